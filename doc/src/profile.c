@@ -164,6 +164,14 @@ The number of seconds for which unresponsive hosts listed in the `host`
 variable will be blacklisted.  Blacklisted hosts will not be connected
 to.  The default is 10 seconds.
 
+@par vhost_cache_ttl = \<int\>
+The number of seconds for which the address of a virtual-hosted bucket
+(requests to `bucket.host`, the default for S3) is remembered.  Buckets which
+resolve to the same address then share the idle connections of the
+pool, TLS ones included: the SNI sent is the name of the host, the
+bucket is only named in the Host header of each request.  The default
+is 300 seconds; 0 resolves the bucket name on every connection.
+
 @par header_size = \<inth\>
 The size in bytes of the buffer used to construct HTTP headers sent to
 the cloud service.  The default is 8192 bytes.
@@ -184,6 +192,20 @@ Note that with Basic the password is sent unencrypted, so you should make
 sure to set `use_https` to `true` to provide any level of security at all.
 There is no default.
 
+@par aws_unsigned_payload = \<bool\>
+With version 4 signatures, sign requests with `UNSIGNED-PAYLOAD`
+instead of the SHA256 of their body, so that uploads do not have to
+hash the whole payload before the first byte is sent.  The integrity of
+the body is then only protected by the transport, so this is meant to
+be used along with `use_https`.  The default is `false`.
+
+@par aws_list_version = \<int\>
+Version of the S3 ListObjects API used by the `s3` backend to list
+buckets, 1 or 2.  Version 2 resumes truncated listings with opaque
+continuation tokens and only returns the owner of the objects when
+asked for; version 1 resumes after the last key and is meant for
+servers which do not implement version 2.  The default is 2.
+
 @par ssl_cert_file = \<path\>
 Specifies a pathname, either absolute or relative to the droplet
 directory, to a file containing a client certificate chain which may be
@@ -261,11 +283,23 @@ Size in bytes of the buffer used to read from the HTTP socket.
 The default is 8192 bytes.
 
 @par encrypt_key = \<string\>
-Specifies the key which is used for the optional encryption
-feature in the VFS interface.  To enable file encryption, use the
-`DPL_VFILE_FLAG_ENCRYPT` flag in the `flags` parameter to either
-`dpl_openread()` or `dpl_openwrite()`.  File encryption uses the
-AES-256 cipher.  There is no default.
+Enables client-side encryption of object data with the given passphrase.
+Regular objects written by `dpl_put()`, `dpl_put_id()`, the stream API
+and `dpl_put_parallel()` are encrypted with AES-256-GCM in authenticated
+chunks of 64 KiB under a random per-object key, which is itself wrapped
+with a key derived from the passphrase and a random salt (PBKDF2-SHA256)
+and stored in user metadata along with the salt and IV.  The last chunk
+of an object is authenticated as such, so that truncation is detected
+and the plaintext size follows from the stored size.  As nothing in the
+metadata depends on the data, multipart uploads send it when they are
+initiated.  Reads decrypt transparently, including
+ranged reads which only fetch the chunks they need, and `dpl_head()`
+reports the plaintext size.  Objects without encryption metadata are
+read as is, and data which fails authentication is reported as
+`DPL_EINTEGRITY`.  Ranged writes and resuming encrypted streams are not
+supported, and listings report the stored (encrypted) sizes.  The
+`DPL_OPTION_NOCRYPT` option bypasses encryption for one request.  There
+is no default.
 
 @par backend = \<string\>
 Name of the protocol used to talk to the server.  The default is `s3`.  The
@@ -301,4 +335,141 @@ generate unique ObjectIDs.  Enterprise Number assignments are published
 For example, SGI's Enterprise Number is 59.  The default is 37489
 (assigned to Scality).
 
+@par dcache_ttl = \<int\>
+Lifetime in seconds of the entries of the VFS dentry cache, which
+remembers how path components were resolved so that walking a path
+does not list every intermediate directory.  A directory listing
+populates the entries of all its children at once.  Changes made
+through the VFS interface invalidate the affected entries, but changes
+made by other clients are only seen once the entries expire.  The
+default is 0, which disables the cache and always gives a consistent view.
+
+@par dcache_negative_ttl = \<int\>
+Lifetime in seconds of the dentry cache entries recording that a
+name does not exist.  The default is 0 (not cached).
+
+@par dcache_max_entries = \<int\>
+Maximum number of entries in the dentry cache; the least recently
+used ones are evicted.  The default is 10000.
+
+@par acache_ttl = \<int\>
+Lifetime in seconds of the entries of the VFS attribute cache, which
+remembers the system and user metadata returned by `dpl_getattr()` so
+that repeated calls on the same path do not issue a HEAD each time.
+Changes made through the VFS interface invalidate the affected
+entries, but changes made by other clients are only seen once the
+entries expire.  Hit and miss counters are available from
+`dpl_acache_get_stats()`.  The default is 0 (disabled).
+
+@par acache_negative_ttl = \<int\>
+Lifetime in seconds of the attribute cache entries recording that an
+object does not exist.  The default is 0 (not cached).
+
+@par acache_max_entries = \<int\>
+Maximum number of entries in the attribute cache; the least recently
+used ones are evicted.  The default is 4096.
+
+@par read_ahead_size = \<inth\>
+Size in bytes of the read-ahead window of files opened through the VFS
+interface.  Once `dpl_pread()` sees sequential reads it fetches a whole
+window at once and prefetches the next one in the background.  The
+windows are requested with `If-Match` on the ETag of the object, so a
+modification by another client discards the buffered data.  Files
+opened with `DPL_VFILE_FLAG_RANDOM` never read ahead.  The default is
+1048576; 0 disables read-ahead.
+
+@par write_back_size = \<inth\>
+Size in bytes of the buffer in which `dpl_pwrite()` coalesces
+contiguous writes to a file, which bounds the memory used per open
+file.  Backends supporting ranged PUT get one request per full buffer.
+On the others (e.g. S3) files must be written sequentially from the
+start: full buffers are sent as parts of a multipart upload, which is
+completed by `dpl_close()` or `dpl_fstream_flush()`, so the buffer is
+at least 5 MiB there, and a `dpl_pread()` stores the file first, after
+which writes start over from offset 0 and replace it.  Errors of
+buffered writes are reported by `dpl_close()`.  The default is 0,
+which disables buffering and sends one ranged PUT per write; 8388608
+is a sensible size.
+
+@par copy_parallel_threshold = \<inth\>
+Size in bytes from which `dpl_copy()`, and thus `dpl_fcopy()` and
+`dpl_rename()`, copy an object with `dpl_copy_parallel()`: the ranges
+of the source are copied concurrently as the parts of a multipart
+upload (UploadPartCopy on S3), which is also the only way to copy
+objects above 5 GiB there.  Backends supporting it HEAD the source
+before every copy to learn its size.  The default is 134217728; 0
+disables multipart copies and the extra HEAD.
+
+@par retry_max = \<int\>
+The number of times an idempotent operation (`dpl_get()`, `dpl_head()`,
+`dpl_put()`, `dpl_delete()` and their `_id` variants) is retried after a
+transient failure: no host could be connected, read timeout, connection
+lost, or HTTP 500, 502, 503 and 504.  Retries go to the next host of the
+`host` list.  The default is 3; 0 disables retries.
+
+@par retry_delay = \<int\>
+The backoff before the first retry, in milliseconds.  It doubles at each
+retry and a random part of it is actually waited, so that clients do not
+retry in lockstep; after a 503 at least half of it is waited.  The
+default is 50.
+
+@par retry_max_delay = \<int\>
+The cap of the backoff, in milliseconds.  The default is 2000.
+
+@par retry_budget = \<int\>
+The number of retries a context can issue in a burst.  The budget is
+only replenished by successful operations, a tenth of a retry each, so
+that retries cannot multiply the load of an overloaded service; a retry
+after a timeout counts twice.  The
+default is 50.
+
+@par max_request_rate = \<int\>
+The number of requests per second the context may issue, all threads
+and hosts together.  Requests in excess wait instead of being rejected
+by the service with 503 SlowDown.  Bursts of up to one second worth of
+requests are allowed.  The default is 0, unlimited.
+
+@par max_upload_rate = \<int\>
+The number of bytes per second the context may send, all connections
+together.  The default is 0, unlimited.
+
+@par max_download_rate = \<int\>
+The number of bytes per second the context may receive, all connections
+together.  The default is 0, unlimited.
+
+@par hedge_percentile = \<int\>
+Enables hedged requests for `dpl_get()`, `dpl_head()` and `dpl_get_id()`
+when the `host` list has several hosts: a request which got no reply
+within this percentile of the recent reply latencies is sent again to
+another host, avoiding hosts known to be slower, and the first conclusive
+reply is kept while the other request is cancelled.  At most
+(100 - hedge_percentile)% more requests are sent, e.g. 95 hedges the
+slowest 5%.  Hedging starts after 32 replies have been timed and is not
+done with `DPL_OPTION_NOALLOC`.  The default is 0, disabled.
+
+@par hedge_min_delay = \<int\>
+The minimum delay before hedging a request, in milliseconds.  The
+default is 5.
+
+@par compress = \<bool\>
+Compresses the data of regular objects written with `dpl_put()`,
+`dpl_put_id()` and streams, in independent 64 KiB chunks.  Data which
+does not look compressible from a few samples is stored as is.  The
+codec and chunk size are recorded in user metadata, along with the
+original size when it is known up front, and the original size also
+ends the stored data, so compressed objects are inflated on read and
+`dpl_getattr()` reports their original size whatever this setting.
+`DPL_OPTION_COMPRESS` enables compression for a single call and
+`DPL_OPTION_NOCOMPRESS` bypasses it, reading the stored data.  Requires
+a build with zstd or zlib.  The default is false.
+
+@par compress_codec = \<string\>
+The codec of data written, `zstd` or `zlib`.  Objects are read whatever
+their codec, as long as the build supports it.  The default is zstd if
+the build supports it, zlib otherwise.
+
+@par compress_level = \<int\>
+The compression level, from 1 (fastest) to 9 (smallest).  The default
+is 1.
+
  */
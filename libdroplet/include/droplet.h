@@ -68,8 +68,31 @@ extern "C" {
 #define DPL_DEFAULT_WRITE_TIMEOUT       30
 #define DPL_DEFAULT_READ_BUF_SIZE       8192
 #define DPL_DEFAULT_MAX_REDIRECTS       10
+#define DPL_DEFAULT_VHOST_CACHE_TTL     300
+#define DPL_DEFAULT_DCACHE_TTL          0
+#define DPL_DEFAULT_DCACHE_NEGATIVE_TTL 0
+#define DPL_DEFAULT_DCACHE_MAX_ENTRIES  10000
+#define DPL_DEFAULT_ACACHE_TTL          0
+#define DPL_DEFAULT_ACACHE_NEGATIVE_TTL 0
+#define DPL_DEFAULT_ACACHE_MAX_ENTRIES  4096
+#define DPL_DEFAULT_READ_AHEAD_SIZE     (1024*1024)
+#define DPL_DEFAULT_WRITE_BACK_SIZE     0
+#define DPL_DEFAULT_COPY_PARALLEL_THRESHOLD (128*1024*1024)
+#define DPL_DEFAULT_RETRY_MAX           3
+#define DPL_DEFAULT_RETRY_DELAY         50
+#define DPL_DEFAULT_RETRY_MAX_DELAY     2000
+#define DPL_DEFAULT_RETRY_BUDGET        50
+#define DPL_DEFAULT_MAX_REQUEST_RATE    0
+#define DPL_DEFAULT_MAX_UPLOAD_RATE     0
+#define DPL_DEFAULT_MAX_DOWNLOAD_RATE   0
+#define DPL_DEFAULT_HEDGE_PERCENTILE    0
+#define DPL_DEFAULT_HEDGE_MIN_DELAY     5
+#define DPL_DEFAULT_COMPRESS            0
+#define DPL_DEFAULT_COMPRESS_LEVEL      1
 #define DPL_DEFAULT_AWS_AUTH_SIGN_VERSION        4
 #define DPL_DEFAULT_AWS_REGION          "us-east-1"
+#define DPL_DEFAULT_AWS_LIST_VERSION    2
+#define DPL_DEFAULT_AWS_UNSIGNED_PAYLOAD 0
 #define DPL_DEFAULT_SSL_METHOD          SSLv23_method()
 #define DPL_DEFAULT_SSL_CIPHER_LIST     "ALL:-aNULL:!LOW:!MEDIUM:!RC2:!3DES:!MD5:!DSS:!SEED:!RC4:@STRENGTH"
 #define DPL_DEFAULT_SSL_COMP_NONE       0
@@ -109,6 +132,9 @@ typedef enum
     DPL_EPRECOND             = (-19),/*!< Precondition failed */
     DPL_ECONFLICT            = (-20),/*!< Conflict */
     DPL_ERANGEUNAVAIL        = (-21),/*!< Range Unavailable */
+    DPL_ESERVER              = (-22),/*!< Transient server error */
+    DPL_EBUSY                = (-23),/*!< Server asks to slow down */
+    DPL_EINTEGRITY           = (-24),/*!< Data failed authentication or integrity check */
   } dpl_status_t;
 
 #include <droplet/queue.h>
@@ -427,6 +453,10 @@ enum
     DPL_OPTION_EXPECT_VERSION      = (1u<<5), /*!< expect version */
     DPL_OPTION_FORCE_VERSION       = (1u<<6), /*!< force version */
     DPL_OPTION_NOALLOC             = (1u<<7), /*!< caller provides buffer for GETs */
+    DPL_OPTION_RECONCILE           = (1u<<8), /*!< reconcile resumed stream with server */
+    DPL_OPTION_NOCRYPT             = (1u<<9), /*!< bypass client-side encryption */
+    DPL_OPTION_COMPRESS            = (1u<<10), /*!< compress data written */
+    DPL_OPTION_NOCOMPRESS          = (1u<<11), /*!< bypass transparent compression */
 #ifndef __cplusplus
   } dpl_option_mask_t;
 #else
@@ -474,6 +504,7 @@ typedef struct
   size_t size;
   char *etags;
   dpl_ftype_t type;
+  char *owner;                  /*!< owner ID if listed, may be NULL */
 } dpl_object_t;
 
 typedef struct
@@ -481,6 +512,8 @@ typedef struct
   char *prefix;
 } dpl_common_prefix_t;
 
+typedef struct dpl_list_cursor dpl_list_cursor_t;
+
 typedef struct
 {
   char          *name;
@@ -489,6 +522,20 @@ typedef struct
   char          *error;
 } dpl_delete_object_t;
 
+typedef struct
+{
+  unsigned int  partnb;
+  char          *etag;
+  uint64_t      size;
+} dpl_multipart_part_t;
+
+typedef struct
+{
+  char          *key;
+  char          *uploadid;
+  time_t        initiated;
+} dpl_multipart_upload_t;
+
 typedef struct 
 {
   uint32_t time_low;
@@ -501,6 +548,17 @@ typedef struct
 
 struct dpl_backend_s;
 
+/*
+ * SigV4 signing key of the day, see src/backend/s3/auth/v4.c
+ */
+typedef struct
+{
+  volatile unsigned int seq;  /*!< odd while being refreshed */
+  char date[9];               /*!< YYYYMMDD */
+  char region[32];
+  char key[32];               /*!< HMAC-SHA256 */
+} dpl_sigv4_key_t;
+
 typedef struct dpl_ctx
 {
   /*
@@ -517,11 +575,15 @@ typedef struct dpl_ctx
   dpl_addrlist_t *addrlist;   /*!< list of addresses to contact */
   int cur_host;               /*!< current host beeing used in addrlist */
   int blacklist_expiretime;   /*!< expiration time of blacklisting */
+  int vhost_cache_ttl;        /*!< virtual-hosted bucket resolution lifetime (sec), 0 disables */
   char *base_path;            /*!< or RootURI */
   char *access_key;
   char *secret_key;
   unsigned char aws_auth_sign_version; /*!< S3 Auth signature version */
   char aws_region[32];        /*!< AWS Region */
+  unsigned char aws_list_version; /*!< S3 ListObjects version */
+  int aws_unsigned_payload;   /*!< SigV4: do not hash the payload */
+  dpl_sigv4_key_t aws_sigv4_key; /*!< cached SigV4 signing key */
   /* SSL */
   char *ssl_cert_file;        /*!< SSL certificate of the client*/
   char *ssl_key_file;         /*!< SSL private key of the client*/
@@ -544,6 +606,7 @@ typedef struct dpl_ctx
   char *pricing;             /*!< might be NULL */
   unsigned int read_buf_size;
   char *encrypt_key;
+  struct dpl_crypt_keys *encrypt_keys; /*!< derived from encrypt_key, NULL disables encryption */
   int encode_slashes;        /*!< client wants slashes encoded */
   int empty_folder_emulation;/*!< folders are represented as empty objects (otherwise, they're purely virtual) */
   int keep_alive;            /*!< client supports keep-alive */
@@ -575,12 +638,74 @@ typedef struct dpl_ctx
    */
   struct dpl_conn **conn_buckets;  /*!< idle connections buckets  */
   int n_conn_fds;                  /*!< number of active fds      */
+  struct dpl_vhost **vhost_buckets; /*!< resolved bucket hosts    */
 
   /*
    * vdir
    */
   dpl_dict_t *cwds;
   char *cur_bucket;
+  struct dpl_vdir *vdir;        /*!< snapshot of the above, see vdir.c */
+  struct dpl_vdir *vdir_retired;
+  volatile int vdir_readers;
+
+  /*
+   * dentry cache
+   */
+  int dcache_ttl;               /*!< positive entries lifetime (sec), 0 disables */
+  int dcache_negative_ttl;      /*!< ENOENT entries lifetime (sec), 0 disables */
+  int dcache_max_entries;       /*!< LRU eviction above this */
+  struct dpl_dcache *dcache;
+
+  /*
+   * attribute cache
+   */
+  int acache_ttl;               /*!< positive entries lifetime (sec), 0 disables */
+  int acache_negative_ttl;      /*!< ENOENT entries lifetime (sec), 0 disables */
+  int acache_max_entries;       /*!< LRU eviction above this */
+  struct dpl_acache *acache;
+
+  /*
+   * vfile
+   */
+  unsigned int read_ahead_size; /*!< dpl_pread() window, 0 disables */
+  unsigned int write_back_size; /*!< dpl_pwrite() buffer, 0 disables */
+
+  /*
+   * server side copies
+   */
+  uint64_t copy_parallel_threshold; /*!< multipart copy from this size, 0 disables */
+
+  /*
+   * retries
+   */
+  int retry_max;                /*!< retries per operation, 0 disables */
+  int retry_delay;              /*!< first backoff (msec), doubled each retry */
+  int retry_max_delay;          /*!< backoff cap (msec) */
+  int retry_budget;             /*!< retries allowed in a burst */
+  struct dpl_retry *retry;
+
+  /*
+   * rate limits
+   */
+  uint64_t max_request_rate;    /*!< requests per second, 0 unlimited */
+  uint64_t max_upload_rate;     /*!< bytes sent per second, 0 unlimited */
+  uint64_t max_download_rate;   /*!< bytes received per second, 0 unlimited */
+  struct dpl_rate_limits *rate_limits;
+
+  /*
+   * hedged requests
+   */
+  int hedge_percentile;         /*!< hedge GET/HEAD slower than this percentile, 0 disables */
+  int hedge_min_delay;          /*!< lower bound of the hedging delay (msec) */
+  struct dpl_hedge *hedge;
+
+  /*
+   * compression
+   */
+  int compress;                 /*!< compress data written */
+  int compress_level;           /*!< codec level, 1 fastest to 9 smallest */
+  char *compress_codec;         /*!< codec of data written, NULL for the preferred one */
 
   /*
    * common
@@ -616,6 +741,19 @@ typedef struct
 
     dpl_dict_t          *md;
     dpl_sysmd_t         *sysmd;
+
+    struct dpl_crypt    *crypt;        /*!< client-side encryption state */
+    char                *crypt_buf;    /*!< partial chunk not sent yet */
+    unsigned int        crypt_len;
+    uint64_t            crypt_offset;  /*!< plaintext bytes sent */
+    int                 crypt_done;    /*!< final chunk sent */
+
+    struct dpl_compress *comp;         /*!< compression state */
+    int                 comp_skip;     /*!< data found incompressible */
+    char                *comp_buf;     /*!< partial chunk not compressed yet */
+    unsigned int        comp_len;
+    char                *comp_out;     /*!< compressed data not sent yet */
+    unsigned int        comp_out_len;
 } dpl_stream_t;
 
 /**/
@@ -732,6 +870,10 @@ void dpl_common_prefix_free(dpl_common_prefix_t *common_prefix);
 void dpl_vec_common_prefixes_free(dpl_vec_t *vec);
 void dpl_delete_object_free(dpl_delete_object_t *object);
 void dpl_vec_delete_objects_free(dpl_vec_t *vec);
+void dpl_multipart_part_free(dpl_multipart_part_t *part);
+void dpl_vec_multipart_parts_free(dpl_vec_t *vec);
+void dpl_multipart_upload_free(dpl_multipart_upload_t *upload);
+void dpl_vec_multipart_uploads_free(dpl_vec_t *vec);
 dpl_option_t *dpl_option_dup(const dpl_option_t *src);
 void dpl_option_free(dpl_option_t *option);
 dpl_condition_t *dpl_condition_dup(const dpl_condition_t *src);
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_ACACHE_H__
+#define __DROPLET_ACACHE_H__ 1
+
+typedef struct
+{
+  uint64_t hits;
+  uint64_t negative_hits;       /*!< hits on ENOENT entries */
+  uint64_t misses;
+  uint64_t expired;             /*!< misses on entries past their TTL */
+  uint64_t inserts;
+  uint64_t evictions;           /*!< entries dropped by the LRU */
+  uint64_t invalidations;       /*!< entries dropped by writes */
+  int n_entries;
+} dpl_acache_stats_t;
+
+/* PROTO acache.c */
+/* src/acache.c */
+dpl_status_t dpl_acache_init(dpl_ctx_t *ctx);
+void dpl_acache_free(dpl_ctx_t *ctx);
+int dpl_acache_enabled(dpl_ctx_t *ctx);
+int dpl_acache_lookup(dpl_ctx_t *ctx, const char *bucket, const char *path, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, dpl_status_t *retp);
+void dpl_acache_insert(dpl_ctx_t *ctx, const char *bucket, const char *path, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd);
+void dpl_acache_invalidate(dpl_ctx_t *ctx, const char *bucket, const char *path);
+void dpl_acache_purge(dpl_ctx_t *ctx);
+void dpl_acache_get_stats(dpl_ctx_t *ctx, dpl_acache_stats_t *statsp);
+#endif
@@ -51,6 +51,8 @@ typedef struct dpl_addr
   struct hostent        *h;
   u_short               port;
   time_t                blacklist_expire_timestamp;
+  uint64_t              latency_usec;   /*!< moving average of reply latency */
+  uint64_t              n_replies;
 
   LIST_ENTRY(dpl_addr) list;
 } dpl_addr_t;
@@ -77,6 +79,8 @@ dpl_status_t dpl_addrlist_get_nth(dpl_addrlist_t *addrlist, int n, dpl_addr_t **
 dpl_status_t dpl_addrlist_get_rand(dpl_addrlist_t *addrlist, dpl_addr_t **addrp);
 dpl_status_t dpl_addrlist_blacklist(dpl_addrlist_t *addrlist, const char *host, const char *portstr, time_t expiretime);
 dpl_status_t dpl_addrlist_unblacklist(dpl_addrlist_t *addrlist, const char *host, const char *portstr);
+void dpl_addrlist_record_latency(dpl_addrlist_t *addrlist, const char *host, const char *portstr, uint64_t usec);
+uint64_t dpl_addrlist_get_latency(dpl_addrlist_t *addrlist, dpl_addr_t *addr);
 dpl_status_t dpl_addrlist_refresh_blacklist_nolock(dpl_addrlist_t *addrlist);
 void dpl_addrlist_add_nolock(dpl_addrlist_t *addrlist, dpl_addr_t *addr);
 void dpl_addrlist_remove_nolock(dpl_addrlist_t *addrlist, dpl_addr_t *addr);
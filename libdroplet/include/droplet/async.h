@@ -64,6 +64,18 @@ typedef enum
     DPL_TASK_HEAD_ID,
     DPL_TASK_DELETE_ID,
     DPL_TASK_COPY_ID,
+    DPL_TASK_LIST_BUCKET_ATTRS,
+    DPL_TASK_DELETE_ALL,
+    DPL_TASK_STREAM_GET,
+    DPL_TASK_STREAM_PUT,
+    DPL_TASK_GETATTR,
+    DPL_TASK_FPUT,
+    DPL_TASK_FGET,
+    DPL_TASK_MKDIR,
+    DPL_TASK_RMDIR,
+    DPL_TASK_UNLINK,
+    DPL_TASK_FCOPY,
+    DPL_TASK_RENAME,
   } dpl_async_task_type_t;
 
 typedef struct
@@ -188,6 +200,100 @@ typedef struct
       dpl_condition_t *condition;
       /* output */
     } copy;
+    struct
+    {
+      /* input */
+      char *bucket;
+      char *prefix;
+      char *delimiter;
+      int max_keys;
+      /* output */
+      dpl_dict_t *metadata;
+      dpl_sysmd_t sysmd;
+      dpl_vec_t *objects;
+      dpl_vec_t *common_prefixes;
+    } list_bucket_attrs;
+    struct
+    {
+      /* input */
+      char *bucket;
+      dpl_locators_t *locators;
+      dpl_option_t *option;
+      dpl_condition_t *condition;
+      /* output */
+      dpl_vec_t *objects;
+    } delete_all;
+    struct
+    {
+      /* input */
+      dpl_stream_t *stream; /*!< not owned by the task */
+      unsigned int len;
+      /* output */
+      dpl_buf_t *buf;
+      struct json_object *status;
+    } stream_get;
+    struct
+    {
+      /* input */
+      dpl_stream_t *stream; /*!< not owned by the task */
+      dpl_buf_t *buf;
+      /* output */
+      struct json_object *status;
+    } stream_put;
+    struct
+    {
+      /* input */
+      char *locator;
+      /* output */
+      dpl_dict_t *metadata;
+      dpl_sysmd_t sysmd;
+    } getattr;
+    struct
+    {
+      /* input */
+      char *locator;
+      dpl_option_t *option;
+      dpl_condition_t *condition;
+      dpl_range_t *range;
+      dpl_dict_t *metadata;
+      dpl_sysmd_t *sysmd;
+      dpl_buf_t *buf;
+      /* output */
+    } fput;
+    struct
+    {
+      /* input */
+      char *locator;
+      dpl_option_t *option;
+      dpl_condition_t *condition;
+      dpl_range_t *range;
+      /* output */
+      dpl_buf_t *buf;
+      dpl_dict_t *metadata;
+      dpl_sysmd_t sysmd;
+    } fget;
+    struct
+    {
+      /* input */
+      char *locator;
+      dpl_dict_t *metadata;
+      dpl_sysmd_t *sysmd;
+      /* output */
+    } mkdir;
+    struct
+    {
+      /* input */
+      char *locator;
+      /* output */
+    } unlink;
+    struct
+    {
+      /* input */
+      char *src_locator;
+      char *dst_locator;
+      dpl_ftype_t object_type;
+      /* output */
+    } rename;
   } u;
 } dpl_async_task_t;
 
@@ -211,4 +317,16 @@ dpl_task_t *dpl_get_id_async_prepare(dpl_ctx_t *ctx, const char *bucket, const c
 dpl_task_t *dpl_head_id_async_prepare(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition);
 dpl_task_t *dpl_delete_id_async_prepare(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition);
 dpl_task_t *dpl_copy_id_async_prepare(dpl_ctx_t *ctx, const char *src_bucket, const char *src_resource, const char *dst_bucket, const char *dst_resource, const dpl_option_t *option, dpl_ftype_t object_type, dpl_copy_directive_t copy_directive, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_condition_t *condition);
+dpl_task_t *dpl_list_bucket_attrs_async_prepare(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, int max_keys);
+dpl_task_t *dpl_delete_all_async_prepare(dpl_ctx_t *ctx, const char *bucket, const dpl_locators_t *locators, const dpl_option_t *option, const dpl_condition_t *condition);
+dpl_task_t *dpl_stream_get_async_prepare(dpl_ctx_t *ctx, dpl_stream_t *stream, unsigned int len);
+dpl_task_t *dpl_stream_put_async_prepare(dpl_ctx_t *ctx, dpl_stream_t *stream, dpl_buf_t *buf);
+dpl_task_t *dpl_getattr_async_prepare(dpl_ctx_t *ctx, const char *locator);
+dpl_task_t *dpl_fput_async_prepare(dpl_ctx_t *ctx, const char *locator, const dpl_option_t *option, const dpl_condition_t *condition, const dpl_range_t *range, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, dpl_buf_t *buf);
+dpl_task_t *dpl_fget_async_prepare(dpl_ctx_t *ctx, const char *locator, const dpl_option_t *option, const dpl_condition_t *condition, const dpl_range_t *range);
+dpl_task_t *dpl_mkdir_async_prepare(dpl_ctx_t *ctx, const char *locator, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd);
+dpl_task_t *dpl_rmdir_async_prepare(dpl_ctx_t *ctx, const char *locator);
+dpl_task_t *dpl_unlink_async_prepare(dpl_ctx_t *ctx, const char *locator);
+dpl_task_t *dpl_fcopy_async_prepare(dpl_ctx_t *ctx, const char *src_locator, const char *dst_locator);
+dpl_task_t *dpl_rename_async_prepare(dpl_ctx_t *ctx, const char *src_locator, const char *dst_locator, dpl_ftype_t object_type);
 #endif
@@ -45,6 +45,8 @@
 #define DCL_BACKEND_LIST_ALL_MY_BUCKETS_FN(fn)  DCL_BACKEND_FN(fn, dpl_vec_t **, char **)
 #define DCL_BACKEND_LIST_BUCKET_FN(fn)          DCL_BACKEND_FN(fn, const char *, const char *, const char *, const int, dpl_vec_t **, dpl_vec_t **, char **)
 #define DCL_BACKEND_LIST_BUCKET_ATTRS_FN(fn)    DCL_BACKEND_FN(fn, const char *, const char *, const char *, const int, dpl_dict_t **, dpl_sysmd_t *, dpl_vec_t **, dpl_vec_t **, char **)
+#define DCL_BACKEND_LIST_BUCKET_PAGE_FN(fn)     DCL_BACKEND_FN(fn, const char *, const char *, const char *, const int, const char *, dpl_vec_t **, dpl_vec_t **, char **, char **)
+#define DCL_BACKEND_LIST_BUCKET_V2_FN(fn)       DCL_BACKEND_FN(fn, const char *, const char *, const char *, const int, const char *, const char *, int, dpl_vec_t **, dpl_vec_t **, char **, char **)
 #define DCL_BACKEND_MAKE_BUCKET_FN(fn)          DCL_BACKEND_FN(fn, const char *, const dpl_sysmd_t *, char **)
 #define DCL_BACKEND_DELETE_BUCKET_FN(fn)        DCL_BACKEND_FN(fn, const char *, char **)
 #define DCL_BACKEND_PUT_FN(fn)                  DCL_BACKEND_FN(fn, const char *, const char *, const char *, const dpl_option_t *, dpl_ftype_t, const dpl_condition_t *, const dpl_range_t *, const dpl_dict_t *, const dpl_sysmd_t *, const char *, unsigned int, const dpl_dict_t *, dpl_sysmd_t *, char **)
@@ -55,6 +57,7 @@
 #define DCL_BACKEND_DELETE_ALL_FN(fn)           DCL_BACKEND_FN(fn, const char *, dpl_locators_t *, const dpl_option_t *, const dpl_condition_t *, dpl_vec_t **)
 #define DCL_BACKEND_DELETE_ALL_ID_FN(fn)        DCL_BACKEND_FN(fn, const char *, const char *, dpl_locators_t *, const dpl_option_t *, const dpl_condition_t *, dpl_vec_t **)
 #define DCL_BACKEND_GENURL_FN(fn)               DCL_BACKEND_FN(fn, const char *, const char *, const char *, const dpl_option_t *, time_t, char *, unsigned int, unsigned int *, char **)
+#define DCL_BACKEND_GENURL_BATCH_FN(fn)         DCL_BACKEND_FN(fn, const char *, const char * const *, int, const dpl_option_t *, time_t, char *, unsigned int, char **, int *)
 #define DCL_BACKEND_COPY_FN(fn)                 DCL_BACKEND_FN(fn, const char *, const char *, const char *, const char *, const char *, const char *, const dpl_option_t *, dpl_ftype_t, dpl_copy_directive_t, const dpl_dict_t *, const dpl_sysmd_t *, const dpl_condition_t *, char **)
 #define DCL_BACKEND_GET_ID_SCHEME_FN(fn)        DCL_BACKEND_FN(fn, dpl_id_scheme_t **)
 
@@ -65,12 +68,21 @@ struct json_object;
 #define DCL_BACKEND_STREAM_PUTMD_FN(fn)         DCL_BACKEND_FN(fn, dpl_stream_t *, dpl_dict_t *, dpl_sysmd_t *)
 #define DCL_BACKEND_STREAM_PUT_FN(fn)           DCL_BACKEND_FN(fn, dpl_stream_t *, char *, unsigned int, struct json_object **)
 #define DCL_BACKEND_STREAM_FLUSH_FN(fn)         DCL_BACKEND_FN(fn, dpl_stream_t *)
+#define DCL_BACKEND_MULTIPART_INIT_FN(fn)       DCL_BACKEND_FN(fn, const char *, const char *, const dpl_dict_t *, const dpl_sysmd_t *, const char **)
+#define DCL_BACKEND_MULTIPART_PUT_FN(fn)        DCL_BACKEND_FN(fn, const char *, const char *, const char *, unsigned int, char *, unsigned int, const char **)
+#define DCL_BACKEND_MULTIPART_COMPLETE_FN(fn)   DCL_BACKEND_FN(fn, const char *, const char *, const char *, struct json_object *, unsigned int, const dpl_dict_t *, const dpl_sysmd_t *)
+#define DCL_BACKEND_MULTIPART_ABORT_FN(fn)      DCL_BACKEND_FN(fn, const char *, const char *, const char *)
+#define DCL_BACKEND_MULTIPART_COPY_FN(fn)       DCL_BACKEND_FN(fn, const char *, const char *, const char *, unsigned int, const char *, const char *, const dpl_range_t *, const dpl_condition_t *, const char **)
+#define DCL_BACKEND_MULTIPART_LIST_PARTS_FN(fn) DCL_BACKEND_FN(fn, const char *, const char *, const char *, dpl_vec_t **)
+#define DCL_BACKEND_MULTIPART_LIST_UPLOADS_FN(fn) DCL_BACKEND_FN(fn, const char *, const char *, dpl_vec_t **)
 
 typedef DCL_BACKEND_GET_CAPABILITIES_FN(*dpl_get_capabilities_t);
 typedef DCL_BACKEND_LOGIN_FN(*dpl_login_t);
 typedef DCL_BACKEND_LIST_ALL_MY_BUCKETS_FN(*dpl_list_all_my_buckets_t);
 typedef DCL_BACKEND_LIST_BUCKET_FN(*dpl_list_bucket_t);
 typedef DCL_BACKEND_LIST_BUCKET_ATTRS_FN(*dpl_list_bucket_attrs_t);
+typedef DCL_BACKEND_LIST_BUCKET_PAGE_FN(*dpl_list_bucket_page_t);
+typedef DCL_BACKEND_LIST_BUCKET_V2_FN(*dpl_list_bucket_v2_t);
 typedef DCL_BACKEND_MAKE_BUCKET_FN(*dpl_make_bucket_t);
 typedef DCL_BACKEND_DELETE_BUCKET_FN(*dpl_delete_bucket_t);
 typedef DCL_BACKEND_PUT_FN(*dpl_put_t);
@@ -81,6 +93,7 @@ typedef DCL_BACKEND_DELETE_FN(*dpl_delete_t);
 typedef DCL_BACKEND_DELETE_ALL_FN(*dpl_delete_all_t);
 typedef DCL_BACKEND_DELETE_ALL_ID_FN(*dpl_delete_all_id_t);
 typedef DCL_BACKEND_GENURL_FN(*dpl_genurl_t);
+typedef DCL_BACKEND_GENURL_BATCH_FN(*dpl_genurl_batch_t);
 typedef DCL_BACKEND_COPY_FN(*dpl_copy_t);
 typedef DCL_BACKEND_GET_ID_SCHEME_FN(*dpl_get_id_scheme_t);
 typedef DCL_BACKEND_STREAM_RESUME_FN(*dpl_stream_resume_t);
@@ -89,6 +102,13 @@ typedef DCL_BACKEND_STREAM_GET_FN(*dpl_stream_get_t);
 typedef DCL_BACKEND_STREAM_PUTMD_FN(*dpl_stream_putmd_t);
 typedef DCL_BACKEND_STREAM_PUT_FN(*dpl_stream_put_t);
 typedef DCL_BACKEND_STREAM_FLUSH_FN(*dpl_stream_flush_t);
+typedef DCL_BACKEND_MULTIPART_INIT_FN(*dpl_multipart_init_t);
+typedef DCL_BACKEND_MULTIPART_PUT_FN(*dpl_multipart_put_t);
+typedef DCL_BACKEND_MULTIPART_COMPLETE_FN(*dpl_multipart_complete_t);
+typedef DCL_BACKEND_MULTIPART_ABORT_FN(*dpl_multipart_abort_t);
+typedef DCL_BACKEND_MULTIPART_COPY_FN(*dpl_multipart_copy_t);
+typedef DCL_BACKEND_MULTIPART_LIST_PARTS_FN(*dpl_multipart_list_parts_t);
+typedef DCL_BACKEND_MULTIPART_LIST_UPLOADS_FN(*dpl_multipart_list_uploads_t);
 
 typedef struct dpl_backend_s
 {
@@ -98,6 +118,8 @@ typedef struct dpl_backend_s
   dpl_list_all_my_buckets_t     list_all_my_buckets;
   dpl_list_bucket_t             list_bucket;
   dpl_list_bucket_attrs_t       list_bucket_attrs;
+  dpl_list_bucket_page_t        list_bucket_page;
+  dpl_list_bucket_v2_t          list_bucket_v2;
   dpl_make_bucket_t             make_bucket;
   dpl_delete_bucket_t           delete_bucket;
   dpl_put_t                     post;
@@ -116,6 +138,7 @@ typedef struct dpl_backend_s
   dpl_head_raw_t                head_id_raw;
   dpl_delete_t                  delete_id;
   dpl_genurl_t                  genurl;
+  dpl_genurl_batch_t            genurl_batch;
   dpl_copy_t                    copy;
   dpl_copy_t                    copy_id;
   dpl_stream_resume_t           stream_resume;
@@ -124,6 +147,13 @@ typedef struct dpl_backend_s
   dpl_stream_putmd_t            stream_putmd;
   dpl_stream_put_t              stream_put;
   dpl_stream_flush_t            stream_flush;
+  dpl_multipart_init_t          multipart_init;
+  dpl_multipart_put_t           multipart_put;
+  dpl_multipart_complete_t      multipart_complete;
+  dpl_multipart_abort_t         multipart_abort;
+  dpl_multipart_copy_t          multipart_copy;
+  dpl_multipart_list_parts_t    multipart_list_parts;
+  dpl_multipart_list_uploads_t  multipart_list_uploads;
 } dpl_backend_t;
 
 #endif
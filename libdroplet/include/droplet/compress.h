@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_COMPRESS_H__
+#define __DROPLET_COMPRESS_H__ 1
+
+#define DPL_COMPRESS_CHUNK_SIZE 65536
+#define DPL_COMPRESS_TRAILER_SIZE 8
+
+/*
+ * user metadata describing a compressed object
+ */
+#define DPL_COMPRESS_MD_CODEC   "dpl-comp"
+#define DPL_COMPRESS_MD_CHUNK   "dpl-comp-chunk"
+#define DPL_COMPRESS_MD_SIZE    "dpl-comp-size"
+
+struct dpl_compress_codec;
+
+typedef struct dpl_compress
+{
+  const struct dpl_compress_codec *codec;
+  uint32_t chunk_size;          /*!< original bytes per chunk */
+  int level;
+  uint64_t size;                /*!< original size, DPL_UNDEF until read from the trailer */
+  uint64_t index_offset;        /*!< stored offset of the chunk index */
+  uint32_t n_chunks;
+  uint32_t max_chunks;
+  uint64_t *offsets;            /*!< stored offset of each chunk, and of the index */
+} dpl_compress_t;
+
+/* PROTO compress.c */
+/* src/compress.c */
+int dpl_compress_codec_supported(const char *name);
+int dpl_compress_enabled(dpl_ctx_t *ctx, const dpl_option_t *option);
+int dpl_compress_worthwhile(dpl_ctx_t *ctx, const char *buf, size_t len);
+dpl_compress_t *dpl_compress_new(dpl_ctx_t *ctx);
+void dpl_compress_destroy(dpl_compress_t *comp);
+dpl_status_t dpl_compress_deflate(dpl_compress_t *comp, const char *in, size_t len, char *out, size_t *out_lenp);
+size_t dpl_compress_index_size(const dpl_compress_t *comp);
+size_t dpl_compress_write_index(const dpl_compress_t *comp, char *buf);
+dpl_status_t dpl_compress_seal(const dpl_compress_t *comp, dpl_dict_t *metadata, int sized);
+dpl_status_t dpl_compress_open(dpl_ctx_t *ctx, const dpl_dict_t *metadata, dpl_compress_t **compp);
+dpl_status_t dpl_compress_index_range(const dpl_compress_t *comp, uint64_t stored_size, dpl_range_t *rangep);
+dpl_status_t dpl_compress_load_index(dpl_compress_t *comp, uint64_t stored_size, const char *buf, size_t len);
+uint32_t dpl_compress_range(const dpl_compress_t *comp, uint64_t start, uint64_t end, dpl_range_t *rangep);
+dpl_status_t dpl_compress_inflate(const dpl_compress_t *comp, uint32_t first, const char *in, size_t len, char *out, size_t *out_lenp);
+void dpl_compress_strip(dpl_dict_t *metadata);
+dpl_status_t dpl_compress_copy_md(const dpl_dict_t *src, dpl_dict_t *dst);
+#endif
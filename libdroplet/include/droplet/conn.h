@@ -84,6 +84,12 @@ typedef struct dpl_conn
   dpl_status_t status;
   int eof;           /*!< set to 1 at EOF            */
 
+  /*
+   * current request
+   */
+  struct timespec request_start; /*!< zeroed once the reply status is read */
+  int cancelled;     /*!< shut down in favor of a hedged twin */
+
   /*
    * ssl
    */
@@ -94,6 +100,9 @@ typedef struct dpl_conn
 /* PROTO conn.c */
 /* src/conn.c */
 dpl_conn_t *dpl_conn_open_host(dpl_ctx_t *ctx, int af, const char *host, const char *portstr);
+int dpl_vhost_lookup(dpl_ctx_t *ctx, const char *name, int af, char *addr, int *addr_lenp);
+void dpl_vhost_insert(dpl_ctx_t *ctx, const char *name, int af, const char *addr, int addr_len);
+void dpl_vhost_forget(dpl_ctx_t *ctx, const char *name);
 void dpl_blacklist_host(dpl_ctx_t *ctx, const char *host, const char *portstr);
 dpl_status_t dpl_try_connect(dpl_ctx_t *ctx, dpl_req_t *req, dpl_conn_t **connp);
 void dpl_conn_release(dpl_conn_t *conn);
@@ -101,5 +110,6 @@ void dpl_conn_terminate(dpl_conn_t *conn);
 dpl_status_t dpl_conn_pool_init(dpl_ctx_t *ctx);
 void dpl_conn_pool_destroy(dpl_ctx_t *ctx);
 dpl_status_t dpl_conn_writev_all(dpl_conn_t *conn, struct iovec *iov, int n_iov, int timeout);
+void dpl_conn_record_latency(dpl_conn_t *conn);
 dpl_conn_t *dpl_conn_open_file(dpl_ctx_t *ctx, int fd);
 #endif
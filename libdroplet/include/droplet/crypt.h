@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_CRYPT_H__
+#define __DROPLET_CRYPT_H__ 1
+
+#define DPL_CRYPT_CHUNK_SIZE    65536
+#define DPL_CRYPT_TAG_SIZE      16
+#define DPL_CRYPT_KEY_SIZE      32
+#define DPL_CRYPT_IV_SIZE       12
+#define DPL_CRYPT_SALT_SIZE     16
+
+/*
+ * user metadata holding the envelope of an encrypted object
+ */
+#define DPL_CRYPT_MD_SCHEME     "dpl-enc"
+#define DPL_CRYPT_MD_CHUNK      "dpl-enc-chunk"
+#define DPL_CRYPT_MD_SALT       "dpl-enc-salt"
+#define DPL_CRYPT_MD_IV         "dpl-enc-iv"
+#define DPL_CRYPT_MD_KEY        "dpl-enc-key"
+
+typedef struct dpl_crypt
+{
+  unsigned char key[DPL_CRYPT_KEY_SIZE]; /*!< data key of the object */
+  unsigned char iv[DPL_CRYPT_IV_SIZE];   /*!< chunk index is xored in */
+  uint32_t chunk_size;          /*!< plaintext bytes per chunk */
+} dpl_crypt_t;
+
+/* PROTO crypt.c */
+/* src/crypt.c */
+dpl_status_t dpl_crypt_init(dpl_ctx_t *ctx);
+void dpl_crypt_free(dpl_ctx_t *ctx);
+int dpl_crypt_enabled(dpl_ctx_t *ctx);
+dpl_crypt_t *dpl_crypt_new(dpl_ctx_t *ctx);
+void dpl_crypt_destroy(dpl_crypt_t *crypt);
+dpl_status_t dpl_crypt_seal(dpl_ctx_t *ctx, dpl_crypt_t *crypt, dpl_dict_t *metadata);
+dpl_status_t dpl_crypt_open(dpl_ctx_t *ctx, const dpl_dict_t *metadata, dpl_crypt_t **cryptp);
+void dpl_crypt_strip(dpl_dict_t *metadata);
+dpl_status_t dpl_crypt_copy_envelope(const dpl_dict_t *src, dpl_dict_t *dst);
+uint64_t dpl_crypt_cipher_size(uint32_t chunk_size, uint64_t len, int final);
+int dpl_crypt_plain_size(uint32_t chunk_size, uint64_t cipher_size, uint64_t *sizep);
+uint64_t dpl_crypt_cipher_range(uint32_t chunk_size, uint64_t start, uint64_t end, dpl_range_t *rangep);
+dpl_status_t dpl_crypt_encrypt(const dpl_crypt_t *crypt, uint64_t offset, const char *in, size_t len, int final, char *out);
+dpl_status_t dpl_crypt_decrypt(const dpl_crypt_t *crypt, uint64_t offset, const char *in, size_t len, char *out, size_t *out_lenp, int *finalp);
+#endif
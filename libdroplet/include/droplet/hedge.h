@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_HEDGE_H__
+#define __DROPLET_HEDGE_H__ 1
+
+typedef struct
+{
+  uint64_t hedges_sent;         /*!< duplicate requests issued */
+  uint64_t hedges_won;          /*!< duplicates which answered first */
+  uint64_t cancelled;           /*!< requests abandoned to their twin */
+  uint64_t delay_usec;          /*!< last delay before hedging */
+} dpl_hedge_stats_t;
+
+/* PROTO hedge.c */
+/* src/hedge.c */
+dpl_status_t dpl_hedge_init(dpl_ctx_t *ctx);
+void dpl_hedge_free(dpl_ctx_t *ctx);
+void dpl_hedge_record(dpl_ctx_t *ctx, uint64_t usec);
+int dpl_hedge_avoid(dpl_ctx_t *ctx, dpl_addr_t *addr);
+void dpl_hedge_attach(dpl_conn_t *conn, dpl_addr_t *addr);
+void dpl_hedge_replied(dpl_ctx_t *ctx);
+void dpl_hedge_detach(dpl_conn_t *conn);
+dpl_status_t dpl_hedge_get(dpl_ctx_t *ctx, dpl_get_t get, const char *bucket, const char *resource, const char *subresource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, const dpl_range_t *range, char **data_bufp, unsigned int *data_lenp, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp);
+dpl_status_t dpl_hedge_head(dpl_ctx_t *ctx, dpl_head_t head, const char *bucket, const char *resource, const char *subresource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp);
+void dpl_hedge_get_stats(dpl_ctx_t *ctx, dpl_hedge_stats_t *statsp);
+#endif
@@ -51,6 +51,10 @@ typedef enum
     DPL_HTTP_CODE_CONFLICT         = 409,
     DPL_HTTP_CODE_PRECOND_FAILED   = 412,
     DPL_HTTP_CODE_RANGE_UNAVAIL	   = 416,
+    DPL_HTTP_CODE_INTERNAL_ERROR   = 500,
+    DPL_HTTP_CODE_BAD_GATEWAY      = 502,
+    DPL_HTTP_CODE_SERVICE_UNAVAIL  = 503,
+    DPL_HTTP_CODE_GATEWAY_TIMEOUT  = 504,
   } dpl_http_code_t;
 
 struct dpl_http_reply
@@ -77,4 +81,5 @@ char *dpl_location(dpl_dict_t *headers_returned);
 dpl_status_t dpl_map_http_status(int http_status);
 dpl_status_t dpl_read_http_reply_ext(dpl_conn_t *conn, int expect_data, int buffer_provided, char **data_bufp, unsigned int *data_lenp, dpl_dict_t **headersp, int *connection_closep);
 dpl_status_t dpl_read_http_reply(dpl_conn_t *conn, int expect_data, char **data_bufp, unsigned int *data_lenp, dpl_dict_t **headersp, int *connection_closep);
+dpl_status_t dpl_read_http_reply_stream(dpl_conn_t *conn, int expect_data, dpl_buffer_func_t buffer_func, void *cb_arg, dpl_dict_t **headersp, int *connection_closep);
 #endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DPL_PARALLEL_H__
+#define __DPL_PARALLEL_H__ 1
+
+#include <droplet/task.h>
+
+#define DPL_PARALLEL_DEFAULT_PART_SIZE   (8*1024*1024)
+#define DPL_PARALLEL_DEFAULT_N_PARALLEL  DPL_TASK_DEFAULT_N_WORKERS
+#define DPL_PARALLEL_DEFAULT_MAX_RETRIES 3
+#define DPL_PARALLEL_DEFAULT_COPY_PART_SIZE (64*1024*1024)
+
+#define DPL_MULTIPART_MIN_PART_SIZE      (5*1024*1024)
+#define DPL_MULTIPART_MAX_PARTS          10000
+#define DPL_MULTIPART_MAX_PART_SIZE      (5ULL*1024*1024*1024)
+
+typedef struct
+{
+  uint64_t part_size;   /*!< bytes per part, 0 for default */
+  int n_parallel;       /*!< max parts in flight, 0 for default */
+  int max_retries;      /*!< retries per part, -1 for default */
+  dpl_task_pool_t *pool;/*!< optional pool, a private one is used if NULL */
+} dpl_parallel_params_t;
+
+/**
+ * data source of dpl_put_parallel(): copy at most len bytes into buf
+ * and set *lenp, 0 meaning end of data
+ */
+typedef dpl_status_t (*dpl_parallel_read_func_t)(void *cb_arg, char *buf, unsigned int len, unsigned int *lenp);
+
+/* PROTO parallel.c */
+/* src/parallel.c */
+dpl_status_t dpl_get_parallel(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, const dpl_parallel_params_t *params, char *buf, uint64_t buf_size, uint64_t *lenp, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+dpl_status_t dpl_get_parallel_fd(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, const dpl_parallel_params_t *params, int fd, uint64_t *lenp, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+dpl_status_t dpl_put_parallel(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_parallel_params_t *params, dpl_parallel_read_func_t read_func, void *cb_arg);
+dpl_status_t dpl_fput_file(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_parallel_params_t *params, int fd);
+dpl_status_t dpl_copy_parallel_sized(dpl_ctx_t *ctx, const char *src_bucket, const char *src_resource, const char *dst_bucket, const char *dst_resource, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_condition_t *condition, const dpl_parallel_params_t *params, const dpl_sysmd_t *src_sysmdp, const dpl_dict_t *src_metadata);
+dpl_status_t dpl_copy_parallel(dpl_ctx_t *ctx, const char *src_bucket, const char *src_resource, const char *dst_bucket, const char *dst_resource, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_condition_t *condition, const dpl_parallel_params_t *params);
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_RATELIMIT_H__
+#define __DROPLET_RATELIMIT_H__ 1
+
+typedef struct
+{
+  uint64_t requests;            /*!< requests admitted */
+  uint64_t request_waits;       /*!< requests which had to wait */
+  uint64_t request_wait_usec;
+  uint64_t upload_bytes;
+  uint64_t upload_waits;
+  uint64_t upload_wait_usec;
+  uint64_t download_bytes;
+  uint64_t download_waits;
+  uint64_t download_wait_usec;
+} dpl_rate_limit_stats_t;
+
+typedef void (*dpl_rate_limit_clock_func_t)(struct timespec *nowp);
+typedef void (*dpl_rate_limit_sleep_func_t)(useconds_t usec);
+
+/* PROTO ratelimit.c */
+/* src/ratelimit.c */
+dpl_status_t dpl_rate_limit_init(dpl_ctx_t *ctx);
+void dpl_rate_limit_free(dpl_ctx_t *ctx);
+void dpl_rate_limit_request(dpl_ctx_t *ctx);
+int dpl_rate_limit_upload_enabled(dpl_ctx_t *ctx);
+void dpl_rate_limit_upload(dpl_ctx_t *ctx, size_t len);
+void dpl_rate_limit_download(dpl_ctx_t *ctx, size_t len);
+void dpl_rate_limit_get_stats(dpl_ctx_t *ctx, dpl_rate_limit_stats_t *statsp);
+void dpl_rate_limit_set_clock(dpl_ctx_t *ctx, dpl_rate_limit_clock_func_t clock_func, dpl_rate_limit_sleep_func_t sleep_func);
+#endif
@@ -43,6 +43,7 @@ dpl_status_t dpl_req_set_port(dpl_req_t *req, const char *port);
 void dpl_req_set_method(dpl_req_t *req, dpl_method_t method);
 dpl_status_t dpl_req_set_bucket(dpl_req_t *req, const char *bucket);
 dpl_status_t dpl_req_set_src_resource_ext(dpl_req_t *req, const char *src_resource, int add_base_path);
+void dpl_req_resource_path(const dpl_ctx_t *ctx, const char *resource, char *npath, size_t npath_size);
 dpl_status_t dpl_req_set_resource(dpl_req_t *req, const char *resource);
 dpl_status_t dpl_req_set_subresource(dpl_req_t *req, const char *subresource);
 dpl_status_t dpl_req_add_subresource(dpl_req_t *req, const char *subresource);
@@ -39,6 +39,13 @@ dpl_status_t dpl_get_capabilities(dpl_ctx_t *ctx, dpl_capability_t *maskp);
 dpl_status_t dpl_login(dpl_ctx_t *ctx);
 dpl_status_t dpl_list_all_my_buckets(dpl_ctx_t *ctx, dpl_vec_t **vecp);
 dpl_status_t dpl_list_bucket(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, const int max_keys, dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp);
+dpl_status_t dpl_list_bucket_page(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, const int max_keys, const char *marker, dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp, char **next_markerp);
+dpl_status_t dpl_list_bucket_v2(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, const int max_keys, const char *start_after, const char *token, int fetch_owner, dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp, char **next_tokenp);
+void dpl_list_cursor_free(dpl_list_cursor_t *cursor);
+dpl_list_cursor_t *dpl_list_cursor_new(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, const char *start_after, const char *end_before, const char *token, int fetch_owner);
+dpl_status_t dpl_list_cursor_next(dpl_list_cursor_t *cursor, const int max_keys, dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp);
+int dpl_list_cursor_done(const dpl_list_cursor_t *cursor);
+const char *dpl_list_cursor_token(const dpl_list_cursor_t *cursor);
 dpl_status_t dpl_list_bucket_attrs(dpl_ctx_t *ctx, const char *bucket, const char *prefix, const char *delimiter, const int max_keys, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp);
 dpl_status_t dpl_make_bucket(dpl_ctx_t *ctx, const char *bucket, dpl_location_constraint_t location_constraint, dpl_canned_acl_t canned_acl);
 dpl_status_t dpl_delete_bucket(dpl_ctx_t *ctx, const char *bucket);
@@ -60,6 +67,7 @@ dpl_status_t dpl_delete_id(dpl_ctx_t *ctx, const char *bucket, const char *id, c
 dpl_status_t dpl_delete_all_id(dpl_ctx_t *ctx, const char *bucket, const char *ressource, dpl_locators_t *locators, const dpl_option_t *option, const dpl_condition_t *condition, dpl_vec_t **objects);
 dpl_status_t dpl_copy_id(dpl_ctx_t *ctx, const char *src_bucket, const char *src_id, const char *dst_bucket, const char *dst_path, const dpl_option_t *option, dpl_ftype_t object_type, dpl_copy_directive_t copy_directive, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const dpl_condition_t *condition);
 dpl_status_t dpl_genurl(dpl_ctx_t *ctx, const char *bucket, const char *path, const dpl_option_t *option, time_t expires, char *buf, unsigned int len, unsigned int *lenp);
+dpl_status_t dpl_genurl_batch(dpl_ctx_t *ctx, const char *bucket, const char * const *paths, int n_paths, const dpl_option_t *option, time_t expires, char *buf, unsigned int len, char **urls, int *n_urlsp);
 
 struct json_object;
 dpl_status_t dpl_stream_open(dpl_ctx_t *ctx, const char *bucket, const char *path, const dpl_option_t *option, const dpl_condition_t *condition, dpl_dict_t *metadata, dpl_sysmd_t *sysmd, dpl_stream_t **streamp);
@@ -71,5 +79,14 @@ dpl_status_t dpl_stream_putmd(dpl_ctx_t *ctx, dpl_stream_t *stream, dpl_dict_t *
 dpl_status_t dpl_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream, char *buf, unsigned int len, struct json_object **statusp);
 dpl_status_t dpl_stream_flush(dpl_ctx_t *ctx, dpl_stream_t *stream);
 void         dpl_stream_close(dpl_ctx_t *ctx, dpl_stream_t *stream);
+dpl_status_t dpl_multipart_init(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char **uploadidp);
+dpl_status_t dpl_multipart_init_ext(dpl_ctx_t *ctx, const char *bucket, const char *resource, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const char **uploadidp);
+dpl_status_t dpl_multipart_put(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char *uploadid, unsigned int partnb, char *buf, unsigned int len, const char **etagp);
+dpl_status_t dpl_multipart_complete(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char *uploadid, struct json_object *parts, unsigned int n_parts, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd);
+dpl_status_t dpl_multipart_abort(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char *uploadid);
+dpl_status_t dpl_multipart_copy(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char *uploadid, unsigned int partnb, const char *src_bucket, const char *src_resource, const dpl_range_t *range, const dpl_condition_t *condition, const char **etagp);
+dpl_status_t dpl_multipart_list_parts(dpl_ctx_t *ctx, const char *bucket, const char *resource, const char *uploadid, dpl_vec_t **partsp);
+dpl_status_t dpl_multipart_list_uploads(dpl_ctx_t *ctx, const char *bucket, const char *prefix, dpl_vec_t **uploadsp);
+dpl_status_t dpl_multipart_abort_stale(dpl_ctx_t *ctx, const char *bucket, const char *prefix, time_t max_age, int *n_abortedp);
 
 #endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#ifndef __DROPLET_RETRY_H__
+#define __DROPLET_RETRY_H__ 1
+
+typedef enum
+  {
+    DPL_RETRY_CONNECT,          /*!< no host could be connected */
+    DPL_RETRY_TIMEOUT,          /*!< the server did not answer in time */
+    DPL_RETRY_SERVER,           /*!< 500, 502, 504 */
+    DPL_RETRY_SLOWDOWN,         /*!< 503, e.g. S3 SlowDown */
+    DPL_RETRY_RESET,            /*!< connection lost, possibly mid-body */
+    DPL_RETRY_N_REASONS,
+  } dpl_retry_reason_t;
+
+typedef struct
+{
+  uint64_t retries[DPL_RETRY_N_REASONS]; /*!< retries issued, per reason */
+  uint64_t recovered;           /*!< operations which succeeded after retrying */
+  uint64_t exhausted;           /*!< operations which failed after retry_max retries */
+  uint64_t denied;              /*!< retries not issued for lack of budget */
+  int tokens;                   /*!< budget left */
+} dpl_retry_stats_t;
+
+/* PROTO retry.c */
+/* src/retry.c */
+dpl_status_t dpl_retry_init(dpl_ctx_t *ctx);
+void dpl_retry_free(dpl_ctx_t *ctx);
+int dpl_retry_classify(dpl_status_t status, dpl_retry_reason_t *reasonp);
+const char *dpl_retry_reason_str(dpl_retry_reason_t reason);
+int dpl_retry_again(dpl_ctx_t *ctx, dpl_status_t status, int *attemptp);
+void dpl_retry_get_stats(dpl_ctx_t *ctx, dpl_retry_stats_t *statsp);
+#endif
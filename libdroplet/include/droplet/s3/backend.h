@@ -39,6 +39,8 @@ DCL_BACKEND_GET_CAPABILITIES_FN(dpl_s3_get_capabilities);
 DCL_BACKEND_LIST_ALL_MY_BUCKETS_FN(dpl_s3_list_all_my_buckets);
 DCL_BACKEND_LIST_BUCKET_FN(dpl_s3_list_bucket);
 DCL_BACKEND_LIST_BUCKET_ATTRS_FN(dpl_s3_list_bucket_attrs);
+DCL_BACKEND_LIST_BUCKET_PAGE_FN(dpl_s3_list_bucket_page);
+DCL_BACKEND_LIST_BUCKET_V2_FN(dpl_s3_list_bucket_v2);
 DCL_BACKEND_MAKE_BUCKET_FN(dpl_s3_make_bucket);
 DCL_BACKEND_DELETE_BUCKET_FN(dpl_s3_delete_bucket);
 DCL_BACKEND_PUT_FN(dpl_s3_put);
@@ -48,6 +50,7 @@ DCL_BACKEND_HEAD_RAW_FN(dpl_s3_head_raw);
 DCL_BACKEND_DELETE_FN(dpl_s3_delete);
 DCL_BACKEND_DELETE_ALL_FN(dpl_s3_delete_all);
 DCL_BACKEND_GENURL_FN(dpl_s3_genurl);
+DCL_BACKEND_GENURL_BATCH_FN(dpl_s3_genurl_batch);
 DCL_BACKEND_COPY_FN(dpl_s3_copy);
 DCL_BACKEND_STREAM_RESUME_FN(dpl_s3_stream_resume);
 DCL_BACKEND_STREAM_GET_FN(dpl_s3_stream_get);
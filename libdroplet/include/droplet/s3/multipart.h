@@ -38,6 +38,8 @@
 dpl_status_t dpl_s3_stream_multipart_init(dpl_ctx_t *ctx,
                                           const char *bucket,
                                           const char *resource,
+                                          const dpl_dict_t *metadata,
+                                          const dpl_sysmd_t *sysmd,
                                           const char **uploadidp);
 dpl_status_t dpl_s3_stream_multipart_complete(dpl_ctx_t *ctx,
                                               const char *bucket,
@@ -54,5 +56,39 @@ dpl_status_t dpl_s3_stream_multipart_put(dpl_ctx_t *ctx,
 					 unsigned int partnb,
                                          char *buf, unsigned int len,
                                          const char **etagp);
+dpl_status_t dpl_s3_stream_multipart_abort(dpl_ctx_t *ctx,
+                                           const char *bucket,
+                                           const char *resource,
+                                           const char *uploadid);
+dpl_status_t dpl_s3_stream_multipart_copy(dpl_ctx_t *ctx,
+                                          const char *bucket,
+                                          const char *resource,
+                                          const char *uploadid,
+                                          unsigned int partnb,
+                                          const char *src_bucket,
+                                          const char *src_resource,
+                                          const dpl_range_t *range,
+                                          const dpl_condition_t *condition,
+                                          const char **etagp);
+dpl_status_t dpl_s3_stream_multipart_list_parts(dpl_ctx_t *ctx,
+                                                const char *bucket,
+                                                const char *resource,
+                                                const char *uploadid,
+                                                dpl_vec_t **partsp);
+dpl_status_t dpl_s3_stream_multipart_list_uploads(dpl_ctx_t *ctx,
+                                                  const char *bucket,
+                                                  const char *prefix,
+                                                  dpl_vec_t **uploadsp);
+dpl_status_t dpl_s3_parse_multipart_list_parts(const dpl_ctx_t *ctx,
+                                               const char *buf, int len,
+                                               dpl_vec_t *parts,
+                                               int *truncatedp,
+                                               unsigned int *next_markerp);
+dpl_status_t dpl_s3_parse_multipart_list_uploads(const dpl_ctx_t *ctx,
+                                                 const char *buf, int len,
+                                                 dpl_vec_t *uploads,
+                                                 int *truncatedp,
+                                                 char **next_key_markerp,
+                                                 char **next_uploadid_markerp);
 
 #endif
@@ -36,11 +36,20 @@
 
 #define DPL_X_AMZ_META_PREFIX "x-amz-meta-"
 
+typedef struct dpl_s3_reply_parser dpl_s3_reply_parser_t;
+
 /* PROTO replyparser.c */
 /* src/replyparser.c */
 dpl_status_t dpl_s3_get_metadatum_from_header(const char *header, const char *value, dpl_metadatum_func_t metadatum_func, void *cb_arg, dpl_dict_t *metadata, dpl_sysmd_t *sysmdp);
 dpl_status_t dpl_s3_get_metadata_from_headers(const dpl_dict_t *headers, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
 dpl_status_t dpl_s3_parse_list_all_my_buckets(const dpl_ctx_t *ctx, const char *buf, int len, dpl_vec_t *vec);
+dpl_s3_reply_parser_t *dpl_s3_list_bucket_parser_new(const dpl_ctx_t *ctx, dpl_vec_t *objects, dpl_vec_t *common_prefixes);
+dpl_s3_reply_parser_t *dpl_s3_delete_all_parser_new(const dpl_ctx_t *ctx, dpl_vec_t *objects);
+void dpl_s3_reply_parser_free(dpl_s3_reply_parser_t *parser);
+dpl_status_t dpl_s3_reply_parser_feed(void *cb_arg, char *buf, unsigned int len);
+int dpl_s3_reply_parser_fed(const dpl_s3_reply_parser_t *parser);
+dpl_status_t dpl_s3_reply_parser_finish(dpl_s3_reply_parser_t *parser, int *truncatedp, char **next_markerp);
+dpl_status_t dpl_s3_parse_list_bucket_page(const dpl_ctx_t *ctx, const char *buf, int len, dpl_vec_t *objects, dpl_vec_t *common_prefixes, int *truncatedp, char **next_markerp);
 dpl_status_t dpl_s3_parse_list_bucket(const dpl_ctx_t *ctx, const char *buf, int len, dpl_vec_t *objects, dpl_vec_t *common_prefixes);
 dpl_status_t dpl_s3_parse_delete_all(const dpl_ctx_t *ctx, const char *buf, int len, dpl_vec_t *vec);
 #endif
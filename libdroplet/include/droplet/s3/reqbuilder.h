@@ -39,6 +39,16 @@ typedef enum
     DPL_S3_REQ_COPY = (1u<<0),
   } dpl_s3_req_mask_t;
 
+/*
+ * what the SigV4 query string authentications of a batch of URLs share
+ */
+typedef struct
+{
+  char          date_str[32];
+  char          query[1024];    /*!< canonical query string, without signature */
+  dpl_hmac_key_t key;           /*!< signing key of the day */
+} dpl_s3_presign_v4_t;
+
 /* PROTO reqbuilder.c */
 /* src/reqbuilder.c */
 dpl_status_t dpl_s3_req_build(const dpl_req_t *req, dpl_s3_req_mask_t req_mask, dpl_dict_t **headersp);
@@ -50,10 +60,13 @@ dpl_status_t dpl_s3_add_authorization_to_headers(const dpl_req_t *, dpl_dict_t *
 dpl_status_t dpl_s3_add_authorization_v2_to_headers(const dpl_req_t *, dpl_dict_t *,
                                                     const dpl_dict_t *, struct tm *);
 dpl_status_t dpl_s3_get_authorization_v2_params(const dpl_req_t *, dpl_dict_t *, struct tm *);
+dpl_status_t dpl_s3_presign_v2(dpl_ctx_t *ctx, const dpl_hmac_key_t *hkey, const char *bucket, const char *resource_ue, char *expires_str, char *signature_ue);
 
 /* src/s3/auth/v4.c */
 dpl_status_t dpl_s3_add_authorization_v4_to_headers(const dpl_req_t *, dpl_dict_t *,
                                                     const dpl_dict_t *, struct tm *);
 dpl_status_t dpl_s3_get_authorization_v4_params(const dpl_req_t *, dpl_dict_t *, struct tm *);
+dpl_status_t dpl_s3_presign_v4_init(dpl_ctx_t *ctx, time_t expires, struct tm *i_tm, dpl_s3_presign_v4_t *ps);
+dpl_status_t dpl_s3_presign_v4(const dpl_ctx_t *ctx, const dpl_s3_presign_v4_t *ps, const char *host, const char *resource_ue, char *signature);
 
 #endif
@@ -195,6 +195,19 @@ int dpl_base64_init(void);
 #define DPL_BASE64_LENGTH(len) (((len) + 2) / 3 * 4)
 #define DPL_BASE64_ORIG_LENGTH(len) (((len) + 3) / 4 * 3)
 
+/*
+ * HMAC key with precomputed inner and outer hash states
+ */
+typedef struct
+{
+  int sha256;                   /*!< else SHA1 */
+  union
+  {
+    SHA_CTX sha1;
+    SHA256_CTX sha256;
+  } inner, outer;
+} dpl_hmac_key_t;
+
 #define DPL_HEX_LENGTH(len) ((len) * 2)
 #define DPL_URL_LENGTH(len) ((len)*3+1)
 #define DPL_BCD_LENGTH(len) (2*(len))
@@ -238,6 +251,7 @@ size_t dpl_iov_size(struct iovec *iov, int n_iov);
 void dpl_iov_dump(struct iovec *iov, int n_iov, size_t n_bytes, int binary);
 time_t dpl_iso8601totime(const char *str);
 dpl_status_t dpl_timetoiso8601(time_t t, char *buf, int buf_size);
+dpl_status_t dpl_parse_size(const char *str, uint64_t *sizep);
 char *dpl_strrstr(const char *haystack, const char *needle);
 void test_strrstr(void);
 void dpl_strlower(char *str);
@@ -245,6 +259,9 @@ unsigned int dpl_hmac(const char *key_buf, unsigned int key_len, const char *dat
 unsigned int dpl_hmac_sha1(const char *key_buf, unsigned int key_len, const char *data_buf, unsigned int data_len, char *digest_buf);
 unsigned int dpl_hmac_sha256(const char *key_buf, unsigned int key_len, const char *data_buf, unsigned int data_len, char *digest_buf);
 void dpl_sha256(const uint8_t *, size_t, uint8_t *);
+void dpl_md5_sha256(const uint8_t *data_buf, size_t data_len, uint8_t *md5_buf, uint8_t *sha256_buf);
+void dpl_hmac_key_init(dpl_hmac_key_t *hkey, const char *key_buf, unsigned int key_len, int sha256);
+unsigned int dpl_hmac_key_sign(const dpl_hmac_key_t *hkey, const char *data_buf, unsigned int data_len, char *digest_buf);
 u_int dpl_base64_encode(const u_char *in_buf, u_int in_len, u_char *out_buf);
 u_int dpl_base64_decode(const u_char *in_buf, u_int in_len, u_char *out_buf);
 size_t dpl_url_encode(const char *str, char *str_ue);
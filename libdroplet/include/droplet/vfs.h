@@ -56,6 +56,9 @@ typedef struct
   dpl_vec_t *directories;
   int files_cursor;
   int directories_cursor;
+  char *bucket;
+  struct dpl_dir_page *next_page;   /*!< being prefetched, NULL after the last page */
+  struct dpl_task_pool *pool;
 } dpl_dir_t;
 
 typedef struct
@@ -67,6 +70,47 @@ typedef struct
   size_t size;
 } dpl_dirent_t;
 
+/*
+ * walk
+ */
+#ifndef __cplusplus
+typedef enum
+#else
+enum
+#endif
+  {
+    DPL_WALK_PREORDER =  (1u<<0),     /*!< report directories before their content (default) */
+    DPL_WALK_POSTORDER = (1u<<1),     /*!< report directories after their content */
+    DPL_WALK_FLAT =      (1u<<2),     /*!< list the subtree in one scan without delimiter */
+#ifndef __cplusplus
+  } dpl_walk_flag_t;
+#else
+  };
+
+typedef unsigned int dpl_walk_flag_t;
+#endif
+
+typedef enum
+  {
+    DPL_WALK_VISIT_FILE,              /*!< non-directory entry */
+    DPL_WALK_VISIT_PRE,               /*!< directory, before its content */
+    DPL_WALK_VISIT_POST,              /*!< directory, after its content */
+  } dpl_walk_visit_t;
+
+typedef struct
+{
+  int max_depth;                      /*!< -1 for no limit, 1 for the root content only */
+  const char *prefix;                 /*!< only report entries whose path, relative to the root, starts with it */
+} dpl_walk_params_t;
+
+/**
+ * walk callback, never called concurrently
+ *
+ * @return 0 to continue, 1 to skip the content of a directory (on
+ * DPL_WALK_VISIT_PRE), -1 to abort the walk
+ */
+typedef int (*dpl_walk_func_t)(dpl_dirent_t *dirent, int depth, dpl_walk_visit_t visit, void *cb_arg);
+
 /*
  * vfile
  */
@@ -82,6 +126,7 @@ enum
     DPL_VFILE_FLAG_WRONLY =  (1u<<3),     /*!< open in write-only mode */
     DPL_VFILE_FLAG_RDWR =    (1u<<4),     /*!< open in read-write mode */
     DPL_VFILE_FLAG_STREAM =  (1u<<5),     /*!< open in stream mode (required for read/append) */
+    DPL_VFILE_FLAG_RANDOM =  (1u<<6),     /*!< random access, disables read-ahead */
 #ifndef __cplusplus
   } dpl_vfile_flag_t;
 #else
@@ -102,6 +147,8 @@ typedef struct
   dpl_sysmd_t *sysmd;
   dpl_dict_t *query_params;
   dpl_stream_t *stream;
+  struct dpl_readahead *readahead;
+  struct dpl_writeback *writeback;
 } dpl_vfile_t;
 
 /* PROTO vfs.c */
@@ -110,6 +157,10 @@ dpl_status_t dpl_opendir(dpl_ctx_t *ctx, const char *locator, void **dir_hdlp);
 dpl_status_t dpl_opendir_attrs(dpl_ctx_t *ctx, const char *locator, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, void **dir_hdlp);
 dpl_status_t dpl_readdir(void *dir_hdl, dpl_dirent_t *dirent);
 dpl_status_t dpl_iterate(dpl_ctx_t *ctx, const char *locator, int (* cb)(dpl_dirent_t *dirent, void *ctx), void *cb_ctx);
+dpl_status_t dpl_walk(dpl_ctx_t *ctx, const char *root, dpl_walk_flag_t flags, const dpl_walk_params_t *params, dpl_walk_func_t cb, void *cb_arg, int n_parallel);
+dpl_status_t dpl_du(dpl_ctx_t *ctx, const char *locator, uint64_t *sizep, uint64_t *n_filesp, uint64_t *n_dirsp);
+dpl_status_t dpl_rmdir_recursive(dpl_ctx_t *ctx, const char *locator);
+dpl_status_t dpl_fcopy_recursive(dpl_ctx_t *ctx, const char *src_locator, const char *dst_locator);
 int dpl_eof(void *dir_hdl);
 void dpl_closedir(void *dir_hdl);
 dpl_status_t dpl_chdir(dpl_ctx_t *ctx, const char *locator);
@@ -75,6 +75,14 @@
 #include <droplet/dbuf.h>
 #include <droplet/ntinydb.h>
 #include <droplet/task.h>
+#include <droplet/dcache.h>
+#include <droplet/acache.h>
+#include <droplet/retry.h>
+#include <droplet/ratelimit.h>
+#include <droplet/hedge.h>
+#include <droplet/crypt.h>
+#include <droplet/compress.h>
+#include <droplet/vdir.h>
 
 #define UNUSED  __attribute__((__unused__))
 #define PRINTF(idx, chk) __attribute__((format (printf, idx, chk)))
@@ -0,0 +1,523 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+#include <droplet/queue.h>
+
+/** @file */
+
+/*
+ * Attribute cache: remembers the outcome of the HEAD issued by
+ * dpl_getattr(), that is the system metadata and the user metadata of
+ * an object, or the fact that it does not exist (negative entries).
+ *
+ * Entries are keyed by "bucket:fqn", the fqn without leading slashes
+ * but with its trailing one, as "dir" and "dir/" are distinct objects.
+ */
+
+#define ACACHE_N_BUCKETS 4093
+
+struct acache_entry
+{
+  struct acache_entry *next;            /*!< hash chain */
+  TAILQ_ENTRY(acache_entry) lru;
+  char *key;
+  dpl_sysmd_t *sysmd;                   /*!< NULL for negative entries */
+  dpl_dict_t *metadata;
+  time_t expire;
+};
+
+TAILQ_HEAD(acache_lru, acache_entry);
+
+struct dpl_acache
+{
+  pthread_mutex_t lock;
+  struct acache_entry *buckets[ACACHE_N_BUCKETS];
+  struct acache_lru lru;                /*!< most recently used first */
+  int n_entries;
+  dpl_acache_stats_t stats;
+};
+
+static u_int
+acache_hashcode(const char *s)
+{
+  const char *p;
+  u_int h, g;
+
+  h = g = 0;
+
+  for (p = s;*p;p++)
+    {
+      h = (h<<4)+(*p);
+      if ((g = h&0xf0000000))
+        {
+          h = h^(g>>24);
+          h = h^g;
+        }
+    }
+
+  return h;
+}
+
+static int
+acache_make_key(char *key,
+                size_t key_size,
+                const char *bucket,
+                const char *path)
+{
+  int len;
+
+  while ('/' == *path)
+    path++;
+
+  len = snprintf(key, key_size, "%s:%s", bucket, path);
+  if (len < 0 || (size_t) len >= key_size)
+    return -1;
+
+  return 0;
+}
+
+static void
+acache_entry_free(struct acache_entry *entry)
+{
+  free(entry->key);
+  free(entry->sysmd);
+  if (NULL != entry->metadata)
+    dpl_dict_free(entry->metadata);
+  free(entry);
+}
+
+static struct acache_entry *
+acache_get_nolock(struct dpl_acache *acache,
+                  const char *key)
+{
+  struct acache_entry *entry;
+
+  for (entry = acache->buckets[acache_hashcode(key) % ACACHE_N_BUCKETS];
+       entry;entry = entry->next)
+    {
+      if (!strcmp(entry->key, key))
+        return entry;
+    }
+
+  return NULL;
+}
+
+static void
+acache_remove_nolock(struct dpl_acache *acache,
+                     struct acache_entry *entry)
+{
+  struct acache_entry **prev;
+
+  prev = &acache->buckets[acache_hashcode(entry->key) % ACACHE_N_BUCKETS];
+  while (*prev != entry)
+    prev = &(*prev)->next;
+  *prev = entry->next;
+
+  TAILQ_REMOVE(&acache->lru, entry, lru);
+  acache->n_entries--;
+
+  acache_entry_free(entry);
+}
+
+static void
+acache_remove_key_nolock(struct dpl_acache *acache,
+                         const char *key)
+{
+  struct acache_entry *entry;
+
+  entry = acache_get_nolock(acache, key);
+  if (NULL != entry)
+    {
+      acache_remove_nolock(acache, entry);
+      acache->stats.invalidations++;
+    }
+}
+
+/**
+ * allocate the attribute cache of the context, if enabled by the profile
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_acache_init(dpl_ctx_t *ctx)
+{
+  struct dpl_acache *acache;
+
+  ctx->acache = NULL;
+
+  if (ctx->acache_ttl <= 0 && ctx->acache_negative_ttl <= 0)
+    return DPL_SUCCESS;
+
+  acache = calloc(1, sizeof (*acache));
+  if (NULL == acache)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&acache->lock, NULL);
+  TAILQ_INIT(&acache->lru);
+
+  ctx->acache = acache;
+
+  return DPL_SUCCESS;
+}
+
+void
+dpl_acache_free(dpl_ctx_t *ctx)
+{
+  struct dpl_acache *acache = ctx->acache;
+
+  if (NULL == acache)
+    return;
+
+  dpl_acache_purge(ctx);
+  pthread_mutex_destroy(&acache->lock);
+  free(acache);
+  ctx->acache = NULL;
+}
+
+int
+dpl_acache_enabled(dpl_ctx_t *ctx)
+{
+  return NULL != ctx->acache;
+}
+
+/**
+ * lookup the attributes of an object
+ *
+ * @param ctx
+ * @param bucket
+ * @param path fqn of the object
+ * @param metadatap filled with a copy on positive hit, may be NULL
+ * @param sysmdp filled on positive hit, may be NULL
+ * @param retp DPL_SUCCESS, DPL_ENOENT or DPL_ENOMEM on hit
+ *
+ * @return 1 on hit, 0 on miss
+ */
+int
+dpl_acache_lookup(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *path,
+                  dpl_dict_t **metadatap,
+                  dpl_sysmd_t *sysmdp,
+                  dpl_status_t *retp)
+{
+  struct dpl_acache *acache = ctx->acache;
+  struct acache_entry *entry;
+  char key[DPL_MAXNAMLEN + DPL_MAXPATHLEN];
+  int hit = 0;
+
+  if (NULL == acache)
+    return 0;
+
+  if (-1 == acache_make_key(key, sizeof (key), bucket, path))
+    return 0;
+
+  pthread_mutex_lock(&acache->lock);
+
+  entry = acache_get_nolock(acache, key);
+  if (NULL == entry)
+    {
+      acache->stats.misses++;
+      goto end;
+    }
+
+  if (entry->expire <= time(NULL))
+    {
+      acache_remove_nolock(acache, entry);
+      acache->stats.misses++;
+      acache->stats.expired++;
+      goto end;
+    }
+
+  TAILQ_REMOVE(&acache->lru, entry, lru);
+  TAILQ_INSERT_HEAD(&acache->lru, entry, lru);
+
+  if (NULL == entry->sysmd)
+    {
+      acache->stats.negative_hits++;
+      *retp = DPL_ENOENT;
+    }
+  else
+    {
+      acache->stats.hits++;
+      *retp = DPL_SUCCESS;
+      if (NULL != sysmdp)
+        *sysmdp = *entry->sysmd;
+      if (NULL != metadatap)
+        {
+          *metadatap = dpl_dict_dup(entry->metadata);
+          if (NULL == *metadatap)
+            *retp = DPL_ENOMEM;
+        }
+    }
+
+  hit = 1;
+
+ end:
+  pthread_mutex_unlock(&acache->lock);
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "acache %s %s", hit ? "hit" : "miss", key);
+
+  return hit;
+}
+
+/**
+ * record the attributes of an object
+ *
+ * @param ctx
+ * @param bucket
+ * @param path fqn of the object
+ * @param metadata copied, ignored if sysmd is NULL
+ * @param sysmd NULL records a negative entry
+ */
+void
+dpl_acache_insert(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *path,
+                  const dpl_dict_t *metadata,
+                  const dpl_sysmd_t *sysmd)
+{
+  struct dpl_acache *acache = ctx->acache;
+  struct acache_entry *entry, **bucketp;
+  char key[DPL_MAXNAMLEN + DPL_MAXPATHLEN];
+  dpl_sysmd_t *nsysmd = NULL;
+  dpl_dict_t *nmetadata = NULL;
+  int ttl;
+
+  if (NULL == acache)
+    return;
+
+  ttl = (NULL != sysmd) ? ctx->acache_ttl : ctx->acache_negative_ttl;
+  if (ttl <= 0)
+    return;
+
+  if (-1 == acache_make_key(key, sizeof (key), bucket, path))
+    return;
+
+  if (NULL != sysmd)
+    {
+      nsysmd = malloc(sizeof (*nsysmd));
+      if (NULL == nsysmd)
+        return;
+      *nsysmd = *sysmd;
+
+      nmetadata = (NULL != metadata) ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+      if (NULL == nmetadata)
+        {
+          free(nsysmd);
+          return;
+        }
+    }
+
+  pthread_mutex_lock(&acache->lock);
+
+  entry = acache_get_nolock(acache, key);
+  if (NULL != entry)
+    {
+      free(entry->sysmd);
+      if (NULL != entry->metadata)
+        dpl_dict_free(entry->metadata);
+      entry->sysmd = nsysmd;
+      entry->metadata = nmetadata;
+      entry->expire = time(NULL) + ttl;
+      TAILQ_REMOVE(&acache->lru, entry, lru);
+      TAILQ_INSERT_HEAD(&acache->lru, entry, lru);
+      acache->stats.inserts++;
+      goto end;
+    }
+
+  entry = calloc(1, sizeof (*entry));
+  if (NULL != entry)
+    entry->key = strdup(key);
+  if (NULL == entry || NULL == entry->key)
+    {
+      free(entry);
+      free(nsysmd);
+      if (NULL != nmetadata)
+        dpl_dict_free(nmetadata);
+      goto end;
+    }
+  entry->sysmd = nsysmd;
+  entry->metadata = nmetadata;
+  entry->expire = time(NULL) + ttl;
+
+  while (ctx->acache_max_entries > 0 &&
+         acache->n_entries >= ctx->acache_max_entries)
+    {
+      acache_remove_nolock(acache, TAILQ_LAST(&acache->lru, acache_lru));
+      acache->stats.evictions++;
+    }
+
+  bucketp = &acache->buckets[acache_hashcode(key) % ACACHE_N_BUCKETS];
+  entry->next = *bucketp;
+  *bucketp = entry;
+  TAILQ_INSERT_HEAD(&acache->lru, entry, lru);
+  acache->n_entries++;
+  acache->stats.inserts++;
+
+ end:
+  pthread_mutex_unlock(&acache->lock);
+}
+
+/**
+ * forget about an object which is about to be, or has been, modified
+ *
+ * both the "name" and "name/" objects are dropped, as well as all the
+ * ancestors since creating or removing an object may implicitly create
+ * or remove its parent directories.  If path designates a directory
+ * (trailing slash) then everything below it is dropped too.
+ *
+ * @param ctx
+ * @param bucket
+ * @param path fqn of the object
+ */
+void
+dpl_acache_invalidate(dpl_ctx_t *ctx,
+                      const char *bucket,
+                      const char *path)
+{
+  struct dpl_acache *acache = ctx->acache;
+  struct acache_entry *entry, *tmp;
+  char key[DPL_MAXNAMLEN + DPL_MAXPATHLEN + 1];
+  size_t key_len, bucket_len;
+  int is_dir = 0;
+  char *p;
+
+  if (NULL == acache)
+    return;
+
+  if (-1 == acache_make_key(key, sizeof (key) - 1, bucket, path))
+    {
+      dpl_acache_purge(ctx);
+      return;
+    }
+
+  bucket_len = strlen(bucket) + 1;
+  key_len = strlen(key);
+  if (key_len == bucket_len)
+    is_dir = 1;
+  while (key_len > bucket_len && '/' == key[key_len - 1])
+    {
+      key[--key_len] = 0;
+      is_dir = 1;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "acache invalidate %s", key);
+
+  pthread_mutex_lock(&acache->lock);
+
+  if (is_dir)
+    {
+      TAILQ_FOREACH_SAFE(entry, &acache->lru, lru, tmp)
+        {
+          if (!strncmp(entry->key, key, key_len) &&
+              (key_len == bucket_len || '/' == entry->key[key_len]))
+            {
+              acache_remove_nolock(acache, entry);
+              acache->stats.invalidations++;
+            }
+        }
+    }
+
+  //the bucket root itself, then each ancestor with and without slash
+  for (;;)
+    {
+      acache_remove_key_nolock(acache, key);
+      if (key_len > bucket_len)
+        {
+          key[key_len] = '/';
+          key[key_len + 1] = 0;
+          acache_remove_key_nolock(acache, key);
+          key[key_len] = 0;
+        }
+
+      if (key_len <= bucket_len)
+        break ;
+
+      p = rindex(key + bucket_len, '/');
+      if (NULL == p)
+        p = key + bucket_len;
+      *p = 0;
+      key_len = p - key;
+    }
+
+  pthread_mutex_unlock(&acache->lock);
+}
+
+/**
+ * drop all the entries, e.g. when the bucket was modified by a third party
+ *
+ * @param ctx
+ */
+void
+dpl_acache_purge(dpl_ctx_t *ctx)
+{
+  struct dpl_acache *acache = ctx->acache;
+  struct acache_entry *entry;
+
+  if (NULL == acache)
+    return;
+
+  pthread_mutex_lock(&acache->lock);
+
+  while (NULL != (entry = TAILQ_FIRST(&acache->lru)))
+    acache_remove_nolock(acache, entry);
+
+  pthread_mutex_unlock(&acache->lock);
+}
+
+/**
+ * get the counters of the attribute cache, all zero if it is disabled
+ *
+ * @param ctx
+ * @param statsp
+ */
+void
+dpl_acache_get_stats(dpl_ctx_t *ctx,
+                     dpl_acache_stats_t *statsp)
+{
+  struct dpl_acache *acache = ctx->acache;
+
+  memset(statsp, 0, sizeof (*statsp));
+
+  if (NULL == acache)
+    return;
+
+  pthread_mutex_lock(&acache->lock);
+  *statsp = acache->stats;
+  statsp->n_entries = acache->n_entries;
+  pthread_mutex_unlock(&acache->lock);
+}
@@ -464,6 +464,64 @@ dpl_addrlist_unblacklist(dpl_addrlist_t *addrlist,
   return DPL_SUCCESS;
 }
 
+/**
+ * @brief Account for the time a host took to answer a request.
+ *
+ * The latency kept is a moving average over roughly the last 8 replies.
+ *
+ * @param addrlist a bootstrap list.
+ * @param host a string corresponding to the hostname or IP address
+ * @param portstr a string containing the port number
+ * @param usec time from the request to the reply status line
+ */
+
+void
+dpl_addrlist_record_latency(dpl_addrlist_t *addrlist,
+                            const char *host,
+                            const char *portstr,
+                            uint64_t usec)
+{
+  dpl_addr_t *addr;
+
+  if (addrlist == NULL)
+    return;
+
+  dpl_addrlist_lock(addrlist);
+
+  addr = dpl_addrlist_get_byname_nolock(addrlist, host, portstr);
+  if (addr != NULL) {
+    if (addr->n_replies == 0)
+      addr->latency_usec = usec;
+    else
+      addr->latency_usec = (addr->latency_usec * 7 + usec) / 8;
+    addr->n_replies++;
+  }
+
+  dpl_addrlist_unlock(addrlist);
+}
+
+/**
+ * @brief Get the average reply latency of a host.
+ *
+ * @param addrlist a bootstrap list.
+ * @param addr an entry of the list
+ *
+ * @return the latency in microseconds, 0 if the host never replied
+ */
+
+uint64_t
+dpl_addrlist_get_latency(dpl_addrlist_t *addrlist,
+                         dpl_addr_t *addr)
+{
+  uint64_t usec;
+
+  dpl_addrlist_lock(addrlist);
+  usec = addr->latency_usec;
+  dpl_addrlist_unlock(addrlist);
+
+  return usec;
+}
+
 /**
  * @brief Refresh the bootstrap list blacklist by un-blacklisting
  * expired entries.
@@ -33,6 +33,7 @@
  */
 #include "dropletp.h"
 #include "droplet/async.h"
+#include "droplet/vfs.h"
 
 /** @file */
 
@@ -91,6 +92,68 @@ dpl_buf_release(dpl_buf_t *buf)
     }
 }
 
+static void
+locators_free(dpl_locators_t *locators)
+{
+  unsigned int i;
+
+  if (NULL != locators->tab)
+    {
+      for (i = 0;i < locators->size;i++)
+        {
+          FREE_IF_NOT_NULL(locators->tab[i].name);
+          FREE_IF_NOT_NULL(locators->tab[i].version_id);
+        }
+      free(locators->tab);
+    }
+  free(locators);
+}
+
+static dpl_locators_t *
+locators_dup(const dpl_locators_t *src)
+{
+  dpl_locators_t *dst = NULL;
+  unsigned int i;
+
+  dst = calloc(1, sizeof (*dst));
+  if (NULL == dst)
+    goto bad;
+
+  if (0 != src->size)
+    {
+      dst->tab = calloc(src->size, sizeof (dpl_locator_t));
+      if (NULL == dst->tab)
+        goto bad;
+    }
+  dst->size = src->size;
+
+  for (i = 0;i < src->size;i++)
+    {
+      dst->tab[i].type = src->tab[i].type;
+      if (NULL != src->tab[i].name)
+        {
+          dst->tab[i].name = strdup(src->tab[i].name);
+          if (NULL == dst->tab[i].name)
+            goto bad;
+        }
+      if (NULL != src->tab[i].version_id)
+        {
+          dst->tab[i].version_id = strdup(src->tab[i].version_id);
+          if (NULL == dst->tab[i].version_id)
+            goto bad;
+        }
+    }
+
+  return dst;
+
+ bad:
+
+  if (NULL != dst)
+    locators_free(dst);
+
+  return NULL;
+}
+
 void
 dpl_async_task_free(dpl_async_task_t *task)
 {
@@ -221,6 +284,109 @@ dpl_async_task_free(dpl_async_task_t *task)
         dpl_condition_free(task->u.copy.condition);
       /* output */
       break ;
+    case DPL_TASK_LIST_BUCKET_ATTRS:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.list_bucket_attrs.bucket);
+      FREE_IF_NOT_NULL(task->u.list_bucket_attrs.prefix);
+      FREE_IF_NOT_NULL(task->u.list_bucket_attrs.delimiter);
+      /* output */
+      if (NULL != task->u.list_bucket_attrs.metadata)
+        dpl_dict_free(task->u.list_bucket_attrs.metadata);
+      if (NULL != task->u.list_bucket_attrs.objects)
+        dpl_vec_objects_free(task->u.list_bucket_attrs.objects);
+      if (NULL != task->u.list_bucket_attrs.common_prefixes)
+        dpl_vec_common_prefixes_free(task->u.list_bucket_attrs.common_prefixes);
+      break ;
+    case DPL_TASK_DELETE_ALL:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.delete_all.bucket);
+      if (NULL != task->u.delete_all.locators)
+        locators_free(task->u.delete_all.locators);
+      if (NULL != task->u.delete_all.option)
+        dpl_option_free(task->u.delete_all.option);
+      if (NULL != task->u.delete_all.condition)
+        dpl_condition_free(task->u.delete_all.condition);
+      /* output */
+      if (NULL != task->u.delete_all.objects)
+        dpl_vec_delete_objects_free(task->u.delete_all.objects);
+      break ;
+    case DPL_TASK_STREAM_GET:
+      /* input */
+      /* output */
+      if (NULL != task->u.stream_get.buf)
+        dpl_buf_release(task->u.stream_get.buf);
+      if (NULL != task->u.stream_get.status)
+        json_object_put(task->u.stream_get.status);
+      break ;
+    case DPL_TASK_STREAM_PUT:
+      /* input */
+      if (NULL != task->u.stream_put.buf)
+        dpl_buf_release(task->u.stream_put.buf);
+      /* output */
+      if (NULL != task->u.stream_put.status)
+        json_object_put(task->u.stream_put.status);
+      break ;
+    case DPL_TASK_GETATTR:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.getattr.locator);
+      /* output */
+      if (NULL != task->u.getattr.metadata)
+        dpl_dict_free(task->u.getattr.metadata);
+      break ;
+    case DPL_TASK_FPUT:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.fput.locator);
+      if (NULL != task->u.fput.option)
+        dpl_option_free(task->u.fput.option);
+      if (NULL != task->u.fput.condition)
+        dpl_condition_free(task->u.fput.condition);
+      if (NULL != task->u.fput.range)
+        dpl_range_free(task->u.fput.range);
+      if (NULL != task->u.fput.metadata)
+        dpl_dict_free(task->u.fput.metadata);
+      if (NULL != task->u.fput.sysmd)
+        dpl_sysmd_free(task->u.fput.sysmd);
+      if (NULL != task->u.fput.buf)
+        dpl_buf_release(task->u.fput.buf);
+      /* output */
+      break ;
+    case DPL_TASK_FGET:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.fget.locator);
+      if (NULL != task->u.fget.option)
+        dpl_option_free(task->u.fget.option);
+      if (NULL != task->u.fget.condition)
+        dpl_condition_free(task->u.fget.condition);
+      if (NULL != task->u.fget.range)
+        dpl_range_free(task->u.fget.range);
+      /* output */
+      if (NULL != task->u.fget.metadata)
+        dpl_dict_free(task->u.fget.metadata);
+      if (NULL != task->u.fget.buf)
+        dpl_buf_release(task->u.fget.buf);
+      break ;
+    case DPL_TASK_MKDIR:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.mkdir.locator);
+      if (NULL != task->u.mkdir.metadata)
+        dpl_dict_free(task->u.mkdir.metadata);
+      if (NULL != task->u.mkdir.sysmd)
+        dpl_sysmd_free(task->u.mkdir.sysmd);
+      /* output */
+      break ;
+    case DPL_TASK_RMDIR:
+    case DPL_TASK_UNLINK:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.unlink.locator);
+      /* output */
+      break ;
+    case DPL_TASK_FCOPY:
+    case DPL_TASK_RENAME:
+      /* input */
+      FREE_IF_NOT_NULL(task->u.rename.src_locator);
+      FREE_IF_NOT_NULL(task->u.rename.dst_locator);
+      /* output */
+      break ;
     }
   free(task);
 }
@@ -413,6 +579,107 @@ async_do(void *arg)
                               task->u.copy.sysmd,
                               task->u.copy.condition);
       break ;
+    case DPL_TASK_LIST_BUCKET_ATTRS:
+      task->ret = dpl_list_bucket_attrs(task->ctx,
+                                        task->u.list_bucket_attrs.bucket,
+                                        task->u.list_bucket_attrs.prefix,
+                                        task->u.list_bucket_attrs.delimiter,
+                                        task->u.list_bucket_attrs.max_keys,
+                                        &task->u.list_bucket_attrs.metadata,
+                                        &task->u.list_bucket_attrs.sysmd,
+                                        &task->u.list_bucket_attrs.objects,
+                                        &task->u.list_bucket_attrs.common_prefixes);
+      break ;
+    case DPL_TASK_DELETE_ALL:
+      task->ret = dpl_delete_all(task->ctx,
+                                 task->u.delete_all.bucket,
+                                 task->u.delete_all.locators,
+                                 task->u.delete_all.option,
+                                 task->u.delete_all.condition,
+                                 &task->u.delete_all.objects);
+      break ;
+    case DPL_TASK_STREAM_GET:
+      task->u.stream_get.buf = dpl_buf_new();
+      if (NULL == task->u.stream_get.buf)
+        {
+          task->ret = DPL_ENOMEM;
+          break ;
+        }
+      dpl_buf_acquire(task->u.stream_get.buf);
+      task->ret = dpl_stream_get(task->ctx,
+                                 task->u.stream_get.stream,
+                                 task->u.stream_get.len,
+                                 &dpl_buf_ptr(task->u.stream_get.buf),
+                                 &dpl_buf_size(task->u.stream_get.buf),
+                                 &task->u.stream_get.status);
+      break ;
+    case DPL_TASK_STREAM_PUT:
+      task->ret = dpl_stream_put(task->ctx,
+                                 task->u.stream_put.stream,
+                                 NULL != task->u.stream_put.buf ? dpl_buf_ptr(task->u.stream_put.buf) : NULL,
+                                 NULL != task->u.stream_put.buf ? dpl_buf_size(task->u.stream_put.buf) : 0,
+                                 &task->u.stream_put.status);
+      break ;
+    case DPL_TASK_GETATTR:
+      task->ret = dpl_getattr(task->ctx,
+                              task->u.getattr.locator,
+                              &task->u.getattr.metadata,
+                              &task->u.getattr.sysmd);
+      break ;
+    case DPL_TASK_FPUT:
+      task->ret = dpl_fput(task->ctx,
+                           task->u.fput.locator,
+                           task->u.fput.option,
+                           task->u.fput.condition,
+                           task->u.fput.range,
+                           task->u.fput.metadata,
+                           task->u.fput.sysmd,
+                           NULL != task->u.fput.buf ? dpl_buf_ptr(task->u.fput.buf) : NULL,
+                           NULL != task->u.fput.buf ? dpl_buf_size(task->u.fput.buf) : 0);
+      break ;
+    case DPL_TASK_FGET:
+      task->u.fget.buf = dpl_buf_new();
+      if (NULL == task->u.fget.buf)
+        {
+          task->ret = DPL_ENOMEM;
+          break ;
+        }
+      dpl_buf_acquire(task->u.fget.buf);
+      task->ret = dpl_fget(task->ctx,
+                           task->u.fget.locator,
+                           task->u.fget.option,
+                           task->u.fget.condition,
+                           task->u.fget.range,
+                           &dpl_buf_ptr(task->u.fget.buf),
+                           &dpl_buf_size(task->u.fget.buf),
+                           &task->u.fget.metadata,
+                           &task->u.fget.sysmd);
+      break ;
+    case DPL_TASK_MKDIR:
+      task->ret = dpl_mkdir(task->ctx,
+                            task->u.mkdir.locator,
+                            task->u.mkdir.metadata,
+                            task->u.mkdir.sysmd);
+      break ;
+    case DPL_TASK_RMDIR:
+      task->ret = dpl_rmdir(task->ctx,
+                            task->u.unlink.locator);
+      break ;
+    case DPL_TASK_UNLINK:
+      task->ret = dpl_unlink(task->ctx,
+                             task->u.unlink.locator);
+      break ;
+    case DPL_TASK_FCOPY:
+      task->ret = dpl_fcopy(task->ctx,
+                            task->u.rename.src_locator,
+                            task->u.rename.dst_locator);
+      break ;
+    case DPL_TASK_RENAME:
+      task->ret = dpl_rename(task->ctx,
+                             task->u.rename.src_locator,
+                             task->u.rename.dst_locator,
+                             task->u.rename.object_type);
+      break ;
     }
   if (NULL != task->cb_func)
     task->cb_func(task->cb_arg);
@@ -1287,4 +1554,480 @@ dpl_copy_id_async_prepare(dpl_ctx_t *ctx,
   return NULL;
 }
 
+/**
+ * list bucket or directory and fetch the attributes of the prefix
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix directory can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param max_keys maximum number of entries, -1 for no limit
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_list_bucket_attrs_async_prepare(dpl_ctx_t *ctx,
+                                    const char *bucket,
+                                    const char *prefix,
+                                    const char *delimiter,
+                                    int max_keys)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_LIST_BUCKET_ATTRS;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.list_bucket_attrs, bucket);
+  DUP_IF_NOT_NULL(task->u.list_bucket_attrs, prefix);
+  DUP_IF_NOT_NULL(task->u.list_bucket_attrs, delimiter);
+  task->u.list_bucket_attrs.max_keys = max_keys;
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * delete multiple resources in one request
+ *
+ * @note the locators are deep copied
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param locators the resources to delete
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param condition the optional condition
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_delete_all_async_prepare(dpl_ctx_t *ctx,
+                             const char *bucket,
+                             const dpl_locators_t *locators,
+                             const dpl_option_t *option,
+                             const dpl_condition_t *condition)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_DELETE_ALL;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.delete_all, bucket);
+  if (NULL != locators)
+    {
+      task->u.delete_all.locators = locators_dup(locators);
+      if (NULL == task->u.delete_all.locators)
+        goto bad;
+    }
+  if (NULL != option)
+    task->u.delete_all.option = dpl_option_dup(option);
+  if (NULL != condition)
+    task->u.delete_all.condition = dpl_condition_dup(condition);
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * read the next chunk of a stream
+ *
+ * @note the stream is not owned by the task and must not be used
+ * concurrently by another task
+ *
+ * @param ctx the droplet context
+ * @param stream an opened stream
+ * @param len the maximum number of bytes to read
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_stream_get_async_prepare(dpl_ctx_t *ctx,
+                             dpl_stream_t *stream,
+                             unsigned int len)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_STREAM_GET;
+  task->task.func = async_do;
+  task->u.stream_get.stream = stream;
+  task->u.stream_get.len = len;
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * write the next chunk of a stream
+ *
+ * @note the stream is not owned by the task and must not be used
+ * concurrently by another task
+ *
+ * @param ctx the droplet context
+ * @param stream an opened stream
+ * @param buf the data buffer
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_stream_put_async_prepare(dpl_ctx_t *ctx,
+                             dpl_stream_t *stream,
+                             dpl_buf_t *buf)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_STREAM_PUT;
+  task->task.func = async_do;
+  task->u.stream_put.stream = stream;
+  if (NULL != buf)
+    {
+      task->u.stream_put.buf = buf;
+      dpl_buf_acquire(buf);
+    }
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * get the attributes of a path
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_getattr_async_prepare(dpl_ctx_t *ctx,
+                          const char *locator)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_GETATTR;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.getattr, locator);
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * put a file through the VFS layer
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param condition the optional condition
+ * @param range optional range
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
+ * @param buf the data buffer
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_fput_async_prepare(dpl_ctx_t *ctx,
+                       const char *locator,
+                       const dpl_option_t *option,
+                       const dpl_condition_t *condition,
+                       const dpl_range_t *range,
+                       const dpl_dict_t *metadata,
+                       const dpl_sysmd_t *sysmd,
+                       dpl_buf_t *buf)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_FPUT;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.fput, locator);
+  if (NULL != option)
+    task->u.fput.option = dpl_option_dup(option);
+  if (NULL != condition)
+    task->u.fput.condition = dpl_condition_dup(condition);
+  if (NULL != range)
+    task->u.fput.range = dpl_range_dup(range);
+  if (NULL != metadata)
+    task->u.fput.metadata = dpl_dict_dup(metadata);
+  if (NULL != sysmd)
+    task->u.fput.sysmd = dpl_sysmd_dup(sysmd);
+  if (NULL != buf)
+    {
+      task->u.fput.buf = buf;
+      dpl_buf_acquire(buf);
+    }
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * get a file through the VFS layer
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param condition the optional condition
+ * @param range the optional range
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_fget_async_prepare(dpl_ctx_t *ctx,
+                       const char *locator,
+                       const dpl_option_t *option,
+                       const dpl_condition_t *condition,
+                       const dpl_range_t *range)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_FGET;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.fget, locator);
+  if (NULL != option)
+    task->u.fget.option = dpl_option_dup(option);
+  if (NULL != condition)
+    task->u.fget.condition = dpl_condition_dup(condition);
+  if (NULL != range)
+    task->u.fget.range = dpl_range_dup(range);
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * create a directory
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_mkdir_async_prepare(dpl_ctx_t *ctx,
+                        const char *locator,
+                        const dpl_dict_t *metadata,
+                        const dpl_sysmd_t *sysmd)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = DPL_TASK_MKDIR;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.mkdir, locator);
+  if (NULL != metadata)
+    task->u.mkdir.metadata = dpl_dict_dup(metadata);
+  if (NULL != sysmd)
+    task->u.mkdir.sysmd = dpl_sysmd_dup(sysmd);
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+static dpl_task_t *
+unlink_async_prepare(dpl_ctx_t *ctx,
+                     dpl_async_task_type_t type,
+                     const char *locator)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = type;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.unlink, locator);
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * remove an empty directory
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_rmdir_async_prepare(dpl_ctx_t *ctx,
+                        const char *locator)
+{
+  return unlink_async_prepare(ctx, DPL_TASK_RMDIR, locator);
+}
+
+/**
+ * remove a file
+ *
+ * @param ctx the droplet context
+ * @param locator the path, optionally prefixed by "bucket:"
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_unlink_async_prepare(dpl_ctx_t *ctx,
+                         const char *locator)
+{
+  return unlink_async_prepare(ctx, DPL_TASK_UNLINK, locator);
+}
+
+static dpl_task_t *
+rename_async_prepare(dpl_ctx_t *ctx,
+                     dpl_async_task_type_t type,
+                     const char *src_locator,
+                     const char *dst_locator,
+                     dpl_ftype_t object_type)
+{
+  dpl_async_task_t *task = NULL;
+
+  task = calloc(1, sizeof (*task));
+  if (NULL == task)
+    goto bad;
+
+  task->ctx = ctx;
+  task->type = type;
+  task->task.func = async_do;
+  DUP_IF_NOT_NULL(task->u.rename, src_locator);
+  DUP_IF_NOT_NULL(task->u.rename, dst_locator);
+  task->u.rename.object_type = object_type;
+
+  return (dpl_task_t *) task;
+
+ bad:
+
+  if (NULL != task)
+    dpl_async_task_free(task);
+
+  return NULL;
+}
+
+/**
+ * copy a file
+ *
+ * @param ctx the droplet context
+ * @param src_locator the source path, optionally prefixed by "bucket:"
+ * @param dst_locator the destination path, optionally prefixed by "bucket:"
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_fcopy_async_prepare(dpl_ctx_t *ctx,
+                        const char *src_locator,
+                        const char *dst_locator)
+{
+  return rename_async_prepare(ctx, DPL_TASK_FCOPY, src_locator, dst_locator, DPL_FTYPE_REG);
+}
+
+/**
+ * rename a file or a directory
+ *
+ * @param ctx the droplet context
+ * @param src_locator the source path, optionally prefixed by "bucket:"
+ * @param dst_locator the destination path, optionally prefixed by "bucket:"
+ * @param object_type type of the object
+ *
+ * @return task
+ */
+dpl_task_t *
+dpl_rename_async_prepare(dpl_ctx_t *ctx,
+                         const char *src_locator,
+                         const char *dst_locator,
+                         dpl_ftype_t object_type)
+{
+  return rename_async_prepare(ctx, DPL_TASK_RENAME, src_locator, dst_locator, object_type);
+}
+
 /* @} */
@@ -259,3 +259,48 @@ dpl_s3_get_authorization_v2_params(const dpl_req_t *req, dpl_dict_t *query_param
 
   return DPL_SUCCESS;
 }
+
+/**
+ * compute the signature of a GET URL authenticated by query string
+ *
+ * @param ctx
+ * @param hkey the secret key, prepared for HMAC-SHA1
+ * @param bucket
+ * @param resource_ue encoded resource, starting with a slash
+ * @param expires_str
+ * @param signature_ue receives the url-encoded signature
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_s3_presign_v2(dpl_ctx_t *ctx,
+                  const dpl_hmac_key_t *hkey,
+                  const char *bucket,
+                  const char *resource_ue,
+                  char *expires_str,
+                  char *signature_ue)
+{
+  dpl_status_t ret;
+  char sign_str[1024];
+  u_int sign_len;
+  char hmac_str[SHA_DIGEST_LENGTH];
+  u_int hmac_len;
+  char base64_str[DPL_BASE64_LENGTH(SHA_DIGEST_LENGTH) + 1];
+  u_int base64_len;
+
+  ret = dpl_s3_make_signature_v2(ctx, "GET", bucket, resource_ue, NULL,
+                                 expires_str, NULL,
+                                 sign_str, sizeof (sign_str), &sign_len);
+  if (ret != DPL_SUCCESS)
+    return DPL_FAILURE;
+
+  hmac_len = dpl_hmac_key_sign(hkey, sign_str, sign_len, hmac_str);
+
+  base64_len = dpl_base64_encode((const u_char *) hmac_str, hmac_len, (u_char *) base64_str);
+  base64_str[base64_len] = 0;
+
+  dpl_url_encode(base64_str, signature_ue);
+
+  return DPL_SUCCESS;
+}
@@ -47,6 +47,9 @@ add_payload_signature_to_headers(const dpl_req_t *req, dpl_dict_t *headers)
   if (var != NULL)
     return DPL_SUCCESS;
 
+  if (req->ctx->aws_unsigned_payload)
+    return dpl_dict_add(headers, "x-amz-content-sha256", "UNSIGNED-PAYLOAD", 0);
+
   if (req->data_enabled)
     dpl_sha256((uint8_t *) req->data_buf, req->data_len, digest);
   else
@@ -58,23 +61,134 @@ add_payload_signature_to_headers(const dpl_req_t *req, dpl_dict_t *headers)
   return dpl_dict_add(headers, "x-amz-content-sha256", digest_hex, 0);
 }
 
+/*
+ * a header or query parameter of the canonical request, pointing into
+ * the dict it comes from or into a caller provided buffer
+ */
+struct canonical_var
+{
+  const char    *key;
+  const char    *value;
+};
+
+/*
+ * insertion sort: requests have a handful of headers and parameters, so
+ * this is faster than qsort() and does not allocate
+ */
+static void
+sort_canonical_vars(struct canonical_var *vars, int n_vars)
+{
+  struct canonical_var  tmp;
+  int                   i, j;
+
+  for (i = 1; i < n_vars; i++) {
+    tmp = vars[i];
+    for (j = i; j > 0 && strcasecmp(vars[j - 1].key, tmp.key) > 0; j--)
+      vars[j] = vars[j - 1];
+    vars[j] = tmp;
+  }
+}
+
+static int
+get_canonical_headers(const dpl_dict_t *headers, struct canonical_var *vars)
+{
+  int                 bucket, n_vars = 0;
+  dpl_dict_var_t      *header;
+
+  for (bucket = 0; bucket < headers->n_buckets; bucket++) {
+    for (header = headers->buckets[bucket]; header != NULL; header = header->prev) {
+      assert(header->val->type == DPL_VALUE_STRING);
+
+      vars[n_vars].key = header->key;
+      vars[n_vars].value = dpl_sbuf_get_str(header->val->string);
+      n_vars++;
+    }
+  }
+
+  sort_canonical_vars(vars, n_vars);
+
+  return n_vars;
+}
+
+/*
+ * size of the buffer needed by get_canonical_params()
+ */
+static size_t
+get_canonical_params_size(const dpl_dict_t *query_params, unsigned char encode_url)
+{
+  int                 bucket;
+  dpl_dict_var_t      *param;
+  size_t              size = 0;
+
+  if (query_params == NULL || !encode_url)
+    return 0;
+
+  for (bucket = 0; bucket < query_params->n_buckets; bucket++)
+    for (param = query_params->buckets[bucket]; param != NULL; param = param->prev)
+      size += DPL_URL_LENGTH(strlen(param->key)) + 1 +
+        DPL_URL_LENGTH(strlen(dpl_sbuf_get_str(param->val->string))) + 1;
+
+  return size;
+}
+
 static int
-var_cmp(const void *p1,
-        const void *p2)
+get_canonical_params(const dpl_dict_t *query_params, unsigned char encode_url,
+                     struct canonical_var *vars, char *buf)
+{
+  int                 bucket, n_vars = 0;
+  dpl_dict_var_t      *param;
+
+  if (query_params == NULL)
+    return 0;
+
+  for (bucket = 0; bucket < query_params->n_buckets; bucket++) {
+    for (param = query_params->buckets[bucket]; param != NULL; param = param->prev) {
+      const char        *value = dpl_sbuf_get_str(param->val->string);
+
+      if (encode_url) {
+        vars[n_vars].key = buf;
+        buf += dpl_url_encode(param->key, buf) + 1;
+        vars[n_vars].value = buf;
+        buf += dpl_url_encode(value, buf) + 1;
+      } else {
+        vars[n_vars].key = param->key;
+        vars[n_vars].value = value;
+      }
+      n_vars++;
+    }
+  }
+
+  sort_canonical_vars(vars, n_vars);
+
+  return n_vars;
+}
+
+static dpl_status_t
+create_signed_headers(const struct canonical_var *headers, int n_headers,
+                      char *p, unsigned int len)
 {
-  dpl_value_t *val1 = *(dpl_value_t **) p1;
-  dpl_value_t *val2 = *(dpl_value_t **) p2;
-  dpl_dict_var_t *var1 = (dpl_dict_var_t *) val1->ptr;
-  dpl_dict_var_t *var2 = (dpl_dict_var_t *) val2->ptr;
+  int           item;
+  const char    *c;
+
+  for (item = 0; item < n_headers; item++) {
+    if (item > 0)
+      DPL_APPEND_STR(";");
 
-  return strcasecmp(var1->key, var2->key);
+    for (c = headers[item].key; *c != '\0'; c++)
+      DPL_APPEND_CHAR(tolower(*c));
+  }
+
+  return DPL_SUCCESS;
 }
 
 static dpl_status_t
 create_canonical_request(const dpl_req_t *req,
-                         dpl_dict_t *headers,
-                         dpl_vec_t *canonical_headers,
-                         dpl_vec_t *canonical_params,
+                         const dpl_dict_t *headers,
+                         const struct canonical_var *canonical_headers,
+                         int n_headers,
+                         const char *signed_headers,
+                         const struct canonical_var *canonical_params,
+                         int n_params,
                          char *p, unsigned int len)
 {
   // Method
@@ -101,18 +215,13 @@ create_canonical_request(const dpl_req_t *req,
   {
     int item;
 
-    for (item = 0; item < canonical_params->n_items; item++) {
-      dpl_dict_var_t    *param = (dpl_dict_var_t *) dpl_vec_get(canonical_params, item);
-
-      if (param == NULL)
-        continue;
-
+    for (item = 0; item < n_params; item++) {
       if (item > 0)
         DPL_APPEND_STR("&");
 
-      DPL_APPEND_STR(param->key);
+      DPL_APPEND_STR(canonical_params[item].key);
       DPL_APPEND_STR("=");
-      DPL_APPEND_STR(dpl_sbuf_get_str(param->val->string));
+      DPL_APPEND_STR(canonical_params[item].value);
     }
     DPL_APPEND_STR("\n");
   }
@@ -120,35 +229,18 @@ create_canonical_request(const dpl_req_t *req,
   // Headers
   if (canonical_headers != NULL) {
     int                 item;
-    char                *c;
-    dpl_dict_var_t      *header;
-
-    for (item = 0; item < canonical_headers->n_items; item++) {
-      header = (dpl_dict_var_t *) dpl_vec_get(canonical_headers, item);
-
-      if (header == NULL)
-        continue;
+    const char          *c;
 
-      for (c = header->key; *c != '\0'; c++)
+    for (item = 0; item < n_headers; item++) {
+      for (c = canonical_headers[item].key; *c != '\0'; c++)
         DPL_APPEND_CHAR(tolower(*c));
       DPL_APPEND_STR(":");
-      DPL_APPEND_STR(dpl_sbuf_get_str(header->val->string));
+      DPL_APPEND_STR(canonical_headers[item].value);
       DPL_APPEND_STR("\n");
     }
     DPL_APPEND_STR("\n");
 
-    for (item = 0; item < canonical_headers->n_items; item++) {
-      header = (dpl_dict_var_t *) dpl_vec_get(canonical_headers, item);
-
-      if (header == NULL)
-        continue;
-
-      if (item > 0)
-        DPL_APPEND_STR(";");
-
-      for (c = header->key; *c != '\0'; c++)
-        DPL_APPEND_CHAR(tolower(*c));
-    }
+    DPL_APPEND_STR(signed_headers);
     DPL_APPEND_STR("\n");
   } else {
     DPL_APPEND_STR("host:");
@@ -160,7 +252,7 @@ create_canonical_request(const dpl_req_t *req,
 
   // Hashed payload
   if (headers != NULL) {
-    char        *value = dpl_dict_get_value(headers, "x-amz-content-sha256");
+    char        *value = dpl_dict_get_value((dpl_dict_t *) headers, "x-amz-content-sha256");
     if (value != NULL)
       DPL_APPEND_STR(value);
   } else
@@ -188,38 +280,43 @@ get_current_utc_date(struct tm *tm, struct tm *i_tm,
   return (ret == 0 ? DPL_FAILURE : DPL_SUCCESS);
 }
 
+/*
+ * the "YYYYMMDD" part of a date_str from get_current_utc_date()
+ */
+static void
+get_date_buf(const char *date_str, char *date_buf)
+{
+  memcpy(date_buf, date_str, 8);
+  date_buf[8] = '\0';
+}
+
 static dpl_status_t
-create_sign_request(const dpl_req_t *req,
-                    char *canonical_request, struct tm *tm, char *date_str,
+create_sign_request(const char *region,
+                    char *canonical_request, char *date_str,
                     char *p, unsigned int len)
 {
+  char  date_buf[9];
+
+  get_date_buf(date_str, date_buf);
+
   DPL_APPEND_STR("AWS4-HMAC-SHA256\n");
 
   DPL_APPEND_STR(date_str);
   DPL_APPEND_STR("\n");
 
-  {
-    int         ret;
-    char        date_buf[9];
-
-    ret = strftime(date_buf, sizeof(date_buf), "%Y%m%d", tm);
-    if (ret == 0)
-      return DPL_FAILURE;
-
-    DPL_APPEND_STR(date_buf);
-    DPL_APPEND_STR("/");
-    DPL_APPEND_STR(req->ctx->aws_region);
-    DPL_APPEND_STR("/s3/aws4_request\n");
-  }
+  DPL_APPEND_STR(date_buf);
+  DPL_APPEND_STR("/");
+  DPL_APPEND_STR(region);
+  DPL_APPEND_STR("/s3/aws4_request\n");
 
   {
     uint8_t     digest[SHA256_DIGEST_LENGTH];
     char        digest_hex[DPL_HEX_LENGTH(sizeof digest) + 1];
-    int         i;
+    u_int       digest_hex_len;
 
     dpl_sha256((uint8_t *) canonical_request, strlen(canonical_request), digest);
-    for (i = 0; i < sizeof digest; i++)
-      sprintf(digest_hex + 2 * i, "%02x", (u_char) digest[i]);
+    digest_hex_len = dpl_bcd_encode(digest, sizeof digest, digest_hex);
+    digest_hex[digest_hex_len] = '\0';
 
     DPL_APPEND_STR(digest_hex);
   }
@@ -227,80 +324,91 @@ create_sign_request(const dpl_req_t *req,
   return DPL_SUCCESS;
 }
 
-static dpl_status_t
-create_signature(const dpl_req_t *req, struct tm *tm,
-                 char *sign_request, char *signature)
+/*
+ * The signing key only depends on the secret key, the day, the region
+ * and the service, so the one of the current day is kept in the context.
+ * It is read and refreshed (once a day, at UTC midnight) without lock:
+ * ctx->aws_sigv4_key.seq is odd while a writer updates it, and a reader
+ * retries with a fresh computation if it changed during the copy.
+ */
+static void
+get_signing_key(dpl_ctx_t *ctx, const char *date_buf, char *key)
 {
-  char          digest[64];
-  char          date_buf[9];
-  unsigned int  digest_len, i;
-  int           ret;
-
-  ret = strftime(date_buf, sizeof(date_buf), "%Y%m%d", tm);
-  if (ret == 0)
-    return DPL_FAILURE;
-
-  digest_len = snprintf(digest, sizeof(digest), "AWS4%s", req->ctx->secret_key);
+  dpl_sigv4_key_t       *cache = &ctx->aws_sigv4_key;
+  const char            *region = ctx->aws_region;
+  unsigned int          seq, digest_len;
+  char                  digest[64];
+  int                   hit;
+
+  seq = cache->seq;
+  __sync_synchronize();
+  hit = (!(seq & 1) &&
+         !memcmp(cache->date, date_buf, sizeof cache->date) &&
+         !strncmp(cache->region, region, sizeof cache->region));
+  if (hit)
+    memcpy(key, cache->key, SHA256_DIGEST_LENGTH);
+  __sync_synchronize();
+  if (hit && seq == cache->seq)
+    return;
+
+  digest_len = snprintf(digest, sizeof(digest), "AWS4%s", ctx->secret_key);
 
 #define H(d) \
   digest_len = dpl_hmac_sha256(digest, digest_len, d, strlen(d), digest)
 
   H(date_buf);
-  H(req->ctx->aws_region);
+  H(region);
   H("s3");
   H("aws4_request");
-  H(sign_request);
 
-  for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
-    sprintf(signature + 2 * i, "%02x", (u_char) digest[i]);
+#undef H
 
-  return DPL_SUCCESS;
-}
+  memcpy(key, digest, SHA256_DIGEST_LENGTH);
 
-static dpl_vec_t *
-get_canonical_headers(dpl_dict_t *headers)
-{
-  int                 bucket;
-  dpl_vec_t           *canonical_headers;
-  dpl_dict_var_t      *header;
+  // Another thread is refreshing it, or an older date was asked
+  if ((seq & 1) || strlen(region) >= sizeof cache->region ||
+      !__sync_bool_compare_and_swap(&cache->seq, seq, seq + 1))
+    return;
 
-  canonical_headers = dpl_vec_new(1, 0);
-  if (canonical_headers == NULL)
-    return NULL;
+  if (memcmp(date_buf, cache->date, sizeof cache->date) >= 0) {
+    memcpy(cache->date, date_buf, sizeof cache->date);
+    strcpy(cache->region, region);
+    memcpy(cache->key, digest, SHA256_DIGEST_LENGTH);
+  }
 
-  for (bucket = 0; bucket < headers->n_buckets; bucket++) {
-    header = headers->buckets[bucket];
-    while (header != NULL) {
-      dpl_status_t    ret;
+  __sync_synchronize();
+  cache->seq = seq + 2;
+}
 
-      assert(header->val->type == DPL_VALUE_STRING);
-      
-      ret = dpl_vec_add(canonical_headers, header);
-      if (ret != DPL_SUCCESS) {
-        dpl_vec_free(canonical_headers);
-        return NULL;
-      }
+static dpl_status_t
+create_signature(const dpl_req_t *req, char *date_str,
+                 char *sign_request, char *signature)
+{
+  char          key[SHA256_DIGEST_LENGTH];
+  char          digest[64];
+  char          date_buf[9];
+  unsigned int  digest_len;
 
-      header = header->prev;
-    }
-  }
+  get_date_buf(date_str, date_buf);
+  get_signing_key(req->ctx, date_buf, key);
 
-  dpl_vec_sort(canonical_headers, var_cmp);
+  digest_len = dpl_hmac_sha256(key, sizeof key, sign_request, strlen(sign_request), digest);
+  if (digest_len != SHA256_DIGEST_LENGTH)
+    return DPL_FAILURE;
+
+  signature[dpl_bcd_encode((u_char *) digest, digest_len, signature)] = '\0';
 
-  return canonical_headers;
+  return DPL_SUCCESS;
 }
 
 static dpl_status_t
-create_authorization(const dpl_req_t *req, struct tm *tm,
-                     dpl_vec_t *canonical_headers, char *signature,
+create_authorization(const dpl_req_t *req, char *date_str,
+                     const char *signed_headers, char *signature,
                      char *p, unsigned int len)
 {
-  int   ret;
   char  date_buf[9];
 
-  ret = strftime(date_buf, sizeof(date_buf), "%Y%m%d", tm);
-  if (ret == 0)
-    return DPL_FAILURE;
+  get_date_buf(date_str, date_buf);
 
   DPL_APPEND_STR("AWS4-HMAC-SHA256");
 
@@ -317,24 +425,7 @@ create_authorization(const dpl_req_t *req, struct tm *tm,
   DPL_APPEND_STR(",");
 
   DPL_APPEND_STR("SignedHeaders=");
-  {
-    int                 item;
-    char                *c;
-    dpl_dict_var_t      *header;
-
-    for (item = 0; item < canonical_headers->n_items; item++) {
-      header = (dpl_dict_var_t *) dpl_vec_get(canonical_headers, item);
-
-      if (header == NULL)
-        continue;
-
-      if (item > 0)
-        DPL_APPEND_STR(";");
-
-      for (c = header->key; *c != '\0'; c++)
-        DPL_APPEND_CHAR(tolower(*c));
-    }
-  }
+  DPL_APPEND_STR(signed_headers);
 
   DPL_APPEND_STR(",");
 
@@ -344,125 +435,19 @@ create_authorization(const dpl_req_t *req, struct tm *tm,
   return DPL_SUCCESS;
 }
 
-static dpl_status_t
-insert_query_params_in_vec(dpl_vec_t *params, const dpl_dict_t *query_params,
-                           unsigned char encode_url)
-{
-  int   bucket;
-
-  for (bucket = 0; bucket < query_params->n_buckets; bucket++) {
-    dpl_dict_var_t  *param = query_params->buckets[bucket];
-
-    while (param != NULL) {
-      size_t            new_size;
-      dpl_dict_var_t    *new_param;
-      dpl_status_t      ret;
-
-      new_param = (dpl_dict_var_t *) malloc (sizeof (dpl_dict_var_t));
-      if (new_param == NULL)
-        return DPL_FAILURE;
-
-      if (encode_url)
-        new_size = DPL_URL_LENGTH(strlen(param->key)) + 1;
-      else
-        new_size = strlen(param->key) + 1;
-
-      new_param->key = (char *) malloc(new_size);
-      if (new_param->key == NULL) {
-        free(new_param);
-        return DPL_FAILURE;
-      }
-
-      if (encode_url)
-        dpl_url_encode(param->key, new_param->key);
-      else
-        strcpy(new_param->key, param->key);
-
-      new_param->val = dpl_value_dup(param->val);
-      if (new_param->val == NULL) {
-        free(new_param->key);
-        free(new_param);
-        return DPL_FAILURE;
-      }
-
-      if (encode_url) {
-        ret = dpl_sbuf_url_encode(new_param->val->string);
-        if (ret != DPL_SUCCESS) {
-          dpl_value_free(new_param->val);
-          free(new_param->key);
-          free(new_param);
-          return DPL_FAILURE;
-        }
-      }
-
-      dpl_vec_add(params, new_param);
-
-      param = param->prev;
-    }
-  }
-
-  return DPL_SUCCESS;
-}
-
-static dpl_status_t
-parse_query_params_from_subresource(dpl_vec_t *params, const char *subresource,
-                                    unsigned char encode_url)
-{
-  // TODO: Parse subresource
-  return DPL_SUCCESS;
-}
-
-static dpl_vec_t *
-get_canonical_params(const char *subresource, const dpl_dict_t *query_params,
-                     unsigned char encode_url)
-{
-  dpl_status_t  ret = DPL_SUCCESS;
-  dpl_vec_t     *params;
-
-  params = dpl_vec_new(1, 0);
-  if (params == NULL)
-    return NULL;
-
-  if (subresource != NULL)
-    ret = parse_query_params_from_subresource(params, subresource, encode_url);
-
-  if (ret == DPL_SUCCESS && query_params != NULL)
-    ret = insert_query_params_in_vec(params, query_params, encode_url);
-
-  if (ret != DPL_SUCCESS) {
-    int item;
-
-    for (item = 0; item < params->n_items; item++) {
-      dpl_dict_var_t    *param = (dpl_dict_var_t *) dpl_vec_get(params, item);
-
-      free(param->key);
-      dpl_dict_var_free(param);
-    }
-    dpl_vec_free(params);
-    
-    return NULL;
-  }
-
-  dpl_vec_sort(params, var_cmp);
-
-  return params;
-}
-
 dpl_status_t
 dpl_s3_add_authorization_v4_to_headers(const dpl_req_t *req,
                                        dpl_dict_t *headers,
                                        const dpl_dict_t *query_params,
                                        struct tm *i_tm)
 {
-  int           item;
   dpl_status_t  ret;
   char          canonical_request[4096] = "";
   char          sign_request[1024] = "";
   char          signature[DPL_HEX_LENGTH(SHA256_DIGEST_LENGTH) + 1];
+  char          signed_headers[1024] = "";
   char          authorization[1024] = "";
   char          date_str[32] = "";
-  dpl_vec_t     *canonical_headers;
-  dpl_vec_t     *canonical_params;
   struct tm     tm;
 
   ret = add_payload_signature_to_headers(req, headers);
@@ -477,89 +462,82 @@ dpl_s3_add_authorization_v4_to_headers(const dpl_req_t *req,
   if (ret != DPL_SUCCESS)
     return ret;
 
-  canonical_headers = get_canonical_headers(headers);
-  if (canonical_headers == NULL)
-    return DPL_FAILURE;
-
-  canonical_params = get_canonical_params(req->subresource, query_params, 1);
-  if (canonical_params == NULL) {
-    dpl_vec_free(canonical_headers);
-    return DPL_FAILURE;
+  {
+    int                   n_headers = dpl_dict_count(headers);
+    int                   n_params = query_params ? dpl_dict_count(query_params) : 0;
+    struct canonical_var  canonical_headers[n_headers + 1];
+    struct canonical_var  canonical_params[n_params + 1];
+    char                  params_buf[get_canonical_params_size(query_params, 1) + 1];
+
+    n_headers = get_canonical_headers(headers, canonical_headers);
+    n_params = get_canonical_params(query_params, 1, canonical_params, params_buf);
+
+    ret = create_signed_headers(canonical_headers, n_headers,
+                                signed_headers, sizeof(signed_headers) - 1);
+
+    if (ret == DPL_SUCCESS)
+      ret = create_canonical_request(req, headers,
+                                     canonical_headers, n_headers, signed_headers,
+                                     canonical_params, n_params,
+                                     canonical_request, sizeof(canonical_request) - 1);
   }
 
-  ret = create_canonical_request(req, headers,
-                                 canonical_headers, canonical_params,
-                                 canonical_request, sizeof(canonical_request));
-
   if (ret == DPL_SUCCESS) {
     DPRINTF("Canonical request:\n%s\n", canonical_request);
-    ret = create_sign_request(req, canonical_request, &tm, date_str,
-                              sign_request, sizeof(sign_request));
+    ret = create_sign_request(req->ctx->aws_region, canonical_request, date_str,
+                              sign_request, sizeof(sign_request) - 1);
   }
 
   if (ret == DPL_SUCCESS) {
     DPRINTF("Signing request:\n%s\n", sign_request);
-    ret = create_signature(req, &tm, sign_request, signature);
+    ret = create_signature(req, date_str, sign_request, signature);
   }
 
   if (ret == DPL_SUCCESS) {
     DPRINTF("Signature: %s\n", signature);
-    ret = create_authorization(req, &tm, canonical_headers, signature,
-                               authorization, sizeof(authorization));
+    ret = create_authorization(req, date_str, signed_headers, signature,
+                               authorization, sizeof(authorization) - 1);
   }
 
   if (ret == DPL_SUCCESS)
     ret = dpl_dict_add(headers, "Authorization", authorization, 0);
 
-  for (item = 0; item < canonical_params->n_items; item++) {
-    dpl_dict_var_t    *param = (dpl_dict_var_t *) dpl_vec_get(canonical_params, item);
-    free(param->key);
-    dpl_dict_var_free(param);
-  }
-  dpl_vec_free(canonical_params);
-  dpl_vec_free(canonical_headers);
-
   return ret;
 }
 
 static dpl_status_t
 dpl_s3_insert_signature_v4_params(const dpl_req_t *req, dpl_dict_t *query_params,
-                                  struct tm *tm, char *date_str, char *signature)
+                                  char *date_str, char *signature)
 {
-  int           item;
   dpl_status_t  ret;
-  dpl_vec_t     *canonical_params;
   char          canonical_request[4096] = "";
   char          sign_request[1024] = "";
 
-  canonical_params = get_canonical_params(req->subresource, query_params, 0);
-  if (canonical_params == NULL)
-    return DPL_FAILURE;
+  {
+    int                   n_params = dpl_dict_count(query_params);
+    struct canonical_var  canonical_params[n_params + 1];
+
+    n_params = get_canonical_params(query_params, 0, canonical_params, NULL);
 
-  ret = create_canonical_request(req, NULL, NULL, canonical_params,
-                                 canonical_request, sizeof(canonical_request));
+    ret = create_canonical_request(req, NULL, NULL, 0, NULL,
+                                   canonical_params, n_params,
+                                   canonical_request, sizeof(canonical_request) - 1);
+  }
 
   if (ret == DPL_SUCCESS) {
     DPRINTF("Canonical request:\n%s\n", canonical_request);
-    ret = create_sign_request(req, canonical_request, tm, date_str,
-                              sign_request, sizeof(sign_request));
+    ret = create_sign_request(req->ctx->aws_region, canonical_request, date_str,
+                              sign_request, sizeof(sign_request) - 1);
   }
 
   if (ret == DPL_SUCCESS) {
     DPRINTF("Signing request:\n%s\n", sign_request);
-    ret = create_signature(req, tm, sign_request, signature);
+    ret = create_signature(req, date_str, sign_request, signature);
   }
 
   if (ret == DPL_SUCCESS)
     DPRINTF("Signature: %s\n", signature);
 
-  for (item = 0; item < canonical_params->n_items; item++) {
-    dpl_dict_var_t    *param = (dpl_dict_var_t *) dpl_vec_get(canonical_params, item);
-    free(param->key);
-    dpl_dict_var_free(param);
-  }
-  dpl_vec_free(canonical_params);
-
   return ret;
 }
 
@@ -618,9 +596,102 @@ dpl_s3_get_authorization_v4_params(const dpl_req_t *req, dpl_dict_t *query_param
     return DPL_FAILURE;
 
   ret = dpl_s3_insert_signature_v4_params(req, query_params,
-                                          &tm, date_str, signature);
+                                          date_str, signature);
   if (ret != DPL_SUCCESS)
     return DPL_FAILURE;
 
   return dpl_dict_add(query_params, "X-Amz-Signature", signature, 0);
 }
+
+/**
+ * prepare the query string authentication of URLs which expire at
+ * expires, shared by the calls to dpl_s3_presign_v4()
+ *
+ * @param ctx
+ * @param expires
+ * @param i_tm signing date, NULL for now
+ * @param ps
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_s3_presign_v4_init(dpl_ctx_t *ctx, time_t expires, struct tm *i_tm,
+                       dpl_s3_presign_v4_t *ps)
+{
+  dpl_status_t  ret;
+  struct tm     tm;
+  char          date_buf[9];
+  char          key[SHA256_DIGEST_LENGTH];
+  char          credentials[128];
+  char          credentials_ue[DPL_URL_LENGTH(sizeof(credentials)) + 1];
+  int           n;
+
+  ret = get_current_utc_date(&tm, i_tm, ps->date_str, sizeof(ps->date_str));
+  if (ret != DPL_SUCCESS)
+    return ret;
+
+  get_date_buf(ps->date_str, date_buf);
+
+  snprintf(credentials, sizeof(credentials), "%s/%s/%s/s3/aws4_request",
+           ctx->access_key, date_buf, ctx->aws_region);
+  dpl_url_encode(credentials, credentials_ue);
+
+  // Already in canonical order
+  n = snprintf(ps->query, sizeof(ps->query),
+               "X-Amz-Algorithm=AWS4-HMAC-SHA256"
+               "&X-Amz-Credential=%s"
+               "&X-Amz-Date=%s"
+               "&X-Amz-Expires=%ld"
+               "&X-Amz-SignedHeaders=host",
+               credentials_ue, ps->date_str, (long) (expires - time(0)));
+  if (n < 0 || n >= sizeof(ps->query))
+    return DPL_FAILURE;
+
+  get_signing_key(ctx, date_buf, key);
+  dpl_hmac_key_init(&ps->key, key, sizeof(key), 1);
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * compute the signature of a GET URL authenticated by query string
+ *
+ * @param ctx
+ * @param ps from dpl_s3_presign_v4_init()
+ * @param host
+ * @param resource_ue encoded resource, starting with a slash
+ * @param signature DPL_HEX_LENGTH(SHA256_DIGEST_LENGTH) + 1 bytes
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_s3_presign_v4(const dpl_ctx_t *ctx, const dpl_s3_presign_v4_t *ps,
+                  const char *host, const char *resource_ue, char *signature)
+{
+  dpl_status_t  ret;
+  char          canonical_request[4096] = "";
+  char          sign_request[1024] = "";
+  char          digest[SHA256_DIGEST_LENGTH];
+  char          *p = canonical_request;
+  unsigned int  len = sizeof(canonical_request) - 1;
+
+  DPL_APPEND_STR("GET\n");
+  DPL_APPEND_STR(resource_ue);
+  DPL_APPEND_STR("\n");
+  DPL_APPEND_STR(ps->query);
+  DPL_APPEND_STR("\nhost:");
+  DPL_APPEND_STR(host);
+  DPL_APPEND_STR("\n\nhost\nUNSIGNED-PAYLOAD");
+
+  ret = create_sign_request(ctx->aws_region, canonical_request, (char *) ps->date_str,
+                            sign_request, sizeof(sign_request) - 1);
+  if (ret != DPL_SUCCESS)
+    return ret;
+
+  dpl_hmac_key_sign(&ps->key, sign_request, strlen(sign_request), digest);
+  signature[dpl_bcd_encode((u_char *) digest, sizeof(digest), signature)] = '\0';
+
+  return DPL_SUCCESS;
+}
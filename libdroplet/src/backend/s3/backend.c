@@ -41,6 +41,8 @@ dpl_backend_t   dpl_backend_s3 = {
   .list_all_my_buckets = dpl_s3_list_all_my_buckets,
   .list_bucket         = dpl_s3_list_bucket,
   .list_bucket_attrs   = dpl_s3_list_bucket_attrs, /* WARNING, UNTESTED */
+  .list_bucket_page    = dpl_s3_list_bucket_page,
+  .list_bucket_v2      = dpl_s3_list_bucket_v2,
   .make_bucket         = dpl_s3_make_bucket,
   .delete_bucket       = dpl_s3_delete_bucket,
   .put                 = dpl_s3_put,
@@ -50,11 +52,19 @@ dpl_backend_t   dpl_backend_s3 = {
   .deletef             = dpl_s3_delete,
   .delete_all          = dpl_s3_delete_all,
   .genurl              = dpl_s3_genurl,
+  .genurl_batch        = dpl_s3_genurl_batch,
   .copy                = dpl_s3_copy,
   .stream_resume       = dpl_s3_stream_resume,
   .stream_getmd        = dpl_s3_stream_getmd,
   .stream_get          = dpl_s3_stream_get,
   .stream_putmd        = dpl_s3_stream_putmd,
   .stream_put          = dpl_s3_stream_put,
-  .stream_flush        = dpl_s3_stream_flush
+  .stream_flush        = dpl_s3_stream_flush,
+  .multipart_init      = dpl_s3_stream_multipart_init,
+  .multipart_put       = dpl_s3_stream_multipart_put,
+  .multipart_complete  = dpl_s3_stream_multipart_complete,
+  .multipart_abort     = dpl_s3_stream_multipart_abort,
+  .multipart_copy      = dpl_s3_stream_multipart_copy,
+  .multipart_list_parts = dpl_s3_stream_multipart_list_parts,
+  .multipart_list_uploads = dpl_s3_stream_multipart_list_uploads
 };
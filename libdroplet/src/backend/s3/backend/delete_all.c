@@ -42,8 +42,7 @@ struct dall_req
   dpl_dict_t    *query_params;
   dpl_conn_t    *conn;
   dpl_sbuf_t    *data;
-  char          *answer_data;
-  unsigned int  answer_len;
+  dpl_s3_reply_parser_t *parser;
   int           connection_close;
   dpl_vec_t     *objects;
 };
@@ -178,18 +177,23 @@ delete_all(dpl_ctx_t *ctx, const char *bucket, dpl_locators_t *locators,
     return ret;
   }
 
-  ret = dpl_read_http_reply(dctx->conn, 1,
-                            &dctx->answer_data, &dctx->answer_len,
-                            NULL, &dctx->connection_close);
+  dctx->objects = dpl_vec_new(2, 2);
+  if (dctx->objects == NULL)
+    return DPL_ENOMEM;
 
-  if (dctx->answer_len > 0) {
-    dpl_status_t        parse_ret;
+  // The reply is parsed as it is received
+  dctx->parser = dpl_s3_delete_all_parser_new(ctx, dctx->objects);
+  if (dctx->parser == NULL)
+    return DPL_ENOMEM;
 
-    dctx->objects = dpl_vec_new(2, 2);
-    if (dctx->objects == NULL)
-      return DPL_ENOMEM;
+  ret = dpl_read_http_reply_stream(dctx->conn, 1,
+                                   dpl_s3_reply_parser_feed, dctx->parser,
+                                   NULL, &dctx->connection_close);
+
+  if (dpl_s3_reply_parser_fed(dctx->parser)) {
+    dpl_status_t        parse_ret;
 
-    parse_ret = dpl_s3_parse_delete_all(ctx, dctx->answer_data, dctx->answer_len, dctx->objects);
+    parse_ret = dpl_s3_reply_parser_finish(dctx->parser, NULL, NULL);
     if (parse_ret == DPL_SUCCESS && objectsp != NULL) {
       *objectsp = dctx->objects;
       dctx->objects = NULL;
@@ -216,8 +220,7 @@ dpl_s3_delete_all(dpl_ctx_t *ctx,
     .headers          = NULL,
     .conn             = NULL,
     .data             = NULL,
-    .answer_data      = NULL,
-    .answer_len       = 0,
+    .parser           = NULL,
     .connection_close = 0,
     .objects          = NULL,
   };
@@ -243,8 +246,8 @@ dpl_s3_delete_all(dpl_ctx_t *ctx,
   if (dctx.data != NULL)
     dpl_sbuf_free(dctx.data);
 
-  if (dctx.answer_data != NULL)
-    free(dctx.answer_data);
+  if (dctx.parser != NULL)
+    dpl_s3_reply_parser_free(dctx.parser);
 
   if (dctx.objects != NULL)
     dpl_vec_delete_objects_free(dctx.objects);
@@ -139,3 +139,166 @@ dpl_s3_genurl(dpl_ctx_t *ctx,
 
   return ret;
 }
+
+/*
+ * append an URL to the arena, DPL_ELIMIT if it does not fit
+ */
+static dpl_status_t
+genurl_append(char **pp,
+              unsigned int *lenp,
+              const char *prefix,
+              const char *resource_ue,
+              const char *query)
+{
+  int n;
+
+  n = snprintf(*pp, *lenp, "%s%s?%s", prefix, resource_ue, query);
+  if (n < 0 || n >= *lenp)
+    return DPL_ELIMIT;
+
+  *pp += n + 1;
+  *lenp -= n + 1;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * generate GET URLs for a batch of resources of a bucket
+ *
+ * unlike dpl_s3_genurl(), neither a connection nor a request is set up
+ * per resource, and the secret key is turned into HMAC states once for
+ * the whole batch. The context lock is never taken.
+ */
+dpl_status_t
+dpl_s3_genurl_batch(dpl_ctx_t *ctx,
+                    const char *bucket,
+                    const char * const *resources,
+                    int n_resources,
+                    const dpl_option_t *option,
+                    time_t expires,
+                    char *buf,
+                    unsigned int len,
+                    char **urls,
+                    int *n_urlsp)
+{
+  int           ret, ret2;
+  dpl_addr_t    *addr;
+  char          host[1024];
+  char          prefix[1100];
+  char          npath[DPL_MAXPATHLEN];
+  char          resource_ue[DPL_URL_LENGTH(DPL_MAXPATHLEN) + 1];
+  char          query[2048];
+  const char    *default_port;
+  int           i = 0;
+  dpl_hmac_key_t hkey;
+  dpl_s3_presign_v4_t ps;
+
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "");
+
+  if (NULL == bucket || NULL == ctx->secret_key)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  ret2 = dpl_addrlist_get_rand(ctx->addrlist, &addr);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  default_port = ctx->use_https ? "443" : "80";
+  if (strcmp(addr->portstr, default_port))
+    snprintf(host, sizeof (host), "%s.%s:%s", bucket, addr->host, addr->portstr);
+  else
+    snprintf(host, sizeof (host), "%s.%s", bucket, addr->host);
+
+  snprintf(prefix, sizeof (prefix), "%s://%s",
+           ctx->use_https ? "https" : "http", host);
+
+  if (ctx->aws_auth_sign_version == 2)
+    {
+      dpl_hmac_key_init(&hkey, ctx->secret_key, strlen(ctx->secret_key), 0);
+    }
+  else if (ctx->aws_auth_sign_version == 4)
+    {
+      ret2 = dpl_s3_presign_v4_init(ctx, expires, NULL, &ps);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+  else
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  for (i = 0;i < n_resources;i++)
+    {
+      dpl_req_resource_path(ctx, resources[i], npath, sizeof (npath));
+
+      // the URL path is the canonical URI which gets signed
+      if ('/' != npath[0])
+        {
+          resource_ue[0] = '/';
+          dpl_url_encode_no_slashes(npath, resource_ue + 1);
+        }
+      else
+        dpl_url_encode_no_slashes(npath, resource_ue);
+
+      if (ctx->aws_auth_sign_version == 2)
+        {
+          char expires_str[64];
+          char signature_ue[DPL_URL_LENGTH(DPL_BASE64_LENGTH(SHA_DIGEST_LENGTH)) + 1];
+
+          snprintf(expires_str, sizeof (expires_str), "%ld", expires);
+
+          ret2 = dpl_s3_presign_v2(ctx, &hkey, bucket, resource_ue,
+                                   expires_str, signature_ue);
+          if (DPL_SUCCESS != ret2)
+            {
+              ret = ret2;
+              goto end;
+            }
+
+          snprintf(query, sizeof (query), "AWSAccessKeyId=%s&Expires=%s&Signature=%s",
+                   ctx->access_key, expires_str, signature_ue);
+        }
+      else
+        {
+          char signature[DPL_HEX_LENGTH(SHA256_DIGEST_LENGTH) + 1];
+
+          ret2 = dpl_s3_presign_v4(ctx, &ps, host, resource_ue, signature);
+          if (DPL_SUCCESS != ret2)
+            {
+              ret = ret2;
+              goto end;
+            }
+
+          snprintf(query, sizeof (query), "%s&X-Amz-Signature=%s",
+                   ps.query, signature);
+        }
+
+      urls[i] = buf;
+      ret2 = genurl_append(&buf, &len, prefix, resource_ue, query);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != n_urlsp)
+    *n_urlsp = i;
+
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "ret=%d", ret);
+
+  return ret;
+}
@@ -35,15 +35,28 @@
 #include "dropletp.h"
 #include "droplet/s3/s3.h"
 
-dpl_status_t
-dpl_s3_list_bucket(dpl_ctx_t *ctx,
-                   const char *bucket,
-                   const char *prefix,
-                   const char *delimiter,
-                   const int max_keys,
-                   dpl_vec_t **objectsp,
-                   dpl_vec_t **common_prefixesp,
-                   char **locationp)
+/*
+ * fetch one page of the listing, appending its entries to objects and
+ * common_prefixes.  The page starts at marker, which is the opaque value
+ * returned for the previous page, or else after start_after.
+ * *next_markerp is set to the marker of the following page, or NULL if
+ * this was the last one.
+ *
+ * With ListObjectsV2 (aws_list_version = 2) the marker is a continuation
+ * token, otherwise it is the key to resume after.
+ */
+static dpl_status_t
+list_bucket_page(dpl_ctx_t *ctx,
+                 const char *bucket,
+                 const char *prefix,
+                 const char *delimiter,
+                 const int max_keys,
+                 const char *start_after,
+                 const char *marker,
+                 int fetch_owner,
+                 dpl_vec_t *objects,
+                 dpl_vec_t *common_prefixes,
+                 char **next_markerp)
 {
   int           ret, ret2;
   dpl_conn_t    *conn = NULL;
@@ -52,17 +65,19 @@ dpl_s3_list_bucket(dpl_ctx_t *ctx,
   struct iovec  iov[10];
   int           n_iov = 0;
   int           connection_close = 0;
-  char          *data_buf = NULL;
-  u_int         data_len;
-  dpl_vec_t     *objects = NULL;
-  dpl_vec_t     *common_prefixes = NULL;
+  dpl_s3_reply_parser_t *parser = NULL;
   dpl_dict_t    *query_params = NULL;
   dpl_dict_t    *headers_request = NULL;
   dpl_dict_t    *headers_reply = NULL;
   dpl_req_t     *req = NULL;
   dpl_s3_req_mask_t req_mask = 0u;
+  int           n_objects, n_common_prefixes;
+  int           truncated = 0;
+  char          *next_marker = NULL;
+  int           v2 = (2 == ctx->aws_list_version);
 
-  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "");
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "v%d start_after=%s marker=%s", v2 ? 2 : 1,
+            start_after ? start_after : "", marker ? marker : "");
 
   req = dpl_req_new(ctx);
   if (NULL == req)
@@ -120,6 +135,32 @@ dpl_s3_list_bucket(dpl_ctx_t *ctx,
         }
     }
 
+  if (v2)
+    {
+      ret2 = dpl_dict_add(query_params, "list-type", "2", 0);
+      if (DPL_SUCCESS == ret2 && NULL != marker)
+        ret2 = dpl_dict_add(query_params, "continuation-token", marker, 0);
+      if (DPL_SUCCESS == ret2 && NULL != start_after)
+        ret2 = dpl_dict_add(query_params, "start-after", start_after, 0);
+      //unlike V1, V2 omits the owner unless asked for
+      if (DPL_SUCCESS == ret2 && fetch_owner)
+        ret2 = dpl_dict_add(query_params, "fetch-owner", "true", 0);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
+  else if (NULL != marker || NULL != start_after)
+    {
+      ret2 = dpl_dict_add(query_params, "marker", NULL != marker ? marker : start_after, 0);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
+
   if (-1 != max_keys)
     {
       char tmp[32] = "";
@@ -186,13 +227,141 @@ dpl_s3_list_bucket(dpl_ctx_t *ctx,
       goto end;
     }
 
-  ret2 = dpl_read_http_reply(conn, 1, &data_buf, &data_len, &headers_reply, &connection_close);
+  n_objects = objects->n_items;
+  n_common_prefixes = common_prefixes->n_items;
+
+  //entries are parsed as the reply is received
+  parser = dpl_s3_list_bucket_parser_new(ctx, objects, common_prefixes);
+  if (NULL == parser)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_read_http_reply_stream(conn, 1, dpl_s3_reply_parser_feed, parser,
+                                    &headers_reply, &connection_close);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = dpl_s3_reply_parser_finish(parser, &truncated, &next_marker);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
+  if (truncated && NULL == next_marker && v2)
+    {
+      DPL_LOG(ctx, DPL_ERROR, "truncated listing without NextContinuationToken");
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  if (truncated && NULL == next_marker)
+    {
+      const char *last = NULL;
+
+      /*
+       * NextMarker is only returned along with a delimiter, otherwise
+       * the listing resumes after the greatest name of this page
+       */
+      if (objects->n_items > n_objects)
+        last = ((dpl_object_t *) dpl_vec_get(objects, objects->n_items - 1))->path;
+      if (common_prefixes->n_items > n_common_prefixes)
+        {
+          const char *p = ((dpl_common_prefix_t *) dpl_vec_get(common_prefixes, common_prefixes->n_items - 1))->prefix;
+
+          if (NULL == last || strcmp(p, last) > 0)
+            last = p;
+        }
+
+      if (NULL != last)
+        {
+          next_marker = strdup(last);
+          if (NULL == next_marker)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
+    }
+
+  if (NULL != next_marker && NULL != marker && !strcmp(next_marker, marker))
+    {
+      DPL_LOG(ctx, DPL_ERROR, "listing does not progress past marker '%s'", marker);
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  *next_markerp = truncated ? next_marker : NULL;
+  if (truncated)
+    next_marker = NULL; //consume it
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(next_marker);
+
+  if (NULL != parser)
+    dpl_s3_reply_parser_free(parser);
+
+  if (NULL != conn)
+    {
+      if (1 == connection_close)
+        dpl_conn_terminate(conn);
+      else
+        dpl_conn_release(conn);
+    }
+
+  if (NULL != query_params)
+    dpl_dict_free(query_params);
+
+  if (NULL != headers_reply)
+    dpl_dict_free(headers_reply);
+
+  if (NULL != headers_request)
+    dpl_dict_free(headers_request);
+
+  if (NULL != req)
+    dpl_req_free(req);
+
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "ret=%d", ret);
+
+  return ret;
+}
+
+/**
+ * list one page of a bucket, with ListObjectsV2 if enabled
+ *
+ * @param max_keys -1 lets the server choose the page size
+ * @param start_after list the keys after this one, may be NULL
+ * @param token NULL for the first page
+ * @param fetch_owner ask for the owner of the objects
+ * @param next_tokenp token of the next page, NULL after the last one
+ */
+dpl_status_t
+dpl_s3_list_bucket_v2(dpl_ctx_t *ctx,
+                      const char *bucket,
+                      const char *prefix,
+                      const char *delimiter,
+                      const int max_keys,
+                      const char *start_after,
+                      const char *token,
+                      int fetch_owner,
+                      dpl_vec_t **objectsp,
+                      dpl_vec_t **common_prefixesp,
+                      char **next_tokenp,
+                      char **locationp)
+{
+  dpl_status_t  ret, ret2;
+  dpl_vec_t     *objects = NULL;
+  dpl_vec_t     *common_prefixes = NULL;
+  char          *next_marker = NULL;
+
   objects = dpl_vec_new(2, 2);
   if (NULL == objects)
     {
@@ -207,8 +376,9 @@ dpl_s3_list_bucket(dpl_ctx_t *ctx,
       goto end;
     }
 
-  ret = dpl_s3_parse_list_bucket(ctx, data_buf, data_len, objects, common_prefixes);
-  if (DPL_SUCCESS != ret)
+  ret2 = list_bucket_page(ctx, bucket, prefix, delimiter, max_keys, start_after, token, fetch_owner,
+                          objects, common_prefixes, &next_marker);
+  if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
@@ -226,40 +396,136 @@ dpl_s3_list_bucket(dpl_ctx_t *ctx,
       common_prefixes = NULL; //consume it
     }
 
+  if (NULL != next_tokenp)
+    {
+      *next_tokenp = next_marker;
+      next_marker = NULL; //consume it
+    }
+
   ret = DPL_SUCCESS;
 
  end:
 
+  free(next_marker);
+
   if (NULL != objects)
     dpl_vec_objects_free(objects);
 
   if (NULL != common_prefixes)
     dpl_vec_common_prefixes_free(common_prefixes);
 
-  if (NULL != data_buf)
-    free(data_buf);
+  return ret;
+}
 
-  if (NULL != conn)
+/**
+ * list one page of a bucket
+ *
+ * @param max_keys -1 lets the server choose the page size
+ * @param marker NULL for the first page
+ * @param next_markerp marker of the next page, NULL after the last one
+ */
+dpl_status_t
+dpl_s3_list_bucket_page(dpl_ctx_t *ctx,
+                        const char *bucket,
+                        const char *prefix,
+                        const char *delimiter,
+                        const int max_keys,
+                        const char *marker,
+                        dpl_vec_t **objectsp,
+                        dpl_vec_t **common_prefixesp,
+                        char **next_markerp,
+                        char **locationp)
+{
+  return dpl_s3_list_bucket_v2(ctx, bucket, prefix, delimiter, max_keys, NULL, marker, 0,
+                               objectsp, common_prefixesp, next_markerp, locationp);
+}
+
+/**
+ * list a bucket, following the markers until max_keys entries were
+ * collected or the listing is complete
+ *
+ * @param max_keys -1 for no limit
+ */
+dpl_status_t
+dpl_s3_list_bucket(dpl_ctx_t *ctx,
+                   const char *bucket,
+                   const char *prefix,
+                   const char *delimiter,
+                   const int max_keys,
+                   dpl_vec_t **objectsp,
+                   dpl_vec_t **common_prefixesp,
+                   char **locationp)
+{
+  dpl_status_t  ret, ret2;
+  dpl_vec_t     *objects = NULL;
+  dpl_vec_t     *common_prefixes = NULL;
+  char          *marker = NULL;
+  char          *next_marker = NULL;
+  int           n_keys;
+
+  objects = dpl_vec_new(2, 2);
+  if (NULL == objects)
     {
-      if (1 == connection_close)
-        dpl_conn_terminate(conn);
-      else
-        dpl_conn_release(conn);
+      ret = DPL_ENOMEM;
+      goto end;
     }
 
-  if (NULL != query_params)
-    dpl_dict_free(query_params);
+  common_prefixes = dpl_vec_new(2, 2);
+  if (NULL == common_prefixes)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
 
-  if (NULL != headers_reply)
-    dpl_dict_free(headers_reply);
+  while (1)
+    {
+      n_keys = -1;
+      if (-1 != max_keys)
+        n_keys = max_keys - objects->n_items - common_prefixes->n_items;
 
-  if (NULL != headers_request)
-    dpl_dict_free(headers_request);
+      ret2 = list_bucket_page(ctx, bucket, prefix, delimiter, n_keys, NULL, marker, 0,
+                              objects, common_prefixes, &next_marker);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
 
-  if (NULL != req)
-    dpl_req_free(req);
+      free(marker);
+      marker = next_marker;
+      next_marker = NULL;
 
-  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "ret=%d", ret);
+      if (NULL == marker)
+        break ;
+
+      if (-1 != max_keys &&
+          objects->n_items + common_prefixes->n_items >= max_keys)
+        break ;
+    }
+
+  if (NULL != objectsp)
+    {
+      *objectsp = objects;
+      objects = NULL; //consume it
+    }
+
+  if (NULL != common_prefixesp)
+    {
+      *common_prefixesp = common_prefixes;
+      common_prefixes = NULL; //consume it
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(marker);
+
+  if (NULL != objects)
+    dpl_vec_objects_free(objects);
+
+  if (NULL != common_prefixes)
+    dpl_vec_common_prefixes_free(common_prefixes);
 
   return ret;
 }
@@ -136,6 +136,63 @@ _multipart_parse_complete(const dpl_ctx_t *ctx,
   return ret;
 }
 
+/*
+ * the ETag of an UploadPartCopy is only in the body, possibly a 200
+ * carrying an Error
+ */
+static dpl_status_t
+_multipart_parse_copy(const dpl_ctx_t *ctx,
+                      const char *buf, int len,
+                      const char **etagp)
+{
+  dpl_status_t          ret = DPL_FAILURE;
+  xmlParserCtxtPtr      ctxt;
+  xmlDocPtr             doc;
+  xmlNode               *elem;
+  const char            *start_etag, *end_etag;
+
+  ctxt = xmlNewParserCtxt();
+  if (ctxt == NULL)
+    return DPL_FAILURE;
+
+  doc = xmlCtxtReadMemory(ctxt, buf, len, NULL, NULL, 0u);
+  if (doc == NULL) {
+    xmlFreeParserCtxt(ctxt);
+    return DPL_FAILURE;
+  }
+
+  elem = xmlDocGetRootElement(doc);
+  if (elem != NULL && !strcmp((char *) elem->name, "CopyPartResult"))
+    {
+      for (elem = elem->children;elem != NULL;elem = elem->next)
+        {
+          if (elem->type != XML_ELEMENT_NODE ||
+              strcmp((char *) elem->name, "ETag") ||
+              elem->children == NULL)
+            continue ;
+
+          start_etag = (char *) elem->children->content;
+          if (*start_etag == '"')
+            {
+              start_etag++;
+              end_etag = strchr(start_etag, '"');
+              if (end_etag == NULL)
+                end_etag = start_etag + strlen(start_etag);
+            }
+          else
+            end_etag = start_etag + strlen(start_etag);
+
+          *etagp = strndup(start_etag, end_etag - start_etag);
+          ret = (NULL == *etagp) ? DPL_ENOMEM : DPL_SUCCESS;
+          break ;
+        }
+    }
+
+  xmlFreeDoc(doc);
+  xmlFreeParserCtxt(ctxt);
+
+  return ret;
+}
 
 static dpl_status_t
 multipart_complete_gen_body(const dpl_ctx_t *ctx,
@@ -226,6 +283,8 @@ dpl_status_t
 dpl_s3_stream_multipart_init(dpl_ctx_t *ctx,
                              const char *bucket,
                              const char *resource,
+                             const dpl_dict_t *metadata,
+                             const dpl_sysmd_t *sysmd,
                              const char **uploadidp)
 {
   dpl_status_t  ret;
@@ -268,6 +327,23 @@ dpl_s3_stream_multipart_init(dpl_ctx_t *ctx,
   if (DPL_SUCCESS != ret)
     goto end;
 
+  //the object gets its metadata here, not at completion
+  if (sysmd)
+    {
+      if (sysmd->mask & DPL_SYSMD_MASK_CANNED_ACL)
+        dpl_req_set_canned_acl(req, sysmd->canned_acl);
+
+      if (sysmd->mask & DPL_SYSMD_MASK_STORAGE_CLASS)
+        dpl_req_set_storage_class(req, sysmd->storage_class);
+    }
+
+  if (NULL != metadata)
+    {
+      ret = dpl_req_add_metadata(req, metadata);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
   ret = dpl_s3_req_build(req, 0u, &headers_request);
   if (DPL_SUCCESS != ret)
     goto end;
@@ -659,3 +735,814 @@ end:
   return ret;
 }
 
+dpl_status_t
+dpl_s3_stream_multipart_abort(dpl_ctx_t *ctx,
+                              const char *bucket,
+                              const char *resource,
+                              const char *uploadid)
+{
+  dpl_status_t  ret;
+  dpl_conn_t    *conn = NULL;
+  char          header[dpl_header_size];
+  u_int         header_len;
+  struct iovec  iov[10];
+  int           n_iov = 0;
+  int           connection_close = 0;
+  dpl_dict_t    *headers_request = NULL;
+  dpl_dict_t    *headers_reply = NULL;
+  dpl_req_t     *req = NULL;
+  char          subresource[strlen(uploadid) + 10 /* for 'uploadId=' */];
+
+  snprintf(subresource, sizeof(subresource), "uploadId=%s", uploadid);
+
+  req = dpl_req_new(ctx);
+  if (NULL == req)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  dpl_req_set_method(req, DPL_METHOD_DELETE);
+
+  if (NULL == bucket)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  ret = dpl_req_set_bucket(req, bucket);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_resource(req, resource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_subresource(req, subresource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_s3_req_build(req, 0u, &headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_try_connect(ctx, req, &conn);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_add_host_to_headers(req, headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_s3_add_authorization_to_headers(req, headers_request, NULL, NULL);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_gen_http_request(ctx, req, headers_request, NULL,
+                                  header, sizeof (header), &header_len);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  iov[n_iov].iov_base = header;
+  iov[n_iov].iov_len = header_len;
+  n_iov++;
+
+  //final crlf
+  iov[n_iov].iov_base = "\r\n";
+  iov[n_iov].iov_len = 2;
+  n_iov++;
+
+  ret = dpl_conn_writev_all(conn, iov, n_iov, conn->ctx->write_timeout);
+  if (DPL_SUCCESS != ret)
+    {
+      DPL_TRACE(conn->ctx, DPL_TRACE_ERR, "writev failed");
+      connection_close = 1;
+      goto end;
+    }
+
+  ret = dpl_read_http_reply(conn, 1, NULL, NULL,
+                            &headers_reply, &connection_close);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = DPL_SUCCESS;
+
+end:
+  if (NULL != conn)
+    {
+      if (1 == connection_close)
+        dpl_conn_terminate(conn);
+      else
+        dpl_conn_release(conn);
+    }
+
+  if (NULL != headers_reply)
+    dpl_dict_free(headers_reply);
+
+  if (NULL != headers_request)
+    dpl_dict_free(headers_request);
+
+  if (NULL != req)
+    dpl_req_free(req);
+
+  return ret;
+}
+
+dpl_status_t
+dpl_s3_stream_multipart_copy(dpl_ctx_t *ctx,
+                             const char *bucket,
+                             const char *resource,
+                             const char *uploadid,
+                             unsigned int partnb,
+                             const char *src_bucket,
+                             const char *src_resource,
+                             const dpl_range_t *range,
+                             const dpl_condition_t *condition,
+                             const char **etagp)
+{
+  dpl_status_t  ret;
+  dpl_conn_t    *conn = NULL;
+  char          header[dpl_header_size];
+  u_int         header_len;
+  struct iovec  iov[10];
+  int           n_iov = 0;
+  int           connection_close = 0;
+  dpl_dict_t    *headers_request = NULL;
+  dpl_dict_t    *headers_reply = NULL;
+  dpl_req_t     *req = NULL;
+  char          *replybuf = NULL;
+  unsigned int  replybuflen = 0;
+  char          subresource[  11 /* for 'partNumber=' */ + 18 /* max len for %lu */
+			    + 10 /* for 'uploadId=' */   + strlen(uploadid)];
+
+  snprintf(subresource, sizeof(subresource), "partNumber=%u&uploadId=%s", partnb, uploadid);
+
+  req = dpl_req_new(ctx);
+  if (NULL == req)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  dpl_req_set_method(req, DPL_METHOD_PUT);
+
+  if (NULL == bucket || NULL == src_bucket)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  ret = dpl_req_set_bucket(req, bucket);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_resource(req, resource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_subresource(req, subresource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_src_bucket(req, src_bucket);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_src_resource(req, src_resource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  if (NULL != range)
+    {
+      ret = dpl_req_add_range(req, range->start, range->end);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
+  if (NULL != condition)
+    dpl_req_set_copy_source_condition(req, condition);
+
+  ret = dpl_s3_req_build(req, DPL_S3_REQ_COPY, &headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_try_connect(ctx, req, &conn);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_add_host_to_headers(req, headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_s3_add_authorization_to_headers(req, headers_request, NULL, NULL);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_gen_http_request(ctx, req, headers_request, NULL,
+                                  header, sizeof (header), &header_len);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  iov[n_iov].iov_base = header;
+  iov[n_iov].iov_len = header_len;
+  n_iov++;
+
+  //final crlf
+  iov[n_iov].iov_base = "\r\n";
+  iov[n_iov].iov_len = 2;
+  n_iov++;
+
+  ret = dpl_conn_writev_all(conn, iov, n_iov, conn->ctx->write_timeout);
+  if (DPL_SUCCESS != ret)
+    {
+      DPL_TRACE(conn->ctx, DPL_TRACE_ERR, "writev failed");
+      connection_close = 1;
+      goto end;
+    }
+
+  ret = dpl_read_http_reply_ext(conn, 1, 0, &replybuf, &replybuflen,
+                                &headers_reply, &connection_close);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = _multipart_parse_copy(ctx, replybuf, replybuflen, etagp);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = DPL_SUCCESS;
+
+end:
+  free(replybuf);
+  if (NULL != conn)
+    {
+      if (1 == connection_close)
+        dpl_conn_terminate(conn);
+      else
+        dpl_conn_release(conn);
+    }
+
+  if (NULL != headers_reply)
+    dpl_dict_free(headers_reply);
+
+  if (NULL != headers_request)
+    dpl_dict_free(headers_request);
+
+  if (NULL != req)
+    dpl_req_free(req);
+
+  return ret;
+}
+
+/*
+ * text of a leaf element, "" if empty
+ */
+static const char *
+_multipart_elem_text(const xmlNode *elem)
+{
+  if (elem->children == NULL || elem->children->content == NULL)
+    return "";
+
+  return (const char *) elem->children->content;
+}
+
+static char *
+_multipart_strdup_etag(const char *etag)
+{
+  const char *end;
+
+  if (*etag == '"')
+    {
+      etag++;
+      end = strchr(etag, '"');
+      if (end != NULL)
+        return strndup(etag, end - etag);
+    }
+
+  return strdup(etag);
+}
+
+/**
+ * parse a ListParts reply
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE the reply is malformed
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_s3_parse_multipart_list_parts(const dpl_ctx_t *ctx,
+                                  const char *buf, int len,
+                                  dpl_vec_t *parts,
+                                  int *truncatedp,
+                                  unsigned int *next_markerp)
+{
+  dpl_status_t          ret = DPL_FAILURE;
+  xmlParserCtxtPtr      ctxt;
+  xmlDocPtr             doc;
+  xmlNode               *elem, *child;
+  dpl_multipart_part_t  *part;
+
+  ctxt = xmlNewParserCtxt();
+  if (ctxt == NULL)
+    return DPL_FAILURE;
+
+  doc = xmlCtxtReadMemory(ctxt, buf, len, NULL, NULL, 0u);
+  if (doc == NULL) {
+    xmlFreeParserCtxt(ctxt);
+    return DPL_FAILURE;
+  }
+
+  *truncatedp = 0;
+
+  elem = xmlDocGetRootElement(doc);
+  if (elem == NULL || strcmp((char *) elem->name, "ListPartsResult"))
+    goto end;
+
+  for (elem = elem->children;elem != NULL;elem = elem->next)
+    {
+      if (elem->type != XML_ELEMENT_NODE)
+        continue ;
+
+      if (!strcmp((char *) elem->name, "IsTruncated"))
+        *truncatedp = !strcasecmp(_multipart_elem_text(elem), "true");
+      else if (!strcmp((char *) elem->name, "NextPartNumberMarker"))
+        *next_markerp = strtoul(_multipart_elem_text(elem), NULL, 10);
+      else if (!strcmp((char *) elem->name, "Part"))
+        {
+          part = calloc(1, sizeof (*part));
+          if (part == NULL)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+
+          for (child = elem->children;child != NULL;child = child->next)
+            {
+              if (child->type != XML_ELEMENT_NODE)
+                continue ;
+
+              if (!strcmp((char *) child->name, "PartNumber"))
+                part->partnb = strtoul(_multipart_elem_text(child), NULL, 10);
+              else if (!strcmp((char *) child->name, "Size"))
+                part->size = strtoull(_multipart_elem_text(child), NULL, 10);
+              else if (!strcmp((char *) child->name, "ETag") && part->etag == NULL)
+                {
+                  part->etag = _multipart_strdup_etag(_multipart_elem_text(child));
+                  if (part->etag == NULL)
+                    {
+                      dpl_multipart_part_free(part);
+                      ret = DPL_ENOMEM;
+                      goto end;
+                    }
+                }
+            }
+
+          if (part->etag == NULL || 0 == part->partnb)
+            {
+              dpl_multipart_part_free(part);
+              ret = DPL_FAILURE;
+              goto end;
+            }
+
+          if (DPL_SUCCESS != dpl_vec_add(parts, part))
+            {
+              dpl_multipart_part_free(part);
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+  xmlFreeDoc(doc);
+  xmlFreeParserCtxt(ctxt);
+
+  return ret;
+}
+
+/**
+ * parse a ListMultipartUploads reply
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE the reply is malformed
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_s3_parse_multipart_list_uploads(const dpl_ctx_t *ctx,
+                                    const char *buf, int len,
+                                    dpl_vec_t *uploads,
+                                    int *truncatedp,
+                                    char **next_key_markerp,
+                                    char **next_uploadid_markerp)
+{
+  dpl_status_t          ret = DPL_FAILURE;
+  xmlParserCtxtPtr      ctxt;
+  xmlDocPtr             doc;
+  xmlNode               *elem, *child;
+  dpl_multipart_upload_t *upload;
+
+  ctxt = xmlNewParserCtxt();
+  if (ctxt == NULL)
+    return DPL_FAILURE;
+
+  doc = xmlCtxtReadMemory(ctxt, buf, len, NULL, NULL, 0u);
+  if (doc == NULL) {
+    xmlFreeParserCtxt(ctxt);
+    return DPL_FAILURE;
+  }
+
+  *truncatedp = 0;
+
+  elem = xmlDocGetRootElement(doc);
+  if (elem == NULL || strcmp((char *) elem->name, "ListMultipartUploadsResult"))
+    goto end;
+
+  for (elem = elem->children;elem != NULL;elem = elem->next)
+    {
+      if (elem->type != XML_ELEMENT_NODE)
+        continue ;
+
+      if (!strcmp((char *) elem->name, "IsTruncated"))
+        *truncatedp = !strcasecmp(_multipart_elem_text(elem), "true");
+      else if (!strcmp((char *) elem->name, "NextKeyMarker"))
+        {
+          free(*next_key_markerp);
+          *next_key_markerp = strdup(_multipart_elem_text(elem));
+          if (*next_key_markerp == NULL)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
+      else if (!strcmp((char *) elem->name, "NextUploadIdMarker"))
+        {
+          free(*next_uploadid_markerp);
+          *next_uploadid_markerp = strdup(_multipart_elem_text(elem));
+          if (*next_uploadid_markerp == NULL)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
+      else if (!strcmp((char *) elem->name, "Upload"))
+        {
+          upload = calloc(1, sizeof (*upload));
+          if (upload == NULL)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+
+          for (child = elem->children;child != NULL;child = child->next)
+            {
+              if (child->type != XML_ELEMENT_NODE)
+                continue ;
+
+              if (!strcmp((char *) child->name, "Key") && upload->key == NULL)
+                {
+                  upload->key = strdup(_multipart_elem_text(child));
+                  if (upload->key == NULL)
+                    {
+                      dpl_multipart_upload_free(upload);
+                      ret = DPL_ENOMEM;
+                      goto end;
+                    }
+                }
+              else if (!strcmp((char *) child->name, "UploadId") && upload->uploadid == NULL)
+                {
+                  upload->uploadid = strdup(_multipart_elem_text(child));
+                  if (upload->uploadid == NULL)
+                    {
+                      dpl_multipart_upload_free(upload);
+                      ret = DPL_ENOMEM;
+                      goto end;
+                    }
+                }
+              else if (!strcmp((char *) child->name, "Initiated"))
+                upload->initiated = dpl_iso8601totime(_multipart_elem_text(child));
+            }
+
+          if (upload->key == NULL || upload->uploadid == NULL)
+            {
+              dpl_multipart_upload_free(upload);
+              ret = DPL_FAILURE;
+              goto end;
+            }
+
+          if (DPL_SUCCESS != dpl_vec_add(uploads, upload))
+            {
+              dpl_multipart_upload_free(upload);
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+  xmlFreeDoc(doc);
+  xmlFreeParserCtxt(ctxt);
+
+  return ret;
+}
+
+/*
+ * GET on a multipart subresource, the reply body is returned
+ */
+static dpl_status_t
+_multipart_get(dpl_ctx_t *ctx,
+               const char *bucket,
+               const char *resource,
+               const char *subresource,
+               const dpl_dict_t *query_params,
+               char **replybufp,
+               unsigned int *replybuflenp)
+{
+  dpl_status_t  ret;
+  dpl_conn_t    *conn = NULL;
+  char          header[dpl_header_size];
+  u_int         header_len;
+  struct iovec  iov[10];
+  int           n_iov = 0;
+  int           connection_close = 0;
+  dpl_dict_t    *headers_request = NULL;
+  dpl_dict_t    *headers_reply = NULL;
+  dpl_req_t     *req = NULL;
+
+  req = dpl_req_new(ctx);
+  if (NULL == req)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  dpl_req_set_method(req, DPL_METHOD_GET);
+
+  if (NULL == bucket)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  ret = dpl_req_set_bucket(req, bucket);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_resource(req, resource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_set_subresource(req, subresource);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_s3_req_build(req, 0u, &headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_try_connect(ctx, req, &conn);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_add_host_to_headers(req, headers_request);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_s3_add_authorization_to_headers(req, headers_request, query_params, NULL);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_req_gen_http_request(ctx, req, headers_request, query_params,
+                                  header, sizeof (header), &header_len);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  iov[n_iov].iov_base = header;
+  iov[n_iov].iov_len = header_len;
+  n_iov++;
+
+  //final crlf
+  iov[n_iov].iov_base = "\r\n";
+  iov[n_iov].iov_len = 2;
+  n_iov++;
+
+  ret = dpl_conn_writev_all(conn, iov, n_iov, conn->ctx->write_timeout);
+  if (DPL_SUCCESS != ret)
+    {
+      DPL_TRACE(conn->ctx, DPL_TRACE_ERR, "writev failed");
+      connection_close = 1;
+      goto end;
+    }
+
+  ret = dpl_read_http_reply_ext(conn, 1, 0, replybufp, replybuflenp,
+                                &headers_reply, &connection_close);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = DPL_SUCCESS;
+
+end:
+  if (NULL != conn)
+    {
+      if (1 == connection_close)
+        dpl_conn_terminate(conn);
+      else
+        dpl_conn_release(conn);
+    }
+
+  if (NULL != headers_reply)
+    dpl_dict_free(headers_reply);
+
+  if (NULL != headers_request)
+    dpl_dict_free(headers_request);
+
+  if (NULL != req)
+    dpl_req_free(req);
+
+  return ret;
+}
+
+dpl_status_t
+dpl_s3_stream_multipart_list_parts(dpl_ctx_t *ctx,
+                                   const char *bucket,
+                                   const char *resource,
+                                   const char *uploadid,
+                                   dpl_vec_t **partsp)
+{
+  dpl_status_t  ret;
+  dpl_vec_t     *parts = NULL;
+  dpl_dict_t    *query_params = NULL;
+  char          *replybuf = NULL;
+  unsigned int  replybuflen = 0;
+  int           truncated;
+  unsigned int  marker = 0;
+  char          marker_str[16];
+  char          subresource[strlen(uploadid) + 10 /* for 'uploadId=' */];
+
+  snprintf(subresource, sizeof(subresource), "uploadId=%s", uploadid);
+
+  parts = dpl_vec_new(16, 16);
+  if (NULL == parts)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  do
+    {
+      if (NULL != query_params)
+        dpl_dict_free(query_params);
+      query_params = NULL;
+
+      if (0 != marker)
+        {
+          query_params = dpl_dict_new(13);
+          if (NULL == query_params)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+
+          snprintf(marker_str, sizeof(marker_str), "%u", marker);
+          ret = dpl_dict_add(query_params, "part-number-marker", marker_str, 0);
+          if (DPL_SUCCESS != ret)
+            goto end;
+        }
+
+      ret = _multipart_get(ctx, bucket, resource, subresource, query_params,
+                           &replybuf, &replybuflen);
+      if (DPL_SUCCESS != ret)
+        goto end;
+
+      marker = 0;
+      ret = dpl_s3_parse_multipart_list_parts(ctx, replybuf, replybuflen, parts,
+                                              &truncated, &marker);
+      if (DPL_SUCCESS != ret)
+        goto end;
+
+      free(replybuf);
+      replybuf = NULL;
+
+      if (truncated && 0 == marker)
+        {
+          DPL_LOG(ctx, DPL_ERROR, "truncated parts listing without NextPartNumberMarker");
+          ret = DPL_FAILURE;
+          goto end;
+        }
+    }
+  while (truncated);
+
+  *partsp = parts;
+  parts = NULL;
+
+  ret = DPL_SUCCESS;
+
+end:
+  free(replybuf);
+
+  if (NULL != query_params)
+    dpl_dict_free(query_params);
+
+  if (NULL != parts)
+    dpl_vec_multipart_parts_free(parts);
+
+  return ret;
+}
+
+dpl_status_t
+dpl_s3_stream_multipart_list_uploads(dpl_ctx_t *ctx,
+                                     const char *bucket,
+                                     const char *prefix,
+                                     dpl_vec_t **uploadsp)
+{
+  dpl_status_t  ret;
+  dpl_vec_t     *uploads = NULL;
+  dpl_dict_t    *query_params = NULL;
+  char          *replybuf = NULL;
+  unsigned int  replybuflen = 0;
+  int           truncated;
+  char          *key_marker = NULL;
+  char          *uploadid_marker = NULL;
+
+  uploads = dpl_vec_new(16, 16);
+  if (NULL == uploads)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  do
+    {
+      if (NULL != query_params)
+        dpl_dict_free(query_params);
+
+      query_params = dpl_dict_new(13);
+      if (NULL == query_params)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+
+      if (NULL != prefix && 0 != prefix[0])
+        {
+          ret = dpl_dict_add(query_params, "prefix", prefix, 0);
+          if (DPL_SUCCESS != ret)
+            goto end;
+        }
+
+      if (NULL != key_marker)
+        {
+          ret = dpl_dict_add(query_params, "key-marker", key_marker, 0);
+          if (DPL_SUCCESS != ret)
+            goto end;
+        }
+
+      if (NULL != uploadid_marker)
+        {
+          ret = dpl_dict_add(query_params, "upload-id-marker", uploadid_marker, 0);
+          if (DPL_SUCCESS != ret)
+            goto end;
+        }
+
+      ret = _multipart_get(ctx, bucket, "/", "uploads", query_params,
+                           &replybuf, &replybuflen);
+      if (DPL_SUCCESS != ret)
+        goto end;
+
+      ret = dpl_s3_parse_multipart_list_uploads(ctx, replybuf, replybuflen, uploads,
+                                                &truncated, &key_marker, &uploadid_marker);
+      if (DPL_SUCCESS != ret)
+        goto end;
+
+      free(replybuf);
+      replybuf = NULL;
+
+      if (truncated && NULL == key_marker)
+        {
+          DPL_LOG(ctx, DPL_ERROR, "truncated uploads listing without NextKeyMarker");
+          ret = DPL_FAILURE;
+          goto end;
+        }
+    }
+  while (truncated);
+
+  *uploadsp = uploads;
+  uploads = NULL;
+
+  ret = DPL_SUCCESS;
+
+end:
+  free(replybuf);
+  free(key_marker);
+  free(uploadid_marker);
+
+  if (NULL != query_params)
+    dpl_dict_free(query_params);
+
+  if (NULL != uploads)
+    dpl_vec_multipart_uploads_free(uploads);
+
+  return ret;
+}
@@ -37,7 +37,7 @@
 
 static dpl_status_t
 _status_write_get(struct json_object *status,
-                  unsigned int *offsetp,
+                  uint64_t *offsetp,
                   unsigned int *npartsp)
 {
   dpl_status_t        ret = DPL_FAILURE;
@@ -74,7 +74,7 @@ _status_write_get(struct json_object *status,
         }
       json_object_object_add(status, "offset", json_off);
     }
-  *offsetp = (unsigned int)json_object_get_int64(json_off);
+  *offsetp = (uint64_t)json_object_get_int64(json_off);
 
   if (json_object_object_get_ex(status, "nparts", &json_nparts) == FALSE)
     {
@@ -107,7 +107,7 @@ end:
 
 static dpl_status_t
 _status_write_set(struct json_object *status,
-                  unsigned int offset,
+                  uint64_t offset,
                   unsigned int nparts,
                   unsigned int part_idx,
                   const char *etag)
@@ -167,6 +167,42 @@ end:
   return ret;
 }
 
+/*
+ * A resumed (and reconciled) status may already hold the etag of the
+ * part about to be sent: when it matches the MD5 of the data the part
+ * is known to be stored and does not need to be uploaded again.
+ */
+static int
+_status_part_uploaded(struct json_object *status,
+                      unsigned int part_idx,
+                      const char *buf,
+                      unsigned int len,
+                      const char **etagp)
+{
+  struct json_object  *json_parts = NULL;
+  struct json_object  *json_etag = NULL;
+  u_char              digest[MD5_DIGEST_LENGTH];
+  char                digest_hex[MD5_DIGEST_LENGTH * 2 + 1];
+
+  if (json_object_object_get_ex(status, "parts", &json_parts) == FALSE
+      || !json_object_is_type(json_parts, json_type_array)
+      || part_idx >= (unsigned int)json_object_array_length(json_parts))
+    return 0;
+
+  json_etag = json_object_array_get_idx(json_parts, part_idx);
+  if (NULL == json_etag || !json_object_is_type(json_etag, json_type_string))
+    return 0;
+
+  MD5((const u_char *) buf, len, digest);
+  digest_hex[dpl_bcd_encode(digest, MD5_DIGEST_LENGTH, digest_hex)] = 0;
+
+  if (strcasecmp(digest_hex, json_object_get_string(json_etag)))
+    return 0;
+
+  *etagp = strdup(digest_hex);
+
+  return NULL != *etagp;
+}
 
 dpl_status_t
 dpl_s3_stream_putmd(dpl_ctx_t *ctx, dpl_stream_t *stream,
@@ -237,7 +273,7 @@ dpl_s3_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream,
   const char          **uploadidp = NULL;
   const char          *uploadid = NULL;
   const char          *etag = NULL;
-  unsigned int        offset = 0;
+  uint64_t            offset = 0;
   unsigned int        part_idx;
   unsigned int        nparts;
 
@@ -264,6 +300,8 @@ dpl_s3_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream,
       ret = dpl_s3_stream_multipart_init(ctx,
                                          stream->bucket,
                                          stream->locator,
+                                         stream->md,
+                                         stream->sysmd,
                                          uploadidp);
       if (DPL_SUCCESS != ret)
         {
@@ -291,16 +329,23 @@ dpl_s3_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream,
 
   part_idx = nparts;
 
-  ret = dpl_s3_stream_multipart_put(ctx,
-                                    stream->bucket,
-                                    stream->locator,
-                                    uploadid,
-				    part_idx+1 /* we want the number not the index */,
-                                    buf, len, &etag);
-  if (DPL_SUCCESS != ret)
-    goto end;
+  if (_status_part_uploaded(stream->status, part_idx, buf, len, &etag))
+    {
+      DPL_TRACE(ctx, DPL_TRACE_BACKEND, "part %u already uploaded", part_idx+1);
+    }
+  else
+    {
+      ret = dpl_s3_stream_multipart_put(ctx,
+                                        stream->bucket,
+                                        stream->locator,
+                                        uploadid,
+                                        part_idx+1 /* we want the number not the index */,
+                                        buf, len, &etag);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
 
-  ret = _status_write_set(stream->status, offset, nparts+1, part_idx, etag);
+  ret = _status_write_set(stream->status, offset + len, nparts+1, part_idx, etag);
   if (DPL_SUCCESS != ret)
     goto end;
 
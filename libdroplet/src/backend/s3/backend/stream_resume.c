@@ -35,13 +35,156 @@
 #include <dropletp.h>
 #include <droplet/s3/s3.h>
 
+/*
+ * Rebuild the write status of a multipart upload from ListParts: the
+ * server is authoritative, so local etags it does not confirm are
+ * dropped and the parts it holds are recorded at their index.  The
+ * status resumes after the longest run of parts starting at 1, parts
+ * stored beyond a gap are kept so that dpl_s3_stream_put() can skip
+ * them if the same data is fed again.
+ */
+static dpl_status_t
+_status_reconcile(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                  struct json_object *status)
+{
+  dpl_status_t          ret = DPL_FAILURE;
+  struct json_object    *obj = NULL;
+  struct json_object    *json_local = NULL;
+  struct json_object    *json_parts = NULL;
+  struct json_object    *json_etag = NULL;
+  struct json_object    *json_off = NULL;
+  struct json_object    *json_nparts = NULL;
+  dpl_vec_t             *parts = NULL;
+  dpl_multipart_part_t  *part;
+  const char            *local_etag;
+  unsigned int          nparts;
+  uint64_t              offset = 0;
+  int                   i;
+
+  if (json_object_object_get_ex(status, "uploadId", &obj) == FALSE
+      || !json_object_is_type(obj, json_type_string))
+    return DPL_SUCCESS;
+
+  ret = dpl_s3_stream_multipart_list_parts(ctx, stream->bucket, stream->locator,
+                                           json_object_get_string(obj), &parts);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  if (json_object_object_get_ex(status, "parts", &json_local) == FALSE
+      || !json_object_is_type(json_local, json_type_array))
+    json_local = NULL;
+
+  json_parts = json_object_new_array();
+  if (NULL == json_parts)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  for (i = 0;i < parts->n_items;i++)
+    {
+      part = (dpl_multipart_part_t *) dpl_vec_get(parts, i);
+
+      if (NULL != json_local
+          && (int) part->partnb <= json_object_array_length(json_local))
+        {
+          obj = json_object_array_get_idx(json_local, part->partnb - 1);
+          local_etag = (NULL != obj) ? json_object_get_string(obj) : NULL;
+          if (NULL != local_etag && strcasecmp(local_etag, part->etag))
+            DPL_LOG(ctx, DPL_WARNING,
+                    "part %u of %s: local etag %s differs from stored %s",
+                    part->partnb, stream->locator, local_etag, part->etag);
+        }
+
+      json_etag = json_object_new_string(part->etag);
+      if (NULL == json_etag)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      json_object_array_put_idx(json_parts, part->partnb - 1, json_etag);
+      json_etag = NULL;
+    }
+
+  for (nparts = 0;(int) nparts < json_object_array_length(json_parts);nparts++)
+    if (NULL == json_object_array_get_idx(json_parts, nparts))
+      break ;
+
+  for (i = 0;i < parts->n_items;i++)
+    {
+      part = (dpl_multipart_part_t *) dpl_vec_get(parts, i);
+      if (part->partnb <= nparts)
+        offset += part->size;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND,
+            "reconciled %s: %d parts stored, resuming at part %u offset %llu",
+            stream->locator, parts->n_items, nparts + 1,
+            (unsigned long long) offset);
+
+  json_off = json_object_new_int64(offset);
+  if (NULL == json_off)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  json_nparts = json_object_new_int64(nparts);
+  if (NULL == json_nparts)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  json_object_object_del(status, "offset");
+  json_object_object_add(status, "offset", json_off);
+  json_off = NULL;
+  json_object_object_del(status, "nparts");
+  json_object_object_add(status, "nparts", json_nparts);
+  json_nparts = NULL;
+  json_object_object_del(status, "parts");
+  json_object_object_add(status, "parts", json_parts);
+  json_parts = NULL;
+
+  ret = DPL_SUCCESS;
+
+end:
+  if (NULL != json_off)
+    json_object_put(json_off);
+  if (NULL != json_nparts)
+    json_object_put(json_nparts);
+  if (NULL != json_parts)
+    json_object_put(json_parts);
+  if (NULL != parts)
+    dpl_vec_multipart_parts_free(parts);
+
+  return ret;
+}
+
 dpl_status_t
 dpl_s3_stream_resume(dpl_ctx_t *ctx, dpl_stream_t *stream,
                      struct json_object *status)
 {
+  dpl_status_t  ret;
+
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "");
+
+  if (NULL != stream->options
+      && (stream->options->mask & DPL_OPTION_RECONCILE))
+    {
+      ret = _status_reconcile(ctx, stream, status);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
   json_object_put(stream->status);
   json_object_get(status);
   stream->status = status;
 
-  return DPL_SUCCESS;
+  ret = DPL_SUCCESS;
+
+ end:
+  DPL_TRACE(ctx, DPL_TRACE_BACKEND, "ret=%d", ret);
+
+  return ret;
 }
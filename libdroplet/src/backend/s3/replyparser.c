@@ -96,8 +96,13 @@ dpl_s3_get_metadatum_from_header(const char *header,
         {
           if (!strcmp(header, "content-length"))
             {
+              ret2 = dpl_parse_size(value, &sysmdp->size);
+              if (DPL_SUCCESS != ret2)
+                {
+                  ret = ret2;
+                  goto end;
+                }
               sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
-              sysmdp->size = atoi(value);
             }
           else if (!strcmp(header, "last-modified"))
             {
@@ -368,324 +373,618 @@ dpl_s3_parse_list_all_my_buckets(const dpl_ctx_t *ctx,
 
 /**/
 
-static dpl_status_t
-parse_list_bucket_content(xmlNode *node,
-                          dpl_vec_t *vec)
+/*
+ * streaming parser of the list bucket and delete all replies
+ *
+ * libxml2 is fed with the body as it is received, through SAX callbacks
+ * which only keep the entry being parsed: each one is appended to the
+ * vectors as soon as its closing tag is seen, so neither the whole body
+ * nor a document tree is ever held in memory.
+ */
+
+#define REPLY_PARSER_MAX_DEPTH  4
+#define REPLY_PARSER_MAX_TEXT   (64*1024)
+
+enum reply_elem
+  {
+    ELEM_OTHER = 0,
+    ELEM_LIST_BUCKET_RESULT,
+    ELEM_DELETE_RESULT,
+    ELEM_ERROR,
+    ELEM_CONTENTS,
+    ELEM_COMMON_PREFIXES,
+    ELEM_DELETED,
+    ELEM_OWNER,
+    ELEM_KEY,
+    ELEM_PREFIX,
+    ELEM_SIZE,
+    ELEM_LAST_MODIFIED,
+    ELEM_ID,
+    ELEM_VERSION_ID,
+    ELEM_CODE,
+    ELEM_MESSAGE,
+    ELEM_IS_TRUNCATED,
+    ELEM_NEXT_MARKER,
+    ELEM_NEXT_CONTINUATION_TOKEN,
+  };
+
+static const struct
 {
-  xmlNode *tmp;
-  dpl_object_t *object = NULL;
-  int ret;
+  const char *name;
+  enum reply_elem elem;
+} reply_elems[] =
+  {
+    { "ListBucketResult", ELEM_LIST_BUCKET_RESULT },
+    { "DeleteResult", ELEM_DELETE_RESULT },
+    { "Error", ELEM_ERROR },
+    { "Contents", ELEM_CONTENTS },
+    { "CommonPrefixes", ELEM_COMMON_PREFIXES },
+    { "Deleted", ELEM_DELETED },
+    { "Owner", ELEM_OWNER },
+    { "Key", ELEM_KEY },
+    { "Prefix", ELEM_PREFIX },
+    { "Size", ELEM_SIZE },
+    { "LastModified", ELEM_LAST_MODIFIED },
+    { "ID", ELEM_ID },
+    { "VersionId", ELEM_VERSION_ID },
+    { "Code", ELEM_CODE },
+    { "Message", ELEM_MESSAGE },
+    { "IsTruncated", ELEM_IS_TRUNCATED },
+    { "NextMarker", ELEM_NEXT_MARKER },
+    { "NextContinuationToken", ELEM_NEXT_CONTINUATION_TOKEN },
+  };
+
+struct dpl_s3_reply_parser
+{
+  const dpl_ctx_t *ctx;
+  xmlParserCtxtPtr xml;
+  dpl_status_t ret;             /*!< first error */
+  int fed;
+
+  int depth;
+  enum reply_elem stack[REPLY_PARSER_MAX_DEPTH + 1]; /*!< 1-based */
+  char *text;
+  int text_len;
+  int text_size;
+
+  dpl_vec_t *objects;           /*!< dpl_object_t or dpl_delete_object_t */
+  dpl_vec_t *common_prefixes;
+  dpl_object_t *object;
+  dpl_common_prefix_t *common_prefix;
+  dpl_delete_object_t *delete_object;
+
+  int truncated;
+  char *next_marker;
+  char *error_code;
+  char *error_message;
+};
 
-  object = malloc(sizeof (*object));
-  if (NULL == object)
-    goto bad;
+static void
+reply_parser_fail(dpl_s3_reply_parser_t *parser,
+                  dpl_status_t ret)
+{
+  if (DPL_SUCCESS == parser->ret)
+    parser->ret = ret;
+  xmlStopParser(parser->xml);
+}
 
-  memset(object, 0, sizeof (*object));
+static enum reply_elem
+reply_elem_lookup(const xmlChar *name)
+{
+  int i;
 
-  for (tmp = node; NULL != tmp; tmp = tmp->next)
-    {
-      if (tmp->type == XML_ELEMENT_NODE)
-        {
-          DPRINTF("name: %s\n", tmp->name);
-          if (!strcmp((char *) tmp->name, "Key"))
-            {
-              object->path = strdup((char *) tmp->children->content);
-              if (NULL == object->path)
-                goto bad;
-            }
-          else if (!strcmp((char *) tmp->name, "LastModified"))
-            {
-              object->last_modified = dpl_iso8601totime((char *) tmp->children->content);
-            }
-          else if (!strcmp((char *) tmp->name, "Size"))
-            {
-              object->size = strtoull((char *) tmp->children->content, NULL, 0);
-            }
-          object->type = DPL_FTYPE_REG;
+  for (i = 0;i < (int) (sizeof (reply_elems) / sizeof (reply_elems[0]));i++)
+    if (!strcmp((char *) name, reply_elems[i].name))
+      return reply_elems[i].elem;
 
-        }
-      else if (tmp->type == XML_TEXT_NODE)
-        {
-          DPRINTF("content: %s\n", tmp->content);
-        }
-    }
+  return ELEM_OTHER;
+}
 
-  ret = dpl_vec_add(vec, object);
-  if (DPL_SUCCESS != ret)
-    goto bad;
+/*
+ * take the text of the element being closed
+ */
+static char *
+reply_parser_text_dup(dpl_s3_reply_parser_t *parser)
+{
+  char *str;
 
-  return DPL_SUCCESS;
+  str = strndup(NULL != parser->text ? parser->text : "", parser->text_len);
+  if (NULL == str)
+    reply_parser_fail(parser, DPL_ENOMEM);
 
- bad:
+  return str;
+}
 
-  if (NULL != object)
-    dpl_object_free(object);
+static void
+reply_parser_set_str(dpl_s3_reply_parser_t *parser,
+                     char **strp)
+{
+  free(*strp);
+  *strp = reply_parser_text_dup(parser);
+}
 
-  return DPL_FAILURE;
+static void
+reply_parser_add(dpl_s3_reply_parser_t *parser,
+                 dpl_vec_t *vec,
+                 void *item)
+{
+  if (NULL != item && DPL_SUCCESS != dpl_vec_add(vec, item))
+    reply_parser_fail(parser, DPL_ENOMEM);
 }
 
-static dpl_status_t
-parse_list_bucket_common_prefixes(xmlNode *node,
-                                  dpl_vec_t *vec)
+static void
+reply_parser_start(void *ctx,
+                   const xmlChar *localname,
+                   UNUSED const xmlChar *prefix,
+                   UNUSED const xmlChar *uri,
+                   UNUSED int nb_namespaces,
+                   UNUSED const xmlChar **namespaces,
+                   UNUSED int nb_attributes,
+                   UNUSED int nb_defaulted,
+                   UNUSED const xmlChar **attributes)
 {
-  xmlNode *tmp;
-  dpl_common_prefix_t *common_prefix = NULL;
-  int ret;
+  dpl_s3_reply_parser_t *parser = ctx;
+  enum reply_elem elem, root;
 
-  common_prefix = malloc(sizeof (*common_prefix));
-  if (NULL == common_prefix)
-    goto bad;
+  parser->depth++;
+  parser->text_len = 0;
 
-  memset(common_prefix, 0, sizeof (*common_prefix));
+  if (parser->depth > REPLY_PARSER_MAX_DEPTH)
+    return ;
 
-  for (tmp = node; NULL != tmp; tmp = tmp->next)
+  elem = reply_elem_lookup(localname);
+  parser->stack[parser->depth] = elem;
+
+  if (2 != parser->depth)
+    return ;
+
+  root = parser->stack[1];
+
+  if (ELEM_LIST_BUCKET_RESULT == root && ELEM_CONTENTS == elem &&
+      NULL == parser->object)
     {
-      if (tmp->type == XML_ELEMENT_NODE)
+      parser->object = calloc(1, sizeof (*parser->object));
+      if (NULL == parser->object)
+        reply_parser_fail(parser, DPL_ENOMEM);
+    }
+  else if (ELEM_LIST_BUCKET_RESULT == root && ELEM_COMMON_PREFIXES == elem &&
+           NULL == parser->common_prefix)
+    {
+      parser->common_prefix = calloc(1, sizeof (*parser->common_prefix));
+      if (NULL == parser->common_prefix)
+        reply_parser_fail(parser, DPL_ENOMEM);
+    }
+  else if (ELEM_DELETE_RESULT == root &&
+           (ELEM_DELETED == elem || ELEM_ERROR == elem) &&
+           NULL == parser->delete_object)
+    {
+      parser->delete_object = calloc(1, sizeof (*parser->delete_object));
+      if (NULL == parser->delete_object)
+        reply_parser_fail(parser, DPL_ENOMEM);
+      else
+        parser->delete_object->status = (ELEM_DELETED == elem) ? DPL_SUCCESS : DPL_FAILURE;
+    }
+}
+
+static void
+reply_parser_end_list_bucket(dpl_s3_reply_parser_t *parser)
+{
+  enum reply_elem *stack = parser->stack;
+  dpl_object_t *object = parser->object;
+
+  if (2 == parser->depth)
+    {
+      switch (stack[2])
         {
-          DPRINTF("name: %s\n", tmp->name);
-          if (!strcmp((char *) tmp->name, "Prefix"))
-            {
-              common_prefix->prefix = strdup((char *) tmp->children->content);
-              if (NULL == common_prefix->prefix)
-                goto bad;
-            }
+        case ELEM_CONTENTS:
+          if (NULL != object)
+            object->type = DPL_FTYPE_REG;
+          reply_parser_add(parser, parser->objects, object);
+          if (DPL_SUCCESS != parser->ret && NULL != object)
+            dpl_object_free(object);
+          parser->object = NULL;
+          break ;
+        case ELEM_COMMON_PREFIXES:
+          reply_parser_add(parser, parser->common_prefixes, parser->common_prefix);
+          if (DPL_SUCCESS != parser->ret && NULL != parser->common_prefix)
+            dpl_common_prefix_free(parser->common_prefix);
+          parser->common_prefix = NULL;
+          break ;
+        case ELEM_IS_TRUNCATED:
+          parser->truncated = (4 == parser->text_len &&
+                               !strncasecmp(parser->text, "true", 4));
+          break ;
+        case ELEM_NEXT_MARKER:
+        case ELEM_NEXT_CONTINUATION_TOKEN:
+          reply_parser_set_str(parser, &parser->next_marker);
+          break ;
+        default:
+          break ;
         }
-      else if (tmp->type == XML_TEXT_NODE)
+    }
+  else if (3 == parser->depth && ELEM_CONTENTS == stack[2] && NULL != object)
+    {
+      switch (stack[3])
         {
-          DPRINTF("content: %s\n", tmp->content);
+        case ELEM_KEY:
+          reply_parser_set_str(parser, &object->path);
+          break ;
+        case ELEM_LAST_MODIFIED:
+          object->last_modified = dpl_iso8601totime(parser->text);
+          break ;
+        case ELEM_SIZE:
+          object->size = strtoull(parser->text, NULL, 0);
+          break ;
+        default:
+          break ;
         }
     }
+  else if (3 == parser->depth && ELEM_COMMON_PREFIXES == stack[2] &&
+           ELEM_PREFIX == stack[3] && NULL != parser->common_prefix)
+    {
+      reply_parser_set_str(parser, &parser->common_prefix->prefix);
+    }
+  else if (4 == parser->depth && ELEM_CONTENTS == stack[2] &&
+           ELEM_OWNER == stack[3] && ELEM_ID == stack[4] && NULL != object)
+    {
+      reply_parser_set_str(parser, &object->owner);
+    }
+}
 
-  ret = dpl_vec_add(vec, common_prefix);
-  if (DPL_SUCCESS != ret)
-    goto bad;
+static void
+reply_parser_end_delete_all(dpl_s3_reply_parser_t *parser)
+{
+  enum reply_elem *stack = parser->stack;
+  dpl_delete_object_t *object = parser->delete_object;
 
-  return DPL_SUCCESS;
+  if (2 == parser->depth &&
+      (ELEM_DELETED == stack[2] || ELEM_ERROR == stack[2]))
+    {
+      reply_parser_add(parser, parser->objects, object);
+      if (DPL_SUCCESS != parser->ret && NULL != object)
+        dpl_delete_object_free(object);
+      parser->delete_object = NULL;
+    }
+  else if (3 == parser->depth && NULL != object &&
+           (ELEM_DELETED == stack[2] || ELEM_ERROR == stack[2]))
+    {
+      if (ELEM_KEY == stack[3])
+        reply_parser_set_str(parser, &object->name);
+      else if (ELEM_VERSION_ID == stack[3])
+        reply_parser_set_str(parser, &object->version_id);
+      else if (ELEM_MESSAGE == stack[3] && ELEM_ERROR == stack[2])
+        reply_parser_set_str(parser, &object->error);
+    }
+}
 
- bad:
+static void
+reply_parser_end(void *ctx,
+                 UNUSED const xmlChar *localname,
+                 UNUSED const xmlChar *prefix,
+                 UNUSED const xmlChar *uri)
+{
+  dpl_s3_reply_parser_t *parser = ctx;
 
-  if (NULL != common_prefix)
-    dpl_common_prefix_free(common_prefix);
+  if (parser->depth <= REPLY_PARSER_MAX_DEPTH && NULL != parser->text)
+    {
+      parser->text[parser->text_len] = 0;
 
-  return DPL_FAILURE;
+      switch (parser->stack[1])
+        {
+        case ELEM_LIST_BUCKET_RESULT:
+          if (NULL != parser->common_prefixes)
+            reply_parser_end_list_bucket(parser);
+          break ;
+        case ELEM_DELETE_RESULT:
+          if (NULL == parser->common_prefixes)
+            reply_parser_end_delete_all(parser);
+          break ;
+        case ELEM_ERROR:
+          if (2 == parser->depth && ELEM_CODE == parser->stack[2])
+            reply_parser_set_str(parser, &parser->error_code);
+          else if (2 == parser->depth && ELEM_MESSAGE == parser->stack[2])
+            reply_parser_set_str(parser, &parser->error_message);
+          break ;
+        default:
+          break ;
+        }
+    }
+
+  parser->depth--;
+  parser->text_len = 0;
 }
 
-static dpl_status_t
-parse_list_bucket_children(xmlNode *node,
-                           dpl_vec_t *objects,
-                           dpl_vec_t *common_prefixes)
+static void
+reply_parser_characters(void *ctx,
+                        const xmlChar *ch,
+                        int len)
 {
-  xmlNode *tmp;
-  int ret;
+  dpl_s3_reply_parser_t *parser = ctx;
+  char *ntext;
+  int nsize;
 
-  for (tmp = node; NULL != tmp; tmp = tmp->next)
+  //only leaves are of interest
+  if (parser->depth < 2 || parser->depth > REPLY_PARSER_MAX_DEPTH)
+    return ;
+
+  if (parser->text_len + len + 1 > parser->text_size)
     {
-      if (tmp->type == XML_ELEMENT_NODE)
+      if (parser->text_len + len + 1 > REPLY_PARSER_MAX_TEXT)
         {
-          DPRINTF("name: %s\n", tmp->name);
-
-          if (!strcmp((char *) tmp->name, "Contents"))
-            {
-              ret = parse_list_bucket_content(tmp->children, objects);
-              if (DPL_SUCCESS != ret)
-                return DPL_FAILURE;
-            }
-          else if (!strcmp((char *) tmp->name, "CommonPrefixes"))
-            {
-              ret = parse_list_bucket_common_prefixes(tmp->children, common_prefixes);
-              if (DPL_SUCCESS != ret)
-                return DPL_FAILURE;
-            }
+          reply_parser_fail(parser, DPL_FAILURE);
+          return ;
         }
-      else if (tmp->type == XML_TEXT_NODE)
+
+      nsize = MAX(2 * parser->text_size, parser->text_len + len + 1);
+      ntext = realloc(parser->text, nsize);
+      if (NULL == ntext)
         {
-          DPRINTF("content: %s\n", tmp->content);
+          reply_parser_fail(parser, DPL_ENOMEM);
+          return ;
         }
+      parser->text = ntext;
+      parser->text_size = nsize;
     }
 
-  return DPL_SUCCESS;
+  memcpy(parser->text + parser->text_len, ch, len);
+  parser->text_len += len;
 }
 
-dpl_status_t
-dpl_s3_parse_list_bucket(const dpl_ctx_t *ctx,
-                         const char *buf,
-                         int len,
-                         dpl_vec_t *objects,
-                         dpl_vec_t *common_prefixes)
+static dpl_s3_reply_parser_t *
+reply_parser_new(const dpl_ctx_t *ctx,
+                 dpl_vec_t *objects,
+                 dpl_vec_t *common_prefixes)
 {
-  int                   ret = DPL_SUCCESS;
-  xmlParserCtxtPtr      ctxt;
-  xmlDocPtr             doc;
-  xmlNode               *tmp;
+  dpl_s3_reply_parser_t *parser;
+  xmlSAXHandler sax;
 
-  ctxt = xmlNewParserCtxt();
-  if (ctxt == NULL)
-    return DPL_FAILURE;
+  parser = calloc(1, sizeof (*parser));
+  if (NULL == parser)
+    return NULL;
 
-  doc = xmlCtxtReadMemory(ctxt, buf, len, NULL, NULL, 0u);
-  if (doc == NULL) {
-    xmlFreeParserCtxt(ctxt);
-    return DPL_FAILURE;
-  }
+  parser->ctx = ctx;
+  parser->ret = DPL_SUCCESS;
+  parser->objects = objects;
+  parser->common_prefixes = common_prefixes;
 
-  tmp = xmlDocGetRootElement(doc);
-  while (tmp != NULL) {
-    if (tmp->type == XML_ELEMENT_NODE) {
-      DPRINTF("name: %s\n", tmp->name);
+  parser->text_size = 256;
+  parser->text = malloc(parser->text_size);
+  if (NULL == parser->text)
+    goto bad;
 
-      if (!strcmp((char *) tmp->name, "ListBucketResult")) {
-        ret = parse_list_bucket_children(tmp->children, objects, common_prefixes);
-        if (ret != DPL_SUCCESS)
-          break;
-      }
-    } else if (tmp->type == XML_TEXT_NODE)
-      DPRINTF("content: %s\n", tmp->content);
+  memset(&sax, 0, sizeof (sax));
+  sax.initialized = XML_SAX2_MAGIC;
+  sax.startElementNs = reply_parser_start;
+  sax.endElementNs = reply_parser_end;
+  sax.characters = reply_parser_characters;
 
-    tmp = tmp->next;
-  }
+  parser->xml = xmlCreatePushParserCtxt(&sax, parser, NULL, 0, NULL);
+  if (NULL == parser->xml)
+    goto bad;
 
-  xmlFreeDoc(doc);
-  xmlFreeParserCtxt(ctxt);
+  xmlCtxtUseOptions(parser->xml, XML_PARSE_NONET|XML_PARSE_NOERROR|XML_PARSE_NOWARNING);
 
-  return ret;
-}
+  return parser;
 
-static dpl_status_t
-parse_delete_all_deleted(const dpl_ctx_t *ctx, xmlNode *elem, dpl_vec_t *objects)
-{
-  dpl_status_t          ret = DPL_SUCCESS;
-  dpl_delete_object_t   *object;
+ bad:
 
-  object = (dpl_delete_object_t *) malloc(sizeof(dpl_delete_object_t));
-  if (object == NULL)
-    return DPL_ENOMEM;
+  dpl_s3_reply_parser_free(parser);
 
-  object->status     = DPL_SUCCESS;
-  object->name       = NULL;
-  object->version_id = NULL;
-  object->error      = NULL;
+  return NULL;
+}
 
-  while (elem != NULL && ret == DPL_SUCCESS) {
-    if (elem->type == XML_ELEMENT_NODE) {
-      char      **pstr;
+/**
+ * create a streaming parser of a list bucket reply
+ *
+ * @param ctx
+ * @param objects receives the dpl_object_t
+ * @param common_prefixes receives the dpl_common_prefix_t
+ *
+ * @return the parser or NULL
+ */
+dpl_s3_reply_parser_t *
+dpl_s3_list_bucket_parser_new(const dpl_ctx_t *ctx,
+                              dpl_vec_t *objects,
+                              dpl_vec_t *common_prefixes)
+{
+  return reply_parser_new(ctx, objects, common_prefixes);
+}
 
-      if (!strcmp((char *) elem->name, "Key"))
-        pstr = &object->name;
-      else if (!strcmp((char *) elem->name, "VersionId"))
-        pstr = &object->version_id;
-      else
-        pstr = NULL;
+/**
+ * create a streaming parser of a delete all (multi-object delete) reply
+ *
+ * @param ctx
+ * @param objects receives the dpl_delete_object_t
+ *
+ * @return the parser or NULL
+ */
+dpl_s3_reply_parser_t *
+dpl_s3_delete_all_parser_new(const dpl_ctx_t *ctx,
+                             dpl_vec_t *objects)
+{
+  return reply_parser_new(ctx, objects, NULL);
+}
 
-      if (pstr != NULL && elem->children != NULL) {
-        *pstr = strdup((char *) elem->children->content);
-        if (*pstr == NULL)
-          ret = DPL_ENOMEM;
-      }
+void
+dpl_s3_reply_parser_free(dpl_s3_reply_parser_t *parser)
+{
+  if (NULL != parser->xml)
+    {
+      if (NULL != parser->xml->myDoc)
+        xmlFreeDoc(parser->xml->myDoc);
+      xmlFreeParserCtxt(parser->xml);
     }
-    elem = elem->next;
-  }
+  if (NULL != parser->object)
+    dpl_object_free(parser->object);
+  if (NULL != parser->common_prefix)
+    dpl_common_prefix_free(parser->common_prefix);
+  if (NULL != parser->delete_object)
+    dpl_delete_object_free(parser->delete_object);
+  free(parser->text);
+  free(parser->next_marker);
+  free(parser->error_code);
+  free(parser->error_message);
+  free(parser);
+}
 
-  if (ret == DPL_SUCCESS)
-    ret = dpl_vec_add(objects, object);
+/**
+ * feed a chunk of the reply, as a dpl_buffer_func_t
+ *
+ * parse errors are kept for dpl_s3_reply_parser_finish() and the rest of
+ * the reply is skipped, so that the reply is still consumed and its
+ * HTTP status reported when the body is not the expected XML.  Running
+ * out of memory stops the reading of the reply, which is not the fault
+ * of the host.
+ *
+ * @param cb_arg the parser
+ * @param buf
+ * @param len
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_s3_reply_parser_feed(void *cb_arg,
+                         char *buf,
+                         unsigned int len)
+{
+  dpl_s3_reply_parser_t *parser = cb_arg;
 
-  if (ret != DPL_SUCCESS)
-    dpl_delete_object_free(object);
+  parser->fed = 1;
 
-  return ret;
+  if (DPL_SUCCESS == parser->ret &&
+      0 != xmlParseChunk(parser->xml, buf, len, 0) && DPL_SUCCESS == parser->ret)
+    parser->ret = DPL_FAILURE;
+
+  if (DPL_ENOMEM == parser->ret)
+    return DPL_ENOMEM;
+
+  return DPL_SUCCESS;
 }
 
-static dpl_status_t
-parse_delete_all_delete_error(const dpl_ctx_t *ctx, xmlNode *elem, dpl_vec_t *objects)
+/**
+ * @return 1 if some of the reply was fed
+ */
+int
+dpl_s3_reply_parser_fed(const dpl_s3_reply_parser_t *parser)
 {
-  dpl_status_t          ret = DPL_SUCCESS;
-  dpl_delete_object_t   *object;
+  return parser->fed;
+}
 
-  object = (dpl_delete_object_t *) malloc(sizeof(dpl_delete_object_t));
-  if (object == NULL)
-    return DPL_ENOMEM;
+/**
+ * terminate the parsing once the whole reply was fed
+ *
+ * @param parser
+ * @param truncatedp set to 1 if there are more pages, may be NULL
+ * @param next_markerp NextMarker, or NextContinuationToken for a
+ * ListObjectsV2 reply, if the server provided one, may be NULL
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_s3_reply_parser_finish(dpl_s3_reply_parser_t *parser,
+                           int *truncatedp,
+                           char **next_markerp)
+{
+  if (DPL_SUCCESS == parser->ret &&
+      0 != xmlParseChunk(parser->xml, NULL, 0, 1) && DPL_SUCCESS == parser->ret)
+    parser->ret = DPL_FAILURE;
 
-  object->status     = DPL_FAILURE;
-  object->name       = NULL;
-  object->version_id = NULL;
-  object->error      = NULL;
-
-  while (elem != NULL && ret == DPL_SUCCESS) {
-    if (elem->type == XML_ELEMENT_NODE) {
-      char      **pstr;
-
-      if (!strcmp((char *) elem->name, "Key"))
-        pstr = &object->name;
-      else if (!strcmp((char *) elem->name, "VersionId"))
-        pstr = &object->version_id;
-      else if (!strcmp((char *) elem->name, "Message"))
-        pstr = &object->error;
+  if (NULL != parser->error_message)
+    {
+      if (NULL != parser->error_code)
+        DPL_LOG((dpl_ctx_t *) parser->ctx, DPL_ERROR, "Error: %s (%s)", parser->error_message, parser->error_code);
       else
-        pstr = NULL;
-
-      if (pstr != NULL && elem->children != NULL) {
-        *pstr = strdup((char *) elem->children->content);
-        if (*pstr == NULL)
-          ret = DPL_ENOMEM;
-      }
+        DPL_LOG((dpl_ctx_t *) parser->ctx, DPL_ERROR, "Error: %s", parser->error_message);
     }
-    elem = elem->next;
-  }
 
-  if (ret == DPL_SUCCESS)
-    ret = dpl_vec_add(objects, object);
+  if (DPL_SUCCESS != parser->ret)
+    return parser->ret;
 
-  if (ret != DPL_SUCCESS)
-    dpl_delete_object_free(object);
+  if (NULL != truncatedp)
+    *truncatedp = parser->truncated;
 
-  return ret;
+  if (NULL != next_markerp)
+    {
+      *next_markerp = parser->next_marker;
+      parser->next_marker = NULL; //consume it
+    }
+
+  return DPL_SUCCESS;
 }
 
+/*
+ * parse a whole reply at once
+ */
 static dpl_status_t
-parse_delete_all_children(const dpl_ctx_t *ctx, xmlNode *elem, dpl_vec_t *objects)
+reply_parse(const dpl_ctx_t *ctx,
+            const char *buf,
+            int len,
+            dpl_vec_t *objects,
+            dpl_vec_t *common_prefixes,
+            int *truncatedp,
+            char **next_markerp)
 {
-  dpl_status_t  ret = DPL_SUCCESS;
+  dpl_s3_reply_parser_t *parser;
+  dpl_status_t ret;
+
+  parser = reply_parser_new(ctx, objects, common_prefixes);
+  if (NULL == parser)
+    return DPL_ENOMEM;
 
-  while (elem != NULL) {
-    if (elem->type == XML_ELEMENT_NODE) {
-      if (!strcmp((char *) elem->name, "Deleted"))
-        ret = parse_delete_all_deleted(ctx, elem->children, objects);
-      else if (!strcmp((char *) elem->name, "Error"))
-        ret = parse_delete_all_delete_error(ctx, elem->children, objects);
+  (void) dpl_s3_reply_parser_feed(parser, (char *) buf, len);
+  ret = dpl_s3_reply_parser_finish(parser, truncatedp, next_markerp);
 
-      if (ret != DPL_SUCCESS)
-        break;
-    }
-    elem = elem->next;
-  }
+  dpl_s3_reply_parser_free(parser);
 
   return ret;
 }
 
-static void
-parse_delete_all_error(const dpl_ctx_t *ctx, xmlNode *elem)
+/**
+ * parse one page of a bucket listing
+ *
+ * entries are appended to objects and common_prefixes.
+ *
+ * @param ctx
+ * @param buf
+ * @param len
+ * @param objects
+ * @param common_prefixes
+ * @param truncatedp set to 1 if there are more pages, may be NULL
+ * @param next_markerp NextMarker, or NextContinuationToken for a
+ * ListObjectsV2 reply, if the server provided one, may be NULL
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_s3_parse_list_bucket_page(const dpl_ctx_t *ctx,
+                              const char *buf,
+                              int len,
+                              dpl_vec_t *objects,
+                              dpl_vec_t *common_prefixes,
+                              int *truncatedp,
+                              char **next_markerp)
 {
-  char  *code = NULL, *message = NULL;
-
-  while (elem != NULL) {
-    if (elem->type == XML_ELEMENT_NODE) {
-      if (!strcmp((char *) elem->name, "Code")) {
-        if (elem->children != NULL)
-          code = (char *) elem->children->content;
-      } else if (!strcmp((char *) elem->name, "Message")) {
-        if (elem->children != NULL)
-          message = (char *) elem->children->content;
-      }
-    }
-    elem = elem->next;
-  }
+  if (NULL != truncatedp)
+    *truncatedp = 0;
+  if (NULL != next_markerp)
+    *next_markerp = NULL;
 
-  if (message == NULL)
-    return ;
+  return reply_parse(ctx, buf, len, objects, common_prefixes, truncatedp, next_markerp);
+}
 
-  if (code != NULL)
-    DPL_LOG((dpl_ctx_t *) ctx, DPL_ERROR, "Error: %s (%s)", message, code);
-  else
-    DPL_LOG((dpl_ctx_t *) ctx, DPL_ERROR, "Error: %s", message);
+dpl_status_t
+dpl_s3_parse_list_bucket(const dpl_ctx_t *ctx,
+                         const char *buf,
+                         int len,
+                         dpl_vec_t *objects,
+                         dpl_vec_t *common_prefixes)
+{
+  return dpl_s3_parse_list_bucket_page(ctx, buf, len, objects, common_prefixes,
+                                       NULL, NULL);
 }
 
 dpl_status_t
@@ -693,38 +992,7 @@ dpl_s3_parse_delete_all(const dpl_ctx_t *ctx,
                         const char *buf, int len,
                         dpl_vec_t *objects)
 {
-  int                   ret = DPL_SUCCESS;
-  xmlParserCtxtPtr      ctxt;
-  xmlDocPtr             doc;
-  xmlNode               *elem;
-
-  ctxt = xmlNewParserCtxt();
-  if (ctxt == NULL)
-    return DPL_FAILURE;
-
-  doc = xmlCtxtReadMemory(ctxt, buf, len, NULL, NULL, 0u);
-  if (doc == NULL) {
-    xmlFreeParserCtxt(ctxt);
-    return DPL_FAILURE;
-  }
-
-  elem = xmlDocGetRootElement(doc);
-  while (elem != NULL) {
-    if (elem->type == XML_ELEMENT_NODE) {
-      if (!strcmp((char *) elem->name, "DeleteResult")) {
-        ret = parse_delete_all_children(ctx, elem->children, objects);
-        if (ret != DPL_SUCCESS)
-          break;
-      } else if (!strcmp((char *) elem->name, "Error"))
-        parse_delete_all_error(ctx, elem->children);
-    }
-    elem = elem->next;
-  }
-
-  xmlFreeDoc(doc);
-  xmlFreeParserCtxt(ctxt);
-
-  return ret;
+  return reply_parse(ctx, buf, len, objects, NULL, NULL, NULL);
 }
 
 /**/
@@ -376,9 +376,35 @@ dpl_s3_req_build(const dpl_req_t *req,
               goto end;
             }
 
-          MD5_Init(&ctx);
-          MD5_Update(&ctx, req->data_buf, req->data_len);
-          MD5_Final(digest, &ctx);
+          if (4 == req->ctx->aws_auth_sign_version &&
+              NULL != req->ctx->secret_key &&
+              !req->ctx->aws_unsigned_payload &&
+              NULL == dpl_dict_get(headers, "x-amz-content-sha256"))
+            {
+              u_char sha256_digest[SHA256_DIGEST_LENGTH];
+              char sha256_hex[DPL_HEX_LENGTH(SHA256_DIGEST_LENGTH) + 1];
+              u_int sha256_hex_len;
+
+              //the payload hash of the signature is computed in the same pass
+              dpl_md5_sha256((uint8_t *) req->data_buf, req->data_len,
+                             digest, sha256_digest);
+
+              sha256_hex_len = dpl_bcd_encode(sha256_digest, SHA256_DIGEST_LENGTH, sha256_hex);
+              sha256_hex[sha256_hex_len] = 0;
+
+              ret2 = dpl_dict_add(headers, "x-amz-content-sha256", sha256_hex, 0);
+              if (DPL_SUCCESS != ret2)
+                {
+                  ret = ret2;
+                  goto end;
+                }
+            }
+          else
+            {
+              MD5_Init(&ctx);
+              MD5_Update(&ctx, req->data_buf, req->data_len);
+              MD5_Final(digest, &ctx);
+            }
 
           b64_digest_len = dpl_base64_encode(digest, MD5_DIGEST_LENGTH, (u_char *) b64_digest);
           b64_digest[b64_digest_len] = 0;
@@ -485,8 +511,10 @@ dpl_s3_req_build(const dpl_req_t *req,
 
               switch (req->copy_directive)
                 {
-                case DPL_COPY_DIRECTIVE_UNDEF:
                 case DPL_COPY_DIRECTIVE_COPY:
+                  str = "COPY";
+                  break ;
+                case DPL_COPY_DIRECTIVE_UNDEF:
                 case DPL_COPY_DIRECTIVE_LINK:
                 case DPL_COPY_DIRECTIVE_SYMLINK:
                 case DPL_COPY_DIRECTIVE_MOVE:
@@ -498,6 +526,9 @@ dpl_s3_req_build(const dpl_req_t *req,
                 case DPL_COPY_DIRECTIVE_METADATA_REPLACE:
                   str = "REPLACE";
                   break ;
+                default:
+                  ret = DPL_EINVAL;
+                  goto end;
                 }
 
               ret2 = dpl_dict_add(headers, "x-amz-metadata-directive", str, 0);
@@ -508,6 +539,17 @@ dpl_s3_req_build(const dpl_req_t *req,
                 }
             }
 
+          //part of an UploadPartCopy
+          if (req->range_enabled)
+            {
+              ret2 = dpl_add_copy_source_range_to_headers(&req->range, headers);
+              if (DPL_SUCCESS != ret2)
+                {
+                  ret = ret2;
+                  goto end;
+                }
+            }
+
           ret2 = add_conditions_to_headers(&req->copy_source_condition, headers, 1);
           if (DPL_SUCCESS != ret2)
             {
@@ -322,8 +322,13 @@ dpl_swift_get_metadatum_from_header(const char *header,
         {
           if (!strcmp(header, "content-length"))
             {
+              ret2 = dpl_parse_size(value, &sysmdp->size);
+              if (DPL_SUCCESS != ret2)
+                {
+                  ret = ret2;
+                  goto end;
+                }
               sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
-              sysmdp->size = atoi(value);
             }
           
           if (!strcmp(header, "last-modified"))
@@ -0,0 +1,873 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+/** @file */
+
+/*
+ * Transparent compression of object data, enabled by the compress
+ * profile setting or per call with DPL_OPTION_COMPRESS.
+ *
+ * The data is cut into fixed-size chunks which are compressed
+ * independently, so that a range of the original data maps to a range of
+ * whole stored chunks.  A chunk which does not shrink is stored as is,
+ * and is told apart by a stored length equal to its original length.
+ * The stored chunks are followed by an index holding their stored
+ * lengths as 32-bit big-endian integers, and by a trailer holding the
+ * original size as a 64-bit big-endian integer, from which the offset of
+ * the index derives.
+ *
+ * The codec and chunk size are recorded in user metadata, which is thus
+ * known before the first byte is written and can go along with the
+ * initiation of a multipart upload.  The original size is recorded too
+ * when known at that time, sparing a read of the trailer.  Objects which
+ * do not look compressible from a few samples are stored without any of
+ * it.
+ *
+ * zstd is used when built with it, as it is faster than zlib at a
+ * better ratio, zlib otherwise.  Objects are read whatever the codec they
+ * were written with, as long as the build supports it.
+ */
+
+#define COMPRESS_MIN_CHUNK_SIZE 4096
+#define COMPRESS_MAX_CHUNK_SIZE (16*1024*1024)
+#define COMPRESS_INDEX_ENTRY    4
+
+/* sampling heuristic */
+#define COMPRESS_MIN_SIZE       1024
+#define COMPRESS_SAMPLE_SIZE    4096
+#define COMPRESS_N_SAMPLES      4
+#define COMPRESS_MIN_SAVING     10      /* percent */
+
+/*
+ * a codec compresses a chunk into at most *out_lenp bytes, DPL_ELIMIT
+ * meaning that it does not fit, and restores exactly *out_lenp bytes
+ */
+struct dpl_compress_codec
+{
+  const char *name;
+  dpl_status_t (*compress)(int level, const char *in, size_t in_len, char *out, size_t *out_lenp);
+  dpl_status_t (*uncompress)(const char *in, size_t in_len, char *out, size_t *out_lenp);
+};
+
+#ifdef HAVE_ZSTD
+static dpl_status_t
+zstd_compress(int level,
+              const char *in,
+              size_t in_len,
+              char *out,
+              size_t *out_lenp)
+{
+  size_t zret;
+
+  zret = ZSTD_compress(out, *out_lenp, in, in_len, level);
+  if (ZSTD_isError(zret))
+    {
+      if (ZSTD_error_dstSize_tooSmall == ZSTD_getErrorCode(zret))
+        return DPL_ELIMIT;
+      return ZSTD_error_memory_allocation == ZSTD_getErrorCode(zret) ?
+        DPL_ENOMEM : DPL_FAILURE;
+    }
+
+  *out_lenp = zret;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+zstd_uncompress(const char *in,
+                size_t in_len,
+                char *out,
+                size_t *out_lenp)
+{
+  size_t zret;
+
+  zret = ZSTD_decompress(out, *out_lenp, in, in_len);
+  if (ZSTD_isError(zret) || zret != *out_lenp)
+    return DPL_EINTEGRITY;
+
+  return DPL_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_ZLIB
+static dpl_status_t
+zlib_compress(int level,
+              const char *in,
+              size_t in_len,
+              char *out,
+              size_t *out_lenp)
+{
+  uLongf out_len = *out_lenp;
+  int zret;
+
+  zret = compress2((Bytef *) out, &out_len, (const Bytef *) in, in_len, level);
+  if (Z_BUF_ERROR == zret)
+    return DPL_ELIMIT;
+  else if (Z_OK != zret)
+    return Z_MEM_ERROR == zret ? DPL_ENOMEM : DPL_FAILURE;
+
+  *out_lenp = out_len;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+zlib_uncompress(const char *in,
+                size_t in_len,
+                char *out,
+                size_t *out_lenp)
+{
+  uLongf out_len = *out_lenp;
+
+  if (Z_OK != uncompress((Bytef *) out, &out_len, (const Bytef *) in, in_len) ||
+      out_len != *out_lenp)
+    return DPL_EINTEGRITY;
+
+  return DPL_SUCCESS;
+}
+#endif
+
+/* by order of preference */
+static const struct dpl_compress_codec codecs[] = {
+#ifdef HAVE_ZSTD
+  { "zstd", zstd_compress, zstd_uncompress },
+#endif
+#ifdef HAVE_ZLIB
+  { "zlib", zlib_compress, zlib_uncompress },
+#endif
+  { NULL, NULL, NULL }
+};
+
+static const char *compress_keys[] = {
+  DPL_COMPRESS_MD_CODEC,
+  DPL_COMPRESS_MD_CHUNK,
+  DPL_COMPRESS_MD_SIZE,
+  NULL
+};
+
+/*
+ * the preferred codec if name is NULL
+ */
+static const struct dpl_compress_codec *
+codec_lookup(const char *name)
+{
+  int i;
+
+  for (i = 0;NULL != codecs[i].name;i++)
+    if (NULL == name || !strcmp(codecs[i].name, name))
+      return &codecs[i];
+
+  return NULL;
+}
+
+static int
+compress_level(dpl_ctx_t *ctx)
+{
+  if (ctx->compress_level < 1)
+    return 1;
+  else if (ctx->compress_level > 9)
+    return 9;
+
+  return ctx->compress_level;
+}
+
+/**
+ * tell whether this build can read and write data compressed with a codec
+ *
+ * @param name
+ *
+ * @return 1 or 0
+ */
+int
+dpl_compress_codec_supported(const char *name)
+{
+  return NULL != name && NULL != codec_lookup(name);
+}
+
+/**
+ * tell whether data written with this option is to be compressed
+ *
+ * @param ctx
+ * @param option may be NULL
+ *
+ * @return 1 or 0
+ */
+int
+dpl_compress_enabled(dpl_ctx_t *ctx,
+                     const dpl_option_t *option)
+{
+  if (NULL == codec_lookup(ctx->compress_codec))
+    return 0;
+
+  if (NULL != option && (option->mask & DPL_OPTION_NOCOMPRESS))
+    return 0;
+
+  if (NULL != option && (option->mask & DPL_OPTION_COMPRESS))
+    return 1;
+
+  return ctx->compress;
+}
+
+/**
+ * guess whether compressing data is worth it by compressing a few
+ * samples spread over it
+ *
+ * @param ctx
+ * @param buf
+ * @param len
+ *
+ * @return 1 or 0
+ */
+int
+dpl_compress_worthwhile(dpl_ctx_t *ctx,
+                        const char *buf,
+                        size_t len)
+{
+  const struct dpl_compress_codec *codec;
+  char out[COMPRESS_SAMPLE_SIZE];
+  size_t out_len, sample_len, stride, in_total = 0, out_total = 0;
+  int i, n_samples;
+
+  codec = codec_lookup(ctx->compress_codec);
+  if (NULL == codec)
+    return 0;
+
+  if (len < COMPRESS_MIN_SIZE)
+    return 0;
+
+  if (len <= COMPRESS_N_SAMPLES * COMPRESS_SAMPLE_SIZE)
+    {
+      n_samples = (len + COMPRESS_SAMPLE_SIZE - 1) / COMPRESS_SAMPLE_SIZE;
+      stride = COMPRESS_SAMPLE_SIZE;
+    }
+  else
+    {
+      n_samples = COMPRESS_N_SAMPLES;
+      stride = (len - COMPRESS_SAMPLE_SIZE) / (COMPRESS_N_SAMPLES - 1);
+    }
+
+  for (i = 0;i < n_samples;i++)
+    {
+      sample_len = MIN(COMPRESS_SAMPLE_SIZE, len - i * stride);
+
+      out_len = sizeof (out);
+      if (DPL_SUCCESS != codec->compress(compress_level(ctx), buf + i * stride,
+                                         sample_len, out, &out_len))
+        out_len = sample_len;
+
+      in_total += sample_len;
+      out_total += MIN(out_len, sample_len);
+    }
+
+  return out_total * 100 <= in_total * (100 - COMPRESS_MIN_SAVING);
+}
+
+/**
+ * start compressing a new object
+ *
+ * @param ctx
+ *
+ * @return NULL on error, or if built without any codec
+ */
+dpl_compress_t *
+dpl_compress_new(dpl_ctx_t *ctx)
+{
+  dpl_compress_t *comp;
+
+  comp = calloc(1, sizeof (*comp));
+  if (NULL == comp)
+    return NULL;
+
+  comp->codec = codec_lookup(ctx->compress_codec);
+  if (NULL == comp->codec)
+    {
+      free(comp);
+      return NULL;
+    }
+
+  comp->chunk_size = DPL_COMPRESS_CHUNK_SIZE;
+  comp->level = compress_level(ctx);
+
+  comp->max_chunks = 16;
+  comp->offsets = malloc((comp->max_chunks + 1) * sizeof (*comp->offsets));
+  if (NULL == comp->offsets)
+    {
+      free(comp);
+      return NULL;
+    }
+  comp->offsets[0] = 0;
+
+  return comp;
+}
+
+void
+dpl_compress_destroy(dpl_compress_t *comp)
+{
+  if (NULL == comp)
+    return;
+
+  free(comp->offsets);
+  free(comp);
+}
+
+/*
+ * original length of a chunk
+ */
+static size_t
+chunk_len(const dpl_compress_t *comp,
+          uint32_t i)
+{
+  return MIN(comp->chunk_size, comp->size - (uint64_t) i * comp->chunk_size);
+}
+
+/**
+ * compress data following what was already compressed
+ *
+ * only the last chunk of an object may be short, so len shall be a
+ * multiple of the chunk size but for the last call.
+ *
+ * @param comp
+ * @param in
+ * @param len
+ * @param out at least len bytes
+ * @param out_lenp
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_compress_deflate(dpl_compress_t *comp,
+                     const char *in,
+                     size_t len,
+                     char *out,
+                     size_t *out_lenp)
+{
+  uint64_t *offsets;
+  uint32_t max_chunks;
+  size_t in_len, stored_len, out_len = 0;
+  dpl_status_t ret;
+
+  while (len > 0)
+    {
+      if (comp->n_chunks == comp->max_chunks)
+        {
+          if (comp->max_chunks >= UINT32_MAX / 2)
+            return DPL_FAILURE;
+          max_chunks = comp->max_chunks * 2;
+          offsets = realloc(comp->offsets, (max_chunks + 1) * sizeof (*offsets));
+          if (NULL == offsets)
+            return DPL_ENOMEM;
+          comp->offsets = offsets;
+          comp->max_chunks = max_chunks;
+        }
+
+      in_len = MIN(comp->chunk_size, len);
+
+      /* anything short of a saving is stored as is */
+      stored_len = in_len - 1;
+      ret = comp->codec->compress(comp->level, in, in_len, out + out_len,
+                                  &stored_len);
+      if (DPL_ELIMIT == ret || (DPL_SUCCESS == ret && 0 == stored_len))
+        {
+          memcpy(out + out_len, in, in_len);
+          stored_len = in_len;
+        }
+      else if (DPL_SUCCESS != ret)
+        {
+          return ret;
+        }
+
+      comp->offsets[comp->n_chunks + 1] = comp->offsets[comp->n_chunks] + stored_len;
+      comp->n_chunks++;
+      comp->size += in_len;
+
+      in += in_len;
+      len -= in_len;
+      out_len += stored_len;
+    }
+
+  *out_lenp = out_len;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * size of the chunk index and of the trailer following it
+ *
+ * @param comp
+ *
+ * @return the size
+ */
+size_t
+dpl_compress_index_size(const dpl_compress_t *comp)
+{
+  return (size_t) comp->n_chunks * COMPRESS_INDEX_ENTRY + DPL_COMPRESS_TRAILER_SIZE;
+}
+
+/**
+ * write the chunk index and the trailer which follow the stored chunks
+ *
+ * @param comp
+ * @param buf dpl_compress_index_size() bytes
+ *
+ * @return the length written
+ */
+size_t
+dpl_compress_write_index(const dpl_compress_t *comp,
+                         char *buf)
+{
+  uint32_t i, len;
+  unsigned char *p = (unsigned char *) buf;
+
+  for (i = 0;i < comp->n_chunks;i++)
+    {
+      len = comp->offsets[i + 1] - comp->offsets[i];
+      *p++ = len >> 24;
+      *p++ = len >> 16;
+      *p++ = len >> 8;
+      *p++ = len;
+    }
+
+  for (i = 0;i < DPL_COMPRESS_TRAILER_SIZE;i++)
+    *p++ = comp->size >> (56 - 8 * i);
+
+  return dpl_compress_index_size(comp);
+}
+
+/**
+ * record the compression of an object in its user metadata
+ *
+ * @param comp
+ * @param metadata
+ * @param sized all the data was compressed, its size is recorded too
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_compress_seal(const dpl_compress_t *comp,
+                  dpl_dict_t *metadata,
+                  int sized)
+{
+  char buf[32];
+  dpl_status_t ret;
+
+  dpl_compress_strip(metadata);
+
+  ret = dpl_dict_add(metadata, DPL_COMPRESS_MD_CODEC, comp->codec->name, 0);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  snprintf(buf, sizeof (buf), "%u", comp->chunk_size);
+  ret = dpl_dict_add(metadata, DPL_COMPRESS_MD_CHUNK, buf, 0);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  if (sized)
+    {
+      snprintf(buf, sizeof (buf), "%llu", (unsigned long long) comp->size);
+      ret = dpl_dict_add(metadata, DPL_COMPRESS_MD_SIZE, buf, 0);
+      if (DPL_SUCCESS != ret)
+        return ret;
+    }
+
+  return DPL_SUCCESS;
+}
+
+static int
+get_ull(const dpl_dict_t *metadata,
+        const char *key,
+        unsigned long long *ullp)
+{
+  char *value, *endp;
+
+  value = dpl_dict_get_value(metadata, key);
+  if (NULL == value || !isdigit((unsigned char) value[0]))
+    return -1;
+
+  errno = 0;
+  *ullp = strtoull(value, &endp, 10);
+  if (*endp || ERANGE == errno)
+    return -1;
+
+  return 0;
+}
+
+/*
+ * set the original size and what derives from it
+ */
+static int
+set_size(dpl_compress_t *comp,
+         uint64_t size)
+{
+  uint64_t n_chunks;
+
+  n_chunks = size / comp->chunk_size + (0 != size % comp->chunk_size);
+  if (n_chunks > (UINT32_MAX - DPL_COMPRESS_TRAILER_SIZE) / COMPRESS_INDEX_ENTRY)
+    return -1;
+
+  comp->size = size;
+  comp->n_chunks = n_chunks;
+
+  return 0;
+}
+
+/**
+ * read the compression of an object from its user metadata
+ *
+ * the chunk index still has to be loaded with dpl_compress_load_index()
+ * before data can be inflated, as well as the original size unless it
+ * was recorded in the metadata.
+ *
+ * @param ctx
+ * @param metadata may be NULL
+ * @param compp
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ * @return DPL_ENOENT the object is not compressed
+ * @return DPL_EINTEGRITY the metadata is malformed
+ * @return DPL_ENOTSUPP codec unknown or not built in
+ */
+dpl_status_t
+dpl_compress_open(dpl_ctx_t *ctx,
+                  const dpl_dict_t *metadata,
+                  dpl_compress_t **compp)
+{
+  const struct dpl_compress_codec *codec;
+  dpl_compress_t *comp;
+  unsigned long long chunk_size, size;
+  char *value;
+
+  if (NULL == metadata)
+    return DPL_ENOENT;
+
+  value = dpl_dict_get_value(metadata, DPL_COMPRESS_MD_CODEC);
+  if (NULL == value)
+    return DPL_ENOENT;
+
+  codec = codec_lookup(value);
+  if (NULL == codec)
+    {
+      DPL_LOG(ctx, DPL_ERROR, "unsupported compression codec %s", value);
+      return DPL_ENOTSUPP;
+    }
+
+  if (-1 == get_ull(metadata, DPL_COMPRESS_MD_CHUNK, &chunk_size))
+    return DPL_EINTEGRITY;
+
+  if (chunk_size < COMPRESS_MIN_CHUNK_SIZE ||
+      chunk_size > COMPRESS_MAX_CHUNK_SIZE)
+    return DPL_EINTEGRITY;
+
+  comp = calloc(1, sizeof (*comp));
+  if (NULL == comp)
+    return DPL_ENOMEM;
+
+  comp->codec = codec;
+  comp->chunk_size = chunk_size;
+  comp->size = DPL_UNDEF;
+
+  if (NULL != dpl_dict_get(metadata, DPL_COMPRESS_MD_SIZE))
+    {
+      if (-1 == get_ull(metadata, DPL_COMPRESS_MD_SIZE, &size) ||
+          -1 == set_size(comp, size))
+        {
+          dpl_compress_destroy(comp);
+          return DPL_EINTEGRITY;
+        }
+    }
+
+  *compp = comp;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * stored range to fetch for dpl_compress_load_index(): the chunk index
+ * and the trailer, or the trailer alone while the original size is not
+ * known
+ *
+ * @param comp
+ * @param stored_size
+ * @param rangep
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINTEGRITY the object is too short
+ */
+dpl_status_t
+dpl_compress_index_range(const dpl_compress_t *comp,
+                         uint64_t stored_size,
+                         dpl_range_t *rangep)
+{
+  size_t len;
+
+  if (DPL_UNDEF == comp->size)
+    len = DPL_COMPRESS_TRAILER_SIZE;
+  else
+    len = dpl_compress_index_size(comp);
+
+  if (stored_size < len)
+    return DPL_EINTEGRITY;
+
+  rangep->start = stored_size - len;
+  rangep->end = stored_size - 1;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * load the chunk index of an object opened with dpl_compress_open()
+ *
+ * buf holds the end of the stored object, from which the original size
+ * is read.  If buf does not hold the whole chunk index, it is to be
+ * fetched again with dpl_compress_index_range() and comp->offsets stays
+ * NULL.
+ *
+ * @param comp
+ * @param stored_size
+ * @param buf
+ * @param len
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ * @return DPL_EINTEGRITY the index does not match the metadata or the size
+ */
+dpl_status_t
+dpl_compress_load_index(dpl_compress_t *comp,
+                        uint64_t stored_size,
+                        const char *buf,
+                        size_t len)
+{
+  const unsigned char *p;
+  uint64_t *offsets;
+  uint64_t size = 0;
+  uint32_t i, stored_len;
+  size_t index_size;
+
+  if (len < DPL_COMPRESS_TRAILER_SIZE || len > stored_size)
+    return DPL_EINTEGRITY;
+
+  p = (const unsigned char *) buf + len - DPL_COMPRESS_TRAILER_SIZE;
+  for (i = 0;i < DPL_COMPRESS_TRAILER_SIZE;i++)
+    size = (size << 8) | p[i];
+
+  if (DPL_UNDEF != comp->size && size != comp->size)
+    return DPL_EINTEGRITY;
+
+  if (-1 == set_size(comp, size))
+    return DPL_EINTEGRITY;
+
+  index_size = dpl_compress_index_size(comp);
+  if (stored_size < index_size)
+    return DPL_EINTEGRITY;
+  comp->index_offset = stored_size - index_size;
+
+  if (len < index_size)
+    return DPL_SUCCESS;
+
+  offsets = malloc(((size_t) comp->n_chunks + 1) * sizeof (*offsets));
+  if (NULL == offsets)
+    return DPL_ENOMEM;
+
+  p = (const unsigned char *) buf + len - index_size;
+  offsets[0] = 0;
+  for (i = 0;i < comp->n_chunks;i++)
+    {
+      stored_len = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+        ((uint32_t) p[2] << 8) | p[3];
+      p += COMPRESS_INDEX_ENTRY;
+
+      if (0 == stored_len || stored_len > chunk_len(comp, i))
+        {
+          free(offsets);
+          return DPL_EINTEGRITY;
+        }
+
+      offsets[i + 1] = offsets[i] + stored_len;
+    }
+
+  if (offsets[comp->n_chunks] != comp->index_offset)
+    {
+      free(offsets);
+      return DPL_EINTEGRITY;
+    }
+
+  free(comp->offsets);
+  comp->offsets = offsets;
+  comp->max_chunks = comp->n_chunks;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * stored range of the chunks holding an original range
+ *
+ * @param comp with its index loaded
+ * @param start
+ * @param end last byte, inclusive, shall be below the original size
+ * @param rangep
+ *
+ * @return the index of the first chunk
+ */
+uint32_t
+dpl_compress_range(const dpl_compress_t *comp,
+                   uint64_t start,
+                   uint64_t end,
+                   dpl_range_t *rangep)
+{
+  uint32_t first, last;
+
+  first = start / comp->chunk_size;
+  last = end / comp->chunk_size;
+
+  rangep->start = comp->offsets[first];
+  rangep->end = comp->offsets[last + 1] - 1;
+
+  return first;
+}
+
+/**
+ * inflate consecutive stored chunks
+ *
+ * @param comp with its index loaded
+ * @param first index of the first chunk
+ * @param in whole stored chunks
+ * @param len
+ * @param out room for the original chunks
+ * @param out_lenp
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINTEGRITY a chunk is corrupt or truncated
+ */
+dpl_status_t
+dpl_compress_inflate(const dpl_compress_t *comp,
+                     uint32_t first,
+                     const char *in,
+                     size_t len,
+                     char *out,
+                     size_t *out_lenp)
+{
+  size_t stored_len, plain_len, out_len = 0;
+  uint32_t i;
+
+  for (i = first;len > 0;i++)
+    {
+      if (i >= comp->n_chunks)
+        return DPL_EINTEGRITY;
+
+      stored_len = comp->offsets[i + 1] - comp->offsets[i];
+      if (stored_len > len)
+        return DPL_EINTEGRITY;
+
+      plain_len = chunk_len(comp, i);
+      if (stored_len == plain_len)
+        memcpy(out + out_len, in, stored_len);
+      else if (DPL_SUCCESS != comp->codec->uncompress(in, stored_len,
+                                                      out + out_len, &plain_len))
+        return DPL_EINTEGRITY;
+
+      in += stored_len;
+      len -= stored_len;
+      out_len += plain_len;
+    }
+
+  *out_lenp = out_len;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * remove the compression metadata, e.g. before handing metadata to the
+ * user
+ *
+ * @param metadata may be NULL
+ */
+void
+dpl_compress_strip(dpl_dict_t *metadata)
+{
+  dpl_dict_var_t *var;
+  int i;
+
+  if (NULL == metadata)
+    return;
+
+  for (i = 0;NULL != compress_keys[i];i++)
+    {
+      var = dpl_dict_get(metadata, compress_keys[i]);
+      if (NULL != var)
+        dpl_dict_remove(metadata, var);
+    }
+}
+
+/**
+ * carry the compression metadata of an object over to metadata which is
+ * about to replace its own
+ *
+ * @param src user metadata of the object
+ * @param dst
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_compress_copy_md(const dpl_dict_t *src,
+                     dpl_dict_t *dst)
+{
+  char *value;
+  dpl_status_t ret;
+  int i;
+
+  for (i = 0;NULL != compress_keys[i];i++)
+    {
+      value = dpl_dict_get_value(src, compress_keys[i]);
+      if (NULL == value)
+        continue ;
+
+      ret = dpl_dict_add(dst, compress_keys[i], value, 0);
+      if (DPL_SUCCESS != ret)
+        return ret;
+    }
+
+  return DPL_SUCCESS;
+}
@@ -40,6 +40,8 @@
 
 //#define DEBUG
 
+#define RATE_LIMIT_SLICE (64*1024)
+
 dpl_ctx_t *dpl_default_conn_ctx = NULL;
 
 static u_int
@@ -365,7 +367,21 @@ do_connect(dpl_ctx_t *ctx,
 }
 
 static int
-init_ssl_conn(dpl_ctx_t *ctx, dpl_conn_t *conn)
+is_numeric_host(const char *host)
+{
+  struct in6_addr addr;
+
+  return 1 == inet_pton(AF_INET, host, &addr) ||
+    1 == inet_pton(AF_INET6, host, &addr);
+}
+
+/*
+ * sni is the name of the endpoint, not of a virtual-hosted bucket, so
+ * that the connection can be shared by all the buckets it serves: the
+ * bucket only appears in the Host header of each request.
+ */
+static int
+init_ssl_conn(dpl_ctx_t *ctx, dpl_conn_t *conn, const char *sni)
 {
   int ret;
 
@@ -379,6 +395,11 @@ init_ssl_conn(dpl_ctx_t *ctx, dpl_conn_t *conn)
 
   SSL_set_bio(conn->ssl, conn->bio, conn->bio);
 
+#ifdef SSL_CTRL_SET_TLSEXT_HOSTNAME
+  if (NULL != sni && !is_numeric_host(sni))
+    SSL_set_tlsext_host_name(conn->ssl, sni);
+#endif
+
   ret = SSL_connect(conn->ssl);
   if (ret <= 0) {
     int ret_ssl = 0;
@@ -410,7 +431,8 @@ init_ssl_conn(dpl_ctx_t *ctx, dpl_conn_t *conn)
 static dpl_conn_t *
 conn_open(dpl_ctx_t *ctx,
           struct hostent *host,
-          u_short port)
+          u_short port,
+          const char *sni)
 {
   dpl_conn_t    *conn = NULL;
   time_t        now = time(0);
@@ -496,7 +518,7 @@ conn_open(dpl_ctx_t *ctx,
   conn->n_hits = 0;
 
   if (ctx->use_https) {
-    if (!init_ssl_conn(ctx, conn)) {
+    if (!init_ssl_conn(ctx, conn, sni)) {
       dpl_conn_free(conn);
       conn = NULL;
       goto end;
@@ -514,6 +536,34 @@ conn_open(dpl_ctx_t *ctx,
   return conn;
 }
 
+static int
+conn_set_endpoint(dpl_conn_t *conn,
+                  const char *host,
+                  const char *portstr)
+{
+  char *nstr;
+
+  nstr = strdup(host);
+  if (NULL == nstr)
+    return -1;
+
+  if (NULL != conn->host)
+    free(conn->host);
+
+  conn->host = nstr;
+
+  nstr = strdup(portstr);
+  if (NULL == nstr)
+    return -1;
+
+  if (NULL != conn->port)
+    free(conn->port);
+
+  conn->port = nstr;
+
+  return 0;
+}
+
 dpl_conn_t *
 dpl_conn_open_host(dpl_ctx_t *ctx, int af,
                    const char *host,
@@ -525,7 +575,6 @@ dpl_conn_open_host(dpl_ctx_t *ctx, int af,
   int                   herr = 0;
   u_short               port;
   dpl_conn_t            *conn = NULL;
-  char                  *nstr;
 
   ret2 = dpl_gethostbyname2_r(host, af, &hret, hbuf, sizeof (hbuf), &hresult, &herr);
   if (0 != ret2 || hresult == NULL) {
@@ -535,30 +584,15 @@ dpl_conn_open_host(dpl_ctx_t *ctx, int af,
   }
 
   port = atoi(portstr);
-  conn = conn_open(ctx, hresult, port);
+  conn = conn_open(ctx, hresult, port, host);
   if (NULL == conn) {
     DPL_TRACE(ctx, DPL_TRACE_ERR, "connect failed");
     goto bad;
   }
 
-  nstr = strdup(host);
-  if (NULL == nstr)
-    goto bad;
-
-  if (NULL != conn->host)
-    free(conn->host);
-
-  conn->host = nstr;
-
-  nstr = strdup(portstr);
-  if (NULL == nstr)
+  if (-1 == conn_set_endpoint(conn, host, portstr))
     goto bad;
 
-  if (NULL != conn->port)
-    free(conn->port);
-
-  conn->port = nstr;
-
   return conn;
 
  bad:
@@ -569,6 +603,253 @@ dpl_conn_open_host(dpl_ctx_t *ctx, int af,
   return NULL;
 }
 
+/*
+ * Virtual-hosted buckets: "bucket.host" names are resolved once and
+ * remembered for vhost_cache_ttl seconds.  As the pool is keyed by
+ * address, all the buckets served by the same endpoint then share its
+ * idle connections instead of each paying for a lookup and a handshake.
+ */
+struct dpl_vhost
+{
+  struct dpl_vhost *next;
+  char *name;
+  int af;
+  int addr_len;
+  char addr[sizeof (struct in6_addr)];
+  time_t expire;
+};
+
+/**
+ * look up the address cached for the virtual host name
+ *
+ * expired entries met on the way are dropped
+ *
+ * @return 1 if found, with the address in addr, 0 otherwise
+ */
+int
+dpl_vhost_lookup(dpl_ctx_t *ctx,
+                 const char *name,
+                 int af,
+                 char *addr,
+                 int *addr_lenp)
+{
+  struct dpl_vhost *vhost, **prev;
+  time_t now = time(0);
+  int hit = 0;
+
+  if (NULL == ctx->vhost_buckets)
+    return 0;
+
+  dpl_ctx_lock(ctx);
+
+  prev = &ctx->vhost_buckets[conn_hashcode((const unsigned char *) name, strlen(name)) % ctx->n_conn_buckets];
+  while (NULL != (vhost = *prev))
+    {
+      if (vhost->expire <= now)
+        {
+          *prev = vhost->next;
+          free(vhost->name);
+          free(vhost);
+          continue ;
+        }
+
+      if (vhost->af == af && !strcmp(vhost->name, name))
+        {
+          memcpy(addr, vhost->addr, vhost->addr_len);
+          *addr_lenp = vhost->addr_len;
+          hit = 1;
+          break ;
+        }
+
+      prev = &vhost->next;
+    }
+
+  dpl_ctx_unlock(ctx);
+
+  return hit;
+}
+
+/**
+ * remember the address of the virtual host name for vhost_cache_ttl seconds
+ */
+void
+dpl_vhost_insert(dpl_ctx_t *ctx,
+                 const char *name,
+                 int af,
+                 const char *addr,
+                 int addr_len)
+{
+  struct dpl_vhost *vhost, **bucketp;
+
+  if (NULL == ctx->vhost_buckets || addr_len > (int) sizeof (vhost->addr))
+    return ;
+
+  vhost = malloc(sizeof (*vhost));
+  if (NULL == vhost)
+    return ;
+
+  vhost->name = strdup(name);
+  if (NULL == vhost->name)
+    {
+      free(vhost);
+      return ;
+    }
+  vhost->af = af;
+  vhost->addr_len = addr_len;
+  memcpy(vhost->addr, addr, addr_len);
+  vhost->expire = time(0) + ctx->vhost_cache_ttl;
+
+  dpl_ctx_lock(ctx);
+
+  bucketp = &ctx->vhost_buckets[conn_hashcode((const unsigned char *) name, strlen(name)) % ctx->n_conn_buckets];
+  vhost->next = *bucketp;
+  *bucketp = vhost;
+
+  dpl_ctx_unlock(ctx);
+}
+
+/**
+ * drop the addresses cached for the virtual host name
+ */
+void
+dpl_vhost_forget(dpl_ctx_t *ctx,
+                 const char *name)
+{
+  struct dpl_vhost *vhost, **prev;
+
+  if (NULL == ctx->vhost_buckets)
+    return ;
+
+  dpl_ctx_lock(ctx);
+
+  prev = &ctx->vhost_buckets[conn_hashcode((const unsigned char *) name, strlen(name)) % ctx->n_conn_buckets];
+  while (NULL != (vhost = *prev))
+    {
+      if (!strcmp(vhost->name, name))
+        {
+          *prev = vhost->next;
+          free(vhost->name);
+          free(vhost);
+          continue ;
+        }
+      prev = &vhost->next;
+    }
+
+  dpl_ctx_unlock(ctx);
+}
+
+/*
+ * whether the endpoint addr itself has the address vaddr
+ */
+static int
+addr_has(const dpl_addr_t *addr,
+         const char *vaddr,
+         int vaddr_len)
+{
+  char **ap;
+
+  if (addr->h->h_length != vaddr_len)
+    return 0;
+
+  for (ap = addr->h->h_addr_list;NULL != *ap;ap++)
+    if (!memcmp(*ap, vaddr, vaddr_len))
+      return 1;
+
+  return 0;
+}
+
+/*
+ * connect to the address "vhost" resolves to, on behalf of the endpoint
+ * addr: the connection is recorded as belonging to addr, so that errors
+ * blacklist the endpoint as they do for path-style requests.
+ *
+ * *resolvedp is cleared if the name itself does not resolve, in which
+ * case the endpoint is not at fault.  A connect failure only forgets the
+ * bucket's address, which is looked up again once if it came from the
+ * cache, and *endpoint_downp is set only if that address is one of the
+ * endpoint's own.
+ */
+static dpl_conn_t *
+conn_open_vhost(dpl_ctx_t *ctx,
+                dpl_addr_t *addr,
+                const char *vhost,
+                int *resolvedp,
+                int *endpoint_downp)
+{
+  int                   ret2;
+  struct hostent        hret, *hresult;
+  char                  hbuf[1024];
+  int                   herr = 0;
+  char                  vaddr[sizeof (struct in6_addr)];
+  int                   vaddr_len;
+  char                  *addr_list[2];
+  int                   af = addr->h->h_addrtype;
+  dpl_conn_t            *conn = NULL;
+  int                   cached;
+  int                   relooked = 0;
+
+  *resolvedp = 1;
+  *endpoint_downp = 0;
+
+ again:
+  cached = dpl_vhost_lookup(ctx, vhost, af, vaddr, &vaddr_len);
+  if (!cached)
+    {
+      ret2 = dpl_gethostbyname2_r(vhost, af, &hret, hbuf, sizeof (hbuf), &hresult, &herr);
+      if (0 != ret2 || hresult == NULL) {
+        DPL_LOG(ctx, DPL_ERROR, "Failed to lookup hostname \"%s\": %s",
+                vhost, hstrerror(herr));
+        *resolvedp = 0;
+        return NULL;
+      }
+
+      vaddr_len = hresult->h_length;
+      if (vaddr_len > (int) sizeof (vaddr))
+        {
+          *resolvedp = 0;
+          return NULL;
+        }
+      memcpy(vaddr, hresult->h_addr, vaddr_len);
+
+      if (ctx->vhost_cache_ttl > 0)
+        dpl_vhost_insert(ctx, vhost, af, vaddr, vaddr_len);
+    }
+  else
+    DPL_TRACE(ctx, DPL_TRACE_CONN, "vhost cache hit %s", vhost);
+
+  memset(&hret, 0, sizeof (hret));
+  hret.h_name = (char *) vhost;
+  hret.h_addrtype = af;
+  hret.h_length = vaddr_len;
+  addr_list[0] = vaddr;
+  addr_list[1] = NULL;
+  hret.h_addr_list = addr_list;
+
+  conn = conn_open(ctx, &hret, addr->port, addr->host);
+  if (NULL == conn) {
+    DPL_TRACE(ctx, DPL_TRACE_ERR, "connect failed");
+    dpl_vhost_forget(ctx, vhost);
+
+    //the bucket may have moved since it was cached
+    if (cached && !relooked)
+      {
+        relooked = 1;
+        goto again;
+      }
+
+    *endpoint_downp = addr_has(addr, vaddr, vaddr_len);
+    return NULL;
+  }
+
+  if (-1 == conn_set_endpoint(conn, addr->host, addr->portstr))
+    {
+      dpl_conn_release(conn);
+      return NULL;
+    }
+
+  return conn;
+}
+
 void
 dpl_blacklist_host(dpl_ctx_t *ctx,
                    const char *host,
@@ -591,7 +872,9 @@ dpl_blacklist_host(dpl_ctx_t *ctx,
  * the profile, connections will be distributed between those hosts in
  * a round-robin manner.  Any failure while connecting will cause the
  * failing host to be blacklisted and the connection retried with
- * another host; if no hosts remain, `DPL_FAILURE` is returned.
+ * another host; if no hosts remain, `DPL_FAILURE` is returned.  With
+ * virtual hosting, a failure to reach the bucket's own address does
+ * not blacklist the host, which still serves other buckets.
  *
  * On success, a pointer to a connection is returned in `*connp`.  You
  * should release the connection by calling either `dpl_conn_release()` or
@@ -613,6 +896,12 @@ dpl_try_connect(dpl_ctx_t *ctx,
   dpl_conn_t    *conn = NULL;
   dpl_status_t  ret, ret2;
   char          virtual_host[1024], *hostp = NULL;
+  int           resolved = 1;
+  int           endpoint_down = 1;
+  u_int         n_avoided = 0;
+  u_int         n_vhost_failed = 0;
+
+  dpl_rate_limit_request(ctx);
 
  retry:
   pthread_mutex_lock(&ctx->lock);
@@ -625,21 +914,35 @@ dpl_try_connect(dpl_ctx_t *ctx,
   ret2 = dpl_addrlist_get_nth(ctx->addrlist, cur_host, &addr);
   if (DPL_SUCCESS != ret2) {
     DPL_TRACE(ctx, DPL_TRACE_CONN, "no more host to contact, giving up");
-    ret = DPL_FAILURE;
+    ret = DPL_ECONNECT;
     goto end;
   }
 
+  if (dpl_hedge_avoid(ctx, addr) &&
+      ++n_avoided < dpl_addrlist_count(ctx->addrlist))
+    goto retry;
+
   if (req->behavior_flags & DPL_BEHAVIOR_VIRTUAL_HOSTING) {
     snprintf(virtual_host, sizeof (virtual_host), "%s.%s", req->bucket, addr->host);
     hostp = virtual_host;
-  } else
+    conn = conn_open_vhost(ctx, addr, hostp, &resolved, &endpoint_down);
+  } else {
     hostp = addr->host;
+    conn = dpl_conn_open_host(ctx, addr->h->h_addrtype, hostp, addr->portstr);
+  }
 
-  conn = dpl_conn_open_host(ctx, addr->h->h_addrtype, hostp, addr->portstr);
   if (NULL == conn) {
-    if (req->behavior_flags & DPL_BEHAVIOR_VIRTUAL_HOSTING) {
+    if (!resolved) {
       ret = DPL_FAILURE;
       goto end;
+    } else if (!endpoint_down) {
+      //only the bucket is unreachable through this endpoint, which
+      //still serves the others
+      if (++n_vhost_failed >= dpl_addrlist_count(ctx->addrlist)) {
+        ret = DPL_ECONNECT;
+        goto end;
+      }
+      goto retry;
     } else {
       dpl_blacklist_host(ctx, addr->host, addr->portstr);
       goto retry;
@@ -658,6 +961,9 @@ dpl_try_connect(dpl_ctx_t *ctx,
     goto end;
   }
 
+  clock_gettime(CLOCK_MONOTONIC, &conn->request_start);
+  dpl_hedge_attach(conn, addr);
+
   ret = DPL_SUCCESS;
 
   if (NULL != connp) {
@@ -690,6 +996,8 @@ dpl_try_connect(dpl_ctx_t *ctx,
 void
 dpl_conn_release(dpl_conn_t *conn)
 {
+  dpl_hedge_detach(conn);
+
   dpl_ctx_lock(conn->ctx);
 
   if (conn->type == DPL_CONN_TYPE_FILE)
@@ -703,6 +1011,14 @@ dpl_conn_release(dpl_conn_t *conn)
 
   DPL_TRACE(conn->ctx, DPL_TRACE_CONN, "conn_release conn=%p", conn);
 
+  //its socket was shut down
+  if (conn->cancelled)
+    {
+      dpl_conn_terminate_nolock(conn);
+      dpl_ctx_unlock(conn->ctx);
+      return ;
+    }
+
   conn->close_time = time(0);
   dpl_conn_add_nolock(conn);
 
@@ -728,6 +1044,8 @@ dpl_conn_terminate(dpl_conn_t *conn)
 
   ctx = conn->ctx;
 
+  dpl_hedge_detach(conn);
+
   dpl_ctx_lock(ctx);
 
   assert(conn->type == DPL_CONN_TYPE_HTTP);
@@ -745,6 +1063,18 @@ dpl_conn_pool_init(dpl_ctx_t *ctx)
 
   memset(ctx->conn_buckets, 0, ctx->n_conn_buckets * sizeof (dpl_conn_t *));
 
+  ctx->vhost_buckets = NULL;
+  if (ctx->vhost_cache_ttl > 0)
+    {
+      ctx->vhost_buckets = calloc(ctx->n_conn_buckets, sizeof (struct dpl_vhost *));
+      if (NULL == ctx->vhost_buckets)
+        {
+          free(ctx->conn_buckets);
+          ctx->conn_buckets = NULL;
+          return DPL_FAILURE;
+        }
+    }
+
   return DPL_SUCCESS;
 }
 
@@ -767,6 +1097,24 @@ dpl_conn_pool_destroy(dpl_ctx_t *ctx)
 
       free(ctx->conn_buckets);
     }
+
+  if (NULL != ctx->vhost_buckets)
+    {
+      struct dpl_vhost *vhost, *next;
+
+      for (bucket = 0;bucket < ctx->n_conn_buckets;bucket++)
+        {
+          for (vhost = ctx->vhost_buckets[bucket];vhost;vhost = next)
+            {
+              next = vhost->next;
+              free(vhost->name);
+              free(vhost);
+            }
+        }
+
+      free(ctx->vhost_buckets);
+      ctx->vhost_buckets = NULL;
+    }
 }
 
 /*
@@ -824,7 +1172,7 @@ writev_all_plaintext(dpl_conn_t *conn,
           if (EINTR == errno)
             continue ;
 
-          return DPL_FAILURE;
+          return DPL_EIO;
         }
 
       for (i = 0;i < n_iov;i++)
@@ -888,13 +1236,78 @@ writev_all_ssl(dpl_conn_t *conn,
     {
       DPL_SSL_PERROR(conn->ctx, "SSL_write");
       free(ptr);
-      return DPL_FAILURE;
+      return DPL_EIO;
     }
 
   free(ptr);
   return DPL_SUCCESS;
 }
 
+/*
+ * Write an IO vector in slices, each one waiting for the upload rate
+ * limit, so that a large body is paced instead of being sent at once
+ * and followed by a long pause.
+ */
+static dpl_status_t
+writev_all_limited(dpl_conn_t *conn,
+                   struct iovec *iov,
+                   int n_iov,
+                   int timeout)
+{
+  struct iovec *slice;
+  int i, n_slice;
+  size_t off, len, room;
+  dpl_status_t ret;
+
+  slice = malloc(n_iov * sizeof (*slice));
+  if (NULL == slice)
+    return DPL_ENOMEM;
+
+  i = 0;
+  off = 0;
+  ret = DPL_SUCCESS;
+
+  while (i < n_iov)
+    {
+      n_slice = 0;
+      room = RATE_LIMIT_SLICE;
+
+      while (i < n_iov && room > 0)
+        {
+          len = MIN(iov[i].iov_len - off, room);
+          if (len > 0)
+            {
+              slice[n_slice].iov_base = (char *) iov[i].iov_base + off;
+              slice[n_slice].iov_len = len;
+              n_slice++;
+              room -= len;
+              off += len;
+            }
+          if (off == iov[i].iov_len)
+            {
+              i++;
+              off = 0;
+            }
+        }
+
+      if (0 == n_slice)
+        break ;
+
+      dpl_rate_limit_upload(conn->ctx, RATE_LIMIT_SLICE - room);
+
+      if (0 == conn->ctx->use_https)
+        ret = writev_all_plaintext(conn, slice, n_slice, timeout);
+      else
+        ret = writev_all_ssl(conn, slice, n_slice, timeout);
+      if (DPL_SUCCESS != ret)
+        break ;
+    }
+
+  free(slice);
+
+  return ret;
+}
+
 /**
  * Write an IO vector to the connection.
  *
@@ -924,21 +1337,55 @@ dpl_conn_writev_all(dpl_conn_t *conn,
   if (conn->ctx->trace_buffers)
     dpl_iov_dump(iov, n_iov, dpl_iov_size(iov, n_iov), conn->ctx->trace_binary);
 
-  if (0 == conn->ctx->use_https)
+  if (dpl_rate_limit_upload_enabled(conn->ctx) && DPL_CONN_TYPE_HTTP == conn->type)
+    ret = writev_all_limited(conn, iov, n_iov, timeout);
+  else if (0 == conn->ctx->use_https)
     ret = writev_all_plaintext(conn, iov, n_iov, timeout);
   else
     ret = writev_all_ssl(conn, iov, n_iov, timeout);
 
   if (DPL_SUCCESS != ret)
     {
-      //blacklist host
-      if (DPL_CONN_TYPE_HTTP == conn->type)
+      //blacklist host, unless the failure is a hedging cancellation
+      if (DPL_CONN_TYPE_HTTP == conn->type && !conn->cancelled)
         dpl_blacklist_host(conn->ctx, conn->host, conn->port);
     }
 
   return ret;
 }
 
+/**
+ * Account for the reply latency of the current request.
+ *
+ * Called when the status line of the reply has been read, the time since
+ * `dpl_try_connect()` returned the connection feeds the per-host latency
+ * of the address list and the delay of hedged requests.  A hedged request
+ * which got this far is not hedged any more.
+ *
+ * @param conn the connection the reply is read from
+ */
+void
+dpl_conn_record_latency(dpl_conn_t *conn)
+{
+  struct timespec now;
+  uint64_t usec;
+
+  dpl_hedge_replied(conn->ctx);
+
+  if (0 == conn->request_start.tv_sec && 0 == conn->request_start.tv_nsec)
+    return ;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  usec = (now.tv_sec - conn->request_start.tv_sec) * 1000000 +
+    (now.tv_nsec - conn->request_start.tv_nsec) / 1000;
+  memset(&conn->request_start, 0, sizeof (conn->request_start));
+
+  DPL_TRACE(conn->ctx, DPL_TRACE_CONN, "reply latency %s:%s %lluus", conn->host, conn->port, (unsigned long long) usec);
+
+  dpl_addrlist_record_latency(conn->ctx->addrlist, conn->host, conn->port, usec);
+  dpl_hedge_record(conn->ctx, usec);
+}
+
 /**
  * Create a connection to a local file
  *
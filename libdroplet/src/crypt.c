@@ -0,0 +1,917 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+#include <openssl/evp.h>
+
+/** @file */
+
+/*
+ * Client-side encryption of object data, enabled by the encrypt_key
+ * profile setting.
+ *
+ * Each object gets a random data key and base IV.  The data is cut into
+ * fixed-size chunks which are sealed independently with AES-256-GCM, the
+ * chunk index being both xored into the IV and authenticated as AAD, so
+ * that a range of the plaintext maps to a range of whole ciphertext
+ * chunks which can be fetched and verified on their own.  Chunks are
+ * laid out back to back, each followed by its tag.  The last chunk is
+ * always partial, empty if need be, and is flagged as such in its AAD:
+ * chunks dropped at the end are detected, and the plaintext size follows
+ * from the stored size.
+ *
+ * The data key is wrapped with a key derived from encrypt_key and a
+ * random salt, and stored along with the salt, IV and chunk size in user
+ * metadata (the envelope).  Nothing in it depends on the data, so that it
+ * can be sent when a multipart upload is initiated.  A context draws one
+ * salt for all the objects it writes, and keeps the keys derived for the
+ * salts it reads.
+ */
+
+#define CRYPT_SCHEME            "aes-256-gcm"
+#define CRYPT_KDF_ITERATIONS    600000
+#define CRYPT_MIN_CHUNK_SIZE    4096
+#define CRYPT_MAX_CHUNK_SIZE    (16*1024*1024)
+#define CRYPT_N_CACHED_KEYS     8
+
+/* wrap IV | wrapped data key | tag */
+#define CRYPT_WRAPPED_SIZE      (DPL_CRYPT_IV_SIZE + DPL_CRYPT_KEY_SIZE + DPL_CRYPT_TAG_SIZE)
+
+/* chunk index | final flag */
+#define CRYPT_CHUNK_AAD_SIZE    9
+
+static const char *envelope_keys[] = {
+  DPL_CRYPT_MD_SCHEME,
+  DPL_CRYPT_MD_CHUNK,
+  DPL_CRYPT_MD_SALT,
+  DPL_CRYPT_MD_IV,
+  DPL_CRYPT_MD_KEY,
+  NULL
+};
+
+struct crypt_kek
+{
+  unsigned char salt[DPL_CRYPT_SALT_SIZE];
+  unsigned char kek[DPL_CRYPT_KEY_SIZE];
+};
+
+struct dpl_crypt_keys
+{
+  struct crypt_kek write;       /*!< for the objects written */
+  pthread_mutex_t lock;
+  struct crypt_kek cache[CRYPT_N_CACHED_KEYS]; /*!< for the objects read */
+  int n_cached;
+  int next_cached;
+};
+
+static int
+derive_kek(const char *encrypt_key,
+           struct crypt_kek *kek)
+{
+  if (1 != PKCS5_PBKDF2_HMAC(encrypt_key, strlen(encrypt_key),
+                             kek->salt, DPL_CRYPT_SALT_SIZE,
+                             CRYPT_KDF_ITERATIONS, EVP_sha256(),
+                             DPL_CRYPT_KEY_SIZE, kek->kek))
+    return -1;
+
+  return 0;
+}
+
+/**
+ * draw the salt of the objects to write and derive their key encryption
+ * key from the encrypt_key profile setting
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_crypt_init(dpl_ctx_t *ctx)
+{
+  struct dpl_crypt_keys *keys;
+
+  ctx->encrypt_keys = NULL;
+
+  if (NULL == ctx->encrypt_key || 0 == ctx->encrypt_key[0])
+    return DPL_SUCCESS;
+
+  keys = calloc(1, sizeof (*keys));
+  if (NULL == keys)
+    return DPL_ENOMEM;
+
+  if (1 != RAND_bytes(keys->write.salt, DPL_CRYPT_SALT_SIZE) ||
+      -1 == derive_kek(ctx->encrypt_key, &keys->write))
+    {
+      OPENSSL_cleanse(keys, sizeof (*keys));
+      free(keys);
+      return DPL_FAILURE;
+    }
+
+  pthread_mutex_init(&keys->lock, NULL);
+
+  ctx->encrypt_keys = keys;
+
+  return DPL_SUCCESS;
+}
+
+void
+dpl_crypt_free(dpl_ctx_t *ctx)
+{
+  struct dpl_crypt_keys *keys = ctx->encrypt_keys;
+
+  if (NULL == keys)
+    return;
+
+  pthread_mutex_destroy(&keys->lock);
+  OPENSSL_cleanse(keys, sizeof (*keys));
+  free(keys);
+  ctx->encrypt_keys = NULL;
+}
+
+int
+dpl_crypt_enabled(dpl_ctx_t *ctx)
+{
+  return NULL != ctx->encrypt_keys;
+}
+
+/*
+ * key encryption key of an object written with salt, derived outside of
+ * the lock as it takes a while
+ */
+static int
+lookup_kek(dpl_ctx_t *ctx,
+           const unsigned char *salt,
+           unsigned char *kek)
+{
+  struct dpl_crypt_keys *keys = ctx->encrypt_keys;
+  struct crypt_kek derived;
+  int i;
+
+  if (!memcmp(salt, keys->write.salt, DPL_CRYPT_SALT_SIZE))
+    {
+      memcpy(kek, keys->write.kek, DPL_CRYPT_KEY_SIZE);
+      return 0;
+    }
+
+  pthread_mutex_lock(&keys->lock);
+  for (i = 0;i < keys->n_cached;i++)
+    {
+      if (!memcmp(salt, keys->cache[i].salt, DPL_CRYPT_SALT_SIZE))
+        {
+          memcpy(kek, keys->cache[i].kek, DPL_CRYPT_KEY_SIZE);
+          pthread_mutex_unlock(&keys->lock);
+          return 0;
+        }
+    }
+  pthread_mutex_unlock(&keys->lock);
+
+  memcpy(derived.salt, salt, DPL_CRYPT_SALT_SIZE);
+  if (-1 == derive_kek(ctx->encrypt_key, &derived))
+    return -1;
+
+  memcpy(kek, derived.kek, DPL_CRYPT_KEY_SIZE);
+
+  pthread_mutex_lock(&keys->lock);
+  keys->cache[keys->next_cached] = derived;
+  keys->next_cached = (keys->next_cached + 1) % CRYPT_N_CACHED_KEYS;
+  if (keys->n_cached < CRYPT_N_CACHED_KEYS)
+    keys->n_cached++;
+  pthread_mutex_unlock(&keys->lock);
+
+  OPENSSL_cleanse(&derived, sizeof (derived));
+
+  return 0;
+}
+
+/**
+ * draw the keys of a new object
+ *
+ * @param ctx
+ *
+ * @return NULL on error
+ */
+dpl_crypt_t *
+dpl_crypt_new(dpl_ctx_t *ctx)
+{
+  dpl_crypt_t *crypt;
+
+  crypt = calloc(1, sizeof (*crypt));
+  if (NULL == crypt)
+    return NULL;
+
+  if (1 != RAND_bytes(crypt->key, sizeof (crypt->key)) ||
+      1 != RAND_bytes(crypt->iv, sizeof (crypt->iv)))
+    {
+      DPL_LOG(ctx, DPL_ERROR, "unable to draw an encryption key");
+      dpl_crypt_destroy(crypt);
+      return NULL;
+    }
+
+  crypt->chunk_size = DPL_CRYPT_CHUNK_SIZE;
+
+  return crypt;
+}
+
+void
+dpl_crypt_destroy(dpl_crypt_t *crypt)
+{
+  if (NULL == crypt)
+    return;
+
+  OPENSSL_cleanse(crypt, sizeof (*crypt));
+  free(crypt);
+}
+
+/*
+ * single-shot AES-256-GCM, tag appended to (resp. expected after) the
+ * data
+ */
+static int
+gcm_seal(EVP_CIPHER_CTX *cipher_ctx,
+         const unsigned char *key,
+         const unsigned char *iv,
+         const unsigned char *aad,
+         int aad_len,
+         const unsigned char *in,
+         int len,
+         unsigned char *out)
+{
+  int out_len;
+
+  if (1 != EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_gcm(), NULL, key, iv))
+    return -1;
+
+  if (1 != EVP_EncryptUpdate(cipher_ctx, NULL, &out_len, aad, aad_len))
+    return -1;
+
+  if (len > 0 && 1 != EVP_EncryptUpdate(cipher_ctx, out, &out_len, in, len))
+    return -1;
+
+  if (1 != EVP_EncryptFinal_ex(cipher_ctx, out + len, &out_len))
+    return -1;
+
+  if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_GET_TAG,
+                               DPL_CRYPT_TAG_SIZE, out + len))
+    return -1;
+
+  return 0;
+}
+
+static int
+gcm_open(EVP_CIPHER_CTX *cipher_ctx,
+         const unsigned char *key,
+         const unsigned char *iv,
+         const unsigned char *aad,
+         int aad_len,
+         const unsigned char *in,
+         int len,
+         unsigned char *out)
+{
+  int out_len;
+
+  if (1 != EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_gcm(), NULL, key, iv))
+    return -1;
+
+  if (1 != EVP_DecryptUpdate(cipher_ctx, NULL, &out_len, aad, aad_len))
+    return -1;
+
+  if (len > 0 && 1 != EVP_DecryptUpdate(cipher_ctx, out, &out_len, in, len))
+    return -1;
+
+  if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_SET_TAG,
+                               DPL_CRYPT_TAG_SIZE, (void *) (in + len)))
+    return -1;
+
+  if (1 != EVP_DecryptFinal_ex(cipher_ctx, out + len, &out_len))
+    return -1;
+
+  return 0;
+}
+
+/*
+ * the AAD of the key wrapping binds the envelope fields
+ */
+static int
+envelope_aad(char *buf,
+             size_t buf_size,
+             uint32_t chunk_size,
+             const unsigned char *iv)
+{
+  int len;
+
+  len = snprintf(buf, buf_size, "%s:%u:", CRYPT_SCHEME, chunk_size);
+  if (len < 0 || (size_t) len + DPL_CRYPT_IV_SIZE > buf_size)
+    return -1;
+
+  memcpy(buf + len, iv, DPL_CRYPT_IV_SIZE);
+
+  return len + DPL_CRYPT_IV_SIZE;
+}
+
+static dpl_status_t
+add_base64(dpl_dict_t *metadata,
+           const char *key,
+           const unsigned char *in,
+           u_int len)
+{
+  char buf[DPL_BASE64_LENGTH(CRYPT_WRAPPED_SIZE) + 1];
+  u_int out_len;
+
+  out_len = dpl_base64_encode(in, len, (u_char *) buf);
+  buf[out_len] = 0;
+
+  return dpl_dict_add(metadata, key, buf, 0);
+}
+
+static int
+get_base64(const dpl_dict_t *metadata,
+           const char *key,
+           unsigned char *out,
+           u_int len)
+{
+  unsigned char buf[DPL_BASE64_ORIG_LENGTH(DPL_BASE64_LENGTH(CRYPT_WRAPPED_SIZE))];
+  char *value;
+  size_t value_len;
+  u_int out_len;
+
+  value = dpl_dict_get_value(metadata, key);
+  if (NULL == value)
+    return -1;
+
+  value_len = strlen(value);
+  if (value_len > DPL_BASE64_LENGTH(len))
+    return -1;
+
+  out_len = dpl_base64_decode((u_char *) value, value_len, buf);
+  if (out_len != len)
+    return -1;
+
+  memcpy(out, buf, len);
+
+  return 0;
+}
+
+/**
+ * record the envelope of an object in its user metadata
+ *
+ * @param ctx
+ * @param crypt
+ * @param metadata
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_crypt_seal(dpl_ctx_t *ctx,
+               dpl_crypt_t *crypt,
+               dpl_dict_t *metadata)
+{
+  struct dpl_crypt_keys *keys = ctx->encrypt_keys;
+  unsigned char wrapped[CRYPT_WRAPPED_SIZE];
+  char aad[64];
+  char buf[32];
+  int aad_len;
+  EVP_CIPHER_CTX *cipher_ctx = NULL;
+  dpl_status_t ret, ret2;
+
+  aad_len = envelope_aad(aad, sizeof (aad), crypt->chunk_size, crypt->iv);
+  if (-1 == aad_len)
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  if (1 != RAND_bytes(wrapped, DPL_CRYPT_IV_SIZE))
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  cipher_ctx = EVP_CIPHER_CTX_new();
+  if (NULL == cipher_ctx)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  if (-1 == gcm_seal(cipher_ctx, keys->write.kek, wrapped,
+                     (unsigned char *) aad, aad_len,
+                     crypt->key, DPL_CRYPT_KEY_SIZE,
+                     wrapped + DPL_CRYPT_IV_SIZE))
+    {
+      DPL_LOG(ctx, DPL_ERROR, "unable to wrap the encryption key");
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  dpl_crypt_strip(metadata);
+
+  ret2 = dpl_dict_add(metadata, DPL_CRYPT_MD_SCHEME, CRYPT_SCHEME, 0);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  snprintf(buf, sizeof (buf), "%u", crypt->chunk_size);
+  ret2 = dpl_dict_add(metadata, DPL_CRYPT_MD_CHUNK, buf, 0);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = add_base64(metadata, DPL_CRYPT_MD_SALT, keys->write.salt, DPL_CRYPT_SALT_SIZE);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = add_base64(metadata, DPL_CRYPT_MD_IV, crypt->iv, DPL_CRYPT_IV_SIZE);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = add_base64(metadata, DPL_CRYPT_MD_KEY, wrapped, CRYPT_WRAPPED_SIZE);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != cipher_ctx)
+    EVP_CIPHER_CTX_free(cipher_ctx);
+
+  OPENSSL_cleanse(wrapped, sizeof (wrapped));
+
+  return ret;
+}
+
+/**
+ * unwrap the envelope of an object
+ *
+ * @param ctx
+ * @param metadata user metadata of the object, may be NULL
+ * @param cryptp filled on success, to be released with dpl_crypt_destroy()
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOENT the object is not encrypted
+ * @return DPL_EPERM no key, or not the one the object was encrypted with
+ * @return DPL_EINTEGRITY the envelope is malformed
+ * @return DPL_ENOTSUPP unknown scheme
+ */
+dpl_status_t
+dpl_crypt_open(dpl_ctx_t *ctx,
+               const dpl_dict_t *metadata,
+               dpl_crypt_t **cryptp)
+{
+  unsigned char wrapped[CRYPT_WRAPPED_SIZE];
+  unsigned char salt[DPL_CRYPT_SALT_SIZE];
+  unsigned char kek[DPL_CRYPT_KEY_SIZE];
+  dpl_crypt_t *crypt = NULL;
+  EVP_CIPHER_CTX *cipher_ctx = NULL;
+  char aad[64];
+  int aad_len;
+  char *value, *endp;
+  unsigned long long ull;
+  dpl_status_t ret;
+
+  if (NULL == metadata)
+    return DPL_ENOENT;
+
+  value = dpl_dict_get_value(metadata, DPL_CRYPT_MD_SCHEME);
+  if (NULL == value)
+    return DPL_ENOENT;
+
+  if (strcmp(value, CRYPT_SCHEME))
+    {
+      DPL_LOG(ctx, DPL_ERROR, "unsupported encryption scheme %s", value);
+      return DPL_ENOTSUPP;
+    }
+
+  if (NULL == ctx->encrypt_keys)
+    {
+      DPL_LOG(ctx, DPL_ERROR, "object is encrypted but no encrypt_key is set");
+      return DPL_EPERM;
+    }
+
+  crypt = calloc(1, sizeof (*crypt));
+  if (NULL == crypt)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  value = dpl_dict_get_value(metadata, DPL_CRYPT_MD_CHUNK);
+  if (NULL == value)
+    {
+      ret = DPL_EINTEGRITY;
+      goto end;
+    }
+  ull = strtoull(value, &endp, 10);
+  if (*endp || ull < CRYPT_MIN_CHUNK_SIZE || ull > CRYPT_MAX_CHUNK_SIZE)
+    {
+      ret = DPL_EINTEGRITY;
+      goto end;
+    }
+  crypt->chunk_size = ull;
+
+  if (-1 == get_base64(metadata, DPL_CRYPT_MD_SALT, salt, DPL_CRYPT_SALT_SIZE) ||
+      -1 == get_base64(metadata, DPL_CRYPT_MD_IV, crypt->iv, DPL_CRYPT_IV_SIZE) ||
+      -1 == get_base64(metadata, DPL_CRYPT_MD_KEY, wrapped, CRYPT_WRAPPED_SIZE))
+    {
+      ret = DPL_EINTEGRITY;
+      goto end;
+    }
+
+  aad_len = envelope_aad(aad, sizeof (aad), crypt->chunk_size, crypt->iv);
+  if (-1 == aad_len)
+    {
+      ret = DPL_EINTEGRITY;
+      goto end;
+    }
+
+  if (-1 == lookup_kek(ctx, salt, kek))
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  cipher_ctx = EVP_CIPHER_CTX_new();
+  if (NULL == cipher_ctx)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  if (-1 == gcm_open(cipher_ctx, kek, wrapped,
+                     (unsigned char *) aad, aad_len,
+                     wrapped + DPL_CRYPT_IV_SIZE, DPL_CRYPT_KEY_SIZE,
+                     crypt->key))
+    {
+      DPL_LOG(ctx, DPL_ERROR, "unable to unwrap the encryption key: wrong encrypt_key or altered envelope");
+      ret = DPL_EPERM;
+      goto end;
+    }
+
+  *cryptp = crypt;
+  crypt = NULL;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != cipher_ctx)
+    EVP_CIPHER_CTX_free(cipher_ctx);
+
+  dpl_crypt_destroy(crypt);
+
+  OPENSSL_cleanse(wrapped, sizeof (wrapped));
+  OPENSSL_cleanse(kek, sizeof (kek));
+
+  return ret;
+}
+
+/**
+ * remove the envelope from user metadata, which then describes the
+ * plaintext
+ *
+ * @param metadata may be NULL
+ */
+void
+dpl_crypt_strip(dpl_dict_t *metadata)
+{
+  dpl_dict_var_t *var;
+  int i;
+
+  if (NULL == metadata)
+    return;
+
+  for (i = 0;NULL != envelope_keys[i];i++)
+    {
+      var = dpl_dict_get(metadata, envelope_keys[i]);
+      if (NULL != var)
+        dpl_dict_remove(metadata, var);
+    }
+}
+
+/**
+ * carry the envelope of an object over to metadata which is about to
+ * replace its own
+ *
+ * @param src user metadata of the object
+ * @param dst
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_crypt_copy_envelope(const dpl_dict_t *src,
+                        dpl_dict_t *dst)
+{
+  char *value;
+  dpl_status_t ret;
+  int i;
+
+  for (i = 0;NULL != envelope_keys[i];i++)
+    {
+      value = dpl_dict_get_value(src, envelope_keys[i]);
+      if (NULL == value)
+        continue ;
+
+      ret = dpl_dict_add(dst, envelope_keys[i], value, 0);
+      if (DPL_SUCCESS != ret)
+        return ret;
+    }
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * size of the ciphertext of whole chunks
+ *
+ * @param chunk_size
+ * @param len plaintext length, a multiple of the chunk size unless final
+ * @param final whether len ends the object, which adds the last chunk
+ *
+ * @return
+ */
+uint64_t
+dpl_crypt_cipher_size(uint32_t chunk_size,
+                      uint64_t len,
+                      int final)
+{
+  return len + (len / chunk_size + (final ? 1 : 0)) * DPL_CRYPT_TAG_SIZE;
+}
+
+/**
+ * plaintext size of an object from its stored size
+ *
+ * @param chunk_size
+ * @param cipher_size
+ * @param sizep
+ *
+ * @return 0, or -1 if no plaintext encrypts to that size
+ */
+int
+dpl_crypt_plain_size(uint32_t chunk_size,
+                     uint64_t cipher_size,
+                     uint64_t *sizep)
+{
+  uint64_t cipher_chunk_size = (uint64_t) chunk_size + DPL_CRYPT_TAG_SIZE;
+  uint64_t n_full, last;
+
+  n_full = cipher_size / cipher_chunk_size;
+  last = cipher_size % cipher_chunk_size;
+  if (last < DPL_CRYPT_TAG_SIZE)
+    return -1;
+
+  *sizep = n_full * chunk_size + last - DPL_CRYPT_TAG_SIZE;
+
+  return 0;
+}
+
+/**
+ * range of the chunks holding a range of the plaintext
+ *
+ * @param chunk_size
+ * @param start first plaintext byte
+ * @param end last plaintext byte, or DPL_UNDEF up to the end
+ * @param rangep filled with the ciphertext range
+ *
+ * @return plaintext offset of the first chunk
+ */
+uint64_t
+dpl_crypt_cipher_range(uint32_t chunk_size,
+                       uint64_t start,
+                       uint64_t end,
+                       dpl_range_t *rangep)
+{
+  uint64_t cipher_chunk_size = (uint64_t) chunk_size + DPL_CRYPT_TAG_SIZE;
+
+  rangep->start = start / chunk_size * cipher_chunk_size;
+  if (DPL_UNDEF == end)
+    rangep->end = DPL_UNDEF;
+  else
+    rangep->end = (end / chunk_size + 1) * cipher_chunk_size - 1;
+
+  return start / chunk_size * chunk_size;
+}
+
+static void
+chunk_iv(const dpl_crypt_t *crypt,
+         uint64_t idx,
+         int final,
+         unsigned char *iv,
+         unsigned char *aad)
+{
+  int i;
+
+  for (i = 0;i < 8;i++)
+    aad[i] = (idx >> (56 - 8 * i)) & 0xff;
+  aad[8] = final ? 1 : 0;
+
+  memcpy(iv, crypt->iv, DPL_CRYPT_IV_SIZE);
+  for (i = 0;i < 8;i++)
+    iv[DPL_CRYPT_IV_SIZE - 8 + i] ^= aad[i];
+}
+
+/**
+ * encrypt whole chunks
+ *
+ * in and out must not overlap, out holds
+ * dpl_crypt_cipher_size(crypt->chunk_size, len, final) bytes.  The call
+ * ending the object ends it with a partial chunk, which is empty if len
+ * is a multiple of the chunk size.
+ *
+ * @param crypt
+ * @param offset plaintext offset of in, a multiple of the chunk size
+ * @param in
+ * @param len a multiple of the chunk size unless final
+ * @param final whether in ends the object
+ * @param out
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINVAL
+ * @return DPL_ENOMEM
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_crypt_encrypt(const dpl_crypt_t *crypt,
+                  uint64_t offset,
+                  const char *in,
+                  size_t len,
+                  int final,
+                  char *out)
+{
+  EVP_CIPHER_CTX *cipher_ctx;
+  unsigned char iv[DPL_CRYPT_IV_SIZE];
+  unsigned char aad[CRYPT_CHUNK_AAD_SIZE];
+  uint64_t idx;
+  size_t chunk_len;
+  int last;
+  dpl_status_t ret;
+
+  if (0 != offset % crypt->chunk_size ||
+      (!final && 0 != len % crypt->chunk_size))
+    return DPL_EINVAL;
+
+  cipher_ctx = EVP_CIPHER_CTX_new();
+  if (NULL == cipher_ctx)
+    return DPL_ENOMEM;
+
+  idx = offset / crypt->chunk_size;
+  while (len > 0 || final)
+    {
+      chunk_len = MIN(len, crypt->chunk_size);
+      last = chunk_len < crypt->chunk_size;
+
+      chunk_iv(crypt, idx, last, iv, aad);
+      if (-1 == gcm_seal(cipher_ctx, crypt->key, iv, aad, sizeof (aad),
+                         (unsigned char *) in, chunk_len,
+                         (unsigned char *) out))
+        {
+          ret = DPL_FAILURE;
+          goto end;
+        }
+
+      in += chunk_len;
+      out += chunk_len + DPL_CRYPT_TAG_SIZE;
+      len -= chunk_len;
+      idx++;
+
+      if (last)
+        break ;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  EVP_CIPHER_CTX_free(cipher_ctx);
+
+  return ret;
+}
+
+/**
+ * decrypt and verify whole chunks
+ *
+ * in and out must not overlap, out holds at least len bytes.  Nothing
+ * may follow the last chunk of the object, which the caller has to have
+ * seen unless it asked for a range ending before it.
+ *
+ * @param crypt
+ * @param offset plaintext offset of the first chunk
+ * @param in ciphertext as returned by dpl_crypt_cipher_range()
+ * @param len
+ * @param out
+ * @param out_lenp filled with the plaintext length
+ * @param finalp set if in ends with the last chunk of the object
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINTEGRITY the data was altered
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_crypt_decrypt(const dpl_crypt_t *crypt,
+                  uint64_t offset,
+                  const char *in,
+                  size_t len,
+                  char *out,
+                  size_t *out_lenp,
+                  int *finalp)
+{
+  EVP_CIPHER_CTX *cipher_ctx;
+  unsigned char iv[DPL_CRYPT_IV_SIZE];
+  unsigned char aad[CRYPT_CHUNK_AAD_SIZE];
+  uint64_t idx;
+  size_t chunk_len, out_len = 0;
+  int final = 0;
+  dpl_status_t ret;
+
+  if (0 != offset % crypt->chunk_size)
+    return DPL_EINVAL;
+
+  cipher_ctx = EVP_CIPHER_CTX_new();
+  if (NULL == cipher_ctx)
+    return DPL_ENOMEM;
+
+  idx = offset / crypt->chunk_size;
+  while (len > 0)
+    {
+      if (final || len < DPL_CRYPT_TAG_SIZE)
+        {
+          ret = DPL_EINTEGRITY;
+          goto end;
+        }
+
+      chunk_len = MIN(len - DPL_CRYPT_TAG_SIZE, crypt->chunk_size);
+      final = chunk_len < crypt->chunk_size;
+
+      chunk_iv(crypt, idx, final, iv, aad);
+      if (-1 == gcm_open(cipher_ctx, crypt->key, iv, aad, sizeof (aad),
+                         (unsigned char *) in, chunk_len,
+                         (unsigned char *) out))
+        {
+          ret = DPL_EINTEGRITY;
+          goto end;
+        }
+
+      in += chunk_len + DPL_CRYPT_TAG_SIZE;
+      len -= chunk_len + DPL_CRYPT_TAG_SIZE;
+      out += chunk_len;
+      out_len += chunk_len;
+      idx++;
+    }
+
+  *out_lenp = out_len;
+  *finalp = final;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  EVP_CIPHER_CTX_free(cipher_ctx);
+
+  return ret;
+}
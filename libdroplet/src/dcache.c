@@ -0,0 +1,489 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+#include "droplet/vfs.h"
+#include <droplet/queue.h>
+
+/** @file */
+
+/*
+ * Dentry cache: remembers the outcome of dir_lookup() so that resolving
+ * a path does not list every intermediate directory on each call.
+ *
+ * Entries are keyed by "bucket:parent/name", which is also the object
+ * path with the bucket prepended, so that invalidating a directory is a
+ * plain prefix match.  Negative entries (fqn == NULL) record ENOENT.
+ */
+
+#define DCACHE_N_BUCKETS 4093
+
+struct dcache_entry
+{
+  struct dcache_entry *next;            /*!< hash chain */
+  TAILQ_ENTRY(dcache_entry) lru;
+  char *key;
+  char *fqn;                            /*!< NULL for negative entries */
+  dpl_ftype_t type;
+  time_t expire;
+};
+
+TAILQ_HEAD(dcache_lru, dcache_entry);
+
+struct dpl_dcache
+{
+  pthread_mutex_t lock;
+  struct dcache_entry *buckets[DCACHE_N_BUCKETS];
+  struct dcache_lru lru;                /*!< most recently used first */
+  int n_entries;
+};
+
+static u_int
+dcache_hashcode(const char *s)
+{
+  const char *p;
+  u_int h, g;
+
+  h = g = 0;
+
+  for (p = s;*p;p++)
+    {
+      h = (h<<4)+(*p);
+      if ((g = h&0xf0000000))
+        {
+          h = h^(g>>24);
+          h = h^g;
+        }
+    }
+
+  return h;
+}
+
+/*
+ * parent is a directory fqn: leading slashes are skipped and a trailing
+ * one is enforced so that "a/b" and "a/b/" map to the same entries.
+ */
+static int
+dcache_make_key(char *key,
+                size_t key_size,
+                const char *bucket,
+                const char *parent,
+                const char *name)
+{
+  size_t parent_len;
+  int len;
+
+  while ('/' == *parent)
+    parent++;
+
+  parent_len = strlen(parent);
+
+  len = snprintf(key, key_size, "%s:%s%s%s", bucket, parent,
+                 (parent_len > 0 && '/' != parent[parent_len - 1]) ? "/" : "",
+                 name);
+  if (len < 0 || (size_t) len >= key_size)
+    return -1;
+
+  return 0;
+}
+
+static void
+dcache_entry_free(struct dcache_entry *entry)
+{
+  free(entry->key);
+  free(entry->fqn);
+  free(entry);
+}
+
+static struct dcache_entry *
+dcache_get_nolock(struct dpl_dcache *dcache,
+                  const char *key)
+{
+  struct dcache_entry *entry;
+
+  entry = dcache->buckets[dcache_hashcode(key) % DCACHE_N_BUCKETS];
+  for (;entry;entry = entry->next)
+    {
+      if (!strcmp(entry->key, key))
+        return entry;
+    }
+
+  return NULL;
+}
+
+static void
+dcache_remove_nolock(struct dpl_dcache *dcache,
+                     struct dcache_entry *entry)
+{
+  struct dcache_entry **prev;
+
+  prev = &dcache->buckets[dcache_hashcode(entry->key) % DCACHE_N_BUCKETS];
+  while (*prev != entry)
+    prev = &(*prev)->next;
+  *prev = entry->next;
+
+  TAILQ_REMOVE(&dcache->lru, entry, lru);
+  dcache->n_entries--;
+
+  dcache_entry_free(entry);
+}
+
+static void
+dcache_remove_key_nolock(struct dpl_dcache *dcache,
+                         const char *key)
+{
+  struct dcache_entry *entry;
+
+  entry = dcache_get_nolock(dcache, key);
+  if (NULL != entry)
+    dcache_remove_nolock(dcache, entry);
+}
+
+/**
+ * allocate the dentry cache of the context, if enabled by the profile
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_dcache_init(dpl_ctx_t *ctx)
+{
+  struct dpl_dcache *dcache;
+
+  ctx->dcache = NULL;
+
+  if (ctx->dcache_ttl <= 0 && ctx->dcache_negative_ttl <= 0)
+    return DPL_SUCCESS;
+
+  dcache = calloc(1, sizeof (*dcache));
+  if (NULL == dcache)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&dcache->lock, NULL);
+  TAILQ_INIT(&dcache->lru);
+
+  ctx->dcache = dcache;
+
+  return DPL_SUCCESS;
+}
+
+void
+dpl_dcache_free(dpl_ctx_t *ctx)
+{
+  struct dpl_dcache *dcache = ctx->dcache;
+
+  if (NULL == dcache)
+    return;
+
+  dpl_dcache_purge(ctx);
+  pthread_mutex_destroy(&dcache->lock);
+  free(dcache);
+  ctx->dcache = NULL;
+}
+
+int
+dpl_dcache_enabled(dpl_ctx_t *ctx)
+{
+  return NULL != ctx->dcache;
+}
+
+/**
+ * lookup a name in a directory
+ *
+ * @param ctx
+ * @param bucket
+ * @param parent fqn of the directory
+ * @param name
+ * @param obj_fqnp filled on positive hit, may be NULL
+ * @param obj_typep filled on positive hit, may be NULL
+ * @param retp DPL_SUCCESS or DPL_ENOENT on hit
+ *
+ * @return 1 on hit, 0 on miss
+ */
+int
+dpl_dcache_lookup(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *parent,
+                  const char *name,
+                  struct dpl_fqn *obj_fqnp,
+                  dpl_ftype_t *obj_typep,
+                  dpl_status_t *retp)
+{
+  struct dpl_dcache *dcache = ctx->dcache;
+  struct dcache_entry *entry;
+  char key[DPL_MAXPATHLEN + DPL_MAXNAMLEN];
+  int hit = 0;
+
+  if (NULL == dcache)
+    return 0;
+
+  if (-1 == dcache_make_key(key, sizeof (key), bucket, parent, name))
+    return 0;
+
+  pthread_mutex_lock(&dcache->lock);
+
+  entry = dcache_get_nolock(dcache, key);
+  if (NULL == entry)
+    goto end;
+
+  if (entry->expire <= time(NULL))
+    {
+      dcache_remove_nolock(dcache, entry);
+      goto end;
+    }
+
+  TAILQ_REMOVE(&dcache->lru, entry, lru);
+  TAILQ_INSERT_HEAD(&dcache->lru, entry, lru);
+
+  if (NULL == entry->fqn)
+    {
+      *retp = DPL_ENOENT;
+    }
+  else
+    {
+      if (NULL != obj_fqnp)
+        strcpy(obj_fqnp->path, entry->fqn);
+      if (NULL != obj_typep)
+        *obj_typep = entry->type;
+      *retp = DPL_SUCCESS;
+    }
+
+  hit = 1;
+
+ end:
+  pthread_mutex_unlock(&dcache->lock);
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "dcache %s %s", hit ? "hit" : "miss", key);
+
+  return hit;
+}
+
+/**
+ * record the outcome of a lookup
+ *
+ * a live directory entry is not replaced by a regular one of the same
+ * name, as dir_lookup() favors directories.
+ *
+ * @param ctx
+ * @param bucket
+ * @param parent fqn of the directory
+ * @param name
+ * @param obj_fqn NULL records a negative entry
+ * @param obj_type
+ */
+void
+dpl_dcache_insert(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *parent,
+                  const char *name,
+                  const char *obj_fqn,
+                  dpl_ftype_t obj_type)
+{
+  struct dpl_dcache *dcache = ctx->dcache;
+  struct dcache_entry *entry, **bucketp;
+  char key[DPL_MAXPATHLEN + DPL_MAXNAMLEN];
+  char *fqn = NULL;
+  int ttl;
+  time_t now;
+
+  if (NULL == dcache)
+    return;
+
+  ttl = (NULL != obj_fqn) ? ctx->dcache_ttl : ctx->dcache_negative_ttl;
+  if (ttl <= 0)
+    return;
+
+  if (NULL != obj_fqn && strlen(obj_fqn) >= DPL_MAXPATHLEN)
+    return;
+
+  if (-1 == dcache_make_key(key, sizeof (key), bucket, parent, name))
+    return;
+
+  if (NULL != obj_fqn)
+    {
+      fqn = strdup(obj_fqn);
+      if (NULL == fqn)
+        return;
+    }
+
+  now = time(NULL);
+
+  pthread_mutex_lock(&dcache->lock);
+
+  entry = dcache_get_nolock(dcache, key);
+  if (NULL != entry)
+    {
+      if (NULL != fqn && NULL != entry->fqn &&
+          DPL_FTYPE_DIR == entry->type && DPL_FTYPE_DIR != obj_type &&
+          entry->expire > now)
+        {
+          free(fqn);
+          goto end;
+        }
+
+      free(entry->fqn);
+      entry->fqn = fqn;
+      entry->type = obj_type;
+      entry->expire = now + ttl;
+      TAILQ_REMOVE(&dcache->lru, entry, lru);
+      TAILQ_INSERT_HEAD(&dcache->lru, entry, lru);
+      goto end;
+    }
+
+  entry = calloc(1, sizeof (*entry));
+  if (NULL == entry)
+    {
+      free(fqn);
+      goto end;
+    }
+
+  entry->key = strdup(key);
+  if (NULL == entry->key)
+    {
+      free(entry);
+      free(fqn);
+      goto end;
+    }
+  entry->fqn = fqn;
+  entry->type = obj_type;
+  entry->expire = now + ttl;
+
+  while (ctx->dcache_max_entries > 0 &&
+         dcache->n_entries >= ctx->dcache_max_entries)
+    dcache_remove_nolock(dcache, TAILQ_LAST(&dcache->lru, dcache_lru));
+
+  bucketp = &dcache->buckets[dcache_hashcode(key) % DCACHE_N_BUCKETS];
+  entry->next = *bucketp;
+  *bucketp = entry;
+  TAILQ_INSERT_HEAD(&dcache->lru, entry, lru);
+  dcache->n_entries++;
+
+ end:
+  pthread_mutex_unlock(&dcache->lock);
+}
+
+/**
+ * forget about an object which is about to be, or has been, modified
+ *
+ * the entries of all the ancestors are dropped as well, since creating
+ * or removing an object may implicitly create or remove its parent
+ * directories.  If path designates a directory (trailing slash) then
+ * everything below it is dropped too.
+ *
+ * @param ctx
+ * @param bucket
+ * @param path fqn of the object
+ */
+void
+dpl_dcache_invalidate(dpl_ctx_t *ctx,
+                      const char *bucket,
+                      const char *path)
+{
+  struct dpl_dcache *dcache = ctx->dcache;
+  struct dcache_entry *entry, *tmp;
+  char key[DPL_MAXPATHLEN + DPL_MAXNAMLEN];
+  size_t key_len, bucket_len;
+  int is_dir = 0;
+  char *p;
+
+  if (NULL == dcache)
+    return;
+
+  if (-1 == dcache_make_key(key, sizeof (key), bucket, "", path))
+    {
+      dpl_dcache_purge(ctx);
+      return;
+    }
+
+  bucket_len = strlen(bucket) + 1;
+  p = key + bucket_len;
+  while ('/' == *p)
+    memmove(p, p + 1, strlen(p));
+
+  key_len = strlen(key);
+  while (key_len > bucket_len && '/' == key[key_len - 1])
+    {
+      key[--key_len] = 0;
+      is_dir = 1;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "dcache invalidate %s", key);
+
+  pthread_mutex_lock(&dcache->lock);
+
+  if (is_dir)
+    {
+      TAILQ_FOREACH_SAFE(entry, &dcache->lru, lru, tmp)
+        {
+          if (!strncmp(entry->key, key, key_len) && '/' == entry->key[key_len])
+            dcache_remove_nolock(dcache, entry);
+        }
+    }
+
+  while (key_len > bucket_len)
+    {
+      dcache_remove_key_nolock(dcache, key);
+
+      p = rindex(key + bucket_len, '/');
+      if (NULL == p)
+        break ;
+      *p = 0;
+      key_len = p - key;
+    }
+
+  pthread_mutex_unlock(&dcache->lock);
+}
+
+/**
+ * drop all the entries, e.g. when the bucket was modified by a third party
+ *
+ * @param ctx
+ */
+void
+dpl_dcache_purge(dpl_ctx_t *ctx)
+{
+  struct dpl_dcache *dcache = ctx->dcache;
+  struct dcache_entry *entry;
+
+  if (NULL == dcache)
+    return;
+
+  pthread_mutex_lock(&dcache->lock);
+
+  while (NULL != (entry = TAILQ_FIRST(&dcache->lru)))
+    dcache_remove_nolock(dcache, entry);
+
+  pthread_mutex_unlock(&dcache->lock);
+}
@@ -93,6 +93,12 @@ dpl_status_str(dpl_status_t status)
       return "DPL_ECONFLICT";
     case DPL_ERANGEUNAVAIL:
       return "DPL_ERANGEUNAVAIL";
+    case DPL_ESERVER:
+      return "DPL_ESERVER";
+    case DPL_EBUSY:
+      return "DPL_EBUSY";
+    case DPL_EINTEGRITY:
+      return "DPL_EINTEGRITY";
     }
 
   return "Unknown error";
@@ -560,6 +566,8 @@ dpl_object_free(dpl_object_t *object)
   if (NULL != object->path)
     free(object->path);
 
+  free(object->owner);
+
   free(object);
 }
 
@@ -598,6 +606,47 @@ dpl_vec_delete_objects_free(dpl_vec_t *vec)
   dpl_vec_free(vec);
 }
 
+void
+dpl_multipart_part_free(dpl_multipart_part_t *part)
+{
+  if (part->etag != NULL)
+    free(part->etag);
+
+  free(part);
+}
+
+void
+dpl_vec_multipart_parts_free(dpl_vec_t *vec)
+{
+  int i;
+
+  for (i = 0; i < vec->n_items; i++)
+    dpl_multipart_part_free((dpl_multipart_part_t *) dpl_vec_get(vec, i));
+  dpl_vec_free(vec);
+}
+
+void
+dpl_multipart_upload_free(dpl_multipart_upload_t *upload)
+{
+  if (upload->key != NULL)
+    free(upload->key);
+
+  if (upload->uploadid != NULL)
+    free(upload->uploadid);
+
+  free(upload);
+}
+
+void
+dpl_vec_multipart_uploads_free(dpl_vec_t *vec)
+{
+  int i;
+
+  for (i = 0; i < vec->n_items; i++)
+    dpl_multipart_upload_free((dpl_multipart_upload_t *) dpl_vec_get(vec, i));
+  dpl_vec_free(vec);
+}
+
 void
 dpl_common_prefix_free(dpl_common_prefix_t *common_prefix)
 {
@@ -0,0 +1,979 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+
+/** @file */
+
+/*
+ * Hedged requests: a GET or HEAD which got no reply status line within a
+ * high percentile of the recent reply latencies is sent again to another
+ * host, and whichever host answers first wins.  A primary which is only
+ * slow to transfer its body is not hedged.  The tail latency is then
+ * decided by the faster of two hosts instead of the slowest node, for at
+ * most (100 - hedge_percentile)% more requests.
+ *
+ * The primary attempt runs in the caller's thread, so that requests
+ * which are not hedged cost no thread.  A timer thread per context arms
+ * the pending primaries and starts the twin in a detached thread once
+ * the delay passed.  The first attempt to conclude cancels the other one
+ * by shutting its socket down; the twin cleans up after itself, on
+ * copies of the inputs so that it may outlive the caller.
+ */
+
+#define HEDGE_N_SAMPLES   256
+#define HEDGE_MIN_SAMPLES 32
+
+struct hedge_call;
+
+struct dpl_hedge
+{
+  pthread_mutex_t lock;
+  pthread_cond_t idle;          /*!< signaled when n_running drops to 0 */
+  int n_running;                /*!< twin threads alive */
+  pthread_cond_t armed;         /*!< signaled when a call is armed */
+  struct hedge_call *pending;   /*!< primaries waiting for their delay */
+  pthread_t timer;
+  int timer_started;
+  int stopping;
+  uint32_t samples[HEDGE_N_SAMPLES]; /*!< reply latencies (usec) */
+  int n_samples;
+  int next_sample;
+  dpl_hedge_stats_t stats;
+};
+
+struct hedge_attempt
+{
+  struct hedge_call *call;
+  int index;                    /*!< 0 for the primary */
+  int started;
+  int replied;                  /*!< the reply status line was read */
+  int done;
+  int cancelled;
+  dpl_conn_t *conn;             /*!< in flight, NULL otherwise */
+  dpl_status_t ret;
+  char *data_buf;
+  unsigned int data_len;
+  dpl_dict_t *metadata;
+  dpl_sysmd_t sysmd;
+  char *location;
+};
+
+struct hedge_call
+{
+  struct hedge_call *next;      /*!< in hedge->pending */
+  struct timespec deadline;     /*!< when the twin is started */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int refcount;
+  int returned;                 /*!< the caller got its result */
+  dpl_ctx_t *ctx;
+  dpl_get_t get;                /*!< NULL for a HEAD */
+  dpl_head_t head;
+  char *bucket;
+  char *resource;
+  char *subresource;
+  int has_option;
+  dpl_option_t option;
+  dpl_ftype_t object_type;
+  int has_condition;
+  dpl_condition_t condition;
+  int has_range;
+  dpl_range_t range;
+  int want_data;
+  int want_metadata;
+  int want_sysmd;
+  int want_location;
+  uint64_t delay_usec;
+  dpl_addr_t *primary_addr;     /*!< compared, never dereferenced */
+  struct hedge_attempt attempts[2];
+};
+
+static pthread_key_t hedge_key;
+static pthread_once_t hedge_key_once = PTHREAD_ONCE_INIT;
+
+static void
+hedge_key_create(void)
+{
+  (void) pthread_key_create(&hedge_key, NULL);
+}
+
+/**
+ * allocate the hedging state of the context, if enabled by the profile
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_hedge_init(dpl_ctx_t *ctx)
+{
+  struct dpl_hedge *hedge;
+
+  ctx->hedge = NULL;
+
+  if (ctx->hedge_percentile <= 0)
+    return DPL_SUCCESS;
+
+  hedge = calloc(1, sizeof (*hedge));
+  if (NULL == hedge)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&hedge->lock, NULL);
+  pthread_cond_init(&hedge->idle, NULL);
+  pthread_cond_init(&hedge->armed, NULL);
+  pthread_once(&hedge_key_once, hedge_key_create);
+
+  ctx->hedge = hedge;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * free the hedging state, waiting for cancelled attempts to wind up
+ *
+ * to be called before anything they use is torn down
+ *
+ * @param ctx
+ */
+void
+dpl_hedge_free(dpl_ctx_t *ctx)
+{
+  struct dpl_hedge *hedge = ctx->hedge;
+
+  if (NULL == hedge)
+    return;
+
+  pthread_mutex_lock(&hedge->lock);
+  hedge->stopping = 1;
+  pthread_cond_signal(&hedge->armed);
+  pthread_mutex_unlock(&hedge->lock);
+
+  if (hedge->timer_started)
+    pthread_join(hedge->timer, NULL);
+
+  pthread_mutex_lock(&hedge->lock);
+  while (hedge->n_running > 0)
+    pthread_cond_wait(&hedge->idle, &hedge->lock);
+  pthread_mutex_unlock(&hedge->lock);
+
+  pthread_cond_destroy(&hedge->armed);
+  pthread_cond_destroy(&hedge->idle);
+  pthread_mutex_destroy(&hedge->lock);
+  free(hedge);
+  ctx->hedge = NULL;
+}
+
+/**
+ * account for the latency of a reply, from which hedging delays derive
+ *
+ * @param ctx
+ * @param usec time from the request to the reply status line
+ */
+void
+dpl_hedge_record(dpl_ctx_t *ctx,
+                 uint64_t usec)
+{
+  struct dpl_hedge *hedge = ctx->hedge;
+
+  if (NULL == hedge)
+    return;
+
+  pthread_mutex_lock(&hedge->lock);
+
+  hedge->samples[hedge->next_sample] = MIN(usec, UINT32_MAX);
+  hedge->next_sample = (hedge->next_sample + 1) % HEDGE_N_SAMPLES;
+  if (hedge->n_samples < HEDGE_N_SAMPLES)
+    hedge->n_samples++;
+
+  pthread_mutex_unlock(&hedge->lock);
+}
+
+static int
+cmp_u32(const void *p1,
+        const void *p2)
+{
+  uint32_t u1 = *(const uint32_t *) p1;
+  uint32_t u2 = *(const uint32_t *) p2;
+
+  return (u1 > u2) - (u1 < u2);
+}
+
+/*
+ * the delay after which a request is hedged, 0 if it must not be
+ */
+static uint64_t
+hedge_delay(dpl_ctx_t *ctx,
+            const dpl_option_t *option)
+{
+  struct dpl_hedge *hedge = ctx->hedge;
+  uint32_t samples[HEDGE_N_SAMPLES];
+  uint64_t delay;
+  int n;
+
+  if (NULL == hedge)
+    return 0;
+
+  //the caller buffer cannot be shared by two attempts
+  if (NULL != option && option->mask & DPL_OPTION_NOALLOC)
+    return 0;
+
+  if (dpl_addrlist_count(ctx->addrlist) < 2)
+    return 0;
+
+  pthread_mutex_lock(&hedge->lock);
+  n = hedge->n_samples;
+  memcpy(samples, hedge->samples, n * sizeof (samples[0]));
+  pthread_mutex_unlock(&hedge->lock);
+
+  if (n < HEDGE_MIN_SAMPLES)
+    return 0;
+
+  qsort(samples, n, sizeof (samples[0]), cmp_u32);
+
+  delay = samples[MIN(n - 1, n * ctx->hedge_percentile / 100)];
+  if (delay < (uint64_t) ctx->hedge_min_delay * 1000)
+    delay = (uint64_t) ctx->hedge_min_delay * 1000;
+
+  pthread_mutex_lock(&hedge->lock);
+  hedge->stats.delay_usec = delay;
+  pthread_mutex_unlock(&hedge->lock);
+
+  return delay;
+}
+
+static void
+hedge_cancel_conn(dpl_conn_t *conn)
+{
+  conn->cancelled = 1;
+  (void) shutdown(conn->fd, SHUT_RDWR);
+}
+
+/**
+ * tell dpl_try_connect() whether to skip a host for the current request
+ *
+ * a hedge avoids the host of its primary, and hosts known to be slower
+ * than the delay which triggered it.
+ *
+ * @param ctx
+ * @param addr
+ *
+ * @return 1 if another host should be tried
+ */
+int
+dpl_hedge_avoid(dpl_ctx_t *ctx,
+                dpl_addr_t *addr)
+{
+  struct hedge_attempt *attempt;
+  struct hedge_call *call;
+  int avoid;
+
+  if (NULL == ctx->hedge)
+    return 0;
+
+  attempt = pthread_getspecific(hedge_key);
+  if (NULL == attempt || 0 == attempt->index)
+    return 0;
+
+  call = attempt->call;
+
+  pthread_mutex_lock(&call->lock);
+  avoid = (addr == call->primary_addr);
+  pthread_mutex_unlock(&call->lock);
+
+  if (!avoid)
+    avoid = dpl_addrlist_get_latency(ctx->addrlist, addr) > call->delay_usec;
+
+  return avoid;
+}
+
+/**
+ * register the connection of the current request, so that it can be
+ * cancelled if the request is hedged and loses
+ *
+ * @param conn
+ * @param addr host the connection goes to
+ */
+void
+dpl_hedge_attach(dpl_conn_t *conn,
+                 dpl_addr_t *addr)
+{
+  struct hedge_attempt *attempt;
+  struct hedge_call *call;
+
+  if (NULL == conn->ctx->hedge)
+    return;
+
+  attempt = pthread_getspecific(hedge_key);
+  if (NULL == attempt)
+    return;
+
+  call = attempt->call;
+
+  pthread_mutex_lock(&call->lock);
+
+  attempt->conn = conn;
+  if (0 == attempt->index)
+    call->primary_addr = addr;
+  if (attempt->cancelled)
+    hedge_cancel_conn(conn);
+
+  pthread_mutex_unlock(&call->lock);
+}
+
+/**
+ * note that the reply status line of the current request was read, so
+ * that it is not hedged for a slow body
+ *
+ * @param ctx
+ */
+void
+dpl_hedge_replied(dpl_ctx_t *ctx)
+{
+  struct hedge_attempt *attempt;
+
+  if (NULL == ctx->hedge)
+    return;
+
+  attempt = pthread_getspecific(hedge_key);
+  if (NULL == attempt)
+    return;
+
+  pthread_mutex_lock(&attempt->call->lock);
+  attempt->replied = 1;
+  pthread_mutex_unlock(&attempt->call->lock);
+}
+
+/**
+ * unregister a connection before it is released
+ *
+ * @param conn
+ */
+void
+dpl_hedge_detach(dpl_conn_t *conn)
+{
+  struct hedge_attempt *attempt;
+
+  if (NULL == conn->ctx->hedge)
+    return;
+
+  attempt = pthread_getspecific(hedge_key);
+  if (NULL == attempt || attempt->conn != conn)
+    return;
+
+  pthread_mutex_lock(&attempt->call->lock);
+  attempt->conn = NULL;
+  pthread_mutex_unlock(&attempt->call->lock);
+}
+
+static void
+hedge_discard(struct hedge_attempt *attempt)
+{
+  free(attempt->data_buf);
+  attempt->data_buf = NULL;
+  if (NULL != attempt->metadata)
+    {
+      dpl_dict_free(attempt->metadata);
+      attempt->metadata = NULL;
+    }
+  free(attempt->location);
+  attempt->location = NULL;
+}
+
+static void
+hedge_call_free(struct hedge_call *call)
+{
+  pthread_cond_destroy(&call->cond);
+  pthread_mutex_destroy(&call->lock);
+  free(call->bucket);
+  free(call->resource);
+  free(call->subresource);
+  free(call);
+}
+
+/*
+ * drop a reference, with call->lock held which is released
+ */
+static void
+hedge_call_unref(struct hedge_call *call)
+{
+  int refcount;
+
+  refcount = --call->refcount;
+
+  pthread_mutex_unlock(&call->lock);
+
+  if (0 == refcount)
+    hedge_call_free(call);
+}
+
+static struct hedge_call *
+hedge_call_new(dpl_ctx_t *ctx,
+               const char *bucket,
+               const char *resource,
+               const char *subresource,
+               const dpl_option_t *option,
+               dpl_ftype_t object_type,
+               const dpl_condition_t *condition,
+               uint64_t delay_usec)
+{
+  struct hedge_call *call;
+  int i;
+
+  call = calloc(1, sizeof (*call));
+  if (NULL == call)
+    return NULL;
+
+  pthread_mutex_init(&call->lock, NULL);
+  pthread_cond_init(&call->cond, NULL);
+
+  if ((NULL != bucket && NULL == (call->bucket = strdup(bucket))) ||
+      (NULL != resource && NULL == (call->resource = strdup(resource))) ||
+      (NULL != subresource && NULL == (call->subresource = strdup(subresource))))
+    {
+      hedge_call_free(call);
+      return NULL;
+    }
+
+  if (NULL != option)
+    {
+      call->option = *option;
+      call->has_option = 1;
+    }
+
+  if (NULL != condition)
+    {
+      call->condition = *condition;
+      call->has_condition = 1;
+    }
+
+  call->ctx = ctx;
+  call->object_type = object_type;
+  call->delay_usec = delay_usec;
+  call->refcount = 1;
+
+  for (i = 0;i < 2;i++)
+    {
+      call->attempts[i].call = call;
+      call->attempts[i].index = i;
+    }
+
+  return call;
+}
+
+static int
+hedge_conclusive(struct hedge_attempt *attempt)
+{
+  dpl_retry_reason_t reason;
+
+  return attempt->done && !dpl_retry_classify(attempt->ret, &reason);
+}
+
+/*
+ * issue the request of an attempt, in the current thread.  Returns with
+ * call->lock held.
+ */
+static void
+hedge_attempt_run(struct hedge_attempt *attempt)
+{
+  struct hedge_call *call = attempt->call;
+  struct hedge_attempt *other = &call->attempts[!attempt->index];
+  dpl_ctx_t *ctx = call->ctx;
+  struct dpl_hedge *hedge = ctx->hedge;
+  dpl_status_t ret;
+
+  pthread_setspecific(hedge_key, attempt);
+
+  if (NULL != call->get)
+    ret = call->get(ctx, call->bucket, call->resource, call->subresource,
+                    call->has_option ? &call->option : NULL,
+                    call->object_type,
+                    call->has_condition ? &call->condition : NULL,
+                    call->has_range ? &call->range : NULL,
+                    call->want_data ? &attempt->data_buf : NULL,
+                    &attempt->data_len,
+                    call->want_metadata ? &attempt->metadata : NULL,
+                    call->want_sysmd ? &attempt->sysmd : NULL,
+                    call->want_location ? &attempt->location : NULL);
+  else
+    ret = call->head(ctx, call->bucket, call->resource, call->subresource,
+                     call->has_option ? &call->option : NULL,
+                     call->object_type,
+                     call->has_condition ? &call->condition : NULL,
+                     call->want_metadata ? &attempt->metadata : NULL,
+                     call->want_sysmd ? &attempt->sysmd : NULL,
+                     call->want_location ? &attempt->location : NULL);
+
+  pthread_setspecific(hedge_key, NULL);
+
+  pthread_mutex_lock(&call->lock);
+
+  attempt->ret = ret;
+  attempt->done = 1;
+
+  //the first conclusive answer makes the other attempt useless
+  if (hedge_conclusive(attempt) &&
+      other->started && !other->done && !other->cancelled)
+    {
+      other->cancelled = 1;
+      if (NULL != other->conn)
+        hedge_cancel_conn(other->conn);
+
+      pthread_mutex_lock(&hedge->lock);
+      hedge->stats.cancelled++;
+      pthread_mutex_unlock(&hedge->lock);
+    }
+
+  if (call->returned)
+    hedge_discard(attempt);
+
+  pthread_cond_broadcast(&call->cond);
+}
+
+static void *
+hedge_twin_main(void *arg)
+{
+  struct hedge_attempt *attempt = arg;
+  struct dpl_hedge *hedge = attempt->call->ctx->hedge;
+
+  hedge_attempt_run(attempt);
+  hedge_call_unref(attempt->call);
+
+  pthread_mutex_lock(&hedge->lock);
+  if (0 == --hedge->n_running)
+    pthread_cond_broadcast(&hedge->idle);
+  pthread_mutex_unlock(&hedge->lock);
+
+  return NULL;
+}
+
+/*
+ * run the twin in a detached thread, with call->lock held
+ */
+static int
+hedge_start_twin(struct hedge_call *call)
+{
+  struct dpl_hedge *hedge = call->ctx->hedge;
+  pthread_attr_t attr;
+  pthread_t thread;
+  int ret;
+
+  call->refcount++;
+
+  pthread_mutex_lock(&hedge->lock);
+  hedge->n_running++;
+  pthread_mutex_unlock(&hedge->lock);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  ret = pthread_create(&thread, &attr, hedge_twin_main, &call->attempts[1]);
+  pthread_attr_destroy(&attr);
+  if (0 != ret)
+    {
+      call->refcount--;
+      pthread_mutex_lock(&hedge->lock);
+      if (0 == --hedge->n_running)
+        pthread_cond_broadcast(&hedge->idle);
+      pthread_mutex_unlock(&hedge->lock);
+      return -1;
+    }
+
+  call->attempts[1].started = 1;
+
+  return 0;
+}
+
+static int
+timespec_le(const struct timespec *t1,
+            const struct timespec *t2)
+{
+  return t1->tv_sec < t2->tv_sec ||
+    (t1->tv_sec == t2->tv_sec && t1->tv_nsec <= t2->tv_nsec);
+}
+
+/*
+ * start the twins of the primaries whose delay passed
+ */
+static void *
+hedge_timer_main(void *arg)
+{
+  struct dpl_hedge *hedge = arg;
+  struct hedge_call *call, **prev, *expired;
+  struct timespec now, next;
+  int has_next;
+
+  pthread_mutex_lock(&hedge->lock);
+
+  while (!hedge->stopping)
+    {
+      clock_gettime(CLOCK_REALTIME, &now);
+
+      expired = NULL;
+      has_next = 0;
+      prev = &hedge->pending;
+      while (NULL != (call = *prev))
+        {
+          if (timespec_le(&call->deadline, &now))
+            {
+              *prev = call->next;
+              call->next = expired;
+              expired = call;
+              continue ;
+            }
+
+          if (!has_next || timespec_le(&call->deadline, &next))
+            {
+              next = call->deadline;
+              has_next = 1;
+            }
+          prev = &call->next;
+        }
+
+      if (NULL == expired)
+        {
+          if (!has_next)
+            pthread_cond_wait(&hedge->armed, &hedge->lock);
+          else
+            pthread_cond_timedwait(&hedge->armed, &hedge->lock, &next);
+          continue ;
+        }
+
+      //calls are locked before the hedging state, never the reverse
+      pthread_mutex_unlock(&hedge->lock);
+
+      while (NULL != (call = expired))
+        {
+          expired = call->next;
+          call->next = NULL;
+
+          pthread_mutex_lock(&call->lock);
+
+          if (!call->attempts[0].replied && !call->attempts[0].done &&
+              0 == hedge_start_twin(call))
+            {
+              DPL_TRACE(call->ctx, DPL_TRACE_REST, "hedging after %lluus",
+                        (unsigned long long) call->delay_usec);
+
+              pthread_mutex_lock(&hedge->lock);
+              hedge->stats.hedges_sent++;
+              pthread_mutex_unlock(&hedge->lock);
+            }
+
+          //drop the reference of the pending list
+          hedge_call_unref(call);
+        }
+
+      pthread_mutex_lock(&hedge->lock);
+    }
+
+  pthread_mutex_unlock(&hedge->lock);
+
+  return NULL;
+}
+
+/*
+ * queue the call for its twin to be started after its delay
+ *
+ * @return -1 if there is no timer to do it
+ */
+static int
+hedge_arm(struct hedge_call *call)
+{
+  struct dpl_hedge *hedge = call->ctx->hedge;
+  int ret = 0;
+
+  clock_gettime(CLOCK_REALTIME, &call->deadline);
+  call->deadline.tv_sec += call->delay_usec / 1000000;
+  call->deadline.tv_nsec += (call->delay_usec % 1000000) * 1000;
+  if (call->deadline.tv_nsec >= 1000000000)
+    {
+      call->deadline.tv_sec++;
+      call->deadline.tv_nsec -= 1000000000;
+    }
+
+  pthread_mutex_lock(&hedge->lock);
+
+  if (!hedge->timer_started)
+    {
+      if (0 != pthread_create(&hedge->timer, NULL, hedge_timer_main, hedge))
+        {
+          ret = -1;
+          goto end;
+        }
+      hedge->timer_started = 1;
+    }
+
+  //the pending list holds a reference
+  call->refcount++;
+  call->next = hedge->pending;
+  hedge->pending = call;
+  pthread_cond_signal(&hedge->armed);
+
+ end:
+
+  pthread_mutex_unlock(&hedge->lock);
+
+  return ret;
+}
+
+/*
+ * withdraw the call from the pending list, if the timer did not already
+ */
+static void
+hedge_disarm(struct hedge_call *call)
+{
+  struct dpl_hedge *hedge = call->ctx->hedge;
+  struct hedge_call **prev;
+  int found = 0;
+
+  pthread_mutex_lock(&hedge->lock);
+
+  for (prev = &hedge->pending;NULL != *prev;prev = &(*prev)->next)
+    {
+      if (*prev == call)
+        {
+          *prev = call->next;
+          call->next = NULL;
+          found = 1;
+          break ;
+        }
+    }
+
+  pthread_mutex_unlock(&hedge->lock);
+
+  if (found)
+    {
+      pthread_mutex_lock(&call->lock);
+      hedge_call_unref(call);
+    }
+}
+
+static dpl_status_t
+hedge_run(struct hedge_call *call,
+          char **data_bufp,
+          unsigned int *data_lenp,
+          dpl_dict_t **metadatap,
+          dpl_sysmd_t *sysmdp,
+          char **locationp)
+{
+  dpl_ctx_t *ctx = call->ctx;
+  struct dpl_hedge *hedge = ctx->hedge;
+  struct hedge_attempt *primary = &call->attempts[0];
+  struct hedge_attempt *twin = &call->attempts[1];
+  struct hedge_attempt *winner = NULL;
+  dpl_status_t ret;
+  int armed;
+
+  armed = (0 == hedge_arm(call));
+
+  primary->started = 1;
+  hedge_attempt_run(primary);
+  pthread_mutex_unlock(&call->lock);
+
+  if (armed)
+    hedge_disarm(call);
+
+  pthread_mutex_lock(&call->lock);
+
+  //first conclusive answer wins, a transient failure waits for the twin
+  while (1)
+    {
+      if (hedge_conclusive(primary) && !primary->cancelled)
+        winner = primary;
+      else if (hedge_conclusive(twin))
+        winner = twin;
+      else if (!twin->started || twin->done)
+        winner = primary;
+
+      if (NULL != winner)
+        break ;
+
+      pthread_cond_wait(&call->cond, &call->lock);
+    }
+
+  //a running loser was cancelled by the winner and discards its result
+  if (winner != primary)
+    hedge_discard(primary);
+  else if (twin->done)
+    hedge_discard(twin);
+
+  if (winner == twin)
+    {
+      pthread_mutex_lock(&hedge->lock);
+      hedge->stats.hedges_won++;
+      pthread_mutex_unlock(&hedge->lock);
+    }
+
+  ret = winner->ret;
+
+  if (NULL != data_bufp && NULL != winner->data_buf)
+    {
+      *data_bufp = winner->data_buf;
+      winner->data_buf = NULL;
+    }
+
+  if (NULL != metadatap && NULL != winner->metadata)
+    {
+      *metadatap = winner->metadata;
+      winner->metadata = NULL;
+    }
+
+  if (NULL != locationp && NULL != winner->location)
+    {
+      *locationp = winner->location;
+      winner->location = NULL;
+    }
+
+  if (DPL_SUCCESS == ret)
+    {
+      if (NULL != data_lenp)
+        *data_lenp = winner->data_len;
+      if (NULL != sysmdp)
+        *sysmdp = winner->sysmd;
+    }
+
+  call->returned = 1;
+  hedge_call_unref(call);
+
+  return ret;
+}
+
+/**
+ * issue a GET, hedged if enabled and worth it
+ *
+ * arguments are those of the backend function `get`.  Hedging is not
+ * done with DPL_OPTION_NOALLOC, nor with a single host.
+ *
+ * @return the status of the request which answered first
+ */
+dpl_status_t
+dpl_hedge_get(dpl_ctx_t *ctx,
+              dpl_get_t get,
+              const char *bucket,
+              const char *resource,
+              const char *subresource,
+              const dpl_option_t *option,
+              dpl_ftype_t object_type,
+              const dpl_condition_t *condition,
+              const dpl_range_t *range,
+              char **data_bufp,
+              unsigned int *data_lenp,
+              dpl_dict_t **metadatap,
+              dpl_sysmd_t *sysmdp,
+              char **locationp)
+{
+  struct hedge_call *call;
+  uint64_t delay;
+
+  delay = hedge_delay(ctx, option);
+  if (0 == delay)
+    return get(ctx, bucket, resource, subresource, option, object_type,
+               condition, range, data_bufp, data_lenp, metadatap, sysmdp,
+               locationp);
+
+  call = hedge_call_new(ctx, bucket, resource, subresource, option,
+                        object_type, condition, delay);
+  if (NULL == call)
+    return DPL_ENOMEM;
+
+  call->get = get;
+  if (NULL != range)
+    {
+      call->range = *range;
+      call->has_range = 1;
+    }
+  call->want_data = (NULL != data_bufp);
+  call->want_metadata = (NULL != metadatap);
+  call->want_sysmd = (NULL != sysmdp);
+  call->want_location = (NULL != locationp);
+
+  return hedge_run(call, data_bufp, data_lenp, metadatap, sysmdp, locationp);
+}
+
+/**
+ * issue a HEAD, hedged if enabled and worth it
+ *
+ * arguments are those of the backend function `head`.
+ *
+ * @return the status of the request which answered first
+ */
+dpl_status_t
+dpl_hedge_head(dpl_ctx_t *ctx,
+               dpl_head_t head,
+               const char *bucket,
+               const char *resource,
+               const char *subresource,
+               const dpl_option_t *option,
+               dpl_ftype_t object_type,
+               const dpl_condition_t *condition,
+               dpl_dict_t **metadatap,
+               dpl_sysmd_t *sysmdp,
+               char **locationp)
+{
+  struct hedge_call *call;
+  uint64_t delay;
+
+  delay = hedge_delay(ctx, option);
+  if (0 == delay)
+    return head(ctx, bucket, resource, subresource, option, object_type,
+                condition, metadatap, sysmdp, locationp);
+
+  call = hedge_call_new(ctx, bucket, resource, subresource, option,
+                        object_type, condition, delay);
+  if (NULL == call)
+    return DPL_ENOMEM;
+
+  call->head = head;
+  call->want_metadata = (NULL != metadatap);
+  call->want_sysmd = (NULL != sysmdp);
+  call->want_location = (NULL != locationp);
+
+  return hedge_run(call, NULL, NULL, metadatap, sysmdp, locationp);
+}
+
+void
+dpl_hedge_get_stats(dpl_ctx_t *ctx,
+                    dpl_hedge_stats_t *statsp)
+{
+  struct dpl_hedge *hedge = ctx->hedge;
+
+  memset(statsp, 0, sizeof (*statsp));
+
+  if (NULL == hedge)
+    return;
+
+  pthread_mutex_lock(&hedge->lock);
+  *statsp = hedge->stats;
+  pthread_mutex_unlock(&hedge->lock);
+}
@@ -239,6 +239,8 @@ read_line(dpl_conn_t *conn)
 
 	  if (conn->cc == 0)
             conn->eof = 1;
+          else
+            dpl_rate_limit_download(conn->ctx, conn->cc);
 
           if (conn->ctx->trace_buffers)
             dpl_dump_simple(conn->read_buf, conn->cc, conn->ctx->trace_binary);
@@ -380,7 +382,7 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
 		      DPL_LOG(conn->ctx, DPL_ERROR,
 			      "Timed out waiting to read from server %s:%s",
 			      conn->host, conn->port);
-                      ret = DPL_FAILURE;
+                      ret = DPL_ETIMEOUT;
                       goto end;
                     }
                   else if (!(fds.revents & POLLIN))
@@ -402,7 +404,7 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
                       DPL_LOG(conn->ctx, DPL_ERROR,
 			      "Failed to read from server %s:%s: %s",
 			      conn->host, conn->port, strerror(errno));
-                      ret = DPL_FAILURE;
+                      ret = DPL_EIO;
                       goto end;
                     }
                 }
@@ -412,7 +414,7 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
                   if (conn->cc <= 0)
                     {
                       DPL_SSL_PERROR(conn->ctx, "SSL_read");
-                      ret = DPL_FAILURE;
+                      ret = DPL_EIO;
                       goto end;
                     }
                 }
@@ -422,9 +424,19 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
               if (0 == conn->cc)
                 {
                   DPRINTF("no more data to read\n");
+                  if (!connclose && chunk_off < chunk_len)
+                    {
+                      DPL_LOG(conn->ctx, DPL_ERROR,
+                              "Connection to server %s:%s closed mid-body",
+                              conn->host, conn->port);
+                      ret = DPL_EIO;
+                      goto end;
+                    }
                   break ;
                 }
 
+              dpl_rate_limit_download(conn->ctx, conn->cc);
+
               if (conn->ctx->trace_buffers)
                 dpl_dump_simple(conn->read_buf, conn->cc, conn->ctx->trace_binary);
 
@@ -465,7 +477,12 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
           if (NULL == line)
             {
               DPL_TRACE(conn->ctx, DPL_TRACE_ERR, "read line: %s", dpl_status_str(conn->status));
-              ret = DPL_FAILURE;
+              if (DPL_ETIMEOUT == conn->status)
+                ret = DPL_ETIMEOUT;
+              else if (DPL_EIO == conn->status || conn->eof)
+                ret = DPL_EIO;
+              else
+                ret = DPL_FAILURE;
               goto end;
             }
 
@@ -476,12 +493,15 @@ dpl_read_http_reply_buffered(dpl_conn_t *conn,
               if (http_parse_reply(line, &http_reply) != 0)
                 {
                   DPL_TRACE(conn->ctx, DPL_TRACE_ERR, "bad http reply: %.*s...", 100, line);
-                  ret = DPL_FAILURE;
+                  //an idle connection closed by the server reads as empty
+                  ret = conn->eof ? DPL_EIO : DPL_FAILURE;
                   goto end;
                 }
 
               DPL_TRACE(conn->ctx, DPL_TRACE_HTTP, "conn=%p http_status=%d", conn, http_reply.code);
 
+              dpl_conn_record_latency(conn);
+
               mode = MODE_HEADER;
 
               break ;
@@ -693,6 +713,9 @@ struct httreply_conven
   u_int data_len;
   u_int max_len;
   dpl_dict_t *headers;
+  dpl_buffer_func_t buffer_func; /*!< body consumer for the stream version */
+  void *cb_arg;
+  dpl_status_t cb_ret;
 };
 
 static dpl_status_t
@@ -766,6 +789,18 @@ cb_httpreply_buffer_noalloc(void *cb_arg,
   return DPL_SUCCESS;
 }
 
+static dpl_status_t
+cb_httpreply_buffer_stream(void *cb_arg,
+                           char *buf,
+                           u_int len)
+{
+  struct httreply_conven *hc = (struct httreply_conven *) cb_arg;
+
+  hc->cb_ret = hc->buffer_func(hc->cb_arg, buf, len);
+
+  return hc->cb_ret;
+}
+
 dpl_status_t
 dpl_map_http_status(int http_status)
 {
@@ -799,6 +834,14 @@ dpl_map_http_status(int http_status)
     case DPL_HTTP_CODE_RANGE_UNAVAIL:
       ret = DPL_ERANGEUNAVAIL;
       break;
+    case DPL_HTTP_CODE_INTERNAL_ERROR:
+    case DPL_HTTP_CODE_BAD_GATEWAY:
+    case DPL_HTTP_CODE_GATEWAY_TIMEOUT:
+      ret = DPL_ESERVER;
+      break;
+    case DPL_HTTP_CODE_SERVICE_UNAVAIL:
+      ret = DPL_EBUSY;
+      break;
     default:
       ret = DPL_FAILURE;
       break;
@@ -819,39 +862,42 @@ dpl_map_http_status(int http_status)
  *
  * @return dpl_status
  */
-dpl_status_t
-dpl_read_http_reply_ext(dpl_conn_t *conn,
-                        int expect_data,
-                        int buffer_provided,
-                        char **data_bufp,
-                        unsigned int *data_lenp,
-                        dpl_dict_t **headersp,
-                        int *connection_closep)
+static dpl_status_t
+read_http_reply(dpl_conn_t *conn,
+                int expect_data,
+                dpl_buffer_func_t buffer_func,
+                struct httreply_conven *hc,
+                int *connection_closep)
 {
   int ret, ret2;
-  struct httreply_conven hc;
   int connection_close = 0;
   int http_status;
 
-  memset(&hc, 0, sizeof (hc));
-
-  if (buffer_provided)
-    {
-      hc.data_buf = *data_bufp;
-      hc.max_len = *data_lenp;
-    }
-
   ret2 = dpl_read_http_reply_buffered(conn,
-                                      expect_data, 
-                                      &http_status, 
-                                      cb_httpreply_header, 
-                                      buffer_provided ? cb_httpreply_buffer_noalloc : cb_httpreply_buffer, 
-                                      &hc);
+                                      expect_data,
+                                      &http_status,
+                                      cb_httpreply_header,
+                                      buffer_func,
+                                      hc);
   if (DPL_SUCCESS != ret2)
     {
       //on I/O failure close connection
       connection_close = 1;
 
+      //the body consumer failed, not the host
+      if (DPL_SUCCESS != hc->cb_ret)
+        {
+          ret = hc->cb_ret;
+          goto end;
+        }
+
+      //a hedged twin answered first, the host is fine
+      if (conn->cancelled)
+        {
+          ret = ret2;
+          goto end;
+        }
+
       //blacklist host
       dpl_blacklist_host(conn->ctx, conn->host, conn->port);
 
@@ -860,7 +906,7 @@ dpl_read_http_reply_ext(dpl_conn_t *conn,
     }
 
   //connection_close might explicitely be requested
-  if (dpl_connection_close(hc.headers))
+  if (dpl_connection_close(hc->headers))
     connection_close = 1;
 
   //some servers does not send explicit connection information and does not support keep alive
@@ -876,6 +922,37 @@ dpl_read_http_reply_ext(dpl_conn_t *conn,
 
  end:
 
+  if (NULL != connection_closep)
+    *connection_closep = connection_close;
+
+  return ret;
+}
+
+dpl_status_t
+dpl_read_http_reply_ext(dpl_conn_t *conn,
+                        int expect_data,
+                        int buffer_provided,
+                        char **data_bufp,
+                        unsigned int *data_lenp,
+                        dpl_dict_t **headersp,
+                        int *connection_closep)
+{
+  int ret;
+  struct httreply_conven hc;
+
+  memset(&hc, 0, sizeof (hc));
+  hc.cb_ret = DPL_SUCCESS;
+
+  if (buffer_provided)
+    {
+      hc.data_buf = *data_bufp;
+      hc.max_len = *data_lenp;
+    }
+
+  ret = read_http_reply(conn, expect_data,
+                        buffer_provided ? cb_httpreply_buffer_noalloc : cb_httpreply_buffer,
+                        &hc, connection_closep);
+
   if (NULL != data_bufp)
     {
       *data_bufp = hc.data_buf;
@@ -898,8 +975,50 @@ dpl_read_http_reply_ext(dpl_conn_t *conn,
   if (NULL != hc.headers)
     dpl_dict_free(hc.headers);
 
-  if (NULL != connection_closep)
-    *connection_closep = connection_close;
+  return ret;
+}
+
+/**
+ * read http reply, handing the body to buffer_func as it arrives
+ *
+ * the body is passed whatever the status, e.g. to parse error replies.
+ *
+ * @param conn
+ * @param expect_data
+ * @param buffer_func
+ * @param cb_arg
+ * @param headersp caller must free it, may be NULL
+ * @param connection_closep
+ *
+ * @return dpl_status, or what buffer_func returned if it failed
+ */
+dpl_status_t
+dpl_read_http_reply_stream(dpl_conn_t *conn,
+                           int expect_data,
+                           dpl_buffer_func_t buffer_func,
+                           void *cb_arg,
+                           dpl_dict_t **headersp,
+                           int *connection_closep)
+{
+  int ret;
+  struct httreply_conven hc;
+
+  memset(&hc, 0, sizeof (hc));
+  hc.buffer_func = buffer_func;
+  hc.cb_arg = cb_arg;
+  hc.cb_ret = DPL_SUCCESS;
+
+  ret = read_http_reply(conn, expect_data, cb_httpreply_buffer_stream,
+                        &hc, connection_closep);
+
+  if (NULL != headersp)
+    {
+      *headersp = hc.headers;
+      hc.headers = NULL; //consumed
+    }
+
+  if (NULL != hc.headers)
+    dpl_dict_free(hc.headers);
 
   return ret;
 }
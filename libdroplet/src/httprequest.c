@@ -127,6 +127,13 @@ dpl_add_content_range_to_headers(const dpl_range_t *range,
   return dpl_add_range_to_headers_internal(range, "Content-Range", headers);
 }
 
+dpl_status_t
+dpl_add_copy_source_range_to_headers(const dpl_range_t *range,
+                                     dpl_dict_t *headers)
+{
+  return dpl_add_range_to_headers_internal(range, "x-amz-copy-source-range", headers);
+}
+
 dpl_status_t
 dpl_add_condition_to_headers(const dpl_condition_t *cond,
                              dpl_dict_t *headers)
@@ -0,0 +1,1478 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+#include "droplet/parallel.h"
+#include <sys/stat.h>
+
+/** @file */
+
+/**
+ * @defgroup parallel Parallel transfers
+ * @addtogroup parallel
+ * @{
+ * Split large objects into parts transferred concurrently on a task pool
+ */
+
+//#define DPRINTF(fmt,...) fprintf(stderr, fmt, ##__VA_ARGS__)
+#define DPRINTF(fmt,...)
+
+/*
+ * bounded window of in-flight parts shared by the submitter and the
+ * workers. the first failure is kept and stops further submissions.
+ */
+struct window
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int n_inflight;
+  int max_inflight;
+  dpl_status_t ret;
+};
+
+static void
+window_init(struct window *win,
+            int max_inflight)
+{
+  pthread_mutex_init(&win->lock, NULL);
+  pthread_cond_init(&win->cond, NULL);
+  win->n_inflight = 0;
+  win->max_inflight = max_inflight;
+  win->ret = DPL_SUCCESS;
+}
+
+static void
+window_destroy(struct window *win)
+{
+  pthread_mutex_destroy(&win->lock);
+  pthread_cond_destroy(&win->cond);
+}
+
+/*
+ * wait for a free slot. returns the first error seen so far if any, in
+ * which case no slot is taken
+ */
+static dpl_status_t
+window_acquire(struct window *win)
+{
+  dpl_status_t ret;
+
+  pthread_mutex_lock(&win->lock);
+  while (DPL_SUCCESS == win->ret && win->n_inflight >= win->max_inflight)
+    pthread_cond_wait(&win->cond, &win->lock);
+  ret = win->ret;
+  if (DPL_SUCCESS == ret)
+    win->n_inflight++;
+  pthread_mutex_unlock(&win->lock);
+
+  return ret;
+}
+
+static void
+window_release(struct window *win,
+               dpl_status_t ret)
+{
+  pthread_mutex_lock(&win->lock);
+  if (DPL_SUCCESS != ret && DPL_SUCCESS == win->ret)
+    win->ret = ret;
+  win->n_inflight--;
+  pthread_cond_broadcast(&win->cond);
+  pthread_mutex_unlock(&win->lock);
+}
+
+/*
+ * record a failure detected outside of a part
+ */
+static void
+window_fail(struct window *win,
+            dpl_status_t ret)
+{
+  pthread_mutex_lock(&win->lock);
+  if (DPL_SUCCESS == win->ret)
+    win->ret = ret;
+  pthread_cond_broadcast(&win->cond);
+  pthread_mutex_unlock(&win->lock);
+}
+
+static int
+window_failed(struct window *win)
+{
+  int failed;
+
+  pthread_mutex_lock(&win->lock);
+  failed = (DPL_SUCCESS != win->ret);
+  pthread_mutex_unlock(&win->lock);
+
+  return failed;
+}
+
+/*
+ * wait for all parts to finish and return the first error
+ */
+static dpl_status_t
+window_wait(struct window *win)
+{
+  dpl_status_t ret;
+
+  pthread_mutex_lock(&win->lock);
+  while (win->n_inflight > 0)
+    pthread_cond_wait(&win->cond, &win->lock);
+  ret = win->ret;
+  pthread_mutex_unlock(&win->lock);
+
+  return ret;
+}
+
+/*
+ * transient failures worth retrying on a part, as for a single request
+ */
+static int
+part_is_retryable(dpl_status_t ret)
+{
+  dpl_retry_reason_t reason;
+
+  return dpl_retry_classify(ret, &reason);
+}
+
+static void
+params_resolve(const dpl_parallel_params_t *params,
+               dpl_parallel_params_t *resolved)
+{
+  if (NULL != params)
+    *resolved = *params;
+  else
+    {
+      memset(resolved, 0, sizeof (*resolved));
+      resolved->max_retries = -1;
+    }
+
+  if (0 == resolved->part_size)
+    resolved->part_size = DPL_PARALLEL_DEFAULT_PART_SIZE;
+  if (0 >= resolved->n_parallel)
+    resolved->n_parallel = DPL_PARALLEL_DEFAULT_N_PARALLEL;
+  if (0 > resolved->max_retries)
+    resolved->max_retries = DPL_PARALLEL_DEFAULT_MAX_RETRIES;
+}
+
+/*
+ * parallel GET
+ */
+
+struct get_parallel
+{
+  struct window win;
+  dpl_ctx_t *ctx;
+  const char *bucket;
+  const char *resource;
+  dpl_option_t option;
+  dpl_ftype_t object_type;
+  dpl_condition_t condition;
+  char *buf;    /*!< either buf ... */
+  int fd;       /*!< ... or fd */
+  int max_retries;
+};
+
+struct get_part
+{
+  dpl_task_t task; /*!< mandatory */
+  struct get_parallel *gp;
+  uint64_t start;
+  unsigned int len;
+};
+
+static dpl_status_t
+get_part_once(struct get_part *part)
+{
+  struct get_parallel *gp = part->gp;
+  dpl_status_t ret, ret2;
+  dpl_range_t range;
+  dpl_option_t option;
+  char *data_buf = NULL;
+  unsigned int data_len;
+  unsigned int off;
+  ssize_t cc;
+
+  range.start = part->start;
+  range.end = part->start + part->len - 1;
+
+  option = gp->option;
+  if (NULL != gp->buf)
+    {
+      option.mask |= DPL_OPTION_NOALLOC;
+      data_buf = gp->buf + part->start;
+    }
+  data_len = part->len;
+
+  ret2 = dpl_get(gp->ctx, gp->bucket, gp->resource, &option,
+                 gp->object_type,
+                 gp->condition.n_conds > 0 ? &gp->condition : NULL,
+                 &range, &data_buf, &data_len, NULL, NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (data_len != part->len)
+    {
+      DPL_TRACE(gp->ctx, DPL_TRACE_ERR, "short part at %llu: got %u expected %u",
+                (unsigned long long) part->start, data_len, part->len);
+      ret = DPL_EIO;
+      goto end;
+    }
+
+  if (NULL == gp->buf)
+    {
+      for (off = 0;off < data_len;off += cc)
+        {
+          cc = pwrite(gp->fd, data_buf + off, data_len - off, part->start + off);
+          if (-1 == cc)
+            {
+              if (EINTR == errno)
+                {
+                  cc = 0;
+                  continue ;
+                }
+              DPL_TRACE(gp->ctx, DPL_TRACE_ERR, "pwrite failed: %s", strerror(errno));
+              ret = DPL_ESYS;
+              goto end;
+            }
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL == gp->buf && NULL != data_buf)
+    free(data_buf);
+
+  return ret;
+}
+
+static void
+get_part_do(void *arg)
+{
+  struct get_part *part = (struct get_part *) arg;
+  struct get_parallel *gp = part->gp;
+  dpl_status_t ret;
+  int retry;
+
+  for (retry = 0;;retry++)
+    {
+      if (window_failed(&gp->win))
+        {
+          ret = DPL_SUCCESS; //another part already failed
+          break ;
+        }
+
+      ret = get_part_once(part);
+      if (DPL_SUCCESS == ret || !part_is_retryable(ret) || retry >= gp->max_retries)
+        break ;
+
+      DPL_TRACE(gp->ctx, DPL_TRACE_WARN, "retrying part at %llu (%d/%d): %s",
+                (unsigned long long) part->start, retry + 1, gp->max_retries,
+                dpl_status_str(ret));
+    }
+
+  free(part);
+  window_release(&gp->win, ret);
+}
+
+static dpl_status_t
+get_parallel(dpl_ctx_t *ctx,
+             const char *bucket,
+             const char *resource,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             const dpl_parallel_params_t *params,
+             char *buf,
+             uint64_t buf_size,
+             int fd,
+             uint64_t *lenp,
+             dpl_dict_t **metadatap,
+             dpl_sysmd_t *sysmdp)
+{
+  dpl_status_t ret, ret2;
+  dpl_parallel_params_t p;
+  struct get_parallel gp;
+  int win_inited = 0;
+  dpl_task_pool_t *pool = NULL;
+  int own_pool = 0;
+  dpl_dict_t *metadata = NULL;
+  dpl_sysmd_t sysmd;
+  uint64_t off;
+  struct get_part *part;
+
+  params_resolve(params, &p);
+
+  //whole chunks, so that none is fetched by two parts
+  if (dpl_crypt_enabled(ctx))
+    p.part_size = (p.part_size + DPL_CRYPT_CHUNK_SIZE - 1) / DPL_CRYPT_CHUNK_SIZE * DPL_CRYPT_CHUNK_SIZE;
+
+  if (p.part_size > UINT_MAX)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  ret2 = dpl_head(ctx, bucket, resource, option, object_type, condition,
+                  NULL != metadatap ? &metadata : NULL, &sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (!(sysmd.mask & DPL_SYSMD_MASK_SIZE))
+    {
+      DPL_TRACE(ctx, DPL_TRACE_ERR, "backend did not return object size");
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  if (NULL != lenp)
+    *lenp = sysmd.size;
+
+  if (NULL != buf && sysmd.size > buf_size)
+    {
+      ret = DPL_ELIMIT;
+      goto end;
+    }
+
+  memset(&gp, 0, sizeof (gp));
+  gp.ctx = ctx;
+  gp.bucket = bucket;
+  gp.resource = resource;
+  if (NULL != option)
+    gp.option = *option;
+  gp.object_type = object_type;
+  if (NULL != condition)
+    gp.condition = *condition;
+  gp.buf = buf;
+  gp.fd = fd;
+  gp.max_retries = p.max_retries;
+
+  //pin every part to the version we just sized
+  if ((sysmd.mask & DPL_SYSMD_MASK_ETAG) && gp.condition.n_conds < DPL_COND_MAX)
+    {
+      dpl_condition_one_t *cond = &gp.condition.conds[gp.condition.n_conds];
+
+      cond->type = DPL_CONDITION_IF_MATCH;
+      if (strlen(sysmd.etag) + 2 <= DPL_ETAG_SIZE)
+        snprintf(cond->etag, sizeof (cond->etag), "\"%s\"", sysmd.etag);
+      else
+        snprintf(cond->etag, sizeof (cond->etag), "%s", sysmd.etag);
+      gp.condition.n_conds++;
+    }
+
+  window_init(&gp.win, p.n_parallel);
+  win_inited = 1;
+
+  pool = p.pool;
+  if (NULL == pool && sysmd.size > 0)
+    {
+      pool = dpl_task_pool_create(ctx, "getparallel", p.n_parallel);
+      if (NULL == pool)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      own_pool = 1;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "get_parallel size=%llu part_size=%llu n_parallel=%d",
+            (unsigned long long) sysmd.size, (unsigned long long) p.part_size,
+            p.n_parallel);
+
+  for (off = 0;off < sysmd.size;off += p.part_size)
+    {
+      if (DPL_SUCCESS != window_acquire(&gp.win))
+        break ;
+
+      part = calloc(1, sizeof (*part));
+      if (NULL == part)
+        {
+          window_release(&gp.win, DPL_ENOMEM);
+          break ;
+        }
+
+      part->task.func = get_part_do;
+      part->gp = &gp;
+      part->start = off;
+      part->len = MIN(p.part_size, sysmd.size - off);
+
+      dpl_task_pool_put(pool, (dpl_task_t *) part);
+    }
+
+  ret2 = window_wait(&gp.win);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != metadatap)
+    {
+      *metadatap = metadata;
+      metadata = NULL;
+    }
+
+  if (NULL != sysmdp)
+    *sysmdp = sysmd;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (own_pool)
+    dpl_task_pool_destroy(pool);
+
+  if (win_inited)
+    window_destroy(&gp.win);
+
+  if (NULL != metadata)
+    dpl_dict_free(metadata);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+/**
+ * get a resource into a caller buffer with concurrent ranged GETs
+ *
+ * the object is sized with a HEAD, then split into parts of
+ * params->part_size bytes fetched concurrently. every part is
+ * conditioned on the ETag returned by the HEAD so the object cannot
+ * change during the transfer.
+ *
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param resource the mandatory resource
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_ANY get any type of resource
+ * @param condition the optional condition
+ * @param params the optional tuning parameters
+ * @param buf the caller buffer
+ * @param buf_size size of buf
+ * @param lenp the returned object size
+ * @param metadatap the returned user metadata client shall free
+ * @param sysmdp the returned system metadata passed through stack
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT resource does not exist
+ * @return DPL_ELIMIT buf is too small, *lenp holds the object size
+ * @return DPL_EPRECOND the object changed during the transfer
+ */
+dpl_status_t
+dpl_get_parallel(dpl_ctx_t *ctx,
+                 const char *bucket,
+                 const char *resource,
+                 const dpl_option_t *option,
+                 dpl_ftype_t object_type,
+                 const dpl_condition_t *condition,
+                 const dpl_parallel_params_t *params,
+                 char *buf,
+                 uint64_t buf_size,
+                 uint64_t *lenp,
+                 dpl_dict_t **metadatap,
+                 dpl_sysmd_t *sysmdp)
+{
+  if (NULL == buf)
+    return DPL_EINVAL;
+
+  return get_parallel(ctx, bucket, resource, option, object_type, condition,
+                      params, buf, buf_size, -1, lenp, metadatap, sysmdp);
+}
+
+/**
+ * get a resource into a file descriptor with concurrent ranged GETs
+ *
+ * same as dpl_get_parallel() but every part is written with pwrite(2)
+ * at its offset in fd
+ *
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param resource the mandatory resource
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_ANY get any type of resource
+ * @param condition the optional condition
+ * @param params the optional tuning parameters
+ * @param fd a file descriptor opened for writing and supporting pwrite(2)
+ * @param lenp the returned object size
+ * @param metadatap the returned user metadata client shall free
+ * @param sysmdp the returned system metadata passed through stack
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT resource does not exist
+ * @return DPL_EPRECOND the object changed during the transfer
+ */
+dpl_status_t
+dpl_get_parallel_fd(dpl_ctx_t *ctx,
+                    const char *bucket,
+                    const char *resource,
+                    const dpl_option_t *option,
+                    dpl_ftype_t object_type,
+                    const dpl_condition_t *condition,
+                    const dpl_parallel_params_t *params,
+                    int fd,
+                    uint64_t *lenp,
+                    dpl_dict_t **metadatap,
+                    dpl_sysmd_t *sysmdp)
+{
+  if (0 > fd)
+    return DPL_EINVAL;
+
+  return get_parallel(ctx, bucket, resource, option, object_type, condition,
+                      params, NULL, 0, fd, lenp, metadatap, sysmdp);
+}
+
+/*
+ * parallel multipart PUT
+ */
+
+struct put_parallel
+{
+  struct window win;
+  dpl_ctx_t *ctx;
+  const char *bucket;
+  const char *resource;
+  const char *uploadid;
+  struct json_object *parts; /*!< protected by win.lock */
+  int max_retries;
+  const dpl_crypt_t *crypt; /*!< NULL unless encrypting */
+};
+
+struct put_part
+{
+  dpl_task_t task; /*!< mandatory */
+  struct put_parallel *pp;
+  unsigned int partnb;
+  uint64_t offset; /*!< in the plaintext */
+  char *buf;
+  unsigned int len;
+  int final; /*!< last part of the object */
+};
+
+/*
+ * encrypt in the worker, once for all the retries
+ */
+static dpl_status_t
+put_part_encrypt(struct put_part *part)
+{
+  const dpl_crypt_t *crypt = part->pp->crypt;
+  uint64_t cipher_len;
+  char *cipher_buf;
+  dpl_status_t ret;
+
+  cipher_len = dpl_crypt_cipher_size(crypt->chunk_size, part->len, part->final);
+  if (cipher_len > UINT_MAX)
+    return DPL_ELIMIT;
+
+  cipher_buf = malloc(cipher_len);
+  if (NULL == cipher_buf)
+    return DPL_ENOMEM;
+
+  ret = dpl_crypt_encrypt(crypt, part->offset, part->buf, part->len,
+                          part->final, cipher_buf);
+  if (DPL_SUCCESS != ret)
+    {
+      free(cipher_buf);
+      return ret;
+    }
+
+  free(part->buf);
+  part->buf = cipher_buf;
+  part->len = cipher_len;
+
+  return DPL_SUCCESS;
+}
+
+static void
+put_part_do(void *arg)
+{
+  struct put_part *part = (struct put_part *) arg;
+  struct put_parallel *pp = part->pp;
+  dpl_status_t ret;
+  const char *etag = NULL;
+  struct json_object *json_etag;
+  int retry;
+
+  if (NULL != pp->crypt && !window_failed(&pp->win))
+    {
+      ret = put_part_encrypt(part);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
+  for (retry = 0;;retry++)
+    {
+      if (window_failed(&pp->win))
+        {
+          ret = DPL_SUCCESS; //another part already failed
+          goto end;
+        }
+
+      ret = dpl_multipart_put(pp->ctx, pp->bucket, pp->resource, pp->uploadid,
+                              part->partnb, part->buf, part->len, &etag);
+      if (DPL_SUCCESS == ret || !part_is_retryable(ret) || retry >= pp->max_retries)
+        break ;
+
+      DPL_TRACE(pp->ctx, DPL_TRACE_WARN, "retrying part %u (%d/%d): %s",
+                part->partnb, retry + 1, pp->max_retries, dpl_status_str(ret));
+    }
+
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  json_etag = json_object_new_string(etag);
+  if (NULL == json_etag)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  pthread_mutex_lock(&pp->win.lock);
+  json_object_array_put_idx(pp->parts, part->partnb - 1, json_etag);
+  pthread_mutex_unlock(&pp->win.lock);
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != etag)
+    free((void *) etag);
+  free(part->buf);
+  free(part);
+  window_release(&pp->win, ret);
+}
+
+/*
+ * fill buf unless the source is exhausted
+ */
+static dpl_status_t
+read_full(dpl_parallel_read_func_t read_func,
+          void *cb_arg,
+          char *buf,
+          unsigned int len,
+          unsigned int *lenp)
+{
+  dpl_status_t ret;
+  unsigned int off = 0;
+  unsigned int cc;
+
+  while (off < len)
+    {
+      ret = read_func(cb_arg, buf + off, len - off, &cc);
+      if (DPL_SUCCESS != ret)
+        return ret;
+
+      if (0 == cc)
+        break ;
+
+      off += cc;
+    }
+
+  *lenp = off;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * upload a resource with a parallel multipart upload
+ *
+ * data is read sequentially from read_func into part_size buffers which
+ * are uploaded concurrently. at most n_parallel parts are in flight so
+ * memory is bounded to (n_parallel + 1) * part_size. failed parts are
+ * retried, and the upload is aborted on a fatal error so no orphan
+ * parts are left behind. data smaller than one part is sent with a
+ * single dpl_put(), which is the only case where it gets compressed.
+ *
+ * @param ctx the droplet context
+ * @param bucket the bucket
+ * @param resource the resource
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
+ * @param params the optional tuning parameters, part_size is raised to
+ * DPL_MULTIPART_MIN_PART_SIZE if needed
+ * @param read_func the data source
+ * @param cb_arg closure of read_func
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP the backend does not support multipart uploads
+ * @return DPL_ELIMIT more than DPL_MULTIPART_MAX_PARTS parts
+ */
+dpl_status_t
+dpl_put_parallel(dpl_ctx_t *ctx,
+                 const char *bucket,
+                 const char *resource,
+                 const dpl_dict_t *metadata,
+                 const dpl_sysmd_t *sysmd,
+                 const dpl_parallel_params_t *params,
+                 dpl_parallel_read_func_t read_func,
+                 void *cb_arg)
+{
+  dpl_status_t ret, ret2;
+  dpl_parallel_params_t p;
+  struct put_parallel pp;
+  int win_inited = 0;
+  dpl_task_pool_t *pool = NULL;
+  int own_pool = 0;
+  const char *uploadid = NULL;
+  struct json_object *parts = NULL;
+  char *buf = NULL;
+  unsigned int len;
+  unsigned int partnb = 0;
+  uint64_t total = 0;
+  struct put_part *part;
+  dpl_crypt_t *crypt = NULL;
+  dpl_dict_t *crypt_md = NULL;
+
+  params_resolve(params, &p);
+
+  if (p.part_size < DPL_MULTIPART_MIN_PART_SIZE)
+    p.part_size = DPL_MULTIPART_MIN_PART_SIZE;
+
+  //parts hold whole chunks, only the last one may end with a partial chunk
+  if (dpl_crypt_enabled(ctx))
+    p.part_size = (p.part_size + DPL_CRYPT_CHUNK_SIZE - 1) / DPL_CRYPT_CHUNK_SIZE * DPL_CRYPT_CHUNK_SIZE;
+
+  if (p.part_size > UINT_MAX)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  buf = malloc(p.part_size);
+  if (NULL == buf)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = read_full(read_func, cb_arg, buf, p.part_size, &len);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (len < p.part_size)
+    {
+      //fits in one part
+      ret2 = dpl_put(ctx, bucket, resource, NULL, DPL_FTYPE_REG, NULL, NULL,
+                     metadata, sysmd, buf, len);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  //the envelope goes along with the initiation, which takes the metadata
+  if (dpl_crypt_enabled(ctx))
+    {
+      crypt = dpl_crypt_new(ctx);
+      if (NULL == crypt)
+        {
+          ret = DPL_FAILURE;
+          goto end;
+        }
+
+      crypt_md = (NULL != metadata) ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+      if (NULL == crypt_md)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+
+      ret2 = dpl_crypt_seal(ctx, crypt, crypt_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      metadata = crypt_md;
+    }
+
+  ret2 = dpl_multipart_init_ext(ctx, bucket, resource, metadata, sysmd, &uploadid);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  parts = json_object_new_array();
+  if (NULL == parts)
+    {
+      ret = DPL_ENOMEM;
+      goto abort;
+    }
+
+  memset(&pp, 0, sizeof (pp));
+  pp.ctx = ctx;
+  pp.bucket = bucket;
+  pp.resource = resource;
+  pp.uploadid = uploadid;
+  pp.parts = parts;
+  pp.max_retries = p.max_retries;
+  pp.crypt = crypt;
+
+  window_init(&pp.win, p.n_parallel);
+  win_inited = 1;
+
+  pool = p.pool;
+  if (NULL == pool)
+    {
+      pool = dpl_task_pool_create(ctx, "putparallel", p.n_parallel);
+      if (NULL == pool)
+        {
+          ret = DPL_ENOMEM;
+          goto abort;
+        }
+      own_pool = 1;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "put_parallel uploadid=%s part_size=%llu n_parallel=%d",
+            uploadid, (unsigned long long) p.part_size, p.n_parallel);
+
+  while (1)
+    {
+      if (DPL_MULTIPART_MAX_PARTS == partnb)
+        {
+          window_fail(&pp.win, DPL_ELIMIT);
+          break ;
+        }
+
+      if (DPL_SUCCESS != window_acquire(&pp.win))
+        break ;
+
+      part = calloc(1, sizeof (*part));
+      if (NULL == part)
+        {
+          window_release(&pp.win, DPL_ENOMEM);
+          break ;
+        }
+
+      part->task.func = put_part_do;
+      part->pp = &pp;
+      part->partnb = ++partnb;
+      part->offset = total;
+      part->buf = buf;
+      part->len = len;
+      part->final = len < p.part_size;
+      buf = NULL;
+      total += len;
+
+      dpl_task_pool_put(pool, (dpl_task_t *) part);
+
+      if (len < p.part_size)
+        break ; //last part
+
+      //read the next part while the previous ones are in flight
+      buf = malloc(p.part_size);
+      if (NULL == buf)
+        {
+          window_fail(&pp.win, DPL_ENOMEM);
+          break ;
+        }
+
+      ret2 = read_full(read_func, cb_arg, buf, p.part_size, &len);
+      if (DPL_SUCCESS != ret2)
+        {
+          window_fail(&pp.win, ret2);
+          break ;
+        }
+
+      //unless the object ends with an empty last chunk
+      if (0 == len && NULL == crypt)
+        break ;
+    }
+
+  ret2 = window_wait(&pp.win);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto abort;
+    }
+
+  ret2 = dpl_multipart_complete(ctx, bucket, resource, uploadid, parts, partnb,
+                                metadata, sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto abort;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "put_parallel uploaded %u parts %llu bytes",
+            partnb, (unsigned long long) total);
+
+  ret = DPL_SUCCESS;
+  goto end;
+
+ abort:
+
+  ret2 = dpl_multipart_abort(ctx, bucket, resource, uploadid);
+  if (DPL_SUCCESS != ret2)
+    DPL_LOG(ctx, DPL_WARNING, "could not abort upload %s of %s: %s",
+            uploadid, resource, dpl_status_str(ret2));
+
+ end:
+
+  if (own_pool)
+    dpl_task_pool_destroy(pool);
+
+  if (win_inited)
+    window_destroy(&pp.win);
+
+  if (NULL != parts)
+    json_object_put(parts);
+
+  if (NULL != uploadid)
+    free((void *) uploadid);
+
+  if (NULL != buf)
+    free(buf);
+
+  if (NULL != crypt_md)
+    dpl_dict_free(crypt_md);
+
+  dpl_crypt_destroy(crypt);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+struct fd_source
+{
+  int fd;
+  uint64_t offset;
+};
+
+static dpl_status_t
+fd_source_read(void *cb_arg,
+               char *buf,
+               unsigned int len,
+               unsigned int *lenp)
+{
+  struct fd_source *src = (struct fd_source *) cb_arg;
+  ssize_t cc;
+
+  do
+    cc = pread(src->fd, buf, len, src->offset);
+  while (-1 == cc && EINTR == errno);
+
+  if (-1 == cc)
+    return DPL_ESYS;
+
+  src->offset += cc;
+  *lenp = cc;
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * upload the content of a file descriptor with a parallel multipart upload
+ *
+ * the part size is raised if needed so that a regular file fits in
+ * DPL_MULTIPART_MAX_PARTS parts. see dpl_put_parallel()
+ *
+ * @param ctx the droplet context
+ * @param bucket the bucket
+ * @param resource the resource
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
+ * @param params the optional tuning parameters
+ * @param fd a file descriptor supporting pread(2), read from offset 0
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ESYS read error
+ */
+dpl_status_t
+dpl_fput_file(dpl_ctx_t *ctx,
+              const char *bucket,
+              const char *resource,
+              const dpl_dict_t *metadata,
+              const dpl_sysmd_t *sysmd,
+              const dpl_parallel_params_t *params,
+              int fd)
+{
+  dpl_parallel_params_t p;
+  struct fd_source src;
+  struct stat st;
+  uint64_t min_part_size;
+
+  if (0 > fd)
+    return DPL_EINVAL;
+
+  params_resolve(params, &p);
+
+  if (0 == fstat(fd, &st) && S_ISREG(st.st_mode))
+    {
+      min_part_size = (st.st_size + DPL_MULTIPART_MAX_PARTS - 1) / DPL_MULTIPART_MAX_PARTS;
+      if (p.part_size < min_part_size)
+        p.part_size = min_part_size;
+    }
+
+  src.fd = fd;
+  src.offset = 0;
+
+  return dpl_put_parallel(ctx, bucket, resource, metadata, sysmd, &p,
+                          fd_source_read, &src);
+}
+
+/*
+ * parallel multipart copy
+ */
+
+struct copy_parallel
+{
+  struct window win;
+  dpl_ctx_t *ctx;
+  const char *src_bucket;
+  const char *src_resource;
+  const char *dst_bucket;
+  const char *dst_resource;
+  const char *uploadid;
+  dpl_condition_t condition;
+  struct json_object *parts; /*!< protected by win.lock */
+  int max_retries;
+};
+
+struct copy_part
+{
+  dpl_task_t task; /*!< mandatory */
+  struct copy_parallel *cp;
+  unsigned int partnb;
+  dpl_range_t range;
+};
+
+static void
+copy_part_do(void *arg)
+{
+  struct copy_part *part = (struct copy_part *) arg;
+  struct copy_parallel *cp = part->cp;
+  dpl_status_t ret;
+  const char *etag = NULL;
+  struct json_object *json_etag;
+  int retry;
+
+  for (retry = 0;;retry++)
+    {
+      if (window_failed(&cp->win))
+        {
+          ret = DPL_SUCCESS; //another part already failed
+          goto end;
+        }
+
+      ret = dpl_multipart_copy(cp->ctx, cp->dst_bucket, cp->dst_resource,
+                               cp->uploadid, part->partnb,
+                               cp->src_bucket, cp->src_resource, &part->range,
+                               cp->condition.n_conds > 0 ? &cp->condition : NULL,
+                               &etag);
+      if (DPL_SUCCESS == ret || !part_is_retryable(ret) || retry >= cp->max_retries)
+        break ;
+
+      DPL_TRACE(cp->ctx, DPL_TRACE_WARN, "retrying part %u (%d/%d): %s",
+                part->partnb, retry + 1, cp->max_retries, dpl_status_str(ret));
+    }
+
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  json_etag = json_object_new_string(etag);
+  if (NULL == json_etag)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  pthread_mutex_lock(&cp->win.lock);
+  json_object_array_put_idx(cp->parts, part->partnb - 1, json_etag);
+  pthread_mutex_unlock(&cp->win.lock);
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != etag)
+    free((void *) etag);
+  free(part);
+  window_release(&cp->win, ret);
+}
+
+/**
+ * server side copy of a large object with a parallel multipart copy,
+ * the source being already known
+ *
+ * same as dpl_copy_parallel() for a caller that already issued the HEAD
+ * of the source, e.g. to decide whether the copy is worth parallelizing
+ *
+ * @param src_sysmd the system metadata of the stored source, its size
+ * is mandatory
+ * @param src_metadata the user metadata of the stored source, envelope
+ * and compression metadata included
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP the backend does not support multipart copies
+ * @return DPL_EPRECOND the source changed during the copy
+ */
+dpl_status_t
+dpl_copy_parallel_sized(dpl_ctx_t *ctx,
+                        const char *src_bucket,
+                        const char *src_resource,
+                        const char *dst_bucket,
+                        const char *dst_resource,
+                        const dpl_dict_t *metadata,
+                        const dpl_sysmd_t *sysmd,
+                        const dpl_condition_t *condition,
+                        const dpl_parallel_params_t *params,
+                        const dpl_sysmd_t *src_sysmdp,
+                        const dpl_dict_t *src_metadata)
+{
+  dpl_status_t ret, ret2;
+  dpl_parallel_params_t p;
+  struct copy_parallel cp;
+  int win_inited = 0;
+  dpl_task_pool_t *pool = NULL;
+  int own_pool = 0;
+  const char *uploadid = NULL;
+  struct json_object *parts = NULL;
+  dpl_dict_t *crypt_md = NULL;
+  dpl_sysmd_t src_sysmd = *src_sysmdp;
+  uint64_t off, min_part_size;
+  unsigned int partnb = 0;
+  struct copy_part *part;
+
+  params_resolve(params, &p);
+
+  if (NULL == params || 0 == params->part_size)
+    p.part_size = DPL_PARALLEL_DEFAULT_COPY_PART_SIZE;
+
+  if (NULL == ctx->backend->multipart_copy)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  if (NULL != metadata && NULL != src_metadata)
+    {
+      crypt_md = dpl_dict_dup(metadata);
+      if (NULL == crypt_md)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+
+      ret2 = dpl_crypt_copy_envelope(src_metadata, crypt_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = dpl_compress_copy_md(src_metadata, crypt_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      metadata = crypt_md;
+    }
+
+  if (!(src_sysmd.mask & DPL_SYSMD_MASK_SIZE))
+    {
+      DPL_TRACE(ctx, DPL_TRACE_ERR, "backend did not return object size");
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  if (0 == src_sysmd.size)
+    {
+      //an empty range cannot be expressed
+      ret2 = dpl_copy(ctx, src_bucket, src_resource, dst_bucket, dst_resource,
+                      NULL, DPL_FTYPE_REG,
+                      NULL == metadata ? DPL_COPY_DIRECTIVE_COPY : DPL_COPY_DIRECTIVE_METADATA_REPLACE,
+                      metadata, sysmd, condition);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  min_part_size = (src_sysmd.size + DPL_MULTIPART_MAX_PARTS - 1) / DPL_MULTIPART_MAX_PARTS;
+  if (p.part_size < min_part_size)
+    p.part_size = min_part_size;
+  if (p.part_size < DPL_MULTIPART_MIN_PART_SIZE)
+    p.part_size = DPL_MULTIPART_MIN_PART_SIZE;
+  if (p.part_size > DPL_MULTIPART_MAX_PART_SIZE)
+    p.part_size = DPL_MULTIPART_MAX_PART_SIZE;
+
+  memset(&cp, 0, sizeof (cp));
+  cp.ctx = ctx;
+  cp.src_bucket = src_bucket;
+  cp.src_resource = src_resource;
+  cp.dst_bucket = dst_bucket;
+  cp.dst_resource = dst_resource;
+  if (NULL != condition)
+    cp.condition = *condition;
+  cp.max_retries = p.max_retries;
+
+  //pin every part to the version we just sized
+  if ((src_sysmd.mask & DPL_SYSMD_MASK_ETAG) && cp.condition.n_conds < DPL_COND_MAX)
+    {
+      dpl_condition_one_t *cond = &cp.condition.conds[cp.condition.n_conds];
+
+      cond->type = DPL_CONDITION_IF_MATCH;
+      if (strlen(src_sysmd.etag) + 2 <= DPL_ETAG_SIZE)
+        snprintf(cond->etag, sizeof (cond->etag), "\"%s\"", src_sysmd.etag);
+      else
+        snprintf(cond->etag, sizeof (cond->etag), "%s", src_sysmd.etag);
+      cp.condition.n_conds++;
+    }
+
+  //a multipart copy does not carry the metadata of the source over
+  ret2 = dpl_multipart_init_ext(ctx, dst_bucket, dst_resource,
+                                NULL != metadata ? metadata : src_metadata,
+                                sysmd, &uploadid);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  parts = json_object_new_array();
+  if (NULL == parts)
+    {
+      ret = DPL_ENOMEM;
+      goto abort;
+    }
+
+  cp.uploadid = uploadid;
+  cp.parts = parts;
+
+  window_init(&cp.win, p.n_parallel);
+  win_inited = 1;
+
+  pool = p.pool;
+  if (NULL == pool)
+    {
+      pool = dpl_task_pool_create(ctx, "copyparallel", p.n_parallel);
+      if (NULL == pool)
+        {
+          ret = DPL_ENOMEM;
+          goto abort;
+        }
+      own_pool = 1;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "copy_parallel uploadid=%s size=%llu part_size=%llu n_parallel=%d",
+            uploadid, (unsigned long long) src_sysmd.size,
+            (unsigned long long) p.part_size, p.n_parallel);
+
+  for (off = 0;off < src_sysmd.size;off += p.part_size)
+    {
+      if (DPL_SUCCESS != window_acquire(&cp.win))
+        break ;
+
+      part = calloc(1, sizeof (*part));
+      if (NULL == part)
+        {
+          window_release(&cp.win, DPL_ENOMEM);
+          break ;
+        }
+
+      part->task.func = copy_part_do;
+      part->cp = &cp;
+      part->partnb = ++partnb;
+      part->range.start = off;
+      part->range.end = MIN(off + p.part_size, src_sysmd.size) - 1;
+
+      dpl_task_pool_put(pool, (dpl_task_t *) part);
+    }
+
+  ret2 = window_wait(&cp.win);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto abort;
+    }
+
+  ret2 = dpl_multipart_complete(ctx, dst_bucket, dst_resource, uploadid, parts, partnb,
+                                NULL != metadata ? metadata : src_metadata, sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto abort;
+    }
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "copy_parallel copied %u parts %llu bytes",
+            partnb, (unsigned long long) src_sysmd.size);
+
+  ret = DPL_SUCCESS;
+  goto end;
+
+ abort:
+
+  ret2 = dpl_multipart_abort(ctx, dst_bucket, dst_resource, uploadid);
+  if (DPL_SUCCESS != ret2)
+    DPL_LOG(ctx, DPL_WARNING, "could not abort upload %s of %s: %s",
+            uploadid, dst_resource, dpl_status_str(ret2));
+
+ end:
+
+  if (own_pool)
+    dpl_task_pool_destroy(pool);
+
+  if (win_inited)
+    window_destroy(&cp.win);
+
+  if (NULL != parts)
+    json_object_put(parts);
+
+  if (NULL != uploadid)
+    free((void *) uploadid);
+
+  if (NULL != crypt_md)
+    dpl_dict_free(crypt_md);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+
+/**
+ * server side copy of a large object with a parallel multipart copy
+ *
+ * the source is sized with a HEAD, then copied by ranges of
+ * params->part_size bytes issued concurrently as UploadPartCopy, so
+ * that objects larger than the limit of a single copy can be copied and
+ * the copy is spread over several server side streams. every part is
+ * conditioned on the ETag returned by the HEAD so the source cannot
+ * change during the copy. the upload is aborted on failure.
+ *
+ * @param ctx the droplet context
+ * @param src_bucket the source bucket
+ * @param src_resource the source resource
+ * @param dst_bucket the destination bucket
+ * @param dst_resource the destination resource
+ * @param metadata the user metadata of the destination, those of the
+ * source if NULL
+ * @param sysmd the optional system metadata of the destination
+ * @param condition the optional condition on the source
+ * @param params the optional tuning parameters, part_size defaults to
+ * DPL_PARALLEL_DEFAULT_COPY_PART_SIZE and is raised if needed so that
+ * the object fits in DPL_MULTIPART_MAX_PARTS parts
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT the source does not exist
+ * @return DPL_ENOTSUPP the backend does not support multipart copies
+ * @return DPL_EPRECOND the source changed during the copy
+ */
+dpl_status_t
+dpl_copy_parallel(dpl_ctx_t *ctx,
+                  const char *src_bucket,
+                  const char *src_resource,
+                  const char *dst_bucket,
+                  const char *dst_resource,
+                  const dpl_dict_t *metadata,
+                  const dpl_sysmd_t *sysmd,
+                  const dpl_condition_t *condition,
+                  const dpl_parallel_params_t *params)
+{
+  dpl_status_t ret, ret2;
+  dpl_dict_t *src_metadata = NULL;
+  dpl_option_t option;
+  dpl_sysmd_t src_sysmd;
+
+  if (NULL == ctx->backend->multipart_copy)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  //the parts are ranges of the stored object, envelope and compression
+  //metadata included
+  memset(&option, 0, sizeof (option));
+  option.mask |= DPL_OPTION_NOCRYPT | DPL_OPTION_NOCOMPRESS;
+
+  memset(&src_sysmd, 0, sizeof (src_sysmd));
+  ret2 = dpl_head(ctx, src_bucket, src_resource, &option, DPL_FTYPE_REG, condition,
+                  &src_metadata,
+                  &src_sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = dpl_copy_parallel_sized(ctx, src_bucket, src_resource, dst_bucket, dst_resource,
+                                 metadata, sysmd, condition, params,
+                                 &src_sysmd, src_metadata);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != src_metadata)
+    dpl_dict_free(src_metadata);
+
+  return ret;
+}
+
+/* @} */
@@ -304,6 +304,10 @@ conf_cb_func(void *cb_arg,
     {
       ctx->blacklist_expiretime = atoi(value);
     }
+  else if (!strcmp(var, "vhost_cache_ttl"))
+    {
+      ctx->vhost_cache_ttl = atoi(value);
+    }
   else if (! strcmp(var, "header_size"))
     {
       ctx->header_size = strtoul(value, NULL, 0);
@@ -352,6 +356,26 @@ conf_cb_func(void *cb_arg,
     {
       strncpy(ctx->aws_region, value, sizeof(ctx->aws_region));
     }
+  else if (!strcmp(var, "aws_unsigned_payload"))
+    {
+      if (!strcasecmp(value, "true"))
+        ctx->aws_unsigned_payload = 1;
+      else if (!strcasecmp(value, "false"))
+        ctx->aws_unsigned_payload = 0;
+      else
+        {
+          DPL_LOG(ctx, DPL_ERROR, "invalid boolean value for '%s'", var);
+          return -1;
+        }
+    }
+  else if (!strcmp(var, "aws_list_version"))
+    {
+      ctx->aws_list_version = atoi(value);
+      if (ctx->aws_list_version != 1 && ctx->aws_list_version != 2) {
+        DPL_LOG(ctx, DPL_ERROR, "aws_list_version must be set 1 or 2");
+        return -1;
+      }
+    }
   else if (!strcmp(var, "ssl_cert_file"))
     {
       free(ctx->ssl_cert_file);
@@ -562,6 +586,110 @@ conf_cb_func(void *cb_arg,
     {
       ctx->write_timeout = strtoul(value, NULL, 0);
     }
+  else if (! strcmp(var, "dcache_ttl"))
+    {
+      ctx->dcache_ttl = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "dcache_negative_ttl"))
+    {
+      ctx->dcache_negative_ttl = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "dcache_max_entries"))
+    {
+      ctx->dcache_max_entries = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "acache_ttl"))
+    {
+      ctx->acache_ttl = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "acache_negative_ttl"))
+    {
+      ctx->acache_negative_ttl = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "acache_max_entries"))
+    {
+      ctx->acache_max_entries = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "read_ahead_size"))
+    {
+      ctx->read_ahead_size = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "write_back_size"))
+    {
+      ctx->write_back_size = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "copy_parallel_threshold"))
+    {
+      ctx->copy_parallel_threshold = strtoull(value, NULL, 0);
+    }
+  else if (! strcmp(var, "retry_max"))
+    {
+      ctx->retry_max = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "retry_delay"))
+    {
+      ctx->retry_delay = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "retry_max_delay"))
+    {
+      ctx->retry_max_delay = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "retry_budget"))
+    {
+      ctx->retry_budget = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "max_request_rate"))
+    {
+      ctx->max_request_rate = strtoull(value, NULL, 0);
+    }
+  else if (! strcmp(var, "max_upload_rate"))
+    {
+      ctx->max_upload_rate = strtoull(value, NULL, 0);
+    }
+  else if (! strcmp(var, "max_download_rate"))
+    {
+      ctx->max_download_rate = strtoull(value, NULL, 0);
+    }
+  else if (! strcmp(var, "hedge_percentile"))
+    {
+      ctx->hedge_percentile = strtoul(value, NULL, 0);
+    }
+  else if (! strcmp(var, "hedge_min_delay"))
+    {
+      ctx->hedge_min_delay = strtoul(value, NULL, 0);
+    }
+  else if (!strcmp(var, "compress"))
+    {
+      if (!strcasecmp(value, "true"))
+        ctx->compress = 1;
+      else if (!strcasecmp(value, "false"))
+        ctx->compress = 0;
+      else
+        {
+          DPL_LOG(ctx, DPL_ERROR, "invalid boolean value for '%s'", var);
+          return -1;
+        }
+#if !defined(HAVE_ZLIB) && !defined(HAVE_ZSTD)
+      if (ctx->compress)
+        DPL_LOG(ctx, DPL_WARNING, "compression is not supported by this build");
+#endif
+    }
+  else if (! strcmp(var, "compress_level"))
+    {
+      ctx->compress_level = strtoul(value, NULL, 0);
+    }
+  else if (!strcmp(var, "compress_codec"))
+    {
+      if (!dpl_compress_codec_supported(value))
+        {
+          DPL_LOG(ctx, DPL_ERROR, "compression codec '%s' is not supported by this build", value);
+          return -1;
+        }
+      free(ctx->compress_codec);
+      ctx->compress_codec = strdup(value);
+      if (NULL == ctx->compress_codec)
+        return -1;
+    }
   else if (! strcmp(var, "droplet_dir") ||
 	   ! strcmp(var, "profile_name"))
     {
@@ -665,6 +793,7 @@ dpl_profile_default(dpl_ctx_t *ctx)
   ctx->use_https = 0;
   ctx->addrlist = NULL;
   ctx->blacklist_expiretime = 10;
+  ctx->vhost_cache_ttl = DPL_DEFAULT_VHOST_CACHE_TTL;
   ctx->pricing = NULL;
   ctx->pricing_dir = NULL;
   ctx->read_buf_size = DPL_DEFAULT_READ_BUF_SIZE;
@@ -673,12 +802,34 @@ dpl_profile_default(dpl_ctx_t *ctx)
   ctx->url_encoding = 1;
   ctx->preserve_root_path = 0;
   ctx->max_redirects = DPL_DEFAULT_MAX_REDIRECTS;
+  ctx->dcache_ttl = DPL_DEFAULT_DCACHE_TTL;
+  ctx->dcache_negative_ttl = DPL_DEFAULT_DCACHE_NEGATIVE_TTL;
+  ctx->dcache_max_entries = DPL_DEFAULT_DCACHE_MAX_ENTRIES;
+  ctx->acache_ttl = DPL_DEFAULT_ACACHE_TTL;
+  ctx->acache_negative_ttl = DPL_DEFAULT_ACACHE_NEGATIVE_TTL;
+  ctx->acache_max_entries = DPL_DEFAULT_ACACHE_MAX_ENTRIES;
+  ctx->read_ahead_size = DPL_DEFAULT_READ_AHEAD_SIZE;
+  ctx->write_back_size = DPL_DEFAULT_WRITE_BACK_SIZE;
+  ctx->copy_parallel_threshold = DPL_DEFAULT_COPY_PARALLEL_THRESHOLD;
+  ctx->retry_max = DPL_DEFAULT_RETRY_MAX;
+  ctx->retry_delay = DPL_DEFAULT_RETRY_DELAY;
+  ctx->retry_max_delay = DPL_DEFAULT_RETRY_MAX_DELAY;
+  ctx->retry_budget = DPL_DEFAULT_RETRY_BUDGET;
+  ctx->max_request_rate = DPL_DEFAULT_MAX_REQUEST_RATE;
+  ctx->max_upload_rate = DPL_DEFAULT_MAX_UPLOAD_RATE;
+  ctx->max_download_rate = DPL_DEFAULT_MAX_DOWNLOAD_RATE;
+  ctx->hedge_percentile = DPL_DEFAULT_HEDGE_PERCENTILE;
+  ctx->hedge_min_delay = DPL_DEFAULT_HEDGE_MIN_DELAY;
+  ctx->compress = DPL_DEFAULT_COMPRESS;
+  ctx->compress_level = DPL_DEFAULT_COMPRESS_LEVEL;
   ctx->enterprise_number = DPL_DEFAULT_ENTERPRISE_NUMBER;
   ctx->base_path = strdup(DPL_DEFAULT_BASE_PATH);
   if (NULL == ctx->base_path)
     return DPL_ENOMEM;
   ctx->aws_auth_sign_version = DPL_DEFAULT_AWS_AUTH_SIGN_VERSION;
   strncpy(ctx->aws_region, DPL_DEFAULT_AWS_REGION, sizeof(ctx->aws_region));
+  ctx->aws_list_version = DPL_DEFAULT_AWS_LIST_VERSION;
+  ctx->aws_unsigned_payload = DPL_DEFAULT_AWS_UNSIGNED_PAYLOAD;
   ctx->ssl_method = DPL_DEFAULT_SSL_METHOD;
   ctx->ssl_cipher_list = strdup(DPL_DEFAULT_SSL_CIPHER_LIST);
   if (NULL == ctx->ssl_cipher_list)
@@ -1012,6 +1163,34 @@ dpl_profile_post(dpl_ctx_t *ctx)
   if (NULL == ctx->cur_bucket)
     return DPL_FAILURE;
 
+  ret = dpl_vdir_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_dcache_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_acache_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_retry_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_rate_limit_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_hedge_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  ret = dpl_crypt_init(ctx);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
   return DPL_SUCCESS;
 }
 
@@ -1090,6 +1269,9 @@ dpl_profile_set_from_dict(dpl_ctx_t *ctx,
 void
 dpl_profile_free(dpl_ctx_t *ctx)
 {
+  //losing hedged attempts still use the pool and the profile
+  dpl_hedge_free(ctx);
+
   dpl_conn_pool_destroy(ctx);
 
   dpl_close_event_log(ctx);
@@ -1129,6 +1311,8 @@ dpl_profile_free(dpl_ctx_t *ctx)
     free(ctx->pricing);
   if (NULL != ctx->encrypt_key)
     free(ctx->encrypt_key);
+  if (NULL != ctx->compress_codec)
+    free(ctx->compress_codec);
   if (NULL != ctx->pricing_dir)
     free(ctx->pricing_dir);
 
@@ -1143,5 +1327,12 @@ dpl_profile_free(dpl_ctx_t *ctx)
     dpl_dict_free(ctx->cwds);
   if (NULL != ctx->cur_bucket)
     free(ctx->cur_bucket);
+  dpl_vdir_free(ctx);
+
+  dpl_dcache_free(ctx);
+  dpl_acache_free(ctx);
+  dpl_retry_free(ctx);
+  dpl_rate_limit_free(ctx);
+  dpl_crypt_free(ctx);
 
 }
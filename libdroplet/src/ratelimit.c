@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+
+/** @file */
+
+/*
+ * Client-side shaping: token buckets bounding the request rate and the
+ * bandwidth in each direction of a context, so that a client sharing a
+ * service with others stays below the rates which trigger server-side
+ * throttling instead of bouncing off 503 SlowDown.
+ *
+ * Buckets hold one second worth of tokens.  Consumers take what they
+ * used, possibly driving the bucket into debt, and sleep until the debt
+ * is repaid: large writes are thus admitted at once and the following
+ * ones delayed, which keeps the average rate without splitting I/Os.
+ */
+
+struct bucket
+{
+  double rate;                  /*!< tokens per second, 0 unlimited */
+  double tokens;
+  struct timespec last;
+  uint64_t *countp;
+  uint64_t *waitsp;
+  uint64_t *wait_usecp;
+};
+
+struct dpl_rate_limits
+{
+  pthread_mutex_t lock;
+  struct bucket requests;
+  struct bucket upload;
+  struct bucket download;
+  dpl_rate_limit_stats_t stats;
+  dpl_rate_limit_clock_func_t clock_func;
+  dpl_rate_limit_sleep_func_t sleep_func;
+};
+
+static void
+monotonic_clock(struct timespec *nowp)
+{
+  clock_gettime(CLOCK_MONOTONIC, nowp);
+}
+
+static void
+real_sleep(useconds_t usec)
+{
+  usleep(usec);
+}
+
+static void
+bucket_init(struct dpl_rate_limits *limits,
+            struct bucket *bucket,
+            uint64_t rate,
+            uint64_t *countp,
+            uint64_t *waitsp,
+            uint64_t *wait_usecp)
+{
+  bucket->rate = rate;
+  bucket->tokens = rate;
+  limits->clock_func(&bucket->last);
+  bucket->countp = countp;
+  bucket->waitsp = waitsp;
+  bucket->wait_usecp = wait_usecp;
+}
+
+static void
+bucket_consume(struct dpl_rate_limits *limits,
+               struct bucket *bucket,
+               double amount)
+{
+  struct timespec now;
+  double elapsed;
+  useconds_t delay = 0;
+
+  if (0 == bucket->rate)
+    return ;
+
+  pthread_mutex_lock(&limits->lock);
+
+  //read under the lock, so that last never goes backwards
+  limits->clock_func(&now);
+
+  elapsed = (now.tv_sec - bucket->last.tv_sec) +
+    (now.tv_nsec - bucket->last.tv_nsec) / 1e9;
+  bucket->last = now;
+
+  bucket->tokens = MIN(bucket->tokens + elapsed * bucket->rate, bucket->rate);
+  bucket->tokens -= amount;
+  *bucket->countp += amount;
+
+  if (bucket->tokens < 0)
+    {
+      delay = (useconds_t) (-bucket->tokens / bucket->rate * 1e6);
+      (*bucket->waitsp)++;
+      *bucket->wait_usecp += delay;
+    }
+
+  pthread_mutex_unlock(&limits->lock);
+
+  if (delay > 0)
+    limits->sleep_func(delay);
+}
+
+/**
+ * allocate the rate limiters of the context, if enabled by the profile
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_rate_limit_init(dpl_ctx_t *ctx)
+{
+  struct dpl_rate_limits *limits;
+
+  ctx->rate_limits = NULL;
+
+  if (0 == ctx->max_request_rate &&
+      0 == ctx->max_upload_rate &&
+      0 == ctx->max_download_rate)
+    return DPL_SUCCESS;
+
+  limits = calloc(1, sizeof (*limits));
+  if (NULL == limits)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&limits->lock, NULL);
+  limits->clock_func = monotonic_clock;
+  limits->sleep_func = real_sleep;
+
+  bucket_init(limits, &limits->requests, ctx->max_request_rate,
+              &limits->stats.requests,
+              &limits->stats.request_waits,
+              &limits->stats.request_wait_usec);
+  bucket_init(limits, &limits->upload, ctx->max_upload_rate,
+              &limits->stats.upload_bytes,
+              &limits->stats.upload_waits,
+              &limits->stats.upload_wait_usec);
+  bucket_init(limits, &limits->download, ctx->max_download_rate,
+              &limits->stats.download_bytes,
+              &limits->stats.download_waits,
+              &limits->stats.download_wait_usec);
+
+  ctx->rate_limits = limits;
+
+  return DPL_SUCCESS;
+}
+
+void
+dpl_rate_limit_free(dpl_ctx_t *ctx)
+{
+  struct dpl_rate_limits *limits = ctx->rate_limits;
+
+  if (NULL == limits)
+    return;
+
+  pthread_mutex_destroy(&limits->lock);
+  free(limits);
+  ctx->rate_limits = NULL;
+}
+
+/**
+ * wait, if needed, before issuing a request
+ *
+ * @param ctx
+ */
+void
+dpl_rate_limit_request(dpl_ctx_t *ctx)
+{
+  if (NULL == ctx->rate_limits)
+    return;
+
+  bucket_consume(ctx->rate_limits, &ctx->rate_limits->requests, 1);
+}
+
+/**
+ * tell whether sent bytes must be accounted for
+ *
+ * @param ctx
+ *
+ * @return 1 if the upload rate is limited
+ */
+int
+dpl_rate_limit_upload_enabled(dpl_ctx_t *ctx)
+{
+  return NULL != ctx->rate_limits && 0 != ctx->rate_limits->upload.rate;
+}
+
+/**
+ * account for bytes sent, waiting if the upload rate is exceeded
+ *
+ * @param ctx
+ * @param len
+ */
+void
+dpl_rate_limit_upload(dpl_ctx_t *ctx,
+                      size_t len)
+{
+  if (NULL == ctx->rate_limits)
+    return;
+
+  bucket_consume(ctx->rate_limits, &ctx->rate_limits->upload, len);
+}
+
+/**
+ * account for bytes received, waiting if the download rate is exceeded
+ *
+ * @param ctx
+ * @param len
+ */
+void
+dpl_rate_limit_download(dpl_ctx_t *ctx,
+                        size_t len)
+{
+  if (NULL == ctx->rate_limits)
+    return;
+
+  bucket_consume(ctx->rate_limits, &ctx->rate_limits->download, len);
+}
+
+void
+dpl_rate_limit_get_stats(dpl_ctx_t *ctx,
+                         dpl_rate_limit_stats_t *statsp)
+{
+  struct dpl_rate_limits *limits = ctx->rate_limits;
+
+  memset(statsp, 0, sizeof (*statsp));
+
+  if (NULL == limits)
+    return;
+
+  pthread_mutex_lock(&limits->lock);
+  *statsp = limits->stats;
+  pthread_mutex_unlock(&limits->lock);
+}
+
+/**
+ * replace the clock and the sleep of the rate limiters, e.g. to test them
+ * against a fixed clock
+ *
+ * the buckets are full again, as of the new clock's current time
+ *
+ * @param ctx
+ * @param clock_func
+ * @param sleep_func
+ */
+void
+dpl_rate_limit_set_clock(dpl_ctx_t *ctx,
+                         dpl_rate_limit_clock_func_t clock_func,
+                         dpl_rate_limit_sleep_func_t sleep_func)
+{
+  struct dpl_rate_limits *limits = ctx->rate_limits;
+
+  if (NULL == limits)
+    return;
+
+  pthread_mutex_lock(&limits->lock);
+  limits->clock_func = clock_func;
+  limits->sleep_func = sleep_func;
+  bucket_init(limits, &limits->requests, limits->requests.rate,
+              limits->requests.countp, limits->requests.waitsp,
+              limits->requests.wait_usecp);
+  bucket_init(limits, &limits->upload, limits->upload.rate,
+              limits->upload.countp, limits->upload.waitsp,
+              limits->upload.wait_usecp);
+  bucket_init(limits, &limits->download, limits->download.rate,
+              limits->download.countp, limits->download.waitsp,
+              limits->download.wait_usecp);
+  pthread_mutex_unlock(&limits->lock);
+}
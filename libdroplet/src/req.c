@@ -172,33 +172,51 @@ dpl_req_set_bucket(dpl_req_t *req,
   return DPL_SUCCESS;
 }
 
-dpl_status_t
-dpl_req_set_resource(dpl_req_t *req,
-                     const char *resource)
+/**
+ * compute the resource of a request from a path, as
+ * dpl_req_set_resource() does, into a caller buffer
+ *
+ * @param ctx
+ * @param resource
+ * @param npath
+ * @param npath_size
+ */
+void
+dpl_req_resource_path(const dpl_ctx_t *ctx,
+                      const char *resource,
+                      char *npath,
+                      size_t npath_size)
 {
-  char *nstr;
-  char npath[DPL_MAXPATHLEN];
-
   if (resource == NULL || *resource == '\0' || !strcmp(resource, "/")) {
-    if (!strcmp(req->ctx->base_path, "/")) {
-      if (!req->ctx->preserve_root_path)
+    if (!strcmp(ctx->base_path, "/")) {
+      if (!ctx->preserve_root_path)
         npath[0] = '\0';
       else
-        strncpy(npath, resource, sizeof (npath));
+        strncpy(npath, resource, npath_size);
     }
     else {
-      if (!req->ctx->preserve_root_path)
-        strncpy(npath, req->ctx->base_path, sizeof (npath));
+      if (!ctx->preserve_root_path)
+        strncpy(npath, ctx->base_path, npath_size);
       else {
-        snprintf(npath, sizeof (npath), "%s%s", req->ctx->base_path, resource);
+        snprintf(npath, npath_size, "%s%s", ctx->base_path, resource);
       }
     }
   } else {
-    if (!strcmp(req->ctx->base_path, "/"))
-      snprintf(npath, sizeof (npath), "%s", resource);
+    if (!strcmp(ctx->base_path, "/"))
+      snprintf(npath, npath_size, "%s", resource);
     else
-      snprintf(npath, sizeof (npath), "%s/%s", req->ctx->base_path, resource);
+      snprintf(npath, npath_size, "%s/%s", ctx->base_path, resource);
   }
+}
+
+dpl_status_t
+dpl_req_set_resource(dpl_req_t *req,
+                     const char *resource)
+{
+  char *nstr;
+  char npath[DPL_MAXPATHLEN];
+
+  dpl_req_resource_path(req->ctx, resource, npath, sizeof (npath));
 
   nstr = strdup(npath);
   if (NULL == nstr)
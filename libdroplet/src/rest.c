@@ -32,6 +32,7 @@
  * https://github.com/scality/Droplet
  */
 #include "dropletp.h"
+#include "droplet/parallel.h"
 
 /** @file */
 
@@ -53,41 +54,2526 @@
  * Configuring the backend is done is the profile dictionnary or the profile configuration file (see dpl_ctx_new())
  */
 
+/*
+ * a write guarded by a condition is not idempotent: replayed after an
+ * ambiguous failure it could fail the very condition it first satisfied
+ */
+static int
+is_idempotent_write(const dpl_condition_t *condition)
+{
+  return NULL == condition || 0 == condition->n_conds;
+}
+
+/*
+ * client-side encryption (see crypt.c) wraps the plain entry points,
+ * which are passed along so that path and ID flavors share the code
+ */
+typedef dpl_status_t (*put_func_t)(dpl_ctx_t *ctx, const char *bucket, const char *locator, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, const dpl_range_t *range, const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd, const char *data_buf, unsigned int data_len);
+typedef dpl_status_t (*get_func_t)(dpl_ctx_t *ctx, const char *bucket, const char *locator, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, const dpl_range_t *range, char **data_bufp, unsigned int *data_lenp, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+typedef dpl_status_t (*head_func_t)(dpl_ctx_t *ctx, const char *bucket, const char *locator, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+
+static dpl_status_t head_plain(dpl_ctx_t *ctx, const char *bucket, const char *path, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+static dpl_status_t head_id_plain(dpl_ctx_t *ctx, const char *bucket, const char *id, const dpl_option_t *option, dpl_ftype_t object_type, const dpl_condition_t *condition, dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp);
+
+static int
+crypt_applies(dpl_ctx_t *ctx,
+              const dpl_option_t *option,
+              dpl_ftype_t object_type)
+{
+  if (!dpl_crypt_enabled(ctx))
+    return 0;
+
+  if (NULL != option && option->mask & DPL_OPTION_NOCRYPT)
+    return 0;
+
+  return DPL_FTYPE_REG == object_type || DPL_FTYPE_ANY == object_type ||
+    DPL_FTYPE_UNDEF == object_type;
+}
+
+static dpl_status_t
+put_encrypt(dpl_ctx_t *ctx,
+            put_func_t put_func,
+            const char *bucket,
+            const char *locator,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            const dpl_range_t *range,
+            const dpl_dict_t *metadata,
+            const dpl_sysmd_t *sysmd,
+            const char *data_buf,
+            unsigned int data_len)
+{
+  dpl_crypt_t *crypt = NULL;
+  dpl_dict_t *md = NULL;
+  char *cipher_buf = NULL;
+  uint64_t cipher_len;
+  dpl_status_t ret, ret2;
+
+  if (NULL != range)
+    {
+      //chunks cannot be rewritten in place
+      DPL_LOG(ctx, DPL_ERROR, "ranged put of an encrypted object");
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  crypt = dpl_crypt_new(ctx);
+  if (NULL == crypt)
+    {
+      ret = DPL_FAILURE;
+      goto end;
+    }
+
+  md = (NULL != metadata) ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+  if (NULL == md)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_crypt_seal(ctx, crypt, md);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  cipher_len = dpl_crypt_cipher_size(crypt->chunk_size, data_len, 1);
+  if (cipher_len > UINT_MAX)
+    {
+      ret = DPL_ELIMIT;
+      goto end;
+    }
+
+  cipher_buf = malloc(cipher_len);
+  if (NULL == cipher_buf)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_crypt_encrypt(crypt, 0, data_buf, data_len, 1, cipher_buf);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = put_func(ctx, bucket, locator, option, object_type, condition, NULL,
+                 md, sysmd, cipher_buf, cipher_len);
+
+ end:
+
+  free(cipher_buf);
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  dpl_crypt_destroy(crypt);
+
+  return ret;
+}
+
+/*
+ * bounds [*startp, *endp) of a range of an object of size bytes, a NULL
+ * range being the whole object and a DPL_UNDEF start its last range->end
+ * bytes
+ */
+static dpl_status_t
+range_bounds(const dpl_range_t *range,
+             uint64_t size,
+             uint64_t *startp,
+             uint64_t *endp)
+{
+  uint64_t start, end;
+
+  if (NULL == range)
+    {
+      *startp = 0;
+      *endp = size;
+      return DPL_SUCCESS;
+    }
+
+  if (DPL_UNDEF == range->start)
+    {
+      start = (range->end < size) ? size - range->end : 0;
+      end = size;
+    }
+  else
+    {
+      start = range->start;
+      end = (DPL_UNDEF == range->end || range->end >= size) ?
+        size : range->end + 1;
+    }
+
+  if (start >= end)
+    return DPL_ERANGEUNAVAIL;
+
+  *startp = start;
+  *endp = end;
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * chunks dropped at the end would go unnoticed otherwise
+ */
+static dpl_status_t
+check_truncation(dpl_ctx_t *ctx,
+                 const char *locator,
+                 uint64_t len,
+                 uint64_t expected_len)
+{
+  if (len != expected_len)
+    {
+      DPL_LOG(ctx, DPL_ERROR, "%s is truncated", locator);
+      return DPL_EINTEGRITY;
+    }
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * hand the len bytes at off in *bufp over to the caller, either copied
+ * to its buf_len bytes buffer with DPL_OPTION_NOALLOC, truncated to the
+ * buffer size as by the backends, or by taking *bufp over
+ */
+static dpl_status_t
+deliver_data(const dpl_option_t *option,
+             char **bufp,
+             size_t off,
+             size_t len,
+             unsigned int buf_len,
+             char **data_bufp,
+             unsigned int *data_lenp)
+{
+  char *buf = *bufp;
+
+  if (NULL != option && option->mask & DPL_OPTION_NOALLOC)
+    {
+      if (NULL != data_lenp)
+        {
+          len = MIN(len, buf_len);
+          if (len > 0)
+            memcpy(*data_bufp, buf + off, len);
+          *data_lenp = len;
+        }
+
+      return DPL_SUCCESS;
+    }
+
+  if (NULL == buf)
+    {
+      buf = malloc(1);
+      if (NULL == buf)
+        return DPL_ENOMEM;
+      *bufp = buf;
+    }
+
+  if (0 != off)
+    memmove(buf, buf + off, len);
+
+  if (NULL != data_bufp)
+    {
+      *data_bufp = buf;
+      *bufp = NULL;
+    }
+
+  if (NULL != data_lenp)
+    *data_lenp = len;
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * the chunks holding the range are fetched assuming the default chunk
+ * size, and fetched again if the object was written with another one.
+ * The last bytes of an object are located from its size, with a HEAD.
+ * Objects without an envelope are fetched again with the original
+ * range, unless there was none.
+ */
+static dpl_status_t
+get_decrypt(dpl_ctx_t *ctx,
+            get_func_t get_func,
+            head_func_t head_func,
+            const char *bucket,
+            const char *locator,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            const dpl_range_t *range,
+            char **data_bufp,
+            unsigned int *data_lenp,
+            dpl_dict_t **metadatap,
+            dpl_sysmd_t *sysmdp)
+{
+  dpl_option_t cipher_option;
+  dpl_range_t abs_range, cipher_range, *cipher_rangep = NULL;
+  dpl_sysmd_t stored_sysmd;
+  uint32_t chunk_size = DPL_CRYPT_CHUNK_SIZE;
+  int remapped = 0, final;
+  uint64_t first = 0, size, start, end, expected_end;
+  char *cipher_buf = NULL;
+  char *plain_buf = NULL;
+  unsigned int cipher_len, buf_len = 0;
+  size_t plain_len, off, len;
+  dpl_dict_t *md = NULL;
+  dpl_crypt_t *crypt = NULL;
+  dpl_status_t ret, ret2;
+
+  //the ciphertext does not fit in the buffer of the caller
+  if (NULL != option)
+    cipher_option = *option;
+  else
+    memset(&cipher_option, 0, sizeof (cipher_option));
+  cipher_option.mask &= ~DPL_OPTION_NOALLOC;
+
+  if (NULL != option && option->mask & DPL_OPTION_NOALLOC && NULL != data_lenp)
+    buf_len = *data_lenp;
+
+  if (NULL != range && DPL_UNDEF == range->start)
+    {
+      memset(&stored_sysmd, 0, sizeof (stored_sysmd));
+      ret2 = head_func(ctx, bucket, locator, option, object_type, condition,
+                       &md, &stored_sysmd);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = dpl_crypt_open(ctx, md, &crypt);
+      if (DPL_ENOENT == ret2)
+        {
+          ret = get_func(ctx, bucket, locator, option, object_type, condition,
+                         range, data_bufp, data_lenp, metadatap, sysmdp);
+          goto end;
+        }
+      else if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      if (!(stored_sysmd.mask & DPL_SYSMD_MASK_SIZE))
+        {
+          ret = DPL_ENOTSUPP;
+          goto end;
+        }
+
+      if (-1 == dpl_crypt_plain_size(crypt->chunk_size, stored_sysmd.size, &size))
+        {
+          DPL_LOG(ctx, DPL_ERROR, "%s is truncated", locator);
+          ret = DPL_EINTEGRITY;
+          goto end;
+        }
+
+      ret2 = range_bounds(range, size, &start, &end);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      abs_range.start = start;
+      abs_range.end = end - 1;
+      range = &abs_range;
+      chunk_size = crypt->chunk_size;
+      remapped = 1;
+
+      dpl_dict_free(md);
+      md = NULL;
+      dpl_crypt_destroy(crypt);
+      crypt = NULL;
+    }
+
+ again:
+
+  if (NULL != range)
+    {
+      first = dpl_crypt_cipher_range(chunk_size, range->start, range->end,
+                                     &cipher_range);
+      cipher_rangep = &cipher_range;
+    }
+
+  cipher_len = 0;
+  ret2 = get_func(ctx, bucket, locator, &cipher_option, object_type, condition,
+                  cipher_rangep, &cipher_buf, &cipher_len, &md, sysmdp);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = dpl_crypt_open(ctx, md, &crypt);
+  if (DPL_ENOENT == ret2)
+    {
+      if (NULL != range)
+        {
+          free(cipher_buf);
+          cipher_buf = NULL;
+          dpl_dict_free(md);
+          md = NULL;
+
+          ret = get_func(ctx, bucket, locator, option, object_type, condition,
+                         range, data_bufp, data_lenp, metadatap, sysmdp);
+          goto end;
+        }
+
+      plain_buf = cipher_buf;
+      cipher_buf = NULL;
+      off = 0;
+      len = cipher_len;
+      goto deliver;
+    }
+  else if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != cipher_rangep && crypt->chunk_size != chunk_size && !remapped)
+    {
+      chunk_size = crypt->chunk_size;
+      remapped = 1;
+
+      free(cipher_buf);
+      cipher_buf = NULL;
+      dpl_dict_free(md);
+      md = NULL;
+      dpl_crypt_destroy(crypt);
+      crypt = NULL;
+      goto again;
+    }
+
+  plain_buf = malloc(cipher_len > 0 ? cipher_len : 1);
+  if (NULL == plain_buf)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_crypt_decrypt(crypt, first, cipher_buf, cipher_len,
+                           plain_buf, &plain_len, &final);
+  if (DPL_SUCCESS != ret2)
+    {
+      DPL_LOG(ctx, DPL_ERROR, "decryption of %s failed: %s", locator,
+              dpl_status_str(ret2));
+      ret = ret2;
+      goto end;
+    }
+
+  //the last chunk ends the object, a range may end before it
+  if (final)
+    expected_end = first + plain_len;
+  else if (NULL != range && DPL_UNDEF != range->end)
+    expected_end = (range->end / crypt->chunk_size + 1) * crypt->chunk_size;
+  else
+    expected_end = DPL_UNDEF;
+
+  ret2 = check_truncation(ctx, locator, first + plain_len, expected_end);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  //the chunks fetched hold the whole range
+  ret2 = range_bounds(range, first + plain_len, &start, &end);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  off = start - first;
+  len = end - start;
+
+  dpl_crypt_strip(md);
+
+  if (NULL != sysmdp)
+    {
+      sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
+      sysmdp->size = len;
+    }
+
+ deliver:
+
+  ret2 = deliver_data(option, &plain_buf, off, len, buf_len,
+                      data_bufp, data_lenp);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != metadatap)
+    {
+      *metadatap = md;
+      md = NULL;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(cipher_buf);
+  free(plain_buf);
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  dpl_crypt_destroy(crypt);
+
+  return ret;
+}
+
+/*
+ * report the plaintext size and hide the envelope
+ */
+static dpl_status_t
+head_decrypt(dpl_ctx_t *ctx,
+             const char *locator,
+             dpl_dict_t *metadata,
+             dpl_sysmd_t *sysmdp)
+{
+  dpl_crypt_t *crypt = NULL;
+  uint64_t size;
+  dpl_status_t ret;
+
+  ret = dpl_crypt_open(ctx, metadata, &crypt);
+  if (DPL_ENOENT == ret)
+    return DPL_SUCCESS;
+  else if (DPL_SUCCESS != ret)
+    return ret;
+
+  if (NULL != sysmdp && sysmdp->mask & DPL_SYSMD_MASK_SIZE)
+    {
+      if (-1 == dpl_crypt_plain_size(crypt->chunk_size, sysmdp->size, &size))
+        {
+          DPL_LOG(ctx, DPL_ERROR, "%s is truncated", locator);
+          dpl_crypt_destroy(crypt);
+          return DPL_EINTEGRITY;
+        }
+
+      sysmdp->size = size;
+    }
+
+  dpl_crypt_strip(metadata);
+
+  dpl_crypt_destroy(crypt);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+head_with_md(dpl_ctx_t *ctx,
+             head_func_t head_func,
+             const char *bucket,
+             const char *locator,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             dpl_dict_t **metadatap,
+             dpl_sysmd_t *sysmdp)
+{
+  dpl_dict_t *md = NULL;
+  dpl_status_t ret;
+
+  ret = head_func(ctx, bucket, locator, option, object_type, condition,
+                  &md, sysmdp);
+  if (DPL_SUCCESS == ret)
+    ret = head_decrypt(ctx, locator, md, sysmdp);
+
+  if (DPL_SUCCESS == ret && NULL != metadatap)
+    {
+      *metadatap = md;
+      md = NULL;
+    }
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  return ret;
+}
+
+/*
+ * metadata replacing those of an encrypted or compressed object must keep
+ * its envelope and compression metadata, *metadatap is left NULL if there
+ * are none
+ */
+static dpl_status_t
+merge_envelope(const dpl_dict_t *src_md,
+               const dpl_dict_t *metadata,
+               dpl_dict_t **metadatap)
+{
+  dpl_dict_t *md = NULL;
+  dpl_status_t ret, ret2;
+
+  if (NULL == src_md ||
+      (NULL == dpl_dict_get(src_md, DPL_CRYPT_MD_SCHEME) &&
+       NULL == dpl_dict_get(src_md, DPL_COMPRESS_MD_CODEC)))
+    {
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  md = (NULL != metadata) ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+  if (NULL == md)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_crypt_copy_envelope(src_md, md);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = dpl_compress_copy_md(src_md, md);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  *metadatap = md;
+  md = NULL;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  return ret;
+}
+
+static dpl_status_t
+copy_envelope(dpl_ctx_t *ctx,
+              head_func_t head_func,
+              const char *src_bucket,
+              const char *src_locator,
+              const dpl_option_t *option,
+              dpl_ftype_t object_type,
+              const dpl_condition_t *condition,
+              const dpl_dict_t *metadata,
+              dpl_dict_t **metadatap)
+{
+  dpl_dict_t *src_md = NULL;
+  dpl_sysmd_t src_sysmd;
+  dpl_status_t ret, ret2;
+
+  memset(&src_sysmd, 0, sizeof (src_sysmd));
+  ret2 = head_func(ctx, src_bucket, src_locator, option, object_type,
+                   condition, &src_md, &src_sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = merge_envelope(src_md, metadata, metadatap);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != src_md)
+    dpl_dict_free(src_md);
+
+  return ret;
+}
+
+/*
+ * encryption applies to the stored form of the data, compressed or not
+ */
+static dpl_status_t
+put_stored(dpl_ctx_t *ctx,
+           put_func_t put_func,
+           const char *bucket,
+           const char *locator,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition,
+           const dpl_range_t *range,
+           const dpl_dict_t *metadata,
+           const dpl_sysmd_t *sysmd,
+           const char *data_buf,
+           unsigned int data_len)
+{
+  if (crypt_applies(ctx, option, object_type))
+    return put_encrypt(ctx, put_func, bucket, locator, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+
+  return put_func(ctx, bucket, locator, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+}
+
+static dpl_status_t
+get_stored(dpl_ctx_t *ctx,
+           get_func_t get_func,
+           head_func_t head_func,
+           const char *bucket,
+           const char *locator,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition,
+           const dpl_range_t *range,
+           char **data_bufp,
+           unsigned int *data_lenp,
+           dpl_dict_t **metadatap,
+           dpl_sysmd_t *sysmdp)
+{
+  if (crypt_applies(ctx, option, object_type))
+    return get_decrypt(ctx, get_func, head_func, bucket, locator, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+
+  return get_func(ctx, bucket, locator, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+}
+
+static dpl_status_t
+head_stored(dpl_ctx_t *ctx,
+            head_func_t head_func,
+            const char *bucket,
+            const char *locator,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            dpl_dict_t **metadatap,
+            dpl_sysmd_t *sysmdp)
+{
+  if (crypt_applies(ctx, option, object_type))
+    return head_with_md(ctx, head_func, bucket, locator, option, object_type, condition, metadatap, sysmdp);
+
+  return head_func(ctx, bucket, locator, option, object_type, condition, metadatap, sysmdp);
+}
+
+/*
+ * transparent compression (see compress.c) is layered above encryption.
+ * Writes are compressed when enabled, reads always inflate compressed
+ * objects unless DPL_OPTION_NOCOMPRESS is given.
+ */
+static int
+compress_applies(dpl_ctx_t *ctx,
+                 const dpl_option_t *option,
+                 dpl_ftype_t object_type)
+{
+  if (!dpl_compress_enabled(ctx, option))
+    return 0;
+
+  return DPL_FTYPE_REG == object_type || DPL_FTYPE_ANY == object_type ||
+    DPL_FTYPE_UNDEF == object_type;
+}
+
+static int
+decompress_applies(const dpl_option_t *option,
+                   dpl_ftype_t object_type)
+{
+  if (NULL != option && option->mask & DPL_OPTION_NOCOMPRESS)
+    return 0;
+
+  return DPL_FTYPE_REG == object_type || DPL_FTYPE_ANY == object_type ||
+    DPL_FTYPE_UNDEF == object_type;
+}
+
+static dpl_status_t
+put_compress(dpl_ctx_t *ctx,
+             put_func_t put_func,
+             const char *bucket,
+             const char *locator,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             const dpl_range_t *range,
+             const dpl_dict_t *metadata,
+             const dpl_sysmd_t *sysmd,
+             const char *data_buf,
+             unsigned int data_len)
+{
+  dpl_compress_t *comp = NULL;
+  dpl_dict_t *md = NULL;
+  char *stored_buf = NULL;
+  size_t stored_len, index_len;
+  dpl_status_t ret, ret2;
+
+  if (NULL != range)
+    {
+      //chunks cannot be rewritten in place
+      DPL_LOG(ctx, DPL_ERROR, "ranged put of a compressed object");
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  if (!dpl_compress_worthwhile(ctx, data_buf, data_len))
+    goto store;
+
+  comp = dpl_compress_new(ctx);
+  if (NULL == comp)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  //chunks are never stored larger than they are
+  stored_buf = malloc((size_t) data_len +
+                      (data_len / comp->chunk_size + 1) * sizeof (uint32_t) +
+                      DPL_COMPRESS_TRAILER_SIZE);
+  if (NULL == stored_buf)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_compress_deflate(comp, data_buf, data_len, stored_buf, &stored_len);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  index_len = dpl_compress_write_index(comp, stored_buf + stored_len);
+
+  //the samples were misleading
+  if (stored_len + index_len >= data_len)
+    goto store;
+
+  md = (NULL != metadata) ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+  if (NULL == md)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_compress_seal(comp, md, 1);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = put_stored(ctx, put_func, bucket, locator, option, object_type,
+                   condition, NULL, md, sysmd, stored_buf,
+                   stored_len + index_len);
+  goto end;
+
+ store:
+
+  ret = put_stored(ctx, put_func, bucket, locator, option, object_type,
+                   condition, NULL, metadata, sysmd, data_buf, data_len);
+
+ end:
+
+  free(stored_buf);
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  dpl_compress_destroy(comp);
+
+  return ret;
+}
+
+/*
+ * load the chunk index from the end of the stored object, reading the
+ * trailer first if the original size is not in the metadata
+ */
+static dpl_status_t
+fetch_index(dpl_ctx_t *ctx,
+            get_func_t get_func,
+            head_func_t head_func,
+            const char *bucket,
+            const char *locator,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            uint64_t stored_size,
+            dpl_compress_t *comp)
+{
+  dpl_range_t index_range;
+  char *index_buf = NULL;
+  unsigned int index_len;
+  int i;
+  dpl_status_t ret, ret2;
+
+  for (i = 0;i < 2 && NULL == comp->offsets;i++)
+    {
+      ret2 = dpl_compress_index_range(comp, stored_size, &index_range);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      index_len = 0;
+      ret2 = get_stored(ctx, get_func, head_func, bucket, locator, option,
+                        object_type, condition, &index_range,
+                        &index_buf, &index_len, NULL, NULL);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = dpl_compress_load_index(comp, stored_size, index_buf, index_len);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      free(index_buf);
+      index_buf = NULL;
+    }
+
+  ret = NULL != comp->offsets ? DPL_SUCCESS : DPL_EINTEGRITY;
+
+ end:
+
+  free(index_buf);
+
+  return ret;
+}
+
+/*
+ * A whole object is fetched with the request of the caller, and inflated
+ * if compressed.  For a range, or a buffer provided by the caller, the
+ * metadata and stored size come first from a HEAD, as the stored data
+ * does not match the request.  The request is then passed through for an
+ * object which is not compressed, otherwise the chunk index and then the
+ * chunks holding the range are fetched.
+ */
+static dpl_status_t
+get_decompress(dpl_ctx_t *ctx,
+               get_func_t get_func,
+               head_func_t head_func,
+               const char *bucket,
+               const char *locator,
+               const dpl_option_t *option,
+               dpl_ftype_t object_type,
+               const dpl_condition_t *condition,
+               const dpl_range_t *range,
+               char **data_bufp,
+               unsigned int *data_lenp,
+               dpl_dict_t **metadatap,
+               dpl_sysmd_t *sysmdp)
+{
+  dpl_option_t stored_option;
+  dpl_range_t stored_range;
+  dpl_sysmd_t stored_sysmd;
+  char *stored_buf = NULL;
+  char *plain_buf = NULL;
+  unsigned int stored_len = 0, buf_len = 0;
+  uint64_t start, end, expected_len;
+  uint32_t first = 0;
+  size_t plain_len = 0, off = 0;
+  int noalloc;
+  dpl_dict_t *md = NULL;
+  dpl_compress_t *comp = NULL;
+  dpl_status_t ret, ret2;
+
+  //the stored data does not fit in the buffer of the caller
+  if (NULL != option)
+    stored_option = *option;
+  else
+    memset(&stored_option, 0, sizeof (stored_option));
+  stored_option.mask &= ~DPL_OPTION_NOALLOC;
+
+  noalloc = NULL != option && (option->mask & DPL_OPTION_NOALLOC);
+  if (noalloc && NULL != data_lenp)
+    buf_len = *data_lenp;
+
+  memset(&stored_sysmd, 0, sizeof (stored_sysmd));
+
+  if (NULL == range && !noalloc)
+    {
+      ret2 = get_stored(ctx, get_func, head_func, bucket, locator, option,
+                        object_type, condition, NULL, &stored_buf, &stored_len,
+                        &md, &stored_sysmd);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = dpl_compress_open(ctx, md, &comp);
+      if (DPL_ENOENT == ret2)
+        {
+          plain_buf = stored_buf;
+          stored_buf = NULL;
+          start = 0;
+          end = stored_len;
+          goto deliver;
+        }
+      else if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      //the chunk index and the trailer follow the chunks
+      ret2 = dpl_compress_load_index(comp, stored_len, stored_buf, stored_len);
+      if (DPL_SUCCESS == ret2 && NULL == comp->offsets)
+        ret2 = DPL_EINTEGRITY;
+      if (DPL_SUCCESS != ret2)
+        {
+          DPL_LOG(ctx, DPL_ERROR, "chunk index of %s is corrupt", locator);
+          ret = ret2;
+          goto end;
+        }
+
+      stored_len = comp->index_offset;
+    }
+  else
+    {
+      ret2 = head_func(ctx, bucket, locator, option, object_type, condition,
+                       &md, &stored_sysmd);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = dpl_compress_open(ctx, md, &comp);
+      if (DPL_ENOENT == ret2)
+        {
+          dpl_dict_free(md);
+          md = NULL;
+
+          //a range may still be readable from a truncated ciphertext
+          ret = get_stored(ctx, get_func, head_func, bucket, locator, option,
+                           object_type, condition, range, data_bufp, data_lenp,
+                           metadatap, sysmdp);
+          goto end;
+        }
+      else if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      if (crypt_applies(ctx, option, object_type))
+        {
+          ret2 = head_decrypt(ctx, locator, md, &stored_sysmd);
+          if (DPL_SUCCESS != ret2)
+            {
+              ret = ret2;
+              goto end;
+            }
+        }
+
+      if (!(stored_sysmd.mask & DPL_SYSMD_MASK_SIZE))
+        {
+          ret = DPL_ENOTSUPP;
+          goto end;
+        }
+
+      ret2 = fetch_index(ctx, get_func, head_func, bucket, locator,
+                         &stored_option, object_type, condition,
+                         stored_sysmd.size, comp);
+      if (DPL_SUCCESS != ret2)
+        {
+          DPL_LOG(ctx, DPL_ERROR, "chunk index of %s is corrupt", locator);
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  ret2 = range_bounds(range, comp->size, &start, &end);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (start < end)
+    {
+      first = dpl_compress_range(comp, start, end - 1, &stored_range);
+
+      if (NULL == stored_buf)
+        {
+          ret2 = get_stored(ctx, get_func, head_func, bucket, locator, &stored_option,
+                            object_type, condition, &stored_range,
+                            &stored_buf, &stored_len, NULL, NULL);
+          if (DPL_SUCCESS != ret2)
+            {
+              ret = ret2;
+              goto end;
+            }
+        }
+
+      expected_len = MIN(comp->size, ((end - 1) / comp->chunk_size + 1) * comp->chunk_size) -
+        (uint64_t) first * comp->chunk_size;
+
+      plain_buf = malloc(expected_len);
+      if (NULL == plain_buf)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+
+      ret2 = dpl_compress_inflate(comp, first, stored_buf, stored_len,
+                                  plain_buf, &plain_len);
+      if (DPL_SUCCESS != ret2)
+        {
+          DPL_LOG(ctx, DPL_ERROR, "decompression of %s failed: %s", locator,
+                  dpl_status_str(ret2));
+          ret = ret2;
+          goto end;
+        }
+
+      ret2 = check_truncation(ctx, locator, plain_len, expected_len);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      off = start - (uint64_t) first * comp->chunk_size;
+    }
+
+  dpl_compress_strip(md);
+
+  stored_sysmd.mask |= DPL_SYSMD_MASK_SIZE;
+  stored_sysmd.size = comp->size;
+
+ deliver:
+
+  ret2 = deliver_data(option, &plain_buf, off, end - start, buf_len,
+                      data_bufp, data_lenp);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != sysmdp)
+    *sysmdp = stored_sysmd;
+
+  if (NULL != metadatap)
+    {
+      *metadatap = md;
+      md = NULL;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(stored_buf);
+  free(plain_buf);
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  dpl_compress_destroy(comp);
+
+  return ret;
+}
+
+/*
+ * report the original size, from the trailer if it is not in the
+ * metadata, and hide the compression metadata
+ */
+static dpl_status_t
+head_decompress(dpl_ctx_t *ctx,
+                get_func_t get_func,
+                head_func_t head_func,
+                const char *bucket,
+                const char *locator,
+                const dpl_option_t *option,
+                dpl_ftype_t object_type,
+                const dpl_condition_t *condition,
+                dpl_dict_t **metadatap,
+                dpl_sysmd_t *sysmdp)
+{
+  dpl_sysmd_t stored_sysmd;
+  dpl_range_t trailer_range;
+  char *trailer_buf = NULL;
+  unsigned int trailer_len = 0;
+  dpl_dict_t *md = NULL;
+  dpl_compress_t *comp = NULL;
+  dpl_status_t ret;
+
+  memset(&stored_sysmd, 0, sizeof (stored_sysmd));
+  ret = head_stored(ctx, head_func, bucket, locator, option, object_type,
+                    condition, &md, &stored_sysmd);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = dpl_compress_open(ctx, md, &comp);
+  if (DPL_ENOENT == ret)
+    ret = DPL_SUCCESS;
+  else if (DPL_SUCCESS != ret)
+    goto end;
+
+  if (NULL != comp)
+    {
+      if (DPL_UNDEF == comp->size && NULL != sysmdp &&
+          stored_sysmd.mask & DPL_SYSMD_MASK_SIZE)
+        {
+          ret = dpl_compress_index_range(comp, stored_sysmd.size, &trailer_range);
+          if (DPL_SUCCESS != ret)
+            goto end;
+
+          ret = get_stored(ctx, get_func, head_func, bucket, locator, option,
+                           object_type, condition, &trailer_range,
+                           &trailer_buf, &trailer_len, NULL, NULL);
+          if (DPL_SUCCESS != ret)
+            goto end;
+
+          ret = dpl_compress_load_index(comp, stored_sysmd.size,
+                                        trailer_buf, trailer_len);
+          if (DPL_SUCCESS != ret)
+            goto end;
+        }
+
+      if (DPL_UNDEF != comp->size)
+        {
+          stored_sysmd.mask |= DPL_SYSMD_MASK_SIZE;
+          stored_sysmd.size = comp->size;
+        }
+      else
+        {
+          stored_sysmd.mask &= ~DPL_SYSMD_MASK_SIZE;
+        }
+
+      dpl_compress_strip(md);
+    }
+
+  if (NULL != sysmdp)
+    *sysmdp = stored_sysmd;
+
+  if (NULL != metadatap)
+    {
+      *metadatap = md;
+      md = NULL;
+    }
+
+ end:
+
+  free(trailer_buf);
+
+  if (NULL != md)
+    dpl_dict_free(md);
+
+  dpl_compress_destroy(comp);
+
+  return ret;
+}
+
+/** 
+ * return the name of the backend currently used
+ * 
+ * @param ctx 
+ * 
+ * @return the backend name
+ */
+const char *
+dpl_get_backend_name(dpl_ctx_t *ctx)
+{
+  return ctx->backend->name;
+}
+
+/**
+ * @brief get the backend capabilities
+ *
+ * @param ctx droplet context
+ * @param[out] maskp a pointer to @a mask
+ *
+ */
+dpl_status_t
+dpl_get_capabilities(dpl_ctx_t *ctx,
+                     dpl_capability_t *maskp)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "get_capabilities");
+
+  if (NULL == ctx->backend->get_capabilities)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->get_capabilities(ctx, maskp);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+  
+ end:
+  
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+  
+  return ret;
+}
+
+/**
+ * @brief login
+ *
+ * @param ctx droplet context
+ *
+ */
+dpl_status_t
+dpl_login(dpl_ctx_t *ctx)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "login");
+
+  if (NULL == ctx->backend->login)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->login(ctx);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+  
+ end:
+  
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+  
+  return ret;
+}
+
+/**
+ * @brief convert the absolute URI in @a location string to a relative
+ * resource (possibly removing ctx->base_path) and subresource
+ *
+ * @note this function modifies @a location string
+ *
+ * @param ctx droplet context
+ * @param location absolute URI
+ * @param[out] resourcep a pointer to @a location which is the
+ * relative path of the resource.
+ * @param[out] subresourcep a pointer to @a location which is the
+ * query-string without the '?'
+ *
+ */
+static void
+dpl_location_to_resource(dpl_ctx_t *ctx,
+                         char *location,
+                         char **resourcep,
+                         char **subresourcep)
+{
+  char *resource;
+  char *subresource;
+  size_t base_path_len;
+
+  if (0 == strcmp(ctx->base_path, "/"))
+    {
+      resource = location;
+    }
+  else
+    {
+      base_path_len = strlen(ctx->base_path);
+      if (0 == strncmp(location, ctx->base_path, base_path_len))
+        resource = location + base_path_len;
+      else
+        resource = location;
+    }
+
+  subresource = strchr(resource, '?');
+  if (NULL != subresource)
+    {
+      subresource[0] = '\0';
+      ++subresource;
+    }
+
+  if (NULL != resourcep)
+    *resourcep = resource;
+  if (NULL != subresourcep)
+    *subresourcep = subresource;
+}
+
+/**
+ * list all buckets
+ *
+ * @param ctx the droplect context
+ * @param vecp a vector of dpl_bucket_t *
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t 
+dpl_list_all_my_buckets(dpl_ctx_t *ctx,
+                        dpl_vec_t **vecp)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "list_all_my_buckets");
+
+  if (NULL == ctx->backend->list_all_my_buckets)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->list_all_my_buckets(ctx, vecp, NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+  
+ end:
+  
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "REQUEST", "LIST", 0);
+  
+  return ret;
+}
+
+/**
+ * list bucket or directory
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix directory can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param max number of keys we want to get (-1 for no limit)
+ * @param pointer to a dpl_dict_t filled with metadata (to be freed by caller)
+ * @param pointer to a preallocated sysmd to be filled with system metadata
+ * @param objectsp vector of dpl_object_t * (files)
+ * @param prefixesp vector of dpl_common_prefix_t * (directories)
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_list_bucket_attrs(dpl_ctx_t *ctx,
+                      const char *bucket,
+                      const char *prefix,
+                      const char *delimiter,
+                      const int max_keys,
+                      dpl_dict_t **metadatap,
+                      dpl_sysmd_t *sysmdp,
+                      dpl_vec_t **objectsp,
+                      dpl_vec_t **common_prefixesp)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "list_bucket bucket=%s prefix=%s delimiter=%s", bucket, prefix, delimiter);
+
+  if (NULL == ctx->backend->list_bucket)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->list_bucket_attrs(ctx,
+                                         bucket,
+                                         prefix,
+                                         delimiter,
+                                         max_keys,
+                                         metadatap,
+                                         sysmdp,
+                                         objectsp,
+                                         common_prefixesp,
+                                         NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+  
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "REQUEST", "LIST", 0);
+  
+  return ret;
+}
+
+/**
+ * list bucket or directory
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix directory can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param max number of keys we want to get (-1 for no limit)
+ * @param objectsp vector of dpl_object_t * (files)
+ * @param prefixesp vector of dpl_common_prefix_t * (directories)
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_list_bucket(dpl_ctx_t *ctx,
+                const char *bucket,
+                const char *prefix,
+                const char *delimiter,
+                const int max_keys,
+                dpl_vec_t **objectsp,
+                dpl_vec_t **common_prefixesp)
+{
+  return dpl_list_bucket_attrs(ctx,
+                               bucket,
+                               prefix,
+                               delimiter,
+                               max_keys,
+                               NULL,
+                               NULL,
+                               objectsp,
+                               common_prefixesp);
+}
+
+/**
+ * list one page of a bucket or directory
+ *
+ * backends which cannot resume a listing return everything in the
+ * first page.
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix directory can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param max_keys page size, -1 lets the backend choose
+ * @param marker NULL for the first page, else the *next_markerp of the previous call
+ * @param objectsp vector of dpl_object_t * (files)
+ * @param common_prefixesp vector of dpl_common_prefix_t * (directories)
+ * @param next_markerp marker of the next page (to be freed by caller), NULL after the last one
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_list_bucket_page(dpl_ctx_t *ctx,
+                     const char *bucket,
+                     const char *prefix,
+                     const char *delimiter,
+                     const int max_keys,
+                     const char *marker,
+                     dpl_vec_t **objectsp,
+                     dpl_vec_t **common_prefixesp,
+                     char **next_markerp)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "list_bucket_page bucket=%s prefix=%s delimiter=%s marker=%s", bucket, prefix, delimiter, marker);
+
+  *next_markerp = NULL;
+
+  if (NULL == ctx->backend->list_bucket_page)
+    {
+      if (NULL != marker)
+        {
+          ret = DPL_ENOTSUPP;
+          goto end;
+        }
+
+      ret = dpl_list_bucket(ctx, bucket, prefix, delimiter, max_keys,
+                            objectsp, common_prefixesp);
+      goto end;
+    }
+
+  ret2 = ctx->backend->list_bucket_page(ctx,
+                                        bucket,
+                                        prefix,
+                                        delimiter,
+                                        max_keys,
+                                        marker,
+                                        objectsp,
+                                        common_prefixesp,
+                                        next_markerp,
+                                        NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  dpl_log_request(ctx, "REQUEST", "LIST", 0);
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * drop the entries of a listing which are not after start_after or not
+ * before end_before, *cutp is set if any of the latter was seen
+ */
+static void
+list_vec_trim(dpl_vec_t *vec,
+              int objects,
+              const char *start_after,
+              const char *end_before,
+              int *cutp)
+{
+  int i, j;
+  const char *name;
+
+  for (i = 0, j = 0;i < vec->n_items;i++)
+    {
+      if (objects)
+        name = ((dpl_object_t *) dpl_vec_get(vec, i))->path;
+      else
+        name = ((dpl_common_prefix_t *) dpl_vec_get(vec, i))->prefix;
+
+      if ((NULL == start_after || strcmp(name, start_after) > 0) &&
+          (NULL == end_before || strcmp(name, end_before) < 0))
+        {
+          vec->items[j++] = vec->items[i];
+          continue ;
+        }
+
+      if (NULL != end_before && strcmp(name, end_before) >= 0)
+        *cutp = 1;
+
+      if (objects)
+        dpl_object_free((dpl_object_t *) dpl_vec_get(vec, i));
+      else
+        dpl_common_prefix_free((dpl_common_prefix_t *) dpl_vec_get(vec, i));
+      dpl_value_free(vec->items[i]);
+    }
+
+  vec->n_items = j;
+}
+
+/**
+ * list one page of a bucket or directory, S3 ListObjectsV2 style
+ *
+ * backends without native support resume from start_after with
+ * markers, or filter a full listing if they cannot resume at all.
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix directory can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param max_keys page size, -1 lets the backend choose
+ * @param start_after only list the keys after this one, may be NULL
+ * @param token NULL for the first page, else the *next_tokenp of the previous call
+ * @param fetch_owner fill the owner of the objects if the backend can
+ * @param objectsp vector of dpl_object_t * (files)
+ * @param common_prefixesp vector of dpl_common_prefix_t * (directories)
+ * @param next_tokenp token of the next page (to be freed by caller), NULL after the last one
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_list_bucket_v2(dpl_ctx_t *ctx,
+                   const char *bucket,
+                   const char *prefix,
+                   const char *delimiter,
+                   const int max_keys,
+                   const char *start_after,
+                   const char *token,
+                   int fetch_owner,
+                   dpl_vec_t **objectsp,
+                   dpl_vec_t **common_prefixesp,
+                   char **next_tokenp)
+{
+  dpl_status_t ret, ret2;
+  dpl_vec_t *objects = NULL;
+  dpl_vec_t *common_prefixes = NULL;
+  int cut = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "list_bucket_v2 bucket=%s prefix=%s delimiter=%s start_after=%s token=%s", bucket, prefix, delimiter, start_after, token);
+
+  *next_tokenp = NULL;
+
+  if (NULL != ctx->backend->list_bucket_v2)
+    {
+      ret2 = ctx->backend->list_bucket_v2(ctx, bucket, prefix, delimiter, max_keys,
+                                          start_after, token, fetch_owner,
+                                          objectsp, common_prefixesp,
+                                          next_tokenp, NULL);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      dpl_log_request(ctx, "REQUEST", "LIST", 0);
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  if (NULL != ctx->backend->list_bucket_page)
+    {
+      //markers are keys there
+      ret = dpl_list_bucket_page(ctx, bucket, prefix, delimiter, max_keys,
+                                 NULL != token ? token : start_after,
+                                 objectsp, common_prefixesp, next_tokenp);
+      goto end;
+    }
+
+  if (NULL != token)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  ret2 = dpl_list_bucket(ctx, bucket, prefix, delimiter, -1, &objects, &common_prefixes);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != start_after)
+    {
+      list_vec_trim(objects, 1, start_after, NULL, &cut);
+      list_vec_trim(common_prefixes, 0, start_after, NULL, &cut);
+    }
+
+  if (NULL != objectsp)
+    {
+      *objectsp = objects;
+      objects = NULL; //consume it
+    }
+
+  if (NULL != common_prefixesp)
+    {
+      *common_prefixesp = common_prefixes;
+      common_prefixes = NULL; //consume it
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != objects)
+    dpl_vec_objects_free(objects);
+
+  if (NULL != common_prefixes)
+    dpl_vec_common_prefixes_free(common_prefixes);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * listing cursor
+ */
+
+struct dpl_list_cursor
+{
+  dpl_ctx_t *ctx;
+  char *bucket;
+  char *prefix;
+  char *delimiter;
+  char *start_after;
+  char *end_before;
+  char *token;                  /*!< of the next page */
+  int fetch_owner;
+  int done;
+};
+
+void
+dpl_list_cursor_free(dpl_list_cursor_t *cursor)
+{
+  free(cursor->bucket);
+  free(cursor->prefix);
+  free(cursor->delimiter);
+  free(cursor->start_after);
+  free(cursor->end_before);
+  free(cursor->token);
+  free(cursor);
+}
+
+static int
+list_cursor_strdup(char **dstp,
+                   const char *src)
+{
+  if (NULL == src)
+    return 0;
+
+  *dstp = strdup(src);
+
+  return NULL == *dstp ? -1 : 0;
+}
+
+/**
+ * create a cursor iterating over a listing page by page
+ *
+ * The listing may be restricted to a key range, so that a large bucket
+ * can be scanned by several workers, each one with its own range, e.g.
+ * [NULL, "m") and ["m", NULL).  An interrupted scan is resumed by
+ * creating a cursor with the same parameters and the last token
+ * returned by dpl_list_cursor_token().
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param prefix can be NULL
+ * @param delimiter e.g. "/" can be NULL
+ * @param start_after only list the names after this one, may be NULL
+ * @param end_before only list the names before this one, may be NULL
+ * @param token resume from there, may be NULL
+ * @param fetch_owner fill the owner of the objects if the backend can
+ *
+ * @return the cursor or NULL
+ */
+dpl_list_cursor_t *
+dpl_list_cursor_new(dpl_ctx_t *ctx,
+                    const char *bucket,
+                    const char *prefix,
+                    const char *delimiter,
+                    const char *start_after,
+                    const char *end_before,
+                    const char *token,
+                    int fetch_owner)
+{
+  dpl_list_cursor_t *cursor;
+
+  cursor = calloc(1, sizeof (*cursor));
+  if (NULL == cursor)
+    return NULL;
+
+  cursor->ctx = ctx;
+  cursor->fetch_owner = fetch_owner;
+
+  if (-1 == list_cursor_strdup(&cursor->bucket, bucket) ||
+      -1 == list_cursor_strdup(&cursor->prefix, prefix) ||
+      -1 == list_cursor_strdup(&cursor->delimiter, delimiter) ||
+      -1 == list_cursor_strdup(&cursor->start_after, start_after) ||
+      -1 == list_cursor_strdup(&cursor->end_before, end_before) ||
+      -1 == list_cursor_strdup(&cursor->token, token))
+    {
+      dpl_list_cursor_free(cursor);
+      return NULL;
+    }
+
+  return cursor;
+}
+
+/**
+ * fetch the next page of a cursor
+ *
+ * a page may be empty while the cursor is not done yet.
+ *
+ * @param cursor
+ * @param max_keys page size, -1 lets the backend choose
+ * @param objectsp vector of dpl_object_t * (files)
+ * @param common_prefixesp vector of dpl_common_prefix_t * (directories)
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOENT if the cursor is done
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_list_cursor_next(dpl_list_cursor_t *cursor,
+                     const int max_keys,
+                     dpl_vec_t **objectsp,
+                     dpl_vec_t **common_prefixesp)
+{
+  dpl_ctx_t *ctx = cursor->ctx;
+  dpl_status_t ret, ret2;
+  dpl_vec_t *objects = NULL;
+  dpl_vec_t *common_prefixes = NULL;
+  char *next_token = NULL;
+  int cut = 0;
+
+  if (cursor->done)
+    {
+      ret = DPL_ENOENT;
+      goto end;
+    }
+
+  ret2 = dpl_list_bucket_v2(ctx, cursor->bucket, cursor->prefix, cursor->delimiter,
+                            max_keys, cursor->start_after, cursor->token,
+                            cursor->fetch_owner, &objects, &common_prefixes,
+                            &next_token);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != cursor->end_before)
+    {
+      list_vec_trim(objects, 1, NULL, cursor->end_before, &cut);
+      list_vec_trim(common_prefixes, 0, NULL, cursor->end_before, &cut);
+    }
+
+  free(cursor->token);
+  cursor->token = next_token;
+  next_token = NULL;
+
+  if (cut || NULL == cursor->token)
+    {
+      free(cursor->token);
+      cursor->token = NULL;
+      cursor->done = 1;
+    }
+
+  if (NULL != objectsp)
+    {
+      *objectsp = objects;
+      objects = NULL; //consume it
+    }
+
+  if (NULL != common_prefixesp)
+    {
+      *common_prefixesp = common_prefixes;
+      common_prefixes = NULL; //consume it
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != objects)
+    dpl_vec_objects_free(objects);
+
+  if (NULL != common_prefixes)
+    dpl_vec_common_prefixes_free(common_prefixes);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
+}
+
+/**
+ * @return 1 once the last page was returned
+ */
+int
+dpl_list_cursor_done(const dpl_list_cursor_t *cursor)
+{
+  return cursor->done;
+}
+
+/**
+ * the token from which to resume after the last page returned, to be
+ * given to dpl_list_cursor_new(), NULL if the cursor is done or was
+ * just created without token
+ */
+const char *
+dpl_list_cursor_token(const dpl_list_cursor_t *cursor)
+{
+  return cursor->token;
+}
+
+/**
+ * make a bucket
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param location_constraint geographic location
+ * @param canned_acl simplified ACL
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_make_bucket(dpl_ctx_t *ctx,
+                const char *bucket, 
+                dpl_location_constraint_t location_constraint,
+                dpl_canned_acl_t canned_acl)
+{
+  dpl_status_t ret, ret2;
+  dpl_sysmd_t sysmd;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "makebucket bucket=%s", bucket);
+
+  if (NULL == ctx->backend->make_bucket)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  memset(&sysmd, 0, sizeof (sysmd));
+  sysmd.mask = DPL_SYSMD_MASK_CANNED_ACL|DPL_SYSMD_MASK_LOCATION_CONSTRAINT;
+  sysmd.canned_acl = canned_acl;
+  sysmd.location_constraint = location_constraint;
+
+  ret2 = ctx->backend->make_bucket(ctx, bucket, &sysmd, NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "PUT", 0);
+  
+  return ret;
+}
+
+/**
+ * delete a path
+ *
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t 
+dpl_delete_bucket(dpl_ctx_t *ctx,
+                  const char *bucket)
+{
+  dpl_status_t ret, ret2;
+  
+  DPL_TRACE(ctx, DPL_TRACE_REST, "delete_bucket bucket=%s", bucket);
+
+  if (NULL == ctx->backend->delete_bucket)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->delete_bucket(ctx, bucket, NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "DELETE", 0);
+  
+  return ret;
+}
+
+/** 
+ * create or post data into a path
+ *
+ * @note this function is expected to return a newly created object
+ * 
+ * @param ctx the droplet context
+ * @param bucket can be NULL
+ * @param path can be NULL
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_REG create a file
+ * @param metadata the user metadata. optional
+ * @param sysmd the system metadata. optional
+ * @param data_buf the data buffer
+ * @param data_len the data length
+ * @param query_params can be NULL
+ * @param returned_sysmdp the returned system metadata passed through stack
+ * 
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_post(dpl_ctx_t *ctx,
+         const char *bucket,
+         const char *path,
+         const dpl_option_t *option,
+         dpl_ftype_t object_type,
+         const dpl_condition_t *condition,
+         const dpl_range_t *range,
+         const dpl_dict_t *metadata,
+         const dpl_sysmd_t *sysmd,
+         const char *data_buf,
+         unsigned int data_len,
+         const dpl_dict_t *query_params,
+         dpl_sysmd_t *returned_sysmdp)
+{
+  dpl_status_t ret, ret2;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "put bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->post)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  ret2 = ctx->backend->post(ctx, bucket, path, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, query_params, returned_sysmdp, NULL);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "IN", data_len);
+  
+  return ret;
+}
+
+/*
+ * dpl_put() without compression or client-side encryption
+ */
+static dpl_status_t
+put_plain(dpl_ctx_t *ctx,
+          const char *bucket,
+          const char *path,
+          const dpl_option_t *option,
+          dpl_ftype_t object_type,
+          const dpl_condition_t *condition,
+          const dpl_range_t *range,
+          const dpl_dict_t *metadata,
+          const dpl_sysmd_t *sysmd,
+          const char *data_buf,
+          unsigned int data_len)
+{
+  dpl_status_t ret, ret2;
+  int attempt = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "put bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->put)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  do
+    {
+      ret2 = ctx->backend->put(ctx, bucket, path, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, NULL, NULL, NULL);
+    }
+  while (is_idempotent_write(condition) && dpl_retry_again(ctx, ret2, &attempt));
+
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "IN", data_len);
+  
+  return ret;
+}
+
+/**
+ * put a path
+ *
+ * @param ctx the droplet context
+ * @param bucket optional
+ * @param path mandatory
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_REG create a file
+ * @param object_type DPL_FTYPE_DIR create a directory
+ * @param condition the optional condition
+ * @param range optional range
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
+ * @param data_buf the data buffer
+ * @param data_len the data length
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_EEXIST
+ */
+dpl_status_t
+dpl_put(dpl_ctx_t *ctx,
+        const char *bucket,
+        const char *path,
+        const dpl_option_t *option,
+        dpl_ftype_t object_type,
+        const dpl_condition_t *condition,
+        const dpl_range_t *range,
+        const dpl_dict_t *metadata,
+        const dpl_sysmd_t *sysmd,
+        const char *data_buf,
+        unsigned int data_len)
+{
+  if (compress_applies(ctx, option, object_type))
+    return put_compress(ctx, put_plain, bucket, path, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+
+  return put_stored(ctx, put_plain, bucket, path, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+}
+
+/*
+ * dpl_get() without compression or client-side encryption
+ */
+static dpl_status_t
+get_plain(dpl_ctx_t *ctx,
+          const char *bucket,
+          const char *path,
+          const dpl_option_t *option,
+          dpl_ftype_t object_type,
+          const dpl_condition_t *condition,
+          const dpl_range_t *range, 
+          char **data_bufp,
+          unsigned int *data_lenp,
+          dpl_dict_t **metadatap,
+          dpl_sysmd_t *sysmdp)
+{
+  dpl_status_t ret, ret2;
+  u_int data_len;
+  char *new_location = NULL;
+  char *new_location_resource;
+  char *new_location_subresource;
+  int attempt = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "get bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->get)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  do
+    {
+      if (NULL != data_lenp)
+        data_len = *data_lenp;
+
+      new_location = NULL;
+      ret2 = dpl_hedge_get(ctx, ctx->backend->get, bucket, path, NULL, option, object_type, condition, range, data_bufp, &data_len, metadatap, sysmdp, &new_location);
+
+      if (DPL_EREDIRECT == ret2)
+        {
+          dpl_location_to_resource(ctx,
+                                   new_location,
+                                   &new_location_resource,
+                                   &new_location_subresource);
+
+          if (NULL != data_lenp)
+            data_len = *data_lenp;
+
+          ret2 = ctx->backend->get(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, range, data_bufp, &data_len, metadatap, sysmdp, NULL);
+
+          free(new_location);
+        }
+    }
+  while (dpl_retry_again(ctx, ret2, &attempt));
+
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  if (NULL != data_lenp)
+    *data_lenp = data_len;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "OUT", data_len);
+  
+  return ret;
+}
+
 /** 
- * return the name of the backend currently used
+ * get a path with range
+ * 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_ANY get any type of path
+ * @param condition the optional condition
+ * @param range the optional range
+ * @param data_bufp the returned data buffer client shall free
+ * @param data_lenp the returned data length
+ * @param metadatap the returned user metadata client shall free
+ * @param sysmdp the returned system metadata passed through stack
+ * 
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT path does not exist
+ * @return DPL_EINTEGRITY encrypted or compressed data is corrupt
+ */
+dpl_status_t
+dpl_get(dpl_ctx_t *ctx,
+        const char *bucket,
+        const char *path,
+        const dpl_option_t *option,
+        dpl_ftype_t object_type,
+        const dpl_condition_t *condition,
+        const dpl_range_t *range, 
+        char **data_bufp,
+        unsigned int *data_lenp,
+        dpl_dict_t **metadatap,
+        dpl_sysmd_t *sysmdp)
+{
+  if (decompress_applies(option, object_type))
+    return get_decompress(ctx, get_plain, head_plain, bucket, path, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+
+  return get_stored(ctx, get_plain, head_plain, bucket, path, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+}
+
+/** 
+ * get a path for SYMLINKS
+ *
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_ANY get any type of path
+ * @param condition the optional condition
+ * @param data_bufp the returned data buffer client shall free
+ * @param data_lenp the returned data length
+ * @param metadatap the returned user metadata client shall free
+ * @param sysmdp the returned system metadata passed through stack
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT path does not exist
+ */
+dpl_status_t
+dpl_get_noredirect(dpl_ctx_t *ctx,
+                   const char *bucket,
+                   const char *path,
+                   dpl_ftype_t object_type,
+                   char **locationp)
+{
+  dpl_status_t ret, ret2;
+  int loclen = 0;
+  char *new_location = NULL;
+  char *new_location_resource = NULL;
+  char *new_location_subresource = NULL;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "get bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->get)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  ret2 = ctx->backend->get(ctx, bucket, path, NULL, NULL, object_type,
+                           NULL, NULL, NULL, NULL, NULL, NULL, &new_location);
+  if (DPL_EREDIRECT != ret2)
+    {
+      if (ret2 == DPL_SUCCESS)
+        {
+          ret = DPL_ENOTSUPP;
+          goto end;
+        }
+      ret = ret2;
+      goto end;
+    }
+
+  dpl_location_to_resource(ctx,
+                           new_location,
+                           &new_location_resource,
+                           &new_location_subresource);
+  loclen = strlen(new_location_resource);
+  if (NULL != locationp)
+    {
+      *locationp = strdup(new_location_resource);
+      if (NULL == *locationp)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+  if (new_location)
+    free(new_location);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "LINKDATA", "OUT", loclen);
+
+  return ret;
+}
+
+/*
+ * dpl_head() without compression or client-side encryption
+ */
+static dpl_status_t
+head_plain(dpl_ctx_t *ctx,
+           const char *bucket,
+           const char *path,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition,
+           dpl_dict_t **metadatap,
+           dpl_sysmd_t *sysmdp)
+{
+  dpl_status_t ret, ret2;
+  char *new_location = NULL;
+  char *new_location_resource;
+  char *new_location_subresource;
+  int attempt = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "head bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->head)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+  
+  do
+    {
+      new_location = NULL;
+      ret2 = dpl_hedge_head(ctx, ctx->backend->head, bucket, path, NULL, option, object_type, condition, metadatap, sysmdp, &new_location);
+
+      if (DPL_EREDIRECT == ret2)
+        {
+          dpl_location_to_resource(ctx,
+                                   new_location,
+                                   &new_location_resource,
+                                   &new_location_subresource);
+
+          ret2 = ctx->backend->head(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, metadatap, sysmdp, NULL);
+
+          free(new_location);
+        }
+    }
+  while (dpl_retry_again(ctx, ret2, &attempt));
+
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "GET", 0);
+  
+  return ret;
+}
+
+/**
+ * get user and system metadata
  * 
- * @param ctx 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type DPL_FTYPE_ANY get any type of path
+ * @param condition the optional condition
+ * @param metadatap the returned user metadata client shall free
+ * @param sysmdp the returned system metadata passed through stack
  * 
- * @return the backend name
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT path does not exist
  */
-const char *
-dpl_get_backend_name(dpl_ctx_t *ctx)
+dpl_status_t
+dpl_head(dpl_ctx_t *ctx,
+         const char *bucket,
+         const char *path,
+         const dpl_option_t *option,
+         dpl_ftype_t object_type,
+         const dpl_condition_t *condition,
+         dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp)
 {
-  return ctx->backend->name;
+  if (decompress_applies(option, object_type))
+    return head_decompress(ctx, get_plain, head_plain, bucket, path, option, object_type, condition, metadatap, sysmdp);
+
+  return head_stored(ctx, head_plain, bucket, path, option, object_type, condition, metadatap, sysmdp);
 }
 
-/**
- * @brief get the backend capabilities
- *
- * @param ctx droplet context
- * @param[out] maskp a pointer to @a mask
- *
+/** 
+ * get raw metadata
+ * 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param condition the optional condition
+ * @param metadatap the returned metadata client shall free
+ * 
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT
  */
 dpl_status_t
-dpl_get_capabilities(dpl_ctx_t *ctx,
-                     dpl_capability_t *maskp)
+dpl_head_raw(dpl_ctx_t *ctx,
+             const char *bucket,
+             const char *path,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             dpl_dict_t **metadatap)
 {
   dpl_status_t ret, ret2;
+  char *new_location = NULL;
+  char *new_location_resource;
+  char *new_location_subresource;
+  int attempt = 0;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "get_capabilities");
+  DPL_TRACE(ctx, DPL_TRACE_REST, "head_raw bucket=%s path=%s", bucket, path);
 
-  if (NULL == ctx->backend->get_capabilities)
+  if (NULL == ctx->backend->head_raw)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
   
-  ret2 = ctx->backend->get_capabilities(ctx, maskp);
+  do
+    {
+      new_location = NULL;
+      ret2 = ctx->backend->head_raw(ctx, bucket, path, NULL, option, object_type, condition, metadatap, &new_location);
+
+      if (DPL_EREDIRECT == ret2)
+        {
+          dpl_location_to_resource(ctx,
+                                   new_location,
+                                   &new_location_resource,
+                                   &new_location_subresource);
+
+          ret2 = ctx->backend->head_raw(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, metadatap, NULL);
+
+          free(new_location);
+        }
+    }
+  while (dpl_retry_again(ctx, ret2, &attempt));
+
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -95,123 +2581,333 @@ dpl_get_capabilities(dpl_ctx_t *ctx,
     }
   
   ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "GET", 0);
+  
+  return ret;
+}
+
+/** 
+ * delete a path
+ * 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param condition the optional condition
+ * 
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOENT path does not exist
+ */
+dpl_status_t
+dpl_delete(dpl_ctx_t *ctx,
+           const char *bucket,
+           const char *path,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition)
+{
+  dpl_status_t ret, ret2;
+  int attempt = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "delete bucket=%s path=%s", bucket, path);
+
+  if (NULL == ctx->backend->deletef)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
   
+  do
+    {
+      ret2 = ctx->backend->deletef(ctx, bucket, path, NULL, option, object_type, condition, NULL);
+    }
+  while (is_idempotent_write(condition) && dpl_retry_again(ctx, ret2, &attempt));
+
+  //the attempt which failed may have deleted it
+  if (DPL_ENOENT == ret2 && attempt > 0)
+    ret2 = DPL_SUCCESS;
+
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
  end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "DELETE", 0);
+  
+  return ret;
+}
+
+/**
+ * delete multiple path
+ * 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type
+ * @param condition the optional condition
+ *
+ * @return DPL_ENOTSUPP
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_delete_all(dpl_ctx_t *ctx,
+               const char *bucket,
+               dpl_locators_t *locators,
+               const dpl_option_t *option,
+               const dpl_condition_t *condition,
+               dpl_vec_t **objectsp)
+{
+  dpl_status_t  ret;
+
+  if (ctx->backend->delete_all == NULL) {
+    ret = DPL_ENOTSUPP;
+    goto end;
+  }
   
+  ret = ctx->backend->delete_all(ctx, bucket, locators, option, condition, objectsp);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "DELETE", 0);
   
   return ret;
 }
 
 /**
- * @brief login
+ * delete multiple id
+ * 
+ * @param ctx the droplet context
+ * @param bucket the optional bucket
+ * @param ressource path of ID (ex: /proxy/arc) for REST backend
+ * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
+ * @param object_type
+ * @param condition the optional condition
  *
- * @param ctx droplet context
+ * @return DPL_ENOTSUPP
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_delete_all_id(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *ressource,
+                  dpl_locators_t *locators,
+                  const dpl_option_t *option,
+                  const dpl_condition_t *condition,
+                  dpl_vec_t **objectsp)
+{
+  dpl_status_t  ret;
+
+  if (ctx->backend->delete_all_id == NULL) {
+    ret = DPL_ENOTSUPP;
+    goto end;
+  }
+  
+  ret = ctx->backend->delete_all_id(ctx, bucket, ressource, locators, option, condition, objectsp);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "DELETE", 0);
+  
+  return ret;
+}
+
+/** 
+ * create or post data into a path
  *
+ * @note this function is expected to return a newly created object
+ * 
+ * @param ctx 
+ * @param bucket 
+ * @param path can be NULL
+ * @param object_type 
+ * @param metadata 
+ * @param canned_acl 
+ * @param data_buf 
+ * @param data_len 
+ * @param query_params can be NULL
+ * @param returned_sysmdp
+ * 
+ * @return 
  */
 dpl_status_t
-dpl_login(dpl_ctx_t *ctx)
+dpl_post_id(dpl_ctx_t *ctx,
+            const char *bucket,
+            const char *id,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            const dpl_range_t *range,
+            const dpl_dict_t *metadata,
+            const dpl_sysmd_t *sysmd,
+            const char *data_buf,
+            unsigned int data_len,
+            const dpl_dict_t *query_params,
+            dpl_sysmd_t *returned_sysmdp)
 {
   dpl_status_t ret, ret2;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "login");
+  DPL_TRACE(ctx, DPL_TRACE_ID, "post_id bucket=%s", bucket);
 
-  if (NULL == ctx->backend->login)
+  if (NULL == ctx->backend->post_id)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
   
-  ret2 = ctx->backend->login(ctx);
+  ret2 = ctx->backend->post_id(ctx, bucket, id, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, query_params, returned_sysmdp, NULL);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
-  
+
   ret = DPL_SUCCESS;
   
  end:
-  
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-  
+
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
+
   return ret;
 }
 
-/**
- * @brief convert the absolute URI in @a location string to a relative
- * resource (possibly removing ctx->base_path) and subresource
- *
- * @note this function modifies @a location string
- *
- * @param ctx droplet context
- * @param location absolute URI
- * @param[out] resourcep a pointer to @a location which is the
- * relative path of the resource.
- * @param[out] subresourcep a pointer to @a location which is the
- * query-string without the '?'
- *
+/*
+ * dpl_put_id() without compression or client-side encryption
  */
-static void
-dpl_location_to_resource(dpl_ctx_t *ctx,
-                         char *location,
-                         char **resourcep,
-                         char **subresourcep)
+static dpl_status_t
+put_id_plain(dpl_ctx_t *ctx,
+             const char *bucket,
+             const char *id,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             const dpl_range_t *range,
+             const dpl_dict_t *metadata,
+             const dpl_sysmd_t *sysmd,
+             const char *data_buf,
+             unsigned int data_len)
 {
-  char *resource;
-  char *subresource;
-  size_t base_path_len;
+  dpl_status_t ret, ret2;
+  int attempt = 0;
 
-  if (0 == strcmp(ctx->base_path, "/"))
+  DPL_TRACE(ctx, DPL_TRACE_ID, "put_id bucket=%s id=%s", bucket, id);
+
+  if (NULL == ctx->backend->put_id)
     {
-      resource = location;
+      ret = DPL_ENOTSUPP;
+      goto end;
     }
-  else
+
+  do
     {
-      base_path_len = strlen(ctx->base_path);
-      if (0 == strncmp(location, ctx->base_path, base_path_len))
-        resource = location + base_path_len;
-      else
-        resource = location;
+      ret2 = ctx->backend->put_id(ctx, bucket, id, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, NULL, NULL, NULL);
     }
+  while (is_idempotent_write(condition) && dpl_retry_again(ctx, ret2, &attempt));
 
-  subresource = strchr(resource, '?');
-  if (NULL != subresource)
+  if (DPL_SUCCESS != ret2)
     {
-      subresource[0] = '\0';
-      ++subresource;
+      ret = ret2;
+      goto end;
     }
+  
+  ret = DPL_SUCCESS;
 
-  if (NULL != resourcep)
-    *resourcep = resource;
-  if (NULL != subresourcep)
-    *subresourcep = subresource;
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
+  
+  return ret;
 }
 
-/**
- * list all buckets
- *
- * @param ctx the droplect context
- * @param vecp a vector of dpl_bucket_t *
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
+dpl_status_t
+dpl_put_id(dpl_ctx_t *ctx,
+           const char *bucket,
+           const char *id,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition,
+           const dpl_range_t *range,
+           const dpl_dict_t *metadata,
+           const dpl_sysmd_t *sysmd,
+           const char *data_buf,
+           unsigned int data_len)
+{
+  if (compress_applies(ctx, option, object_type))
+    return put_compress(ctx, put_id_plain, bucket, id, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+
+  return put_stored(ctx, put_id_plain, bucket, id, option, object_type, condition, range, metadata, sysmd, data_buf, data_len);
+}
+
+/*
+ * dpl_get_id() without compression or client-side encryption
  */
-dpl_status_t 
-dpl_list_all_my_buckets(dpl_ctx_t *ctx,
-                        dpl_vec_t **vecp)
+static dpl_status_t
+get_id_plain(dpl_ctx_t *ctx,
+             const char *bucket,
+             const char *id,
+             const dpl_option_t *option,
+             dpl_ftype_t object_type,
+             const dpl_condition_t *condition,
+             const dpl_range_t *range,
+             char **data_bufp,
+             unsigned int *data_lenp,
+             dpl_dict_t **metadatap,
+             dpl_sysmd_t *sysmdp)
 {
   dpl_status_t ret, ret2;
+  unsigned int data_len = 0;
+  int attempt = 0;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "list_all_my_buckets");
+  DPL_TRACE(ctx, DPL_TRACE_ID, "get_id bucket=%s id=%s", bucket, id);
 
-  if (NULL == ctx->backend->list_all_my_buckets)
+  if (NULL == ctx->backend->get_id)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->list_all_my_buckets(ctx, vecp, NULL);
+
+  if (NULL != data_lenp)
+    data_len = *data_lenp;
+
+  do
+    {
+      if (NULL != data_lenp)
+        *data_lenp = data_len;
+
+      ret2 = dpl_hedge_get(ctx, ctx->backend->get_id, bucket, id, NULL, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp, NULL);
+    }
+  while (dpl_retry_again(ctx, ret2, &attempt));
+
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -219,150 +2915,114 @@ dpl_list_all_my_buckets(dpl_ctx_t *ctx,
     }
   
   ret = DPL_SUCCESS;
-  
+
  end:
-  
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "REQUEST", "LIST", 0);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
   
   return ret;
 }
 
-/**
- * list bucket or directory
- *
- * @param ctx the droplet context
- * @param bucket can be NULL
- * @param prefix directory can be NULL
- * @param delimiter e.g. "/" can be NULL
- * @param max number of keys we want to get (-1 for no limit)
- * @param pointer to a dpl_dict_t filled with metadata (to be freed by caller)
- * @param pointer to a preallocated sysmd to be filled with system metadata
- * @param objectsp vector of dpl_object_t * (files)
- * @param prefixesp vector of dpl_common_prefix_t * (directories)
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- */
 dpl_status_t
-dpl_list_bucket_attrs(dpl_ctx_t *ctx,
-                      const char *bucket,
-                      const char *prefix,
-                      const char *delimiter,
-                      const int max_keys,
-                      dpl_dict_t **metadatap,
-                      dpl_sysmd_t *sysmdp,
-                      dpl_vec_t **objectsp,
-                      dpl_vec_t **common_prefixesp)
+dpl_get_id(dpl_ctx_t *ctx,
+           const char *bucket,
+           const char *id,
+           const dpl_option_t *option,
+           dpl_ftype_t object_type,
+           const dpl_condition_t *condition,
+           const dpl_range_t *range,
+           char **data_bufp,
+           unsigned int *data_lenp,
+           dpl_dict_t **metadatap,
+           dpl_sysmd_t *sysmdp)
+{
+  if (decompress_applies(option, object_type))
+    return get_decompress(ctx, get_id_plain, head_id_plain, bucket, id, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+
+  return get_stored(ctx, get_id_plain, head_id_plain, bucket, id, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp);
+}
+
+/*
+ * dpl_head_id() without compression or client-side encryption
+ */
+static dpl_status_t
+head_id_plain(dpl_ctx_t *ctx,
+              const char *bucket,
+              const char *id,
+              const dpl_option_t *option,
+              dpl_ftype_t object_type,
+              const dpl_condition_t *condition,
+              dpl_dict_t **metadatap,
+              dpl_sysmd_t *sysmdp)
 {
   dpl_status_t ret, ret2;
+  int attempt = 0;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "list_bucket bucket=%s prefix=%s delimiter=%s", bucket, prefix, delimiter);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "head_id bucket=%s id=%s", bucket, id);
 
-  if (NULL == ctx->backend->list_bucket)
+  if (NULL == ctx->backend->head_id)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->list_bucket_attrs(ctx,
-                                         bucket,
-                                         prefix,
-                                         delimiter,
-                                         max_keys,
-                                         metadatap,
-                                         sysmdp,
-                                         objectsp,
-                                         common_prefixesp,
-                                         NULL);
+
+  do
+    {
+      ret2 = ctx->backend->head_id(ctx, bucket, id, NULL, option, object_type, condition, metadatap, sysmdp, NULL);
+    }
+  while (dpl_retry_again(ctx, ret2, &attempt));
+
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
-
+  
   ret = DPL_SUCCESS;
 
  end:
-  
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "REQUEST", "LIST", 0);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
   
   return ret;
 }
 
-/**
- * list bucket or directory
- *
- * @param ctx the droplet context
- * @param bucket can be NULL
- * @param prefix directory can be NULL
- * @param delimiter e.g. "/" can be NULL
- * @param max number of keys we want to get (-1 for no limit)
- * @param objectsp vector of dpl_object_t * (files)
- * @param prefixesp vector of dpl_common_prefix_t * (directories)
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- */
 dpl_status_t
-dpl_list_bucket(dpl_ctx_t *ctx,
-                const char *bucket,
-                const char *prefix,
-                const char *delimiter,
-                const int max_keys,
-                dpl_vec_t **objectsp,
-                dpl_vec_t **common_prefixesp)
+dpl_head_id(dpl_ctx_t *ctx,
+            const char *bucket,
+            const char *id,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            const dpl_condition_t *condition,
+            dpl_dict_t **metadatap,
+            dpl_sysmd_t *sysmdp)
 {
-  return dpl_list_bucket_attrs(ctx,
-                               bucket,
-                               prefix,
-                               delimiter,
-                               max_keys,
-                               NULL,
-                               NULL,
-                               objectsp,
-                               common_prefixesp);
+  if (decompress_applies(option, object_type))
+    return head_decompress(ctx, get_id_plain, head_id_plain, bucket, id, option, object_type, condition, metadatap, sysmdp);
+
+  return head_stored(ctx, head_id_plain, bucket, id, option, object_type, condition, metadatap, sysmdp);
 }
 
-/**
- * make a bucket
- *
- * @param ctx the droplet context
- * @param bucket can be NULL
- * @param location_constraint geographic location
- * @param canned_acl simplified ACL
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- */
 dpl_status_t
-dpl_make_bucket(dpl_ctx_t *ctx,
-                const char *bucket, 
-                dpl_location_constraint_t location_constraint,
-                dpl_canned_acl_t canned_acl)
+dpl_head_raw_id(dpl_ctx_t *ctx,
+                const char *bucket,
+                const char *id,
+                const dpl_option_t *option,
+                dpl_ftype_t object_type,
+                const dpl_condition_t *condition,
+                dpl_dict_t **metadatap)
 {
   dpl_status_t ret, ret2;
-  dpl_sysmd_t sysmd;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "makebucket bucket=%s", bucket);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "head_raw_id bucket=%s id=%s", bucket, id);
 
-  if (NULL == ctx->backend->make_bucket)
+  if (NULL == ctx->backend->head_id_raw)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  memset(&sysmd, 0, sizeof (sysmd));
-  sysmd.mask = DPL_SYSMD_MASK_CANNED_ACL|DPL_SYSMD_MASK_LOCATION_CONSTRAINT;
-  sysmd.canned_acl = canned_acl;
-  sysmd.location_constraint = location_constraint;
 
-  ret2 = ctx->backend->make_bucket(ctx, bucket, &sysmd, NULL);
+  ret2 = ctx->backend->head_id_raw(ctx, bucket, id, NULL, option, object_type, condition, metadatap, NULL);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -373,38 +3033,40 @@ dpl_make_bucket(dpl_ctx_t *ctx,
 
  end:
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "PUT", 0);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
   
   return ret;
 }
 
-/**
- * delete a path
- *
- * @param ctx the droplet context
- * @param bucket can be NULL
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- */
-dpl_status_t 
-dpl_delete_bucket(dpl_ctx_t *ctx,
-                  const char *bucket)
+dpl_status_t
+dpl_delete_id(dpl_ctx_t *ctx,
+              const char *bucket,
+              const char *id,
+              const dpl_option_t *option,
+              dpl_ftype_t object_type,
+              const dpl_condition_t *condition)
 {
   dpl_status_t ret, ret2;
-  
-  DPL_TRACE(ctx, DPL_TRACE_REST, "delete_bucket bucket=%s", bucket);
+  int attempt = 0;
 
-  if (NULL == ctx->backend->delete_bucket)
+  DPL_TRACE(ctx, DPL_TRACE_ID, "delete bucket=%s id=%s", bucket, id);
+
+  if (NULL == ctx->backend->delete_id)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->delete_bucket(ctx, bucket, NULL);
+
+  do
+    {
+      ret2 = ctx->backend->delete_id(ctx, bucket, id, NULL, option, object_type, condition, NULL);
+    }
+  while (is_idempotent_write(condition) && dpl_retry_again(ctx, ret2, &attempt));
+
+  //the attempt which failed may have deleted it
+  if (DPL_ENOENT == ret2 && attempt > 0)
+    ret2 = DPL_SUCCESS;
+
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -415,60 +3077,47 @@ dpl_delete_bucket(dpl_ctx_t *ctx,
 
  end:
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "DELETE", 0);
+  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
   
   return ret;
 }
 
 /** 
- * create or post data into a path
- *
- * @note this function is expected to return a newly created object
+ * generate a valid URL for sharing object
  * 
  * @param ctx the droplet context
- * @param bucket can be NULL
- * @param path can be NULL
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type DPL_FTYPE_REG create a file
- * @param metadata the user metadata. optional
- * @param sysmd the system metadata. optional
- * @param data_buf the data buffer
- * @param data_len the data length
- * @param query_params can be NULL
- * @param returned_sysmdp the returned system metadata passed through stack
+ * @param bucket the optional bucket
+ * @param path the mandat path
+ * @param option unused
+ * @param expires expire time of URL
+ * @param buf URL is created in this buffer
+ * @param len buffer length
+ * @param lenp real buffer returned
  * 
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
  */
 dpl_status_t
-dpl_post(dpl_ctx_t *ctx,
-         const char *bucket,
-         const char *path,
-         const dpl_option_t *option,
-         dpl_ftype_t object_type,
-         const dpl_condition_t *condition,
-         const dpl_range_t *range,
-         const dpl_dict_t *metadata,
-         const dpl_sysmd_t *sysmd,
-         const char *data_buf,
-         unsigned int data_len,
-         const dpl_dict_t *query_params,
-         dpl_sysmd_t *returned_sysmdp)
+dpl_genurl(dpl_ctx_t *ctx,
+           const char *bucket,
+           const char *path,
+           const dpl_option_t *option,
+           time_t expires,
+           char *buf,
+           unsigned int len,
+           unsigned int *lenp)
 {
   dpl_status_t ret, ret2;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "put bucket=%s path=%s", bucket, path);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "genurl bucket=%s path=%s", bucket, path);
 
-  if (NULL == ctx->backend->post)
+  if (NULL == ctx->backend->genurl)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
   
-  ret2 = ctx->backend->post(ctx, bucket, path, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, query_params, returned_sysmdp, NULL);
+  ret2 = ctx->backend->genurl(ctx, bucket, path, NULL, option, expires, buf, len, lenp, NULL);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -480,1158 +3129,1459 @@ dpl_post(dpl_ctx_t *ctx,
  end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "IN", data_len);
   
   return ret;
 }
 
 /**
- * put a path
+ * generate URLs for sharing many objects of a bucket at once
+ *
+ * the signing material is derived once for the whole batch, and no
+ * lock of the context is held, so that many threads may generate URLs
+ * concurrently.
  *
  * @param ctx the droplet context
- * @param bucket optional
- * @param path mandatory
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type DPL_FTYPE_REG create a file
- * @param object_type DPL_FTYPE_DIR create a directory
- * @param condition the optional condition
- * @param range optional range
- * @param metadata the optional user metadata
- * @param sysmd the optional system metadata
- * @param data_buf the data buffer
- * @param data_len the data length
+ * @param bucket the mandat bucket
+ * @param paths the paths
+ * @param n_paths number of paths
+ * @param option unused
+ * @param expires expire time of the URLs
+ * @param buf arena in which the URLs are created, NUL terminated
+ * @param len arena length
+ * @param urls receives the n_paths URLs
+ * @param n_urlsp number of URLs generated
  *
  * @return DPL_SUCCESS
+ * @return DPL_ELIMIT the arena is too small, *n_urlsp URLs were generated
  * @return DPL_FAILURE
- * @return DPL_EEXIST
  */
 dpl_status_t
-dpl_put(dpl_ctx_t *ctx,
-        const char *bucket,
-        const char *path,
-        const dpl_option_t *option,
-        dpl_ftype_t object_type,
-        const dpl_condition_t *condition,
-        const dpl_range_t *range,
-        const dpl_dict_t *metadata,
-        const dpl_sysmd_t *sysmd,
-        const char *data_buf,
-        unsigned int data_len)
+dpl_genurl_batch(dpl_ctx_t *ctx,
+                 const char *bucket,
+                 const char * const *paths,
+                 int n_paths,
+                 const dpl_option_t *option,
+                 time_t expires,
+                 char *buf,
+                 unsigned int len,
+                 char **urls,
+                 int *n_urlsp)
 {
   dpl_status_t ret, ret2;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "put bucket=%s path=%s", bucket, path);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "genurl_batch bucket=%s n_paths=%d", bucket, n_paths);
 
-  if (NULL == ctx->backend->put)
+  if (NULL == ctx->backend->genurl_batch)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret2 = ctx->backend->put(ctx, bucket, path, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, NULL, NULL, NULL);
+  ret2 = ctx->backend->genurl_batch(ctx, bucket, paths, n_paths, option, expires, buf, len, urls, n_urlsp);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
-  
+
   ret = DPL_SUCCESS;
 
  end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "IN", data_len);
-  
   return ret;
 }
 
 /** 
- * get a path with range
+ * perform various flavors of server side copies
  * 
  * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type DPL_FTYPE_ANY get any type of path
+ * @param src_bucket the optional source bucket
+ * @param src_path the mandat source path
+ * @param dst_bucket the optional destination bucket
+ * @param dst_path the optional destination path (if dst equals src)
+ * @param option unused
+ * @param object_type unused
+ * @param copy_directive DPL_COPY_DIRECTIVE_COPY server side copy
+ * @param copy_directive DPL_COPY_DIRECTIVE_METADATA_REPLACE setattr
+ * @param copy_directive DPL_COPY_DIRECTIVE_LINK hard link
+ * @param copy_directive DPL_COPY_DIRECTIVE_SYMLINK reference
+ * @param copy_directive DPL_COPY_DIRECTIVE_MOVE rename, a copy followed
+ * by a delete of the source on backends that cannot rename objects
+ * @param copy_directive DPL_COPY_DIRECTIVE_MKDENT create a directory entry
+ * @param metadata the optional user metadata
+ * @param sysmd the optional system metadata
  * @param condition the optional condition
- * @param range the optional range
- * @param data_bufp the returned data buffer client shall free
- * @param data_lenp the returned data length
- * @param metadatap the returned user metadata client shall free
- * @param sysmdp the returned system metadata passed through stack
- * 
+ *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
- * @return DPL_ENOENT path does not exist
  */
 dpl_status_t
-dpl_get(dpl_ctx_t *ctx,
-        const char *bucket,
-        const char *path,
-        const dpl_option_t *option,
-        dpl_ftype_t object_type,
-        const dpl_condition_t *condition,
-        const dpl_range_t *range, 
-        char **data_bufp,
-        unsigned int *data_lenp,
-        dpl_dict_t **metadatap,
-        dpl_sysmd_t *sysmdp)
+dpl_copy(dpl_ctx_t *ctx,
+         const char *src_bucket,
+         const char *src_path,
+         const char *dst_bucket,
+         const char *dst_path,
+         const dpl_option_t *option,
+         dpl_ftype_t object_type,
+         dpl_copy_directive_t copy_directive,
+         const dpl_dict_t *metadata,
+         const dpl_sysmd_t *sysmd,
+         const dpl_condition_t *condition)
+{
+  dpl_status_t ret, ret2;
+  dpl_dict_t *crypt_md = NULL;
+  dpl_dict_t *src_md = NULL;
+  dpl_sysmd_t src_sysmd;
+  int keep_envelope, by_parts;
+  int delete_src = 0;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "copy src_bucket=%s src_path=%s dst_bucket=%s dst_path=%s", src_bucket, src_path, dst_bucket, dst_path);
+
+  keep_envelope = (crypt_applies(ctx, option, object_type) ||
+                   decompress_applies(option, object_type)) &&
+    (NULL != metadata || DPL_COPY_DIRECTIVE_METADATA_REPLACE == copy_directive) &&
+    (DPL_COPY_DIRECTIVE_COPY == copy_directive ||
+     DPL_COPY_DIRECTIVE_MOVE == copy_directive ||
+     DPL_COPY_DIRECTIVE_METADATA_REPLACE == copy_directive);
+
+  //large objects are copied by parts
+  by_parts = (DPL_COPY_DIRECTIVE_COPY == copy_directive ||
+              DPL_COPY_DIRECTIVE_MOVE == copy_directive) &&
+    DPL_FTYPE_DIR != object_type &&
+    ctx->copy_parallel_threshold > 0 &&
+    NULL != ctx->backend->multipart_copy;
+
+  //a single HEAD of the stored source serves both
+  memset(&src_sysmd, 0, sizeof (src_sysmd));
+  if (keep_envelope || by_parts)
+    {
+      ret2 = head_plain(ctx, src_bucket, src_path, option, object_type, condition,
+                        &src_md, &src_sysmd);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  if (keep_envelope)
+    {
+      ret2 = merge_envelope(src_md, metadata, &crypt_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      if (NULL != crypt_md)
+        metadata = crypt_md;
+    }
+
+  if (by_parts &&
+      (src_sysmd.mask & DPL_SYSMD_MASK_SIZE) &&
+      src_sysmd.size >= ctx->copy_parallel_threshold)
+    {
+      ret2 = dpl_copy_parallel_sized(ctx, src_bucket, src_path, dst_bucket, dst_path,
+                                     metadata, sysmd, condition, NULL,
+                                     &src_sysmd, src_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      delete_src = (DPL_COPY_DIRECTIVE_MOVE == copy_directive);
+    }
+  else
+    {
+      if (NULL == ctx->backend->copy)
+        {
+          ret = DPL_ENOTSUPP;
+          goto end;
+        }
+
+      ret2 = ctx->backend->copy(ctx, src_bucket, src_path, NULL, dst_bucket, dst_path, NULL, option, object_type, copy_directive, metadata, sysmd, condition, NULL);
+      if (DPL_ENOTSUPP == ret2 &&
+          DPL_COPY_DIRECTIVE_MOVE == copy_directive &&
+          DPL_FTYPE_DIR != object_type)
+        {
+          //no native rename, move as large objects are moved
+          ret2 = ctx->backend->copy(ctx, src_bucket, src_path, NULL, dst_bucket, dst_path, NULL, option, object_type,
+                                    NULL == metadata ? DPL_COPY_DIRECTIVE_COPY : DPL_COPY_DIRECTIVE_METADATA_REPLACE,
+                                    metadata, sysmd, condition, NULL);
+          delete_src = 1;
+        }
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  if (delete_src)
+    {
+      ret2 = dpl_delete(ctx, src_bucket, src_path, option, object_type, NULL);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != src_md)
+    dpl_dict_free(src_md);
+
+  if (NULL != crypt_md)
+    dpl_dict_free(crypt_md);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "PUT", 0);
+  
+  return ret;
+}
+
+dpl_status_t
+dpl_copy_id(dpl_ctx_t *ctx,
+            const char *src_bucket,
+            const char *src_id,
+            const char *dst_bucket,
+            const char *dst_path,
+            const dpl_option_t *option,
+            dpl_ftype_t object_type,
+            dpl_copy_directive_t copy_directive,
+            const dpl_dict_t *metadata,
+            const dpl_sysmd_t *sysmd,
+            const dpl_condition_t *condition)
 {
   dpl_status_t ret, ret2;
-  u_int data_len;
-  char *new_location = NULL;
-  char *new_location_resource;
-  char *new_location_subresource;
+  dpl_dict_t *crypt_md = NULL;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "get bucket=%s path=%s", bucket, path);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "copy_id src_bucket=%s src_id=%s dst_bucket=%s dst_path=%s", src_bucket, src_id, dst_bucket, dst_path);
 
-  if (NULL == ctx->backend->get)
+  if (NULL == ctx->backend->copy_id)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  if (NULL != data_lenp)
-    data_len = *data_lenp;
-
-  ret2 = ctx->backend->get(ctx, bucket, path, NULL, option, object_type, condition, range, data_bufp, &data_len, metadatap, sysmdp, &new_location);
-
-  if (DPL_EREDIRECT == ret2)
+  if ((crypt_applies(ctx, option, object_type) ||
+       decompress_applies(option, object_type)) &&
+      (NULL != metadata || DPL_COPY_DIRECTIVE_METADATA_REPLACE == copy_directive) &&
+      (DPL_COPY_DIRECTIVE_COPY == copy_directive ||
+       DPL_COPY_DIRECTIVE_MOVE == copy_directive ||
+       DPL_COPY_DIRECTIVE_METADATA_REPLACE == copy_directive))
     {
-      dpl_location_to_resource(ctx,
-                               new_location,
-                               &new_location_resource,
-                               &new_location_subresource);
-
-      if (NULL != data_lenp)
-        data_len = *data_lenp;
-
-      ret2 = ctx->backend->get(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, range, data_bufp, &data_len, metadatap, sysmdp, NULL);
+      ret2 = copy_envelope(ctx, head_id_plain, src_bucket, src_id, option,
+                           object_type, condition, metadata, &crypt_md);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
 
-      free(new_location);
+      if (NULL != crypt_md)
+        metadata = crypt_md;
     }
-
+  
+  ret2 = ctx->backend->copy_id(ctx, src_bucket, src_id, NULL, dst_bucket, dst_path, NULL, option, object_type, copy_directive, metadata, sysmd, condition, NULL);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
   
-  if (NULL != data_lenp)
-    *data_lenp = data_len;
-
   ret = DPL_SUCCESS;
 
  end:
 
+  if (NULL != crypt_md)
+    dpl_dict_free(crypt_md);
+
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
   if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "OUT", data_len);
+    dpl_log_request(ctx, "DATA", "PUT", 0);
   
   return ret;
 }
 
-/** 
- * get a path for SYMLINKS
+/**
+ * Create a streaming object to read from/write to using an object path
+ * The returned stream is not reentrant, and should not be used by multiple
+ * threads at the same time.
  *
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type DPL_FTYPE_ANY get any type of path
- * @param condition the optional condition
- * @param data_bufp the returned data buffer client shall free
- * @param data_lenp the returned data length
- * @param metadatap the returned user metadata client shall free
- * @param sysmdp the returned system metadata passed through stack
+ * @param ctx       the droplet context
+ * @param bucket    the name of the bucket
+ * @param path      the path of the object
+ * @param option    Optional. The dict of options for this stream object
+ * @param condition Optional. The condition
+ * @param streamp   Mandatory. The pointer to return the stream through
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
- * @return DPL_ENOENT path does not exist
+ * @return DPL_ENOMEM
  */
 dpl_status_t
-dpl_get_noredirect(dpl_ctx_t *ctx,
-                   const char *bucket,
-                   const char *path,
-                   dpl_ftype_t object_type,
-                   char **locationp)
+dpl_stream_open(dpl_ctx_t *ctx, const char *bucket, const char *path,
+                const dpl_option_t *option, const dpl_condition_t *condition,
+                dpl_dict_t *metadata, dpl_sysmd_t *sysmd,
+                dpl_stream_t **streamp)
 {
-  dpl_status_t ret, ret2;
-  int loclen = 0;
-  char *new_location = NULL;
-  char *new_location_resource = NULL;
-  char *new_location_subresource = NULL;
+  dpl_status_t  ret = DPL_FAILURE;
+  dpl_stream_t  *stream = NULL;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "get bucket=%s path=%s", bucket, path);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "stream_open bucket=%s path=%s"
+            " option=%p condition=%p metadata=%p sysmd=%p",
+            bucket, path, option, condition, metadata, sysmd);
 
-  if (NULL == ctx->backend->get)
+  stream = calloc(1, sizeof(*stream));
+  if (NULL == stream)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ENOMEM;
       goto end;
     }
 
-  ret2 = ctx->backend->get(ctx, bucket, path, NULL, NULL, object_type,
-                           NULL, NULL, NULL, NULL, NULL, NULL, &new_location);
-  if (DPL_EREDIRECT != ret2)
+  stream->bucket = strdup(bucket);
+  if (NULL == stream->bucket)
     {
-      if (ret2 == DPL_SUCCESS)
-        {
-          ret = DPL_ENOTSUPP;
-          goto end;
-        }
-      ret = ret2;
+      ret = DPL_ENOMEM;
       goto end;
     }
 
-  dpl_location_to_resource(ctx,
-                           new_location,
-                           &new_location_resource,
-                           &new_location_subresource);
-  loclen = strlen(new_location_resource);
-  if (NULL != locationp)
+  stream->locator_is_id = 0;
+  stream->locator = strdup(path);
+  if (NULL == stream->locator)
     {
-      *locationp = strdup(new_location_resource);
-      if (NULL == *locationp)
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  if (NULL != option)
+    {
+      stream->options = dpl_option_dup(option);
+      if (NULL == stream->options)
         {
           ret = DPL_ENOMEM;
           goto end;
         }
     }
 
-  ret = DPL_SUCCESS;
-
- end:
-  if (new_location)
-    free(new_location);
-
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "LINKDATA", "OUT", loclen);
-
-  return ret;
-}
-
-/**
- * get user and system metadata
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type DPL_FTYPE_ANY get any type of path
- * @param condition the optional condition
- * @param metadatap the returned user metadata client shall free
- * @param sysmdp the returned system metadata passed through stack
- * 
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- * @return DPL_ENOENT path does not exist
- */
-dpl_status_t
-dpl_head(dpl_ctx_t *ctx,
-         const char *bucket,
-         const char *path,
-         const dpl_option_t *option,
-         dpl_ftype_t object_type,
-         const dpl_condition_t *condition,
-         dpl_dict_t **metadatap,
-         dpl_sysmd_t *sysmdp)
-{
-  dpl_status_t ret, ret2;
-  char *new_location = NULL;
-  char *new_location_resource;
-  char *new_location_subresource;
-
-  DPL_TRACE(ctx, DPL_TRACE_REST, "head bucket=%s path=%s", bucket, path);
-
-  if (NULL == ctx->backend->head)
+  if (NULL != condition)
     {
-      ret = DPL_ENOTSUPP;
-      goto end;
+      stream->condition = dpl_condition_dup(condition);
+      if (NULL == stream->condition)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
     }
-  
-  ret2 = ctx->backend->head(ctx, bucket, path, NULL, option, object_type, condition, metadatap, sysmdp, &new_location);
 
-  if (DPL_EREDIRECT == ret2)
+  if (NULL != metadata)
     {
-      dpl_location_to_resource(ctx,
-                               new_location,
-                               &new_location_resource,
-                               &new_location_subresource);
-
-      ret2 = ctx->backend->head(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, metadatap, sysmdp, NULL);
-
-      free(new_location);
+      stream->md = dpl_dict_dup(metadata);
+      if (NULL == stream->md)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
     }
 
-  if (DPL_SUCCESS != ret2)
+  if (NULL != sysmd)
     {
-      ret = ret2;
-      goto end;
+      stream->sysmd = dpl_sysmd_dup(sysmd);
+      if (NULL == stream->sysmd)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
     }
-  
+
+  *streamp = stream;
+  stream = NULL;
+
   ret = DPL_SUCCESS;
 
- end:
+end:
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+  if (NULL != stream)
+    dpl_stream_close(ctx, stream);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d stream=%p", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "GET", 0);
-  
   return ret;
 }
 
-/** 
- * get raw metadata
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param condition the optional condition
- * @param metadatap the returned metadata client shall free
- * 
+/**
+ * Create a streaming object to read from/write to using an object ID
+ * The returned stream is not reentrant, and should not be used by multiple
+ * threads at the same time.
+ *
+ * @param ctx       the droplet context
+ * @param bucket    the name of the bucket
+ * @param id        the id of the object
+ * @param option    Optional. The dict of options for this stream object
+ * @param condition Optional. The condition
+ * @param streamp   Mandatory. The pointer to return the stream through
+ *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
- * @return DPL_ENOENT
  */
+
 dpl_status_t
-dpl_head_raw(dpl_ctx_t *ctx,
-             const char *bucket,
-             const char *path,
-             const dpl_option_t *option,
-             dpl_ftype_t object_type,
-             const dpl_condition_t *condition,
-             dpl_dict_t **metadatap)
+dpl_stream_openid(dpl_ctx_t *ctx, const char *bucket, const char *id,
+                  const dpl_option_t *option, const dpl_condition_t *condition,
+                  dpl_dict_t *metadata, dpl_sysmd_t *sysmd,
+                  dpl_stream_t **streamp)
 {
-  dpl_status_t ret, ret2;
-  char *new_location = NULL;
-  char *new_location_resource;
-  char *new_location_subresource;
+  dpl_status_t  ret = DPL_FAILURE;
+  dpl_stream_t  *stream = NULL;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "stream_open bucket=%s id=%s"
+            " option=%p condition=%pi metadata=%p sysmd=%p",
+            bucket, id, option, condition, metadata, sysmd);
+
+  stream = calloc(1, sizeof(*stream));
+  if (NULL == stream)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "head_raw bucket=%s path=%s", bucket, path);
+  stream->bucket = strdup(bucket);
+  if (NULL == stream->bucket)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
 
-  if (NULL == ctx->backend->head_raw)
+  stream->locator_is_id = 1;
+  stream->locator = strdup(id);
+  if (NULL == stream->locator)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ENOMEM;
       goto end;
     }
-  
-  ret2 = ctx->backend->head_raw(ctx, bucket, path, NULL, option, object_type, condition, metadatap, &new_location);
 
-  if (DPL_EREDIRECT == ret2)
+  if (NULL != option)
     {
-      dpl_location_to_resource(ctx,
-                               new_location,
-                               &new_location_resource,
-                               &new_location_subresource);
+      stream->options = dpl_option_dup(option);
+      if (NULL == stream->options)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
 
-      ret2 = ctx->backend->head_raw(ctx, bucket, new_location_resource, new_location_subresource, option, object_type, condition, metadatap, NULL);
+  if (NULL != condition)
+    {
+      stream->condition = dpl_condition_dup(condition);
+      if (NULL == stream->condition)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
 
-      free(new_location);
+  if (NULL != metadata)
+    {
+      stream->md = dpl_dict_dup(metadata);
+      if (NULL == stream->md)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
     }
 
-  if (DPL_SUCCESS != ret2)
+  if (NULL != sysmd)
     {
-      ret = ret2;
-      goto end;
+      stream->sysmd = dpl_sysmd_dup(sysmd);
+      if (NULL == stream->sysmd)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
     }
-  
+
+  *streamp = stream;
   ret = DPL_SUCCESS;
 
- end:
+end:
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+  if (NULL != stream)
+    dpl_stream_close(ctx, stream);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d stream=%p", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "GET", 0);
-  
   return ret;
 }
 
-/** 
- * delete a path
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param condition the optional condition
- * 
+/**
+ * Resume a streaming (Write) operation using the json object returned by the
+ * last successful call to a stream write operation.
+ *
+ * If the stream was opened with DPL_OPTION_RECONCILE, the parts stored by
+ * the server are listed first and the status is rebuilt from them, so that
+ * only the missing parts are uploaded again.
+ *
+ * @param ctx       the droplet context
+ * @param stream    the droplet stream
+ * @param status    the json status object
+ *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
- * @return DPL_ENOENT path does not exist
+ * @return DPL_ENOENT the upload was aborted or completed meanwhile
  */
 dpl_status_t
-dpl_delete(dpl_ctx_t *ctx,
-           const char *bucket,
-           const char *path,
-           const dpl_option_t *option,
-           dpl_ftype_t object_type,
-           const dpl_condition_t *condition)
+dpl_stream_resume(dpl_ctx_t *ctx, dpl_stream_t *stream, struct json_object *status)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "delete bucket=%s path=%s", bucket, path);
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_resume ctx=%p stream=%p status=%p", ctx, stream, status);
 
-  if (NULL == ctx->backend->deletef)
+  if (NULL == ctx->backend->stream_resume)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->deletef(ctx, bucket, path, NULL, option, object_type, condition, NULL);
-  if (DPL_SUCCESS != ret2)
+
+  //the pending chunk of an encrypted or compressed stream is lost with
+  //the process
+  if (crypt_applies(ctx, stream->options, DPL_FTYPE_REG) ||
+      dpl_compress_enabled(ctx, stream->options))
     {
-      ret = ret2;
+      ret = DPL_ENOTSUPP;
       goto end;
     }
 
+  ret = ctx->backend->stream_resume(ctx, stream, status);
+  if (DPL_SUCCESS != ret)
+      goto end;
+
   ret = DPL_SUCCESS;
 
- end:
+end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "DELETE", 0);
-  
   return ret;
 }
 
 /**
- * delete multiple path
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type
- * @param condition the optional condition
+ * Read the Object's metadata from the stream
+ *
+ * @param ctx       the droplet context
+ * @param stream    the droplet stream
+ * @param metadatap the pointer to the metadata to return
+ * @param sysmdp    the pointer to the sysmd to return
  *
- * @return DPL_ENOTSUPP
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
  */
 dpl_status_t
-dpl_delete_all(dpl_ctx_t *ctx,
-               const char *bucket,
-               dpl_locators_t *locators,
-               const dpl_option_t *option,
-               const dpl_condition_t *condition,
-               dpl_vec_t **objectsp)
+dpl_stream_getmd(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                 dpl_dict_t **metadatap, dpl_sysmd_t **sysmdp)
 {
-  dpl_status_t  ret;
+  dpl_status_t  ret = DPL_FAILURE;
 
-  if (ctx->backend->delete_all == NULL) {
-    ret = DPL_ENOTSUPP;
-    goto end;
-  }
-  
-  ret = ctx->backend->delete_all(ctx, bucket, locators, option, condition, objectsp);
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_getmd ctx=%p stream=%p mdp=%p sysmdp=%p",
+            ctx, stream, metadatap, sysmdp);
+
+  if (NULL == ctx->backend->stream_getmd)
+    {
+      ret = DPL_ENOTSUPP;
+      goto end;
+    }
+
+  ret = ctx->backend->stream_getmd(ctx, stream, metadatap, sysmdp);
   if (DPL_SUCCESS != ret)
-    goto end;
+      goto end;
 
   ret = DPL_SUCCESS;
 
- end:
+end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "DELETE", 0);
-  
   return ret;
 }
 
-/**
- * delete multiple id
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param ressource path of ID (ex: /proxy/arc) for REST backend
- * @param option DPL_OPTION_HTTP_COMPAT use if possible the HTTP compat mode
- * @param object_type
- * @param condition the optional condition
- *
- * @return DPL_ENOTSUPP
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
+/*
+ * encrypted or compressed reads go through the same layers as dpl_get(),
+ * the offset being kept in the status as by the backends
  */
-dpl_status_t
-dpl_delete_all_id(dpl_ctx_t *ctx,
-                  const char *bucket,
-                  const char *ressource,
-                  dpl_locators_t *locators,
-                  const dpl_option_t *option,
-                  const dpl_condition_t *condition,
-                  dpl_vec_t **objectsp)
+static dpl_status_t
+stream_get_ranged(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                   unsigned int len, char **data_bufp, unsigned int *data_lenp)
 {
-  dpl_status_t  ret;
+  dpl_status_t        ret = DPL_FAILURE;
+  struct json_object  *json_mode = NULL;
+  struct json_object  *json_offset = NULL;
+  dpl_range_t         range;
+  uint64_t            offset = 0;
 
-  if (ctx->backend->delete_all_id == NULL) {
-    ret = DPL_ENOTSUPP;
-    goto end;
-  }
-  
-  ret = ctx->backend->delete_all_id(ctx, bucket, ressource, locators, option, condition, objectsp);
+  if (0 == len)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  if (NULL == stream->status)
+    {
+      stream->status = json_object_new_object();
+      if (NULL == stream->status)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
+
+  if (json_object_object_get_ex(stream->status, "direction", &json_mode) == FALSE)
+    {
+      json_mode = json_object_new_string("read");
+      if (NULL == json_mode)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      json_object_object_add(stream->status, "direction", json_mode);
+    }
+  else if (!json_object_is_type(json_mode, json_type_string)
+           || strcmp(json_object_get_string(json_mode), "read") != 0)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  if (json_object_object_get_ex(stream->status, "offset", &json_offset) == TRUE)
+    offset = json_object_get_int64(json_offset);
+
+  range.start = offset;
+  range.end = offset + len - 1;
+
+  if (decompress_applies(stream->options, DPL_FTYPE_REG))
+    ret = get_decompress(ctx, stream->locator_is_id ? get_id_plain : get_plain,
+                         stream->locator_is_id ? head_id_plain : head_plain,
+                         stream->bucket, stream->locator, stream->options,
+                         DPL_FTYPE_REG, stream->condition, &range,
+                         data_bufp, data_lenp, NULL, NULL);
+  else
+    ret = get_stored(ctx, stream->locator_is_id ? get_id_plain : get_plain,
+                     stream->locator_is_id ? head_id_plain : head_plain,
+                     stream->bucket, stream->locator, stream->options,
+                     DPL_FTYPE_REG, stream->condition, &range,
+                     data_bufp, data_lenp, NULL, NULL);
   if (DPL_SUCCESS != ret)
     goto end;
 
-  ret = DPL_SUCCESS;
+  json_offset = json_object_new_int64(offset + *data_lenp);
+  if (NULL == json_offset)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+  json_object_object_del(stream->status, "offset");
+  json_object_object_add(stream->status, "offset", json_offset);
 
- end:
+  ret = DPL_SUCCESS;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+end:
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "DELETE", 0);
-  
   return ret;
 }
 
-/** 
- * create or post data into a path
+/**
+ * Read the Object's Data into the streamed object
  *
- * @note this function is expected to return a newly created object
- * 
- * @param ctx 
- * @param bucket 
- * @param path can be NULL
- * @param object_type 
- * @param metadata 
- * @param canned_acl 
- * @param data_buf 
- * @param data_len 
- * @param query_params can be NULL
- * @param returned_sysmdp
- * 
- * @return 
- */
-dpl_status_t
-dpl_post_id(dpl_ctx_t *ctx,
-            const char *bucket,
-            const char *id,
-            const dpl_option_t *option,
-            dpl_ftype_t object_type,
-            const dpl_condition_t *condition,
-            const dpl_range_t *range,
-            const dpl_dict_t *metadata,
-            const dpl_sysmd_t *sysmd,
-            const char *data_buf,
-            unsigned int data_len,
-            const dpl_dict_t *query_params,
-            dpl_sysmd_t *returned_sysmdp)
+ * @param ctx       the droplet context
+ * @param stream    the droplet stream
+ * @param len       the size of the data to read
+ * @param data_bufp pointer to return the read data
+ * @param data_lenp pointer to return the size of the data read
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_stream_get(dpl_ctx_t *ctx, dpl_stream_t *stream,
+               unsigned int len, char **data_bufp, unsigned int *data_lenp,
+               struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "post_id bucket=%s", bucket);
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_get ctx=%p stream=%p len=%u", ctx, stream, len);
 
-  if (NULL == ctx->backend->post_id)
+  if (NULL == ctx->backend->stream_get)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->post_id(ctx, bucket, id, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, query_params, returned_sysmdp, NULL);
-  if (DPL_SUCCESS != ret2)
-    {
-      ret = ret2;
+
+  if (crypt_applies(ctx, stream->options, DPL_FTYPE_REG) ||
+      dpl_compress_enabled(ctx, stream->options))
+    ret = stream_get_ranged(ctx, stream, len, data_bufp, data_lenp);
+  else
+    ret = ctx->backend->stream_get(ctx, stream, len, data_bufp, data_lenp, statusp);
+  if (DPL_SUCCESS != ret)
       goto end;
-    }
 
   ret = DPL_SUCCESS;
-  
- end:
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
+end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
   return ret;
 }
 
+/**
+ * Write the Object's Metadata into the streamed object
+ *
+ * @param ctx       the droplet context
+ * @param stream    the droplet stream
+ * @param metadata  the metadata to write
+ * @param sysmd     the sysmd to write
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
 dpl_status_t
-dpl_put_id(dpl_ctx_t *ctx,
-           const char *bucket,
-           const char *id,
-           const dpl_option_t *option,
-           dpl_ftype_t object_type,
-           const dpl_condition_t *condition,
-           const dpl_range_t *range,
-           const dpl_dict_t *metadata,
-           const dpl_sysmd_t *sysmd,
-           const char *data_buf,
-           unsigned int data_len)
+dpl_stream_putmd(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                 dpl_dict_t *metadata, dpl_sysmd_t *sysmd)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "put_id bucket=%s id=%s", bucket, id);
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_putmd ctx=%p stream=%p md=%p sysmd=%p",
+            ctx, stream, metadata, sysmd);
 
-  if (NULL == ctx->backend->put_id)
+  if (NULL == ctx->backend->stream_putmd)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret2 = ctx->backend->put_id(ctx, bucket, id, NULL, option, object_type, condition, range, metadata, sysmd, data_buf, data_len, NULL, NULL, NULL);
-  if (DPL_SUCCESS != ret2)
-    {
-      ret = ret2;
+  ret = ctx->backend->stream_putmd(ctx, stream, metadata, sysmd);
+  if (DPL_SUCCESS != ret)
       goto end;
+
+  //new metadata must not lose the envelope nor the compression metadata
+  if (NULL != stream->crypt && NULL != metadata && NULL != stream->md)
+    {
+      ret = dpl_crypt_seal(ctx, stream->crypt, stream->md);
+      if (DPL_SUCCESS != ret)
+        goto end;
     }
-  
+
+  if (NULL != stream->comp && NULL != metadata && NULL != stream->md)
+    {
+      ret = dpl_compress_seal(stream->comp, stream->md, 0);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
   ret = DPL_SUCCESS;
 
- end:
+end:
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
-  
   return ret;
 }
 
-dpl_status_t
-dpl_get_id(dpl_ctx_t *ctx,
-           const char *bucket,
-           const char *id,
-           const dpl_option_t *option,
-           dpl_ftype_t object_type,
-           const dpl_condition_t *condition,
-           const dpl_range_t *range,
-           char **data_bufp,
-           unsigned int *data_lenp,
-           dpl_dict_t **metadatap,
-           dpl_sysmd_t *sysmdp)
+/*
+ * encrypt and send the first len pending bytes as one part, the last one
+ * if final
+ */
+static dpl_status_t
+stream_put_pending(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                   unsigned int len, int final, struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
-
-  DPL_TRACE(ctx, DPL_TRACE_ID, "get_id bucket=%s id=%s", bucket, id);
+  dpl_status_t  ret = DPL_FAILURE;
+  char          *cipher_buf = NULL;
+  uint64_t      cipher_len;
 
-  if (NULL == ctx->backend->get_id)
+  cipher_len = dpl_crypt_cipher_size(stream->crypt->chunk_size, len, final);
+  if (cipher_len > UINT_MAX)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ELIMIT;
       goto end;
     }
 
-  ret2 = ctx->backend->get_id(ctx, bucket, id, NULL, option, object_type, condition, range, data_bufp, data_lenp, metadatap, sysmdp, NULL);
-  if (DPL_SUCCESS != ret2)
+  cipher_buf = malloc(cipher_len > 0 ? cipher_len : 1);
+  if (NULL == cipher_buf)
     {
-      ret = ret2;
+      ret = DPL_ENOMEM;
       goto end;
     }
-  
+
+  ret = dpl_crypt_encrypt(stream->crypt, stream->crypt_offset,
+                          stream->crypt_buf, len, final, cipher_buf);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  ret = ctx->backend->stream_put(ctx, stream, cipher_buf, cipher_len, statusp);
+  if (DPL_SUCCESS != ret)
+    goto end;
+
+  memmove(stream->crypt_buf, stream->crypt_buf + len, stream->crypt_len - len);
+  stream->crypt_len -= len;
+  stream->crypt_offset += len;
+  stream->crypt_done = final;
+
   ret = DPL_SUCCESS;
 
- end:
+end:
+
+  free(cipher_buf);
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
-  
   return ret;
 }
 
-dpl_status_t
-dpl_head_id(dpl_ctx_t *ctx,
-            const char *bucket,
-            const char *id,
-            const dpl_option_t *option,
-            dpl_ftype_t object_type,
-            const dpl_condition_t *condition,
-            dpl_dict_t **metadatap,
-            dpl_sysmd_t *sysmdp)
+/*
+ * The envelope goes along with the first part, as some backends only
+ * take metadata when a multipart upload is initiated.  The data of a put
+ * is held back until the next one, which sends its whole chunks as a
+ * part and carries the remainder over, so that the final partial chunk
+ * joins the last part at flush instead of making the one before it
+ * shorter than the data given to that put.
+ */
+static dpl_status_t
+stream_put_encrypt(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                   char *buf, unsigned int len, struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
+  unsigned int  n;
+  char          *tmp;
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "head_id bucket=%s id=%s", bucket, id);
+  if (NULL == stream->crypt)
+    {
+      if (NULL == stream->md)
+        {
+          stream->md = dpl_dict_new(13);
+          if (NULL == stream->md)
+            {
+              ret = DPL_ENOMEM;
+              goto end;
+            }
+        }
 
-  if (NULL == ctx->backend->head_id)
+      stream->crypt = dpl_crypt_new(ctx);
+      if (NULL == stream->crypt)
+        {
+          ret = DPL_FAILURE;
+          goto end;
+        }
+
+      ret = dpl_crypt_seal(ctx, stream->crypt, stream->md);
+      if (DPL_SUCCESS != ret)
+        {
+          dpl_crypt_destroy(stream->crypt);
+          stream->crypt = NULL;
+          goto end;
+        }
+    }
+
+  if ((uint64_t) stream->crypt_len + len > UINT_MAX)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ELIMIT;
       goto end;
     }
 
-  ret2 = ctx->backend->head_id(ctx, bucket, id, NULL, option, object_type, condition, metadatap, sysmdp, NULL);
-  if (DPL_SUCCESS != ret2)
+  tmp = realloc(stream->crypt_buf, stream->crypt_len + len + 1);
+  if (NULL == tmp)
     {
-      ret = ret2;
+      ret = DPL_ENOMEM;
       goto end;
     }
-  
+  stream->crypt_buf = tmp;
+
+  n = stream->crypt_len / stream->crypt->chunk_size * stream->crypt->chunk_size;
+  if (n > 0)
+    {
+      ret = stream_put_pending(ctx, stream, n, 0, statusp);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+  else
+    {
+      if (NULL != stream->status)
+        json_object_get(stream->status);
+      *statusp = stream->status;
+    }
+
+  memcpy(stream->crypt_buf + stream->crypt_len, buf, len);
+  stream->crypt_len += len;
+
   ret = DPL_SUCCESS;
 
- end:
+end:
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
-  
   return ret;
 }
 
-dpl_status_t
-dpl_head_raw_id(dpl_ctx_t *ctx,
-                const char *bucket,
-                const char *id,
-                const dpl_option_t *option,
-                dpl_ftype_t object_type,
-                const dpl_condition_t *condition,
-                dpl_dict_t **metadatap)
+static dpl_status_t
+stream_put_stored(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                  char *buf, unsigned int len, struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
+  if (crypt_applies(ctx, stream->options, DPL_FTYPE_REG))
+    return stream_put_encrypt(ctx, stream, buf, len, statusp);
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "head_raw_id bucket=%s id=%s", bucket, id);
+  return ctx->backend->stream_put(ctx, stream, buf, len, statusp);
+}
 
-  if (NULL == ctx->backend->head_id_raw)
+/*
+ * send the compressed data accumulated so far as one part
+ */
+static dpl_status_t
+stream_put_compressed(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                      unsigned int len, struct json_object **statusp)
+{
+  dpl_status_t  ret;
+
+  ret = stream_put_stored(ctx, stream, stream->comp_out, len, statusp);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  stream->comp_out_len = 0;
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * the compression metadata go along with the first part, as some
+ * backends only take metadata when a multipart upload is initiated
+ */
+static dpl_status_t
+stream_compress_new(dpl_ctx_t *ctx, dpl_stream_t *stream)
+{
+  dpl_status_t  ret;
+
+  if (NULL == stream->md)
     {
-      ret = DPL_ENOTSUPP;
-      goto end;
+      stream->md = dpl_dict_new(13);
+      if (NULL == stream->md)
+        return DPL_ENOMEM;
     }
 
-  ret2 = ctx->backend->head_id_raw(ctx, bucket, id, NULL, option, object_type, condition, metadatap, NULL);
-  if (DPL_SUCCESS != ret2)
+  stream->comp = dpl_compress_new(ctx);
+  if (NULL == stream->comp)
+    return DPL_ENOMEM;
+
+  ret = dpl_compress_seal(stream->comp, stream->md, 0);
+  if (DPL_SUCCESS != ret)
     {
-      ret = ret2;
-      goto end;
+      dpl_compress_destroy(stream->comp);
+      stream->comp = NULL;
+      return ret;
     }
-  
-  ret = DPL_SUCCESS;
-
- end:
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
-  
-  return ret;
+  return DPL_SUCCESS;
 }
 
-dpl_status_t
-dpl_delete_id(dpl_ctx_t *ctx,
-              const char *bucket,
-              const char *id,
-              const dpl_option_t *option,
-              dpl_ftype_t object_type,
-              const dpl_condition_t *condition)
+/*
+ * Whether the data is compressible is decided on its first chunk, which
+ * is held back until complete.  Compressed data is then accumulated
+ * until it makes a part of the minimum multipart size, the partial chunk
+ * at the end of a put being carried over to the next one.  Pending data
+ * is sent before taking the new one, so that a failed put can be
+ * retried.
+ */
+static dpl_status_t
+stream_put_compress(dpl_ctx_t *ctx, dpl_stream_t *stream,
+                    char *buf, unsigned int len, struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
+  uint32_t      chunk_size = DPL_COMPRESS_CHUNK_SIZE;
+  unsigned int  k;
+  size_t        out_len, n;
+  char          *tmp = NULL;
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "delete bucket=%s id=%s", bucket, id);
+  if (stream->comp_skip)
+    return stream_put_stored(ctx, stream, buf, len, statusp);
+
+  if (NULL == stream->comp_buf)
+    {
+      stream->comp_buf = malloc(chunk_size);
+      if (NULL == stream->comp_buf)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
+
+  if (NULL == stream->comp)
+    {
+      if (stream->comp_len + len < chunk_size)
+        {
+          memcpy(stream->comp_buf + stream->comp_len, buf, len);
+          stream->comp_len += len;
+
+          if (NULL != stream->status)
+            json_object_get(stream->status);
+          *statusp = stream->status;
+
+          ret = DPL_SUCCESS;
+          goto end;
+        }
+
+      if ((uint64_t) stream->comp_len + len > UINT_MAX)
+        {
+          ret = DPL_ELIMIT;
+          goto end;
+        }
+
+      tmp = malloc(stream->comp_len + len);
+      if (NULL == tmp)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      memcpy(tmp, stream->comp_buf, stream->comp_len);
+      memcpy(tmp + stream->comp_len, buf, len);
+
+      if (!dpl_compress_worthwhile(ctx, tmp, stream->comp_len + len))
+        {
+          ret = stream_put_stored(ctx, stream, tmp, stream->comp_len + len, statusp);
+          if (DPL_SUCCESS != ret)
+            goto end;
+
+          stream->comp_len = 0;
+          stream->comp_skip = 1;
+          goto end;
+        }
+
+      free(tmp);
+      tmp = NULL;
+
+      ret = stream_compress_new(ctx, stream);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
+  if (stream->comp_out_len >= DPL_MULTIPART_MIN_PART_SIZE)
+    {
+      ret = stream_put_compressed(ctx, stream, stream->comp_out_len, statusp);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+  else
+    {
+      if (NULL != stream->status)
+        json_object_get(stream->status);
+      *statusp = stream->status;
+    }
 
-  if (NULL == ctx->backend->delete_id)
+  //chunks are never stored larger than they are
+  n = ((size_t) stream->comp_len + len) / chunk_size * chunk_size;
+  if ((uint64_t) stream->comp_out_len + n > UINT_MAX)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ELIMIT;
       goto end;
     }
 
-  ret2 = ctx->backend->delete_id(ctx, bucket, id, NULL, option, object_type, condition, NULL);
-  if (DPL_SUCCESS != ret2)
+  if (n > 0)
     {
-      ret = ret2;
-      goto end;
+      tmp = realloc(stream->comp_out, stream->comp_out_len + n);
+      if (NULL == tmp)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      stream->comp_out = tmp;
+      tmp = NULL;
+
+      if (stream->comp_len > 0)
+        {
+          k = chunk_size - stream->comp_len;
+          memcpy(stream->comp_buf + stream->comp_len, buf, k);
+          buf += k;
+          len -= k;
+          n -= chunk_size;
+
+          ret = dpl_compress_deflate(stream->comp, stream->comp_buf, chunk_size,
+                                     stream->comp_out + stream->comp_out_len,
+                                     &out_len);
+          if (DPL_SUCCESS != ret)
+            goto end;
+          stream->comp_out_len += out_len;
+          stream->comp_len = 0;
+        }
+
+      ret = dpl_compress_deflate(stream->comp, buf, n,
+                                 stream->comp_out + stream->comp_out_len,
+                                 &out_len);
+      if (DPL_SUCCESS != ret)
+        goto end;
+      stream->comp_out_len += out_len;
+      buf += n;
+      len -= n;
     }
-  
+
+  memcpy(stream->comp_buf + stream->comp_len, buf, len);
+  stream->comp_len += len;
+
   ret = DPL_SUCCESS;
 
- end:
+end:
+
+  free(tmp);
 
-  DPL_TRACE(ctx, DPL_TRACE_ID, "ret=%d", ret);
-  
   return ret;
 }
 
-/** 
- * generate a valid URL for sharing object
- * 
- * @param ctx the droplet context
- * @param bucket the optional bucket
- * @param path the mandat path
- * @param option unused
- * @param expires expire time of URL
- * @param buf URL is created in this buffer
- * @param len buffer length
- * @param lenp real buffer returned
- * 
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
+/*
+ * compress the last chunk, append the chunk index and trailer and send
+ * what is left
  */
-dpl_status_t
-dpl_genurl(dpl_ctx_t *ctx,
-           const char *bucket,
-           const char *path,
-           const dpl_option_t *option,
-           time_t expires,
-           char *buf,
-           unsigned int len,
-           unsigned int *lenp)
+static dpl_status_t
+stream_flush_compress(dpl_ctx_t *ctx, dpl_stream_t *stream)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t        ret = DPL_FAILURE;
+  struct json_object  *status = NULL;
+  uint32_t            n_chunks;
+  uint64_t            size;
+  size_t              out_len, index_len;
+  char                *tmp;
+
+  if (NULL == stream->comp)
+    {
+      //small object, still undecided
+      if (0 == stream->comp_len)
+        {
+          ret = DPL_SUCCESS;
+          goto end;
+        }
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "genurl bucket=%s path=%s", bucket, path);
+      if (!dpl_compress_worthwhile(ctx, stream->comp_buf, stream->comp_len))
+        {
+          ret = stream_put_stored(ctx, stream, stream->comp_buf,
+                                  stream->comp_len, &status);
+          if (DPL_SUCCESS != ret)
+            goto end;
 
-  if (NULL == ctx->backend->genurl)
+          stream->comp_len = 0;
+          stream->comp_skip = 1;
+          goto end;
+        }
+
+      ret = stream_compress_new(ctx, stream);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
+  index_len = ((size_t) stream->comp->n_chunks + 1) * sizeof (uint32_t) +
+    DPL_COMPRESS_TRAILER_SIZE;
+  if ((uint64_t) stream->comp_out_len + stream->comp_len + index_len > UINT_MAX)
     {
-      ret = DPL_ENOTSUPP;
+      ret = DPL_ELIMIT;
       goto end;
     }
-  
-  ret2 = ctx->backend->genurl(ctx, bucket, path, NULL, option, expires, buf, len, lenp, NULL);
-  if (DPL_SUCCESS != ret2)
+
+  tmp = realloc(stream->comp_out, stream->comp_out_len + stream->comp_len + index_len);
+  if (NULL == tmp)
     {
-      ret = ret2;
+      ret = DPL_ENOMEM;
       goto end;
     }
-  
-  ret = DPL_SUCCESS;
+  stream->comp_out = tmp;
 
- end:
+  //undone if sending fails
+  n_chunks = stream->comp->n_chunks;
+  size = stream->comp->size;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
-  
-  return ret;
-}
+  ret = dpl_compress_deflate(stream->comp, stream->comp_buf, stream->comp_len,
+                             stream->comp_out + stream->comp_out_len, &out_len);
+  if (DPL_SUCCESS != ret)
+    goto undo;
 
-/** 
- * perform various flavors of server side copies
- * 
- * @param ctx the droplet context
- * @param src_bucket the optional source bucket
- * @param src_path the mandat source path
- * @param dst_bucket the optional destination bucket
- * @param dst_path the optional destination path (if dst equals src)
- * @param option unused
- * @param object_type unused
- * @param copy_directive DPL_COPY_DIRECTIVE_COPY server side copy
- * @param copy_directive DPL_COPY_DIRECTIVE_METADATA_REPLACE setattr
- * @param copy_directive DPL_COPY_DIRECTIVE_LINK hard link
- * @param copy_directive DPL_COPY_DIRECTIVE_SYMLINK reference
- * @param copy_directive DPL_COPY_DIRECTIVE_MOVE rename
- * @param copy_directive DPL_COPY_DIRECTIVE_MKDENT create a directory entry
- * @param metadata the optional user metadata
- * @param sysmd the optional system metadata
- * @param condition the optional condition
- *
- * @return DPL_SUCCESS
- * @return DPL_FAILURE
- */
-dpl_status_t
-dpl_copy(dpl_ctx_t *ctx,
-         const char *src_bucket,
-         const char *src_path,
-         const char *dst_bucket,
-         const char *dst_path,
-         const dpl_option_t *option,
-         dpl_ftype_t object_type,
-         dpl_copy_directive_t copy_directive,
-         const dpl_dict_t *metadata,
-         const dpl_sysmd_t *sysmd,
-         const dpl_condition_t *condition)
-{
-  dpl_status_t ret, ret2;
+  out_len += stream->comp_out_len;
+  out_len += dpl_compress_write_index(stream->comp, stream->comp_out + out_len);
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "copy src_bucket=%s src_path=%s dst_bucket=%s dst_path=%s", src_bucket, src_path, dst_bucket, dst_path);
+  ret = stream_put_compressed(ctx, stream, out_len, &status);
+  if (DPL_SUCCESS != ret)
+    goto undo;
+
+  stream->comp_len = 0;
+
+  //the stream is complete, a retried flush must not send it again
+  stream->comp_skip = 1;
 
-  if (NULL == ctx->backend->copy)
-    {
-      ret = DPL_ENOTSUPP;
-      goto end;
-    }
-  
-  ret2 = ctx->backend->copy(ctx, src_bucket, src_path, NULL, dst_bucket, dst_path, NULL, option, object_type, copy_directive, metadata, sysmd, condition, NULL);
-  if (DPL_SUCCESS != ret2)
-    {
-      ret = ret2;
-      goto end;
-    }
-  
   ret = DPL_SUCCESS;
+  goto end;
 
- end:
+ undo:
+  stream->comp->n_chunks = n_chunks;
+  stream->comp->size = size;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+end:
+
+  if (NULL != status)
+    json_object_put(status);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "PUT", 0);
-  
   return ret;
 }
 
+/**
+ * Write the Object's Data into the streamed object
+ *
+ * @param ctx       the droplet context
+ * @param stream    the droplet stream
+ * @param buf       the data to write
+ * @param len       the size of the data to write
+ * @param statusp   The pointer to a json status object, to return
+ *                  backend-specific status to caller
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
 dpl_status_t
-dpl_copy_id(dpl_ctx_t *ctx,
-            const char *src_bucket,
-            const char *src_id,
-            const char *dst_bucket,
-            const char *dst_path,
-            const dpl_option_t *option,
-            dpl_ftype_t object_type,
-            dpl_copy_directive_t copy_directive,
-            const dpl_dict_t *metadata,
-            const dpl_sysmd_t *sysmd,
-            const dpl_condition_t *condition)
+dpl_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream,
+               char *buf, unsigned int len, struct json_object **statusp)
 {
-  dpl_status_t ret, ret2;
+  dpl_status_t  ret = DPL_FAILURE;
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "copy_id src_bucket=%s src_id=%s dst_bucket=%s dst_path=%s", src_bucket, src_id, dst_bucket, dst_path);
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_put ctx=%p stream=%p buf=%p len=%u status=%p",
+            ctx, stream, buf, len, statusp);
 
-  if (NULL == ctx->backend->copy_id)
+  if (NULL == ctx->backend->stream_put)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
-  
-  ret2 = ctx->backend->copy_id(ctx, src_bucket, src_id, NULL, dst_bucket, dst_path, NULL, option, object_type, copy_directive, metadata, sysmd, condition, NULL);
-  if (DPL_SUCCESS != ret2)
-    {
-      ret = ret2;
+
+  if (dpl_compress_enabled(ctx, stream->options))
+    ret = stream_put_compress(ctx, stream, buf, len, statusp);
+  else
+    ret = stream_put_stored(ctx, stream, buf, len, statusp);
+  if (DPL_SUCCESS != ret)
       goto end;
-    }
-  
+
   ret = DPL_SUCCESS;
 
- end:
+end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
-  if (DPL_SUCCESS == ret)
-    dpl_log_request(ctx, "DATA", "PUT", 0);
-  
   return ret;
 }
 
 /**
- * Create a streaming object to read from/write to using an object path
- * The returned stream is not reentrant, and should not be used by multiple
- * threads at the same time.
+ * Flush (finalize) streamed upload
  *
- * @param ctx       the droplet context
- * @param bucket    the name of the bucket
- * @param path      the path of the object
- * @param option    Optional. The dict of options for this stream object
- * @param condition Optional. The condition
- * @param streamp   Mandatory. The pointer to return the stream through
+ * @param ctx     the droplet context
+ * @param stream  the droplet stream
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
- * @return DPL_ENOMEM
  */
 dpl_status_t
-dpl_stream_open(dpl_ctx_t *ctx, const char *bucket, const char *path,
-                const dpl_option_t *option, const dpl_condition_t *condition,
-                dpl_dict_t *metadata, dpl_sysmd_t *sysmd,
-                dpl_stream_t **streamp)
+dpl_stream_flush(dpl_ctx_t *ctx, dpl_stream_t *stream)
 {
-  dpl_status_t  ret = DPL_FAILURE;
-  dpl_stream_t  *stream = NULL;
-
-  DPL_TRACE(ctx, DPL_TRACE_REST, "stream_open bucket=%s path=%s"
-            " option=%p condition=%p metadata=%p sysmd=%p",
-            bucket, path, option, condition, metadata, sysmd);
+  dpl_status_t        ret = DPL_FAILURE;
+  struct json_object  *status = NULL;
 
-  stream = calloc(1, sizeof(*stream));
-  if (NULL == stream)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
-
-  stream->bucket = strdup(bucket);
-  if (NULL == stream->bucket)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_flush ctx=%p stream=%p", ctx, stream);
 
-  stream->locator_is_id = 0;
-  stream->locator = strdup(path);
-  if (NULL == stream->locator)
+  if (NULL == ctx->backend->stream_flush)
     {
-      ret = DPL_ENOMEM;
+      ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  if (NULL != option)
-    {
-      stream->options = dpl_option_dup(option);
-      if (NULL == stream->options)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-
-  if (NULL != condition)
-    {
-      stream->condition = dpl_condition_dup(condition);
-      if (NULL == stream->condition)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-
-  if (NULL != metadata)
+  if (dpl_compress_enabled(ctx, stream->options) && !stream->comp_skip)
     {
-      stream->md = dpl_dict_dup(metadata);
-      if (NULL == stream->md)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
+      ret = stream_flush_compress(ctx, stream);
+      if (DPL_SUCCESS != ret)
+        goto end;
     }
 
-  if (NULL != sysmd)
+  if (NULL != stream->crypt && !stream->crypt_done)
     {
-      stream->sysmd = dpl_sysmd_dup(sysmd);
-      if (NULL == stream->sysmd)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
+      ret = stream_put_pending(ctx, stream, stream->crypt_len, 1, &status);
+      if (NULL != status)
+        json_object_put(status);
+      if (DPL_SUCCESS != ret)
+        goto end;
     }
 
-  *streamp = stream;
-  stream = NULL;
+  ret = ctx->backend->stream_flush(ctx, stream);
+  if (DPL_SUCCESS != ret)
+      goto end;
 
   ret = DPL_SUCCESS;
 
 end:
 
-  if (NULL != stream)
-    dpl_stream_close(ctx, stream);
-
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d stream=%p", ret);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
   return ret;
 }
 
+
 /**
- * Create a streaming object to read from/write to using an object ID
- * The returned stream is not reentrant, and should not be used by multiple
- * threads at the same time.
+ * Releases resources associated to the stream stream
  *
  * @param ctx       the droplet context
- * @param bucket    the name of the bucket
- * @param id        the id of the object
- * @param option    Optional. The dict of options for this stream object
- * @param condition Optional. The condition
- * @param streamp   Mandatory. The pointer to return the stream through
+ * @param stream    the droplet stream
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
  */
-
-dpl_status_t
-dpl_stream_openid(dpl_ctx_t *ctx, const char *bucket, const char *id,
-                  const dpl_option_t *option, const dpl_condition_t *condition,
-                  dpl_dict_t *metadata, dpl_sysmd_t *sysmd,
-                  dpl_stream_t **streamp)
+void
+dpl_stream_close(dpl_ctx_t *ctx, dpl_stream_t *stream)
 {
-  dpl_status_t  ret = DPL_FAILURE;
-  dpl_stream_t  *stream = NULL;
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "stream_close ctx=%p stream=%p", ctx, stream);
 
-  DPL_TRACE(ctx, DPL_TRACE_REST, "stream_open bucket=%s id=%s"
-            " option=%p condition=%pi metadata=%p sysmd=%p",
-            bucket, id, option, condition, metadata, sysmd);
+  if (stream->condition)
+    dpl_condition_free(stream->condition);
 
-  stream = calloc(1, sizeof(*stream));
-  if (NULL == stream)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
+  if (stream->options)
+    dpl_option_free(stream->options);
 
-  stream->bucket = strdup(bucket);
-  if (NULL == stream->bucket)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
+  if (stream->locator)
+    free(stream->locator);
 
-  stream->locator_is_id = 1;
-  stream->locator = strdup(id);
-  if (NULL == stream->locator)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
+  if (stream->bucket)
+    free(stream->bucket);
 
-  if (NULL != option)
-    {
-      stream->options = dpl_option_dup(option);
-      if (NULL == stream->options)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
+  if (stream->status)
+      json_object_put(stream->status);
 
-  if (NULL != condition)
-    {
-      stream->condition = dpl_condition_dup(condition);
-      if (NULL == stream->condition)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
+  dpl_crypt_destroy(stream->crypt);
+  free(stream->crypt_buf);
 
-  if (NULL != metadata)
-    {
-      stream->md = dpl_dict_dup(metadata);
-      if (NULL == stream->md)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
+  dpl_compress_destroy(stream->comp);
+  free(stream->comp_buf);
+  free(stream->comp_out);
 
-  if (NULL != sysmd)
+  free(stream);
+}
+
+/**
+ * Initiate a multipart upload
+ *
+ * @param ctx       the droplet context
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param uploadidp the returned upload id, caller shall free it
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
+ */
+dpl_status_t
+dpl_multipart_init(dpl_ctx_t *ctx,
+                   const char *bucket,
+                   const char *resource,
+                   const char **uploadidp)
+{
+  return dpl_multipart_init_ext(ctx, bucket, resource, NULL, NULL, uploadidp);
+}
+
+/**
+ * Initiate a multipart upload of an object with metadata
+ *
+ * backends such as S3 only take the metadata of the object here, and
+ * ignore those given to dpl_multipart_complete()
+ *
+ * @param ctx       the droplet context
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param metadata  the optional user metadata
+ * @param sysmd     the optional system metadata
+ * @param uploadidp the returned upload id, caller shall free it
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
+ */
+dpl_status_t
+dpl_multipart_init_ext(dpl_ctx_t *ctx,
+                       const char *bucket,
+                       const char *resource,
+                       const dpl_dict_t *metadata,
+                       const dpl_sysmd_t *sysmd,
+                       const char **uploadidp)
+{
+  dpl_status_t  ret = DPL_FAILURE;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST,
+            "multipart_init bucket=%s resource=%s", bucket, resource);
+
+  if (NULL == ctx->backend->multipart_init)
     {
-      stream->sysmd = dpl_sysmd_dup(sysmd);
-      if (NULL == stream->sysmd)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
+      ret = DPL_ENOTSUPP;
+      goto end;
     }
 
-  *streamp = stream;
+  ret = ctx->backend->multipart_init(ctx, bucket, resource, metadata, sysmd,
+                                     uploadidp);
+  if (DPL_SUCCESS != ret)
+      goto end;
+
   ret = DPL_SUCCESS;
 
 end:
 
-  if (NULL != stream)
-    dpl_stream_close(ctx, stream);
-
-  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d stream=%p", ret);
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
   return ret;
 }
 
 /**
- * Resume a streaming (Write) operation using the json object returned by the
- * last successful call to a stream write operation.
+ * Upload one part of a multipart upload
  *
  * @param ctx       the droplet context
- * @param stream    the droplet stream
- * @param status    the json status object
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param uploadid  the upload id returned by dpl_multipart_init()
+ * @param partnb    the part number, starting at 1
+ * @param buf       the part data
+ * @param len       the part length
+ * @param etagp     the returned part ETag, caller shall free it
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_resume(dpl_ctx_t *ctx, dpl_stream_t *stream, struct json_object *status)
+dpl_multipart_put(dpl_ctx_t *ctx,
+                  const char *bucket,
+                  const char *resource,
+                  const char *uploadid,
+                  unsigned int partnb,
+                  char *buf,
+                  unsigned int len,
+                  const char **etagp)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_resume ctx=%p stream=%p status=%p", ctx, stream, status);
+            "multipart_put bucket=%s resource=%s partnb=%u len=%u",
+            bucket, resource, partnb, len);
 
-  if (NULL == ctx->backend->stream_resume)
+  if (NULL == ctx->backend->multipart_put)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_resume(ctx, stream, status);
+  ret = ctx->backend->multipart_put(ctx, bucket, resource, uploadid,
+                                    partnb, buf, len, etagp);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1641,37 +4591,52 @@ end:
 
   DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
 
+  if (DPL_SUCCESS == ret)
+    dpl_log_request(ctx, "DATA", "IN", len);
+
   return ret;
 }
 
 /**
- * Read the Object's metadata from the stream
+ * Complete a multipart upload
  *
  * @param ctx       the droplet context
- * @param stream    the droplet stream
- * @param metadatap the pointer to the metadata to return
- * @param sysmdp    the pointer to the sysmd to return
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param uploadid  the upload id returned by dpl_multipart_init()
+ * @param parts     json array of part ETags, index 0 is part number 1
+ * @param n_parts   number of parts
+ * @param metadata  the optional user metadata
+ * @param sysmd     the optional system metadata
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_getmd(dpl_ctx_t *ctx, dpl_stream_t *stream,
-                 dpl_dict_t **metadatap, dpl_sysmd_t **sysmdp)
+dpl_multipart_complete(dpl_ctx_t *ctx,
+                       const char *bucket,
+                       const char *resource,
+                       const char *uploadid,
+                       struct json_object *parts,
+                       unsigned int n_parts,
+                       const dpl_dict_t *metadata,
+                       const dpl_sysmd_t *sysmd)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_getmd ctx=%p stream=%p mdp=%p sysmdp=%p",
-            ctx, stream, metadatap, sysmdp);
+            "multipart_complete bucket=%s resource=%s n_parts=%u",
+            bucket, resource, n_parts);
 
-  if (NULL == ctx->backend->stream_getmd)
+  if (NULL == ctx->backend->multipart_complete)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_getmd(ctx, stream, metadatap, sysmdp);
+  ret = ctx->backend->multipart_complete(ctx, bucket, resource, uploadid,
+                                         parts, n_parts, metadata, sysmd);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1685,34 +4650,35 @@ end:
 }
 
 /**
- * Read the Object's Data into the streamed object
+ * Abort a multipart upload and release its stored parts
  *
  * @param ctx       the droplet context
- * @param stream    the droplet stream
- * @param len       the size of the data to read
- * @param data_bufp pointer to return the read data
- * @param data_lenp pointer to return the size of the data read
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param uploadid  the upload id returned by dpl_multipart_init()
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_get(dpl_ctx_t *ctx, dpl_stream_t *stream,
-               unsigned int len, char **data_bufp, unsigned int *data_lenp,
-               struct json_object **statusp)
+dpl_multipart_abort(dpl_ctx_t *ctx,
+                    const char *bucket,
+                    const char *resource,
+                    const char *uploadid)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_get ctx=%p stream=%p len=%u", ctx, stream, len);
+            "multipart_abort bucket=%s resource=%s", bucket, resource);
 
-  if (NULL == ctx->backend->stream_get)
+  if (NULL == ctx->backend->multipart_abort)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_get(ctx, stream, len, data_bufp, data_lenp, statusp);
+  ret = ctx->backend->multipart_abort(ctx, bucket, resource, uploadid);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1726,33 +4692,51 @@ end:
 }
 
 /**
- * Write the Object's Metadata into the streamed object
+ * Copy a range of an existing object as one part of a multipart upload
+ * (UploadPartCopy), the data does not go through the client
  *
- * @param ctx       the droplet context
- * @param stream    the droplet stream
- * @param metadata  the metadata to write
- * @param sysmd     the sysmd to write
+ * @param ctx          the droplet context
+ * @param bucket       the bucket
+ * @param resource     the resource
+ * @param uploadid     the upload id returned by dpl_multipart_init()
+ * @param partnb       the part number, starting at 1
+ * @param src_bucket   the source bucket
+ * @param src_resource the source resource
+ * @param range        the optional range of the source
+ * @param condition    the optional condition on the source
+ * @param etagp        the returned part ETag, caller shall free it
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_putmd(dpl_ctx_t *ctx, dpl_stream_t *stream,
-                 dpl_dict_t *metadata, dpl_sysmd_t *sysmd)
+dpl_multipart_copy(dpl_ctx_t *ctx,
+                   const char *bucket,
+                   const char *resource,
+                   const char *uploadid,
+                   unsigned int partnb,
+                   const char *src_bucket,
+                   const char *src_resource,
+                   const dpl_range_t *range,
+                   const dpl_condition_t *condition,
+                   const char **etagp)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_putmd ctx=%p stream=%p md=%p sysmd=%p",
-            ctx, stream, metadata, sysmd);
+            "multipart_copy bucket=%s resource=%s partnb=%u src_bucket=%s src_resource=%s",
+            bucket, resource, partnb, src_bucket, src_resource);
 
-  if (NULL == ctx->backend->stream_putmd)
+  if (NULL == ctx->backend->multipart_copy)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_putmd(ctx, stream, metadata, sysmd);
+  ret = ctx->backend->multipart_copy(ctx, bucket, resource, uploadid, partnb,
+                                     src_bucket, src_resource, range,
+                                     condition, etagp);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1766,35 +4750,39 @@ end:
 }
 
 /**
- * Write the Object's Data into the streamed object
+ * List the parts already stored for a multipart upload (ListParts)
  *
  * @param ctx       the droplet context
- * @param stream    the droplet stream
- * @param buf       the data to write
- * @param len       the size of the data to write
- * @param statusp   The pointer to a json status object, to return
- *                  backend-specific status to caller
+ * @param bucket    the bucket
+ * @param resource  the resource
+ * @param uploadid  the upload id returned by dpl_multipart_init()
+ * @param partsp    vector of dpl_multipart_part_t, free with
+ *                  dpl_vec_multipart_parts_free()
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOENT the upload does not exist anymore
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream,
-               char *buf, unsigned int len, struct json_object **statusp)
+dpl_multipart_list_parts(dpl_ctx_t *ctx,
+                         const char *bucket,
+                         const char *resource,
+                         const char *uploadid,
+                         dpl_vec_t **partsp)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_put ctx=%p stream=%p buf=%p len=%u status=%p",
-            ctx, stream, buf, len, statusp);
+            "multipart_list_parts bucket=%s resource=%s", bucket, resource);
 
-  if (NULL == ctx->backend->stream_put)
+  if (NULL == ctx->backend->multipart_list_parts)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_put(ctx, stream, buf, len, statusp);
+  ret = ctx->backend->multipart_list_parts(ctx, bucket, resource, uploadid, partsp);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1808,29 +4796,38 @@ end:
 }
 
 /**
- * Flush (finalize) streamed upload
+ * List the multipart uploads in progress (ListMultipartUploads)
  *
- * @param ctx     the droplet context
- * @param stream  the droplet stream
+ * @param ctx       the droplet context
+ * @param bucket    the bucket
+ * @param prefix    only list the uploads of keys starting with prefix,
+ *                  may be NULL
+ * @param uploadsp  vector of dpl_multipart_upload_t, free with
+ *                  dpl_vec_multipart_uploads_free()
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
 dpl_status_t
-dpl_stream_flush(dpl_ctx_t *ctx, dpl_stream_t *stream)
+dpl_multipart_list_uploads(dpl_ctx_t *ctx,
+                           const char *bucket,
+                           const char *prefix,
+                           dpl_vec_t **uploadsp)
 {
   dpl_status_t  ret = DPL_FAILURE;
 
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_flush ctx=%p stream=%p", ctx, stream);
+            "multipart_list_uploads bucket=%s prefix=%s", bucket,
+            prefix ? prefix : "");
 
-  if (NULL == ctx->backend->stream_flush)
+  if (NULL == ctx->backend->multipart_list_uploads)
     {
       ret = DPL_ENOTSUPP;
       goto end;
     }
 
-  ret = ctx->backend->stream_flush(ctx, stream);
+  ret = ctx->backend->multipart_list_uploads(ctx, bucket, prefix, uploadsp);
   if (DPL_SUCCESS != ret)
       goto end;
 
@@ -1843,38 +4840,82 @@ end:
   return ret;
 }
 
-
 /**
- * Releases resources associated to the stream stream
+ * Abort the multipart uploads under a prefix which were initiated more
+ * than max_age seconds ago, e.g. left behind by crashed writers
  *
- * @param ctx       the droplet context
- * @param stream    the droplet stream
+ * an upload which fails to abort is logged and skipped, the first error
+ * is returned once all the candidates have been tried.
+ *
+ * @param ctx         the droplet context
+ * @param bucket      the bucket
+ * @param prefix      only consider keys starting with prefix, may be NULL
+ * @param max_age     minimum age in seconds of the uploads to abort
+ * @param n_abortedp  number of uploads aborted, may be NULL
  *
  * @return DPL_SUCCESS
  * @return DPL_FAILURE
+ * @return DPL_ENOTSUPP
  */
-void
-dpl_stream_close(dpl_ctx_t *ctx, dpl_stream_t *stream)
+dpl_status_t
+dpl_multipart_abort_stale(dpl_ctx_t *ctx,
+                          const char *bucket,
+                          const char *prefix,
+                          time_t max_age,
+                          int *n_abortedp)
 {
+  dpl_status_t  ret, ret2;
+  dpl_vec_t     *uploads = NULL;
+  dpl_multipart_upload_t *upload;
+  time_t        limit;
+  int           n_aborted = 0;
+  int           i;
+
   DPL_TRACE(ctx, DPL_TRACE_REST,
-            "stream_close ctx=%p stream=%p", ctx, stream);
+            "multipart_abort_stale bucket=%s prefix=%s max_age=%ld", bucket,
+            prefix ? prefix : "", (long) max_age);
 
-  if (stream->condition)
-    dpl_condition_free(stream->condition);
+  ret2 = dpl_multipart_list_uploads(ctx, bucket, prefix, &uploads);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
 
-  if (stream->options)
-    dpl_option_free(stream->options);
+  limit = time(NULL) - max_age;
+  ret = DPL_SUCCESS;
 
-  if (stream->locator)
-    free(stream->locator);
+  for (i = 0;i < uploads->n_items;i++)
+    {
+      upload = (dpl_multipart_upload_t *) dpl_vec_get(uploads, i);
 
-  if (stream->bucket)
-    free(stream->bucket);
+      if (upload->initiated <= 0 || upload->initiated > limit)
+        continue ;
 
-  if (stream->status)
-      json_object_put(stream->status);
+      ret2 = dpl_multipart_abort(ctx, bucket, upload->key, upload->uploadid);
+      if (DPL_SUCCESS != ret2 && DPL_ENOENT != ret2)
+        {
+          DPL_LOG(ctx, DPL_WARNING, "abort of upload %s on %s failed: %s",
+                  upload->uploadid, upload->key, dpl_status_str(ret2));
+          if (DPL_SUCCESS == ret)
+            ret = ret2;
+          continue ;
+        }
 
-  free(stream);
+      n_aborted++;
+    }
+
+end:
+
+  if (NULL != n_abortedp)
+    *n_abortedp = n_aborted;
+
+  if (NULL != uploads)
+    dpl_vec_multipart_uploads_free(uploads);
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "ret=%d", ret);
+
+  return ret;
 }
 
 /* @} */
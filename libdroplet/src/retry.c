@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+
+/** @file */
+
+/*
+ * Retry policy of the REST layer: transient failures of idempotent
+ * operations are retried after a jittered exponential backoff.  Since
+ * dpl_try_connect() walks the host list round-robin, and blacklists the
+ * host which failed, a retry goes to another host whenever there is one.
+ *
+ * Retries draw from a per-context token bucket which only successes
+ * refill, so that an overloaded service sees at most one retry for ten
+ * successful requests instead of a multiplied load.
+ */
+
+#define RETRY_COST      10      /*!< tokens drawn by a retry */
+#define RETRY_REFILL    1       /*!< tokens returned by a success */
+
+struct dpl_retry
+{
+  pthread_mutex_t lock;
+  int tokens;
+  int max_tokens;
+  dpl_retry_stats_t stats;
+};
+
+/**
+ * allocate the retry state of the context, if enabled by the profile
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_retry_init(dpl_ctx_t *ctx)
+{
+  struct dpl_retry *retry;
+
+  ctx->retry = NULL;
+
+  if (ctx->retry_max <= 0)
+    return DPL_SUCCESS;
+
+  retry = calloc(1, sizeof (*retry));
+  if (NULL == retry)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&retry->lock, NULL);
+  retry->max_tokens = ctx->retry_budget * RETRY_COST;
+  retry->tokens = retry->max_tokens;
+
+  ctx->retry = retry;
+
+  return DPL_SUCCESS;
+}
+
+void
+dpl_retry_free(dpl_ctx_t *ctx)
+{
+  struct dpl_retry *retry = ctx->retry;
+
+  if (NULL == retry)
+    return;
+
+  pthread_mutex_destroy(&retry->lock);
+  free(retry);
+  ctx->retry = NULL;
+}
+
+/**
+ * tell whether a failure is transient
+ *
+ * @param status
+ * @param reasonp filled if transient
+ *
+ * @return 1 if the operation may succeed if tried again
+ */
+int
+dpl_retry_classify(dpl_status_t status,
+                   dpl_retry_reason_t *reasonp)
+{
+  switch (status)
+    {
+    case DPL_ECONNECT:
+      *reasonp = DPL_RETRY_CONNECT;
+      return 1;
+    case DPL_ETIMEOUT:
+      *reasonp = DPL_RETRY_TIMEOUT;
+      return 1;
+    case DPL_ESERVER:
+      *reasonp = DPL_RETRY_SERVER;
+      return 1;
+    case DPL_EBUSY:
+      *reasonp = DPL_RETRY_SLOWDOWN;
+      return 1;
+    case DPL_EIO:
+      *reasonp = DPL_RETRY_RESET;
+      return 1;
+    default:
+      return 0;
+    }
+}
+
+const char *
+dpl_retry_reason_str(dpl_retry_reason_t reason)
+{
+  switch (reason)
+    {
+    case DPL_RETRY_CONNECT:
+      return "connect";
+    case DPL_RETRY_TIMEOUT:
+      return "timeout";
+    case DPL_RETRY_SERVER:
+      return "server";
+    case DPL_RETRY_SLOWDOWN:
+      return "slowdown";
+    case DPL_RETRY_RESET:
+      return "reset";
+    case DPL_RETRY_N_REASONS:
+      break ;
+    }
+
+  return "unknown";
+}
+
+/**
+ * decide whether an idempotent operation shall be issued again
+ *
+ * to be called after each attempt, including successful ones which
+ * refill the budget.  When a retry is granted the calling thread sleeps
+ * for the backoff delay: a random duration up to retry_delay doubled at
+ * each attempt and capped by retry_max_delay, or at least half of it if
+ * the server asked to slow down.
+ *
+ * @param ctx
+ * @param status outcome of the attempt
+ * @param attemptp number of retries so far, incremented on retry
+ *
+ * @return 1 if the operation shall be retried
+ */
+int
+dpl_retry_again(dpl_ctx_t *ctx,
+                dpl_status_t status,
+                int *attemptp)
+{
+  struct dpl_retry *retry = ctx->retry;
+  dpl_retry_reason_t reason;
+  int cost;
+  u_int cap, delay;
+
+  if (NULL == retry)
+    return 0;
+
+  if (DPL_SUCCESS == status)
+    {
+      pthread_mutex_lock(&retry->lock);
+      retry->tokens = MIN(retry->tokens + RETRY_REFILL, retry->max_tokens);
+      if (*attemptp > 0)
+        retry->stats.recovered++;
+      pthread_mutex_unlock(&retry->lock);
+      return 0;
+    }
+
+  if (!dpl_retry_classify(status, &reason))
+    return 0;
+
+  pthread_mutex_lock(&retry->lock);
+
+  if (*attemptp >= ctx->retry_max)
+    {
+      retry->stats.exhausted++;
+      pthread_mutex_unlock(&retry->lock);
+      DPL_TRACE(ctx, DPL_TRACE_REST, "giving up after %d retries", *attemptp);
+      return 0;
+    }
+
+  //timeouts hold resources on the server for longest
+  cost = (DPL_RETRY_TIMEOUT == reason) ? 2 * RETRY_COST : RETRY_COST;
+  if (retry->tokens < cost)
+    {
+      retry->stats.denied++;
+      pthread_mutex_unlock(&retry->lock);
+      DPL_TRACE(ctx, DPL_TRACE_REST, "retry budget exhausted");
+      return 0;
+    }
+
+  retry->tokens -= cost;
+  retry->stats.retries[reason]++;
+
+  pthread_mutex_unlock(&retry->lock);
+
+  cap = (u_int) ctx->retry_delay << MIN(*attemptp, 16);
+  if (cap > (u_int) ctx->retry_max_delay)
+    cap = ctx->retry_max_delay;
+
+  if (DPL_RETRY_SLOWDOWN == reason)
+    delay = cap / 2 + dpl_rand_u32() % (cap / 2 + 1);
+  else
+    delay = dpl_rand_u32() % (cap + 1);
+
+  (*attemptp)++;
+
+  DPL_TRACE(ctx, DPL_TRACE_REST, "retry %d (%s) in %ums",
+            *attemptp, dpl_retry_reason_str(reason), delay);
+
+  if (delay > 0)
+    usleep(delay * 1000);
+
+  return 1;
+}
+
+void
+dpl_retry_get_stats(dpl_ctx_t *ctx,
+                    dpl_retry_stats_t *statsp)
+{
+  struct dpl_retry *retry = ctx->retry;
+
+  memset(statsp, 0, sizeof (*statsp));
+
+  if (NULL == retry)
+    return;
+
+  pthread_mutex_lock(&retry->lock);
+  *statsp = retry->stats;
+  statsp->tokens = retry->tokens / RETRY_COST;
+  pthread_mutex_unlock(&retry->lock);
+}
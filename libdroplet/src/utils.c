@@ -494,6 +494,35 @@ dpl_timetoiso8601(time_t t,
   return DPL_SUCCESS;
 }
 
+/**
+ * parse a size, e.g. a Content-Length, which may go beyond 2^31
+ *
+ * @param str decimal digits only
+ * @param sizep
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE malformed or out of range
+ */
+dpl_status_t
+dpl_parse_size(const char *str,
+               uint64_t *sizep)
+{
+  unsigned long long size;
+  char *endp;
+
+  if (!isdigit((unsigned char) str[0]))
+    return DPL_FAILURE;
+
+  errno = 0;
+  size = strtoull(str, &endp, 10);
+  if (*endp || ERANGE == errno)
+    return DPL_FAILURE;
+
+  *sizep = size;
+
+  return DPL_SUCCESS;
+}
+
 /**/
 
 /**
@@ -630,6 +659,154 @@ dpl_sha256(const uint8_t *data_buf, size_t data_len,
   SHA256_Final(digest_buf, &ctx);
 }
 
+#define DPL_HASH_BLOCK_SIZE (16*1024)
+
+/**
+ * compute MD5 and SHA256 in a single pass
+ *
+ * the data is walked by blocks small enough to stay in the CPU cache
+ * between the two updates, so it is only read once from memory.
+ * OpenSSL selects the accelerated (e.g. SHA-NI) implementations itself.
+ *
+ * @param data_buf
+ * @param data_len
+ * @param md5_buf MD5_DIGEST_LENGTH bytes
+ * @param sha256_buf SHA256_DIGEST_LENGTH bytes
+ */
+void
+dpl_md5_sha256(const uint8_t *data_buf, size_t data_len,
+               uint8_t *md5_buf, uint8_t *sha256_buf)
+{
+  MD5_CTX       md5_ctx;
+  SHA256_CTX    sha256_ctx;
+  size_t        off, len;
+
+  MD5_Init(&md5_ctx);
+  SHA256_Init(&sha256_ctx);
+
+  for (off = 0;off < data_len;off += len)
+    {
+      len = data_len - off;
+      if (len > DPL_HASH_BLOCK_SIZE)
+        len = DPL_HASH_BLOCK_SIZE;
+
+      MD5_Update(&md5_ctx, data_buf + off, len);
+      SHA256_Update(&sha256_ctx, data_buf + off, len);
+    }
+
+  MD5_Final(md5_buf, &md5_ctx);
+  SHA256_Final(sha256_buf, &sha256_ctx);
+}
+
+/**
+ * prepare a HMAC key for signing many messages
+ *
+ * the inner and outer hash states of the key are computed once, so that
+ * each signature only hashes the message.  A prepared key is read-only
+ * and may be shared by threads.
+ *
+ * @param hkey
+ * @param key_buf
+ * @param key_len
+ * @param sha256 HMAC-SHA256 if set, else HMAC-SHA1
+ */
+void
+dpl_hmac_key_init(dpl_hmac_key_t *hkey,
+                  const char *key_buf,
+                  unsigned int key_len,
+                  int sha256)
+{
+  u_char        key[SHA256_CBLOCK];
+  u_char        pad[SHA256_CBLOCK];
+  int           i;
+
+  memset(key, 0, sizeof (key));
+  hkey->sha256 = sha256;
+
+  //SHA1 and SHA256 share the same block size
+  if (key_len > sizeof (key))
+    {
+      if (sha256)
+        SHA256((const u_char *) key_buf, key_len, key);
+      else
+        SHA1((const u_char *) key_buf, key_len, key);
+    }
+  else
+    memcpy(key, key_buf, key_len);
+
+  for (i = 0;i < sizeof (pad);i++)
+    pad[i] = key[i] ^ 0x36;
+  if (sha256)
+    {
+      SHA256_Init(&hkey->inner.sha256);
+      SHA256_Update(&hkey->inner.sha256, pad, sizeof (pad));
+    }
+  else
+    {
+      SHA1_Init(&hkey->inner.sha1);
+      SHA1_Update(&hkey->inner.sha1, pad, sizeof (pad));
+    }
+
+  for (i = 0;i < sizeof (pad);i++)
+    pad[i] = key[i] ^ 0x5c;
+  if (sha256)
+    {
+      SHA256_Init(&hkey->outer.sha256);
+      SHA256_Update(&hkey->outer.sha256, pad, sizeof (pad));
+    }
+  else
+    {
+      SHA1_Init(&hkey->outer.sha1);
+      SHA1_Update(&hkey->outer.sha1, pad, sizeof (pad));
+    }
+}
+
+/**
+ * compute the HMAC of data with a prepared key
+ *
+ * @param hkey
+ * @param data_buf
+ * @param data_len
+ * @param digest_buf
+ *
+ * @return digest_len
+ */
+unsigned int
+dpl_hmac_key_sign(const dpl_hmac_key_t *hkey,
+                  const char *data_buf,
+                  unsigned int data_len,
+                  char *digest_buf)
+{
+  if (hkey->sha256)
+    {
+      SHA256_CTX ctx;
+
+      ctx = hkey->inner.sha256;
+      SHA256_Update(&ctx, data_buf, data_len);
+      SHA256_Final((u_char *) digest_buf, &ctx);
+
+      ctx = hkey->outer.sha256;
+      SHA256_Update(&ctx, digest_buf, SHA256_DIGEST_LENGTH);
+      SHA256_Final((u_char *) digest_buf, &ctx);
+
+      return SHA256_DIGEST_LENGTH;
+    }
+  else
+    {
+      SHA_CTX ctx;
+
+      ctx = hkey->inner.sha1;
+      SHA1_Update(&ctx, data_buf, data_len);
+      SHA1_Final((u_char *) digest_buf, &ctx);
+
+      ctx = hkey->outer.sha1;
+      SHA1_Update(&ctx, digest_buf, SHA_DIGEST_LENGTH);
+      SHA1_Final((u_char *) digest_buf, &ctx);
+
+      return SHA_DIGEST_LENGTH;
+    }
+}
+
 /**/
 
 static const char *base = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2010 SCALITY SA. All rights reserved.
+ * http://www.scality.com
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY SCALITY SA ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SCALITY SA OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * official policies, either expressed or implied, of SCALITY SA.
+ *
+ * https://github.com/scality/Droplet
+ */
+#include "dropletp.h"
+
+/** @file */
+
+/*
+ * Snapshots of the current bucket and of the working directories
+ * (ctx->cur_bucket and ctx->cwds), through which VFS calls resolve
+ * relative locators without taking the context lock.
+ *
+ * Snapshots are immutable. Writers, serialized by the context lock,
+ * publish a new one and retire the previous one, which is freed once no
+ * reader is left: readers register in ctx->vdir_readers before loading
+ * the snapshot pointer, so a writer seeing no reader after publishing
+ * knows that nobody can still hold a retired snapshot.
+ */
+
+struct dpl_vdir
+{
+  struct dpl_vdir *next;        /*!< retired list */
+  char *cur_bucket;
+  dpl_dict_t *cwds;
+};
+
+static void
+vdir_free(struct dpl_vdir *vdir)
+{
+  free(vdir->cur_bucket);
+  if (NULL != vdir->cwds)
+    dpl_dict_free(vdir->cwds);
+  free(vdir);
+}
+
+/*
+ * ctx->cur_bucket may be assigned by the application, possibly to a
+ * string reusing the address of the previous one, so it is compared by
+ * value
+ */
+static int
+vdir_is_current(const struct dpl_vdir *vdir,
+                const dpl_ctx_t *ctx)
+{
+  return NULL != vdir &&
+    !strcmp(vdir->cur_bucket, NULL != ctx->cur_bucket ? ctx->cur_bucket : "");
+}
+
+/*
+ * free the retired snapshots if nobody reads any, context lock held
+ */
+static void
+vdir_reclaim(dpl_ctx_t *ctx)
+{
+  struct dpl_vdir *vdir;
+
+  if (0 != __sync_fetch_and_add(&ctx->vdir_readers, 0))
+    return ;
+
+  while (NULL != (vdir = ctx->vdir_retired))
+    {
+      ctx->vdir_retired = vdir->next;
+      vdir_free(vdir);
+    }
+}
+
+dpl_status_t
+dpl_vdir_init(dpl_ctx_t *ctx)
+{
+  ctx->vdir = NULL;
+  ctx->vdir_retired = NULL;
+  ctx->vdir_readers = 0;
+
+  return dpl_vdir_publish(ctx);
+}
+
+void
+dpl_vdir_free(dpl_ctx_t *ctx)
+{
+  struct dpl_vdir *vdir;
+
+  if (NULL != ctx->vdir)
+    {
+      vdir_free(ctx->vdir);
+      ctx->vdir = NULL;
+    }
+
+  while (NULL != (vdir = ctx->vdir_retired))
+    {
+      ctx->vdir_retired = vdir->next;
+      vdir_free(vdir);
+    }
+}
+
+/**
+ * make the current values of ctx->cur_bucket and ctx->cwds visible to
+ * the readers, with the context lock held
+ *
+ * @param ctx
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_ENOMEM
+ */
+dpl_status_t
+dpl_vdir_publish(dpl_ctx_t *ctx)
+{
+  struct dpl_vdir *vdir, *old;
+
+  vdir = calloc(1, sizeof (*vdir));
+  if (NULL == vdir)
+    return DPL_ENOMEM;
+
+  vdir->cur_bucket = strdup(NULL != ctx->cur_bucket ? ctx->cur_bucket : "");
+  vdir->cwds = (NULL != ctx->cwds) ? dpl_dict_dup(ctx->cwds) : dpl_dict_new(13);
+  if (NULL == vdir->cur_bucket || NULL == vdir->cwds)
+    {
+      vdir_free(vdir);
+      return DPL_ENOMEM;
+    }
+
+  old = ctx->vdir;
+  __sync_synchronize();
+  ctx->vdir = vdir;
+  __sync_synchronize();
+
+  if (NULL != old)
+    {
+      old->next = ctx->vdir_retired;
+      ctx->vdir_retired = old;
+    }
+
+  vdir_reclaim(ctx);
+
+  return DPL_SUCCESS;
+}
+
+/**
+ * get the current snapshot, to be released with dpl_vdir_release()
+ *
+ * @param ctx
+ *
+ * @return the snapshot, NULL if out of memory (still to be released)
+ */
+struct dpl_vdir *
+dpl_vdir_acquire(dpl_ctx_t *ctx)
+{
+  struct dpl_vdir *vdir;
+
+  __sync_fetch_and_add(&ctx->vdir_readers, 1);
+  vdir = *(struct dpl_vdir * volatile *) &ctx->vdir;
+
+  //ctx->cur_bucket was assigned by the application
+  if (!vdir_is_current(vdir, ctx))
+    {
+      __sync_fetch_and_sub(&ctx->vdir_readers, 1);
+
+      dpl_ctx_lock(ctx);
+      if (!vdir_is_current(ctx->vdir, ctx))
+        (void) dpl_vdir_publish(ctx);
+      __sync_fetch_and_add(&ctx->vdir_readers, 1);
+      vdir = ctx->vdir;
+      dpl_ctx_unlock(ctx);
+    }
+
+  return vdir;
+}
+
+void
+dpl_vdir_release(dpl_ctx_t *ctx,
+                 struct dpl_vdir *vdir)
+{
+  __sync_fetch_and_sub(&ctx->vdir_readers, 1);
+}
+
+const char *
+dpl_vdir_cur_bucket(const struct dpl_vdir *vdir)
+{
+  return vdir->cur_bucket;
+}
+
+/**
+ * @return the working directory of bucket, NULL if not set
+ */
+const char *
+dpl_vdir_cwd(const struct dpl_vdir *vdir,
+             const char *bucket)
+{
+  dpl_dict_var_t *var;
+
+  var = dpl_dict_get(vdir->cwds, bucket);
+  if (NULL == var)
+    return NULL;
+
+  assert(var->val->type == DPL_VALUE_STRING);
+
+  return dpl_sbuf_get_str(var->val->string);
+}
@@ -33,6 +33,7 @@
  */
 #include "dropletp.h"
 #include "droplet/vfs.h"
+#include "droplet/parallel.h"
 
 /** @file */
 
@@ -55,6 +56,8 @@ dir_lookup(dpl_ctx_t *ctx,
   dpl_ftype_t obj_type;
   int obj_name_len = strlen(obj_name);
   char *skip_slashes;
+  int cache;
+  int found = 0;
 
   memset(&obj_fqn, 0, sizeof (obj_fqn));
 
@@ -123,6 +126,12 @@ dir_lookup(dpl_ctx_t *ctx,
       goto end;
     }
 
+  if (dpl_dcache_lookup(ctx, bucket, parent_fqn.path, obj_name, obj_fqnp, obj_typep, &ret))
+    goto end;
+
+  //on a miss, a single listing fills the cache for all the siblings
+  cache = dpl_dcache_enabled(ctx);
+
   skip_slashes = parent_fqn.path;
   while ('/' == *skip_slashes)
     ++skip_slashes;
@@ -168,6 +177,19 @@ dir_lookup(dpl_ctx_t *ctx,
 
       path_len = p - p2 + 1;
 
+      if (cache && path_len > 0 && path_len < DPL_MAXNAMLEN &&
+          strlen(prefix->prefix) < DPL_MAXNAMLEN)
+        {
+          char name[DPL_MAXNAMLEN];
+
+          memcpy(name, p2, path_len);
+          name[path_len] = 0;
+          dpl_dcache_insert(ctx, bucket, parent_fqn.path, name, prefix->prefix, DPL_FTYPE_DIR);
+        }
+
+      if (found)
+        continue ;
+
       DPRINTF("cmp (prefix=%s) prefix=%.*s obj_name=%s\n", prefix->prefix, path_len, p2, obj_name);
 
       if (path_len == obj_name_len && !memcmp(p2, obj_name, obj_name_len))
@@ -184,15 +206,10 @@ dir_lookup(dpl_ctx_t *ctx,
           memcpy(obj_fqn.path, prefix->prefix, path_len);
           obj_fqn.path[path_len] = 0;
           obj_type = DPL_FTYPE_DIR;
+          found = 1;
 
-          if (NULL != obj_fqnp)
-            *obj_fqnp = obj_fqn;
-
-          if (NULL != obj_typep)
-            *obj_typep = obj_type;
-
-          ret = DPL_SUCCESS;
-          goto end;
+          if (!cache)
+            break ;
         }
     }
 
@@ -201,6 +218,10 @@ dir_lookup(dpl_ctx_t *ctx,
       dpl_object_t *obj = (dpl_object_t *) dpl_vec_get(files, i);
       int path_len;
       char *p;
+      dpl_ftype_t type;
+
+      if (found && !cache)
+        break ;
 
       p = rindex(obj->path, '/');
       if (NULL != p)
@@ -208,13 +229,24 @@ dir_lookup(dpl_ctx_t *ctx,
       else
         p = obj->path;
 
+      path_len = strlen(obj->path);
+      if (path_len >= 1 && *(obj->path + path_len - 1) == '/')
+        type = DPL_FTYPE_DIR;
+      else
+        type = DPL_FTYPE_REG;
+
+      if (cache && *p && path_len < DPL_MAXNAMLEN)
+        dpl_dcache_insert(ctx, bucket, parent_fqn.path, p, obj->path, type);
+
+      if (found)
+        continue ;
+
       DPRINTF("cmp obj_path=%s obj_name=%s\n", p, obj_name);
 
       if (!strcmp(p, obj_name))
         {
           DPRINTF("ok\n");
 
-          path_len = strlen(obj->path);
           if (path_len >= DPL_MAXNAMLEN)
             {
               DPL_TRACE(ctx, DPL_TRACE_ERR, "path is too long");
@@ -223,22 +255,26 @@ dir_lookup(dpl_ctx_t *ctx,
             }
           memcpy(obj_fqn.path, obj->path, path_len);
           obj_fqn.path[path_len] = 0;
-          if (path_len >= 1 && *(obj->path + path_len - 1) == '/')
-            obj_type = DPL_FTYPE_DIR;
-          else
-            obj_type = DPL_FTYPE_REG;
+          obj_type = type;
+          found = 1;
+        }
+    }
 
-          if (NULL != obj_fqnp)
-            *obj_fqnp = obj_fqn;
+  if (found)
+    {
+      if (NULL != obj_fqnp)
+        *obj_fqnp = obj_fqn;
 
-          if (NULL != obj_typep)
-            *obj_typep = obj_type;
+      if (NULL != obj_typep)
+        *obj_typep = obj_type;
 
-          ret = DPL_SUCCESS;
-          goto end;
-        }
+      ret = DPL_SUCCESS;
+      goto end;
     }
 
+  if (cache)
+    dpl_dcache_insert(ctx, bucket, parent_fqn.path, obj_name, NULL, DPL_FTYPE_UNDEF);
+
   ret = DPL_ENOENT;
 
  end:
@@ -254,6 +290,158 @@ dir_lookup(dpl_ctx_t *ctx,
   return ret;
 }
 
+/*
+ * directory listings are consumed one page at a time: while the caller
+ * reads a page, the next one is fetched in the background.
+ */
+struct dpl_dir_page
+{
+  dpl_task_t task;
+  dpl_ctx_t *ctx;
+  char *bucket;
+  char *prefix;
+  char *marker;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int done;
+  dpl_status_t ret;
+  dpl_vec_t *files;
+  dpl_vec_t *directories;
+  char *next_marker;
+};
+
+static void
+dir_page_free(struct dpl_dir_page *page)
+{
+  if (NULL != page->files)
+    dpl_vec_objects_free(page->files);
+
+  if (NULL != page->directories)
+    dpl_vec_common_prefixes_free(page->directories);
+
+  free(page->bucket);
+  free(page->prefix);
+  free(page->marker);
+  free(page->next_marker);
+  pthread_mutex_destroy(&page->lock);
+  pthread_cond_destroy(&page->cond);
+  free(page);
+}
+
+static void
+dir_page_fetch(void *handle)
+{
+  struct dpl_dir_page *page = handle;
+  dpl_status_t ret;
+
+  ret = dpl_list_bucket_page(page->ctx, page->bucket, page->prefix, "/", -1,
+                             page->marker, &page->files, &page->directories,
+                             &page->next_marker);
+
+  pthread_mutex_lock(&page->lock);
+  page->ret = ret;
+  page->done = 1;
+  pthread_cond_signal(&page->cond);
+  pthread_mutex_unlock(&page->lock);
+}
+
+/*
+ * start fetching the page following marker
+ */
+static dpl_status_t
+dir_prefetch(dpl_dir_t *dir,
+             const char *marker)
+{
+  struct dpl_dir_page *page;
+  char *skip_slashes;
+
+  page = calloc(1, sizeof (*page));
+  if (NULL == page)
+    return DPL_ENOMEM;
+
+  pthread_mutex_init(&page->lock, NULL);
+  pthread_cond_init(&page->cond, NULL);
+  page->task.func = dir_page_fetch;
+  page->ctx = dir->ctx;
+
+  skip_slashes = dir->fqn.path;
+  while ('/' == *skip_slashes)
+    ++skip_slashes;
+
+  page->bucket = strdup(dir->bucket);
+  page->prefix = strcmp(skip_slashes, "") ? strdup(skip_slashes) : NULL;
+  page->marker = strdup(marker);
+  if (NULL == page->bucket || NULL == page->marker ||
+      (NULL == page->prefix && strcmp(skip_slashes, "")))
+    {
+      dir_page_free(page);
+      return DPL_ENOMEM;
+    }
+
+  if (NULL == dir->pool)
+    {
+      dir->pool = dpl_task_pool_create(dir->ctx, "readdir", 1);
+      if (NULL == dir->pool)
+        {
+          dir_page_free(page);
+          return DPL_ENOMEM;
+        }
+    }
+
+  dir->next_page = page;
+  dpl_task_pool_put(dir->pool, (dpl_task_t *) page);
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * switch to the prefetched page and start fetching the one after
+ */
+static dpl_status_t
+dir_next_page(dpl_dir_t *dir)
+{
+  struct dpl_dir_page *page = dir->next_page;
+  dpl_status_t ret;
+
+  pthread_mutex_lock(&page->lock);
+  while (!page->done)
+    pthread_cond_wait(&page->cond, &page->lock);
+  pthread_mutex_unlock(&page->lock);
+
+  dir->next_page = NULL;
+
+  if (DPL_SUCCESS != page->ret)
+    {
+      DPL_TRACE(dir->ctx, DPL_TRACE_ERR, "list_bucket_page failed %s:%s", page->bucket, page->marker);
+      ret = page->ret;
+      goto end;
+    }
+
+  dpl_vec_objects_free(dir->files);
+  dpl_vec_common_prefixes_free(dir->directories);
+  dir->files = page->files;
+  page->files = NULL;
+  dir->directories = page->directories;
+  page->directories = NULL;
+  dir->files_cursor = 0;
+  dir->directories_cursor = 0;
+
+  if (NULL != page->next_marker)
+    {
+      ret = dir_prefetch(dir, page->next_marker);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  dir_page_free(page);
+
+  return ret;
+}
+
 static dpl_status_t
 dir_open_attrs(dpl_ctx_t *ctx,
                const char *bucket,
@@ -265,6 +453,7 @@ dir_open_attrs(dpl_ctx_t *ctx,
   dpl_dir_t *dir;
   int ret, ret2;
   char *skip_slashes;
+  char *next_marker = NULL;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "opendir bucket=%s fqn=%s", bucket, fqn.path);
 
@@ -280,20 +469,43 @@ dir_open_attrs(dpl_ctx_t *ctx,
   dir->ctx = ctx;
   dir->fqn = fqn;
 
+  dir->bucket = strdup(bucket);
+  if (NULL == dir->bucket)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
   skip_slashes = fqn.path;
   while ('/' == *skip_slashes)
     ++skip_slashes;
 
   //AWS prefers NULL for listing the root dir
-  ret2 = dpl_list_bucket_attrs(ctx,
-                               bucket,
-                               !strcmp(skip_slashes, "") ? NULL : skip_slashes,
-                               "/",
-                               -1,
-                               metadatap,
-                               sysmdp,
-                               &dir->files,
-                               &dir->directories);
+  if (NULL != metadatap || NULL != sysmdp)
+    {
+      //attributes come along with a full listing
+      ret2 = dpl_list_bucket_attrs(ctx,
+                                   bucket,
+                                   !strcmp(skip_slashes, "") ? NULL : skip_slashes,
+                                   "/",
+                                   -1,
+                                   metadatap,
+                                   sysmdp,
+                                   &dir->files,
+                                   &dir->directories);
+    }
+  else
+    {
+      ret2 = dpl_list_bucket_page(ctx,
+                                  bucket,
+                                  !strcmp(skip_slashes, "") ? NULL : skip_slashes,
+                                  "/",
+                                  -1,
+                                  NULL,
+                                  &dir->files,
+                                  &dir->directories,
+                                  &next_marker);
+    }
   if (DPL_SUCCESS != ret2)
     {
       DPL_TRACE(ctx, DPL_TRACE_ERR, "list_bucket failed %s:%s", bucket, skip_slashes);
@@ -301,6 +513,16 @@ dir_open_attrs(dpl_ctx_t *ctx,
       goto end;
     }
 
+  if (NULL != next_marker)
+    {
+      ret2 = dir_prefetch(dir, next_marker);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
   if (NULL != dir_hdlp)
     *dir_hdlp = dir;
 
@@ -310,6 +532,8 @@ dir_open_attrs(dpl_ctx_t *ctx,
 
  end:
 
+  free(next_marker);
+
   if (DPL_SUCCESS != ret)
     {
       if (NULL != dir)
@@ -320,6 +544,7 @@ dir_open_attrs(dpl_ctx_t *ctx,
           if (NULL != dir->directories)
             dpl_vec_common_prefixes_free(dir->directories);
 
+          free(dir->bucket);
           free(dir);
         }
     }
@@ -343,6 +568,17 @@ dir_read(void *dir_hdl,
 
   memset(dirent, 0, sizeof (*dirent));
 
+  while (dir->files_cursor >= dir->files->n_items &&
+         dir->directories_cursor >= dir->directories->n_items &&
+         NULL != dir->next_page)
+    {
+      dpl_status_t ret;
+
+      ret = dir_next_page(dir);
+      if (DPL_SUCCESS != ret)
+        return ret;
+    }
+
   skip_slashes = dir->fqn.path;
   while ('/' == *skip_slashes)
     ++skip_slashes;
@@ -442,7 +678,8 @@ dir_eof(void *dir_hdl)
   dpl_dir_t *dir = (dpl_dir_t *) dir_hdl;
 
   return dir->files_cursor == dir->files->n_items &&
-    dir->directories_cursor == dir->directories->n_items;
+    dir->directories_cursor == dir->directories->n_items &&
+    NULL == dir->next_page;
 }
 
 static void
@@ -454,6 +691,15 @@ dir_close(void *dir_hdl)
     {
       DPL_TRACE(dir->ctx, DPL_TRACE_VFS, "closedir dir_hdl=%p", dir_hdl);
 
+      //waits for a pending prefetch
+      if (dir->pool)
+        dpl_task_pool_destroy(dir->pool);
+
+      if (dir->next_page)
+        dir_page_free(dir->next_page);
+
+      free(dir->bucket);
+
       if (dir->files)
         dpl_vec_objects_free(dir->files);
 
@@ -567,6 +813,79 @@ make_abs_path(dpl_ctx_t *ctx, const char *bucket,
   return ret;
 }
 
+/*
+ * a locator split into its bucket and path without allocating: the
+ * path points into the locator, and the bucket, which would need a
+ * terminator, is copied here from it or from the current bucket
+ */
+struct vfs_locator
+{
+  const char *path;
+  char bucket[DPL_MAXNAMLEN];
+};
+
+static dpl_status_t
+vfs_locator_parse(dpl_ctx_t *ctx,
+                  const char *locator,
+                  struct vfs_locator *loc)
+{
+  struct dpl_vdir *vdir;
+  const char *p;
+  size_t len;
+  dpl_status_t ret;
+
+  p = index(locator, ':');
+  if (NULL != p)
+    {
+      len = p - locator;
+      if (len >= sizeof (loc->bucket))
+        return DPL_ENAMETOOLONG;
+
+      memcpy(loc->bucket, locator, len);
+      loc->bucket[len] = 0;
+      loc->path = p + 1;
+
+      return DPL_SUCCESS;
+    }
+
+  vdir = dpl_vdir_acquire(ctx);
+  if (NULL == vdir)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  len = strlen(dpl_vdir_cur_bucket(vdir));
+  if (len >= sizeof (loc->bucket))
+    {
+      ret = DPL_ENAMETOOLONG;
+      goto end;
+    }
+
+  memcpy(loc->bucket, dpl_vdir_cur_bucket(vdir), len + 1);
+  loc->path = locator;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  dpl_vdir_release(ctx, vdir);
+
+  return ret;
+}
+
+/*
+ * drop the cached view of an object modified through this ctx
+ */
+static void
+vfs_invalidate(dpl_ctx_t *ctx,
+               const char *bucket,
+               const char *path)
+{
+  dpl_dcache_invalidate(ctx, bucket, path);
+  dpl_acache_invalidate(ctx, bucket, path);
+}
+
 static void
 fqn_append_trailing_slash(dpl_fqn_t *obj_fqnp)
 {
@@ -603,17 +922,15 @@ dpl_fqn_t
 dpl_cwd(dpl_ctx_t *ctx,
         const char *bucket)
 {
-  dpl_dict_var_t *var;
+  struct dpl_vdir *vdir;
   dpl_fqn_t cwd;
-  char *p = NULL;
+  const char *p = NULL;
 
-  dpl_ctx_lock(ctx);
-  var = dpl_dict_get(ctx->cwds, bucket);
-  if (NULL != var)
+  vdir = dpl_vdir_acquire(ctx);
+  if (NULL != vdir)
+    p = dpl_vdir_cwd(vdir, bucket);
+  if (NULL != p)
     {
-      assert(var->val->type == DPL_VALUE_STRING);
-      p = dpl_sbuf_get_str(var->val->string);
-
       if (strlen(p) >= sizeof cwd.path - 1)
         {
           // fallback on default value and log
@@ -628,13 +945,14 @@ dpl_cwd(dpl_ctx_t *ctx,
     cwd = DPL_ROOT_FQN;
 
  end:
-  dpl_ctx_unlock(ctx);
+  dpl_vdir_release(ctx, vdir);
 
   return cwd;
 }
 
 static dpl_status_t
 dir_is_empty(dpl_ctx_t *ctx,
+             const char *bucket,
              const char *path)
 {
   dpl_status_t ret;
@@ -645,7 +963,7 @@ dir_is_empty(dpl_ctx_t *ctx,
   DPL_TRACE(ctx, DPL_TRACE_VFS, "dir_is_empty path=%s", path);
 
   /* since dir_is_empty(<directory>) returns at least 1 common_prefix (itself), ask for two... */
-  ret2 = dpl_list_bucket(ctx, ctx->cur_bucket, path, "/", 10, &objects, &common_prefixes);
+  ret2 = dpl_list_bucket(ctx, bucket, path, "/", 10, &objects, &common_prefixes);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -689,44 +1007,18 @@ dpl_opendir_attrs(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "opendir locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -735,10 +1027,10 @@ dpl_opendir_attrs(dpl_ctx_t *ctx,
 
   fqn_append_trailing_slash(&obj_fqn);
 
-  ret2 = dir_open_attrs(ctx, bucket, obj_fqn, metadatap, sysmdp, dir_hdlp);
+  ret2 = dir_open_attrs(ctx, loc.bucket, obj_fqn, metadatap, sysmdp, dir_hdlp);
   if (DPL_SUCCESS != ret2)
     {
-      DPL_TRACE(ctx, DPL_TRACE_ERR, "unable to open %s:%s", bucket, obj_fqn.path);
+      DPL_TRACE(ctx, DPL_TRACE_ERR, "unable to open %s:%s", loc.bucket, obj_fqn.path);
       ret = ret2;
       goto end;
     }
@@ -747,12 +1039,6 @@ dpl_opendir_attrs(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -829,134 +1115,2097 @@ dpl_iterate(dpl_ctx_t *ctx,
   return ret;
 }
 
-dpl_status_t
-dpl_chdir(dpl_ctx_t *ctx,
-          const char *locator)
+/*
+ * walk
+ */
+
+struct walk
 {
-  int ret, ret2;
-  dpl_fqn_t obj_fqn, tmp_fqn;
-  char *nlocator = NULL;
-  char *nbucket;
-  char *path;
-  char *bucket = NULL;
-  dpl_sysmd_t sysmd;
+  dpl_ctx_t *ctx;
+  const char *bucket;
+  dpl_walk_flag_t flags;
+  int max_depth;
+  char *filter;                 /*!< absolute prefix filter, NULL for none */
+  dpl_walk_func_t cb;
+  void *cb_arg;
+  dpl_task_pool_t *pool;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_mutex_t cb_lock;      /*!< serializes callbacks */
+  int n_pending;                /*!< directories queued or being listed */
+  dpl_status_t ret;
+};
 
-  DPL_TRACE(ctx, DPL_TRACE_VFS, "chdir locator=%s", locator);
+struct walk_dir
+{
+  dpl_task_t task;
+  struct walk *walk;
+  struct walk_dir *parent;
+  int refs;                     /*!< own listing + children not yet done */
+  int depth;
+  int report;                   /*!< directory matches the filter */
+  dpl_dirent_t dirent;
+};
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
+static int
+walk_failed(struct walk *walk)
+{
+  int failed;
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
+  pthread_mutex_lock(&walk->lock);
+  failed = (DPL_SUCCESS != walk->ret);
+  pthread_mutex_unlock(&walk->lock);
 
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
-  if (DPL_SUCCESS != ret2)
-    {
-      ret = ret2;
-      goto end;
-    }
+  return failed;
+}
 
-  fqn_append_trailing_slash(&obj_fqn);
+static void
+walk_fail(struct walk *walk,
+          dpl_status_t ret)
+{
+  pthread_mutex_lock(&walk->lock);
+  if (DPL_SUCCESS == walk->ret)
+    walk->ret = ret;
+  pthread_mutex_unlock(&walk->lock);
+}
 
-  dpl_ctx_lock(ctx);
-  if (strcmp(bucket, ctx->cur_bucket))
-    {
-      nbucket = strdup(bucket);
-      if (NULL == nbucket)
-        {
-          dpl_ctx_unlock(ctx);
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      free(ctx->cur_bucket);
-      ctx->cur_bucket = nbucket;
-    }
-  dpl_ctx_unlock(ctx);
+static int
+walk_callback(struct walk *walk,
+              dpl_dirent_t *dirent,
+              int depth,
+              dpl_walk_visit_t visit)
+{
+  int ret;
 
-  //recheck obj_type: append delim at the end of object to be compatible with all backend
-  tmp_fqn = obj_fqn;
+  pthread_mutex_lock(&walk->cb_lock);
+  ret = walk->cb(dirent, depth, visit, walk->cb_arg);
+  pthread_mutex_unlock(&walk->cb_lock);
 
-  if (strcmp(tmp_fqn.path, ""))
-    {
-      int len = strlen(tmp_fqn.path);
+  if (-1 == ret)
+    walk_fail(walk, DPL_FAILURE);
 
-      //append delim if not present
-      if (len >= 1 && *(tmp_fqn.path + len - 1) != '/')
-        strcat(tmp_fqn.path, "/");
+  return ret;
+}
+
+/*
+ * does fqn match the filter (match) or may something below it (descend)
+ */
+static int
+walk_filter(struct walk *walk,
+            const char *fqn,
+            int *descendp)
+{
+  size_t fqn_len, filter_len;
+
+  if (NULL == walk->filter)
+    {
+      if (NULL != descendp)
+        *descendp = 1;
+      return 1;
+    }
+
+  fqn_len = strlen(fqn);
+  filter_len = strlen(walk->filter);
+
+  if (NULL != descendp)
+    *descendp = !strncmp(fqn, walk->filter, fqn_len < filter_len ? fqn_len : filter_len);
+
+  return fqn_len >= filter_len && !strncmp(fqn, walk->filter, filter_len);
+}
+
+/*
+ * drop a reference on a directory, reporting it in post-order once its
+ * listing and all its subdirectories are done
+ */
+static void
+walk_dir_release(struct walk_dir *wdir)
+{
+  struct walk *walk = wdir->walk;
+  struct walk_dir *parent;
+  int refs;
+
+  while (NULL != wdir)
+    {
+      pthread_mutex_lock(&walk->lock);
+      refs = --wdir->refs;
+      pthread_mutex_unlock(&walk->lock);
+
+      if (refs > 0)
+        return ;
+
+      if (NULL != wdir->parent && wdir->report &&
+          (walk->flags & DPL_WALK_POSTORDER) && !walk_failed(walk))
+        (void) walk_callback(walk, &wdir->dirent, wdir->depth, DPL_WALK_VISIT_POST);
+
+      parent = wdir->parent;
+      free(wdir);
+      wdir = parent;
+    }
+}
+
+static void walk_dir_do(void *handle);
+
+static dpl_status_t
+walk_dir_spawn(struct walk *walk,
+               struct walk_dir *parent,
+               const dpl_dirent_t *dirent,
+               int report)
+{
+  struct walk_dir *wdir;
+
+  wdir = calloc(1, sizeof (*wdir));
+  if (NULL == wdir)
+    return DPL_ENOMEM;
+
+  wdir->task.func = walk_dir_do;
+  wdir->walk = walk;
+  wdir->parent = parent;
+  wdir->refs = 1;
+  wdir->report = report;
+  wdir->dirent = *dirent;
+  wdir->depth = (NULL != parent) ? parent->depth + 1 : 0;
+
+  pthread_mutex_lock(&walk->lock);
+  if (NULL != parent)
+    parent->refs++;
+  walk->n_pending++;
+  pthread_mutex_unlock(&walk->lock);
+
+  dpl_task_pool_put(walk->pool, (dpl_task_t *) wdir);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+walk_dir_list(struct walk_dir *wdir)
+{
+  struct walk *walk = wdir->walk;
+  dpl_vec_t *files = NULL;
+  dpl_vec_t *directories = NULL;
+  char *marker = NULL;
+  char *next_marker = NULL;
+  const char *dir_path, *list_prefix;
+  size_t dir_len;
+  dpl_dirent_t dirent;
+  int i, descend, report;
+  int preorder;
+  dpl_status_t ret, ret2;
+
+  preorder = (walk->flags & DPL_WALK_PREORDER) || !(walk->flags & DPL_WALK_POSTORDER);
+
+  dir_path = wdir->dirent.fqn.path;
+  while ('/' == *dir_path)
+    ++dir_path;
+  dir_len = strlen(dir_path);
+
+  //let the server apply the part of the filter naming entries of this directory
+  list_prefix = dir_path;
+  if (NULL != walk->filter && strlen(walk->filter) > dir_len &&
+      !strncmp(walk->filter, dir_path, dir_len) &&
+      NULL == index(walk->filter + dir_len, '/'))
+    list_prefix = walk->filter;
+
+  do
+    {
+      //AWS prefers NULL for listing the root dir
+      ret2 = dpl_list_bucket_page(walk->ctx, walk->bucket,
+                                  !strcmp(list_prefix, "") ? NULL : list_prefix,
+                                  "/", -1, marker, &files, &directories, &next_marker);
+      if (DPL_SUCCESS != ret2)
+        {
+          DPL_TRACE(walk->ctx, DPL_TRACE_ERR, "list_bucket failed %s:%s", walk->bucket, list_prefix);
+          ret = ret2;
+          goto end;
+        }
+
+      for (i = 0;i < directories->n_items && !walk_failed(walk);i++)
+        {
+          dpl_common_prefix_t *prefix = (dpl_common_prefix_t *) dpl_vec_get(directories, i);
+          size_t path_len = strlen(prefix->prefix);
+          size_t name_len;
+
+          if (path_len <= dir_len + 1 || path_len >= DPL_MAXPATHLEN)
+            continue ;
+
+          name_len = path_len - dir_len - 1; //without the trailing slash
+          if (name_len >= DPL_MAXNAMLEN)
+            continue ;
+
+          memset(&dirent, 0, sizeof (dirent));
+          memcpy(dirent.name, prefix->prefix + dir_len, name_len);
+          dirent.name[name_len] = 0;
+          memcpy(dirent.fqn.path, prefix->prefix, path_len);
+          dirent.fqn.path[path_len] = 0;
+          dirent.type = DPL_FTYPE_DIR;
+
+          report = walk_filter(walk, dirent.fqn.path, &descend);
+          if (walk->max_depth >= 0 && wdir->depth + 1 >= walk->max_depth)
+            descend = 0;
+
+          if (report && preorder)
+            {
+              if (0 != walk_callback(walk, &dirent, wdir->depth + 1, DPL_WALK_VISIT_PRE))
+                continue ;
+            }
+
+          if (descend)
+            {
+              ret2 = walk_dir_spawn(walk, wdir, &dirent, report);
+              if (DPL_SUCCESS != ret2)
+                {
+                  ret = ret2;
+                  goto end;
+                }
+            }
+          else if (report && (walk->flags & DPL_WALK_POSTORDER))
+            {
+              (void) walk_callback(walk, &dirent, wdir->depth + 1, DPL_WALK_VISIT_POST);
+            }
+        }
+
+      for (i = 0;i < files->n_items && !walk_failed(walk);i++)
+        {
+          dpl_object_t *obj = (dpl_object_t *) dpl_vec_get(files, i);
+          size_t path_len = strlen(obj->path);
+          size_t name_len;
+
+          //the directory object itself
+          if (path_len <= dir_len || path_len >= DPL_MAXPATHLEN)
+            continue ;
+
+          name_len = path_len - dir_len;
+          if (name_len >= DPL_MAXNAMLEN)
+            continue ;
+
+          if (!walk_filter(walk, obj->path, NULL))
+            continue ;
+
+          memset(&dirent, 0, sizeof (dirent));
+          memcpy(dirent.name, obj->path + dir_len, name_len);
+          dirent.name[name_len] = 0;
+          memcpy(dirent.fqn.path, obj->path, path_len);
+          dirent.fqn.path[path_len] = 0;
+          dirent.type = obj->type;
+          if (DPL_FTYPE_UNDEF == dirent.type)
+            dirent.type = DPL_FTYPE_REG;
+          dirent.last_modified = obj->last_modified;
+          dirent.size = obj->size;
+
+          (void) walk_callback(walk, &dirent, wdir->depth + 1, DPL_WALK_VISIT_FILE);
+        }
+
+      dpl_vec_objects_free(files);
+      files = NULL;
+      dpl_vec_common_prefixes_free(directories);
+      directories = NULL;
+
+      free(marker);
+      marker = next_marker;
+      next_marker = NULL;
+    }
+  while (NULL != marker && !walk_failed(walk));
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(marker);
+  free(next_marker);
+
+  if (NULL != files)
+    dpl_vec_objects_free(files);
+
+  if (NULL != directories)
+    dpl_vec_common_prefixes_free(directories);
+
+  return ret;
+}
+
+static void
+walk_dir_do(void *handle)
+{
+  struct walk_dir *wdir = handle;
+  struct walk *walk = wdir->walk;
+  dpl_status_t ret;
+
+  if (!walk_failed(walk))
+    {
+      ret = walk_dir_list(wdir);
+      if (DPL_SUCCESS != ret)
+        walk_fail(walk, ret);
+    }
+
+  walk_dir_release(wdir);
+
+  pthread_mutex_lock(&walk->lock);
+  walk->n_pending--;
+  if (0 == walk->n_pending)
+    pthread_cond_signal(&walk->cond);
+  pthread_mutex_unlock(&walk->lock);
+}
+
+/*
+ * flat walk: the whole subtree is listed as a single prefix scan
+ * without delimiter, and directories are synthesized from the keys.
+ * Keys sharing a prefix are contiguous in a listing, so a directory is
+ * complete as soon as a key outside of it shows up.
+ */
+
+struct flat_dir
+{
+  size_t len;                   /*!< length of its fqn */
+  int depth;
+  int report;
+  int skip;                     /*!< content not reported */
+};
+
+struct flat_walk
+{
+  struct walk *walk;
+  struct flat_dir *stack;
+  int n_stack;
+  int stack_size;
+  char path[DPL_MAXPATHLEN];    /*!< fqn of the innermost open directory */
+};
+
+static void
+flat_dirent(struct flat_walk *flat,
+            dpl_dirent_t *dirent)
+{
+  struct flat_dir *fdir = &flat->stack[flat->n_stack - 1];
+  struct flat_dir *parent = &flat->stack[flat->n_stack - 2];
+  size_t name_len;
+
+  memset(dirent, 0, sizeof (*dirent));
+  name_len = fdir->len - parent->len - 1;
+  if (name_len >= DPL_MAXNAMLEN)
+    name_len = DPL_MAXNAMLEN - 1;
+  memcpy(dirent->name, flat->path + parent->len, name_len);
+  dirent->name[name_len] = 0;
+  memcpy(dirent->fqn.path, flat->path, fdir->len);
+  dirent->fqn.path[fdir->len] = 0;
+  dirent->type = DPL_FTYPE_DIR;
+}
+
+static dpl_status_t
+flat_open(struct flat_walk *flat,
+          const char *key,
+          size_t len)
+{
+  struct walk *walk = flat->walk;
+  struct flat_dir *parent, *fdir;
+  dpl_dirent_t dirent;
+  int preorder;
+
+  if (flat->n_stack == flat->stack_size)
+    {
+      struct flat_dir *stack;
+      int stack_size = flat->stack_size * 2;
+
+      stack = realloc(flat->stack, stack_size * sizeof (*stack));
+      if (NULL == stack)
+        return DPL_ENOMEM;
+      flat->stack = stack;
+      flat->stack_size = stack_size;
+    }
+
+  parent = &flat->stack[flat->n_stack - 1];
+  fdir = &flat->stack[flat->n_stack++];
+
+  memcpy(flat->path + parent->len, key + parent->len, len - parent->len);
+  fdir->len = len;
+  fdir->depth = parent->depth + 1;
+  fdir->skip = parent->skip || (walk->max_depth >= 0 && fdir->depth >= walk->max_depth);
+  fdir->report = !parent->skip && walk_filter(walk, key, NULL) &&
+    (walk->max_depth < 0 || fdir->depth <= walk->max_depth);
+
+  preorder = (walk->flags & DPL_WALK_PREORDER) || !(walk->flags & DPL_WALK_POSTORDER);
+
+  if (fdir->report && preorder)
+    {
+      flat_dirent(flat, &dirent);
+      if (0 != walk_callback(walk, &dirent, fdir->depth, DPL_WALK_VISIT_PRE))
+        {
+          //pruned
+          fdir->report = 0;
+          fdir->skip = 1;
+        }
+    }
+
+  return DPL_SUCCESS;
+}
+
+static void
+flat_close(struct flat_walk *flat)
+{
+  struct walk *walk = flat->walk;
+  struct flat_dir *fdir = &flat->stack[flat->n_stack - 1];
+  dpl_dirent_t dirent;
+
+  if (fdir->report && (walk->flags & DPL_WALK_POSTORDER) && !walk_failed(walk))
+    {
+      flat_dirent(flat, &dirent);
+      (void) walk_callback(walk, &dirent, fdir->depth, DPL_WALK_VISIT_POST);
+    }
+
+  flat->n_stack--;
+}
+
+static dpl_status_t
+flat_object(struct flat_walk *flat,
+            dpl_object_t *obj)
+{
+  struct walk *walk = flat->walk;
+  struct flat_dir *fdir;
+  dpl_dirent_t dirent;
+  size_t key_len = strlen(obj->path);
+  const char *p, *slash;
+  dpl_status_t ret;
+  int depth;
+
+  if (key_len >= DPL_MAXPATHLEN ||
+      strncmp(obj->path, flat->path, flat->stack[0].len))
+    return DPL_SUCCESS;
+
+  while (flat->n_stack > 1 &&
+         strncmp(obj->path, flat->path, flat->stack[flat->n_stack - 1].len))
+    flat_close(flat);
+
+  for (p = obj->path + flat->stack[flat->n_stack - 1].len;
+       NULL != (slash = index(p, '/'));
+       p = slash + 1)
+    {
+      ret = flat_open(flat, obj->path, slash - obj->path + 1);
+      if (DPL_SUCCESS != ret)
+        return ret;
+    }
+
+  //a directory object
+  if ('/' == obj->path[key_len - 1])
+    return DPL_SUCCESS;
+
+  fdir = &flat->stack[flat->n_stack - 1];
+  depth = fdir->depth + 1;
+  if (fdir->skip || key_len - fdir->len >= DPL_MAXNAMLEN ||
+      !walk_filter(walk, obj->path, NULL))
+    return DPL_SUCCESS;
+
+  memset(&dirent, 0, sizeof (dirent));
+  memcpy(dirent.name, obj->path + fdir->len, key_len - fdir->len);
+  dirent.name[key_len - fdir->len] = 0;
+  memcpy(dirent.fqn.path, obj->path, key_len);
+  dirent.fqn.path[key_len] = 0;
+  dirent.type = obj->type;
+  if (DPL_FTYPE_UNDEF == dirent.type)
+    dirent.type = DPL_FTYPE_REG;
+  dirent.last_modified = obj->last_modified;
+  dirent.size = obj->size;
+
+  (void) walk_callback(walk, &dirent, depth, DPL_WALK_VISIT_FILE);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+walk_flat(struct walk *walk,
+          const char *root_path)
+{
+  struct flat_walk flat;
+  dpl_vec_t *files = NULL;
+  dpl_vec_t *directories = NULL;
+  char *marker = NULL;
+  char *next_marker = NULL;
+  const char *scan_prefix;
+  int i;
+  dpl_status_t ret, ret2;
+
+  memset(&flat, 0, sizeof (flat));
+  flat.walk = walk;
+  flat.stack_size = 16;
+  flat.stack = malloc(flat.stack_size * sizeof (*flat.stack));
+  if (NULL == flat.stack)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  strcpy(flat.path, root_path);
+  flat.stack[0].len = strlen(root_path);
+  flat.stack[0].depth = 0;
+  flat.stack[0].report = 0;
+  flat.stack[0].skip = 0;
+  flat.n_stack = 1;
+
+  scan_prefix = (NULL != walk->filter) ? walk->filter : root_path;
+
+  do
+    {
+      ret2 = dpl_list_bucket_page(walk->ctx, walk->bucket,
+                                  !strcmp(scan_prefix, "") ? NULL : scan_prefix,
+                                  NULL, -1, marker, &files, &directories, &next_marker);
+      if (DPL_SUCCESS != ret2)
+        {
+          DPL_TRACE(walk->ctx, DPL_TRACE_ERR, "list_bucket failed %s:%s", walk->bucket, scan_prefix);
+          ret = ret2;
+          goto end;
+        }
+
+      for (i = 0;i < files->n_items && !walk_failed(walk);i++)
+        {
+          ret2 = flat_object(&flat, (dpl_object_t *) dpl_vec_get(files, i));
+          if (DPL_SUCCESS != ret2)
+            {
+              ret = ret2;
+              goto end;
+            }
+        }
+
+      dpl_vec_objects_free(files);
+      files = NULL;
+      dpl_vec_common_prefixes_free(directories);
+      directories = NULL;
+
+      free(marker);
+      marker = next_marker;
+      next_marker = NULL;
+    }
+  while (NULL != marker && !walk_failed(walk));
+
+  while (flat.n_stack > 1)
+    flat_close(&flat);
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  free(flat.stack);
+  free(marker);
+  free(next_marker);
+
+  if (NULL != files)
+    dpl_vec_objects_free(files);
+
+  if (NULL != directories)
+    dpl_vec_common_prefixes_free(directories);
+
+  return ret;
+}
+
+/**
+ * walk a directory tree, listing subdirectories concurrently
+ *
+ * the current directory is used to resolve root but never changed.
+ * Entries of a directory are reported in listing order, but the
+ * directories themselves are listed in no particular order.
+ *
+ * With DPL_WALK_FLAT the tree is listed by a single scan in the caller
+ * thread, and reported in depth-first order, provided the backend can
+ * list without a delimiter; otherwise the flag is ignored.
+ *
+ * @param ctx
+ * @param root [bucket:]path
+ * @param flags DPL_WALK_PREORDER, DPL_WALK_POSTORDER, DPL_WALK_FLAT
+ * @param params depth limit and prefix filter, may be NULL
+ * @param cb called for each entry, never concurrently
+ * @param cb_arg
+ * @param n_parallel number of concurrent listings
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE if the callback aborted the walk
+ */
+dpl_status_t
+dpl_walk(dpl_ctx_t *ctx,
+         const char *root,
+         dpl_walk_flag_t flags,
+         const dpl_walk_params_t *params,
+         dpl_walk_func_t cb,
+         void *cb_arg,
+         int n_parallel)
+{
+  dpl_status_t ret, ret2;
+  struct walk walk;
+  struct vfs_locator loc;
+  dpl_fqn_t root_fqn;
+  char *skip_slashes;
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "walk root=%s flags=0x%x n_parallel=%d", root, flags, n_parallel);
+
+  memset(&walk, 0, sizeof (walk));
+  pthread_mutex_init(&walk.lock, NULL);
+  pthread_cond_init(&walk.cond, NULL);
+  pthread_mutex_init(&walk.cb_lock, NULL);
+  walk.ctx = ctx;
+  walk.flags = flags;
+  walk.max_depth = (NULL != params) ? params->max_depth : -1;
+  walk.cb = cb;
+  walk.cb_arg = cb_arg;
+  walk.ret = DPL_SUCCESS;
+
+  if (NULL == cb || 0 == walk.max_depth)
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  if (n_parallel <= 0)
+    n_parallel = DPL_TASK_DEFAULT_N_WORKERS;
+
+  ret2 = vfs_locator_parse(ctx, root, &loc);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  walk.bucket = loc.bucket;
+
+  ret2 = make_abs_path(ctx, walk.bucket, loc.path, &root_fqn);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  fqn_append_trailing_slash(&root_fqn);
+
+  skip_slashes = root_fqn.path;
+  while ('/' == *skip_slashes)
+    ++skip_slashes;
+  memmove(root_fqn.path, skip_slashes, strlen(skip_slashes) + 1);
+
+  if (NULL != params && NULL != params->prefix && 0 != params->prefix[0])
+    {
+      walk.filter = malloc(strlen(root_fqn.path) + strlen(params->prefix) + 1);
+      if (NULL == walk.filter)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      strcpy(walk.filter, root_fqn.path);
+      strcat(walk.filter, params->prefix);
+    }
+
+  if ((flags & DPL_WALK_FLAT) && NULL != ctx->backend->list_bucket_page)
+    {
+      ret2 = walk_flat(&walk, root_fqn.path);
+      if (DPL_SUCCESS != ret2)
+        walk_fail(&walk, ret2);
+      ret = walk.ret;
+      goto end;
+    }
+
+  walk.pool = dpl_task_pool_create(ctx, "walk", n_parallel);
+  if (NULL == walk.pool)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  {
+    dpl_dirent_t root_dirent;
+
+    memset(&root_dirent, 0, sizeof (root_dirent));
+    root_dirent.fqn = root_fqn;
+    root_dirent.type = DPL_FTYPE_DIR;
+
+    ret2 = walk_dir_spawn(&walk, NULL, &root_dirent, 0);
+    if (DPL_SUCCESS != ret2)
+      {
+        ret = ret2;
+        goto end;
+      }
+  }
+
+  pthread_mutex_lock(&walk.lock);
+  while (walk.n_pending > 0)
+    pthread_cond_wait(&walk.cond, &walk.lock);
+  ret = walk.ret;
+  pthread_mutex_unlock(&walk.lock);
+
+ end:
+
+  if (NULL != walk.pool)
+    dpl_task_pool_destroy(walk.pool);
+
+  free(walk.filter);
+
+  pthread_mutex_destroy(&walk.cb_lock);
+  pthread_cond_destroy(&walk.cond);
+  pthread_mutex_destroy(&walk.lock);
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * resolve a directory locator to its bucket and fqn, the latter without
+ * leading slashes and with a trailing one unless it is the bucket root
+ */
+static dpl_status_t
+dir_locator_resolve(dpl_ctx_t *ctx,
+                    const char *locator,
+                    struct vfs_locator *locp,
+                    dpl_fqn_t *fqnp)
+{
+  dpl_status_t ret2;
+  char *skip_slashes;
+
+  ret2 = vfs_locator_parse(ctx, locator, locp);
+  if (DPL_SUCCESS != ret2)
+    return ret2;
+
+  ret2 = make_abs_path(ctx, locp->bucket, locp->path, fqnp);
+  if (DPL_SUCCESS != ret2)
+    return ret2;
+
+  fqn_append_trailing_slash(fqnp);
+
+  skip_slashes = fqnp->path;
+  while ('/' == *skip_slashes)
+    ++skip_slashes;
+  memmove(fqnp->path, skip_slashes, strlen(skip_slashes) + 1);
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * du
+ */
+
+struct du
+{
+  uint64_t size;
+  uint64_t n_files;
+  uint64_t n_dirs;
+};
+
+static int
+du_cb(dpl_dirent_t *dirent,
+      int depth,
+      dpl_walk_visit_t visit,
+      void *cb_arg)
+{
+  struct du *du = cb_arg;
+
+  if (DPL_WALK_VISIT_FILE == visit)
+    {
+      du->size += dirent->size;
+      du->n_files++;
+    }
+  else
+    {
+      du->n_dirs++;
+    }
+
+  return 0;
+}
+
+/**
+ * account for the space used by a directory tree
+ *
+ * the tree is listed by a flat scan when the backend allows it
+ *
+ * @param ctx
+ * @param locator [bucket:]path of the directory
+ * @param sizep total size of the files, may be NULL
+ * @param n_filesp number of files, may be NULL
+ * @param n_dirsp number of subdirectories, may be NULL
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE
+ */
+dpl_status_t
+dpl_du(dpl_ctx_t *ctx,
+       const char *locator,
+       uint64_t *sizep,
+       uint64_t *n_filesp,
+       uint64_t *n_dirsp)
+{
+  dpl_status_t ret, ret2;
+  struct du du;
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "du locator=%s", locator);
+
+  memset(&du, 0, sizeof (du));
+
+  ret2 = dpl_walk(ctx, locator, DPL_WALK_PREORDER|DPL_WALK_FLAT, NULL, du_cb, &du, 0);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (NULL != sizep)
+    *sizep = du.size;
+
+  if (NULL != n_filesp)
+    *n_filesp = du.n_files;
+
+  if (NULL != n_dirsp)
+    *n_dirsp = du.n_dirs;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * recursive delete
+ *
+ * keys are collected in batches deleted concurrently on a task pool,
+ * with multi-object deletes if the backend supports them.
+ */
+
+#define RMTREE_BATCH_MAX 1000   /* S3 limit for a multi-object delete */
+
+struct rmtree
+{
+  dpl_ctx_t *ctx;
+  const char *bucket;
+  int batch_delete;             /*!< backend has DPL_CAP_BATCH_DELETE */
+  int max_pending;
+  struct rmtree_batch *batch;   /*!< being filled */
+  dpl_task_pool_t *pool;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int n_pending;                /*!< batches queued or being deleted */
+  dpl_status_t ret;
+};
+
+struct rmtree_batch
+{
+  dpl_task_t task;
+  struct rmtree *rmtree;
+  dpl_locators_t locators;
+};
+
+static void
+rmtree_fail(struct rmtree *rmtree,
+            dpl_status_t ret)
+{
+  pthread_mutex_lock(&rmtree->lock);
+  if (DPL_SUCCESS == rmtree->ret)
+    rmtree->ret = ret;
+  pthread_mutex_unlock(&rmtree->lock);
+}
+
+static void
+rmtree_batch_free(struct rmtree_batch *batch)
+{
+  unsigned int i;
+
+  for (i = 0;i < batch->locators.size;i++)
+    free(batch->locators.tab[i].name);
+  free(batch->locators.tab);
+  free(batch);
+}
+
+static void
+rmtree_batch_do(void *handle)
+{
+  struct rmtree_batch *batch = handle;
+  struct rmtree *rmtree = batch->rmtree;
+  dpl_vec_t *objects = NULL;
+  dpl_status_t ret2;
+  unsigned int i;
+  int j;
+
+  if (rmtree->batch_delete)
+    {
+      ret2 = dpl_delete_all(rmtree->ctx, rmtree->bucket, &batch->locators,
+                            NULL, NULL, &objects);
+      if (DPL_SUCCESS != ret2)
+        {
+          rmtree_fail(rmtree, ret2);
+        }
+      else if (NULL != objects)
+        {
+          for (j = 0;j < objects->n_items;j++)
+            {
+              dpl_delete_object_t *obj = (dpl_delete_object_t *) dpl_vec_get(objects, j);
+
+              if (DPL_SUCCESS != obj->status && DPL_ENOENT != obj->status)
+                {
+                  DPL_LOG(rmtree->ctx, DPL_ERROR, "delete %s:%s failed: %s",
+                          rmtree->bucket, obj->name,
+                          NULL != obj->error ? obj->error : dpl_status_str(obj->status));
+                  rmtree_fail(rmtree, obj->status);
+                }
+            }
+          dpl_vec_delete_objects_free(objects);
+        }
+    }
+  else
+    {
+      for (i = 0;i < batch->locators.size;i++)
+        {
+          dpl_locator_t *locator = &batch->locators.tab[i];
+
+          ret2 = dpl_delete(rmtree->ctx, rmtree->bucket, locator->name, NULL,
+                            locator->type, NULL);
+          //directories synthesized from keys have no object
+          if (DPL_SUCCESS != ret2 && DPL_ENOENT != ret2)
+            {
+              DPL_LOG(rmtree->ctx, DPL_ERROR, "delete %s:%s failed: %s",
+                      rmtree->bucket, locator->name, dpl_status_str(ret2));
+              rmtree_fail(rmtree, ret2);
+            }
+        }
+    }
+
+  rmtree_batch_free(batch);
+
+  pthread_mutex_lock(&rmtree->lock);
+  rmtree->n_pending--;
+  pthread_cond_broadcast(&rmtree->cond);
+  pthread_mutex_unlock(&rmtree->lock);
+}
+
+/*
+ * queue the batch being filled, waiting while too many are pending
+ */
+static void
+rmtree_flush(struct rmtree *rmtree)
+{
+  struct rmtree_batch *batch = rmtree->batch;
+
+  if (NULL == batch)
+    return ;
+
+  rmtree->batch = NULL;
+
+  pthread_mutex_lock(&rmtree->lock);
+  while (rmtree->n_pending >= rmtree->max_pending)
+    pthread_cond_wait(&rmtree->cond, &rmtree->lock);
+  rmtree->n_pending++;
+  pthread_mutex_unlock(&rmtree->lock);
+
+  dpl_task_pool_put(rmtree->pool, (dpl_task_t *) batch);
+}
+
+static void
+rmtree_wait(struct rmtree *rmtree)
+{
+  pthread_mutex_lock(&rmtree->lock);
+  while (rmtree->n_pending > 0)
+    pthread_cond_wait(&rmtree->cond, &rmtree->lock);
+  pthread_mutex_unlock(&rmtree->lock);
+}
+
+static dpl_status_t
+rmtree_add(struct rmtree *rmtree,
+           const char *path,
+           dpl_ftype_t type)
+{
+  struct rmtree_batch *batch;
+  dpl_locator_t *locator;
+  int batch_max;
+
+  batch_max = rmtree->batch_delete ? RMTREE_BATCH_MAX : 1;
+
+  if (NULL == rmtree->batch)
+    {
+      batch = calloc(1, sizeof (*batch));
+      if (NULL == batch)
+        return DPL_ENOMEM;
+
+      batch->locators.tab = calloc(batch_max, sizeof (dpl_locator_t));
+      if (NULL == batch->locators.tab)
+        {
+          free(batch);
+          return DPL_ENOMEM;
+        }
+
+      batch->task.func = rmtree_batch_do;
+      batch->rmtree = rmtree;
+      rmtree->batch = batch;
+    }
+
+  batch = rmtree->batch;
+  locator = &batch->locators.tab[batch->locators.size];
+  locator->name = strdup(path);
+  if (NULL == locator->name)
+    return DPL_ENOMEM;
+  locator->type = type;
+  batch->locators.size++;
+
+  if (batch->locators.size == batch_max)
+    rmtree_flush(rmtree);
+
+  return DPL_SUCCESS;
+}
+
+static int
+rmtree_cb(dpl_dirent_t *dirent,
+          int depth,
+          dpl_walk_visit_t visit,
+          void *cb_arg)
+{
+  struct rmtree *rmtree = cb_arg;
+  dpl_status_t ret2;
+
+  if (DPL_WALK_VISIT_FILE == visit)
+    {
+      ret2 = rmtree_add(rmtree, dirent->fqn.path, DPL_FTYPE_REG);
+    }
+  else if (rmtree->batch_delete)
+    {
+      ret2 = rmtree_add(rmtree, dirent->fqn.path, DPL_FTYPE_DIR);
+    }
+  else
+    {
+      //without batch delete the backend may have real directories
+      //which must be emptied first
+      rmtree_flush(rmtree);
+      rmtree_wait(rmtree);
+      ret2 = rmtree_add(rmtree, dirent->fqn.path, DPL_FTYPE_DIR);
+    }
+
+  if (DPL_SUCCESS != ret2)
+    {
+      rmtree_fail(rmtree, ret2);
+      return -1;
+    }
+
+  pthread_mutex_lock(&rmtree->lock);
+  ret2 = rmtree->ret;
+  pthread_mutex_unlock(&rmtree->lock);
+
+  return DPL_SUCCESS != ret2 ? -1 : 0;
+}
+
+/**
+ * remove a directory and all its content
+ *
+ * the tree is listed by a flat scan when the backend allows it, and
+ * the keys are deleted as they are listed by batches of up to 1000
+ * (or one by one if the backend lacks DPL_CAP_BATCH_DELETE) issued
+ * concurrently. The bucket root cannot be removed.
+ *
+ * @param ctx
+ * @param locator [bucket:]path of the directory
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINVAL if locator is the bucket root
+ * @return DPL_ENOMEM
+ * @return the status of the listing, or of the first delete which
+ * failed otherwise than with DPL_ENOENT, including the per-key status of
+ * a batch
+ */
+dpl_status_t
+dpl_rmdir_recursive(dpl_ctx_t *ctx,
+                    const char *locator)
+{
+  dpl_status_t ret, ret2;
+  struct rmtree rmtree;
+  struct vfs_locator loc;
+  dpl_capability_t mask = 0;
+  dpl_fqn_t obj_fqn;
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "rmdir_recursive locator=%s", locator);
+
+  memset(&rmtree, 0, sizeof (rmtree));
+  pthread_mutex_init(&rmtree.lock, NULL);
+  pthread_cond_init(&rmtree.cond, NULL);
+  rmtree.ctx = ctx;
+  rmtree.max_pending = 2 * DPL_TASK_DEFAULT_N_WORKERS;
+  rmtree.ret = DPL_SUCCESS;
+
+  ret2 = dir_locator_resolve(ctx, locator, &loc, &obj_fqn);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  rmtree.bucket = loc.bucket;
+
+  if (!strcmp(obj_fqn.path, "") || !strcmp(obj_fqn.path, "/"))
+    {
+      ret = DPL_EINVAL;
+      goto end;
+    }
+
+  if (DPL_SUCCESS == dpl_get_capabilities(ctx, &mask) &&
+      (mask & DPL_CAP_BATCH_DELETE) && NULL != ctx->backend->delete_all)
+    rmtree.batch_delete = 1;
+
+  rmtree.pool = dpl_task_pool_create(ctx, "rmtree", DPL_TASK_DEFAULT_N_WORKERS);
+  if (NULL == rmtree.pool)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  ret2 = dpl_walk(ctx, locator, DPL_WALK_POSTORDER|DPL_WALK_FLAT, NULL, rmtree_cb, &rmtree, 0);
+  if (DPL_SUCCESS == ret2)
+    {
+      //the directory itself, last
+      rmtree_flush(&rmtree);
+      rmtree_wait(&rmtree);
+      if (DPL_SUCCESS != rmtree_add(&rmtree, obj_fqn.path, DPL_FTYPE_DIR))
+        rmtree_fail(&rmtree, DPL_ENOMEM);
+    }
+  rmtree_flush(&rmtree);
+  rmtree_wait(&rmtree);
+  vfs_invalidate(ctx, rmtree.bucket, obj_fqn.path);
+
+  if (DPL_SUCCESS != rmtree.ret)
+    {
+      ret = rmtree.ret;
+      goto end;
+    }
+
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  if (NULL != rmtree.pool)
+    dpl_task_pool_destroy(rmtree.pool);
+
+  if (NULL != rmtree.batch)
+    rmtree_batch_free(rmtree.batch);
+
+  pthread_cond_destroy(&rmtree.cond);
+  pthread_mutex_destroy(&rmtree.lock);
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * recursive copy
+ */
+
+struct cptree
+{
+  dpl_ctx_t *ctx;
+  const char *src_bucket;
+  dpl_fqn_t src_fqn;
+  size_t src_len;
+  const char *dst_bucket;
+  dpl_fqn_t dst_fqn;
+  dpl_status_t ret;
+};
+
+static int
+cptree_cb(dpl_dirent_t *dirent,
+          int depth,
+          dpl_walk_visit_t visit,
+          void *cb_arg)
+{
+  struct cptree *cptree = cb_arg;
+  char dst_path[DPL_MAXPATHLEN];
+  dpl_status_t ret2;
+  int len;
+
+  len = snprintf(dst_path, sizeof (dst_path), "%s%s",
+                 cptree->dst_fqn.path, dirent->fqn.path + cptree->src_len);
+  if (len < 0 || len >= sizeof (dst_path))
+    {
+      cptree->ret = DPL_ENAMETOOLONG;
+      return -1;
+    }
+
+  if (DPL_WALK_VISIT_FILE == visit)
+    ret2 = dpl_copy(cptree->ctx, cptree->src_bucket, dirent->fqn.path,
+                    cptree->dst_bucket, dst_path, NULL, DPL_FTYPE_REG,
+                    DPL_COPY_DIRECTIVE_COPY, NULL, NULL, NULL);
+  else
+    ret2 = dpl_put(cptree->ctx, cptree->dst_bucket, dst_path, NULL,
+                   DPL_FTYPE_DIR, NULL, NULL, NULL, NULL, NULL, 0);
+
+  if (DPL_SUCCESS != ret2)
+    {
+      DPL_LOG(cptree->ctx, DPL_ERROR, "copy %s:%s to %s:%s failed: %s",
+              cptree->src_bucket, dirent->fqn.path, cptree->dst_bucket,
+              dst_path, dpl_status_str(ret2));
+      cptree->ret = ret2;
+      return -1;
+    }
+
+  return 0;
+}
+
+/**
+ * server side copy of a directory tree
+ *
+ * directories are created before their content, files are copied with
+ * DPL_COPY_DIRECTIVE_COPY.
+ *
+ * @param ctx
+ * @param src_locator [bucket:]path of the source directory
+ * @param dst_locator [bucket:]path of the destination directory
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_EINVAL if the destination is inside the source
+ * @return DPL_ENOMEM
+ * @return DPL_ENAMETOOLONG if a destination path would be too long
+ * @return the status of the listing, or of the first copy or directory
+ * creation which failed
+ */
+dpl_status_t
+dpl_fcopy_recursive(dpl_ctx_t *ctx,
+                    const char *src_locator,
+                    const char *dst_locator)
+{
+  dpl_status_t ret, ret2;
+  struct cptree cptree;
+  struct vfs_locator src_loc, dst_loc;
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "fcopy_recursive src_locator=%s dst_locator=%s", src_locator, dst_locator);
+
+  memset(&cptree, 0, sizeof (cptree));
+  cptree.ctx = ctx;
+  cptree.ret = DPL_SUCCESS;
+
+  ret2 = dir_locator_resolve(ctx, src_locator, &src_loc, &cptree.src_fqn);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  cptree.src_bucket = src_loc.bucket;
+
+  ret2 = dir_locator_resolve(ctx, dst_locator, &dst_loc, &cptree.dst_fqn);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+  cptree.dst_bucket = dst_loc.bucket;
+
+  if (!strcmp(cptree.src_fqn.path, "/"))
+    cptree.src_fqn.path[0] = 0;
+  cptree.src_len = strlen(cptree.src_fqn.path);
+
+  if (!strcmp(cptree.dst_fqn.path, "/"))
+    {
+      cptree.dst_fqn.path[0] = 0;
+    }
+  else
+    {
+      //copying a directory into itself would never end
+      if (!strcmp(cptree.src_bucket, cptree.dst_bucket) &&
+          !strncmp(cptree.dst_fqn.path, cptree.src_fqn.path, cptree.src_len))
+        {
+          ret = DPL_EINVAL;
+          goto end;
+        }
+
+      ret2 = dpl_put(ctx, cptree.dst_bucket, cptree.dst_fqn.path, NULL,
+                     DPL_FTYPE_DIR, NULL, NULL, NULL, NULL, NULL, 0);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  ret2 = dpl_walk(ctx, src_locator, DPL_WALK_PREORDER|DPL_WALK_FLAT, NULL, cptree_cb, &cptree, 0);
+  vfs_invalidate(ctx, cptree.dst_bucket, '\0' != cptree.dst_fqn.path[0] ? cptree.dst_fqn.path : "/");
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = (DPL_SUCCESS != cptree.ret) ? cptree.ret : ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
+}
+
+dpl_status_t
+dpl_chdir(dpl_ctx_t *ctx,
+          const char *locator)
+{
+  int ret, ret2;
+  dpl_fqn_t obj_fqn, tmp_fqn;
+  char *nbucket;
+  struct vfs_locator loc;
+  dpl_sysmd_t sysmd;
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "chdir locator=%s", locator);
+
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  fqn_append_trailing_slash(&obj_fqn);
+
+  dpl_ctx_lock(ctx);
+  if (strcmp(loc.bucket, ctx->cur_bucket))
+    {
+      nbucket = strdup(loc.bucket);
+      if (NULL == nbucket)
+        {
+          dpl_ctx_unlock(ctx);
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+      free(ctx->cur_bucket);
+      ctx->cur_bucket = nbucket;
+
+      ret2 = dpl_vdir_publish(ctx);
+      if (DPL_SUCCESS != ret2)
+        {
+          dpl_ctx_unlock(ctx);
+          ret = ret2;
+          goto end;
+        }
+    }
+  dpl_ctx_unlock(ctx);
+
+  //recheck obj_type: append delim at the end of object to be compatible with all backend
+  tmp_fqn = obj_fqn;
+
+  if (strcmp(tmp_fqn.path, ""))
+    {
+      int len = strlen(tmp_fqn.path);
+
+      //append delim if not present
+      if (len >= 1 && *(tmp_fqn.path + len - 1) != '/')
+        strcat(tmp_fqn.path, "/");
+    }
+
+  ret2 = dpl_head(ctx, loc.bucket, tmp_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, NULL, &sysmd);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  if (sysmd.mask & DPL_SYSMD_MASK_FTYPE)
+    {
+      if (DPL_FTYPE_DIR != sysmd.ftype)
+        {
+          ret = DPL_ENOTDIR;
+          goto end;
+        }
+    }
+
+  dpl_ctx_lock(ctx);
+  ret2 = dpl_dict_add(ctx->cwds, loc.bucket, obj_fqn.path, 0);
+  if (DPL_SUCCESS == ret2)
+    ret2 = dpl_vdir_publish(ctx);
+  dpl_ctx_unlock(ctx);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
+}
+
+/*
+ * vfile
+ */
+
+/*
+ * read-ahead
+ *
+ * once two reads in a row are sequential, dpl_pread() fetches a whole
+ * window and serves the next reads from it, while the following window
+ * is prefetched in the background. Windows are requested with If-Match
+ * on the ETag of the first one, so that a modified object is noticed.
+ */
+
+struct dpl_readahead_fetch
+{
+  dpl_task_t task;
+  dpl_vfile_t *vfile;
+  unsigned long long start;
+  unsigned int len;
+  char etag[DPL_ETAG_SIZE+1];   /*!< expected ETag, empty if unknown */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int done;
+  dpl_status_t ret;
+  char *data;
+  unsigned int data_len;
+};
+
+struct dpl_readahead
+{
+  unsigned long long next_offset; /*!< start of a sequential read */
+  int n_sequential;               /*!< sequential reads in a row */
+  char etag[DPL_ETAG_SIZE+1];
+  char *buf;
+  unsigned long long buf_start;
+  unsigned int buf_len;
+  unsigned int window;
+  int buf_eof;                    /*!< buf reaches the end of the object */
+  struct dpl_readahead_fetch *fetch; /*!< being prefetched */
+  dpl_task_pool_t *pool;
+};
+
+/*
+ * get a range, conditioned by the vfile conditions and etag
+ */
+static dpl_status_t
+readahead_get(dpl_vfile_t *vfile,
+              unsigned long long start,
+              unsigned int len,
+              char *etag,
+              char **datap,
+              unsigned int *data_lenp)
+{
+  dpl_condition_t condition;
+  dpl_sysmd_t sysmd;
+  dpl_range_t range;
+  dpl_status_t ret;
+
+  memset(&condition, 0, sizeof (condition));
+  if (NULL != vfile->condition)
+    condition = *vfile->condition;
+
+  if ('\0' != etag[0] && condition.n_conds < DPL_COND_MAX)
+    {
+      condition.conds[condition.n_conds].type = DPL_CONDITION_IF_MATCH;
+      snprintf(condition.conds[condition.n_conds].etag, DPL_ETAG_SIZE + 1, "%s", etag);
+      condition.n_conds++;
+    }
+
+  range.start = start;
+  range.end = start + len - 1;
+
+  memset(&sysmd, 0, sizeof (sysmd));
+
+  ret = dpl_get(vfile->ctx, vfile->bucket, vfile->obj_fqn.path, vfile->option,
+                DPL_FTYPE_ANY, condition.n_conds > 0 ? &condition : NULL,
+                &range, datap, data_lenp, NULL, &sysmd);
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  //quoted, as If-Match expects it
+  if ('\0' == etag[0] && (sysmd.mask & DPL_SYSMD_MASK_ETAG))
+    {
+      if (strlen(sysmd.etag) + 2 <= DPL_ETAG_SIZE)
+        snprintf(etag, DPL_ETAG_SIZE + 1, "\"%s\"", sysmd.etag);
+      else
+        snprintf(etag, DPL_ETAG_SIZE + 1, "%s", sysmd.etag);
+    }
+
+  return DPL_SUCCESS;
+}
+
+static void
+readahead_fetch_free(struct dpl_readahead_fetch *fetch)
+{
+  free(fetch->data);
+  pthread_mutex_destroy(&fetch->lock);
+  pthread_cond_destroy(&fetch->cond);
+  free(fetch);
+}
+
+static void
+readahead_fetch_do(void *handle)
+{
+  struct dpl_readahead_fetch *fetch = handle;
+  dpl_status_t ret;
+
+  ret = readahead_get(fetch->vfile, fetch->start, fetch->len, fetch->etag,
+                      &fetch->data, &fetch->data_len);
+
+  pthread_mutex_lock(&fetch->lock);
+  fetch->ret = ret;
+  fetch->done = 1;
+  pthread_cond_signal(&fetch->cond);
+  pthread_mutex_unlock(&fetch->lock);
+}
+
+/*
+ * wait for the pending prefetch and take it off the read-ahead
+ */
+static struct dpl_readahead_fetch *
+readahead_fetch_wait(struct dpl_readahead *ra)
+{
+  struct dpl_readahead_fetch *fetch = ra->fetch;
+
+  if (NULL == fetch)
+    return NULL;
+
+  pthread_mutex_lock(&fetch->lock);
+  while (!fetch->done)
+    pthread_cond_wait(&fetch->cond, &fetch->lock);
+  pthread_mutex_unlock(&fetch->lock);
+
+  ra->fetch = NULL;
+
+  return fetch;
+}
+
+static void
+readahead_set_buf(struct dpl_readahead *ra,
+                  unsigned long long start,
+                  unsigned int len,
+                  char *data,
+                  unsigned int data_len)
+{
+  free(ra->buf);
+  ra->buf = data;
+  ra->buf_start = start;
+  ra->buf_len = data_len;
+  ra->buf_eof = (data_len < len);
+}
+
+/*
+ * forget the buffered data, e.g. because the object was modified
+ */
+static void
+readahead_reset(struct dpl_readahead *ra)
+{
+  struct dpl_readahead_fetch *fetch;
+
+  fetch = readahead_fetch_wait(ra);
+  if (NULL != fetch)
+    readahead_fetch_free(fetch);
+
+  free(ra->buf);
+  ra->buf = NULL;
+  ra->buf_len = 0;
+  ra->buf_eof = 0;
+  ra->etag[0] = 0;
+  ra->n_sequential = 0;
+}
+
+static void
+readahead_free(struct dpl_readahead *ra)
+{
+  readahead_reset(ra);
+
+  if (NULL != ra->pool)
+    dpl_task_pool_destroy(ra->pool);
+
+  free(ra);
+}
+
+static int
+readahead_covers(struct dpl_readahead *ra,
+                 unsigned long long offset,
+                 unsigned int len)
+{
+  unsigned long long buf_end = ra->buf_start + ra->buf_len;
+
+  if (NULL == ra->buf || offset < ra->buf_start || offset >= buf_end)
+    return 0;
+
+  return offset + len <= buf_end || ra->buf_eof;
+}
+
+/*
+ * start fetching the window following the buffer
+ */
+static void
+readahead_prefetch(dpl_vfile_t *vfile)
+{
+  struct dpl_readahead *ra = vfile->readahead;
+  struct dpl_readahead_fetch *fetch;
+
+  if (NULL != ra->fetch || NULL == ra->buf || ra->buf_eof)
+    return ;
+
+  if (NULL == ra->pool)
+    {
+      ra->pool = dpl_task_pool_create(vfile->ctx, "readahead", 1);
+      if (NULL == ra->pool)
+        return ;
+    }
+
+  fetch = calloc(1, sizeof (*fetch));
+  if (NULL == fetch)
+    return ;
+
+  pthread_mutex_init(&fetch->lock, NULL);
+  pthread_cond_init(&fetch->cond, NULL);
+  fetch->task.func = readahead_fetch_do;
+  fetch->vfile = vfile;
+  fetch->start = ra->buf_start + ra->buf_len;
+  fetch->len = ra->window;
+  strcpy(fetch->etag, ra->etag);
+
+  ra->fetch = fetch;
+  dpl_task_pool_put(ra->pool, (dpl_task_t *) fetch);
+}
+
+/*
+ * try to serve a read from the read-ahead buffer
+ *
+ * @return DPL_SUCCESS if served, DPL_ENOENT if the read must be done directly
+ */
+static dpl_status_t
+readahead_read(dpl_vfile_t *vfile,
+               unsigned int len,
+               unsigned long long offset,
+               char **bufp,
+               unsigned int *buf_lenp)
+{
+  struct dpl_readahead *ra = vfile->readahead;
+  struct dpl_readahead_fetch *fetch;
+  unsigned int n;
+  char *data = NULL;
+  unsigned int data_len;
+  dpl_status_t ret2;
+
+  if (offset == ra->next_offset)
+    ra->n_sequential++;
+  else
+    ra->n_sequential = 0;
+  ra->next_offset = offset + len;
+
+  if (!readahead_covers(ra, offset, len) && NULL != ra->fetch)
+    {
+      fetch = readahead_fetch_wait(ra);
+      if (DPL_SUCCESS == fetch->ret && offset >= fetch->start &&
+          offset < fetch->start + fetch->len)
+        {
+          readahead_set_buf(ra, fetch->start, fetch->len, fetch->data, fetch->data_len);
+          fetch->data = NULL;
+        }
+      else if (DPL_EPRECOND == fetch->ret)
+        {
+          readahead_reset(ra);
+        }
+      readahead_fetch_free(fetch);
+    }
+
+  if (!readahead_covers(ra, offset, len))
+    {
+      if (ra->n_sequential < 1)
+        return DPL_ENOENT;
+
+      ra->window = vfile->ctx->read_ahead_size;
+      if (ra->window < len)
+        ra->window = len;
+
+      ret2 = readahead_get(vfile, offset, ra->window, ra->etag, &data, &data_len);
+      if (DPL_SUCCESS != ret2)
+        {
+          //e.g. object modified or range past the end
+          readahead_reset(ra);
+          return DPL_ENOENT;
+        }
+
+      readahead_set_buf(ra, offset, ra->window, data, data_len);
+
+      if (!readahead_covers(ra, offset, len))
+        return DPL_ENOENT;
+    }
+
+  n = ra->buf_start + ra->buf_len - offset;
+  if (n > len)
+    n = len;
+
+  data = malloc(n);
+  if (NULL == data)
+    return DPL_ENOMEM;
+  memcpy(data, ra->buf + (offset - ra->buf_start), n);
+
+  *bufp = data;
+  *buf_lenp = n;
+
+  //past the middle of the window, time to fetch the next one
+  if (ra->n_sequential >= 1 && offset + n >= ra->buf_start + ra->buf_len / 2)
+    readahead_prefetch(vfile);
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * write-back
+ *
+ * dpl_pwrite() accumulates contiguous writes in a buffer of
+ * write_back_size bytes. Backends with DPL_CAP_PUT_RANGE get a ranged
+ * PUT whenever the buffer is full or a write is not contiguous. Others
+ * must be written sequentially from offset 0: full buffers become parts
+ * of a multipart upload, and dpl_close() or dpl_fstream_flush() either
+ * completes the upload or, if the whole object fits in the buffer,
+ * issues a single PUT.
+ */
+
+struct dpl_writeback
+{
+  int put_range;                /*!< backend supports ranged PUT */
+  unsigned int size;            /*!< flush threshold */
+  char *buf;
+  unsigned int len;
+  unsigned long long start;     /*!< offset of buf in the object */
+  const char *uploadid;         /*!< multipart upload in progress */
+  struct json_object *parts;
+  unsigned int partnb;
+};
+
+static dpl_status_t
+vfile_put_range(dpl_vfile_t *vfile,
+                char *buf,
+                unsigned int len,
+                unsigned long long offset)
+{
+  dpl_status_t ret;
+  dpl_range_t range;
+
+  range.start = offset;
+  range.end   = offset+len;
+
+  ret = dpl_put(vfile->ctx,
+                vfile->bucket,
+                vfile->obj_fqn.path,
+                vfile->option,
+                DPL_FTYPE_REG,
+                vfile->condition,
+                &range,
+                vfile->metadata,
+                vfile->sysmd,
+                buf,
+                len);
+  vfs_invalidate(vfile->ctx, vfile->bucket, vfile->obj_fqn.path);
+
+  return ret;
+}
+
+static dpl_status_t
+writeback_new(dpl_vfile_t *vfile)
+{
+  dpl_ctx_t *ctx = vfile->ctx;
+  struct dpl_writeback *wb;
+  dpl_capability_t mask = 0;
+
+  if (DPL_SUCCESS != dpl_get_capabilities(ctx, &mask))
+    mask = 0;
+
+  //without either there is nothing better than the plain ranged PUT
+  if (!(mask & DPL_CAP_PUT_RANGE) && NULL == ctx->backend->multipart_init)
+    return DPL_SUCCESS;
+
+  //the parts would be stored in the clear
+  if (dpl_crypt_enabled(ctx))
+    return DPL_SUCCESS;
+
+  wb = calloc(1, sizeof (*wb));
+  if (NULL == wb)
+    return DPL_ENOMEM;
+
+  wb->put_range = (mask & DPL_CAP_PUT_RANGE) ? 1 : 0;
+  wb->size = ctx->write_back_size;
+  if (!wb->put_range && wb->size < DPL_MULTIPART_MIN_PART_SIZE)
+    wb->size = DPL_MULTIPART_MIN_PART_SIZE;
+
+  vfile->writeback = wb;
+
+  return DPL_SUCCESS;
+}
+
+static void
+writeback_abort(dpl_vfile_t *vfile)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+  dpl_status_t ret2;
+
+  if (NULL != wb->uploadid)
+    {
+      ret2 = dpl_multipart_abort(vfile->ctx, vfile->bucket, vfile->obj_fqn.path, wb->uploadid);
+      if (DPL_SUCCESS != ret2)
+        DPL_LOG(vfile->ctx, DPL_WARNING, "could not abort upload %s of %s: %s",
+                wb->uploadid, vfile->obj_fqn.path, dpl_status_str(ret2));
+      free((void *) wb->uploadid);
+      wb->uploadid = NULL;
     }
 
-  ret2 = dpl_head(ctx, ctx->cur_bucket, tmp_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, NULL, &sysmd);
-  if (DPL_SUCCESS != ret2)
+  if (NULL != wb->parts)
     {
-      ret = ret2;
+      json_object_put(wb->parts);
+      wb->parts = NULL;
+    }
+
+  wb->partnb = 0;
+  wb->start = 0;
+  wb->len = 0;
+}
+
+static void
+writeback_free(dpl_vfile_t *vfile)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+
+  writeback_abort(vfile);
+  free(wb->buf);
+  free(wb);
+  vfile->writeback = NULL;
+}
+
+/*
+ * send the buffer as a part of the multipart upload
+ */
+static dpl_status_t
+writeback_put_part(dpl_vfile_t *vfile)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+  const char *etag = NULL;
+  struct json_object *json_etag;
+  dpl_status_t ret, ret2;
+
+  if (DPL_MULTIPART_MAX_PARTS == wb->partnb)
+    {
+      ret = DPL_ELIMIT;
       goto end;
     }
 
-  if (sysmd.mask & DPL_SYSMD_MASK_FTYPE)
+  if (NULL == wb->uploadid)
     {
-      if (DPL_FTYPE_DIR != sysmd.ftype)
+      ret2 = dpl_multipart_init_ext(vfile->ctx, vfile->bucket, vfile->obj_fqn.path,
+                                    vfile->metadata, vfile->sysmd, &wb->uploadid);
+      if (DPL_SUCCESS != ret2)
         {
-          ret = DPL_ENOTDIR;
+          ret = ret2;
+          goto end;
+        }
+
+      wb->parts = json_object_new_array();
+      if (NULL == wb->parts)
+        {
+          ret = DPL_ENOMEM;
           goto end;
         }
     }
 
-  ret2 = dpl_dict_add(ctx->cwds, ctx->cur_bucket, obj_fqn.path, 0);
+  ret2 = dpl_multipart_put(vfile->ctx, vfile->bucket, vfile->obj_fqn.path, wb->uploadid,
+                           wb->partnb + 1, wb->buf, wb->len, &etag);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
+  json_etag = json_object_new_string(etag);
+  if (NULL == json_etag)
+    {
+      ret = DPL_ENOMEM;
+      goto end;
+    }
+
+  json_object_array_put_idx(wb->parts, wb->partnb, json_etag);
+  wb->partnb++;
+
   ret = DPL_SUCCESS;
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
+  if (NULL != etag)
+    free((void *) etag);
 
-  if (NULL != nlocator)
-    free(nlocator);
+  return ret;
+}
 
-  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+/*
+ * write out the buffer, without committing a multipart upload
+ */
+static dpl_status_t
+writeback_flush(dpl_vfile_t *vfile)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+  dpl_status_t ret;
 
-  return ret;
+  if (0 == wb->len)
+    return DPL_SUCCESS;
+
+  if (wb->put_range)
+    ret = vfile_put_range(vfile, wb->buf, wb->len, wb->start);
+  else
+    ret = writeback_put_part(vfile);
+
+  if (DPL_SUCCESS != ret)
+    return ret;
+
+  wb->start += wb->len;
+  wb->len = 0;
+
+  return DPL_SUCCESS;
 }
 
 /*
- * vfile
+ * make everything written so far visible
  */
+static dpl_status_t
+writeback_commit(dpl_vfile_t *vfile)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+  dpl_status_t ret, ret2;
+
+  if (wb->put_range)
+    {
+      ret2 = writeback_flush(vfile);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  if (NULL == wb->uploadid)
+    {
+      if (0 == wb->len)
+        {
+          ret = DPL_SUCCESS;
+          goto end;
+        }
+
+      //the whole object fits in the buffer
+      ret2 = dpl_put(vfile->ctx, vfile->bucket, vfile->obj_fqn.path, vfile->option,
+                     DPL_FTYPE_REG, vfile->condition, NULL, vfile->metadata,
+                     vfile->sysmd, wb->buf, wb->len);
+      vfs_invalidate(vfile->ctx, vfile->bucket, vfile->obj_fqn.path);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+
+      ret = DPL_SUCCESS;
+      goto end;
+    }
+
+  ret2 = writeback_flush(vfile);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  ret2 = dpl_multipart_complete(vfile->ctx, vfile->bucket, vfile->obj_fqn.path,
+                                wb->uploadid, wb->parts, wb->partnb,
+                                vfile->metadata, vfile->sysmd);
+  vfs_invalidate(vfile->ctx, vfile->bucket, vfile->obj_fqn.path);
+  if (DPL_SUCCESS != ret2)
+    {
+      ret = ret2;
+      goto end;
+    }
+
+  free((void *) wb->uploadid);
+  wb->uploadid = NULL;
+
+  ret = DPL_SUCCESS;
+
+ end:
+
+  //next writes start a new object
+  if (!wb->put_range)
+    writeback_abort(vfile);
+
+  return ret;
+}
+
+static dpl_status_t
+writeback_write(dpl_vfile_t *vfile,
+                char *buf,
+                unsigned int len,
+                unsigned long long offset)
+{
+  struct dpl_writeback *wb = vfile->writeback;
+  unsigned int n;
+  dpl_status_t ret2;
+
+  if (offset != wb->start + wb->len)
+    {
+      //objects cannot be rewritten in place without ranged PUT
+      if (!wb->put_range)
+        return DPL_ENOTSUPP;
+
+      ret2 = writeback_flush(vfile);
+      if (DPL_SUCCESS != ret2)
+        return ret2;
+
+      wb->start = offset;
+    }
+
+  if (NULL == wb->buf)
+    {
+      wb->buf = malloc(wb->size);
+      if (NULL == wb->buf)
+        return DPL_ENOMEM;
+    }
+
+  while (len > 0)
+    {
+      n = wb->size - wb->len;
+      if (n > len)
+        n = len;
+
+      memcpy(wb->buf + wb->len, buf, n);
+      wb->len += n;
+      buf += n;
+      len -= n;
+
+      if (wb->len == wb->size)
+        {
+          ret2 = writeback_flush(vfile);
+          if (DPL_SUCCESS != ret2)
+            return ret2;
+        }
+    }
+
+  return DPL_SUCCESS;
+}
 
+/**
+ * Close a file, committing the buffered writes
+ *
+ * @param vfile
+ *
+ * @return DPL_SUCCESS
+ * @return DPL_FAILURE if the buffered writes could not be stored
+ */
 dpl_status_t
 dpl_close(dpl_vfile_t *vfile)
 {
+  dpl_ctx_t *ctx = vfile->ctx;
+  dpl_status_t ret = DPL_SUCCESS;
+
   DPL_TRACE(vfile->ctx, DPL_TRACE_VFS, "close vfile=%p", vfile);
 
+  if (NULL != vfile->writeback)
+    {
+      ret = writeback_commit(vfile);
+      writeback_free(vfile);
+    }
+
+  if (NULL != vfile->readahead)
+    readahead_free(vfile->readahead);
+
   if (NULL != vfile->stream)
     dpl_stream_close(vfile->ctx, vfile->stream);
 
@@ -980,13 +3229,18 @@ dpl_close(dpl_vfile_t *vfile)
 
   free(vfile);
 
-  return DPL_SUCCESS;
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
+
+  return ret;
 }
 
 /**
  * Write to a dpl_vfile_t* at a given offset
  *
- * XXX todo check DPL_CAP_PUT_RANGE
+ * Unless write_back_size is 0, writes are buffered and only guaranteed
+ * to be stored once dpl_close() or dpl_fstream_flush() succeeds. On
+ * backends without DPL_CAP_PUT_RANGE the file must then be written
+ * sequentially from offset 0, and is replaced as a whole.
  *
  * @param vfile
  * @param buf
@@ -1004,25 +3258,17 @@ dpl_pwrite(dpl_vfile_t *vfile,
            unsigned long long offset)
 {
   dpl_status_t ret, ret2;
-  dpl_range_t range;
 
   DPL_TRACE(vfile->ctx, DPL_TRACE_VFS, "start=%llu end=%llu",
             offset, offset+len);
 
-  range.start = offset;
-  range.end   = offset+len;
+  if (NULL != vfile->readahead)
+    readahead_reset(vfile->readahead);
 
-  ret2 = dpl_put(vfile->ctx,
-		 vfile->bucket,
-		 vfile->obj_fqn.path,
-		 vfile->option,
-		 DPL_FTYPE_REG,
-		 vfile->condition,
-		 &range,
-		 vfile->metadata,
-		 vfile->sysmd,
-		 buf,
-		 len);
+  if (NULL != vfile->writeback)
+    ret2 = writeback_write(vfile, buf, len, offset);
+  else
+    ret2 = vfile_put_range(vfile, buf, len, offset);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1040,6 +3286,10 @@ dpl_pwrite(dpl_vfile_t *vfile,
 /**
  * Read from a dpl_vfile_t* at a given offset
  *
+ * Sequential reads are served from a read-ahead window (see the
+ * read_ahead_size profile key) unless the file was opened with
+ * DPL_VFILE_FLAG_RANDOM; they return at most len bytes.
+ *
  * XXX todo check DPL_CAP_GET_RANGE
  *
  * @param vfile
@@ -1064,6 +3314,27 @@ dpl_pread(dpl_vfile_t *vfile,
 
   DPL_TRACE(vfile->ctx, DPL_TRACE_VFS, "start=%llu end=%llu", offset, offset+len);
 
+  //read what was written
+  if (NULL != vfile->writeback)
+    {
+      ret2 = writeback_commit(vfile);
+      if (DPL_SUCCESS != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
+  if (NULL != vfile->readahead)
+    {
+      ret2 = readahead_read(vfile, len, offset, bufp, buf_lenp);
+      if (DPL_ENOENT != ret2)
+        {
+          ret = ret2;
+          goto end;
+        }
+    }
+
   range.start = offset;
   range.end   = offset+len;
 
@@ -1290,7 +3561,8 @@ end:
 }
 
 /**
- * Flush stream's write-data before closing
+ * Flush stream's write-data before closing, or commit the writes
+ * buffered on a file which is not in stream mode
  *
  * @param vfile   the vfile descriptor
  *
@@ -1304,6 +3576,12 @@ dpl_fstream_flush(dpl_vfile_t *vfile)
 
   DPL_TRACE(vfile->ctx, DPL_TRACE_VFS, "fstream_flush vfile=%p", vfile->ctx);
 
+  if (NULL != vfile->writeback)
+    {
+      ret = writeback_commit(vfile);
+      goto end;
+    }
+
   if (0 == (vfile->flags & DPL_VFILE_FLAG_STREAM))
     {
       ret = DPL_EINVAL;
@@ -1311,6 +3589,7 @@ dpl_fstream_flush(dpl_vfile_t *vfile)
     }
 
   ret = dpl_stream_flush(vfile->ctx, vfile->stream);
+  vfs_invalidate(vfile->ctx, vfile->bucket, vfile->obj_fqn.path);
   if (DPL_SUCCESS != ret)
     goto end;
 
@@ -1351,44 +3630,17 @@ dpl_open(dpl_ctx_t *ctx,
 {
   dpl_status_t ret, ret2;
   dpl_vfile_t *vfile = NULL;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
 
-  DPL_TRACE(ctx, DPL_TRACE_VFS, "bucket=%s, locator=%s",
-            ctx->cur_bucket, locator);
+  DPL_TRACE(ctx, DPL_TRACE_VFS, "open locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (! nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
   vfile = malloc(sizeof *vfile);
   if (! vfile)
     {
@@ -1398,16 +3650,19 @@ dpl_open(dpl_ctx_t *ctx,
 
   memset(vfile, 0, sizeof *vfile);
 
-  ret2 = make_abs_path(ctx, bucket, path, &vfile->obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &vfile->obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
+  if (flag & (DPL_VFILE_FLAG_CREAT|DPL_VFILE_FLAG_WRONLY|DPL_VFILE_FLAG_RDWR))
+    vfs_invalidate(ctx, loc.bucket, vfile->obj_fqn.path);
+
   vfile->ctx = ctx;
   vfile->flags = flag;
-  vfile->bucket = strdup(bucket);
+  vfile->bucket = strdup(loc.bucket);
   if (NULL == vfile->bucket)
     {
       ret = DPL_ENOMEM;
@@ -1449,9 +3704,27 @@ dpl_open(dpl_ctx_t *ctx,
 	  goto end;
 	}
     }
+  if (ctx->write_back_size > 0 &&
+      (flag & (DPL_VFILE_FLAG_CREAT|DPL_VFILE_FLAG_WRONLY|DPL_VFILE_FLAG_RDWR)) &&
+      !(flag & DPL_VFILE_FLAG_STREAM))
+    {
+      ret = writeback_new(vfile);
+      if (DPL_SUCCESS != ret)
+        goto end;
+    }
+  if (ctx->read_ahead_size > 0 &&
+      !(flag & (DPL_VFILE_FLAG_RANDOM|DPL_VFILE_FLAG_STREAM|DPL_VFILE_FLAG_WRONLY)))
+    {
+      vfile->readahead = calloc(1, sizeof (*vfile->readahead));
+      if (NULL == vfile->readahead)
+        {
+          ret = DPL_ENOMEM;
+          goto end;
+        }
+    }
   if (flag & DPL_VFILE_FLAG_STREAM)
     {
-      ret = dpl_stream_open(ctx, bucket, path, vfile->option, vfile->condition,
+      ret = dpl_stream_open(ctx, loc.bucket, loc.path, vfile->option, vfile->condition,
                             vfile->metadata, vfile->sysmd, &vfile->stream);
       if (DPL_SUCCESS != ret)
           goto end;
@@ -1477,9 +3750,6 @@ dpl_open(dpl_ctx_t *ctx,
   if (vfile)
     dpl_close(vfile);
 
-  free(bucket);
-  free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%s (%d)", dpl_status_str(ret), ret);
 
   return ret;
@@ -1515,47 +3785,21 @@ dpl_fput(dpl_ctx_t *ctx,
 	 char *data_buf,
 	 unsigned int data_len)
 {
-  int ret = DPL_SUCCESS;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path = NULL;
+  int ret = DPL_SUCCESS, ret2;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "fput locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (! nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
   ret = dpl_put(ctx,
-                bucket,
-                path,
+                loc.bucket,
+                loc.path,
                 option,
                 DPL_FTYPE_REG,
                 condition,
@@ -1565,10 +3809,9 @@ dpl_fput(dpl_ctx_t *ctx,
                 data_buf,
                 data_len);
 
- end:
+  vfs_invalidate(ctx, loc.bucket, loc.path);
 
-  free(nlocator);
-  free(bucket);
+ end:
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
@@ -1603,44 +3846,18 @@ dpl_fget(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path = NULL;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "fget locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (! nlocator)
-    {
-      ret = DPL_ENOMEM;
-      goto end;
-    }
-
-  path = index(nlocator, ':');
-  if (path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
+      ret = ret2;
+      goto end;
     }
 
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1648,7 +3865,7 @@ dpl_fget(dpl_ctx_t *ctx,
     }
 
   ret2 = dpl_get(ctx,
-		 bucket,
+		 loc.bucket,
 		 obj_fqn.path,
 		 option,
 		 DPL_FTYPE_ANY,
@@ -1668,9 +3885,6 @@ dpl_fget(dpl_ctx_t *ctx,
 
  end:
 
-  free(bucket);
-  free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -1689,45 +3903,19 @@ dpl_mkobj(dpl_ctx_t *ctx,
 {
   dpl_fqn_t obj_fqn;
   int ret, ret2;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
   char resource[DPL_MAXPATHLEN];
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "mkobj locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1736,7 +3924,8 @@ dpl_mkobj(dpl_ctx_t *ctx,
 
   snprintf(resource, sizeof (resource), "%s%s", obj_fqn.path, obj_type_ext(obj_type));
 
-  ret2 = dpl_put(ctx, bucket, resource, NULL, obj_type, NULL, NULL, metadata, sysmd, NULL, 0);
+  ret2 = dpl_put(ctx, loc.bucket, resource, NULL, obj_type, NULL, NULL, metadata, sysmd, NULL, 0);
+  vfs_invalidate(ctx, loc.bucket, resource);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1747,12 +3936,6 @@ dpl_mkobj(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -1783,46 +3966,20 @@ dpl_rmdir(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
   size_t path_len;
   char *npath = NULL;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "rmdir locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1850,7 +4007,7 @@ dpl_rmdir(dpl_ctx_t *ctx,
   if (0 != strcmp((char *) dpl_get_backend_name(ctx), "posix"))
     {
       //posix does it server-side
-      ret2 = dir_is_empty(ctx, npath);
+      ret2 = dir_is_empty(ctx, loc.bucket, npath);
       if (DPL_SUCCESS != ret2)
         {
           ret = ret2;
@@ -1858,7 +4015,8 @@ dpl_rmdir(dpl_ctx_t *ctx,
         }
     }
 
-  ret2 = dpl_delete(ctx, bucket, npath, NULL, DPL_FTYPE_DIR, NULL);
+  ret2 = dpl_delete(ctx, loc.bucket, npath, NULL, DPL_FTYPE_DIR, NULL);
+  vfs_invalidate(ctx, loc.bucket, npath);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1872,12 +4030,6 @@ dpl_rmdir(dpl_ctx_t *ctx,
   if (NULL != npath)
     free(npath);
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -1889,51 +4041,26 @@ dpl_unlink(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "unlink locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_delete(ctx, bucket, obj_fqn.path, NULL, DPL_FTYPE_REG, NULL);
+  ret2 = dpl_delete(ctx, loc.bucket, obj_fqn.path, NULL, DPL_FTYPE_REG, NULL);
+  vfs_invalidate(ctx, loc.bucket, obj_fqn.path);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -1944,12 +4071,6 @@ dpl_unlink(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -1962,6 +4083,7 @@ dpl_unlink_all(dpl_ctx_t *ctx,
                dpl_vec_t **objectsp)
 {
   int   i;
+  dpl_status_t ret;
 
   if (locators == NULL || locators->size == 0)
     return DPL_EINVAL;
@@ -1984,7 +4106,12 @@ dpl_unlink_all(dpl_ctx_t *ctx,
     locator->name = path;
   }
 
-  return dpl_delete_all(ctx, bucket, locators, NULL, NULL, objectsp);
+  ret = dpl_delete_all(ctx, bucket, locators, NULL, NULL, objectsp);
+
+  for (i = 0; i < locators->size; i++)
+    vfs_invalidate(ctx, bucket, locators->tab[i].name);
+
+  return ret;
 }
 
 dpl_status_t
@@ -1995,51 +4122,49 @@ dpl_getattr(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
+  dpl_dict_t *metadata = NULL;
+  dpl_sysmd_t sysmd;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "getattr locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_head(ctx, bucket, obj_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, metadatap, sysmdp);
+  if (dpl_acache_enabled(ctx))
+    {
+      if (! dpl_acache_lookup(ctx, loc.bucket, obj_fqn.path, metadatap, sysmdp, &ret2))
+        {
+          //fetch everything so that the entry serves any later caller
+          ret2 = dpl_head(ctx, loc.bucket, obj_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, &metadata, &sysmd);
+          if (DPL_SUCCESS == ret2)
+            {
+              dpl_acache_insert(ctx, loc.bucket, obj_fqn.path, metadata, &sysmd);
+              if (NULL != sysmdp)
+                *sysmdp = sysmd;
+              if (NULL != metadatap)
+                {
+                  *metadatap = metadata;
+                  metadata = NULL;
+                }
+            }
+          else if (DPL_ENOENT == ret2)
+            dpl_acache_insert(ctx, loc.bucket, obj_fqn.path, NULL, NULL);
+        }
+    }
+  else
+    ret2 = dpl_head(ctx, loc.bucket, obj_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, metadatap, sysmdp);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2074,11 +4199,8 @@ dpl_getattr(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
+  if (NULL != metadata)
+    dpl_dict_free(metadata);
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
@@ -2092,51 +4214,25 @@ dpl_getattr_raw(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "getattr locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_head_raw(ctx, bucket, obj_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, metadatap);
+  ret2 = dpl_head_raw(ctx, loc.bucket, obj_fqn.path, NULL, DPL_FTYPE_UNDEF, NULL, metadatap);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2147,12 +4243,6 @@ dpl_getattr_raw(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -2166,59 +4256,34 @@ dpl_setattr(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
   size_t path_len;
   dpl_ftype_t object_type;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "setattr locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  path_len = strlen(path);
-  if (path_len > 0u && path[path_len - 1] == '/')
+  path_len = strlen(loc.path);
+  if (path_len > 0u && loc.path[path_len - 1] == '/')
     object_type = DPL_FTYPE_DIR;
   else
     object_type = DPL_FTYPE_REG;
 
-  ret2 = dpl_copy(ctx, bucket, obj_fqn.path, bucket, obj_fqn.path, NULL, object_type, DPL_COPY_DIRECTIVE_METADATA_REPLACE, metadata, sysmd, NULL);
+  ret2 = dpl_copy(ctx, loc.bucket, obj_fqn.path, loc.bucket, obj_fqn.path, NULL, object_type, DPL_COPY_DIRECTIVE_METADATA_REPLACE, metadata, sysmd, NULL);
+  vfs_invalidate(ctx, loc.bucket, obj_fqn.path);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2229,12 +4294,6 @@ dpl_setattr(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != bucket)
-    free(bucket);
-
-  if (NULL != nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -2250,94 +4309,42 @@ copy_path_to_path(dpl_ctx_t *ctx,
                   dpl_sysmd_t *sysmd)
 {
   int ret, ret2;
-  char *src_nlocator = NULL;
-  char *src_bucket = NULL;
-  char *src_path;
-  char *dst_nlocator = NULL;
-  char *dst_bucket = NULL;
-  char *dst_path;
+  struct vfs_locator src_loc;
+  struct vfs_locator dst_loc;
   dpl_fqn_t dst_obj_fqn, src_obj_fqn;
   size_t path_len;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "copy_path_to_path src_locator=%s dst_locator=%s", src_locator, dst_locator);
 
-  src_nlocator = strdup(src_locator);
-  if (NULL == src_nlocator)
+  ret2 = vfs_locator_parse(ctx, src_locator, &src_loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  src_path = index(src_nlocator, ':');
-  if (NULL != src_path)
-    {
-      *src_path++ = 0;
-      src_bucket = strdup(src_nlocator);
-      if (NULL == src_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      src_bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == src_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      src_path = src_nlocator;
-    }
-
-  dst_nlocator = strdup(dst_locator);
-  if (NULL == dst_nlocator)
+  ret2 = vfs_locator_parse(ctx, dst_locator, &dst_loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  dst_path = index(dst_nlocator, ':');
-  if (NULL != dst_path)
-    {
-      *dst_path++ = 0;
-      dst_bucket = strdup(dst_nlocator);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      dst_bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      dst_path = dst_nlocator;
-    }
-
-  if ((NULL == src_bucket || 0 == src_bucket[0]) /* there is no src_bucket */
+  if (0 == src_loc.bucket[0] /* there is no src_bucket */
       && DPL_COPY_DIRECTIVE_SYMLINK == copy_directive)
     {
-      strcpy(src_obj_fqn.path, src_path);
+      strcpy(src_obj_fqn.path, src_loc.path);
     }
   else
     {
-      ret2 = make_abs_path(ctx, src_bucket, src_path, &src_obj_fqn);
+      ret2 = make_abs_path(ctx, src_loc.bucket, src_loc.path, &src_obj_fqn);
       if (DPL_SUCCESS != ret2)
         {
           ret = ret2;
           goto end;
         }
     }
-  ret2 = make_abs_path(ctx, dst_bucket, dst_path, &dst_obj_fqn);
+  ret2 = make_abs_path(ctx, dst_loc.bucket, dst_loc.path, &dst_obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2359,7 +4366,11 @@ copy_path_to_path(dpl_ctx_t *ctx,
           dst_obj_fqn.path[path_len + 1] = '\0'; //XXX
         }
     }
-  ret2 = dpl_copy(ctx, src_bucket, src_obj_fqn.path, dst_bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  ret2 = dpl_copy(ctx, src_loc.bucket, src_obj_fqn.path, dst_loc.bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  vfs_invalidate(ctx, dst_loc.bucket, dst_obj_fqn.path);
+  if (DPL_COPY_DIRECTIVE_MOVE == copy_directive ||
+      DPL_COPY_DIRECTIVE_MVDENT == copy_directive)
+    vfs_invalidate(ctx, src_loc.bucket, src_obj_fqn.path);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2370,18 +4381,6 @@ copy_path_to_path(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != dst_bucket)
-    free(dst_bucket);
-
-  if (NULL != src_bucket)
-    free(src_bucket);
-
-  if (NULL != dst_nlocator)
-    free(dst_nlocator);
-
-  if (NULL != src_nlocator)
-    free(src_nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -2398,52 +4397,29 @@ copy_id_to_path(dpl_ctx_t *ctx,
                 dpl_sysmd_t *sysmd)
 {
   int ret, ret2;
-  char *dst_nlocator = NULL;
-  char *dst_bucket = NULL;
-  char *dst_path;
+  struct vfs_locator dst_loc;
   dpl_fqn_t dst_obj_fqn;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "copy_id_to_path src_id=%s dst_locator=%s", src_id, dst_locator);
 
-  dst_nlocator = strdup(dst_locator);
-  if (NULL == dst_nlocator)
+  ret2 = vfs_locator_parse(ctx, dst_locator, &dst_loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  dst_path = index(dst_nlocator, ':');
-  if (NULL != dst_path)
-    {
-      *dst_path++ = 0;
-      dst_bucket = strdup(dst_nlocator);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      dst_bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      dst_path = dst_nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, dst_bucket, dst_path, &dst_obj_fqn);
+  ret2 = make_abs_path(ctx, dst_loc.bucket, dst_loc.path, &dst_obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_copy_id(ctx, dst_bucket, src_id, dst_bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  ret2 = dpl_copy_id(ctx, dst_loc.bucket, src_id, dst_loc.bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  if (DPL_FTYPE_DIR == object_type)
+    fqn_append_trailing_slash(&dst_obj_fqn);
+  vfs_invalidate(ctx, dst_loc.bucket, dst_obj_fqn.path);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2454,12 +4430,6 @@ copy_id_to_path(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != dst_bucket)
-    free(dst_bucket);
-
-  if (NULL != dst_nlocator)
-    free(dst_nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -2475,52 +4445,29 @@ copy_name_to_path(dpl_ctx_t *ctx,
                   dpl_sysmd_t *sysmd)
 {
   int ret, ret2;
-  char *dst_nlocator = NULL;
-  char *dst_bucket = NULL;
-  char *dst_path;
+  struct vfs_locator dst_loc;
   dpl_fqn_t dst_obj_fqn;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "copy_name_to_path src_id=%s dst_locator=%s", src_name, dst_locator);
 
-  dst_nlocator = strdup(dst_locator);
-  if (NULL == dst_nlocator)
+  ret2 = vfs_locator_parse(ctx, dst_locator, &dst_loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  dst_path = index(dst_nlocator, ':');
-  if (NULL != dst_path)
-    {
-      *dst_path++ = 0;
-      dst_bucket = strdup(dst_nlocator);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      dst_bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == dst_bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      dst_path = dst_nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, dst_bucket, dst_path, &dst_obj_fqn);
+  ret2 = make_abs_path(ctx, dst_loc.bucket, dst_loc.path, &dst_obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_copy(ctx, dst_bucket, src_name, dst_bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  ret2 = dpl_copy(ctx, dst_loc.bucket, src_name, dst_loc.bucket, dst_obj_fqn.path, NULL, object_type, copy_directive, metadata, sysmd, NULL);
+  if (DPL_FTYPE_DIR == object_type)
+    fqn_append_trailing_slash(&dst_obj_fqn);
+  vfs_invalidate(ctx, dst_loc.bucket, dst_obj_fqn.path);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2531,12 +4478,6 @@ copy_name_to_path(dpl_ctx_t *ctx,
 
  end:
 
-  if (NULL != dst_bucket)
-    free(dst_bucket);
-
-  if (NULL != dst_nlocator)
-    free(dst_nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -2573,52 +4514,26 @@ dpl_readlink(dpl_ctx_t *ctx, const char *locator, char **target_locatorp)
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path = NULL;
+  struct vfs_locator loc;
   char *target = NULL;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "readlink locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (! nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (! bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_get_noredirect(ctx, bucket, obj_fqn.path,
+  ret2 = dpl_get_noredirect(ctx, loc.bucket, obj_fqn.path,
                             DPL_FTYPE_SYMLINK, &target);
   if (DPL_SUCCESS != ret2)
     {
@@ -2636,8 +4551,6 @@ dpl_readlink(dpl_ctx_t *ctx, const char *locator, char **target_locatorp)
 
  end:
 
-  free(bucket);
-  free(nlocator);
   free(target);
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
@@ -2696,51 +4609,25 @@ dpl_fgenurl(dpl_ctx_t *ctx,
 {
   int ret, ret2;
   dpl_fqn_t obj_fqn;
-  char *nlocator = NULL;
-  char *bucket = NULL;
-  char *path;
+  struct vfs_locator loc;
 
   DPL_TRACE(ctx, DPL_TRACE_VFS, "fgenurl locator=%s", locator);
 
-  nlocator = strdup(locator);
-  if (NULL == nlocator)
+  ret2 = vfs_locator_parse(ctx, locator, &loc);
+  if (DPL_SUCCESS != ret2)
     {
-      ret = DPL_ENOMEM;
+      ret = ret2;
       goto end;
     }
 
-  path = index(nlocator, ':');
-  if (NULL != path)
-    {
-      *path++ = 0;
-      bucket = strdup(nlocator);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-    }
-  else
-    {
-      dpl_ctx_lock(ctx);
-      bucket = strdup(ctx->cur_bucket);
-      dpl_ctx_unlock(ctx);
-      if (NULL == bucket)
-        {
-          ret = DPL_ENOMEM;
-          goto end;
-        }
-      path = nlocator;
-    }
-
-  ret2 = make_abs_path(ctx, bucket, path, &obj_fqn);
+  ret2 = make_abs_path(ctx, loc.bucket, loc.path, &obj_fqn);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
       goto end;
     }
 
-  ret2 = dpl_genurl(ctx, bucket, obj_fqn.path, NULL, expires, buf, len, lenp);
+  ret2 = dpl_genurl(ctx, loc.bucket, obj_fqn.path, NULL, expires, buf, len, lenp);
   if (DPL_SUCCESS != ret2)
     {
       ret = ret2;
@@ -2751,12 +4638,6 @@ dpl_fgenurl(dpl_ctx_t *ctx,
 
  end:
 
-  if (bucket)
-    free(bucket);
-
-  if (nlocator)
-    free(nlocator);
-
   DPL_TRACE(ctx, DPL_TRACE_VFS, "ret=%d", ret);
 
   return ret;
@@ -0,0 +1,256 @@
+/* unit test the attribute cache of acache.c */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <check.h>
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "acache_ttl", "60", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "acache_negative_ttl", "60", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "acache_max_entries", "16", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  dpl_assert_int_eq(1, dpl_acache_enabled(ctx));
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+}
+
+static void
+insert(const char *path, size_t size)
+{
+  dpl_sysmd_t sysmd;
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  sysmd.mask = DPL_SYSMD_MASK_SIZE;
+  sysmd.size = size;
+  dpl_acache_insert(ctx, "b", path, NULL, &sysmd);
+}
+
+/* 1 for a positive hit, 0 for a negative one, -1 for a miss */
+static int
+lookup(const char *path)
+{
+  dpl_status_t ret = DPL_FAILURE;
+
+  if (!dpl_acache_lookup(ctx, "b", path, NULL, NULL, &ret))
+    return -1;
+
+  return DPL_SUCCESS == ret;
+}
+
+START_TEST(lookup_test)
+{
+  dpl_acache_stats_t stats;
+  dpl_dict_t *metadata, *out = NULL;
+  dpl_sysmd_t sysmd, outmd;
+  dpl_status_t ret = DPL_FAILURE;
+
+  dpl_assert_int_eq(0, dpl_acache_lookup(ctx, "b", "/o", &out, &outmd, &ret));
+
+  metadata = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(metadata);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(metadata, "color", "blue", 0));
+  memset(&sysmd, 0, sizeof (sysmd));
+  sysmd.mask = DPL_SYSMD_MASK_SIZE;
+  sysmd.size = 42;
+  dpl_acache_insert(ctx, "b", "/o", metadata, &sysmd);
+
+  /* the caller keeps its own */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(metadata, "color", "red", 0));
+
+  /* leading slashes do not matter */
+  dpl_assert_int_eq(1, dpl_acache_lookup(ctx, "b", "o", &out, &outmd, &ret));
+  dpl_assert_int_eq(DPL_SUCCESS, ret);
+  dpl_assert_int_eq(42, outmd.size);
+  dpl_assert_ptr_not_null(out);
+  dpl_assert_str_eq("blue", dpl_dict_get_value(out, "color"));
+  dpl_dict_free(out);
+  dpl_dict_free(metadata);
+
+  /* keyed by bucket, and "o/" is another object */
+  dpl_assert_int_eq(-1, lookup("o/"));
+  dpl_assert_int_eq(0, dpl_acache_lookup(ctx, "c", "o", NULL, NULL, &ret));
+
+  /* negative entries */
+  dpl_acache_insert(ctx, "b", "nope", NULL, NULL);
+  ret = DPL_FAILURE;
+  dpl_assert_int_eq(1, dpl_acache_lookup(ctx, "b", "nope", &out, &outmd, &ret));
+  dpl_assert_int_eq(DPL_ENOENT, ret);
+
+  /* replaced in place */
+  insert("nope", 1);
+  dpl_assert_int_eq(1, lookup("nope"));
+
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(2, stats.n_entries);
+  dpl_assert_int_eq(3, stats.inserts);
+  dpl_assert_int_eq(2, stats.hits);
+  dpl_assert_int_eq(1, stats.negative_hits);
+  dpl_assert_int_eq(3, stats.misses);
+}
+END_TEST
+
+START_TEST(expiry_test)
+{
+  dpl_acache_stats_t stats;
+
+  insert("o", 1);
+  dpl_acache_insert(ctx, "b", "nope", NULL, NULL);
+
+  /* negative entries may be kept for a shorter time, or not at all */
+  ctx->acache_negative_ttl = 0;
+  dpl_acache_insert(ctx, "b", "gone", NULL, NULL);
+  dpl_assert_int_eq(-1, lookup("gone"));
+
+  ctx->acache_ttl = 1;
+  insert("p", 1);
+  dpl_assert_int_eq(1, lookup("p"));
+
+  sleep(2);
+
+  dpl_assert_int_eq(-1, lookup("p"));
+  dpl_assert_int_eq(1, lookup("o"));
+  dpl_assert_int_eq(0, lookup("nope"));
+
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(1, stats.expired);
+  dpl_assert_int_eq(2, stats.n_entries);
+}
+END_TEST
+
+START_TEST(eviction_test)
+{
+  dpl_acache_stats_t stats;
+  char path[32];
+  int i;
+
+  for (i = 0;i < 16;i++)
+    {
+      snprintf(path, sizeof (path), "o%d", i);
+      insert(path, i);
+    }
+
+  /* the oldest is used again, the next one is then the least recent */
+  dpl_assert_int_eq(1, lookup("o0"));
+  insert("o16", 16);
+
+  dpl_assert_int_eq(1, lookup("o0"));
+  dpl_assert_int_eq(-1, lookup("o1"));
+  dpl_assert_int_eq(1, lookup("o2"));
+  dpl_assert_int_eq(1, lookup("o16"));
+
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(16, stats.n_entries);
+  dpl_assert_int_eq(1, stats.evictions);
+}
+END_TEST
+
+START_TEST(invalidate_test)
+{
+  dpl_acache_stats_t stats;
+
+  insert("", 0);
+  insert("d", 0);
+  insert("d/", 0);
+  insert("d/s/", 0);
+  insert("d/s/y", 1);
+  insert("d/s/z", 1);
+  insert("d/t/u", 1);
+  insert("e", 1);
+  dpl_acache_insert(ctx, "b", "d/s/y/", NULL, NULL);
+
+  /* the object in both forms, and all its ancestors */
+  dpl_acache_invalidate(ctx, "b", "/d/s/y");
+  dpl_assert_int_eq(-1, lookup("d/s/y"));
+  dpl_assert_int_eq(-1, lookup("d/s/y/"));
+  dpl_assert_int_eq(-1, lookup("d/s/"));
+  dpl_assert_int_eq(-1, lookup("d/"));
+  dpl_assert_int_eq(-1, lookup("d"));
+  dpl_assert_int_eq(-1, lookup(""));
+  /* not its siblings */
+  dpl_assert_int_eq(1, lookup("d/s/z"));
+  dpl_assert_int_eq(1, lookup("d/t/u"));
+  dpl_assert_int_eq(1, lookup("e"));
+
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(6, stats.invalidations);
+
+  /* a directory, with all that is below it */
+  insert("de", 1);
+  dpl_acache_invalidate(ctx, "b", "d/");
+  dpl_assert_int_eq(-1, lookup("d/s/z"));
+  dpl_assert_int_eq(-1, lookup("d/t/u"));
+  dpl_assert_int_eq(1, lookup("de"));
+  dpl_assert_int_eq(1, lookup("e"));
+
+  /* the root, the whole bucket */
+  dpl_acache_insert(ctx, "c", "e", NULL, NULL);
+  dpl_acache_invalidate(ctx, "b", "/");
+  dpl_assert_int_eq(-1, lookup("de"));
+  dpl_assert_int_eq(-1, lookup("e"));
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(1, stats.n_entries);
+
+  dpl_acache_purge(ctx);
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(0, stats.n_entries);
+}
+END_TEST
+
+START_TEST(disabled_test)
+{
+  dpl_acache_stats_t stats;
+
+  dpl_acache_free(ctx);
+  dpl_assert_int_eq(0, dpl_acache_enabled(ctx));
+
+  insert("o", 1);
+  dpl_assert_int_eq(-1, lookup("o"));
+  dpl_acache_invalidate(ctx, "b", "o");
+
+  dpl_acache_get_stats(ctx, &stats);
+  dpl_assert_int_eq(0, stats.inserts);
+  dpl_assert_int_eq(0, stats.misses);
+}
+END_TEST
+
+Suite *
+acache_suite(void)
+{
+  Suite *s = suite_create("acache");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, lookup_test);
+  tcase_add_test(t, expiry_test);
+  tcase_add_test(t, eviction_test);
+  tcase_add_test(t, invalidate_test);
+  tcase_add_test(t, disabled_test);
+  suite_add_tcase(s, t);
+  return s;
+}
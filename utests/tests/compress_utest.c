@@ -0,0 +1,708 @@
+/* unit test the transparent compression of compress.c, and of rest.c against a fake backend */
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+#define CHUNK DPL_COMPRESS_CHUNK_SIZE
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+static const char *codec_names[] = { "zstd", "zlib", NULL };
+
+/* the one object of the fake backend, and the requests it got */
+static char *object_buf;
+static uint64_t object_len;
+static dpl_dict_t *object_md;
+static dpl_dict_t *upload_md;
+static int n_head;
+static int n_get;
+
+static void
+object_set(const char *buf, uint64_t len, const dpl_dict_t *md)
+{
+  free(object_buf);
+  object_buf = malloc(len > 0 ? len : 1);
+  dpl_assert_ptr_not_null(object_buf);
+  memcpy(object_buf, buf, len);
+  object_len = len;
+
+  if (NULL != object_md)
+    dpl_dict_free(object_md);
+  object_md = NULL != md ? dpl_dict_dup(md) : dpl_dict_new(13);
+  dpl_assert_ptr_not_null(object_md);
+}
+
+static dpl_status_t
+fake_put(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, const dpl_dict_t *metadata,
+         const dpl_sysmd_t *sysmd, const char *data_buf,
+         unsigned int data_len, const dpl_dict_t *query_params,
+         dpl_sysmd_t *returned_sysmdp, char **locationp)
+{
+  object_set(data_buf, data_len, metadata);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_get(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, char **data_bufp,
+         unsigned int *data_lenp, dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp, char **locationp)
+{
+  uint64_t start = 0, end = object_len;
+  char *buf;
+
+  n_get++;
+
+  if (NULL == object_buf)
+    return DPL_ENOENT;
+
+  if (NULL != range)
+    {
+      start = range->start;
+      if (DPL_UNDEF != range->end && range->end < object_len)
+        end = range->end + 1;
+      if (start >= object_len)
+        return DPL_ERANGEUNAVAIL;
+    }
+
+  if (NULL != option && option->mask & DPL_OPTION_NOALLOC)
+    {
+      end = MIN(end, start + *data_lenp);
+      memcpy(*data_bufp, object_buf + start, end - start);
+    }
+  else
+    {
+      buf = malloc(end - start + 1);
+      if (NULL == buf)
+        return DPL_ENOMEM;
+      memcpy(buf, object_buf + start, end - start);
+      *data_bufp = buf;
+    }
+  *data_lenp = end - start;
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_dup(object_md);
+
+  if (NULL != sysmdp)
+    {
+      sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
+      sysmdp->size = end - start;
+    }
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_head(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+          const char *subresource, const dpl_option_t *option,
+          dpl_ftype_t object_type, const dpl_condition_t *condition,
+          dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp)
+{
+  n_head++;
+
+  if (NULL == object_buf)
+    return DPL_ENOENT;
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_dup(object_md);
+
+  if (NULL != sysmdp)
+    {
+      sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
+      sysmdp->size = object_len;
+    }
+
+  return DPL_SUCCESS;
+}
+
+/* like S3, a stream takes its metadata with its first part */
+static dpl_status_t
+fake_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream, char *buf,
+                unsigned int len, struct json_object **statusp)
+{
+  char *tmp;
+
+  if (NULL == upload_md)
+    {
+      upload_md = NULL != stream->md ? dpl_dict_dup(stream->md) : dpl_dict_new(13);
+      object_set("", 0, upload_md);
+    }
+
+  tmp = realloc(object_buf, object_len + len + 1);
+  if (NULL == tmp)
+    return DPL_ENOMEM;
+  object_buf = tmp;
+  memcpy(object_buf + object_len, buf, len);
+  object_len += len;
+
+  if (NULL != statusp)
+    *statusp = NULL;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_stream_flush(dpl_ctx_t *ctx, dpl_stream_t *stream)
+{
+  return DPL_SUCCESS;
+}
+
+static dpl_backend_t fake_backend =
+  {
+    .name = "fake",
+    .put = fake_put,
+    .get = fake_get,
+    .head = fake_head,
+    .stream_put = fake_stream_put,
+    .stream_flush = fake_stream_flush,
+  };
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "compress", "true", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  ctx->backend = &fake_backend;
+
+  n_head = n_get = 0;
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+
+  free(object_buf);
+  object_buf = NULL;
+  object_len = 0;
+  if (NULL != object_md)
+    dpl_dict_free(object_md);
+  object_md = NULL;
+  if (NULL != upload_md)
+    dpl_dict_free(upload_md);
+  upload_md = NULL;
+}
+
+static void
+use_codec(const char *name)
+{
+  free(ctx->compress_codec);
+  ctx->compress_codec = strdup(name);
+  dpl_assert_ptr_not_null(ctx->compress_codec);
+}
+
+static void
+fill_text(char *buf, size_t len)
+{
+  size_t off = 0;
+  int i = 0, n;
+  char line[64];
+
+  while (off < len)
+    {
+      n = snprintf(line, sizeof (line), "%08d GET /bucket/object-%d 200\n", i, i % 37);
+      n = MIN((size_t) n, len - off);
+      memcpy(buf + off, line, n);
+      off += n;
+      i++;
+    }
+}
+
+static void
+fill_random(char *buf, size_t len)
+{
+  uint32_t x = 2463534242u;
+  size_t i;
+
+  for (i = 0;i < len;i++)
+    {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      buf[i] = x;
+    }
+}
+
+/* three text chunks but an incompressible second one, and a short one */
+static char *
+data_new(uint64_t len)
+{
+  char *buf;
+
+  buf = malloc(len);
+  dpl_assert_ptr_not_null(buf);
+  fill_text(buf, len);
+  if (len > 2 * CHUNK)
+    fill_random(buf + CHUNK, CHUNK);
+
+  return buf;
+}
+
+/* compress data as one object, sized or not */
+static char *
+stored_new(const char *data, uint64_t len, int sized,
+           size_t *stored_lenp, dpl_dict_t **mdp)
+{
+  dpl_compress_t *comp;
+  char *stored;
+  size_t stored_len;
+
+  comp = dpl_compress_new(ctx);
+  dpl_assert_ptr_not_null(comp);
+  stored = malloc(len + (len / CHUNK + 1) * 4 + DPL_COMPRESS_TRAILER_SIZE);
+  dpl_assert_ptr_not_null(stored);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_deflate(comp, data, len, stored, &stored_len));
+  dpl_assert_int_eq(stored_len, comp->offsets[comp->n_chunks]);
+  stored_len += dpl_compress_write_index(comp, stored + stored_len);
+
+  *mdp = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(*mdp);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_seal(comp, *mdp, sized));
+  dpl_compress_destroy(comp);
+
+  *stored_lenp = stored_len;
+
+  return stored;
+}
+
+START_TEST(roundtrip_test)
+{
+  uint64_t len = 3 * CHUNK + 100;
+  dpl_compress_t *comp;
+  dpl_dict_t *md;
+  dpl_range_t range;
+  char *data, *stored, *split, *out;
+  size_t stored_len, split_len, out_len;
+  int i, sized;
+
+  data = data_new(len);
+  out = malloc(len);
+  dpl_assert_ptr_not_null(out);
+
+  for (i = 0;NULL != codec_names[i];i++)
+    {
+      if (!dpl_compress_codec_supported(codec_names[i]))
+        continue ;
+      use_codec(codec_names[i]);
+
+      for (sized = 0;sized <= 1;sized++)
+        {
+          stored = stored_new(data, len, sized, &stored_len, &md);
+          dpl_assert_str_eq(codec_names[i], dpl_dict_get_value(md, DPL_COMPRESS_MD_CODEC));
+          dpl_assert_int_eq(sized, NULL != dpl_dict_get(md, DPL_COMPRESS_MD_SIZE));
+          ck_assert_msg(stored_len < len, "%s stored %zu bytes", codec_names[i], stored_len);
+
+          dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+          dpl_assert_int_eq(sized ? len : DPL_UNDEF, comp->size);
+
+          /* without the size, the trailer comes first */
+          dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_index_range(comp, stored_len, &range));
+          if (!sized)
+            {
+              dpl_assert_int_eq(stored_len - DPL_COMPRESS_TRAILER_SIZE, range.start);
+              dpl_assert_int_eq(DPL_SUCCESS,
+                                dpl_compress_load_index(comp, stored_len,
+                                                        stored + range.start,
+                                                        range.end + 1 - range.start));
+              dpl_assert_ptr_null(comp->offsets);
+              dpl_assert_int_eq(len, comp->size);
+              dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_index_range(comp, stored_len, &range));
+            }
+          dpl_assert_int_eq(stored_len - 4 * 4 - DPL_COMPRESS_TRAILER_SIZE, range.start);
+          dpl_assert_int_eq(stored_len - 1, range.end);
+          dpl_assert_int_eq(DPL_SUCCESS,
+                            dpl_compress_load_index(comp, stored_len, stored + range.start,
+                                                    range.end + 1 - range.start));
+          dpl_assert_ptr_not_null(comp->offsets);
+          dpl_assert_int_eq(4, comp->n_chunks);
+
+          /* the random chunk is stored as is */
+          dpl_assert_int_eq(CHUNK, comp->offsets[2] - comp->offsets[1]);
+          ck_assert_msg(comp->offsets[1] < CHUNK / 2, "text chunk stored in %llu bytes",
+                        (unsigned long long) comp->offsets[1]);
+
+          dpl_assert_int_eq(DPL_SUCCESS,
+                            dpl_compress_inflate(comp, 0, stored, comp->index_offset,
+                                                 out, &out_len));
+          dpl_assert_int_eq(len, out_len);
+          dpl_assert_int_eq(0, memcmp(data, out, len));
+
+          /* from the middle */
+          dpl_assert_int_eq(DPL_SUCCESS,
+                            dpl_compress_inflate(comp, 2, stored + comp->offsets[2],
+                                                 comp->index_offset - comp->offsets[2],
+                                                 out, &out_len));
+          dpl_assert_int_eq(CHUNK + 100, out_len);
+          dpl_assert_int_eq(0, memcmp(data + 2 * CHUNK, out, out_len));
+
+          dpl_compress_destroy(comp);
+          dpl_dict_free(md);
+          free(stored);
+        }
+
+      /* the same, compressed in two calls */
+      stored = stored_new(data, len, 1, &stored_len, &md);
+      comp = dpl_compress_new(ctx);
+      dpl_assert_ptr_not_null(comp);
+      split = malloc(stored_len);
+      dpl_assert_ptr_not_null(split);
+      dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_deflate(comp, data, 2 * CHUNK, split, &split_len));
+      dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_deflate(comp, data + 2 * CHUNK, len - 2 * CHUNK,
+                                                          split + split_len, &out_len));
+      split_len += out_len;
+      split_len += dpl_compress_write_index(comp, split + split_len);
+      dpl_assert_int_eq(stored_len, split_len);
+      dpl_assert_int_eq(0, memcmp(stored, split, stored_len));
+      free(split);
+      dpl_compress_destroy(comp);
+      dpl_dict_free(md);
+      free(stored);
+    }
+
+  free(data);
+  free(out);
+}
+END_TEST
+
+START_TEST(range_test)
+{
+  uint64_t len = 3 * CHUNK + 100;
+  dpl_compress_t *comp;
+  dpl_dict_t *md;
+  dpl_range_t range;
+  char *data, *stored;
+  size_t stored_len;
+
+  if (!dpl_compress_codec_supported("zlib") && !dpl_compress_codec_supported("zstd"))
+    return ;
+
+  data = data_new(len);
+  stored = stored_new(data, len, 1, &stored_len, &md);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_load_index(comp, stored_len, stored, stored_len));
+
+  dpl_assert_int_eq(0, dpl_compress_range(comp, 0, 0, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(comp->offsets[1] - 1, range.end);
+
+  dpl_assert_int_eq(0, dpl_compress_range(comp, CHUNK - 1, CHUNK - 1, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(comp->offsets[1] - 1, range.end);
+
+  dpl_assert_int_eq(0, dpl_compress_range(comp, CHUNK - 1, CHUNK, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(comp->offsets[2] - 1, range.end);
+
+  dpl_assert_int_eq(1, dpl_compress_range(comp, CHUNK, 2 * CHUNK - 1, &range));
+  dpl_assert_int_eq(comp->offsets[1], range.start);
+  dpl_assert_int_eq(comp->offsets[2] - 1, range.end);
+
+  /* the short last chunk ends before the index */
+  dpl_assert_int_eq(3, dpl_compress_range(comp, len - 1, len - 1, &range));
+  dpl_assert_int_eq(comp->offsets[3], range.start);
+  dpl_assert_int_eq(comp->index_offset - 1, range.end);
+
+  dpl_compress_destroy(comp);
+  dpl_dict_free(md);
+  free(stored);
+  free(data);
+}
+END_TEST
+
+START_TEST(corrupt_test)
+{
+  uint64_t len = 3 * CHUNK + 100;
+  dpl_compress_t *comp;
+  dpl_dict_t *md;
+  char *data, *stored, *out, *index;
+  size_t stored_len, index_len, out_len;
+
+  /* zstd frames carry no checksum, a corrupt chunk may inflate */
+  if (!dpl_compress_codec_supported("zlib"))
+    return ;
+  use_codec("zlib");
+
+  data = data_new(len);
+  out = malloc(len);
+  dpl_assert_ptr_not_null(out);
+  stored = stored_new(data, len, 1, &stored_len, &md);
+  index_len = 4 * 4 + DPL_COMPRESS_TRAILER_SIZE;
+  index = stored + stored_len - index_len;
+
+  /* an index entry changed, zeroed or larger than its chunk */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  index[3] ^= 1;
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, stored_len, index, index_len));
+  index[3] ^= 1;
+  memset(index + 4, 0, 4);
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, stored_len, index, index_len));
+  index[5] = 2;
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, stored_len, index, index_len));
+  dpl_assert_ptr_null(comp->offsets);
+  dpl_compress_destroy(comp);
+  dpl_dict_free(md);
+  free(stored);
+
+  /* the size of the trailer and that of the metadata disagree */
+  stored = stored_new(data, len, 1, &stored_len, &md);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(md, DPL_COMPRESS_MD_SIZE, "196709", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, stored_len, stored, stored_len));
+  dpl_compress_destroy(comp);
+  dpl_dict_free(md);
+  free(stored);
+
+  /* a truncated object */
+  stored = stored_new(data, len, 0, &stored_len, &md);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, stored_len - 1, stored, stored_len - 1));
+  dpl_compress_destroy(comp);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_load_index(comp, 7, stored, 7));
+  dpl_compress_destroy(comp);
+
+  /* a corrupt chunk */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_compress_load_index(comp, stored_len, stored, stored_len));
+  stored[10] ^= 0x55;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_compress_inflate(comp, 0, stored, comp->index_offset, out, &out_len));
+  stored[10] ^= 0x55;
+  /* or missing */
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_compress_inflate(comp, 0, stored, comp->offsets[1] - 1, out, &out_len));
+  dpl_compress_destroy(comp);
+  free(stored);
+
+  /* malformed metadata */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(md, DPL_COMPRESS_MD_CHUNK, "12", 0));
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(md, DPL_COMPRESS_MD_CHUNK, "65536x", 0));
+  dpl_assert_int_eq(DPL_EINTEGRITY, dpl_compress_open(ctx, md, &comp));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(md, DPL_COMPRESS_MD_CODEC, "lzma", 0));
+  dpl_assert_int_eq(DPL_ENOTSUPP, dpl_compress_open(ctx, md, &comp));
+  dpl_compress_strip(md);
+  dpl_assert_int_eq(DPL_ENOENT, dpl_compress_open(ctx, md, &comp));
+  dpl_dict_free(md);
+
+  free(data);
+  free(out);
+}
+END_TEST
+
+START_TEST(worthwhile_test)
+{
+  size_t len = 4 * CHUNK;
+  char *buf;
+  int i;
+
+  buf = malloc(len);
+  dpl_assert_ptr_not_null(buf);
+
+  for (i = 0;NULL != codec_names[i];i++)
+    {
+      if (!dpl_compress_codec_supported(codec_names[i]))
+        continue ;
+      use_codec(codec_names[i]);
+
+      fill_text(buf, len);
+      dpl_assert_int_eq(1, dpl_compress_worthwhile(ctx, buf, len));
+      dpl_assert_int_eq(1, dpl_compress_worthwhile(ctx, buf, 5000));
+      /* too small to bother */
+      dpl_assert_int_eq(0, dpl_compress_worthwhile(ctx, buf, 1000));
+
+      fill_random(buf, len);
+      dpl_assert_int_eq(0, dpl_compress_worthwhile(ctx, buf, len));
+      dpl_assert_int_eq(0, dpl_compress_worthwhile(ctx, buf, 5000));
+    }
+
+  free(buf);
+}
+END_TEST
+
+/* read back what was stored */
+static void
+check_get(const char *data, uint64_t len,
+          const dpl_range_t *range)
+{
+  uint64_t start = 0, end = len;
+  char *buf = NULL;
+  unsigned int buf_len = 0;
+
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, range,
+                            &buf, &buf_len, NULL, NULL));
+  if (NULL != range)
+    {
+      start = range->start;
+      if (DPL_UNDEF != range->end && range->end < len)
+        end = range->end + 1;
+    }
+  dpl_assert_int_eq(end - start, buf_len);
+  dpl_assert_int_eq(0, memcmp(data + start, buf, buf_len));
+  free(buf);
+}
+
+START_TEST(get_test)
+{
+  uint64_t len = 3 * CHUNK + 100;
+  char *data, buf[10], *bufp = buf;
+  unsigned int buf_len;
+  dpl_option_t option;
+  dpl_range_t range;
+  dpl_sysmd_t sysmd;
+  dpl_dict_t *md = NULL;
+
+  if (!dpl_compress_codec_supported("zlib") && !dpl_compress_codec_supported("zstd"))
+    return ;
+
+  data = data_new(len);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_put(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            NULL, NULL, data, len));
+  ck_assert_msg(object_len < len, "stored %llu bytes", (unsigned long long) object_len);
+  dpl_assert_ptr_not_null(dpl_dict_get(object_md, DPL_COMPRESS_MD_SIZE));
+
+  /* one request for the whole object */
+  check_get(data, len, NULL);
+  dpl_assert_int_eq(0, n_head);
+  dpl_assert_int_eq(1, n_get);
+
+  /* the size is in the metadata, the chunk index is read at once */
+  n_get = 0;
+  range.start = CHUNK - 1;
+  range.end = 2 * CHUNK;
+  check_get(data, len, &range);
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(2, n_get);
+
+  range.start = len - 1;
+  range.end = DPL_UNDEF;
+  check_get(data, len, &range);
+  range.start = len;
+  dpl_assert_int_eq(DPL_ERANGEUNAVAIL,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, &range,
+                            &bufp, &buf_len, NULL, NULL));
+
+  /* into a buffer of the caller, truncated to its size */
+  memset(&option, 0, sizeof (option));
+  option.mask = DPL_OPTION_NOALLOC;
+  buf_len = sizeof (buf);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get(ctx, "b", "o", &option, DPL_FTYPE_REG, NULL, NULL,
+                            &bufp, &buf_len, &md, NULL));
+  dpl_assert_ptr_eq(buf, bufp);
+  dpl_assert_int_eq(sizeof (buf), buf_len);
+  dpl_assert_int_eq(0, memcmp(data, buf, sizeof (buf)));
+  dpl_assert_ptr_null(dpl_dict_get(md, DPL_COMPRESS_MD_CODEC));
+  dpl_dict_free(md);
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_head(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(len, sysmd.size);
+
+  /* a truncated object */
+  object_len--;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            &bufp, &buf_len, NULL, NULL));
+
+  /* an object which is not compressed costs a HEAD more, not a GET */
+  object_set(data, len, NULL);
+  n_head = n_get = 0;
+  range.start = 5;
+  range.end = 10;
+  check_get(data, len, &range);
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(1, n_get);
+
+  free(data);
+}
+END_TEST
+
+START_TEST(stream_test)
+{
+  uint64_t len = 3 * CHUNK + 100;
+  dpl_stream_t *stream = NULL;
+  struct json_object *status = NULL;
+  dpl_range_t range;
+  dpl_sysmd_t sysmd;
+  char *data;
+
+  if (!dpl_compress_codec_supported("zlib") && !dpl_compress_codec_supported("zstd"))
+    return ;
+
+  data = data_new(len);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_stream_open(ctx, "b", "o", NULL, NULL, NULL, NULL, &stream));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_put(ctx, stream, data, CHUNK + 1, &status));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_put(ctx, stream, data + CHUNK + 1, len - CHUNK - 1, &status));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_flush(ctx, stream));
+  dpl_stream_close(ctx, stream);
+
+  /* the metadata went along with the first part, without the size */
+  dpl_assert_ptr_not_null(dpl_dict_get(upload_md, DPL_COMPRESS_MD_CODEC));
+  dpl_assert_ptr_null(dpl_dict_get(upload_md, DPL_COMPRESS_MD_SIZE));
+  ck_assert_msg(object_len < len, "stored %llu bytes", (unsigned long long) object_len);
+
+  check_get(data, len, NULL);
+
+  /* the trailer, then the chunk index */
+  n_head = n_get = 0;
+  range.start = 2 * CHUNK + 1;
+  range.end = 2 * CHUNK + 2;
+  check_get(data, len, &range);
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(3, n_get);
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_head(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(DPL_SYSMD_MASK_SIZE, sysmd.mask & DPL_SYSMD_MASK_SIZE);
+  dpl_assert_int_eq(len, sysmd.size);
+
+  free(data);
+}
+END_TEST
+
+Suite *
+compress_suite(void)
+{
+  Suite *s = suite_create("compress");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, roundtrip_test);
+  tcase_add_test(t, range_test);
+  tcase_add_test(t, corrupt_test);
+  tcase_add_test(t, worthwhile_test);
+  tcase_add_test(t, get_test);
+  tcase_add_test(t, stream_test);
+  suite_add_tcase(s, t);
+  return s;
+}
@@ -0,0 +1,290 @@
+/* unit test the server side copies of rest.c against a fake backend */
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include "dropletp.h"
+#include "droplet/s3/s3.h"
+#include "droplet/parallel.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/* what the fake backend saw */
+static int n_head;
+static int n_copy;
+static int n_delete;
+static int n_part_copy;
+static int n_complete;
+static dpl_copy_directive_t copy_directives[4];
+static uint64_t object_size;
+static uint64_t n_copied;
+
+static dpl_status_t
+fake_head(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+          const char *subresource, const dpl_option_t *option,
+          dpl_ftype_t object_type, const dpl_condition_t *condition,
+          dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp)
+{
+  n_head++;
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_new(13);
+
+  /* sized by the header parser, as from a real reply */
+  if (NULL != sysmdp)
+    {
+      char value[32];
+
+      snprintf(value, sizeof (value), "%llu", (unsigned long long) object_size);
+      dpl_assert_int_eq(DPL_SUCCESS,
+                        dpl_s3_get_metadatum_from_header("content-length", value,
+                                                         NULL, NULL, NULL, sysmdp));
+      sysmdp->mask |= DPL_SYSMD_MASK_ETAG;
+      strcpy(sysmdp->etag, "0123456789abcdef");
+    }
+
+  return DPL_SUCCESS;
+}
+
+/* like S3, no rename */
+static dpl_status_t
+fake_copy(dpl_ctx_t *ctx, const char *src_bucket, const char *src_resource,
+          const char *src_subresource, const char *dst_bucket,
+          const char *dst_resource, const char *dst_subresource,
+          const dpl_option_t *option, dpl_ftype_t object_type,
+          dpl_copy_directive_t copy_directive, const dpl_dict_t *metadata,
+          const dpl_sysmd_t *sysmd, const dpl_condition_t *condition,
+          char **locationp)
+{
+  if (n_copy < 4)
+    copy_directives[n_copy] = copy_directive;
+  n_copy++;
+
+  if (DPL_COPY_DIRECTIVE_COPY != copy_directive &&
+      DPL_COPY_DIRECTIVE_METADATA_REPLACE != copy_directive)
+    return DPL_ENOTSUPP;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_delete(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+            const char *subresource, const dpl_option_t *option,
+            dpl_ftype_t object_type, const dpl_condition_t *condition,
+            char **locationp)
+{
+  n_delete++;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_init(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                    const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd,
+                    const char **uploadidp)
+{
+  *uploadidp = strdup("upload");
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_copy(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                    const char *uploadid, unsigned int partnb,
+                    const char *src_bucket, const char *src_resource,
+                    const dpl_range_t *range, const dpl_condition_t *condition,
+                    const char **etagp)
+{
+  __sync_fetch_and_add(&n_part_copy, 1);
+  __sync_fetch_and_add(&n_copied, range->end + 1 - range->start);
+  *etagp = strdup("\"part\"");
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_complete(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                        const char *uploadid, struct json_object *parts,
+                        unsigned int n_parts, const dpl_dict_t *metadata,
+                        const dpl_sysmd_t *sysmd)
+{
+  n_complete++;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_abort(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                     const char *uploadid)
+{
+  return DPL_SUCCESS;
+}
+
+static dpl_backend_t fake_backend =
+  {
+    .name = "fake",
+    .head = fake_head,
+    .deletef = fake_delete,
+    .copy = fake_copy,
+    .multipart_init = fake_multipart_init,
+    .multipart_complete = fake_multipart_complete,
+    .multipart_abort = fake_multipart_abort,
+    .multipart_copy = fake_multipart_copy,
+  };
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  ctx->backend = &fake_backend;
+
+  n_head = n_copy = n_delete = n_part_copy = n_complete = 0;
+  n_copied = 0;
+  memset(copy_directives, 0, sizeof (copy_directives));
+  object_size = 1000;
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+}
+
+START_TEST(copy_one_head_test)
+{
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_copy(ctx, "b", "src", "b", "dst", NULL, DPL_FTYPE_REG,
+                             DPL_COPY_DIRECTIVE_COPY, NULL, NULL, NULL));
+  /* sized once to pick the copy flavor, not again */
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(1, n_copy);
+  dpl_assert_int_eq(DPL_COPY_DIRECTIVE_COPY, copy_directives[0]);
+  dpl_assert_int_eq(0, n_delete);
+
+  /* no HEAD at all when copies are never split */
+  n_head = 0;
+  ctx->copy_parallel_threshold = 0;
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_copy(ctx, "b", "src", "b", "dst", NULL, DPL_FTYPE_REG,
+                             DPL_COPY_DIRECTIVE_COPY, NULL, NULL, NULL));
+  dpl_assert_int_eq(0, n_head);
+}
+END_TEST
+
+START_TEST(move_small_test)
+{
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_copy(ctx, "b", "src", "b", "dst", NULL, DPL_FTYPE_REG,
+                             DPL_COPY_DIRECTIVE_MOVE, NULL, NULL, NULL));
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(2, n_copy);
+  dpl_assert_int_eq(DPL_COPY_DIRECTIVE_MOVE, copy_directives[0]);
+  dpl_assert_int_eq(DPL_COPY_DIRECTIVE_COPY, copy_directives[1]);
+  dpl_assert_int_eq(1, n_delete);
+  dpl_assert_int_eq(0, n_part_copy);
+}
+END_TEST
+
+START_TEST(move_large_test)
+{
+  object_size = 100*1024*1024;
+  ctx->copy_parallel_threshold = 1024*1024;
+
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_copy(ctx, "b", "src", "b", "dst", NULL, DPL_FTYPE_REG,
+                             DPL_COPY_DIRECTIVE_MOVE, NULL, NULL, NULL));
+  /* the parallel copy reuses the HEAD of dpl_copy() */
+  dpl_assert_int_eq(1, n_head);
+  dpl_assert_int_eq(0, n_copy);
+  dpl_assert_int_eq(2, n_part_copy);
+  dpl_assert_int_eq(1, n_complete);
+  dpl_assert_int_eq(1, n_delete);
+}
+END_TEST
+
+START_TEST(copy_huge_test)
+{
+  /* beyond what an int holds */
+  object_size = 5ULL*1024*1024*1024;
+
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_copy(ctx, "b", "src", "b", "dst", NULL, DPL_FTYPE_REG,
+                             DPL_COPY_DIRECTIVE_COPY, NULL, NULL, NULL));
+  dpl_assert_int_eq(0, n_copy);
+  dpl_assert_int_eq(object_size / DPL_PARALLEL_DEFAULT_COPY_PART_SIZE, n_part_copy);
+  dpl_assert_int_eq(object_size, n_copied);
+  dpl_assert_int_eq(1, n_complete);
+}
+END_TEST
+
+START_TEST(content_length_test)
+{
+  dpl_sysmd_t sysmd;
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_s3_get_metadatum_from_header("content-length", "5368709120",
+                                                     NULL, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(DPL_SYSMD_MASK_SIZE, sysmd.mask);
+  dpl_assert_int_eq(5368709120ULL, sysmd.size);
+
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_get_metadatum_from_header("content-length", "12x",
+                                                     NULL, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_get_metadatum_from_header("content-length", "-1",
+                                                     NULL, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_get_metadatum_from_header("content-length", "",
+                                                     NULL, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_get_metadatum_from_header("content-length", "184467440737095516160",
+                                                     NULL, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(0, sysmd.mask);
+}
+END_TEST
+
+START_TEST(move_dir_test)
+{
+  /* moving a directory entry alone would orphan its children */
+  dpl_assert_int_eq(DPL_ENOTSUPP,
+                    dpl_copy(ctx, "b", "src/", "b", "dst/", NULL, DPL_FTYPE_DIR,
+                             DPL_COPY_DIRECTIVE_MOVE, NULL, NULL, NULL));
+  dpl_assert_int_eq(1, n_copy);
+  dpl_assert_int_eq(0, n_delete);
+}
+END_TEST
+
+Suite *
+copy_suite(void)
+{
+  Suite *s = suite_create("copy");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, copy_one_head_test);
+  tcase_add_test(t, move_small_test);
+  tcase_add_test(t, move_large_test);
+  tcase_add_test(t, move_dir_test);
+  tcase_add_test(t, copy_huge_test);
+  tcase_add_test(t, content_length_test);
+  suite_add_tcase(s, t);
+  return s;
+}
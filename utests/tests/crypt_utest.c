@@ -0,0 +1,748 @@
+/* unit test the client side encryption of crypt.c, and of rest.c against a fake backend */
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include "dropletp.h"
+#include "droplet/parallel.h"
+
+#include "utest_main.h"
+
+#define CHUNK DPL_CRYPT_CHUNK_SIZE
+#define CIPHER_CHUNK (CHUNK + DPL_CRYPT_TAG_SIZE)
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/* the one object of the fake backend */
+static char *object_buf;
+static uint64_t object_len;
+static dpl_dict_t *object_md;
+
+/* the upload in progress */
+#define MAX_PARTS 16
+static char *part_bufs[MAX_PARTS + 1];
+static unsigned int part_lens[MAX_PARTS + 1];
+static dpl_dict_t *upload_md;
+
+static void
+object_set(const char *buf, uint64_t len, const dpl_dict_t *md)
+{
+  free(object_buf);
+  object_buf = malloc(len > 0 ? len : 1);
+  dpl_assert_ptr_not_null(object_buf);
+  memcpy(object_buf, buf, len);
+  object_len = len;
+
+  if (NULL != object_md)
+    dpl_dict_free(object_md);
+  object_md = NULL != md ? dpl_dict_dup(md) : dpl_dict_new(13);
+  dpl_assert_ptr_not_null(object_md);
+}
+
+static dpl_status_t
+fake_put(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, const dpl_dict_t *metadata,
+         const dpl_sysmd_t *sysmd, const char *data_buf,
+         unsigned int data_len, const dpl_dict_t *query_params,
+         dpl_sysmd_t *returned_sysmdp, char **locationp)
+{
+  object_set(data_buf, data_len, metadata);
+
+  return DPL_SUCCESS;
+}
+
+/* like S3, a range past the end is refused and one overlapping it is cut */
+static dpl_status_t
+fake_get(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, char **data_bufp,
+         unsigned int *data_lenp, dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp, char **locationp)
+{
+  uint64_t start = 0, end = object_len;
+  char *buf;
+
+  if (NULL == object_buf)
+    return DPL_ENOENT;
+
+  if (NULL != range)
+    {
+      start = range->start;
+      if (DPL_UNDEF != range->end && range->end < object_len)
+        end = range->end + 1;
+      if (start >= object_len)
+        return DPL_ERANGEUNAVAIL;
+    }
+
+  buf = malloc(end - start + 1);
+  if (NULL == buf)
+    return DPL_ENOMEM;
+  memcpy(buf, object_buf + start, end - start);
+  *data_bufp = buf;
+  *data_lenp = end - start;
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_dup(object_md);
+
+  if (NULL != sysmdp)
+    {
+      sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
+      sysmdp->size = end - start;
+    }
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_head(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+          const char *subresource, const dpl_option_t *option,
+          dpl_ftype_t object_type, const dpl_condition_t *condition,
+          dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp)
+{
+  if (NULL == object_buf)
+    return DPL_ENOENT;
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_dup(object_md);
+
+  if (NULL != sysmdp)
+    {
+      sysmdp->mask |= DPL_SYSMD_MASK_SIZE;
+      sysmdp->size = object_len;
+    }
+
+  return DPL_SUCCESS;
+}
+
+/* like S3, the metadata is taken when the upload is initiated */
+static dpl_status_t
+fake_multipart_init(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                    const dpl_dict_t *metadata, const dpl_sysmd_t *sysmd,
+                    const char **uploadidp)
+{
+  upload_md = NULL != metadata ? dpl_dict_dup(metadata) : dpl_dict_new(13);
+  *uploadidp = strdup("upload");
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_put(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                   const char *uploadid, unsigned int partnb,
+                   char *buf, unsigned int len, const char **etagp)
+{
+  if (partnb < 1 || partnb > MAX_PARTS)
+    return DPL_ELIMIT;
+
+  free(part_bufs[partnb]);
+  part_bufs[partnb] = malloc(len > 0 ? len : 1);
+  if (NULL == part_bufs[partnb])
+    return DPL_ENOMEM;
+  memcpy(part_bufs[partnb], buf, len);
+  part_lens[partnb] = len;
+  *etagp = strdup("\"part\"");
+
+  return DPL_SUCCESS;
+}
+
+/* and ignored at completion */
+static dpl_status_t
+fake_multipart_complete(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                        const char *uploadid, struct json_object *parts,
+                        unsigned int n_parts, const dpl_dict_t *metadata,
+                        const dpl_sysmd_t *sysmd)
+{
+  char *buf;
+  uint64_t len = 0;
+  unsigned int i;
+
+  for (i = 1;i <= n_parts;i++)
+    len += part_lens[i];
+
+  buf = malloc(len + 1);
+  if (NULL == buf)
+    return DPL_ENOMEM;
+  for (len = 0, i = 1;i <= n_parts;i++)
+    {
+      memcpy(buf + len, part_bufs[i], part_lens[i]);
+      len += part_lens[i];
+    }
+
+  object_set(buf, len, upload_md);
+  free(buf);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_multipart_abort(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+                     const char *uploadid)
+{
+  return DPL_SUCCESS;
+}
+
+/* a stream is an upload initiated by its first put */
+static dpl_status_t
+fake_stream_put(dpl_ctx_t *ctx, dpl_stream_t *stream, char *buf,
+                unsigned int len, struct json_object **statusp)
+{
+  char *tmp;
+
+  if (NULL == upload_md)
+    {
+      upload_md = NULL != stream->md ? dpl_dict_dup(stream->md) : dpl_dict_new(13);
+      free(part_bufs[1]);
+      part_bufs[1] = NULL;
+      part_lens[1] = 0;
+    }
+
+  tmp = realloc(part_bufs[1], part_lens[1] + len + 1);
+  if (NULL == tmp)
+    return DPL_ENOMEM;
+  part_bufs[1] = tmp;
+  memcpy(part_bufs[1] + part_lens[1], buf, len);
+  part_lens[1] += len;
+
+  if (NULL != statusp)
+    *statusp = NULL;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_stream_flush(dpl_ctx_t *ctx, dpl_stream_t *stream)
+{
+  object_set(part_bufs[1], part_lens[1], upload_md);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_backend_t fake_backend =
+  {
+    .name = "fake",
+    .put = fake_put,
+    .get = fake_get,
+    .head = fake_head,
+    .multipart_init = fake_multipart_init,
+    .multipart_put = fake_multipart_put,
+    .multipart_complete = fake_multipart_complete,
+    .multipart_abort = fake_multipart_abort,
+    .stream_put = fake_stream_put,
+    .stream_flush = fake_stream_flush,
+  };
+
+static dpl_ctx_t *
+keyed_ctx_new(const char *key)
+{
+  dpl_ctx_t *new_ctx;
+
+  if (NULL != key)
+    dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "encrypt_key", key, 0));
+  else if (NULL != dpl_dict_get(profile, "encrypt_key"))
+    dpl_dict_remove(profile, dpl_dict_get(profile, "encrypt_key"));
+
+  new_ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(new_ctx);
+  new_ctx->backend = &fake_backend;
+
+  return new_ctx;
+}
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+
+  ctx = keyed_ctx_new("correct horse battery staple");
+}
+
+static void
+teardown(void)
+{
+  int i;
+
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+
+  free(object_buf);
+  object_buf = NULL;
+  object_len = 0;
+  if (NULL != object_md)
+    dpl_dict_free(object_md);
+  object_md = NULL;
+  for (i = 0;i <= MAX_PARTS;i++)
+    {
+      free(part_bufs[i]);
+      part_bufs[i] = NULL;
+      part_lens[i] = 0;
+    }
+  if (NULL != upload_md)
+    dpl_dict_free(upload_md);
+  upload_md = NULL;
+}
+
+static char *
+pattern_new(uint64_t len)
+{
+  char *buf;
+  uint64_t i;
+
+  buf = malloc(len > 0 ? len : 1);
+  dpl_assert_ptr_not_null(buf);
+  for (i = 0;i < len;i++)
+    buf[i] = (i * 7 + i / 251) & 0xff;
+
+  return buf;
+}
+
+/* read back what was stored, over its whole range */
+static void
+check_get(const char *data, uint64_t len,
+          uint64_t start, uint64_t end)
+{
+  dpl_range_t range;
+  char *buf = NULL;
+  unsigned int buf_len = 0;
+
+  range.start = start;
+  range.end = end;
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                            DPL_UNDEF == start && DPL_UNDEF == end ? NULL : &range,
+                            &buf, &buf_len, NULL, NULL));
+  if (DPL_UNDEF == start && DPL_UNDEF == end)
+    {
+      start = 0;
+      end = len - 1;
+    }
+  else if (DPL_UNDEF == start)
+    {
+      start = len - end;
+      end = len - 1;
+    }
+  else if (DPL_UNDEF == end || end >= len)
+    end = len - 1;
+  dpl_assert_int_eq(end + 1 - start, buf_len);
+  dpl_assert_int_eq(0, memcmp(data + start, buf, buf_len));
+  free(buf);
+}
+
+START_TEST(roundtrip_test)
+{
+  static const uint64_t sizes[] = { 0, 1, CHUNK - 1, CHUNK, CHUNK + 1 };
+  dpl_crypt_t *crypt;
+  char *plain, *cipher, *split, *out;
+  uint64_t cipher_len, size;
+  size_t out_len;
+  int final, i;
+
+  crypt = dpl_crypt_new(ctx);
+  dpl_assert_ptr_not_null(crypt);
+
+  for (i = 0;i < sizeof (sizes) / sizeof (sizes[0]);i++)
+    {
+      plain = pattern_new(sizes[i]);
+      cipher_len = dpl_crypt_cipher_size(CHUNK, sizes[i], 1);
+      dpl_assert_int_eq((sizes[i] / CHUNK + 1) * DPL_CRYPT_TAG_SIZE + sizes[i], cipher_len);
+      cipher = malloc(cipher_len);
+      out = malloc(cipher_len);
+      dpl_assert_ptr_not_null(cipher);
+      dpl_assert_ptr_not_null(out);
+
+      dpl_assert_int_eq(DPL_SUCCESS,
+                        dpl_crypt_encrypt(crypt, 0, plain, sizes[i], 1, cipher));
+      dpl_assert_int_eq(0, dpl_crypt_plain_size(CHUNK, cipher_len, &size));
+      dpl_assert_int_eq(sizes[i], size);
+
+      final = 0;
+      dpl_assert_int_eq(DPL_SUCCESS,
+                        dpl_crypt_decrypt(crypt, 0, cipher, cipher_len, out, &out_len, &final));
+      dpl_assert_int_eq(sizes[i], out_len);
+      dpl_assert_int_eq(1, final);
+      dpl_assert_int_eq(0, memcmp(plain, out, out_len));
+
+      /* the same, encrypted in two calls */
+      if (sizes[i] >= CHUNK)
+        {
+          split = malloc(cipher_len);
+          dpl_assert_ptr_not_null(split);
+          dpl_assert_int_eq(CIPHER_CHUNK, dpl_crypt_cipher_size(CHUNK, CHUNK, 0));
+          dpl_assert_int_eq(DPL_SUCCESS,
+                            dpl_crypt_encrypt(crypt, 0, plain, CHUNK, 0, split));
+          dpl_assert_int_eq(DPL_SUCCESS,
+                            dpl_crypt_encrypt(crypt, CHUNK, plain + CHUNK,
+                                              sizes[i] - CHUNK, 1, split + CIPHER_CHUNK));
+          dpl_assert_int_eq(0, memcmp(cipher, split, cipher_len));
+          free(split);
+        }
+
+      free(plain);
+      free(cipher);
+      free(out);
+    }
+
+  /* no size ends with a whole chunk */
+  dpl_assert_int_eq(-1, dpl_crypt_plain_size(CHUNK, CIPHER_CHUNK, &size));
+  dpl_assert_int_eq(-1, dpl_crypt_plain_size(CHUNK, DPL_CRYPT_TAG_SIZE - 1, &size));
+
+  dpl_crypt_destroy(crypt);
+}
+END_TEST
+
+START_TEST(tamper_test)
+{
+  dpl_crypt_t *crypt;
+  uint64_t len = 3 * CHUNK + 5, cipher_len;
+  char *plain, *cipher, *out;
+  size_t out_len;
+  int final;
+
+  crypt = dpl_crypt_new(ctx);
+  dpl_assert_ptr_not_null(crypt);
+  plain = pattern_new(len);
+  cipher_len = dpl_crypt_cipher_size(CHUNK, len, 1);
+  cipher = malloc(cipher_len + CIPHER_CHUNK);
+  out = malloc(cipher_len + CIPHER_CHUNK);
+  dpl_assert_ptr_not_null(cipher);
+  dpl_assert_ptr_not_null(out);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_crypt_encrypt(crypt, 0, plain, len, 1, cipher));
+
+  /* a flipped tag byte */
+  cipher[CIPHER_CHUNK + CHUNK + 3] ^= 1;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_crypt_decrypt(crypt, 0, cipher, cipher_len, out, &out_len, &final));
+  cipher[CIPHER_CHUNK + CHUNK + 3] ^= 1;
+
+  /* a chunk at the wrong index */
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_crypt_decrypt(crypt, CHUNK, cipher + CIPHER_CHUNK, CIPHER_CHUNK,
+                                      out, &out_len, &final));
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_crypt_decrypt(crypt, 2 * CHUNK, cipher + CIPHER_CHUNK, CIPHER_CHUNK,
+                                      out, &out_len, &final));
+  dpl_assert_int_eq(DPL_EINVAL,
+                    dpl_crypt_decrypt(crypt, 1, cipher, CIPHER_CHUNK, out, &out_len, &final));
+
+  /* whole chunks decrypt without the last one, which the caller must notice */
+  final = 1;
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_crypt_decrypt(crypt, 0, cipher, 3 * CIPHER_CHUNK, out, &out_len, &final));
+  dpl_assert_int_eq(3 * CHUNK, out_len);
+  dpl_assert_int_eq(0, final);
+
+  /* a cut last chunk, or data after it */
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_crypt_decrypt(crypt, 0, cipher, cipher_len - 1,
+                                      out, &out_len, &final));
+  memcpy(cipher + cipher_len, cipher, CIPHER_CHUNK);
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_crypt_decrypt(crypt, 0, cipher, cipher_len + CIPHER_CHUNK,
+                                      out, &out_len, &final));
+
+  free(plain);
+  free(cipher);
+  free(out);
+  dpl_crypt_destroy(crypt);
+}
+END_TEST
+
+START_TEST(get_tamper_test)
+{
+  uint64_t len = 3 * CHUNK + 5;
+  char *data, *tmp, *buf = NULL;
+  unsigned int buf_len;
+  dpl_range_t range;
+
+  data = pattern_new(len);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_put(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            NULL, NULL, data, len));
+  dpl_assert_int_eq(dpl_crypt_cipher_size(CHUNK, len, 1), object_len);
+  dpl_assert_ptr_not_null(dpl_dict_get(object_md, DPL_CRYPT_MD_SALT));
+  check_get(data, len, DPL_UNDEF, DPL_UNDEF);
+
+  /* a flipped tag byte */
+  object_buf[2 * CIPHER_CHUNK - 1] ^= 1;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            &buf, &buf_len, NULL, NULL));
+  object_buf[2 * CIPHER_CHUNK - 1] ^= 1;
+
+  /* swapped chunks */
+  tmp = malloc(CIPHER_CHUNK);
+  dpl_assert_ptr_not_null(tmp);
+  memcpy(tmp, object_buf, CIPHER_CHUNK);
+  memcpy(object_buf, object_buf + CIPHER_CHUNK, CIPHER_CHUNK);
+  memcpy(object_buf + CIPHER_CHUNK, tmp, CIPHER_CHUNK);
+  free(tmp);
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            &buf, &buf_len, NULL, NULL));
+
+  /* a dropped trailing chunk */
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_put(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            NULL, NULL, data, len));
+  object_len -= 5 + DPL_CRYPT_TAG_SIZE;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            &buf, &buf_len, NULL, NULL));
+  range.start = CHUNK + 1;
+  range.end = DPL_UNDEF;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, &range,
+                            &buf, &buf_len, NULL, NULL));
+  range.end = 10 * CHUNK;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, &range,
+                            &buf, &buf_len, NULL, NULL));
+  range.start = DPL_UNDEF;
+  range.end = 10;
+  dpl_assert_int_eq(DPL_EINTEGRITY,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, &range,
+                            &buf, &buf_len, NULL, NULL));
+  /* a range ending before the missing part is still readable */
+  check_get(data, len, CHUNK - 1, 2 * CHUNK);
+
+  free(data);
+}
+END_TEST
+
+START_TEST(cipher_range_test)
+{
+  dpl_range_t range;
+
+  dpl_assert_int_eq(0, dpl_crypt_cipher_range(CHUNK, 0, 0, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(CIPHER_CHUNK - 1, range.end);
+
+  dpl_assert_int_eq(0, dpl_crypt_cipher_range(CHUNK, CHUNK - 1, CHUNK - 1, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(CIPHER_CHUNK - 1, range.end);
+
+  dpl_assert_int_eq(0, dpl_crypt_cipher_range(CHUNK, CHUNK - 1, CHUNK, &range));
+  dpl_assert_int_eq(0, range.start);
+  dpl_assert_int_eq(2 * CIPHER_CHUNK - 1, range.end);
+
+  dpl_assert_int_eq(CHUNK, dpl_crypt_cipher_range(CHUNK, CHUNK, DPL_UNDEF, &range));
+  dpl_assert_int_eq(CIPHER_CHUNK, range.start);
+  dpl_assert_int_eq(DPL_UNDEF, range.end);
+
+  dpl_assert_int_eq(2 * CHUNK, dpl_crypt_cipher_range(CHUNK, 2 * CHUNK + 3, 3 * CHUNK, &range));
+  dpl_assert_int_eq(2 * CIPHER_CHUNK, range.start);
+  dpl_assert_int_eq(4 * CIPHER_CHUNK - 1, range.end);
+
+  /* another chunk size */
+  dpl_assert_int_eq(4096, dpl_crypt_cipher_range(4096, 5000, 8191, &range));
+  dpl_assert_int_eq(4096 + DPL_CRYPT_TAG_SIZE, range.start);
+  dpl_assert_int_eq(2 * (4096 + DPL_CRYPT_TAG_SIZE) - 1, range.end);
+}
+END_TEST
+
+START_TEST(range_test)
+{
+  uint64_t len = 3 * CHUNK + 5;
+  char *data, buf[10], *bufp = buf;
+  unsigned int buf_len;
+  dpl_option_t option;
+  dpl_range_t range;
+  dpl_sysmd_t sysmd;
+
+  data = pattern_new(len);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_put(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL,
+                            NULL, NULL, data, len));
+
+  check_get(data, len, 0, 0);
+  check_get(data, len, CHUNK - 1, CHUNK);
+  check_get(data, len, CHUNK, 2 * CHUNK - 1);
+  check_get(data, len, 3 * CHUNK, DPL_UNDEF);
+  check_get(data, len, 2 * CHUNK + 7, 100 * CHUNK);
+  /* suffixes */
+  check_get(data, len, DPL_UNDEF, 3);
+  check_get(data, len, DPL_UNDEF, CHUNK + 6);
+
+  range.start = len;
+  range.end = DPL_UNDEF;
+  dpl_assert_int_eq(DPL_ERANGEUNAVAIL,
+                    dpl_get(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, &range,
+                            &bufp, &buf_len, NULL, NULL));
+
+  /* into a buffer of the caller, truncated to its size */
+  memset(&option, 0, sizeof (option));
+  option.mask = DPL_OPTION_NOALLOC;
+  range.start = CHUNK - 2;
+  range.end = CHUNK + 20;
+  buf_len = sizeof (buf);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get(ctx, "b", "o", &option, DPL_FTYPE_REG, NULL, &range,
+                            &bufp, &buf_len, NULL, NULL));
+  dpl_assert_ptr_eq(buf, bufp);
+  dpl_assert_int_eq(sizeof (buf), buf_len);
+  dpl_assert_int_eq(0, memcmp(data + CHUNK - 2, buf, sizeof (buf)));
+
+  /* the size of the plaintext */
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_head(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL, NULL, &sysmd));
+  dpl_assert_int_eq(len, sysmd.size);
+
+  free(data);
+}
+END_TEST
+
+START_TEST(wrong_key_test)
+{
+  dpl_ctx_t *other;
+  dpl_crypt_t *crypt, *opened = NULL;
+  dpl_dict_t *md;
+
+  crypt = dpl_crypt_new(ctx);
+  dpl_assert_ptr_not_null(crypt);
+  md = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(md);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_crypt_seal(ctx, crypt, md));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_crypt_open(ctx, md, &opened));
+  dpl_assert_int_eq(0, memcmp(crypt->key, opened->key, DPL_CRYPT_KEY_SIZE));
+  dpl_crypt_destroy(opened);
+  opened = NULL;
+
+  /* the same key under another salt */
+  other = keyed_ctx_new("correct horse battery staple");
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_crypt_open(other, md, &opened));
+  dpl_crypt_destroy(opened);
+  opened = NULL;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_crypt_open(other, md, &opened));
+  dpl_crypt_destroy(opened);
+  opened = NULL;
+  dpl_ctx_free(other);
+
+  other = keyed_ctx_new("incorrect horse");
+  dpl_assert_int_eq(DPL_EPERM, dpl_crypt_open(other, md, &opened));
+  dpl_assert_ptr_null(opened);
+  dpl_ctx_free(other);
+
+  other = keyed_ctx_new(NULL);
+  dpl_assert_int_eq(0, dpl_crypt_enabled(other));
+  dpl_assert_int_eq(DPL_EPERM, dpl_crypt_open(other, md, &opened));
+  dpl_ctx_free(other);
+
+  /* nothing to open */
+  dpl_crypt_strip(md);
+  dpl_assert_int_eq(DPL_ENOENT, dpl_crypt_open(ctx, md, &opened));
+
+  dpl_dict_free(md);
+  dpl_crypt_destroy(crypt);
+}
+END_TEST
+
+struct reader
+{
+  const char *data;
+  uint64_t len;
+  uint64_t off;
+};
+
+static dpl_status_t
+read_cb(void *cb_arg, char *buf, unsigned int len, unsigned int *lenp)
+{
+  struct reader *reader = cb_arg;
+
+  len = MIN(len, reader->len - reader->off);
+  memcpy(buf, reader->data + reader->off, len);
+  reader->off += len;
+  *lenp = len;
+
+  return DPL_SUCCESS;
+}
+
+START_TEST(put_parallel_test)
+{
+  static const uint64_t sizes[] = { DPL_MULTIPART_MIN_PART_SIZE * 5 / 2,
+                                    DPL_MULTIPART_MIN_PART_SIZE * 2 };
+  dpl_parallel_params_t params;
+  struct reader reader;
+  int i;
+
+  memset(&params, 0, sizeof (params));
+  params.part_size = DPL_MULTIPART_MIN_PART_SIZE;
+  params.n_parallel = 2;
+
+  for (i = 0;i < sizeof (sizes) / sizeof (sizes[0]);i++)
+    {
+      reader.data = pattern_new(sizes[i]);
+      reader.len = sizes[i];
+      reader.off = 0;
+
+      dpl_assert_int_eq(DPL_SUCCESS,
+                        dpl_put_parallel(ctx, "b", "o", NULL, NULL, &params,
+                                         read_cb, &reader));
+      /* the envelope was there at initiation */
+      dpl_assert_ptr_not_null(dpl_dict_get(upload_md, DPL_CRYPT_MD_KEY));
+      dpl_assert_int_eq(dpl_crypt_cipher_size(CHUNK, sizes[i], 1), object_len);
+      check_get(reader.data, sizes[i], DPL_UNDEF, DPL_UNDEF);
+      check_get(reader.data, sizes[i], DPL_UNDEF, 100);
+
+      dpl_dict_free(upload_md);
+      upload_md = NULL;
+      free((char *) reader.data);
+    }
+}
+END_TEST
+
+START_TEST(stream_test)
+{
+  uint64_t len = 2 * CHUNK;
+  dpl_stream_t *stream = NULL;
+  struct json_object *status = NULL;
+  char *data;
+
+  data = pattern_new(len);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_stream_open(ctx, "b", "o", NULL, NULL, NULL, NULL, &stream));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_put(ctx, stream, data, CHUNK + 1, &status));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_put(ctx, stream, data + CHUNK + 1, CHUNK - 1, &status));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_stream_flush(ctx, stream));
+  dpl_stream_close(ctx, stream);
+
+  dpl_assert_ptr_not_null(dpl_dict_get(upload_md, DPL_CRYPT_MD_KEY));
+  dpl_assert_int_eq(dpl_crypt_cipher_size(CHUNK, len, 1), object_len);
+  check_get(data, len, DPL_UNDEF, DPL_UNDEF);
+  check_get(data, len, CHUNK, DPL_UNDEF);
+
+  free(data);
+}
+END_TEST
+
+Suite *
+crypt_suite(void)
+{
+  Suite *s = suite_create("crypt");
+  TCase *t = tcase_create("base");
+  tcase_set_timeout(t, 60);
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, roundtrip_test);
+  tcase_add_test(t, tamper_test);
+  tcase_add_test(t, get_tamper_test);
+  tcase_add_test(t, cipher_range_test);
+  tcase_add_test(t, range_test);
+  tcase_add_test(t, wrong_key_test);
+  tcase_add_test(t, put_parallel_test);
+  tcase_add_test(t, stream_test);
+  suite_add_tcase(s, t);
+  return s;
+}
@@ -17,6 +17,9 @@ START_TEST(status_str_test)
   dpl_assert_str_eq("DPL_FAILURE", dpl_status_str(DPL_FAILURE));
   /* lots of others, just try one */
   dpl_assert_str_eq("DPL_ECONNECT", dpl_status_str(DPL_ECONNECT));
+  dpl_assert_str_eq("DPL_ESERVER", dpl_status_str(DPL_ESERVER));
+  dpl_assert_str_eq("DPL_EBUSY", dpl_status_str(DPL_EBUSY));
+  dpl_assert_str_eq("DPL_EINTEGRITY", dpl_status_str(DPL_EINTEGRITY));
   /* we get a non-null string when passing completely bogus error codes */
   dpl_assert_ptr_not_null(dpl_status_str(3000));
   dpl_assert_ptr_not_null(dpl_status_str(-3000));
@@ -0,0 +1,137 @@
+/* unit test the hedged requests of hedge.c with fake attempts */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <check.h>
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/* the primary is slow, to its status line or only to its body */
+static int n_calls;
+static int primary_replies;
+
+static dpl_status_t
+fake_get(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, char **data_bufp,
+         unsigned int *data_lenp, dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp, char **locationp)
+{
+  if (0 == __sync_fetch_and_add(&n_calls, 1))
+    {
+      if (primary_replies)
+        dpl_hedge_replied(ctx);
+      usleep(300000);
+    }
+  else
+    {
+      dpl_hedge_replied(ctx);
+    }
+
+  *data_bufp = strdup("data");
+  if (NULL == *data_bufp)
+    return DPL_ENOMEM;
+  *data_lenp = 4;
+
+  return DPL_SUCCESS;
+}
+
+static void
+setup(void)
+{
+  int i;
+
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  /* a twin needs another host */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "127.0.0.1,127.0.0.2", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "hedge_percentile", "95", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "hedge_min_delay", "0", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  dpl_assert_ptr_not_null(ctx->hedge);
+
+  /* replies take 20ms */
+  for (i = 0;i < 64;i++)
+    dpl_hedge_record(ctx, 20000);
+
+  n_calls = 0;
+  primary_replies = 0;
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+}
+
+START_TEST(slow_head_test)
+{
+  dpl_hedge_stats_t stats;
+  char *buf = NULL;
+  unsigned int len = 0;
+
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_hedge_get(ctx, fake_get, "b", "o", NULL, NULL,
+                                  DPL_FTYPE_REG, NULL, NULL, &buf, &len,
+                                  NULL, NULL, NULL));
+  dpl_assert_str_eq("data", buf);
+  dpl_assert_int_eq(4, len);
+  free(buf);
+
+  dpl_assert_int_eq(2, n_calls);
+  dpl_hedge_get_stats(ctx, &stats);
+  dpl_assert_int_eq(1, stats.hedges_sent);
+  dpl_assert_int_eq(1, stats.hedges_won);
+  dpl_assert_int_eq(20000, stats.delay_usec);
+}
+END_TEST
+
+START_TEST(slow_body_test)
+{
+  dpl_hedge_stats_t stats;
+  char *buf = NULL;
+  unsigned int len = 0;
+
+  /* the reply started in time, only its transfer is long */
+  primary_replies = 1;
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_hedge_get(ctx, fake_get, "b", "o", NULL, NULL,
+                                  DPL_FTYPE_REG, NULL, NULL, &buf, &len,
+                                  NULL, NULL, NULL));
+  dpl_assert_str_eq("data", buf);
+  free(buf);
+
+  dpl_assert_int_eq(1, n_calls);
+  dpl_hedge_get_stats(ctx, &stats);
+  dpl_assert_int_eq(0, stats.hedges_sent);
+}
+END_TEST
+
+Suite *
+hedge_suite(void)
+{
+  Suite *s = suite_create("hedge");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, slow_head_test);
+  tcase_add_test(t, slow_body_test);
+  suite_add_tcase(s, t);
+  return s;
+}
@@ -0,0 +1,205 @@
+/* unit test the parallel transfers of parallel.c against a fake backend */
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <check.h>
+#include "dropletp.h"
+#include "droplet/s3/s3.h"
+#include "droplet/parallel.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/* what the fake backend serves, and saw */
+static uint64_t object_size;
+static int n_get;
+static uint64_t n_got;
+static dpl_status_t get_status;
+
+static dpl_status_t
+fake_head(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+          const char *subresource, const dpl_option_t *option,
+          dpl_ftype_t object_type, const dpl_condition_t *condition,
+          dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp)
+{
+  char value[32];
+
+  if (NULL != metadatap)
+    *metadatap = dpl_dict_new(13);
+
+  /* sized by the header parser, as from a real reply */
+  if (NULL != sysmdp)
+    {
+      snprintf(value, sizeof (value), "%llu", (unsigned long long) object_size);
+      dpl_assert_int_eq(DPL_SUCCESS,
+                        dpl_s3_get_metadatum_from_header("content-length", value,
+                                                         NULL, NULL, NULL, sysmdp));
+    }
+
+  return DPL_SUCCESS;
+}
+
+/* the content does not matter, nothing touches it */
+static dpl_status_t
+fake_get(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, char **data_bufp,
+         unsigned int *data_lenp, dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp, char **locationp)
+{
+  uint64_t len;
+
+  __sync_fetch_and_add(&n_get, 1);
+
+  if (DPL_SUCCESS != get_status)
+    return get_status;
+
+  dpl_assert_ptr_not_null(range);
+  ck_assert_msg(range->end < object_size, "range ends at %llu", (unsigned long long) range->end);
+  len = range->end + 1 - range->start;
+
+  if (NULL == option || !(option->mask & DPL_OPTION_NOALLOC))
+    {
+      *data_bufp = malloc(len);
+      if (NULL == *data_bufp)
+        return DPL_ENOMEM;
+    }
+  *data_lenp = len;
+  __sync_fetch_and_add(&n_got, len);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_backend_t fake_backend =
+  {
+    .name = "fake",
+    .head = fake_head,
+    .get = fake_get,
+  };
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  /* only the retries of the parts */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "retry_max", "0", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  ctx->backend = &fake_backend;
+
+  n_get = 0;
+  n_got = 0;
+  get_status = DPL_SUCCESS;
+  object_size = 1000;
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+}
+
+START_TEST(get_huge_test)
+{
+  dpl_parallel_params_t params;
+  uint64_t len = 0;
+  char buf[1];
+  int fd;
+
+  /* beyond what an unsigned int holds */
+  object_size = 5ULL*1024*1024*1024 + 1;
+
+  memset(&params, 0, sizeof (params));
+  params.part_size = 1024*1024*1024;
+  params.n_parallel = 2;
+  params.max_retries = 0;
+
+  fd = open("/dev/null", O_WRONLY);
+  dpl_assert_int_ne(-1, fd);
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get_parallel_fd(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                        &params, fd, &len, NULL, NULL));
+  close(fd);
+  dpl_assert_int_eq(object_size, len);
+  dpl_assert_int_eq(6, n_get);
+  dpl_assert_int_eq(object_size, n_got);
+
+  /* sized before anything is fetched */
+  n_get = 0;
+  len = 0;
+  dpl_assert_int_eq(DPL_ELIMIT,
+                    dpl_get_parallel(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                     &params, buf, 4ULL*1024*1024*1024, &len,
+                                     NULL, NULL));
+  dpl_assert_int_eq(object_size, len);
+  dpl_assert_int_eq(0, n_get);
+}
+END_TEST
+
+START_TEST(get_retry_test)
+{
+  dpl_parallel_params_t params;
+  char buf[1000];
+
+  memset(&params, 0, sizeof (params));
+  params.part_size = 100;
+  params.n_parallel = 1;
+  params.max_retries = 2;
+
+  /* transient */
+  get_status = DPL_EIO;
+  dpl_assert_int_eq(DPL_EIO,
+                    dpl_get_parallel(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                     &params, buf, sizeof (buf), NULL, NULL, NULL));
+  dpl_assert_int_eq(3, n_get);
+
+  /* permanent */
+  n_get = 0;
+  get_status = DPL_FAILURE;
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_get_parallel(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                     &params, buf, sizeof (buf), NULL, NULL, NULL));
+  dpl_assert_int_eq(1, n_get);
+
+  n_get = 0;
+  get_status = DPL_EPERM;
+  dpl_assert_int_eq(DPL_EPERM,
+                    dpl_get_parallel(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                     &params, buf, sizeof (buf), NULL, NULL, NULL));
+  dpl_assert_int_eq(1, n_get);
+
+  get_status = DPL_SUCCESS;
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_get_parallel(ctx, "b", "o", NULL, DPL_FTYPE_REG, NULL,
+                                     &params, buf, sizeof (buf), NULL, NULL, NULL));
+}
+END_TEST
+
+Suite *
+parallel_suite(void)
+{
+  Suite *s = suite_create("parallel");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, get_huge_test);
+  tcase_add_test(t, get_retry_test);
+  suite_add_tcase(s, t);
+  return s;
+}
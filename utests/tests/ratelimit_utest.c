@@ -0,0 +1,177 @@
+/* unit test the token buckets of ratelimit.c against a fixed clock */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <check.h>
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/* time only goes by when told to, or when sleeping */
+static struct timespec fake_now;
+static int n_sleeps;
+static uint64_t slept_usec;
+
+static void
+advance(uint64_t usec)
+{
+  fake_now.tv_sec += usec / 1000000;
+  fake_now.tv_nsec += (usec % 1000000) * 1000;
+  if (fake_now.tv_nsec >= 1000000000)
+    {
+      fake_now.tv_sec++;
+      fake_now.tv_nsec -= 1000000000;
+    }
+}
+
+static void
+fake_clock(struct timespec *nowp)
+{
+  *nowp = fake_now;
+}
+
+static void
+fake_sleep(useconds_t usec)
+{
+  n_sleeps++;
+  slept_usec += usec;
+  advance(usec);
+}
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  /* rates whose delays are exact in binary */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "max_request_rate", "8", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "max_upload_rate", "1024", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  dpl_assert_ptr_not_null(ctx->rate_limits);
+
+  fake_now.tv_sec = 1000;
+  fake_now.tv_nsec = 0;
+  n_sleeps = 0;
+  slept_usec = 0;
+  dpl_rate_limit_set_clock(ctx, fake_clock, fake_sleep);
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+}
+
+START_TEST(request_test)
+{
+  dpl_rate_limit_stats_t stats;
+  int i;
+
+  /* a full bucket admits one second worth of requests at once */
+  for (i = 0;i < 8;i++)
+    dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(0, n_sleeps);
+
+  /* then each waits for its token */
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(1, n_sleeps);
+  dpl_assert_int_eq(125000, slept_usec);
+
+  /* the sleep repaid the debt */
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(2, n_sleeps);
+  dpl_assert_int_eq(250000, slept_usec);
+
+  dpl_rate_limit_get_stats(ctx, &stats);
+  dpl_assert_int_eq(10, stats.requests);
+  dpl_assert_int_eq(2, stats.request_waits);
+  dpl_assert_int_eq(250000, stats.request_wait_usec);
+
+  /* refills no further than one second worth, however long idle */
+  advance(10000000);
+  for (i = 0;i < 8;i++)
+    dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(2, n_sleeps);
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(3, n_sleeps);
+
+  /* partially refilled: the debt and two more tokens */
+  advance(250000);
+  dpl_rate_limit_request(ctx);
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(3, n_sleeps);
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(4, n_sleeps);
+  dpl_assert_int_eq(375000 + 125000, slept_usec);
+}
+END_TEST
+
+START_TEST(upload_test)
+{
+  dpl_rate_limit_stats_t stats;
+
+  dpl_assert_int_eq(1, dpl_rate_limit_upload_enabled(ctx));
+
+  /* a large write is admitted at once, into debt */
+  dpl_rate_limit_upload(ctx, 3072);
+  dpl_assert_int_eq(1, n_sleeps);
+  dpl_assert_int_eq(2000000, slept_usec);
+
+  /* the debt is repaid, the next one only waits for itself */
+  dpl_rate_limit_upload(ctx, 512);
+  dpl_assert_int_eq(2, n_sleeps);
+  dpl_assert_int_eq(2500000, slept_usec);
+
+  dpl_rate_limit_get_stats(ctx, &stats);
+  dpl_assert_int_eq(3584, stats.upload_bytes);
+  dpl_assert_int_eq(2, stats.upload_waits);
+  dpl_assert_int_eq(2500000, stats.upload_wait_usec);
+
+  /* the buckets are independent */
+  dpl_rate_limit_request(ctx);
+  dpl_assert_int_eq(2, n_sleeps);
+}
+END_TEST
+
+START_TEST(unlimited_test)
+{
+  dpl_rate_limit_stats_t stats;
+
+  /* no download limit, nothing accounted */
+  dpl_rate_limit_download(ctx, 1024*1024*1024);
+  dpl_assert_int_eq(0, n_sleeps);
+
+  dpl_rate_limit_get_stats(ctx, &stats);
+  dpl_assert_int_eq(0, stats.download_bytes);
+  dpl_assert_int_eq(0, stats.download_waits);
+}
+END_TEST
+
+Suite *
+ratelimit_suite(void)
+{
+  Suite *s = suite_create("ratelimit");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, request_test);
+  tcase_add_test(t, upload_test);
+  tcase_add_test(t, unlimited_test);
+  suite_add_tcase(s, t);
+  return s;
+}
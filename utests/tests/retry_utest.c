@@ -0,0 +1,193 @@
+#include <check.h>
+#include <sys/time.h>
+
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+/*
+ * a bare context, enough for the retry policy
+ */
+static dpl_ctx_t *
+ctx_new(int retry_max, int retry_delay, int retry_max_delay, int retry_budget)
+{
+  dpl_ctx_t *ctx;
+
+  ctx = calloc(1, sizeof (*ctx));
+  dpl_assert_ptr_not_null(ctx);
+  ctx->retry_max = retry_max;
+  ctx->retry_delay = retry_delay;
+  ctx->retry_max_delay = retry_max_delay;
+  ctx->retry_budget = retry_budget;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_retry_init(ctx));
+
+  return ctx;
+}
+
+static void
+ctx_free(dpl_ctx_t *ctx)
+{
+  dpl_retry_free(ctx);
+  free(ctx);
+}
+
+static uint64_t
+now_msec(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+START_TEST(classify_test)
+{
+  dpl_retry_reason_t reason;
+
+  dpl_assert_int_eq(1, dpl_retry_classify(DPL_ECONNECT, &reason));
+  dpl_assert_int_eq(DPL_RETRY_CONNECT, reason);
+  dpl_assert_int_eq(1, dpl_retry_classify(DPL_ETIMEOUT, &reason));
+  dpl_assert_int_eq(DPL_RETRY_TIMEOUT, reason);
+  dpl_assert_int_eq(1, dpl_retry_classify(DPL_ESERVER, &reason));
+  dpl_assert_int_eq(DPL_RETRY_SERVER, reason);
+  dpl_assert_int_eq(1, dpl_retry_classify(DPL_EBUSY, &reason));
+  dpl_assert_int_eq(DPL_RETRY_SLOWDOWN, reason);
+  dpl_assert_int_eq(1, dpl_retry_classify(DPL_EIO, &reason));
+  dpl_assert_int_eq(DPL_RETRY_RESET, reason);
+
+  /* definite answers are not retried */
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_SUCCESS, &reason));
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_FAILURE, &reason));
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_ENOENT, &reason));
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_EPERM, &reason));
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_EPRECOND, &reason));
+  dpl_assert_int_eq(0, dpl_retry_classify(DPL_ENOMEM, &reason));
+}
+END_TEST
+
+START_TEST(disabled_test)
+{
+  dpl_ctx_t *ctx = ctx_new(0, 0, 0, 10);
+  int attempt = 0;
+
+  dpl_assert_ptr_null(ctx->retry);
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  dpl_assert_int_eq(0, attempt);
+
+  ctx_free(ctx);
+}
+END_TEST
+
+START_TEST(max_test)
+{
+  dpl_ctx_t *ctx = ctx_new(2, 0, 0, 10);
+  dpl_retry_stats_t stats;
+  int attempt = 0;
+
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ESERVER, &attempt));
+  dpl_assert_int_eq(1, attempt);
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ESERVER, &attempt));
+  dpl_assert_int_eq(2, attempt);
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ESERVER, &attempt));
+  dpl_assert_int_eq(2, attempt);
+
+  /* not transient */
+  attempt = 0;
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ENOENT, &attempt));
+
+  /* a success after retrying counts as recovered */
+  attempt = 1;
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_SUCCESS, &attempt));
+
+  dpl_retry_get_stats(ctx, &stats);
+  dpl_assert_int_eq(2, stats.retries[DPL_RETRY_SERVER]);
+  dpl_assert_int_eq(1, stats.exhausted);
+  dpl_assert_int_eq(1, stats.recovered);
+
+  ctx_free(ctx);
+}
+END_TEST
+
+START_TEST(backoff_test)
+{
+  dpl_ctx_t *ctx;
+  uint64_t start, elapsed;
+  int attempt;
+
+  /* the doubling is capped: uncapped, the 10th retry would wait 100s */
+  ctx = ctx_new(20, 100, 5, 10);
+  attempt = 10;
+  start = now_msec();
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  elapsed = now_msec() - start;
+  ck_assert_msg(elapsed < 1000, "capped backoff took %llu ms", (unsigned long long) elapsed);
+  dpl_assert_int_eq(11, attempt);
+  ctx_free(ctx);
+
+  /* a slowdown waits at least half of the cap */
+  ctx = ctx_new(5, 40, 40, 10);
+  attempt = 0;
+  start = now_msec();
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_EBUSY, &attempt));
+  elapsed = now_msec() - start;
+  ck_assert_msg(elapsed >= 20, "slowdown backoff took %llu ms", (unsigned long long) elapsed);
+  ck_assert_msg(elapsed < 1000, "slowdown backoff took %llu ms", (unsigned long long) elapsed);
+  ctx_free(ctx);
+}
+END_TEST
+
+START_TEST(budget_test)
+{
+  dpl_ctx_t *ctx = ctx_new(100, 0, 0, 2);
+  dpl_retry_stats_t stats;
+  int attempt = 0;
+  int i;
+
+  dpl_retry_get_stats(ctx, &stats);
+  dpl_assert_int_eq(2, stats.tokens);
+
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  /* exhausted */
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  dpl_assert_int_eq(2, attempt);
+
+  dpl_retry_get_stats(ctx, &stats);
+  dpl_assert_int_eq(0, stats.tokens);
+  dpl_assert_int_eq(1, stats.denied);
+
+  /* ten successes pay for one retry */
+  attempt = 0;
+  for (i = 0;i < 9;i++)
+    dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_SUCCESS, &attempt));
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_SUCCESS, &attempt));
+  /* but not for a timeout, which costs twice as much */
+  dpl_assert_int_eq(0, dpl_retry_again(ctx, DPL_ETIMEOUT, &attempt));
+  dpl_assert_int_eq(1, dpl_retry_again(ctx, DPL_ECONNECT, &attempt));
+
+  /* the refill stops at the budget */
+  attempt = 0;
+  for (i = 0;i < 100;i++)
+    dpl_retry_again(ctx, DPL_SUCCESS, &attempt);
+  dpl_retry_get_stats(ctx, &stats);
+  dpl_assert_int_eq(2, stats.tokens);
+
+  ctx_free(ctx);
+}
+END_TEST
+
+Suite *
+retry_suite(void)
+{
+  Suite *s = suite_create("retry");
+  TCase *t = tcase_create("base");
+  tcase_add_test(t, classify_test);
+  tcase_add_test(t, disabled_test);
+  tcase_add_test(t, max_test);
+  tcase_add_test(t, backoff_test);
+  tcase_add_test(t, budget_test);
+  suite_add_tcase(s, t);
+  return s;
+}
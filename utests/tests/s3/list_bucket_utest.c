@@ -0,0 +1,122 @@
+#include <check.h>
+
+#include "dropletp.h"
+#include "droplet/s3/s3.h"
+
+#include "utest_main.h"
+
+static const char list_v2_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<Name>bucket</Name>"
+  "<Prefix>photos/</Prefix>"
+  "<KeyCount>3</KeyCount>"
+  "<MaxKeys>3</MaxKeys>"
+  "<Delimiter>/</Delimiter>"
+  "<IsTruncated>true</IsTruncated>"
+  "<NextContinuationToken>1ueGcxLPRx1Tr/XYExHnhbYLgveDs2J/wm36Hy4vbOwM=</NextContinuationToken>"
+  "<Contents>"
+  "<Key>photos/a.jpg</Key>"
+  "<LastModified>2009-10-12T17:50:30.000Z</LastModified>"
+  "<ETag>&quot;fba9dede5f27731c9771645a39863328&quot;</ETag>"
+  "<Size>434234</Size>"
+  "<Owner><ID>75aa57f09aa0c8caeab4f8c24e99d10f8e7faeebf76c078efc7c6caea54ba06a</ID>"
+  "<DisplayName>mtd@amazon.com</DisplayName></Owner>"
+  "<StorageClass>STANDARD</StorageClass>"
+  "</Contents>"
+  "<Contents>"
+  "<Key>photos/b.jpg</Key>"
+  "<LastModified>2009-10-12T17:50:30.000Z</LastModified>"
+  "<Size>12</Size>"
+  "<StorageClass>STANDARD</StorageClass>"
+  "</Contents>"
+  "<CommonPrefixes><Prefix>photos/2006/</Prefix></CommonPrefixes>"
+  "</ListBucketResult>";
+
+static const char list_v1_last_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<Name>bucket</Name>"
+  "<Prefix></Prefix>"
+  "<Marker>a</Marker>"
+  "<MaxKeys>1000</MaxKeys>"
+  "<IsTruncated>false</IsTruncated>"
+  "<Contents><Key>b</Key><Size>1</Size></Contents>"
+  "</ListBucketResult>";
+
+START_TEST(list_v2_page_test)
+{
+  dpl_vec_t     *objects, *common_prefixes;
+  dpl_object_t  *object;
+  int           truncated;
+  char          *next_marker = NULL;
+  dpl_status_t  ret;
+
+  objects = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(objects);
+  common_prefixes = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(common_prefixes);
+
+  ret = dpl_s3_parse_list_bucket_page(NULL, list_v2_reply, sizeof (list_v2_reply) - 1,
+                                      objects, common_prefixes, &truncated, &next_marker);
+  dpl_assert_int_eq(DPL_SUCCESS, ret);
+
+  dpl_assert_int_eq(1, truncated);
+  dpl_assert_str_eq("1ueGcxLPRx1Tr/XYExHnhbYLgveDs2J/wm36Hy4vbOwM=", next_marker);
+
+  dpl_assert_int_eq(2, objects->n_items);
+  object = dpl_vec_get(objects, 0);
+  dpl_assert_str_eq("photos/a.jpg", object->path);
+  dpl_assert_int_eq(434234, object->size);
+  dpl_assert_str_eq("75aa57f09aa0c8caeab4f8c24e99d10f8e7faeebf76c078efc7c6caea54ba06a", object->owner);
+  object = dpl_vec_get(objects, 1);
+  dpl_assert_str_eq("photos/b.jpg", object->path);
+  dpl_assert_ptr_null(object->owner);
+
+  dpl_assert_int_eq(1, common_prefixes->n_items);
+  dpl_assert_str_eq("photos/2006/",
+                    ((dpl_common_prefix_t *) dpl_vec_get(common_prefixes, 0))->prefix);
+
+  free(next_marker);
+  dpl_vec_objects_free(objects);
+  dpl_vec_common_prefixes_free(common_prefixes);
+}
+END_TEST
+
+START_TEST(list_v1_last_page_test)
+{
+  dpl_vec_t     *objects, *common_prefixes;
+  int           truncated;
+  char          *next_marker = NULL;
+  dpl_status_t  ret;
+
+  objects = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(objects);
+  common_prefixes = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(common_prefixes);
+
+  ret = dpl_s3_parse_list_bucket_page(NULL, list_v1_last_reply, sizeof (list_v1_last_reply) - 1,
+                                      objects, common_prefixes, &truncated, &next_marker);
+  dpl_assert_int_eq(DPL_SUCCESS, ret);
+
+  dpl_assert_int_eq(0, truncated);
+  dpl_assert_ptr_null(next_marker);
+  dpl_assert_int_eq(1, objects->n_items);
+  dpl_assert_str_eq("b", ((dpl_object_t *) dpl_vec_get(objects, 0))->path);
+  dpl_assert_int_eq(0, common_prefixes->n_items);
+
+  dpl_vec_objects_free(objects);
+  dpl_vec_common_prefixes_free(common_prefixes);
+}
+END_TEST
+
+Suite *
+s3_list_bucket_suite(void)
+{
+  Suite *s = suite_create("s3_list_bucket");
+  TCase *t = tcase_create("base");
+  tcase_add_test(t, list_v2_page_test);
+  tcase_add_test(t, list_v1_last_page_test);
+  suite_add_tcase(s, t);
+  return s;
+}
@@ -0,0 +1,216 @@
+#include <check.h>
+
+#include "dropletp.h"
+#include "droplet/s3/s3.h"
+
+#include "utest_main.h"
+
+static const char list_parts_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<Bucket>example-bucket</Bucket>"
+  "<Key>example-object</Key>"
+  "<UploadId>XXBsb2FkIElEIGZvciBlbHZpbmcncyVcdS1tb3ZpZS5tMnRzEEEwbG9hZA</UploadId>"
+  "<PartNumberMarker>1</PartNumberMarker>"
+  "<NextPartNumberMarker>3</NextPartNumberMarker>"
+  "<MaxParts>2</MaxParts>"
+  "<IsTruncated>true</IsTruncated>"
+  "<Part>"
+  "<PartNumber>2</PartNumber>"
+  "<LastModified>2010-11-10T20:48:34.000Z</LastModified>"
+  "<ETag>&quot;7778aef83f66abc1fa1e8477f296d394&quot;</ETag>"
+  "<Size>10485760</Size>"
+  "</Part>"
+  "<Part>"
+  "<PartNumber>3</PartNumber>"
+  "<LastModified>2010-11-10T20:48:33.000Z</LastModified>"
+  "<ETag>&quot;aaaa18db4cc2f85cedef654fccc4a4x8&quot;</ETag>"
+  "<Size>10485760</Size>"
+  "</Part>"
+  "</ListPartsResult>";
+
+static const char list_parts_no_etag_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<IsTruncated>false</IsTruncated>"
+  "<Part><PartNumber>1</PartNumber><Size>5</Size></Part>"
+  "</ListPartsResult>";
+
+static const char list_parts_no_partnb_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<IsTruncated>false</IsTruncated>"
+  "<Part><ETag>&quot;7778aef83f66abc1fa1e8477f296d394&quot;</ETag><Size>5</Size></Part>"
+  "</ListPartsResult>";
+
+static const char list_uploads_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListMultipartUploadsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<Bucket>bucket</Bucket>"
+  "<KeyMarker></KeyMarker>"
+  "<UploadIdMarker></UploadIdMarker>"
+  "<NextKeyMarker>my-movie.m2ts</NextKeyMarker>"
+  "<NextUploadIdMarker>YW55IGlkZWEgd2h5IGVsdmluZydzIHVwbG9hZCBmYWlsZWQ</NextUploadIdMarker>"
+  "<MaxUploads>2</MaxUploads>"
+  "<IsTruncated>true</IsTruncated>"
+  "<Upload>"
+  "<Key>my-divisor</Key>"
+  "<UploadId>XMgbGlrZSB5b3VyIGZhdm9yaXRlIHByb2plY3Q</UploadId>"
+  "<StorageClass>STANDARD</StorageClass>"
+  "<Initiated>2010-11-10T20:48:33.000Z</Initiated>"
+  "</Upload>"
+  "<Upload>"
+  "<Key>my-movie.m2ts</Key>"
+  "<UploadId>YW55IGlkZWEgd2h5IGVsdmluZydzIHVwbG9hZCBmYWlsZWQ</UploadId>"
+  "<StorageClass>STANDARD</StorageClass>"
+  "<Initiated>2010-11-10T20:48:33.000Z</Initiated>"
+  "</Upload>"
+  "</ListMultipartUploadsResult>";
+
+static const char list_uploads_no_uploadid_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListMultipartUploadsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<IsTruncated>false</IsTruncated>"
+  "<Upload><Key>my-divisor</Key></Upload>"
+  "</ListMultipartUploadsResult>";
+
+static const char list_uploads_no_key_reply[] =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<ListMultipartUploadsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+  "<IsTruncated>false</IsTruncated>"
+  "<Upload><UploadId>XMgbGlrZSB5b3VyIGZhdm9yaXRlIHByb2plY3Q</UploadId></Upload>"
+  "</ListMultipartUploadsResult>";
+
+START_TEST(list_parts_test)
+{
+  dpl_vec_t             *parts;
+  dpl_multipart_part_t  *part;
+  int                   truncated;
+  unsigned int          next_marker = 0;
+  dpl_status_t          ret;
+
+  parts = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(parts);
+
+  ret = dpl_s3_parse_multipart_list_parts(NULL, list_parts_reply, sizeof (list_parts_reply) - 1,
+                                          parts, &truncated, &next_marker);
+  dpl_assert_int_eq(DPL_SUCCESS, ret);
+
+  dpl_assert_int_eq(1, truncated);
+  dpl_assert_int_eq(3, next_marker);
+
+  dpl_assert_int_eq(2, parts->n_items);
+  part = dpl_vec_get(parts, 0);
+  dpl_assert_int_eq(2, part->partnb);
+  dpl_assert_str_eq("7778aef83f66abc1fa1e8477f296d394", part->etag);
+  dpl_assert_int_eq(10485760, part->size);
+  part = dpl_vec_get(parts, 1);
+  dpl_assert_int_eq(3, part->partnb);
+  dpl_assert_str_eq("aaaa18db4cc2f85cedef654fccc4a4x8", part->etag);
+
+  dpl_vec_multipart_parts_free(parts);
+}
+END_TEST
+
+START_TEST(list_parts_malformed_test)
+{
+  dpl_vec_t     *parts;
+  int           truncated;
+  unsigned int  next_marker = 0;
+
+  parts = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(parts);
+
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_parse_multipart_list_parts(NULL, list_parts_no_etag_reply,
+                                                      sizeof (list_parts_no_etag_reply) - 1,
+                                                      parts, &truncated, &next_marker));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_parse_multipart_list_parts(NULL, list_parts_no_partnb_reply,
+                                                      sizeof (list_parts_no_partnb_reply) - 1,
+                                                      parts, &truncated, &next_marker));
+  /* not even XML */
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_parse_multipart_list_parts(NULL, "<ListPartsResult", 16,
+                                                      parts, &truncated, &next_marker));
+  dpl_assert_int_eq(0, parts->n_items);
+
+  dpl_vec_multipart_parts_free(parts);
+}
+END_TEST
+
+START_TEST(list_uploads_test)
+{
+  dpl_vec_t               *uploads;
+  dpl_multipart_upload_t  *upload;
+  int                     truncated;
+  char                    *next_key_marker = NULL;
+  char                    *next_uploadid_marker = NULL;
+  dpl_status_t            ret;
+
+  uploads = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(uploads);
+
+  ret = dpl_s3_parse_multipart_list_uploads(NULL, list_uploads_reply, sizeof (list_uploads_reply) - 1,
+                                            uploads, &truncated,
+                                            &next_key_marker, &next_uploadid_marker);
+  dpl_assert_int_eq(DPL_SUCCESS, ret);
+
+  dpl_assert_int_eq(1, truncated);
+  dpl_assert_str_eq("my-movie.m2ts", next_key_marker);
+  dpl_assert_str_eq("YW55IGlkZWEgd2h5IGVsdmluZydzIHVwbG9hZCBmYWlsZWQ", next_uploadid_marker);
+
+  dpl_assert_int_eq(2, uploads->n_items);
+  upload = dpl_vec_get(uploads, 0);
+  dpl_assert_str_eq("my-divisor", upload->key);
+  dpl_assert_str_eq("XMgbGlrZSB5b3VyIGZhdm9yaXRlIHByb2plY3Q", upload->uploadid);
+  dpl_assert_int_eq(dpl_iso8601totime("2010-11-10T20:48:33.000Z"), upload->initiated);
+  upload = dpl_vec_get(uploads, 1);
+  dpl_assert_str_eq("my-movie.m2ts", upload->key);
+
+  free(next_key_marker);
+  free(next_uploadid_marker);
+  dpl_vec_multipart_uploads_free(uploads);
+}
+END_TEST
+
+START_TEST(list_uploads_malformed_test)
+{
+  dpl_vec_t     *uploads;
+  int           truncated;
+  char          *next_key_marker = NULL;
+  char          *next_uploadid_marker = NULL;
+
+  uploads = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(uploads);
+
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_parse_multipart_list_uploads(NULL, list_uploads_no_uploadid_reply,
+                                                        sizeof (list_uploads_no_uploadid_reply) - 1,
+                                                        uploads, &truncated,
+                                                        &next_key_marker, &next_uploadid_marker));
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_s3_parse_multipart_list_uploads(NULL, list_uploads_no_key_reply,
+                                                        sizeof (list_uploads_no_key_reply) - 1,
+                                                        uploads, &truncated,
+                                                        &next_key_marker, &next_uploadid_marker));
+  dpl_assert_int_eq(0, uploads->n_items);
+
+  free(next_key_marker);
+  free(next_uploadid_marker);
+  dpl_vec_multipart_uploads_free(uploads);
+}
+END_TEST
+
+Suite *
+s3_multipart_suite(void)
+{
+  Suite *s = suite_create("s3_multipart");
+  TCase *t = tcase_create("base");
+  tcase_add_test(t, list_parts_test);
+  tcase_add_test(t, list_parts_malformed_test);
+  tcase_add_test(t, list_uploads_test);
+  tcase_add_test(t, list_uploads_malformed_test);
+  suite_add_tcase(s, t);
+  return s;
+}
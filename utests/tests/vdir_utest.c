@@ -0,0 +1,102 @@
+#include <check.h>
+
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+/*
+ * a bare context, enough for the snapshots
+ */
+static dpl_ctx_t *
+ctx_new(const char *cur_bucket)
+{
+  dpl_ctx_t *ctx;
+
+  ctx = calloc(1, sizeof (*ctx));
+  dpl_assert_ptr_not_null(ctx);
+  pthread_mutex_init(&ctx->lock, NULL);
+  ctx->cur_bucket = strdup(cur_bucket);
+  ctx->cwds = dpl_dict_new(13);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_vdir_init(ctx));
+
+  return ctx;
+}
+
+static void
+ctx_free(dpl_ctx_t *ctx)
+{
+  dpl_vdir_free(ctx);
+  dpl_dict_free(ctx->cwds);
+  free(ctx->cur_bucket);
+  pthread_mutex_destroy(&ctx->lock);
+  free(ctx);
+}
+
+START_TEST(vdir_publish_test)
+{
+  dpl_ctx_t *ctx = ctx_new("bucket");
+  struct dpl_vdir *old, *cur;
+
+  old = dpl_vdir_acquire(ctx);
+  dpl_assert_ptr_not_null(old);
+  dpl_assert_str_eq("bucket", dpl_vdir_cur_bucket(old));
+  dpl_assert_ptr_null(dpl_vdir_cwd(old, "bucket"));
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(ctx->cwds, "bucket", "/a/b/", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_vdir_publish(ctx));
+
+  /* a reader keeps its snapshot across a publish */
+  dpl_assert_ptr_null(dpl_vdir_cwd(old, "bucket"));
+
+  cur = dpl_vdir_acquire(ctx);
+  dpl_assert_ptr_ne(old, cur);
+  dpl_assert_str_eq("/a/b/", dpl_vdir_cwd(cur, "bucket"));
+  dpl_vdir_release(ctx, cur);
+
+  dpl_vdir_release(ctx, old);
+
+  /* the retired snapshot goes with the next publish */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_vdir_publish(ctx));
+  dpl_assert_ptr_null(ctx->vdir_retired);
+
+  ctx_free(ctx);
+}
+END_TEST
+
+START_TEST(vdir_cur_bucket_test)
+{
+  dpl_ctx_t *ctx = ctx_new("first");
+  struct dpl_vdir *vdir;
+
+  vdir = dpl_vdir_acquire(ctx);
+  dpl_assert_str_eq("first", dpl_vdir_cur_bucket(vdir));
+  dpl_vdir_release(ctx, vdir);
+
+  /* assigned behind our back, in place so that the address is reused */
+  strcpy(ctx->cur_bucket, "other");
+
+  vdir = dpl_vdir_acquire(ctx);
+  dpl_assert_str_eq("other", dpl_vdir_cur_bucket(vdir));
+  dpl_vdir_release(ctx, vdir);
+
+  free(ctx->cur_bucket);
+  ctx->cur_bucket = NULL;
+
+  vdir = dpl_vdir_acquire(ctx);
+  dpl_assert_str_eq("", dpl_vdir_cur_bucket(vdir));
+  dpl_vdir_release(ctx, vdir);
+
+  ctx_free(ctx);
+}
+END_TEST
+
+Suite *
+vdir_suite(void)
+{
+  Suite *s = suite_create("vdir");
+  TCase *t = tcase_create("base");
+  tcase_add_test(t, vdir_publish_test);
+  tcase_add_test(t, vdir_cur_bucket_test);
+  suite_add_tcase(s, t);
+  return s;
+}
@@ -0,0 +1,1256 @@
+/* unit test the tree operations of vfs.c against an in-memory fake backend */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <check.h>
+#include "dropletp.h"
+#include "droplet/vfs.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+
+/*
+ * the keys of the single bucket, kept sorted as a listing returns them
+ */
+#define STORE_MAX 64
+
+static pthread_mutex_t store_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *store[STORE_MAX];
+static int n_store;
+
+/* what the fake backend does, and saw */
+static int batch_delete;        /* advertise DPL_CAP_BATCH_DELETE */
+static int page_size;           /* entries per listing page, 0 for all */
+static const char *fail_key;    /* reported as not deleted by a batch */
+static int n_delete;
+static int n_delete_all;
+static int n_notempty;          /* directories deleted before their content */
+static int n_list;
+static int n_head;
+static uint64_t obj_size;       /* of every object */
+static char etag[16];           /* of every object, changed to modify them */
+static int n_get;
+static int n_precond;           /* requests failed on their If-Match */
+static uint64_t get_start;      /* of the last get */
+static int get_if_match;        /* whether the last get had an If-Match */
+
+static int
+store_find(const char *key)
+{
+  int i;
+
+  for (i = 0;i < n_store;i++)
+    if (!strcmp(store[i], key))
+      return i;
+
+  return -1;
+}
+
+static void
+store_add(const char *key)
+{
+  int i;
+
+  pthread_mutex_lock(&store_lock);
+  if (-1 == store_find(key))
+    {
+      dpl_assert_int_ne(STORE_MAX, n_store);
+      for (i = n_store;i > 0 && strcmp(store[i - 1], key) > 0;i--)
+        store[i] = store[i - 1];
+      store[i] = strdup(key);
+      dpl_assert_ptr_not_null(store[i]);
+      n_store++;
+    }
+  pthread_mutex_unlock(&store_lock);
+}
+
+/* with the store locked */
+static dpl_status_t
+store_remove(const char *key)
+{
+  int i = store_find(key);
+
+  if (-1 == i)
+    return DPL_ENOENT;
+
+  free(store[i]);
+  memmove(store + i, store + i + 1, (n_store - i - 1) * sizeof (*store));
+  n_store--;
+
+  return DPL_SUCCESS;
+}
+
+static int
+store_has(const char *key)
+{
+  int found;
+
+  pthread_mutex_lock(&store_lock);
+  found = (-1 != store_find(key));
+  pthread_mutex_unlock(&store_lock);
+
+  return found;
+}
+
+static void
+store_clear(void)
+{
+  while (n_store > 0)
+    free(store[--n_store]);
+}
+
+static dpl_status_t
+fake_get_capabilities(dpl_ctx_t *ctx,
+                      dpl_capability_t *maskp)
+{
+  *maskp = DPL_CAP_BUCKETS|DPL_CAP_FNAMES;
+  if (batch_delete)
+    *maskp |= DPL_CAP_BATCH_DELETE;
+
+  return DPL_SUCCESS;
+}
+
+/*
+ * like S3: keys after marker, with those sharing a prefix up to the
+ * delimiter rolled up into one common prefix, and a truncated page
+ * continued from its last entry
+ */
+static dpl_status_t
+fake_list_bucket_page(dpl_ctx_t *ctx, const char *bucket, const char *prefix,
+                      const char *delimiter, const int max_keys,
+                      const char *marker, dpl_vec_t **objectsp,
+                      dpl_vec_t **common_prefixesp, char **next_markerp,
+                      char **locationp)
+{
+  dpl_vec_t *objects, *common_prefixes;
+  size_t prefix_len = (NULL != prefix) ? strlen(prefix) : 0;
+  char entry[DPL_MAXPATHLEN];
+  char last[DPL_MAXPATHLEN] = "";
+  const char *p;
+  int i, n = 0, truncated = 0;
+
+  objects = dpl_vec_new(2, 2);
+  common_prefixes = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(objects);
+  dpl_assert_ptr_not_null(common_prefixes);
+
+  pthread_mutex_lock(&store_lock);
+  n_list++;
+  for (i = 0;i < n_store;i++)
+    {
+      const char *key = store[i];
+      int is_prefix = 0;
+
+      if (strncmp(key, NULL != prefix ? prefix : "", prefix_len))
+        continue ;
+
+      snprintf(entry, sizeof (entry), "%s", key);
+      if (NULL != delimiter &&
+          NULL != (p = strstr(key + prefix_len, delimiter)))
+        {
+          entry[p - key + strlen(delimiter)] = 0;
+          is_prefix = 1;
+        }
+
+      if ((NULL != marker && strcmp(entry, marker) <= 0) ||
+          !strcmp(entry, last))
+        continue ;
+      if (0 != page_size && n == page_size)
+        {
+          truncated = 1;
+          break ;
+        }
+      strcpy(last, entry);
+      n++;
+
+      if (is_prefix)
+        {
+          dpl_common_prefix_t *common_prefix = calloc(1, sizeof (*common_prefix));
+
+          dpl_assert_ptr_not_null(common_prefix);
+          common_prefix->prefix = strdup(entry);
+          dpl_assert_int_eq(DPL_SUCCESS, dpl_vec_add(common_prefixes, common_prefix));
+        }
+      else
+        {
+          dpl_object_t *object = calloc(1, sizeof (*object));
+
+          dpl_assert_ptr_not_null(object);
+          object->path = strdup(entry);
+          object->size = 10;
+          object->type = DPL_FTYPE_REG;
+          dpl_assert_int_eq(DPL_SUCCESS, dpl_vec_add(objects, object));
+        }
+    }
+  pthread_mutex_unlock(&store_lock);
+
+  *objectsp = objects;
+  *common_prefixesp = common_prefixes;
+  if (NULL != next_markerp)
+    {
+      *next_markerp = NULL;
+      if (truncated)
+        {
+          *next_markerp = strdup(last);
+          dpl_assert_ptr_not_null(*next_markerp);
+        }
+    }
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_list_bucket_attrs(dpl_ctx_t *ctx, const char *bucket, const char *prefix,
+                       const char *delimiter, const int max_keys,
+                       dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp,
+                       dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp,
+                       char **locationp)
+{
+  return fake_list_bucket_page(ctx, bucket, prefix, delimiter, max_keys, NULL,
+                               objectsp, common_prefixesp, NULL, locationp);
+}
+
+static dpl_status_t
+fake_list_bucket(dpl_ctx_t *ctx, const char *bucket, const char *prefix,
+                 const char *delimiter, const int max_keys,
+                 dpl_vec_t **objectsp, dpl_vec_t **common_prefixesp,
+                 char **locationp)
+{
+  return fake_list_bucket_page(ctx, bucket, prefix, delimiter, max_keys, NULL,
+                               objectsp, common_prefixesp, NULL, locationp);
+}
+
+static dpl_status_t
+fake_put(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, const dpl_dict_t *metadata,
+         const dpl_sysmd_t *sysmd, const char *data_buf,
+         unsigned int data_len, const dpl_dict_t *query_params,
+         dpl_sysmd_t *returned_sysmdp, char **locationp)
+{
+  store_add(resource);
+
+  return DPL_SUCCESS;
+}
+
+/* byte i of every object */
+#define OBJ_BYTE(i) ('a' + (i) % 26)
+
+static dpl_status_t
+check_condition(const dpl_condition_t *condition)
+{
+  char quoted[DPL_ETAG_SIZE+1];
+  int i;
+
+  if (NULL == condition)
+    return DPL_SUCCESS;
+
+  snprintf(quoted, sizeof (quoted), "\"%s\"", etag);
+  for (i = 0;i < condition->n_conds;i++)
+    {
+      if (DPL_CONDITION_IF_MATCH == condition->conds[i].type &&
+          strcmp(condition->conds[i].etag, quoted))
+        {
+          __sync_fetch_and_add(&n_precond, 1);
+          return DPL_EPRECOND;
+        }
+    }
+
+  return DPL_SUCCESS;
+}
+
+static void
+fill_sysmd(dpl_sysmd_t *sysmdp)
+{
+  memset(sysmdp, 0, sizeof (*sysmdp));
+  sysmdp->mask = DPL_SYSMD_MASK_SIZE|DPL_SYSMD_MASK_ETAG;
+  sysmdp->size = obj_size;
+  snprintf(sysmdp->etag, sizeof (sysmdp->etag), "%s", etag);
+}
+
+static dpl_status_t
+fake_head(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+          const char *subresource, const dpl_option_t *option,
+          dpl_ftype_t object_type, const dpl_condition_t *condition,
+          dpl_dict_t **metadatap, dpl_sysmd_t *sysmdp, char **locationp)
+{
+  __sync_fetch_and_add(&n_head, 1);
+
+  if (!store_has(resource))
+    return DPL_ENOENT;
+
+  if (DPL_SUCCESS != check_condition(condition))
+    return DPL_EPRECOND;
+
+  if (NULL != metadatap)
+    {
+      *metadatap = dpl_dict_new(13);
+      dpl_assert_ptr_not_null(*metadatap);
+    }
+
+  if (NULL != sysmdp)
+    fill_sysmd(sysmdp);
+
+  return DPL_SUCCESS;
+}
+
+static dpl_status_t
+fake_get(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+         const char *subresource, const dpl_option_t *option,
+         dpl_ftype_t object_type, const dpl_condition_t *condition,
+         const dpl_range_t *range, char **data_bufp,
+         unsigned int *data_lenp, dpl_dict_t **metadatap,
+         dpl_sysmd_t *sysmdp, char **locationp)
+{
+  uint64_t start = 0, end = obj_size, i;
+  char *data;
+
+  __sync_fetch_and_add(&n_get, 1);
+  get_if_match = NULL != condition && condition->n_conds > 0;
+
+  if (!store_has(resource))
+    return DPL_ENOENT;
+
+  if (DPL_SUCCESS != check_condition(condition))
+    return DPL_EPRECOND;
+
+  if (NULL != range)
+    {
+      start = range->start;
+      if (range->end + 1 < end)
+        end = range->end + 1;
+    }
+  get_start = start;
+  if (start >= obj_size)
+    return DPL_ERANGEUNAVAIL;
+
+  data = malloc(end - start);
+  dpl_assert_ptr_not_null(data);
+  for (i = start;i < end;i++)
+    data[i - start] = OBJ_BYTE(i);
+
+  *data_bufp = data;
+  *data_lenp = end - start;
+  if (NULL != metadatap)
+    {
+      *metadatap = dpl_dict_new(13);
+      dpl_assert_ptr_not_null(*metadatap);
+    }
+  if (NULL != sysmdp)
+    fill_sysmd(sysmdp);
+
+  return DPL_SUCCESS;
+}
+
+/* like S3, no rename */
+static dpl_status_t
+fake_copy(dpl_ctx_t *ctx, const char *src_bucket, const char *src_resource,
+          const char *src_subresource, const char *dst_bucket,
+          const char *dst_resource, const char *dst_subresource,
+          const dpl_option_t *option, dpl_ftype_t object_type,
+          dpl_copy_directive_t copy_directive, const dpl_dict_t *metadata,
+          const dpl_sysmd_t *sysmd, const dpl_condition_t *condition,
+          char **locationp)
+{
+  if (DPL_COPY_DIRECTIVE_MOVE == copy_directive)
+    return DPL_ENOTSUPP;
+
+  if (!store_has(src_resource))
+    return DPL_ENOENT;
+
+  store_add(dst_resource);
+
+  return DPL_SUCCESS;
+}
+
+/* directories are real there, and must be emptied first */
+static dpl_status_t
+fake_delete(dpl_ctx_t *ctx, const char *bucket, const char *resource,
+            const char *subresource, const dpl_option_t *option,
+            dpl_ftype_t object_type, const dpl_condition_t *condition,
+            char **locationp)
+{
+  size_t len = strlen(resource);
+  dpl_status_t ret;
+  int i;
+
+  pthread_mutex_lock(&store_lock);
+  n_delete++;
+  if (len > 0 && '/' == resource[len - 1])
+    {
+      for (i = 0;i < n_store;i++)
+        if (strlen(store[i]) > len && !strncmp(store[i], resource, len))
+          {
+            n_notempty++;
+            ret = DPL_ENOTEMPTY;
+            goto end;
+          }
+    }
+  ret = store_remove(resource);
+
+ end:
+  pthread_mutex_unlock(&store_lock);
+
+  return ret;
+}
+
+/* like S3, a status per key */
+static dpl_status_t
+fake_delete_all(dpl_ctx_t *ctx, const char *bucket, dpl_locators_t *locators,
+                const dpl_option_t *option, const dpl_condition_t *condition,
+                dpl_vec_t **objectsp)
+{
+  dpl_vec_t *objects;
+  unsigned int i;
+
+  objects = dpl_vec_new(2, 2);
+  dpl_assert_ptr_not_null(objects);
+
+  pthread_mutex_lock(&store_lock);
+  n_delete_all++;
+  for (i = 0;i < locators->size;i++)
+    {
+      dpl_delete_object_t *object = calloc(1, sizeof (*object));
+
+      dpl_assert_ptr_not_null(object);
+      object->name = strdup(locators->tab[i].name);
+      if (NULL != fail_key && !strcmp(fail_key, object->name))
+        object->status = DPL_EPERM;
+      else
+        object->status = store_remove(object->name);
+      dpl_assert_int_eq(DPL_SUCCESS, dpl_vec_add(objects, object));
+    }
+  pthread_mutex_unlock(&store_lock);
+
+  *objectsp = objects;
+
+  return DPL_SUCCESS;
+}
+
+static dpl_backend_t fake_backend =
+  {
+    .name = "fake",
+    .get_capabilities = fake_get_capabilities,
+    .list_bucket = fake_list_bucket,
+    .list_bucket_attrs = fake_list_bucket_attrs,
+    .list_bucket_page = fake_list_bucket_page,
+    .head = fake_head,
+    .get = fake_get,
+    .put = fake_put,
+    .copy = fake_copy,
+    .deletef = fake_delete,
+    .delete_all = fake_delete_all,
+  };
+
+/*
+ * d/ has a marker and a subdirectory with one (d/s/), and another
+ * only synthesized from its keys (d/t/)
+ */
+static void
+make_tree(void)
+{
+  store_add("a");
+  store_add("d/");
+  store_add("d/x");
+  store_add("d/s/");
+  store_add("d/s/y");
+  store_add("d/s/z");
+  store_add("d/t/u");
+  store_add("e");
+}
+
+static void
+setup(void)
+{
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", "localhost", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "retry_max", "0", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  ctx->backend = &fake_backend;
+  ctx->copy_parallel_threshold = 0;
+
+  store_clear();
+  batch_delete = 0;
+  fail_key = NULL;
+  page_size = 0;
+  n_delete = n_delete_all = n_notempty = n_list = n_head = 0;
+  obj_size = 10;
+  strcpy(etag, "v1");
+  n_get = n_precond = 0;
+  make_tree();
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+  store_clear();
+}
+
+START_TEST(rmdir_one_by_one_test)
+{
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_rmdir_recursive(ctx, "b:/d"));
+
+  /* every directory was emptied before its marker went */
+  dpl_assert_int_eq(0, n_notempty);
+  dpl_assert_int_eq(0, n_delete_all);
+  /* 4 files, 2 subdirectories and d/ itself */
+  dpl_assert_int_eq(7, n_delete);
+
+  dpl_assert_int_eq(2, n_store);
+  dpl_assert_int_eq(1, store_has("a"));
+  dpl_assert_int_eq(1, store_has("e"));
+}
+END_TEST
+
+START_TEST(rmdir_batch_test)
+{
+  batch_delete = 1;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_rmdir_recursive(ctx, "b:/d"));
+
+  /* the content, then d/ itself */
+  dpl_assert_int_eq(2, n_delete_all);
+  dpl_assert_int_eq(0, n_delete);
+  dpl_assert_int_eq(2, n_store);
+
+  /* a key the batch could not delete fails the whole */
+  make_tree();
+  fail_key = "d/s/y";
+  dpl_assert_int_eq(DPL_EPERM, dpl_rmdir_recursive(ctx, "b:/d"));
+  dpl_assert_int_eq(1, store_has("d/s/y"));
+  dpl_assert_int_eq(0, store_has("d/x"));
+}
+END_TEST
+
+START_TEST(rmdir_root_test)
+{
+  dpl_assert_int_eq(DPL_EINVAL, dpl_rmdir_recursive(ctx, "b:/"));
+  dpl_assert_int_eq(8, n_store);
+}
+END_TEST
+
+START_TEST(fcopy_test)
+{
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_fcopy_recursive(ctx, "b:/d", "b:/c"));
+
+  dpl_assert_int_eq(1, store_has("c/"));
+  dpl_assert_int_eq(1, store_has("c/x"));
+  dpl_assert_int_eq(1, store_has("c/s/"));
+  dpl_assert_int_eq(1, store_has("c/s/y"));
+  dpl_assert_int_eq(1, store_has("c/s/z"));
+  /* synthesized directories get a marker */
+  dpl_assert_int_eq(1, store_has("c/t/"));
+  dpl_assert_int_eq(1, store_has("c/t/u"));
+  dpl_assert_int_eq(15, n_store);
+}
+END_TEST
+
+START_TEST(fcopy_into_itself_test)
+{
+  dpl_assert_int_eq(DPL_EINVAL, dpl_fcopy_recursive(ctx, "b:/d", "b:/d/s/c"));
+  dpl_assert_int_eq(DPL_EINVAL, dpl_fcopy_recursive(ctx, "b:/d", "b:/d"));
+  dpl_assert_int_eq(8, n_store);
+
+  /* a sibling sharing the name as a prefix is not inside */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_fcopy_recursive(ctx, "b:/d", "b:/dd"));
+  dpl_assert_int_eq(1, store_has("dd/t/u"));
+
+  /* nor another bucket */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_fcopy_recursive(ctx, "b:/d", "c:/d/s"));
+}
+END_TEST
+
+/*
+ * walk callback recording the visits as "<dir", ">dir" (pre and
+ * post-order) and "=file", with depths
+ */
+#define VISITS_MAX 32
+
+struct visits
+{
+  char tab[VISITS_MAX][DPL_MAXPATHLEN + 1];
+  int depth[VISITS_MAX];
+  int n;
+  const char *prune;            /* return 1 on its pre-order visit */
+  const char *abort;            /* return -1 on its visit */
+};
+
+static int
+record_cb(dpl_dirent_t *dirent,
+          int depth,
+          dpl_walk_visit_t visit,
+          void *cb_arg)
+{
+  struct visits *visits = cb_arg;
+  char c;
+
+  c = (DPL_WALK_VISIT_PRE == visit) ? '<' : (DPL_WALK_VISIT_POST == visit) ? '>' : '=';
+
+  dpl_assert_int_ne(VISITS_MAX, visits->n);
+  snprintf(visits->tab[visits->n], sizeof (visits->tab[0]), "%c%s", c, dirent->fqn.path);
+  visits->depth[visits->n] = depth;
+  visits->n++;
+
+  if (NULL != visits->abort && !strcmp(visits->abort, dirent->fqn.path))
+    return -1;
+
+  if (DPL_WALK_VISIT_PRE == visit &&
+      NULL != visits->prune && !strcmp(visits->prune, dirent->fqn.path))
+    return 1;
+
+  return 0;
+}
+
+/* index of a visit, -1 if it did not happen */
+static int
+visited(struct visits *visits,
+        const char *visit)
+{
+  int i;
+
+  for (i = 0;i < visits->n;i++)
+    if (!strcmp(visits->tab[i], visit))
+      return i;
+
+  return -1;
+}
+
+#define visited_before(visits, v1, v2)                                  \
+  ck_assert_msg(-1 != visited(visits, v1) && -1 != visited(visits, v2) && \
+                visited(visits, v1) < visited(visits, v2),              \
+                "%s not visited before %s", v1, v2)
+
+START_TEST(walk_preorder_test)
+{
+  struct visits visits;
+
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER, NULL, record_cb, &visits, 4));
+
+  /* the root itself and directory markers are not reported */
+  dpl_assert_int_eq(9, visits.n);
+  dpl_assert_int_eq(-1, visited(&visits, "=d/"));
+  dpl_assert_int_eq(-1, visited(&visits, "=d/s/"));
+  dpl_assert_int_ne(-1, visited(&visits, "=a"));
+  dpl_assert_int_ne(-1, visited(&visits, "=e"));
+  dpl_assert_int_eq(1, visits.depth[visited(&visits, "=a")]);
+
+  visited_before(&visits, "<d/", "=d/x");
+  visited_before(&visits, "<d/", "<d/s/");
+  visited_before(&visits, "<d/s/", "=d/s/y");
+  visited_before(&visits, "<d/s/", "=d/s/z");
+  /* synthesized from its keys */
+  visited_before(&visits, "<d/t/", "=d/t/u");
+  /* in listing order within a directory */
+  visited_before(&visits, "=d/s/y", "=d/s/z");
+  dpl_assert_int_eq(2, visits.depth[visited(&visits, "<d/s/")]);
+  dpl_assert_int_eq(3, visits.depth[visited(&visits, "=d/s/y")]);
+  dpl_assert_int_eq(-1, visited(&visits, ">d/"));
+}
+END_TEST
+
+START_TEST(walk_postorder_test)
+{
+  struct visits visits;
+
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_POSTORDER, NULL, record_cb, &visits, 4));
+
+  dpl_assert_int_eq(9, visits.n);
+  dpl_assert_int_eq(-1, visited(&visits, "<d/"));
+  visited_before(&visits, "=d/s/y", ">d/s/");
+  visited_before(&visits, "=d/s/z", ">d/s/");
+  visited_before(&visits, "=d/t/u", ">d/t/");
+  visited_before(&visits, "=d/x", ">d/");
+  visited_before(&visits, ">d/s/", ">d/");
+  visited_before(&visits, ">d/t/", ">d/");
+  dpl_assert_int_eq(1, visits.depth[visited(&visits, ">d/")]);
+
+  /* both */
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/d", DPL_WALK_PREORDER|DPL_WALK_POSTORDER,
+                             NULL, record_cb, &visits, 4));
+  dpl_assert_int_eq(8, visits.n);
+  visited_before(&visits, "<d/s/", "=d/s/y");
+  visited_before(&visits, "=d/s/y", ">d/s/");
+  /* relative to the root */
+  dpl_assert_int_eq(1, visits.depth[visited(&visits, "<d/s/")]);
+  dpl_assert_int_eq(2, visits.depth[visited(&visits, "=d/s/y")]);
+}
+END_TEST
+
+START_TEST(walk_max_depth_test)
+{
+  struct visits visits;
+  dpl_walk_params_t params;
+
+  memset(&params, 0, sizeof (params));
+
+  /* the root content only */
+  params.max_depth = 1;
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER|DPL_WALK_POSTORDER,
+                             &params, record_cb, &visits, 4));
+  dpl_assert_int_eq(4, visits.n);
+  dpl_assert_int_ne(-1, visited(&visits, "<d/"));
+  dpl_assert_int_ne(-1, visited(&visits, ">d/"));
+  dpl_assert_int_eq(-1, visited(&visits, "=d/x"));
+
+  /* directories at the limit are reported, not listed */
+  params.max_depth = 2;
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_POSTORDER, &params, record_cb, &visits, 4));
+  dpl_assert_int_eq(6, visits.n);
+  dpl_assert_int_ne(-1, visited(&visits, ">d/s/"));
+  dpl_assert_int_ne(-1, visited(&visits, ">d/t/"));
+  dpl_assert_int_eq(-1, visited(&visits, "=d/s/y"));
+
+  params.max_depth = 0;
+  dpl_assert_int_eq(DPL_EINVAL,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER, &params, record_cb, &visits, 4));
+}
+END_TEST
+
+START_TEST(walk_prune_test)
+{
+  struct visits visits;
+
+  memset(&visits, 0, sizeof (visits));
+  visits.prune = "d/s/";
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER|DPL_WALK_POSTORDER,
+                             NULL, record_cb, &visits, 4));
+
+  dpl_assert_int_ne(-1, visited(&visits, "<d/s/"));
+  dpl_assert_int_eq(-1, visited(&visits, "=d/s/y"));
+  dpl_assert_int_eq(-1, visited(&visits, "=d/s/z"));
+  dpl_assert_int_eq(-1, visited(&visits, ">d/s/"));
+  /* its siblings are not */
+  dpl_assert_int_ne(-1, visited(&visits, "=d/t/u"));
+  dpl_assert_int_ne(-1, visited(&visits, ">d/"));
+}
+END_TEST
+
+START_TEST(walk_abort_test)
+{
+  struct visits visits;
+
+  /* a single lister, for the visits to be ordered */
+  memset(&visits, 0, sizeof (visits));
+  visits.abort = "d/";
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER, NULL, record_cb, &visits, 1));
+  dpl_assert_str_eq("<d/", visits.tab[visits.n - 1]);
+  dpl_assert_int_eq(-1, visited(&visits, "=d/x"));
+
+  memset(&visits, 0, sizeof (visits));
+  visits.abort = "d/s/y";
+  dpl_assert_int_eq(DPL_FAILURE,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER|DPL_WALK_POSTORDER,
+                             NULL, record_cb, &visits, 1));
+  dpl_assert_str_eq("=d/s/y", visits.tab[visits.n - 1]);
+  /* no post-order visit of what was left unfinished */
+  dpl_assert_int_eq(-1, visited(&visits, ">d/s/"));
+  dpl_assert_int_eq(-1, visited(&visits, ">d/"));
+}
+END_TEST
+
+static void
+assert_visits(struct visits *visits,
+              const char * const *expected,
+              int n_expected)
+{
+  int i;
+
+  for (i = 0;i < n_expected && i < visits->n;i++)
+    dpl_assert_str_eq(expected[i], visits->tab[i]);
+  dpl_assert_int_eq(n_expected, visits->n);
+}
+
+START_TEST(walk_flat_test)
+{
+  struct visits visits;
+  static const char * const both[] =
+    {
+      "=a", "<d/", "<d/s/", "=d/s/y", "=d/s/z", ">d/s/",
+      "<d/t/", "=d/t/u", ">d/t/", "=d/x", ">d/", "=e",
+    };
+  static const char * const post[] =
+    {
+      "=a", "=d/s/y", "=d/s/z", ">d/s/", "=d/t/u", ">d/t/", "=d/x", ">d/", "=e",
+    };
+
+  /* depth-first, in a single scan */
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_PREORDER|DPL_WALK_POSTORDER|DPL_WALK_FLAT,
+                             NULL, record_cb, &visits, 4));
+  assert_visits(&visits, both, sizeof (both) / sizeof (both[0]));
+  dpl_assert_int_eq(1, n_list);
+  dpl_assert_int_eq(1, visits.depth[visited(&visits, "<d/")]);
+  dpl_assert_int_eq(2, visits.depth[visited(&visits, ">d/t/")]);
+  dpl_assert_int_eq(3, visits.depth[visited(&visits, "=d/t/u")]);
+
+  /* a directory is closed as soon as a key outside of it shows up */
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/", DPL_WALK_POSTORDER|DPL_WALK_FLAT,
+                             NULL, record_cb, &visits, 4));
+  assert_visits(&visits, post, sizeof (post) / sizeof (post[0]));
+}
+END_TEST
+
+START_TEST(walk_flat_synthesize_test)
+{
+  struct visits visits;
+  dpl_walk_params_t params;
+  static const char * const expected[] =
+    {
+      "<g/h/", "<g/h/i/", "=g/h/i/j", ">g/h/i/", "=g/h/k", ">g/h/",
+    };
+
+  /* none of these directories has a marker */
+  store_add("g/h/i/j");
+  store_add("g/h/k");
+
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/g", DPL_WALK_PREORDER|DPL_WALK_POSTORDER|DPL_WALK_FLAT,
+                             NULL, record_cb, &visits, 4));
+  /* relative to, and without, the root */
+  assert_visits(&visits, expected, sizeof (expected) / sizeof (expected[0]));
+  dpl_assert_int_eq(1, visits.depth[visited(&visits, "<g/h/")]);
+
+  /* pruned, and limited in depth */
+  memset(&visits, 0, sizeof (visits));
+  visits.prune = "g/h/i/";
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/g", DPL_WALK_PREORDER|DPL_WALK_POSTORDER|DPL_WALK_FLAT,
+                             NULL, record_cb, &visits, 4));
+  dpl_assert_int_eq(-1, visited(&visits, "=g/h/i/j"));
+  dpl_assert_int_eq(-1, visited(&visits, ">g/h/i/"));
+  dpl_assert_int_ne(-1, visited(&visits, "=g/h/k"));
+
+  memset(&params, 0, sizeof (params));
+  params.max_depth = 1;
+  memset(&visits, 0, sizeof (visits));
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_walk(ctx, "b:/g", DPL_WALK_PREORDER|DPL_WALK_POSTORDER|DPL_WALK_FLAT,
+                             &params, record_cb, &visits, 4));
+  dpl_assert_int_eq(2, visits.n);
+  dpl_assert_str_eq("<g/h/", visits.tab[0]);
+  dpl_assert_str_eq(">g/h/", visits.tab[1]);
+}
+END_TEST
+
+static void
+enable_dcache(int ttl)
+{
+  ctx->dcache_ttl = ttl;
+  ctx->dcache_negative_ttl = ttl;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dcache_init(ctx));
+}
+
+START_TEST(dcache_lookup_test)
+{
+  enable_dcache(60);
+
+  /* a listing per component */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(3, n_list);
+
+  /* which filled the cache for the siblings too */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/z", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(3, n_list);
+
+  /* a miss is listed once, then cached as such */
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/s/w", NULL, NULL));
+  dpl_assert_int_eq(4, n_list);
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/s/w", NULL, NULL));
+  dpl_assert_int_eq(4, n_list);
+
+  /* disabled, everything is listed */
+  n_list = 0;
+  dpl_dcache_free(ctx);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(6, n_list);
+}
+END_TEST
+
+START_TEST(dcache_expiry_test)
+{
+  enable_dcache(1);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(3, n_list);
+
+  sleep(2);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(5, n_list);
+  /* the relisting only refreshes what exists, the miss is checked anew */
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(6, n_list);
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(6, n_list);
+}
+END_TEST
+
+START_TEST(dcache_invalidate_test)
+{
+  enable_dcache(60);
+
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/s/w", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+
+  /* a put replaces the negative entry */
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_fput(ctx, "b:d/s/w", NULL, NULL, NULL, NULL, NULL, "w", 1));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/w", NULL, NULL));
+
+  /* a delete the positive one */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_unlink(ctx, "b:d/s/y"));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+
+  /* a rename both */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_rename(ctx, "b:d/x", "b:d/s/y", DPL_FTYPE_REG));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+
+  /* removing a directory drops what is below it */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_rmdir_recursive(ctx, "b:/d"));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/s/w", NULL, NULL));
+}
+END_TEST
+
+/* read a whole directory, as "name/" for the subdirectories */
+static int
+read_dir(const char *locator, char names[][DPL_MAXNAMLEN], int max)
+{
+  void *dir_hdl = NULL;
+  dpl_dirent_t dirent;
+  int n = 0;
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_opendir(ctx, locator, &dir_hdl));
+  while (!dpl_eof(dir_hdl))
+    {
+      dpl_assert_int_eq(DPL_SUCCESS, dpl_readdir(dir_hdl, &dirent));
+      dpl_assert_int_ne(max, n);
+      snprintf(names[n++], DPL_MAXNAMLEN, "%s", dirent.name);
+    }
+  dpl_assert_int_eq(DPL_ENOENT, dpl_readdir(dir_hdl, &dirent));
+  dpl_closedir(dir_hdl);
+
+  return n;
+}
+
+START_TEST(readdir_pages_test)
+{
+  char names[16][DPL_MAXNAMLEN];
+  int n;
+
+  store_add("p/a");
+  store_add("p/b/1");
+  store_add("p/b/2");
+  store_add("p/b/3");
+  store_add("p/c");
+  store_add("p/d/x");
+  store_add("p/e");
+
+  /* p/a p/b/ | p/c p/d/ | p/e: the first page ends on a common prefix */
+  page_size = 2;
+  n = read_dir("b:/p", names, 16);
+  dpl_assert_int_eq(3, n_list);
+  dpl_assert_int_eq(5, n);
+  /* each page lists its files before its directories */
+  dpl_assert_str_eq("a", names[0]);
+  dpl_assert_str_eq("b/", names[1]);
+  dpl_assert_str_eq("c", names[2]);
+  dpl_assert_str_eq("d/", names[3]);
+  dpl_assert_str_eq("e", names[4]);
+
+  /* a last page that is full */
+  n_list = 0;
+  store_add("p/f");
+  n = read_dir("b:/p", names, 16);
+  dpl_assert_int_eq(3, n_list);
+  dpl_assert_int_eq(6, n);
+  dpl_assert_str_eq("f", names[5]);
+
+  /* one entry a page, the next skipping the keys under b/ */
+  n_list = 0;
+  page_size = 1;
+  n = read_dir("b:/p", names, 16);
+  dpl_assert_int_eq(6, n_list);
+  dpl_assert_int_eq(6, n);
+  dpl_assert_str_eq("b/", names[1]);
+  dpl_assert_str_eq("c", names[2]);
+
+  /* a single page */
+  n_list = 0;
+  page_size = 0;
+  n = read_dir("b:/p", names, 16);
+  dpl_assert_int_eq(1, n_list);
+  dpl_assert_int_eq(6, n);
+  /* all the files of the page, then its directories */
+  dpl_assert_str_eq("a", names[0]);
+  dpl_assert_str_eq("c", names[1]);
+  dpl_assert_str_eq("e", names[2]);
+  dpl_assert_str_eq("f", names[3]);
+  dpl_assert_str_eq("b/", names[4]);
+  dpl_assert_str_eq("d/", names[5]);
+}
+END_TEST
+
+START_TEST(readdir_empty_test)
+{
+  char names[4][DPL_MAXNAMLEN];
+
+  page_size = 1;
+  dpl_assert_int_eq(0, read_dir("b:/nope", names, 4));
+  dpl_assert_int_eq(1, n_list);
+}
+END_TEST
+
+START_TEST(acache_getattr_test)
+{
+  dpl_sysmd_t sysmd;
+
+  ctx->acache_ttl = 60;
+  ctx->acache_negative_ttl = 60;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_acache_init(ctx));
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, &sysmd));
+  dpl_assert_int_eq(10, sysmd.size);
+  dpl_assert_int_eq(1, n_head);
+  memset(&sysmd, 0, sizeof (sysmd));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, &sysmd));
+  dpl_assert_int_eq(10, sysmd.size);
+  dpl_assert_int_eq(1, n_head);
+
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(2, n_head);
+
+  /* writes through the ctx drop what they change */
+  dpl_assert_int_eq(DPL_SUCCESS,
+                    dpl_fput(ctx, "b:d/w", NULL, NULL, NULL, NULL, NULL, "w", 1));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_unlink(ctx, "b:d/x"));
+  n_head = 0;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(2, n_head);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_rename(ctx, "b:d/w", "b:d/x", DPL_FTYPE_REG));
+  n_head = 0;
+  dpl_assert_int_eq(DPL_ENOENT, dpl_getattr(ctx, "b:d/w", NULL, NULL));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/x", NULL, NULL));
+  dpl_assert_int_eq(2, n_head);
+
+  /* not the others */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(3, n_head);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_fput(ctx, "b:e", NULL, NULL, NULL, NULL, NULL, "e", 1));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_getattr(ctx, "b:d/s/y", NULL, NULL));
+  dpl_assert_int_eq(3, n_head);
+}
+END_TEST
+
+static dpl_vfile_t *
+open_readahead(dpl_vfile_flag_t flags)
+{
+  dpl_vfile_t *vfile = NULL;
+
+  obj_size = 1000;
+  store_add("o");
+  ctx->read_ahead_size = 100;
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_open(ctx, "b:o", flags, NULL, NULL, NULL,
+                                          NULL, NULL, NULL, &vfile));
+  dpl_assert_ptr_not_null(vfile);
+
+  return vfile;
+}
+
+/* read 10 bytes at offset, and check them */
+static void
+read_at(dpl_vfile_t *vfile, unsigned long long offset)
+{
+  char *buf = NULL;
+  unsigned int len = 0, i;
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_pread(vfile, 10, offset, &buf, &len));
+  ck_assert_msg(len >= 10, "short read of %u bytes at %llu", len, offset);
+  for (i = 0;i < 10;i++)
+    dpl_assert_int_eq(OBJ_BYTE(offset + i), buf[i]);
+  free(buf);
+}
+
+START_TEST(readahead_sequential_test)
+{
+  dpl_vfile_t *vfile;
+  unsigned long long off;
+
+  vfile = open_readahead(DPL_VFILE_FLAG_RDONLY);
+
+  /* a first read is done directly */
+  read_at(vfile, 500);
+  dpl_assert_int_eq(1, n_get);
+  dpl_assert_int_eq(500, get_start);
+
+  /* the next sequential one fetches a window, with nothing to match yet */
+  read_at(vfile, 510);
+  dpl_assert_int_eq(2, n_get);
+  dpl_assert_int_eq(510, get_start);
+  dpl_assert_int_eq(0, get_if_match);
+
+  /* past its middle, the next window is prefetched */
+  for (off = 520;off < 610;off += 10)
+    read_at(vfile, off);
+  read_at(vfile, 610);
+  dpl_assert_int_eq(3, n_get);
+  dpl_assert_int_eq(610, get_start);
+  dpl_assert_int_eq(1, get_if_match);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_close(vfile));
+  dpl_assert_int_eq(0, n_precond);
+
+  /* unless the file is accessed randomly */
+  n_get = 0;
+  vfile = open_readahead(DPL_VFILE_FLAG_RDONLY|DPL_VFILE_FLAG_RANDOM);
+  for (off = 0;off < 50;off += 10)
+    read_at(vfile, off);
+  dpl_assert_int_eq(5, n_get);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_close(vfile));
+}
+END_TEST
+
+START_TEST(readahead_reset_test)
+{
+  dpl_vfile_t *vfile;
+
+  vfile = open_readahead(DPL_VFILE_FLAG_RDONLY);
+
+  read_at(vfile, 500);
+  read_at(vfile, 510);
+  read_at(vfile, 520);
+  dpl_assert_int_eq(2, n_get);
+
+  /* elsewhere, done directly */
+  read_at(vfile, 200);
+  dpl_assert_int_eq(3, n_get);
+  dpl_assert_int_eq(200, get_start);
+  read_at(vfile, 700);
+  dpl_assert_int_eq(4, n_get);
+  dpl_assert_int_eq(700, get_start);
+
+  /* until sequential again, from there */
+  read_at(vfile, 710);
+  dpl_assert_int_eq(5, n_get);
+  dpl_assert_int_eq(710, get_start);
+  read_at(vfile, 720);
+  dpl_assert_int_eq(5, n_get);
+
+  /* the old window is gone */
+  read_at(vfile, 530);
+  dpl_assert_int_eq(6, n_get);
+  dpl_assert_int_eq(530, get_start);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_close(vfile));
+}
+END_TEST
+
+START_TEST(readahead_modified_test)
+{
+  dpl_vfile_t *vfile;
+  unsigned long long off;
+
+  vfile = open_readahead(DPL_VFILE_FLAG_RDONLY);
+
+  read_at(vfile, 500);
+  read_at(vfile, 510);
+  dpl_assert_int_eq(2, n_get);
+
+  /* modified while its first window is read */
+  strcpy(etag, "v2");
+
+  /* the prefetch of the next one fails its If-Match */
+  for (off = 520;off < 610;off += 10)
+    read_at(vfile, off);
+  read_at(vfile, 610);
+  dpl_assert_int_eq(1, n_precond);
+  /* and the read is done directly, unconditionally */
+  dpl_assert_int_eq(610, get_start);
+  dpl_assert_int_eq(0, get_if_match);
+
+  /* then windows are matched against the new ETag */
+  read_at(vfile, 620);
+  dpl_assert_int_eq(620, get_start);
+  dpl_assert_int_eq(0, get_if_match);
+  for (off = 630;off < 720;off += 10)
+    read_at(vfile, off);
+  read_at(vfile, 720);
+  dpl_assert_int_eq(720, get_start);
+  dpl_assert_int_eq(1, get_if_match);
+  dpl_assert_int_eq(1, n_precond);
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_close(vfile));
+}
+END_TEST
+
+Suite *
+vfs_suite(void)
+{
+  Suite *s = suite_create("vfs");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, rmdir_one_by_one_test);
+  tcase_add_test(t, rmdir_batch_test);
+  tcase_add_test(t, rmdir_root_test);
+  tcase_add_test(t, fcopy_test);
+  tcase_add_test(t, fcopy_into_itself_test);
+  tcase_add_test(t, walk_preorder_test);
+  tcase_add_test(t, walk_postorder_test);
+  tcase_add_test(t, walk_max_depth_test);
+  tcase_add_test(t, walk_prune_test);
+  tcase_add_test(t, walk_abort_test);
+  tcase_add_test(t, walk_flat_test);
+  tcase_add_test(t, walk_flat_synthesize_test);
+  tcase_add_test(t, dcache_lookup_test);
+  tcase_add_test(t, dcache_expiry_test);
+  tcase_add_test(t, dcache_invalidate_test);
+  tcase_add_test(t, readdir_pages_test);
+  tcase_add_test(t, readdir_empty_test);
+  tcase_add_test(t, acache_getattr_test);
+  tcase_add_test(t, readahead_sequential_test);
+  tcase_add_test(t, readahead_reset_test);
+  tcase_add_test(t, readahead_modified_test);
+  suite_add_tcase(s, t);
+  return s;
+}
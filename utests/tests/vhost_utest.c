@@ -0,0 +1,162 @@
+/* unit test the virtual-hosted bucket address cache of conn.c */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <check.h>
+#include "dropletp.h"
+
+#include "utest_main.h"
+
+static dpl_ctx_t *ctx = NULL;
+static dpl_dict_t *profile = NULL;
+/* bound but not listening, so that connecting to it is refused */
+static int sock = -1;
+static int port;
+
+static void
+setup(void)
+{
+  struct sockaddr_in sin;
+  socklen_t sinlen = sizeof (sin);
+  char hosts[64];
+
+  unsetenv("DPLDIR");
+  unsetenv("DPLPROFILE");
+  dpl_init();
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  dpl_assert_int_ne(-1, sock);
+  memset(&sin, 0, sizeof (sin));
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_ANY);
+  dpl_assert_int_eq(0, bind(sock, (struct sockaddr *) &sin, sizeof (sin)));
+  dpl_assert_int_eq(0, getsockname(sock, (struct sockaddr *) &sin, &sinlen));
+  port = ntohs(sin.sin_port);
+
+  /*
+   * the buckets of "127" then live at 127.0.0.1 and 127.0.0.2, which
+   * resolve without a name server and are not the endpoints'
+   */
+  snprintf(hosts, sizeof (hosts), "0.0.1:%d,0.0.2:%d", port, port);
+
+  profile = dpl_dict_new(13);
+  dpl_assert_ptr_not_null(profile);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "host", hosts, 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "droplet_dir", "/never/seen", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "profile_name", "viral", 0));
+  /* need this to disable the event log, otherwise the droplet_dir needs to exist */
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "pricing_dir", "", 0));
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_dict_add(profile, "vhost_cache_ttl", "60", 0));
+
+  ctx = dpl_ctx_new_from_dict(profile);
+  dpl_assert_ptr_not_null(ctx);
+  dpl_assert_ptr_not_null(ctx->vhost_buckets);
+}
+
+static void
+teardown(void)
+{
+  dpl_ctx_free(ctx);
+  ctx = NULL;
+  dpl_dict_free(profile);
+  close(sock);
+  sock = -1;
+}
+
+START_TEST(cache_test)
+{
+  struct in_addr in, out;
+  int len = 0;
+
+  in.s_addr = inet_addr("10.0.0.1");
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "b.example", AF_INET, (char *) &out, &len));
+
+  dpl_vhost_insert(ctx, "b.example", AF_INET, (char *) &in, sizeof (in));
+  dpl_assert_int_eq(1, dpl_vhost_lookup(ctx, "b.example", AF_INET, (char *) &out, &len));
+  dpl_assert_int_eq(sizeof (in), len);
+  dpl_assert_int_eq(in.s_addr, out.s_addr);
+
+  /* keyed by name and family */
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "c.example", AF_INET, (char *) &out, &len));
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "b.example", AF_INET6, (char *) &out, &len));
+
+  dpl_vhost_forget(ctx, "b.example");
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "b.example", AF_INET, (char *) &out, &len));
+
+  /* expires as soon as inserted */
+  ctx->vhost_cache_ttl = 0;
+  dpl_vhost_insert(ctx, "b.example", AF_INET, (char *) &in, sizeof (in));
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "b.example", AF_INET, (char *) &out, &len));
+}
+END_TEST
+
+START_TEST(connect_test)
+{
+  dpl_req_t *req;
+  dpl_conn_t *conn = NULL;
+  struct in_addr out;
+  int len = 0;
+
+  dpl_assert_int_eq(0, listen(sock, 1));
+
+  req = dpl_req_new(ctx);
+  dpl_assert_ptr_not_null(req);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_req_set_bucket(req, "127"));
+  req->behavior_flags |= DPL_BEHAVIOR_VIRTUAL_HOSTING;
+
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_try_connect(ctx, req, &conn));
+  dpl_assert_ptr_not_null(conn);
+  dpl_conn_terminate(conn);
+
+  /* whichever endpoint served it */
+  dpl_assert_int_eq(1, dpl_vhost_lookup(ctx, req->host, AF_INET, (char *) &out, &len));
+  dpl_assert_int_eq(inet_addr(req->host), out.s_addr);
+  dpl_req_free(req);
+}
+END_TEST
+
+START_TEST(fallback_test)
+{
+  dpl_req_t *req;
+  dpl_conn_t *conn = NULL;
+  struct in_addr out;
+  int len = 0;
+
+  req = dpl_req_new(ctx);
+  dpl_assert_ptr_not_null(req);
+  dpl_assert_int_eq(DPL_SUCCESS, dpl_req_set_bucket(req, "127"));
+  req->behavior_flags |= DPL_BEHAVIOR_VIRTUAL_HOSTING;
+
+  /* the bucket is unreachable through every endpoint */
+  dpl_assert_int_eq(DPL_ECONNECT, dpl_try_connect(ctx, req, &conn));
+  dpl_assert_ptr_null(conn);
+
+  /* which still serve the other buckets */
+  dpl_assert_int_eq(2, dpl_addrlist_count_avail_nolock(ctx->addrlist));
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "127.0.0.1", AF_INET, (char *) &out, &len));
+  dpl_assert_int_eq(0, dpl_vhost_lookup(ctx, "127.0.0.2", AF_INET, (char *) &out, &len));
+
+  /* while path-style failures are the endpoints' own */
+  req->behavior_flags &= ~DPL_BEHAVIOR_VIRTUAL_HOSTING;
+  dpl_assert_int_eq(DPL_ECONNECT, dpl_try_connect(ctx, req, &conn));
+  dpl_assert_int_eq(0, dpl_addrlist_count_avail_nolock(ctx->addrlist));
+
+  dpl_req_free(req);
+}
+END_TEST
+
+Suite *
+vhost_suite(void)
+{
+  Suite *s = suite_create("vhost");
+  TCase *t = tcase_create("base");
+  tcase_add_checked_fixture(t, setup, teardown);
+  tcase_add_test(t, cache_test);
+  tcase_add_test(t, connect_test);
+  tcase_add_test(t, fallback_test);
+  suite_add_tcase(s, t);
+  return s;
+}
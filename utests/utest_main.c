@@ -118,12 +118,27 @@ main(int argc, char ** argv)
   srunner_add_suite(r, addrlist_suite());
   srunner_add_suite(r, util_suite());
   srunner_add_suite(r, sproxyd_suite());
+  srunner_add_suite(r, vdir_suite());
+  srunner_add_suite(r, copy_suite());
+  srunner_add_suite(r, retry_suite());
+  srunner_add_suite(r, crypt_suite());
+  srunner_add_suite(r, compress_suite());
+  srunner_add_suite(r, parallel_suite());
+  srunner_add_suite(r, hedge_suite());
+  srunner_add_suite(r, vhost_suite());
+  srunner_add_suite(r, ratelimit_suite());
+  srunner_add_suite(r, acache_suite());
+  srunner_add_suite(r, vfs_suite());
   srunner_add_suite(r, utest_suite());
 #ifdef __linux__
   srunner_add_suite(r, profile_suite());
 #endif
   /* srunner_add_suite(r, s3_auth_v2_suite()); */
   srunner_add_suite(r, s3_auth_v4_suite());
+  srunner_add_suite(r, s3_auth_v4_bench_suite());
+  srunner_add_suite(r, s3_genurl_suite());
+  srunner_add_suite(r, s3_list_bucket_suite());
+  srunner_add_suite(r, s3_multipart_suite());
 
   if (debug_flag)
     srunner_set_fork_status(r, CK_NOFORK);
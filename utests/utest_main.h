@@ -16,10 +16,25 @@ extern Suite    *getdate_suite(void);
 extern Suite    *util_suite(void);
 extern Suite    *profile_suite(void);
 extern Suite    *sproxyd_suite(void);
+extern Suite    *vdir_suite(void);
+extern Suite    *copy_suite(void);
+extern Suite    *retry_suite(void);
+extern Suite    *crypt_suite(void);
+extern Suite    *compress_suite(void);
+extern Suite    *parallel_suite(void);
+extern Suite    *hedge_suite(void);
+extern Suite    *vhost_suite(void);
+extern Suite    *ratelimit_suite(void);
+extern Suite    *acache_suite(void);
+extern Suite    *vfs_suite(void);
 
 /* S3 backend tests */
 extern Suite    *s3_auth_v2_suite(void);
 extern Suite    *s3_auth_v4_suite(void);
+extern Suite    *s3_auth_v4_bench_suite(void);
+extern Suite    *s3_genurl_suite(void);
+extern Suite    *s3_list_bucket_suite(void);
+extern Suite    *s3_multipart_suite(void);
 
 /* Provide versions of the <check.h> comparison assert macros which do
  * not expand their arguments twice.  This allows arguments to have side